@@ -0,0 +1,784 @@
+/* BDK - The GIMP Drawing Kit
+ * Copyright (C) 1995-1997 Peter Mattis, Spencer Kimball and Josh MacDonald
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/*
+ * Modified by the BTK+ Team and others 1997-2000.  See the AUTHORS
+ * file for a list of people on the BTK+ Team.  See the ChangeLog
+ * files for a list of changes.  These files are distributed with
+ * BTK+ at ftp://ftp.btk.org/pub/btk/.
+ */
+
+/* Alpha compositing loops for bdk_draw_pixbuf()
+ *
+ * All of them compute, for every channel,
+ *
+ *   t = a * src + (255 - a) * dest + 0x80
+ *   dest = (t + (t >> 8)) >> 8
+ *
+ * which is exact in 16 bits, so the vector versions work on 16 bit
+ * lanes and give the same results as the plain C ones.  A fully
+ * transparent source pixel leaves the destination unchanged, which
+ * the vector loops use to skip runs of them.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include "bdksimd.h"
+
+#ifdef BDK_SIMD_X86
+#include <immintrin.h>
+#endif
+
+#ifdef BDK_SIMD_ARM_NEON
+#include <arm_neon.h>
+#endif
+
+/* Plain C */
+
+static inline void
+composite_rgb_pixels (buchar *p,
+		      buchar *q,
+		      bint    n)
+{
+  while (n--)
+    {
+      buchar a = p[3];
+      buint t;
+
+      t = a * p[0] + (255 - a) * q[0] + 0x80;
+      q[0] = (t + (t >> 8)) >> 8;
+      t = a * p[1] + (255 - a) * q[1] + 0x80;
+      q[1] = (t + (t >> 8)) >> 8;
+      t = a * p[2] + (255 - a) * q[2] + 0x80;
+      q[2] = (t + (t >> 8)) >> 8;
+
+      p += 4;
+      q += 3;
+    }
+}
+
+static inline void
+composite_0888_pixels (buchar       *p,
+		       buchar       *q,
+		       BdkByteOrder  dest_byte_order,
+		       bint          n)
+{
+  if (dest_byte_order == BDK_LSB_FIRST)
+    {
+      while (n--)
+	{
+	  buint t;
+
+	  t = p[3] * p[2] + (255 - p[3]) * q[0] + 0x80;
+	  q[0] = (t + (t >> 8)) >> 8;
+	  t = p[3] * p[1] + (255 - p[3]) * q[1] + 0x80;
+	  q[1] = (t + (t >> 8)) >> 8;
+	  t = p[3] * p[0] + (255 - p[3]) * q[2] + 0x80;
+	  q[2] = (t + (t >> 8)) >> 8;
+	  p += 4;
+	  q += 4;
+	}
+    }
+  else
+    {
+      while (n--)
+	{
+	  buint t;
+
+	  t = p[3] * p[0] + (255 - p[3]) * q[1] + 0x80;
+	  q[1] = (t + (t >> 8)) >> 8;
+	  t = p[3] * p[1] + (255 - p[3]) * q[2] + 0x80;
+	  q[2] = (t + (t >> 8)) >> 8;
+	  t = p[3] * p[2] + (255 - p[3]) * q[3] + 0x80;
+	  q[3] = (t + (t >> 8)) >> 8;
+	  p += 4;
+	  q += 4;
+	}
+    }
+}
+
+static inline void
+composite_565_pixels (buchar  *p,
+		      bushort *q,
+		      bint     n)
+{
+  while (n--)
+    {
+      buchar a = p[3];
+      buint tr, tg, tb;
+      buint tr1, tg1, tb1;
+      buint tmp = *q;
+
+#if 1
+      /* This is fast, and corresponds to what composite_rgb() does
+       * if we converted to 8-bit first.
+       */
+      tr = (tmp & 0xf800);
+      tr1 = a * p[0] + (255 - a) * ((tr >> 8) + (tr >> 13)) + 0x80;
+      tg = (tmp & 0x07e0);
+      tg1 = a * p[1] + (255 - a) * ((tg >> 3) + (tg >> 9)) + 0x80;
+      tb = (tmp & 0x001f);
+      tb1 = a * p[2] + (255 - a) * ((tb << 3) + (tb >> 2)) + 0x80;
+
+      *q = (((tr1 + (tr1 >> 8)) & 0xf800) |
+	    (((tg1 + (tg1 >> 8)) & 0xfc00) >> 5)  |
+	    ((tb1 + (tb1 >> 8)) >> 11));
+#else
+      /* This version correspond to the result we get with XRENDER -
+       * a bit of precision is lost since we convert to 8 bit after premultiplying
+       * instead of at the end
+       */
+      buint tr2, tg2, tb2;
+      buint tr3, tg3, tb3;
+
+      tr = (tmp & 0xf800);
+      tr1 = (255 - a) * ((tr >> 8) + (tr >> 13)) + 0x80;
+      tr2 = a * p[0] + 0x80;
+      tr3 = ((tr1 + (tr1 >> 8)) >> 8) + ((tr2 + (tr2 >> 8)) >> 8);
+
+      tg = (tmp & 0x07e0);
+      tg1 = (255 - a) * ((tg >> 3) + (tg >> 9)) + 0x80;
+      tg2 = a * p[0] + 0x80;
+      tg3 = ((tg1 + (tg1 >> 8)) >> 8) + ((tg2 + (tg2 >> 8)) >> 8);
+
+      tb = (tmp & 0x001f);
+      tb1 = (255 - a) * ((tb << 3) + (tb >> 2)) + 0x80;
+      tb2 = a * p[0] + 0x80;
+      tb3 = ((tb1 + (tb1 >> 8)) >> 8) + ((tb2 + (tb2 >> 8)) >> 8);
+
+      *q = (((tr3 & 0xf8) << 8) |
+	    ((tg3 & 0xfc) << 3) |
+	    ((tb3 >> 3)));
+#endif
+
+      p += 4;
+      q++;
+    }
+}
+
+static void
+composite_rgb (buchar       *src_buf,
+	       bint          src_rowstride,
+	       buchar       *dest_buf,
+	       bint          dest_rowstride,
+	       BdkByteOrder  dest_byte_order,
+	       bint          width,
+	       bint          height)
+{
+  while (height--)
+    {
+      composite_rgb_pixels (src_buf, dest_buf, width);
+
+      src_buf += src_rowstride;
+      dest_buf += dest_rowstride;
+    }
+}
+
+static void
+composite_0888 (buchar       *src_buf,
+		bint          src_rowstride,
+		buchar       *dest_buf,
+		bint          dest_rowstride,
+		BdkByteOrder  dest_byte_order,
+		bint          width,
+		bint          height)
+{
+  while (height--)
+    {
+      composite_0888_pixels (src_buf, dest_buf, dest_byte_order, width);
+
+      src_buf += src_rowstride;
+      dest_buf += dest_rowstride;
+    }
+}
+
+static void
+composite_565 (buchar       *src_buf,
+	       bint          src_rowstride,
+	       buchar       *dest_buf,
+	       bint          dest_rowstride,
+	       BdkByteOrder  dest_byte_order,
+	       bint          width,
+	       bint          height)
+{
+  while (height--)
+    {
+      composite_565_pixels (src_buf, (bushort *) dest_buf, width);
+
+      src_buf += src_rowstride;
+      dest_buf += dest_rowstride;
+    }
+}
+
+#ifdef BDK_SIMD_X86
+
+#define TARGET_SSE2  __attribute__ ((target ("sse2")))
+#define TARGET_SSSE3 __attribute__ ((target ("ssse3")))
+#define TARGET_AVX2  __attribute__ ((target ("avx2")))
+
+/* The byte order of the 0888 formats as 16 bit lane shuffles of an
+ * RGBA pixel
+ */
+#define SHUFFLE_LSB   _MM_SHUFFLE (3, 0, 1, 2)	/* B G R - */
+#define SHUFFLE_MSB   _MM_SHUFFLE (2, 1, 0, 3)	/* - R G B */
+#define SHUFFLE_ALPHA _MM_SHUFFLE (3, 3, 3, 3)
+
+/* SSE2 */
+
+static inline __m128i TARGET_SSE2
+blend_sse2 (__m128i p,
+	    __m128i q,
+	    __m128i a)
+{
+  __m128i t;
+
+  t = _mm_add_epi16 (_mm_mullo_epi16 (p, a),
+		     _mm_mullo_epi16 (q, _mm_sub_epi16 (_mm_set1_epi16 (255), a)));
+  t = _mm_add_epi16 (t, _mm_set1_epi16 (0x80));
+
+  return _mm_srli_epi16 (_mm_add_epi16 (t, _mm_srli_epi16 (t, 8)), 8);
+}
+
+/* Whether all 4 RGBA pixels in @s are fully transparent */
+static inline bboolean TARGET_SSE2
+transparent_sse2 (__m128i s)
+{
+  s = _mm_and_si128 (s, _mm_set1_epi32 (0xff000000));
+
+  return _mm_movemask_epi8 (_mm_cmpeq_epi32 (s, _mm_setzero_si128 ())) == 0xffff;
+}
+
+static void TARGET_SSE2
+composite_0888_sse2 (buchar       *src_buf,
+		     bint          src_rowstride,
+		     buchar       *dest_buf,
+		     bint          dest_rowstride,
+		     BdkByteOrder  dest_byte_order,
+		     bint          width,
+		     bint          height)
+{
+  const __m128i zero = _mm_setzero_si128 ();
+  __m128i keep;
+
+  /* The padding byte of every pixel */
+  if (dest_byte_order == BDK_LSB_FIRST)
+    keep = _mm_set1_epi32 (0xff000000);
+  else
+    keep = _mm_set1_epi32 (0x000000ff);
+
+  while (height--)
+    {
+      bint twidth = width;
+      buchar *p = src_buf;
+      buchar *q = dest_buf;
+
+      for (; twidth >= 4; twidth -= 4, p += 16, q += 16)
+	{
+	  __m128i s, d, s_lo, s_hi, a_lo, a_hi, r;
+
+	  s = _mm_loadu_si128 ((__m128i *) p);
+	  if (transparent_sse2 (s))
+	    continue;
+
+	  d = _mm_loadu_si128 ((__m128i *) q);
+
+	  s_lo = _mm_unpacklo_epi8 (s, zero);
+	  s_hi = _mm_unpackhi_epi8 (s, zero);
+	  a_lo = _mm_shufflehi_epi16 (_mm_shufflelo_epi16 (s_lo, SHUFFLE_ALPHA), SHUFFLE_ALPHA);
+	  a_hi = _mm_shufflehi_epi16 (_mm_shufflelo_epi16 (s_hi, SHUFFLE_ALPHA), SHUFFLE_ALPHA);
+
+	  if (dest_byte_order == BDK_LSB_FIRST)
+	    {
+	      s_lo = _mm_shufflehi_epi16 (_mm_shufflelo_epi16 (s_lo, SHUFFLE_LSB), SHUFFLE_LSB);
+	      s_hi = _mm_shufflehi_epi16 (_mm_shufflelo_epi16 (s_hi, SHUFFLE_LSB), SHUFFLE_LSB);
+	    }
+	  else
+	    {
+	      s_lo = _mm_shufflehi_epi16 (_mm_shufflelo_epi16 (s_lo, SHUFFLE_MSB), SHUFFLE_MSB);
+	      s_hi = _mm_shufflehi_epi16 (_mm_shufflelo_epi16 (s_hi, SHUFFLE_MSB), SHUFFLE_MSB);
+	    }
+
+	  r = _mm_packus_epi16 (blend_sse2 (s_lo, _mm_unpacklo_epi8 (d, zero), a_lo),
+				blend_sse2 (s_hi, _mm_unpackhi_epi8 (d, zero), a_hi));
+	  r = _mm_or_si128 (_mm_and_si128 (keep, d), _mm_andnot_si128 (keep, r));
+
+	  _mm_storeu_si128 ((__m128i *) q, r);
+	}
+
+      composite_0888_pixels (p, q, dest_byte_order, twidth);
+
+      src_buf += src_rowstride;
+      dest_buf += dest_rowstride;
+    }
+}
+
+/* Expands 565 pixels to 8 bits per channel, the way
+ * composite_565_pixels() does.
+ */
+static inline void TARGET_SSE2
+unpack_565_sse2 (__m128i  d,
+		 __m128i *r,
+		 __m128i *g,
+		 __m128i *b)
+{
+  __m128i t;
+
+  t = _mm_srli_epi16 (d, 11);
+  *r = _mm_or_si128 (_mm_slli_epi16 (t, 3), _mm_srli_epi16 (t, 2));
+  t = _mm_and_si128 (_mm_srli_epi16 (d, 5), _mm_set1_epi16 (0x3f));
+  *g = _mm_or_si128 (_mm_slli_epi16 (t, 2), _mm_srli_epi16 (t, 4));
+  t = _mm_and_si128 (d, _mm_set1_epi16 (0x1f));
+  *b = _mm_or_si128 (_mm_slli_epi16 (t, 3), _mm_srli_epi16 (t, 2));
+}
+
+static inline __m128i TARGET_SSE2
+pack_565_sse2 (__m128i r,
+	       __m128i g,
+	       __m128i b)
+{
+  r = _mm_slli_epi16 (_mm_and_si128 (r, _mm_set1_epi16 (0xf8)), 8);
+  g = _mm_slli_epi16 (_mm_and_si128 (g, _mm_set1_epi16 (0xfc)), 3);
+  b = _mm_srli_epi16 (b, 3);
+
+  return _mm_or_si128 (_mm_or_si128 (r, g), b);
+}
+
+static void TARGET_SSE2
+composite_565_sse2 (buchar       *src_buf,
+		    bint          src_rowstride,
+		    buchar       *dest_buf,
+		    bint          dest_rowstride,
+		    BdkByteOrder  dest_byte_order,
+		    bint          width,
+		    bint          height)
+{
+  const __m128i mask = _mm_set1_epi32 (0xff);
+
+  while (height--)
+    {
+      bint twidth = width;
+      buchar *p = src_buf;
+      bushort *q = (bushort *) dest_buf;
+
+      for (; twidth >= 8; twidth -= 8, p += 32, q += 8)
+	{
+	  __m128i s0, s1, sr, sg, sb, sa, dr, dg, db;
+
+	  s0 = _mm_loadu_si128 ((__m128i *) p);
+	  s1 = _mm_loadu_si128 ((__m128i *) (p + 16));
+	  if (transparent_sse2 (s0) && transparent_sse2 (s1))
+	    continue;
+
+	  /* Split into one vector per channel */
+	  sr = _mm_packs_epi32 (_mm_and_si128 (s0, mask),
+				_mm_and_si128 (s1, mask));
+	  sg = _mm_packs_epi32 (_mm_and_si128 (_mm_srli_epi32 (s0, 8), mask),
+				_mm_and_si128 (_mm_srli_epi32 (s1, 8), mask));
+	  sb = _mm_packs_epi32 (_mm_and_si128 (_mm_srli_epi32 (s0, 16), mask),
+				_mm_and_si128 (_mm_srli_epi32 (s1, 16), mask));
+	  sa = _mm_packs_epi32 (_mm_srli_epi32 (s0, 24),
+				_mm_srli_epi32 (s1, 24));
+
+	  unpack_565_sse2 (_mm_loadu_si128 ((__m128i *) q), &dr, &dg, &db);
+
+	  _mm_storeu_si128 ((__m128i *) q,
+			    pack_565_sse2 (blend_sse2 (sr, dr, sa),
+					   blend_sse2 (sg, dg, sa),
+					   blend_sse2 (sb, db, sa)));
+	}
+
+      composite_565_pixels (p, q, twidth);
+
+      src_buf += src_rowstride;
+      dest_buf += dest_rowstride;
+    }
+}
+
+/* SSSE3 */
+
+static void TARGET_SSSE3
+composite_rgb_ssse3 (buchar       *src_buf,
+		     bint          src_rowstride,
+		     buchar       *dest_buf,
+		     bint          dest_rowstride,
+		     BdkByteOrder  dest_byte_order,
+		     bint          width,
+		     bint          height)
+{
+  const __m128i zero = _mm_setzero_si128 ();
+  const __m128i expand = _mm_setr_epi8 (0, 1, 2, -1, 3, 4, 5, -1,
+					6, 7, 8, -1, 9, 10, 11, -1);
+  const __m128i compress = _mm_setr_epi8 (0, 1, 2, 4, 5, 6, 8, 9,
+					  10, 12, 13, 14, -1, -1, -1, -1);
+
+  while (height--)
+    {
+      bint twidth = width;
+      buchar *p = src_buf;
+      buchar *q = dest_buf;
+
+      /* 4 pixels at a time, but the load reads 16 bytes of dest */
+      for (; twidth >= 6; twidth -= 4, p += 16, q += 12)
+	{
+	  __m128i s, d, a_lo, a_hi, r;
+	  bint last;
+
+	  s = _mm_loadu_si128 ((__m128i *) p);
+	  if (transparent_sse2 (s))
+	    continue;
+
+	  d = _mm_shuffle_epi8 (_mm_loadu_si128 ((__m128i *) q), expand);
+
+	  a_lo = _mm_unpacklo_epi8 (s, zero);
+	  a_lo = _mm_shufflehi_epi16 (_mm_shufflelo_epi16 (a_lo, SHUFFLE_ALPHA), SHUFFLE_ALPHA);
+	  a_hi = _mm_unpackhi_epi8 (s, zero);
+	  a_hi = _mm_shufflehi_epi16 (_mm_shufflelo_epi16 (a_hi, SHUFFLE_ALPHA), SHUFFLE_ALPHA);
+
+	  r = _mm_packus_epi16 (blend_sse2 (_mm_unpacklo_epi8 (s, zero),
+					    _mm_unpacklo_epi8 (d, zero), a_lo),
+				blend_sse2 (_mm_unpackhi_epi8 (s, zero),
+					    _mm_unpackhi_epi8 (d, zero), a_hi));
+	  r = _mm_shuffle_epi8 (r, compress);
+
+	  _mm_storel_epi64 ((__m128i *) q, r);
+	  last = _mm_cvtsi128_si32 (_mm_srli_si128 (r, 8));
+	  memcpy (q + 8, &last, 4);
+	}
+
+      composite_rgb_pixels (p, q, twidth);
+
+      src_buf += src_rowstride;
+      dest_buf += dest_rowstride;
+    }
+}
+
+/* AVX2
+ *
+ * Most 256 bit operations work on the two 128 bit halves separately,
+ * so these are the SSE2 loops on 8 or 16 pixels at a time.
+ */
+
+static inline __m256i TARGET_AVX2
+blend_avx2 (__m256i p,
+	    __m256i q,
+	    __m256i a)
+{
+  __m256i t;
+
+  t = _mm256_add_epi16 (_mm256_mullo_epi16 (p, a),
+			_mm256_mullo_epi16 (q, _mm256_sub_epi16 (_mm256_set1_epi16 (255), a)));
+  t = _mm256_add_epi16 (t, _mm256_set1_epi16 (0x80));
+
+  return _mm256_srli_epi16 (_mm256_add_epi16 (t, _mm256_srli_epi16 (t, 8)), 8);
+}
+
+static inline bboolean TARGET_AVX2
+transparent_avx2 (__m256i s)
+{
+  s = _mm256_and_si256 (s, _mm256_set1_epi32 (0xff000000));
+
+  return _mm256_movemask_epi8 (_mm256_cmpeq_epi32 (s, _mm256_setzero_si256 ())) == -1;
+}
+
+static void TARGET_AVX2
+composite_0888_avx2 (buchar       *src_buf,
+		     bint          src_rowstride,
+		     buchar       *dest_buf,
+		     bint          dest_rowstride,
+		     BdkByteOrder  dest_byte_order,
+		     bint          width,
+		     bint          height)
+{
+  const __m256i zero = _mm256_setzero_si256 ();
+  __m256i keep;
+
+  if (dest_byte_order == BDK_LSB_FIRST)
+    keep = _mm256_set1_epi32 (0xff000000);
+  else
+    keep = _mm256_set1_epi32 (0x000000ff);
+
+  while (height--)
+    {
+      bint twidth = width;
+      buchar *p = src_buf;
+      buchar *q = dest_buf;
+
+      for (; twidth >= 8; twidth -= 8, p += 32, q += 32)
+	{
+	  __m256i s, d, s_lo, s_hi, a_lo, a_hi, r;
+
+	  s = _mm256_loadu_si256 ((__m256i *) p);
+	  if (transparent_avx2 (s))
+	    continue;
+
+	  d = _mm256_loadu_si256 ((__m256i *) q);
+
+	  s_lo = _mm256_unpacklo_epi8 (s, zero);
+	  s_hi = _mm256_unpackhi_epi8 (s, zero);
+	  a_lo = _mm256_shufflehi_epi16 (_mm256_shufflelo_epi16 (s_lo, SHUFFLE_ALPHA), SHUFFLE_ALPHA);
+	  a_hi = _mm256_shufflehi_epi16 (_mm256_shufflelo_epi16 (s_hi, SHUFFLE_ALPHA), SHUFFLE_ALPHA);
+
+	  if (dest_byte_order == BDK_LSB_FIRST)
+	    {
+	      s_lo = _mm256_shufflehi_epi16 (_mm256_shufflelo_epi16 (s_lo, SHUFFLE_LSB), SHUFFLE_LSB);
+	      s_hi = _mm256_shufflehi_epi16 (_mm256_shufflelo_epi16 (s_hi, SHUFFLE_LSB), SHUFFLE_LSB);
+	    }
+	  else
+	    {
+	      s_lo = _mm256_shufflehi_epi16 (_mm256_shufflelo_epi16 (s_lo, SHUFFLE_MSB), SHUFFLE_MSB);
+	      s_hi = _mm256_shufflehi_epi16 (_mm256_shufflelo_epi16 (s_hi, SHUFFLE_MSB), SHUFFLE_MSB);
+	    }
+
+	  r = _mm256_packus_epi16 (blend_avx2 (s_lo, _mm256_unpacklo_epi8 (d, zero), a_lo),
+				   blend_avx2 (s_hi, _mm256_unpackhi_epi8 (d, zero), a_hi));
+	  r = _mm256_or_si256 (_mm256_and_si256 (keep, d), _mm256_andnot_si256 (keep, r));
+
+	  _mm256_storeu_si256 ((__m256i *) q, r);
+	}
+
+      composite_0888_pixels (p, q, dest_byte_order, twidth);
+
+      src_buf += src_rowstride;
+      dest_buf += dest_rowstride;
+    }
+}
+
+static void TARGET_AVX2
+composite_565_avx2 (buchar       *src_buf,
+		    bint          src_rowstride,
+		    buchar       *dest_buf,
+		    bint          dest_rowstride,
+		    BdkByteOrder  dest_byte_order,
+		    bint          width,
+		    bint          height)
+{
+  const __m256i mask = _mm256_set1_epi32 (0xff);
+
+  while (height--)
+    {
+      bint twidth = width;
+      buchar *p = src_buf;
+      bushort *q = (bushort *) dest_buf;
+
+      for (; twidth >= 16; twidth -= 16, p += 64, q += 16)
+	{
+	  __m256i s0, s1, sr, sg, sb, sa, d, t, dr, dg, db, r, g, b;
+
+	  s0 = _mm256_loadu_si256 ((__m256i *) p);
+	  s1 = _mm256_loadu_si256 ((__m256i *) (p + 32));
+	  if (transparent_avx2 (s0) && transparent_avx2 (s1))
+	    continue;
+
+	  /* Packing works within the halves, so the channel vectors
+	   * hold pixels 0-3, 8-11, 4-7 and 12-15.  Shuffle the
+	   * destination the same way instead of fixing up all four.
+	   */
+	  sr = _mm256_packs_epi32 (_mm256_and_si256 (s0, mask),
+				   _mm256_and_si256 (s1, mask));
+	  sg = _mm256_packs_epi32 (_mm256_and_si256 (_mm256_srli_epi32 (s0, 8), mask),
+				   _mm256_and_si256 (_mm256_srli_epi32 (s1, 8), mask));
+	  sb = _mm256_packs_epi32 (_mm256_and_si256 (_mm256_srli_epi32 (s0, 16), mask),
+				   _mm256_and_si256 (_mm256_srli_epi32 (s1, 16), mask));
+	  sa = _mm256_packs_epi32 (_mm256_srli_epi32 (s0, 24),
+				   _mm256_srli_epi32 (s1, 24));
+
+	  d = _mm256_loadu_si256 ((__m256i *) q);
+	  d = _mm256_permute4x64_epi64 (d, _MM_SHUFFLE (3, 1, 2, 0));
+
+	  t = _mm256_srli_epi16 (d, 11);
+	  dr = _mm256_or_si256 (_mm256_slli_epi16 (t, 3), _mm256_srli_epi16 (t, 2));
+	  t = _mm256_and_si256 (_mm256_srli_epi16 (d, 5), _mm256_set1_epi16 (0x3f));
+	  dg = _mm256_or_si256 (_mm256_slli_epi16 (t, 2), _mm256_srli_epi16 (t, 4));
+	  t = _mm256_and_si256 (d, _mm256_set1_epi16 (0x1f));
+	  db = _mm256_or_si256 (_mm256_slli_epi16 (t, 3), _mm256_srli_epi16 (t, 2));
+
+	  r = blend_avx2 (sr, dr, sa);
+	  g = blend_avx2 (sg, dg, sa);
+	  b = blend_avx2 (sb, db, sa);
+
+	  r = _mm256_slli_epi16 (_mm256_and_si256 (r, _mm256_set1_epi16 (0xf8)), 8);
+	  g = _mm256_slli_epi16 (_mm256_and_si256 (g, _mm256_set1_epi16 (0xfc)), 3);
+	  b = _mm256_srli_epi16 (b, 3);
+	  d = _mm256_or_si256 (_mm256_or_si256 (r, g), b);
+
+	  _mm256_storeu_si256 ((__m256i *) q,
+			       _mm256_permute4x64_epi64 (d, _MM_SHUFFLE (3, 1, 2, 0)));
+	}
+
+      composite_565_pixels (p, q, twidth);
+
+      src_buf += src_rowstride;
+      dest_buf += dest_rowstride;
+    }
+}
+
+#endif /* BDK_SIMD_X86 */
+
+#ifdef BDK_SIMD_ARM_NEON
+
+/* NEON can load and store interleaved channels directly, so these work
+ * on 16 pixels at a time, one vector per channel.
+ */
+
+static inline uint8x16_t
+blend_neon (uint8x16_t p,
+	    uint8x16_t q,
+	    uint8x16_t a)
+{
+  uint8x16_t ia = vmvnq_u8 (a);
+  uint16x8_t lo, hi;
+
+  lo = vmlal_u8 (vmull_u8 (vget_low_u8 (p), vget_low_u8 (a)),
+		 vget_low_u8 (q), vget_low_u8 (ia));
+  hi = vmlal_u8 (vmull_u8 (vget_high_u8 (p), vget_high_u8 (a)),
+		 vget_high_u8 (q), vget_high_u8 (ia));
+  lo = vaddq_u16 (lo, vdupq_n_u16 (0x80));
+  hi = vaddq_u16 (hi, vdupq_n_u16 (0x80));
+
+  /* (t + (t >> 8)) >> 8 */
+  return vcombine_u8 (vaddhn_u16 (lo, vshrq_n_u16 (lo, 8)),
+		      vaddhn_u16 (hi, vshrq_n_u16 (hi, 8)));
+}
+
+static void
+composite_rgb_neon (buchar       *src_buf,
+		    bint          src_rowstride,
+		    buchar       *dest_buf,
+		    bint          dest_rowstride,
+		    BdkByteOrder  dest_byte_order,
+		    bint          width,
+		    bint          height)
+{
+  while (height--)
+    {
+      bint twidth = width;
+      buchar *p = src_buf;
+      buchar *q = dest_buf;
+
+      for (; twidth >= 16; twidth -= 16, p += 64, q += 48)
+	{
+	  uint8x16x4_t s = vld4q_u8 (p);
+	  uint8x16x3_t d = vld3q_u8 (q);
+
+	  d.val[0] = blend_neon (s.val[0], d.val[0], s.val[3]);
+	  d.val[1] = blend_neon (s.val[1], d.val[1], s.val[3]);
+	  d.val[2] = blend_neon (s.val[2], d.val[2], s.val[3]);
+
+	  vst3q_u8 (q, d);
+	}
+
+      composite_rgb_pixels (p, q, twidth);
+
+      src_buf += src_rowstride;
+      dest_buf += dest_rowstride;
+    }
+}
+
+static void
+composite_0888_neon (buchar       *src_buf,
+		     bint          src_rowstride,
+		     buchar       *dest_buf,
+		     bint          dest_rowstride,
+		     BdkByteOrder  dest_byte_order,
+		     bint          width,
+		     bint          height)
+{
+  while (height--)
+    {
+      bint twidth = width;
+      buchar *p = src_buf;
+      buchar *q = dest_buf;
+
+      for (; twidth >= 16; twidth -= 16, p += 64, q += 64)
+	{
+	  uint8x16x4_t s = vld4q_u8 (p);
+	  uint8x16x4_t d = vld4q_u8 (q);
+
+	  if (dest_byte_order == BDK_LSB_FIRST)
+	    {
+	      d.val[0] = blend_neon (s.val[2], d.val[0], s.val[3]);
+	      d.val[1] = blend_neon (s.val[1], d.val[1], s.val[3]);
+	      d.val[2] = blend_neon (s.val[0], d.val[2], s.val[3]);
+	    }
+	  else
+	    {
+	      d.val[1] = blend_neon (s.val[0], d.val[1], s.val[3]);
+	      d.val[2] = blend_neon (s.val[1], d.val[2], s.val[3]);
+	      d.val[3] = blend_neon (s.val[2], d.val[3], s.val[3]);
+	    }
+
+	  vst4q_u8 (q, d);
+	}
+
+      composite_0888_pixels (p, q, dest_byte_order, twidth);
+
+      src_buf += src_rowstride;
+      dest_buf += dest_rowstride;
+    }
+}
+
+#endif /* BDK_SIMD_ARM_NEON */
+
+/* Returns the fastest compositing loop for @format that only uses
+ * the instruction sets in @flags.  Pass 0 to get the plain C one.
+ */
+BdkCompositeFunc
+_bdk_composite_get_func (BdkCompositeFormat format,
+			 BdkSimdFlags       flags)
+{
+  switch (format)
+    {
+    case BDK_COMPOSITE_RGB:
+#ifdef BDK_SIMD_X86
+      if (flags & BDK_SIMD_SSSE3)
+	return composite_rgb_ssse3;
+#endif
+#ifdef BDK_SIMD_ARM_NEON
+      if (flags & BDK_SIMD_NEON)
+	return composite_rgb_neon;
+#endif
+      return composite_rgb;
+
+    case BDK_COMPOSITE_0888:
+#ifdef BDK_SIMD_X86
+      if (flags & BDK_SIMD_AVX2)
+	return composite_0888_avx2;
+      if (flags & BDK_SIMD_SSE2)
+	return composite_0888_sse2;
+#endif
+#ifdef BDK_SIMD_ARM_NEON
+      if (flags & BDK_SIMD_NEON)
+	return composite_0888_neon;
+#endif
+      return composite_0888;
+
+    case BDK_COMPOSITE_565:
+#ifdef BDK_SIMD_X86
+      if (flags & BDK_SIMD_AVX2)
+	return composite_565_avx2;
+      if (flags & BDK_SIMD_SSE2)
+	return composite_565_sse2;
+#endif
+      return composite_565;
+    }
+
+  return NULL;
+}
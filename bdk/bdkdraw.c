@@ -34,6 +34,7 @@
 #include "bdkwindow.h"
 #include "bdkscreen.h"
 #include "bdkpixbuf.h"
+#include "bdksimd.h"
 #include "bdkalias.h"
 
 static BdkImage*    bdk_drawable_real_get_image (BdkDrawable     *drawable,
@@ -794,11 +795,9 @@ bdk_draw_image (BdkDrawable *drawable,
  * On older X servers, rendering pixbufs with an alpha channel involves round 
  * trips to the X server, and may be somewhat slow.
  *
- * If BDK is built with the Sun mediaLib library, the bdk_draw_pixbuf
- * function is accelerated using mediaLib, which provides hardware
- * acceleration on Intel, AMD, and Sparc chipsets.  If desired, mediaLib
- * support can be turned off by setting the BDK_DISABLE_MEDIALIB environment
- * variable.
+ * The alpha compositing uses the SSE2, SSSE3, AVX2 or NEON instructions
+ * when the processor has them.  If desired, this can be turned off by
+ * setting the BDK_DISABLE_SIMD environment variable.
  *
  * Since: 2.2
  *
@@ -1365,214 +1364,6 @@ _bdk_drawable_ref_bairo_surface (BdkDrawable *drawable)
   return BDK_DRAWABLE_GET_CLASS (drawable)->ref_bairo_surface (drawable);
 }
 
-static void
-composite (buchar *src_buf,
-	   bint    src_rowstride,
-	   buchar *dest_buf,
-	   bint    dest_rowstride,
-	   bint    width,
-	   bint    height)
-{
-  buchar *src = src_buf;
-  buchar *dest = dest_buf;
-
-  while (height--)
-    {
-      bint twidth = width;
-      buchar *p = src;
-      buchar *q = dest;
-
-      while (twidth--)
-	{
-	  buchar a = p[3];
-	  buint t;
-
-	  t = a * p[0] + (255 - a) * q[0] + 0x80;
-	  q[0] = (t + (t >> 8)) >> 8;
-	  t = a * p[1] + (255 - a) * q[1] + 0x80;
-	  q[1] = (t + (t >> 8)) >> 8;
-	  t = a * p[2] + (255 - a) * q[2] + 0x80;
-	  q[2] = (t + (t >> 8)) >> 8;
-
-	  p += 4;
-	  q += 3;
-	}
-      
-      src += src_rowstride;
-      dest += dest_rowstride;
-    }
-}
-
-static void
-composite_0888 (buchar      *src_buf,
-		bint         src_rowstride,
-		buchar      *dest_buf,
-		bint         dest_rowstride,
-		BdkByteOrder dest_byte_order,
-		bint         width,
-		bint         height)
-{
-  buchar *src = src_buf;
-  buchar *dest = dest_buf;
-
-  while (height--)
-    {
-      bint twidth = width;
-      buchar *p = src;
-      buchar *q = dest;
-
-      if (dest_byte_order == BDK_LSB_FIRST)
-	{
-	  while (twidth--)
-	    {
-	      buint t;
-	      
-	      t = p[3] * p[2] + (255 - p[3]) * q[0] + 0x80;
-	      q[0] = (t + (t >> 8)) >> 8;
-	      t = p[3] * p[1] + (255 - p[3]) * q[1] + 0x80;
-	      q[1] = (t + (t >> 8)) >> 8;
-	      t = p[3] * p[0] + (255 - p[3]) * q[2] + 0x80;
-	      q[2] = (t + (t >> 8)) >> 8;
-	      p += 4;
-	      q += 4;
-	    }
-	}
-      else
-	{
-	  while (twidth--)
-	    {
-	      buint t;
-	      
-	      t = p[3] * p[0] + (255 - p[3]) * q[1] + 0x80;
-	      q[1] = (t + (t >> 8)) >> 8;
-	      t = p[3] * p[1] + (255 - p[3]) * q[2] + 0x80;
-	      q[2] = (t + (t >> 8)) >> 8;
-	      t = p[3] * p[2] + (255 - p[3]) * q[3] + 0x80;
-	      q[3] = (t + (t >> 8)) >> 8;
-	      p += 4;
-	      q += 4;
-	    }
-	}
-      
-      src += src_rowstride;
-      dest += dest_rowstride;
-    }
-}
-
-#ifdef USE_MEDIALIB
-static void
-composite_0888_medialib (buchar      *src_buf,
-			 bint         src_rowstride,
-			 buchar      *dest_buf,
-			 bint         dest_rowstride,
-			 BdkByteOrder dest_byte_order,
-			 bint         width,
-			 bint         height)
-{
-  buchar *src  = src_buf;
-  buchar *dest = dest_buf;
-
-  mlib_image img_src, img_dst;
-
-  mlib_ImageSetStruct (&img_dst,
-                       MLIB_BYTE,
-                       4,
-                       width,
-                       height,
-                       dest_rowstride,
-                       dest_buf);
-
-  mlib_ImageSetStruct (&img_src,
-                       MLIB_BYTE,
-                       4,
-                       width,
-                       height,
-                       src_rowstride,
-                       src_buf);
-
-  if (dest_byte_order == BDK_LSB_FIRST)
-      mlib_ImageBlendRGBA2BGRA (&img_dst, &img_src);
-  else
-      mlib_ImageBlendRGBA2ARGB (&img_dst, &img_src);
-}
-#endif
-
-static void
-composite_565 (buchar      *src_buf,
-	       bint         src_rowstride,
-	       buchar      *dest_buf,
-	       bint         dest_rowstride,
-	       BdkByteOrder dest_byte_order,
-	       bint         width,
-	       bint         height)
-{
-  buchar *src = src_buf;
-  buchar *dest = dest_buf;
-
-  while (height--)
-    {
-      bint twidth = width;
-      buchar *p = src;
-      bushort *q = (bushort *)dest;
-
-      while (twidth--)
-	{
-	  buchar a = p[3];
-	  buint tr, tg, tb;
-	  buint tr1, tg1, tb1;
-	  buint tmp = *q;
-
-#if 1
-	  /* This is fast, and corresponds to what composite() above does
-	   * if we converted to 8-bit first.
-	   */
-	  tr = (tmp & 0xf800);
-	  tr1 = a * p[0] + (255 - a) * ((tr >> 8) + (tr >> 13)) + 0x80;
-	  tg = (tmp & 0x07e0);
-	  tg1 = a * p[1] + (255 - a) * ((tg >> 3) + (tg >> 9)) + 0x80;
-	  tb = (tmp & 0x001f);
-	  tb1 = a * p[2] + (255 - a) * ((tb << 3) + (tb >> 2)) + 0x80;
-
-	  *q = (((tr1 + (tr1 >> 8)) & 0xf800) |
-		(((tg1 + (tg1 >> 8)) & 0xfc00) >> 5)  |
-		((tb1 + (tb1 >> 8)) >> 11));
-#else
-	  /* This version correspond to the result we get with XRENDER -
-	   * a bit of precision is lost since we convert to 8 bit after premultiplying
-	   * instead of at the end
-	   */
-	  buint tr2, tg2, tb2;
-	  buint tr3, tg3, tb3;
-	  
-	  tr = (tmp & 0xf800);
-	  tr1 = (255 - a) * ((tr >> 8) + (tr >> 13)) + 0x80;
-	  tr2 = a * p[0] + 0x80;
-	  tr3 = ((tr1 + (tr1 >> 8)) >> 8) + ((tr2 + (tr2 >> 8)) >> 8);
-
-	  tg = (tmp & 0x07e0);
-	  tg1 = (255 - a) * ((tg >> 3) + (tg >> 9)) + 0x80;
-	  tg2 = a * p[0] + 0x80;
-	  tg3 = ((tg1 + (tg1 >> 8)) >> 8) + ((tg2 + (tg2 >> 8)) >> 8);
-
-	  tb = (tmp & 0x001f);
-	  tb1 = (255 - a) * ((tb << 3) + (tb >> 2)) + 0x80;
-	  tb2 = a * p[0] + 0x80;
-	  tb3 = ((tb1 + (tb1 >> 8)) >> 8) + ((tb2 + (tb2 >> 8)) >> 8);
-
-	  *q = (((tr3 & 0xf8) << 8) |
-		((tg3 & 0xfc) << 3) |
-		((tb3 >> 3)));
-#endif
-	  
-	  p += 4;
-	  q++;
-	}
-      
-      src += src_rowstride;
-      dest += dest_rowstride;
-    }
-}
-
 /* Implementation of the old vfunc in terms of the new one
    in case someone calls it directly (which they shouldn't!) */
 static void
@@ -1707,13 +1498,7 @@ bdk_drawable_real_draw_pixbuf (BdkDrawable  *drawable,
   if (bdk_pixbuf_get_has_alpha (pixbuf))
     {
       BdkVisual *visual = bdk_drawable_get_visual (drawable);
-      void (*composite_func) (buchar       *src_buf,
-			      bint          src_rowstride,
-			      buchar       *dest_buf,
-			      bint          dest_rowstride,
-			      BdkByteOrder  dest_byte_order,
-			      bint          width,
-			      bint          height) = NULL;
+      BdkCompositeFunc composite_func = NULL;
 
       /* First we see if we have a visual-specific composition function that can composite
        * the pixbuf data directly onto the image
@@ -1728,21 +1513,14 @@ bdk_drawable_real_draw_pixbuf (BdkDrawable  *drawable,
 	      visual->red_mask   == 0xf800 &&
 	      visual->green_mask == 0x07e0 &&
 	      visual->blue_mask  == 0x001f)
-	    composite_func = composite_565;
+	    composite_func = _bdk_composite_get_func (BDK_COMPOSITE_565,
+						      _bdk_simd_get_flags ());
 	  else if (visual->depth == 24 && bits_per_pixel == 32 &&
 		   visual->red_mask   == 0xff0000 &&
 		   visual->green_mask == 0x00ff00 &&
 		   visual->blue_mask  == 0x0000ff)
-	    {
-#ifdef USE_MEDIALIB
-	      if (_bdk_use_medialib ())
-	        composite_func = composite_0888_medialib;
-	      else
-	        composite_func = composite_0888;
-#else
-	      composite_func = composite_0888;
-#endif
-	    }
+	    composite_func = _bdk_composite_get_func (BDK_COMPOSITE_0888,
+						      _bdk_simd_get_flags ());
 	}
 
       /* We can't use our composite func if we are required to dither
@@ -1795,11 +1573,16 @@ bdk_drawable_real_draw_pixbuf (BdkDrawable  *drawable,
 						     width, height);
 	  
 	  if (composited)
-	    composite (bdk_pixbuf_get_pixels (pixbuf) + src_y * bdk_pixbuf_get_rowstride (pixbuf) + src_x * 4,
-		       bdk_pixbuf_get_rowstride (pixbuf),
-		       bdk_pixbuf_get_pixels (composited),
-		       bdk_pixbuf_get_rowstride (composited),
-		       width, height);
+	    {
+	      composite_func = _bdk_composite_get_func (BDK_COMPOSITE_RGB,
+							_bdk_simd_get_flags ());
+	      (*composite_func) (bdk_pixbuf_get_pixels (pixbuf) + src_y * bdk_pixbuf_get_rowstride (pixbuf) + src_x * 4,
+				 bdk_pixbuf_get_rowstride (pixbuf),
+				 bdk_pixbuf_get_pixels (composited),
+				 bdk_pixbuf_get_rowstride (composited),
+				 BDK_MSB_FIRST,
+				 width, height);
+	    }
 	}
     }
 
@@ -350,19 +350,24 @@ bdk_image_get_pixels (BdkImage *image)
   return image->mem;
 }
 
-/* We have N_REBUNNYION BDK_SCRATCH_IMAGE_WIDTH x BDK_SCRATCH_IMAGE_HEIGHT rebunnyions divided
- * up between n_images different images. possible_n_images gives
- * various divisors of N_REBUNNYIONS. The reason for allowing this
- * flexibility is that we want to create as few images as possible,
- * but we want to deal with the abberant systems that have a SHMMAX
- * limit less than
+/* The scratch images form a ring of n_images images of
+ * BDK_SCRATCH_IMAGE_WIDTH x BDK_SCRATCH_IMAGE_HEIGHT, shared memory
+ * images where the windowing system supports them. Drawing from a
+ * shared image is asynchronous; instead of waiting for the server each
+ * time we go around the ring, we only wait for the image that is about
+ * to be filled again (see _bdk_windowing_image_wait()), so that up to
+ * n_images uploads are in flight at any time.
  *
- * BDK_SCRATCH_IMAGE_WIDTH * BDK_SCRATCH_IMAGE_HEIGHT * N_REBUNNYIONS * 4 (384k)
+ * The number of images can be set with the BDK_SCRATCH_IMAGES
+ * environment variable. Each of them is
  *
- * (Are there any such?)
+ * BDK_SCRATCH_IMAGE_WIDTH * BDK_SCRATCH_IMAGE_HEIGHT * 4 (512k)
+ *
+ * at most. If the shared memory segments can't be allocated, we fall
+ * back to normal images.
  */
-#define N_REBUNNYIONS 6
-static const int possible_n_images[] = { 1, 2, 3, 6 };
+#define N_SCRATCH_IMAGES_DEFAULT 6
+#define N_SCRATCH_IMAGES_MAX 64
 
 /* We allocate one BdkScratchImageInfo structure for each
  * depth where we are allocating scratch images. (Future: one
@@ -374,16 +379,21 @@ struct _BdkScratchImageInfo {
   bint depth;
   
   bint n_images;
-  BdkImage *static_image[N_REBUNNYIONS];
+  BdkImage **static_image;
   bint static_image_idx;
 
+  /* Whether _bdk_windowing_image_wait() works for the images; if not
+   * we bdk_flush() each time we start over at the first image.
+   */
+  bboolean can_wait;
+
   /* In order to optimize filling fractions, we simultaneously fill in up
-   * to three rebunnyions of size BDK_SCRATCH_IMAGE_WIDTH * BDK_SCRATCH_IMAGE_HEIGHT: one
-   * for images that are taller than BDK_SCRATCH_IMAGE_HEIGHT / 2, and must
-   * be tiled horizontally. One for images that are wider than
-   * BDK_SCRATCH_IMAGE_WIDTH / 2 and must be tiled vertically, and a third
-   * for images smaller than BDK_SCRATCH_IMAGE_HEIGHT / 2 x BDK_SCRATCH_IMAGE_WIDTH x 2
-   * that we tile in horizontal rows.
+   * to three images: one for images that are taller than
+   * BDK_SCRATCH_IMAGE_HEIGHT / 2, and must be tiled horizontally. One
+   * for images that are wider than BDK_SCRATCH_IMAGE_WIDTH / 2 and must
+   * be tiled vertically, and a third for images smaller than
+   * BDK_SCRATCH_IMAGE_HEIGHT / 2 x BDK_SCRATCH_IMAGE_WIDTH x 2 that we
+   * tile in horizontal rows.
    */
   bint horiz_idx;
   bint horiz_y;
@@ -404,6 +414,22 @@ struct _BdkScratchImageInfo {
 
 static GSList *scratch_image_infos = NULL;
 
+static bint
+get_n_scratch_images (void)
+{
+  static bint n_images = 0;
+
+  if (n_images == 0)
+    {
+      const char *env = getenv ("BDK_SCRATCH_IMAGES");
+
+      n_images = env ? atoi (env) : N_SCRATCH_IMAGES_DEFAULT;
+      n_images = CLAMP (n_images, 2, N_SCRATCH_IMAGES_MAX);
+    }
+
+  return n_images;
+}
+
 static bboolean
 allocate_scratch_images (BdkScratchImageInfo *info,
 			 bint                 n_images,
@@ -416,7 +442,7 @@ allocate_scratch_images (BdkScratchImageInfo *info,
       info->static_image[i] = _bdk_image_new_for_depth (info->screen,
 							shared ? BDK_IMAGE_SHARED : BDK_IMAGE_NORMAL,
 							NULL,
-							BDK_SCRATCH_IMAGE_WIDTH * (N_REBUNNYIONS / n_images), 
+							BDK_SCRATCH_IMAGE_WIDTH,
 							BDK_SCRATCH_IMAGE_HEIGHT,
 							info->depth);
       
@@ -450,6 +476,7 @@ scratch_image_info_display_closed (BdkDisplay          *display,
   for (i = 0; i < image_info->n_images; i++)
     g_object_unref (image_info->static_image[i]);
 
+  g_free (image_info->static_image);
   g_free (image_info);
 }
 
@@ -459,7 +486,6 @@ scratch_image_info_for_depth (BdkScreen *screen,
 {
   GSList *tmp_list;
   BdkScratchImageInfo *image_info;
-  bint i;
 
   tmp_list = scratch_image_infos;
   while (tmp_list)
@@ -475,27 +501,21 @@ scratch_image_info_for_depth (BdkScreen *screen,
 
   image_info->depth = depth;
   image_info->screen = screen;
+  image_info->n_images = get_n_scratch_images ();
+  image_info->static_image = g_new (BdkImage *, image_info->n_images);
 
   g_signal_connect (bdk_screen_get_display (screen), "closed",
                     G_CALLBACK (scratch_image_info_display_closed),
                     image_info);
 
-  /* Try to allocate as few possible shared images */
-  for (i=0; i < G_N_ELEMENTS (possible_n_images); i++)
-    {
-      if (allocate_scratch_images (image_info, possible_n_images[i], TRUE))
-	{
-	  image_info->n_images = possible_n_images[i];
-	  break;
-	}
-    }
+  /* Try shared images first, if that fails, just allocate normal
+   * images
+   */
+  if (!allocate_scratch_images (image_info, image_info->n_images, TRUE))
+    allocate_scratch_images (image_info, image_info->n_images, FALSE);
 
-  /* If that fails, just allocate N_REBUNNYIONS normal images */
-  if (i == G_N_ELEMENTS (possible_n_images))
-    {
-      allocate_scratch_images (image_info, N_REBUNNYIONS, FALSE);
-      image_info->n_images = N_REBUNNYIONS;
-    }
+  /* None of the images has been drawn yet, so this doesn't block */
+  image_info->can_wait = _bdk_windowing_image_wait (image_info->static_image[0]);
 
   image_info->static_image_idx = 0;
 
@@ -521,18 +541,21 @@ static bint sincelast;
 static bint
 alloc_scratch_image (BdkScratchImageInfo *image_info)
 {
-  if (image_info->static_image_idx == N_REBUNNYIONS)
+  bint idx;
+
+  if (image_info->static_image_idx == image_info->n_images)
     {
 #ifndef NO_FLUSH
-      bdk_flush ();
+      if (!image_info->can_wait)
+	bdk_flush ();
 #endif
 #ifdef VERBOSE
-      g_print ("flush, %d puts since last flush\n", sincelast);
+      g_print ("wrap, %d puts since last wrap\n", sincelast);
       sincelast = 0;
 #endif
       image_info->static_image_idx = 0;
 
-      /* Mark all rebunnyions that we might be filling in as completely
+      /* Mark all images that we might be filling in as completely
        * full, to force new tiles to be allocated for subsequent
        * images
        */
@@ -541,7 +564,15 @@ alloc_scratch_image (BdkScratchImageInfo *image_info)
       image_info->tile_x = BDK_SCRATCH_IMAGE_WIDTH;
       image_info->tile_y1 = image_info->tile_y2 = BDK_SCRATCH_IMAGE_HEIGHT;
     }
-  return image_info->static_image_idx++;
+
+  idx = image_info->static_image_idx++;
+
+#ifndef NO_FLUSH
+  if (image_info->can_wait)
+    _bdk_windowing_image_wait (image_info->static_image[idx]);
+#endif
+
+  return idx;
 }
 
 /**
@@ -556,6 +587,10 @@ alloc_scratch_image (BdkScratchImageInfo *image_info)
  * Allocates an image of size width/height, up to a maximum
  * of BDK_SCRATCH_IMAGE_WIDTHxBDK_SCRATCH_IMAGE_HEIGHT that is
  * suitable to use on @screen.
+ *
+ * The returned area is not in use by any earlier drawing
+ * operation, but the image may be; the caller must only touch
+ * the pixels at @x, @y.
  * 
  * Return value: a scratch image. This must be used by a
  *  call to bdk_image_put() before any other calls to
@@ -636,8 +671,7 @@ _bdk_image_get_scratch (BdkScreen   *screen,
 	  image_info->tile_x += (width + 7) & -8;
 	}
     }
-  image = image_info->static_image[idx * image_info->n_images / N_REBUNNYIONS];
-  *x += BDK_SCRATCH_IMAGE_WIDTH * (idx % (N_REBUNNYIONS / image_info->n_images));
+  image = image_info->static_image[idx];
 #ifdef VERBOSE
   g_print ("index %d, x %d, y %d (%d x %d)\n", idx, *x, *y, width, height);
   sincelast++;
@@ -326,8 +326,8 @@ void bdk_synthesize_window_state (BdkWindow     *window,
                                   BdkWindowState unset_flags,
                                   BdkWindowState set_flags);
 
-#define BDK_SCRATCH_IMAGE_WIDTH 256
-#define BDK_SCRATCH_IMAGE_HEIGHT 64
+#define BDK_SCRATCH_IMAGE_WIDTH 1024
+#define BDK_SCRATCH_IMAGE_HEIGHT 128
 
 BdkImage* _bdk_image_new_for_depth (BdkScreen    *screen,
 				    BdkImageType  type,
@@ -342,6 +342,22 @@ BdkImage *_bdk_image_get_scratch (BdkScreen *screen,
 				  bint	    *x,
 				  bint	    *y);
 
+/* Waits until the windowing system is done reading the contents of
+ * @image for earlier bdk_draw_image() calls. Returns FALSE if that
+ * can't be tracked, bdk_flush() must be used instead then.
+ */
+bboolean _bdk_windowing_image_wait (BdkImage *image);
+
+/* Returns a reference to an image of exactly @width by @height that
+ * bdk_drawable_copy_to_image() can fill with a single request, reusing
+ * the memory of earlier calls where possible, or %NULL if the backend
+ * has no such images.
+ */
+BdkImage *_bdk_windowing_image_get_readback (BdkScreen *screen,
+					     bint       width,
+					     bint       height,
+					     bint       depth);
+
 BdkImage *_bdk_drawable_copy_to_image (BdkDrawable  *drawable,
 				       BdkImage     *image,
 				       bint          src_x,
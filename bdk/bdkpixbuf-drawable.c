@@ -34,6 +34,7 @@
 #include "bdkpixbuf.h"
 #include "bdkpixmap.h"
 #include "bdkinternals.h"
+#include "bdksimd.h"
 #include "bdkalias.h"
 
 /* Some convenient names
@@ -373,26 +374,13 @@ rgb8a (BdkImage    *image,
     }
 }
 
-/* Bit shifting for 565 and 555 conversion routines
+/* Bit shifting for 555 conversion routines; 565 and 888 are done by
+ * the unpacking loops in bdkpixbufconv.c
  *
- * RGB565 == rrrr rggg gggb bbbb, 16 bit native endian
  * RGB555 == xrrr rrgg gggb bbbb
  * ABGR8888: ARGB, 32-bit native endian
  * RGBA8888: RGBA, 32-bit native endian
  */
-#define R8fromRGB565(d) ((((d) >> 8) & 0xf8) | (((d) >> 13) & 0x7))
-#define G8fromRGB565(d) ((((d) >> 3) & 0xfc) | (((d) >> 9)  & 0x3))
-#define B8fromRGB565(d) ((((d) << 3) & 0xf8) | (((d) >> 2)  & 0x7))
-
-#define ABGR8888fromRGB565(d) (  ((d) & 0xf800) >> 8  | ((d) & 0xe000) >> 13 \
-			       | ((d) & 0x07e0) << 5  | ((d) & 0x0600) >> 1  \
-			       | ((d) & 0x001f) << 19 | ((d) & 0x001c) << 14 \
-			       | 0xff000000)
-#define RGBA8888fromRGB565(d) (  ((d) & 0xf800) << 16 | ((d) & 0xe000) << 11 \
-			       | ((d) & 0x07e0) << 13 | ((d) & 0x0600) << 7  \
-			       | ((d) & 0x001f) << 11 | ((d) & 0x001c) << 6  \
-			       | 0xff)
-
 #define R8fromRGB555(d) (((d) & 0x7c00) >> 7 | ((d) & 0x7000) >> 12)
 #define G8fromRGB555(d) (((d) & 0x03e0) >> 2 | ((d) & 0x0380) >> 7)
 #define B8fromRGB555(d) (((d) & 0x001f) << 3 | ((d) & 0x001c) >> 2)
@@ -406,182 +394,6 @@ rgb8a (BdkImage    *image,
 			       | ((d) & 0x001f) << 11 | ((d) & 0x001c) << 6  \
 			       | 0xff)
 
-/*
- * convert 16 bits/pixel data
- * no alpha
- * data in lsb format
- */
-static void
-rgb565lsb (BdkImage    *image,
-	   buchar      *pixels,
-	   int          rowstride,
-	   int          x1,
-	   int          y1,
-	   int          x2,
-	   int          y2,
-	   BdkColormap *colormap)
-{
-  int xx, yy;
-  int bpl;
-
-  register buint16 *s;
-  register buint8 *o;
-
-  buint8 *srow = (buint8*)image->mem + y1 * image->bpl + x1 * image->bpp, *orow = pixels;
-
-  bpl = image->bpl;
-
-  for (yy = y1; yy < y2; yy++)
-    {
-      s = (buint16 *) srow;
-      o = (buint8 *) orow;
-      for (xx = x1; xx < x2; xx ++)
-	{
-	  register buint32 data = *s++;
-#ifdef BIG
-	  data = SWAP16 (data);
-#endif	  
-	  *o++ = R8fromRGB565 (data);
-	  *o++ = G8fromRGB565 (data);
-	  *o++ = B8fromRGB565 (data);
-	}
-      srow += bpl;
-      orow += rowstride;
-    }
-}
-
-/*
- * convert 16 bits/pixel data
- * no alpha
- * data in msb format
- */
-static void
-rgb565msb (BdkImage    *image,
-	   buchar      *pixels,
-	   int          rowstride,
-           int          x1,
-           int          y1,
-           int          x2,
-           int          y2,
-	   BdkColormap *colormap)
-{
-  int xx, yy;
-  int bpl;
-
-  register buint16 *s;
-  register buint8 *o;
-
-  buint8 *srow = (buint8*)image->mem + y1 * image->bpl + x1 * image->bpp, *orow = pixels;
-
-  bpl = image->bpl;
-
-  for (yy = y1; yy < y2; yy++)
-    {
-      s = (buint16 *) srow;
-      o = (buint8 *) orow;
-      for (xx = x1; xx < x2; xx ++)
-	{
-	  register buint32 data = *s++;
-#ifdef LITTLE
-	  data = SWAP16 (data);
-#endif	  
-	  *o++ = R8fromRGB565 (data);
-	  *o++ = G8fromRGB565 (data);
-	  *o++ = B8fromRGB565 (data);
-	}
-      srow += bpl;
-      orow += rowstride;
-    }
-}
-
-/*
- * convert 16 bits/pixel data
- * with alpha
- * data in lsb format
- */
-static void
-rgb565alsb (BdkImage    *image,
-	    buchar      *pixels,
-	    int          rowstride,
-            int          x1,
-            int          y1,
-            int          x2,
-            int          y2,
-	    BdkColormap *colormap)
-{
-  int xx, yy;
-  int bpl;
-
-  register buint16 *s;
-  register buint32 *o;
-
-  buint8 *srow = (buint8*)image->mem + y1 * image->bpl + x1 * image->bpp, *orow = pixels;
-
-  bpl = image->bpl;
-
-  for (yy = y1; yy < y2; yy++)
-    {
-      s = (buint16 *) srow;
-      o = (buint32 *) orow;
-      for (xx = x1; xx < x2; xx ++)
-	{
-	  register buint32 data = *s++;
-#ifdef LITTLE
-	  *o++ = ABGR8888fromRGB565 (data);
-#else
-	  data = SWAP16 (data);
-	  *o++ = RGBA8888fromRGB565 (data);
-#endif
-	}
-      srow += bpl;
-      orow += rowstride;
-    }
-}
-
-/*
- * convert 16 bits/pixel data
- * with alpha
- * data in msb format
- */
-static void
-rgb565amsb (BdkImage    *image,
-	    buchar      *pixels,
-	    int          rowstride,
-            int          x1,
-            int          y1,
-            int          x2,
-            int          y2,
-	    BdkColormap *colormap)
-{
-  int xx, yy;
-  int bpl;
-
-  register buint16 *s;
-  register buint32 *o;
-
-  buint8 *srow = (buint8*)image->mem + y1 * image->bpl + x1 * image->bpp, *orow = pixels;
-
-  bpl = image->bpl;
-
-  for (yy = y1; yy < y2; yy++)
-    {
-      s = (buint16 *) srow;
-      o = (buint32 *) orow;
-      for (xx = x1; xx < x2; xx ++)
-	{
-	  register buint32 data = *s++;
-#ifdef LITTLE
-	  data = SWAP16 (data);
-	  *o++ = ABGR8888fromRGB565 (data);
-#else
-	  *o++ = RGBA8888fromRGB565 (data);
-#endif
-	}
-      srow += bpl;
-      orow += rowstride;
-    }
-}
-
 /*
  * convert 15 bits/pixel data
  * no alpha
@@ -758,158 +570,6 @@ rgb555amsb (BdkImage    *image,
     }
 }
 
-
-static void
-rgb888alsb (BdkImage    *image,
-	    buchar      *pixels,
-	    int          rowstride,
-            int          x1,
-            int          y1,
-            int          x2,
-            int          y2,
-	    BdkColormap *colormap)
-{
-  int xx, yy;
-  int bpl;
-
-  buint8 *s;	/* for byte order swapping */
-  buint8 *o;
-  buint8 *srow = (buint8*)image->mem + y1 * image->bpl + x1 * image->bpp, *orow = pixels;
-
-  bpl = image->bpl;
-
-  d (printf ("32 bits/pixel with alpha\n"));
-
-  /* lsb data */
-  for (yy = y1; yy < y2; yy++)
-    {
-      s = srow;
-      o = orow;
-      for (xx = x1; xx < x2; xx++)
-	{
-	  *o++ = s[2];
-	  *o++ = s[1];
-	  *o++ = s[0];
-	  *o++ = 0xff;
-	  s += 4;
-	}
-      srow += bpl;
-      orow += rowstride;
-    }
-}
-
-static void
-rgb888lsb (BdkImage    *image,
-	   buchar      *pixels,
-	   int          rowstride,
-           int          x1,
-           int          y1,
-           int          x2,
-           int          y2,
-	   BdkColormap *colormap)
-{
-  int xx, yy;
-  int bpl;
-
-  buint8 *srow = (buint8*)image->mem + y1 * image->bpl + x1 * image->bpp, *orow = pixels;
-  buint8 *o, *s;
-
-  bpl = image->bpl;
-
-  d (printf ("32 bit, lsb, no alpha\n"));
-
-  for (yy = y1; yy < y2; yy++)
-    {
-      s = srow;
-      o = orow;
-      for (xx = x1; xx < x2; xx++)
-	{
-	  *o++ = s[2];
-	  *o++ = s[1];
-	  *o++ = s[0];
-	  s += 4;
-	}
-      srow += bpl;
-      orow += rowstride;
-    }
-}
-
-static void
-rgb888amsb (BdkImage    *image,
-	    buchar      *pixels,
-	    int          rowstride,
-            int          x1,
-            int          y1,
-            int          x2,
-            int          y2,
-	    BdkColormap *colormap)
-{
-  int xx, yy;
-  int bpl;
-
-  buint8 *srow = (buint8*)image->mem + y1 * image->bpl + x1 * image->bpp, *orow = pixels;
-  buint32 *o;
-  buint32 *s;
-
-  d (printf ("32 bit, msb, with alpha\n"));
-
-  bpl = image->bpl;
-
-  /* msb data */
-  for (yy = y1; yy < y2; yy++)
-    {
-      s = (buint32 *) srow;
-      o = (buint32 *) orow;
-      for (xx = x1; xx < x2; xx++)
-	{
-#ifdef LITTLE
-	  *o++ = (*s++ >> 8) | 0xff000000;
-#else
-	  *o++ = (*s++ << 8) | 0xff;
-#endif
-	}
-      srow += bpl;
-      orow += rowstride;
-    }
-}
-
-static void
-rgb888msb (BdkImage    *image,
-	   buchar      *pixels,
-	   int          rowstride,
-           int          x1,
-           int          y1,
-           int          x2,
-           int          y2,
-	   BdkColormap *colormap)
-{
-  int xx, yy;
-  int bpl;
-
-  buint8 *srow = (buint8*)image->mem + y1 * image->bpl + x1 * image->bpp, *orow = pixels;
-  buint8 *s;
-  buint8 *o;
-
-  d (printf ("32 bit, msb, no alpha\n"));
-
-  bpl = image->bpl;
-
-  for (yy = y1; yy < y2; yy++)
-    {
-      s = srow;
-      o = orow;
-      for (xx = x1; xx < x2; xx++)
-	{
-	  *o++ = s[1];
-	  *o++ = s[2];
-	  *o++ = s[3];
-	  s += 4;
-	}
-      srow += bpl;
-      orow += rowstride;
-    }
-}
-
 /*
  * This should work correctly with any display/any endianness, but will probably
  * run quite slow
@@ -1008,11 +668,38 @@ typedef void (* cfunc) (BdkImage    *image,
 static const cfunc convert_map[] = {
   rgb1,rgb1,rgb1a,rgb1a,
   rgb8,rgb8,rgb8a,rgb8a,
-  rgb555lsb,rgb555msb,rgb555alsb,rgb555amsb,
-  rgb565lsb,rgb565msb,rgb565alsb,rgb565amsb,
-  rgb888lsb,rgb888msb,rgb888alsb,rgb888amsb
+  rgb555lsb,rgb555msb,rgb555alsb,rgb555amsb
 };
 
+/*
+ * convert 16 and 32 bits/pixel truecolor data a row at a time, with
+ * the vector loops if the CPU has them
+ */
+static void
+unpack_rows (BdkImage           *image,
+	     buchar             *pixels,
+	     int                 rowstride,
+	     bboolean            alpha,
+	     int                 x,
+	     int                 y,
+	     int                 width,
+	     int                 height,
+	     BdkUnpackRowFormat  format)
+{
+  BdkUnpackRowFunc func;
+  const buchar *srow;
+
+  func = _bdk_unpack_row_get_func (format, alpha, _bdk_simd_get_flags ());
+  srow = (const buchar *) image->mem + y * image->bpl + x * image->bpp;
+
+  for (; height > 0; height--)
+    {
+      (* func) (srow, pixels, width);
+      srow += image->bpl;
+      pixels += rowstride;
+    }
+}
+
 /*
  * perform actual conversion
  *
@@ -1121,6 +808,18 @@ rgbconvert (BdkImage    *image,
                          x, y, x + width, y + height,                         
                          cmap, alpha);
     }
+  else if (bank == 3)
+    {
+      unpack_rows (image, pixels, rowstride, alpha, x, y, width, height,
+                   image->byte_order == BDK_MSB_FIRST ?
+                   BDK_UNPACK_ROW_565_MSB : BDK_UNPACK_ROW_565_LSB);
+    }
+  else if (bank == 4)
+    {
+      unpack_rows (image, pixels, rowstride, alpha, x, y, width, height,
+                   image->byte_order == BDK_MSB_FIRST ?
+                   BDK_UNPACK_ROW_0888_MSB : BDK_UNPACK_ROW_0888_LSB);
+    }
   else
     {
       index |= bank << 2;
@@ -1287,6 +986,28 @@ bdk_pixbuf_get_from_drawable (BdkPixbuf   *dest,
       g_return_val_if_fail (dest_y + height <= bdk_pixbuf_get_height (dest), NULL);
     }
 
+  /* Where the windowing system can fill a shared image with one
+   * request, get the whole area at once; otherwise go through the
+   * scratch images a tile at a time.
+   */
+  if (width > 0 && height > 0)
+    {
+      image = _bdk_windowing_image_get_readback (bdk_drawable_get_screen (src),
+                                                 width, height, depth);
+      if (image)
+        {
+          bdk_drawable_copy_to_image (src, image,
+                                      src_x, src_y, 0, 0, width, height);
+
+          bdk_pixbuf_get_from_image (dest, image, cmap,
+                                     0, 0, dest_x, dest_y, width, height);
+
+          g_object_unref (image);
+
+          return dest;
+        }
+    }
+
   for (y0 = 0; y0 < height; y0 += BDK_SCRATCH_IMAGE_HEIGHT)
     {
       bint height1 = MIN (height - y0, BDK_SCRATCH_IMAGE_HEIGHT);
@@ -21,6 +21,7 @@
  */
 
 #include "config.h"
+#include <string.h>
 #include <bdk/bdk.h>
 #include <bdk-pixbuf/bdk-pixbuf.h>
 #include "bdkpixbuf.h"
@@ -28,6 +29,564 @@
 #include "bdkinternals.h"
 #include "bdkalias.h"
 
+/* Server side copies of pixbufs for the functions below, which are
+ * called over and over with the same pixbuf for window icons, DND
+ * icons and the like. Pixbufs have no generation count, so their
+ * pixels are compared with a copy of the ones the server side copies
+ * were made from; that is much cheaper than converting and uploading
+ * them again.
+ *
+ * A pixbuf gets server side copies the second time it is seen with the
+ * same contents, so that pixbufs that are drawn only once don't pay
+ * for them. Until then only a checksum of its pixels is kept. The
+ * total size of the copies, including the copy of the pixels, is
+ * limited; pixbufs that have copies are kept in a LRU list for that.
+ */
+#define PIXBUF_CACHE_SIZE (8 * 1024 * 1024)
+#define PIXBUF_CACHE_MAX_ENTRY_SIZE (PIXBUF_CACHE_SIZE / 4)
+
+typedef struct _BdkPixbufCacheEntry BdkPixbufCacheEntry;
+
+struct _BdkPixbufCacheEntry
+{
+  BdkPixbuf *pixbuf;
+  GList link;                   /* In pixbuf_cache_lru if pixels is set */
+  buint32 checksum;
+  bsize size;
+
+  /* The pixels the copies below were made from, without padding */
+  buchar *pixels;
+
+  /* The pixbuf rendered as by bdk_pixbuf_render_pixmap_and_mask_for_colormap()
+   * for colormap
+   */
+  BdkColormap *colormap;
+  BdkPixmap *pixmap;
+  BdkBitmap *mask;
+  bint mask_threshold;
+
+  /* For pixbufs with alpha, a surface for bairo to composite from */
+  BdkScreen *screen;
+  bairo_surface_t *surface;
+};
+
+static GQuark pixbuf_cache_quark = 0;
+static GQueue pixbuf_cache_lru = G_QUEUE_INIT;
+static bsize pixbuf_cache_size = 0;
+
+static bsize
+pixbuf_row_size (BdkPixbuf *pixbuf)
+{
+  return bdk_pixbuf_get_width (pixbuf) * bdk_pixbuf_get_n_channels (pixbuf);
+}
+
+static bsize
+pixbuf_pixmap_size (BdkPixbuf *pixbuf)
+{
+  return (bsize) bdk_pixbuf_get_width (pixbuf) * bdk_pixbuf_get_height (pixbuf) * 4;
+}
+
+static bsize
+pixbuf_mask_size (BdkPixbuf *pixbuf)
+{
+  return (bsize) (bdk_pixbuf_get_width (pixbuf) + 7) / 8 * bdk_pixbuf_get_height (pixbuf);
+}
+
+static buint32
+pixbuf_checksum (BdkPixbuf *pixbuf)
+{
+  bint height = bdk_pixbuf_get_height (pixbuf);
+  bint rowstride = bdk_pixbuf_get_rowstride (pixbuf);
+  bint row_size = pixbuf_row_size (pixbuf);
+  const buchar *row = bdk_pixbuf_get_pixels (pixbuf);
+  buint32 checksum = 2166136261u;
+  bint x, y;
+
+  /* FNV-1a on 32 bit words. Every step is a bijection, so changing a
+   * single word always changes the result.
+   */
+  for (y = 0; y < height; y++)
+    {
+      for (x = 0; x + 4 <= row_size; x += 4)
+	{
+	  buint32 word;
+
+	  memcpy (&word, row + x, 4);
+	  checksum = (checksum ^ word) * 16777619u;
+	}
+      for (; x < row_size; x++)
+	checksum = (checksum ^ row[x]) * 16777619u;
+
+      row += rowstride;
+    }
+
+  return checksum;
+}
+
+/* Returns whether the pixels of the pixbuf of @entry are still the
+ * ones its copies were made from
+ */
+static bboolean
+pixbuf_cache_entry_matches (BdkPixbufCacheEntry *entry)
+{
+  bint height = bdk_pixbuf_get_height (entry->pixbuf);
+  bint rowstride = bdk_pixbuf_get_rowstride (entry->pixbuf);
+  bsize row_size = pixbuf_row_size (entry->pixbuf);
+  const buchar *row = bdk_pixbuf_get_pixels (entry->pixbuf);
+  const buchar *copy = entry->pixels;
+  bint y;
+
+  for (y = 0; y < height; y++)
+    {
+      if (memcmp (row, copy, row_size) != 0)
+	return FALSE;
+
+      row += rowstride;
+      copy += row_size;
+    }
+
+  return TRUE;
+}
+
+static void
+pixbuf_cache_entry_clear (BdkPixbufCacheEntry *entry)
+{
+  if (entry->pixmap)
+    g_object_unref (entry->pixmap);
+  if (entry->mask)
+    g_object_unref (entry->mask);
+  if (entry->colormap)
+    g_object_unref (entry->colormap);
+  if (entry->surface)
+    bairo_surface_destroy (entry->surface);
+
+  if (entry->pixels)
+    {
+      g_free (entry->pixels);
+      g_queue_unlink (&pixbuf_cache_lru, &entry->link);
+    }
+
+  entry->pixmap = NULL;
+  entry->mask = NULL;
+  entry->colormap = NULL;
+  entry->surface = NULL;
+  entry->screen = NULL;
+  entry->pixels = NULL;
+
+  pixbuf_cache_size -= entry->size;
+  entry->size = 0;
+}
+
+static void
+pixbuf_cache_entry_free (BdkPixbufCacheEntry *entry)
+{
+  pixbuf_cache_entry_clear (entry);
+
+  g_slice_free (BdkPixbufCacheEntry, entry);
+}
+
+static void
+pixbuf_cache_entry_add_size (BdkPixbufCacheEntry *entry,
+			     bsize                size)
+{
+  GList *l;
+
+  entry->size += size;
+  pixbuf_cache_size += size;
+
+  /* Drop the copies of the least recently used pixbufs until we
+   * are within the limit again
+   */
+  l = pixbuf_cache_lru.tail;
+  while (pixbuf_cache_size > PIXBUF_CACHE_SIZE && l)
+    {
+      BdkPixbufCacheEntry *lru_entry = l->data;
+
+      l = l->prev;
+      if (lru_entry != entry)
+	pixbuf_cache_entry_clear (lru_entry);
+    }
+}
+
+static void
+pixbuf_cache_entry_remove_size (BdkPixbufCacheEntry *entry,
+				bsize                size)
+{
+  entry->size -= size;
+  pixbuf_cache_size -= size;
+}
+
+/* Keeps a copy of the pixels of the pixbuf of @entry, which its
+ * server side copies are going to be made from
+ */
+static void
+pixbuf_cache_entry_keep_pixels (BdkPixbufCacheEntry *entry)
+{
+  bint height = bdk_pixbuf_get_height (entry->pixbuf);
+  bint rowstride = bdk_pixbuf_get_rowstride (entry->pixbuf);
+  bsize row_size = pixbuf_row_size (entry->pixbuf);
+  const buchar *row = bdk_pixbuf_get_pixels (entry->pixbuf);
+  buchar *copy;
+  bint y;
+
+  entry->pixels = g_malloc (row_size * height);
+  for (y = 0, copy = entry->pixels; y < height; y++)
+    {
+      memcpy (copy, row, row_size);
+
+      row += rowstride;
+      copy += row_size;
+    }
+
+  g_queue_push_head_link (&pixbuf_cache_lru, &entry->link);
+  pixbuf_cache_entry_add_size (entry, row_size * height);
+}
+
+/* Returns the cache entry of @pixbuf if it was seen before with the
+ * same contents, otherwise remembers its contents and returns %NULL.
+ */
+static BdkPixbufCacheEntry *
+pixbuf_cache_lookup (BdkPixbuf *pixbuf)
+{
+  BdkPixbufCacheEntry *entry;
+  buint32 checksum;
+
+  if (pixbuf_pixmap_size (pixbuf) > PIXBUF_CACHE_MAX_ENTRY_SIZE)
+    return NULL;
+
+  if (!pixbuf_cache_quark)
+    pixbuf_cache_quark = g_quark_from_static_string ("bdk-pixbuf-render-cache");
+
+  entry = g_object_get_qdata (B_OBJECT (pixbuf), pixbuf_cache_quark);
+  if (entry && entry->pixels)
+    {
+      if (pixbuf_cache_entry_matches (entry))
+	{
+	  g_queue_unlink (&pixbuf_cache_lru, &entry->link);
+	  g_queue_push_head_link (&pixbuf_cache_lru, &entry->link);
+
+	  return entry;
+	}
+
+      /* The pixels were changed behind our back */
+      pixbuf_cache_entry_clear (entry);
+      entry->checksum = pixbuf_checksum (pixbuf);
+
+      return NULL;
+    }
+
+  checksum = pixbuf_checksum (pixbuf);
+
+  if (!entry)
+    {
+      entry = g_slice_new0 (BdkPixbufCacheEntry);
+      entry->pixbuf = pixbuf;
+      entry->link.data = entry;
+      entry->checksum = checksum;
+
+      g_object_set_qdata_full (B_OBJECT (pixbuf), pixbuf_cache_quark,
+			       entry, (GDestroyNotify) pixbuf_cache_entry_free);
+
+      return NULL;
+    }
+
+  if (entry->checksum != checksum)
+    {
+      entry->checksum = checksum;
+
+      return NULL;
+    }
+
+  /* Seen the second time with the same contents. The checksum only
+   * told us that they are likely the same; from now on they are
+   * compared with the copy.
+   */
+  pixbuf_cache_entry_keep_pixels (entry);
+
+  return entry;
+}
+
+static void
+pixbuf_cache_display_closed (BdkDisplay *display,
+			     bboolean    is_error,
+			     bpointer    data)
+{
+  GList *l;
+
+  l = pixbuf_cache_lru.head;
+  while (l)
+    {
+      BdkPixbufCacheEntry *entry = l->data;
+
+      l = l->next;
+      if ((entry->colormap &&
+	   bdk_screen_get_display (bdk_colormap_get_screen (entry->colormap)) == display) ||
+	  (entry->screen && bdk_screen_get_display (entry->screen) == display))
+	pixbuf_cache_entry_clear (entry);
+    }
+}
+
+/* Makes sure the copies on @screen go away when its display is closed */
+static void
+pixbuf_cache_watch_screen (BdkScreen *screen)
+{
+  BdkDisplay *display = bdk_screen_get_display (screen);
+
+  if (g_object_get_qdata (B_OBJECT (display), pixbuf_cache_quark))
+    return;
+
+  g_object_set_qdata (B_OBJECT (display), pixbuf_cache_quark, BINT_TO_POINTER (TRUE));
+  g_signal_connect (display, "closed",
+		    G_CALLBACK (pixbuf_cache_display_closed), NULL);
+}
+
+static BdkPixmap *
+render_pixmap (BdkPixbuf   *pixbuf,
+	       BdkColormap *colormap)
+{
+  BdkScreen *screen = bdk_colormap_get_screen (colormap);
+  BdkPixmap *pixmap;
+  BdkGC *gc;
+
+  pixmap = bdk_pixmap_new (bdk_screen_get_root_window (screen),
+			   bdk_pixbuf_get_width (pixbuf), bdk_pixbuf_get_height (pixbuf),
+			   bdk_colormap_get_visual (colormap)->depth);
+
+  bdk_drawable_set_colormap (BDK_DRAWABLE (pixmap), colormap);
+  gc = _bdk_drawable_get_scratch_gc (pixmap, FALSE);
+
+  /* If the pixbuf has an alpha channel, using bdk_pixbuf_draw would give
+   * random pixel values in the area that are within the mask, but semi-
+   * transparent. So we treat the pixbuf like a pixbuf without alpha channel;
+   * see bug #487865.
+   */
+  if (bdk_pixbuf_get_has_alpha (pixbuf))
+    bdk_draw_rgb_32_image (pixmap, gc,
+			   0, 0,
+			   bdk_pixbuf_get_width (pixbuf), bdk_pixbuf_get_height (pixbuf),
+			   BDK_RGB_DITHER_NORMAL,
+			   bdk_pixbuf_get_pixels (pixbuf), bdk_pixbuf_get_rowstride (pixbuf));
+  else
+    bdk_draw_pixbuf (pixmap, gc, pixbuf,
+		     0, 0, 0, 0,
+		     bdk_pixbuf_get_width (pixbuf), bdk_pixbuf_get_height (pixbuf),
+		     BDK_RGB_DITHER_NORMAL,
+		     0, 0);
+
+  return pixmap;
+}
+
+static BdkBitmap *
+render_mask (BdkPixbuf *pixbuf,
+	     BdkScreen *screen,
+	     bint       alpha_threshold)
+{
+  BdkBitmap *mask;
+
+  mask = bdk_pixmap_new (bdk_screen_get_root_window (screen),
+			 bdk_pixbuf_get_width (pixbuf), bdk_pixbuf_get_height (pixbuf), 1);
+
+  bdk_pixbuf_render_threshold_alpha (pixbuf, mask,
+				     0, 0, 0, 0,
+				     bdk_pixbuf_get_width (pixbuf), bdk_pixbuf_get_height (pixbuf),
+				     alpha_threshold);
+
+  return mask;
+}
+
+static BdkPixmap *
+copy_pixmap (BdkPixmap   *pixmap,
+	     BdkColormap *colormap)
+{
+  BdkPixmap *copy;
+  bint width, height;
+
+  bdk_drawable_get_size (pixmap, &width, &height);
+
+  copy = bdk_pixmap_new (pixmap, width, height, -1);
+  if (colormap)
+    bdk_drawable_set_colormap (BDK_DRAWABLE (copy), colormap);
+
+  bdk_draw_drawable (copy, _bdk_drawable_get_scratch_gc (copy, FALSE),
+		     pixmap, 0, 0, 0, 0, width, height);
+
+  return copy;
+}
+
+static void
+pixbuf_cache_set_colormap (BdkPixbufCacheEntry *entry,
+			   BdkColormap         *colormap)
+{
+  if (entry->colormap == colormap)
+    return;
+
+  if (entry->pixmap)
+    {
+      g_object_unref (entry->pixmap);
+      pixbuf_cache_entry_remove_size (entry, pixbuf_pixmap_size (entry->pixbuf));
+    }
+  if (entry->mask)
+    {
+      g_object_unref (entry->mask);
+      pixbuf_cache_entry_remove_size (entry, pixbuf_mask_size (entry->pixbuf));
+    }
+  if (entry->colormap)
+    g_object_unref (entry->colormap);
+
+  entry->pixmap = NULL;
+  entry->mask = NULL;
+  entry->colormap = g_object_ref (colormap);
+
+  pixbuf_cache_watch_screen (bdk_colormap_get_screen (colormap));
+}
+
+static BdkPixmap *
+pixbuf_cache_get_pixmap (BdkPixbufCacheEntry *entry,
+			 BdkColormap         *colormap)
+{
+  pixbuf_cache_set_colormap (entry, colormap);
+
+  if (!entry->pixmap)
+    {
+      entry->pixmap = render_pixmap (entry->pixbuf, colormap);
+      pixbuf_cache_entry_add_size (entry, pixbuf_pixmap_size (entry->pixbuf));
+    }
+
+  return entry->pixmap;
+}
+
+static BdkBitmap *
+pixbuf_cache_get_mask (BdkPixbufCacheEntry *entry,
+		       BdkColormap         *colormap,
+		       bint                 alpha_threshold)
+{
+  pixbuf_cache_set_colormap (entry, colormap);
+
+  if (entry->mask && entry->mask_threshold != alpha_threshold)
+    {
+      g_object_unref (entry->mask);
+      entry->mask = NULL;
+      pixbuf_cache_entry_remove_size (entry, pixbuf_mask_size (entry->pixbuf));
+    }
+
+  if (!entry->mask)
+    {
+      entry->mask = render_mask (entry->pixbuf, bdk_colormap_get_screen (colormap),
+				 alpha_threshold);
+      entry->mask_threshold = alpha_threshold;
+      pixbuf_cache_entry_add_size (entry, pixbuf_mask_size (entry->pixbuf));
+    }
+
+  return entry->mask;
+}
+
+static bairo_surface_t *
+pixbuf_cache_get_surface (BdkPixbufCacheEntry *entry,
+			  BdkScreen           *screen,
+			  bairo_t             *cr)
+{
+  if (entry->surface && entry->screen != screen)
+    {
+      bairo_surface_destroy (entry->surface);
+      entry->surface = NULL;
+      pixbuf_cache_entry_remove_size (entry, pixbuf_pixmap_size (entry->pixbuf));
+    }
+
+  if (!entry->surface)
+    {
+      bint width = bdk_pixbuf_get_width (entry->pixbuf);
+      bint height = bdk_pixbuf_get_height (entry->pixbuf);
+      bairo_t *tmp_cr;
+
+      entry->surface = bairo_surface_create_similar (bairo_get_target (cr),
+						     BAIRO_CONTENT_COLOR_ALPHA,
+						     width, height);
+      entry->screen = screen;
+      pixbuf_cache_watch_screen (screen);
+
+      tmp_cr = bairo_create (entry->surface);
+      bairo_set_operator (tmp_cr, BAIRO_OPERATOR_SOURCE);
+      bdk_bairo_set_source_pixbuf (tmp_cr, entry->pixbuf, 0, 0);
+      bairo_paint (tmp_cr);
+      bairo_destroy (tmp_cr);
+
+      pixbuf_cache_entry_add_size (entry, pixbuf_pixmap_size (entry->pixbuf));
+    }
+
+  return entry->surface;
+}
+
+/* Draws from the cached copies of @pixbuf if it has them, and if the
+ * result is the same as from bdk_draw_pixbuf(). It isn't when BdkRGB
+ * would dither, or for compositing with a clip mask in @gc.
+ */
+static bboolean
+draw_pixbuf_cached (BdkDrawable *drawable,
+		    BdkGC       *gc,
+		    BdkPixbuf   *pixbuf,
+		    bint         src_x,
+		    bint         src_y,
+		    bint         dest_x,
+		    bint         dest_y,
+		    bint         width,
+		    bint         height)
+{
+  BdkPixbufCacheEntry *entry;
+  BdkColormap *colormap;
+  BdkVisual *visual;
+
+  if (!BDK_IS_PIXBUF (pixbuf) || !BDK_IS_DRAWABLE (drawable))
+    return FALSE;
+
+  if (width == -1)
+    width = bdk_pixbuf_get_width (pixbuf);
+  if (height == -1)
+    height = bdk_pixbuf_get_height (pixbuf);
+
+  /* Leave the warnings for bad arguments to bdk_draw_pixbuf() */
+  if (width <= 0 || height <= 0 ||
+      src_x < 0 || src_x + width > bdk_pixbuf_get_width (pixbuf) ||
+      src_y < 0 || src_y + height > bdk_pixbuf_get_height (pixbuf))
+    return FALSE;
+
+  if (bdk_pixbuf_get_has_alpha (pixbuf) && gc)
+    return FALSE;
+
+  colormap = bdk_drawable_get_colormap (drawable);
+  if (!colormap)
+    return FALSE;
+
+  visual = bdk_colormap_get_visual (colormap);
+  if (visual->type != BDK_VISUAL_TRUE_COLOR || visual->depth < 24)
+    return FALSE;
+
+  entry = pixbuf_cache_lookup (pixbuf);
+  if (!entry)
+    return FALSE;
+
+  if (bdk_pixbuf_get_has_alpha (pixbuf))
+    {
+      bairo_t *cr = bdk_bairo_create (drawable);
+
+      bairo_set_source_surface (cr,
+				pixbuf_cache_get_surface (entry, bdk_drawable_get_screen (drawable), cr),
+				dest_x - src_x, dest_y - src_y);
+      bairo_rectangle (cr, dest_x, dest_y, width, height);
+      bairo_fill (cr);
+      bairo_destroy (cr);
+    }
+  else
+    {
+      if (!gc)
+	gc = _bdk_drawable_get_scratch_gc (drawable, FALSE);
+
+      bdk_draw_drawable (drawable, gc, pixbuf_cache_get_pixmap (entry, colormap),
+			 src_x, src_y, dest_x, dest_y, width, height);
+    }
+
+  return TRUE;
+}
+
 
 
 /**
@@ -178,6 +737,10 @@ bdk_pixbuf_render_to_drawable (BdkPixbuf   *pixbuf,
 			       BdkRgbDither dither,
 			       int x_dither, int y_dither)
 {
+  if (draw_pixbuf_cached (drawable, gc, pixbuf,
+			  src_x, src_y, dest_x, dest_y, width, height))
+    return;
+
   bdk_draw_pixbuf (drawable, gc, pixbuf,
 		   src_x, src_y, dest_x, dest_y, width, height,
 		   dither, x_dither, y_dither);
@@ -222,6 +785,10 @@ bdk_pixbuf_render_to_drawable_alpha (BdkPixbuf   *pixbuf,
 				     BdkRgbDither       dither,
 				     int x_dither, int y_dither)
 {
+  if (draw_pixbuf_cached (drawable, NULL, pixbuf,
+			  src_x, src_y, dest_x, dest_y, width, height))
+    return;
+
   bdk_draw_pixbuf (drawable, NULL, pixbuf,
 		   src_x, src_y, dest_x, dest_y, width, height,
 		   dither, x_dither, y_dither);
@@ -292,56 +859,36 @@ bdk_pixbuf_render_pixmap_and_mask_for_colormap (BdkPixbuf   *pixbuf,
 						BdkBitmap  **mask_return,
 						int          alpha_threshold)
 {
+  BdkPixbufCacheEntry *entry;
   BdkScreen *screen;
 
   g_return_if_fail (BDK_IS_PIXBUF (pixbuf));
   g_return_if_fail (BDK_IS_COLORMAP (colormap));
 
   screen = bdk_colormap_get_screen (colormap);
-  
+  entry = pixbuf_cache_lookup (pixbuf);
+
+  /* The caller owns the returned pixmaps, so with cached copies
+   * we make server side copies of them.
+   */
   if (pixmap_return)
     {
-      BdkGC *gc;
-      *pixmap_return = bdk_pixmap_new (bdk_screen_get_root_window (screen),
-				       bdk_pixbuf_get_width (pixbuf), bdk_pixbuf_get_height (pixbuf),
-				       bdk_colormap_get_visual (colormap)->depth);
-
-      bdk_drawable_set_colormap (BDK_DRAWABLE (*pixmap_return), colormap);
-      gc = _bdk_drawable_get_scratch_gc (*pixmap_return, FALSE);
-
-      /* If the pixbuf has an alpha channel, using bdk_pixbuf_draw would give
-       * random pixel values in the area that are within the mask, but semi-
-       * transparent. So we treat the pixbuf like a pixbuf without alpha channel;
-       * see bug #487865.
-       */
-      if (bdk_pixbuf_get_has_alpha (pixbuf))
-        bdk_draw_rgb_32_image (*pixmap_return, gc,
-                               0, 0,
-                               bdk_pixbuf_get_width (pixbuf), bdk_pixbuf_get_height (pixbuf),
-                               BDK_RGB_DITHER_NORMAL,
-                               bdk_pixbuf_get_pixels (pixbuf), bdk_pixbuf_get_rowstride (pixbuf));
+      if (entry)
+	*pixmap_return = copy_pixmap (pixbuf_cache_get_pixmap (entry, colormap),
+				      colormap);
       else
-        bdk_draw_pixbuf (*pixmap_return, gc, pixbuf, 
-                         0, 0, 0, 0,
-                         bdk_pixbuf_get_width (pixbuf), bdk_pixbuf_get_height (pixbuf),
-                         BDK_RGB_DITHER_NORMAL,
-                         0, 0);
+	*pixmap_return = render_pixmap (pixbuf, colormap);
     }
   
   if (mask_return)
     {
-      if (bdk_pixbuf_get_has_alpha (pixbuf))
-	{
-	  *mask_return = bdk_pixmap_new (bdk_screen_get_root_window (screen),
-					 bdk_pixbuf_get_width (pixbuf), bdk_pixbuf_get_height (pixbuf), 1);
-
-	  bdk_pixbuf_render_threshold_alpha (pixbuf, *mask_return,
-					     0, 0, 0, 0,
-					     bdk_pixbuf_get_width (pixbuf), bdk_pixbuf_get_height (pixbuf),
-					     alpha_threshold);
-	}
-      else
+      if (!bdk_pixbuf_get_has_alpha (pixbuf))
 	*mask_return = NULL;
+      else if (entry)
+	*mask_return = copy_pixmap (pixbuf_cache_get_mask (entry, colormap, alpha_threshold),
+				    NULL);
+      else
+	*mask_return = render_mask (pixbuf, screen, alpha_threshold);
     }
 }
 
@@ -0,0 +1,797 @@
+/* BDK - The GIMP Drawing Kit
+ * Copyright (C) 1995-1997 Peter Mattis, Spencer Kimball and Josh MacDonald
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/*
+ * Modified by the BTK+ Team and others 1997-2000.  See the AUTHORS
+ * file for a list of people on the BTK+ Team.  See the ChangeLog
+ * files for a list of changes.  These files are distributed with
+ * BTK+ at ftp://ftp.btk.org/pub/btk/.
+ */
+
+/* Row unpacking loops from image data to pixbuf data
+ *
+ * These are used by bdk_pixbuf_get_from_image() for the 24/32 bit
+ * 0x00rrggbb and the 16 bit 5-6-5 truecolor visuals.  The plain C
+ * versions give the same results as the rgb888* and rgb565*
+ * converters in bdkpixbuf-drawable.c, but read the source a byte at
+ * a time so they don't depend on the host byte order.
+ *
+ * The 5-6-5 channels are widened by replicating their top bits into
+ * the bottom ones, so that 0x1f becomes 0xff.
+ */
+
+#include "config.h"
+
+#include "bdksimd.h"
+
+#ifdef BDK_SIMD_X86
+#include <immintrin.h>
+#endif
+
+#ifdef BDK_SIMD_ARM_NEON
+#include <arm_neon.h>
+#endif
+
+/* Plain C */
+
+static inline void
+unpack_565 (buint   d,
+	    buchar *o)
+{
+  o[0] = ((d >> 8) & 0xf8) | ((d >> 13) & 0x7);
+  o[1] = ((d >> 3) & 0xfc) | ((d >> 9) & 0x3);
+  o[2] = ((d << 3) & 0xf8) | ((d >> 2) & 0x7);
+}
+
+static void
+row_0888_lsb (const buchar *src,
+	      buchar       *dest,
+	      bint          width)
+{
+  for (; width > 0; width--, src += 4, dest += 3)
+    {
+      dest[0] = src[2];
+      dest[1] = src[1];
+      dest[2] = src[0];
+    }
+}
+
+static void
+row_0888_lsb_a (const buchar *src,
+		buchar       *dest,
+		bint          width)
+{
+  for (; width > 0; width--, src += 4, dest += 4)
+    {
+      dest[0] = src[2];
+      dest[1] = src[1];
+      dest[2] = src[0];
+      dest[3] = 0xff;
+    }
+}
+
+static void
+row_0888_msb (const buchar *src,
+	      buchar       *dest,
+	      bint          width)
+{
+  for (; width > 0; width--, src += 4, dest += 3)
+    {
+      dest[0] = src[1];
+      dest[1] = src[2];
+      dest[2] = src[3];
+    }
+}
+
+static void
+row_0888_msb_a (const buchar *src,
+		buchar       *dest,
+		bint          width)
+{
+  for (; width > 0; width--, src += 4, dest += 4)
+    {
+      dest[0] = src[1];
+      dest[1] = src[2];
+      dest[2] = src[3];
+      dest[3] = 0xff;
+    }
+}
+
+static void
+row_565_lsb (const buchar *src,
+	     buchar       *dest,
+	     bint          width)
+{
+  for (; width > 0; width--, src += 2, dest += 3)
+    unpack_565 (src[0] | (src[1] << 8), dest);
+}
+
+static void
+row_565_lsb_a (const buchar *src,
+	       buchar       *dest,
+	       bint          width)
+{
+  for (; width > 0; width--, src += 2, dest += 4)
+    {
+      unpack_565 (src[0] | (src[1] << 8), dest);
+      dest[3] = 0xff;
+    }
+}
+
+static void
+row_565_msb (const buchar *src,
+	     buchar       *dest,
+	     bint          width)
+{
+  for (; width > 0; width--, src += 2, dest += 3)
+    unpack_565 ((src[0] << 8) | src[1], dest);
+}
+
+static void
+row_565_msb_a (const buchar *src,
+	       buchar       *dest,
+	       bint          width)
+{
+  for (; width > 0; width--, src += 2, dest += 4)
+    {
+      unpack_565 ((src[0] << 8) | src[1], dest);
+      dest[3] = 0xff;
+    }
+}
+
+#ifdef BDK_SIMD_X86
+
+#define TARGET_SSSE3 __attribute__ ((target ("ssse3")))
+#define TARGET_AVX2  __attribute__ ((target ("avx2")))
+
+/* SSSE3
+ *
+ * Packed RGB is written 16 pixels at a time, from four vectors of 4
+ * pixels in their low 12 bytes, with the top 4 bytes clear.
+ */
+
+static inline void TARGET_SSSE3
+store_rgb_ssse3 (buchar  *dest,
+		 __m128i  p[4])
+{
+  _mm_storeu_si128 ((__m128i *) dest,
+		    _mm_or_si128 (p[0], _mm_slli_si128 (p[1], 12)));
+  _mm_storeu_si128 ((__m128i *) (dest + 16),
+		    _mm_or_si128 (_mm_srli_si128 (p[1], 4), _mm_slli_si128 (p[2], 8)));
+  _mm_storeu_si128 ((__m128i *) (dest + 32),
+		    _mm_or_si128 (_mm_srli_si128 (p[2], 8), _mm_slli_si128 (p[3], 4)));
+}
+
+static inline void TARGET_SSSE3
+row_0888_rgb_ssse3 (const buchar *src,
+		    buchar       *dest,
+		    bint          width,
+		    __m128i       shuffle)
+{
+  for (; width >= 16; width -= 16, src += 64, dest += 48)
+    {
+      __m128i p[4];
+      bint i;
+
+      for (i = 0; i < 4; i++)
+	p[i] = _mm_shuffle_epi8 (_mm_loadu_si128 ((const __m128i *) (src + 16 * i)),
+				 shuffle);
+      store_rgb_ssse3 (dest, p);
+    }
+}
+
+static inline void TARGET_SSSE3
+row_0888_rgba_ssse3 (const buchar *src,
+		     buchar       *dest,
+		     bint          width,
+		     __m128i       shuffle)
+{
+  const __m128i alpha = _mm_set1_epi32 (0xff000000);
+
+  for (; width >= 4; width -= 4, src += 16, dest += 16)
+    _mm_storeu_si128 ((__m128i *) dest,
+		      _mm_or_si128 (_mm_shuffle_epi8 (_mm_loadu_si128 ((const __m128i *) src),
+						      shuffle),
+				    alpha));
+}
+
+static void TARGET_SSSE3
+row_0888_lsb_ssse3 (const buchar *src,
+		    buchar       *dest,
+		    bint          width)
+{
+  bint n = width & ~15;
+
+  row_0888_rgb_ssse3 (src, dest, n,
+		      _mm_setr_epi8 (2, 1, 0, 6, 5, 4, 10, 9,
+				     8, 14, 13, 12, -1, -1, -1, -1));
+  row_0888_lsb (src + 4 * n, dest + 3 * n, width - n);
+}
+
+static void TARGET_SSSE3
+row_0888_lsb_a_ssse3 (const buchar *src,
+		      buchar       *dest,
+		      bint          width)
+{
+  bint n = width & ~3;
+
+  row_0888_rgba_ssse3 (src, dest, n,
+		       _mm_setr_epi8 (2, 1, 0, -1, 6, 5, 4, -1,
+				      10, 9, 8, -1, 14, 13, 12, -1));
+  row_0888_lsb_a (src + 4 * n, dest + 4 * n, width - n);
+}
+
+static void TARGET_SSSE3
+row_0888_msb_ssse3 (const buchar *src,
+		    buchar       *dest,
+		    bint          width)
+{
+  bint n = width & ~15;
+
+  row_0888_rgb_ssse3 (src, dest, n,
+		      _mm_setr_epi8 (1, 2, 3, 5, 6, 7, 9, 10,
+				     11, 13, 14, 15, -1, -1, -1, -1));
+  row_0888_msb (src + 4 * n, dest + 3 * n, width - n);
+}
+
+static void TARGET_SSSE3
+row_0888_msb_a_ssse3 (const buchar *src,
+		      buchar       *dest,
+		      bint          width)
+{
+  bint n = width & ~3;
+
+  row_0888_rgba_ssse3 (src, dest, n,
+		       _mm_setr_epi8 (1, 2, 3, -1, 5, 6, 7, -1,
+				      9, 10, 11, -1, 13, 14, 15, -1));
+  row_0888_msb_a (src + 4 * n, dest + 4 * n, width - n);
+}
+
+/* unpack_565() on the 16 bit lanes of @d, to R | G << 8 in @rg and
+ * B | @a << 8 in @ba, ready to be interleaved into RGBA
+ */
+static inline void TARGET_SSSE3
+unpack_565_ssse3 (__m128i  d,
+		  __m128i  a,
+		  __m128i *rg,
+		  __m128i *ba)
+{
+  __m128i r, g, b;
+
+  r = _mm_or_si128 (_mm_and_si128 (_mm_srli_epi16 (d, 8), _mm_set1_epi16 (0xf8)),
+		    _mm_srli_epi16 (d, 13));
+  g = _mm_or_si128 (_mm_and_si128 (_mm_srli_epi16 (d, 3), _mm_set1_epi16 (0xfc)),
+		    _mm_and_si128 (_mm_srli_epi16 (d, 9), _mm_set1_epi16 (0x3)));
+  b = _mm_or_si128 (_mm_and_si128 (_mm_slli_epi16 (d, 3), _mm_set1_epi16 (0xf8)),
+		    _mm_and_si128 (_mm_srli_epi16 (d, 2), _mm_set1_epi16 (0x7)));
+
+  *rg = _mm_or_si128 (r, _mm_slli_epi16 (g, 8));
+  *ba = _mm_or_si128 (b, a);
+}
+
+static inline __m128i TARGET_SSSE3
+load_565_ssse3 (const buchar *src,
+		bboolean      msb)
+{
+  __m128i d = _mm_loadu_si128 ((const __m128i *) src);
+
+  if (msb)
+    d = _mm_shuffle_epi8 (d, _mm_setr_epi8 (1, 0, 3, 2, 5, 4, 7, 6,
+					    9, 8, 11, 10, 13, 12, 15, 14));
+  return d;
+}
+
+static inline void TARGET_SSSE3
+row_565_rgb_ssse3 (const buchar *src,
+		   buchar       *dest,
+		   bint          width,
+		   bboolean      msb)
+{
+  const __m128i shuffle = _mm_setr_epi8 (0, 1, 2, 4, 5, 6, 8, 9,
+					 10, 12, 13, 14, -1, -1, -1, -1);
+
+  for (; width >= 16; width -= 16, src += 32, dest += 48)
+    {
+      __m128i p[4], rg, ba;
+      bint i;
+
+      for (i = 0; i < 2; i++)
+	{
+	  unpack_565_ssse3 (load_565_ssse3 (src + 16 * i, msb),
+			    _mm_setzero_si128 (), &rg, &ba);
+	  p[2 * i] = _mm_shuffle_epi8 (_mm_unpacklo_epi16 (rg, ba), shuffle);
+	  p[2 * i + 1] = _mm_shuffle_epi8 (_mm_unpackhi_epi16 (rg, ba), shuffle);
+	}
+      store_rgb_ssse3 (dest, p);
+    }
+}
+
+static inline void TARGET_SSSE3
+row_565_rgba_ssse3 (const buchar *src,
+		    buchar       *dest,
+		    bint          width,
+		    bboolean      msb)
+{
+  const __m128i alpha = _mm_set1_epi16 ((short) 0xff00);
+
+  for (; width >= 8; width -= 8, src += 16, dest += 32)
+    {
+      __m128i rg, ba;
+
+      unpack_565_ssse3 (load_565_ssse3 (src, msb), alpha, &rg, &ba);
+      _mm_storeu_si128 ((__m128i *) dest, _mm_unpacklo_epi16 (rg, ba));
+      _mm_storeu_si128 ((__m128i *) (dest + 16), _mm_unpackhi_epi16 (rg, ba));
+    }
+}
+
+static void TARGET_SSSE3
+row_565_lsb_ssse3 (const buchar *src,
+		   buchar       *dest,
+		   bint          width)
+{
+  bint n = width & ~15;
+
+  row_565_rgb_ssse3 (src, dest, n, FALSE);
+  row_565_lsb (src + 2 * n, dest + 3 * n, width - n);
+}
+
+static void TARGET_SSSE3
+row_565_lsb_a_ssse3 (const buchar *src,
+		     buchar       *dest,
+		     bint          width)
+{
+  bint n = width & ~7;
+
+  row_565_rgba_ssse3 (src, dest, n, FALSE);
+  row_565_lsb_a (src + 2 * n, dest + 4 * n, width - n);
+}
+
+static void TARGET_SSSE3
+row_565_msb_ssse3 (const buchar *src,
+		   buchar       *dest,
+		   bint          width)
+{
+  bint n = width & ~15;
+
+  row_565_rgb_ssse3 (src, dest, n, TRUE);
+  row_565_msb (src + 2 * n, dest + 3 * n, width - n);
+}
+
+static void TARGET_SSSE3
+row_565_msb_a_ssse3 (const buchar *src,
+		     buchar       *dest,
+		     bint          width)
+{
+  bint n = width & ~7;
+
+  row_565_rgba_ssse3 (src, dest, n, TRUE);
+  row_565_msb_a (src + 2 * n, dest + 4 * n, width - n);
+}
+
+/* AVX2
+ *
+ * Only for RGBA output; packed RGB doesn't split evenly into 128 bit
+ * halves, and the SSSE3 loops are already limited by the stores.
+ */
+
+static inline void TARGET_AVX2
+row_0888_rgba_avx2 (const buchar *src,
+		    buchar       *dest,
+		    bint          width,
+		    __m256i       shuffle)
+{
+  const __m256i alpha = _mm256_set1_epi32 (0xff000000);
+
+  for (; width >= 8; width -= 8, src += 32, dest += 32)
+    _mm256_storeu_si256 ((__m256i *) dest,
+			 _mm256_or_si256 (_mm256_shuffle_epi8 (_mm256_loadu_si256 ((const __m256i *) src),
+							       shuffle),
+					  alpha));
+}
+
+static void TARGET_AVX2
+row_0888_lsb_a_avx2 (const buchar *src,
+		     buchar       *dest,
+		     bint          width)
+{
+  bint n = width & ~7;
+
+  row_0888_rgba_avx2 (src, dest, n,
+		      _mm256_setr_epi8 (2, 1, 0, -1, 6, 5, 4, -1,
+					10, 9, 8, -1, 14, 13, 12, -1,
+					2, 1, 0, -1, 6, 5, 4, -1,
+					10, 9, 8, -1, 14, 13, 12, -1));
+  row_0888_lsb_a (src + 4 * n, dest + 4 * n, width - n);
+}
+
+static void TARGET_AVX2
+row_0888_msb_a_avx2 (const buchar *src,
+		     buchar       *dest,
+		     bint          width)
+{
+  bint n = width & ~7;
+
+  row_0888_rgba_avx2 (src, dest, n,
+		      _mm256_setr_epi8 (1, 2, 3, -1, 5, 6, 7, -1,
+					9, 10, 11, -1, 13, 14, 15, -1,
+					1, 2, 3, -1, 5, 6, 7, -1,
+					9, 10, 11, -1, 13, 14, 15, -1));
+  row_0888_msb_a (src + 4 * n, dest + 4 * n, width - n);
+}
+
+static inline void TARGET_AVX2
+row_565_rgba_avx2 (const buchar *src,
+		   buchar       *dest,
+		   bint          width,
+		   bboolean      msb)
+{
+  const __m256i swap = _mm256_setr_epi8 (1, 0, 3, 2, 5, 4, 7, 6,
+					 9, 8, 11, 10, 13, 12, 15, 14,
+					 1, 0, 3, 2, 5, 4, 7, 6,
+					 9, 8, 11, 10, 13, 12, 15, 14);
+
+  for (; width >= 16; width -= 16, src += 32, dest += 64)
+    {
+      __m256i d, r, g, b, rg, ba, lo, hi;
+
+      d = _mm256_loadu_si256 ((const __m256i *) src);
+      if (msb)
+	d = _mm256_shuffle_epi8 (d, swap);
+
+      r = _mm256_or_si256 (_mm256_and_si256 (_mm256_srli_epi16 (d, 8), _mm256_set1_epi16 (0xf8)),
+			   _mm256_srli_epi16 (d, 13));
+      g = _mm256_or_si256 (_mm256_and_si256 (_mm256_srli_epi16 (d, 3), _mm256_set1_epi16 (0xfc)),
+			   _mm256_and_si256 (_mm256_srli_epi16 (d, 9), _mm256_set1_epi16 (0x3)));
+      b = _mm256_or_si256 (_mm256_and_si256 (_mm256_slli_epi16 (d, 3), _mm256_set1_epi16 (0xf8)),
+			   _mm256_and_si256 (_mm256_srli_epi16 (d, 2), _mm256_set1_epi16 (0x7)));
+
+      rg = _mm256_or_si256 (r, _mm256_slli_epi16 (g, 8));
+      ba = _mm256_or_si256 (b, _mm256_set1_epi16 ((short) 0xff00));
+
+      /* The interleaves work within halves: lo has pixels 0-3 and
+       * 8-11, hi has 4-7 and 12-15
+       */
+      lo = _mm256_unpacklo_epi16 (rg, ba);
+      hi = _mm256_unpackhi_epi16 (rg, ba);
+      _mm256_storeu_si256 ((__m256i *) dest, _mm256_permute2x128_si256 (lo, hi, 0x20));
+      _mm256_storeu_si256 ((__m256i *) (dest + 32), _mm256_permute2x128_si256 (lo, hi, 0x31));
+    }
+}
+
+static void TARGET_AVX2
+row_565_lsb_a_avx2 (const buchar *src,
+		    buchar       *dest,
+		    bint          width)
+{
+  bint n = width & ~15;
+
+  row_565_rgba_avx2 (src, dest, n, FALSE);
+  row_565_lsb_a (src + 2 * n, dest + 4 * n, width - n);
+}
+
+static void TARGET_AVX2
+row_565_msb_a_avx2 (const buchar *src,
+		    buchar       *dest,
+		    bint          width)
+{
+  bint n = width & ~15;
+
+  row_565_rgba_avx2 (src, dest, n, TRUE);
+  row_565_msb_a (src + 2 * n, dest + 4 * n, width - n);
+}
+
+#endif /* BDK_SIMD_X86 */
+
+#ifdef BDK_SIMD_ARM_NEON
+
+/* NEON
+ *
+ * The structure loads and stores do the (de)interleaving, 16 pixels
+ * at a time.  5-6-5 words are split into their high and low bytes,
+ * which keeps the loops independent of the host byte order.
+ */
+
+static inline void
+unpack_565_neon (uint8x16_t    h,
+		 uint8x16_t    l,
+		 uint8x16x4_t *q)
+{
+  q->val[0] = vorrq_u8 (vandq_u8 (h, vdupq_n_u8 (0xf8)), vshrq_n_u8 (h, 5));
+  q->val[1] = vorrq_u8 (vorrq_u8 (vshlq_n_u8 (h, 5),
+				  vandq_u8 (vshrq_n_u8 (l, 3), vdupq_n_u8 (0x1c))),
+			vandq_u8 (vshrq_n_u8 (h, 1), vdupq_n_u8 (0x3)));
+  q->val[2] = vorrq_u8 (vshlq_n_u8 (l, 3), vandq_u8 (vshrq_n_u8 (l, 2), vdupq_n_u8 (0x7)));
+  q->val[3] = vdupq_n_u8 (0xff);
+}
+
+static inline void
+row_0888_neon (const buchar *src,
+	       buchar       *dest,
+	       bint          width,
+	       bboolean      msb,
+	       bboolean      alpha)
+{
+  for (; width >= 16; width -= 16, src += 64, dest += alpha ? 64 : 48)
+    {
+      uint8x16x4_t p = vld4q_u8 (src);
+      uint8x16x4_t q;
+
+      if (msb)
+	{
+	  q.val[0] = p.val[1];
+	  q.val[1] = p.val[2];
+	  q.val[2] = p.val[3];
+	}
+      else
+	{
+	  q.val[0] = p.val[2];
+	  q.val[1] = p.val[1];
+	  q.val[2] = p.val[0];
+	}
+      q.val[3] = vdupq_n_u8 (0xff);
+
+      if (alpha)
+	vst4q_u8 (dest, q);
+      else
+	{
+	  uint8x16x3_t t;
+
+	  t.val[0] = q.val[0];
+	  t.val[1] = q.val[1];
+	  t.val[2] = q.val[2];
+	  vst3q_u8 (dest, t);
+	}
+    }
+}
+
+static inline void
+row_565_neon (const buchar *src,
+	      buchar       *dest,
+	      bint          width,
+	      bboolean      msb,
+	      bboolean      alpha)
+{
+  for (; width >= 16; width -= 16, src += 32, dest += alpha ? 64 : 48)
+    {
+      uint8x16x2_t p = vld2q_u8 (src);
+      uint8x16x4_t q;
+
+      if (msb)
+	unpack_565_neon (p.val[0], p.val[1], &q);
+      else
+	unpack_565_neon (p.val[1], p.val[0], &q);
+
+      if (alpha)
+	vst4q_u8 (dest, q);
+      else
+	{
+	  uint8x16x3_t t;
+
+	  t.val[0] = q.val[0];
+	  t.val[1] = q.val[1];
+	  t.val[2] = q.val[2];
+	  vst3q_u8 (dest, t);
+	}
+    }
+}
+
+static void
+row_0888_lsb_neon (const buchar *src,
+		   buchar       *dest,
+		   bint          width)
+{
+  bint n = width & ~15;
+
+  row_0888_neon (src, dest, n, FALSE, FALSE);
+  row_0888_lsb (src + 4 * n, dest + 3 * n, width - n);
+}
+
+static void
+row_0888_lsb_a_neon (const buchar *src,
+		     buchar       *dest,
+		     bint          width)
+{
+  bint n = width & ~15;
+
+  row_0888_neon (src, dest, n, FALSE, TRUE);
+  row_0888_lsb_a (src + 4 * n, dest + 4 * n, width - n);
+}
+
+static void
+row_0888_msb_neon (const buchar *src,
+		   buchar       *dest,
+		   bint          width)
+{
+  bint n = width & ~15;
+
+  row_0888_neon (src, dest, n, TRUE, FALSE);
+  row_0888_msb (src + 4 * n, dest + 3 * n, width - n);
+}
+
+static void
+row_0888_msb_a_neon (const buchar *src,
+		     buchar       *dest,
+		     bint          width)
+{
+  bint n = width & ~15;
+
+  row_0888_neon (src, dest, n, TRUE, TRUE);
+  row_0888_msb_a (src + 4 * n, dest + 4 * n, width - n);
+}
+
+static void
+row_565_lsb_neon (const buchar *src,
+		  buchar       *dest,
+		  bint          width)
+{
+  bint n = width & ~15;
+
+  row_565_neon (src, dest, n, FALSE, FALSE);
+  row_565_lsb (src + 2 * n, dest + 3 * n, width - n);
+}
+
+static void
+row_565_lsb_a_neon (const buchar *src,
+		    buchar       *dest,
+		    bint          width)
+{
+  bint n = width & ~15;
+
+  row_565_neon (src, dest, n, FALSE, TRUE);
+  row_565_lsb_a (src + 2 * n, dest + 4 * n, width - n);
+}
+
+static void
+row_565_msb_neon (const buchar *src,
+		  buchar       *dest,
+		  bint          width)
+{
+  bint n = width & ~15;
+
+  row_565_neon (src, dest, n, TRUE, FALSE);
+  row_565_msb (src + 2 * n, dest + 3 * n, width - n);
+}
+
+static void
+row_565_msb_a_neon (const buchar *src,
+		    buchar       *dest,
+		    bint          width)
+{
+  bint n = width & ~15;
+
+  row_565_neon (src, dest, n, TRUE, TRUE);
+  row_565_msb_a (src + 2 * n, dest + 4 * n, width - n);
+}
+
+#endif /* BDK_SIMD_ARM_NEON */
+
+/* Returns the fastest unpacking loop for @format, writing RGBA if
+ * @alpha is set and RGB otherwise, that only uses the instruction
+ * sets in @flags.  Pass 0 to get the plain C one.
+ */
+BdkUnpackRowFunc
+_bdk_unpack_row_get_func (BdkUnpackRowFormat format,
+			  bboolean           alpha,
+			  BdkSimdFlags       flags)
+{
+  switch (format)
+    {
+    case BDK_UNPACK_ROW_0888_LSB:
+      if (alpha)
+	{
+#ifdef BDK_SIMD_X86
+	  if (flags & BDK_SIMD_AVX2)
+	    return row_0888_lsb_a_avx2;
+	  if (flags & BDK_SIMD_SSSE3)
+	    return row_0888_lsb_a_ssse3;
+#endif
+#ifdef BDK_SIMD_ARM_NEON
+	  if (flags & BDK_SIMD_NEON)
+	    return row_0888_lsb_a_neon;
+#endif
+	  return row_0888_lsb_a;
+	}
+#ifdef BDK_SIMD_X86
+      if (flags & BDK_SIMD_SSSE3)
+	return row_0888_lsb_ssse3;
+#endif
+#ifdef BDK_SIMD_ARM_NEON
+      if (flags & BDK_SIMD_NEON)
+	return row_0888_lsb_neon;
+#endif
+      return row_0888_lsb;
+
+    case BDK_UNPACK_ROW_0888_MSB:
+      if (alpha)
+	{
+#ifdef BDK_SIMD_X86
+	  if (flags & BDK_SIMD_AVX2)
+	    return row_0888_msb_a_avx2;
+	  if (flags & BDK_SIMD_SSSE3)
+	    return row_0888_msb_a_ssse3;
+#endif
+#ifdef BDK_SIMD_ARM_NEON
+	  if (flags & BDK_SIMD_NEON)
+	    return row_0888_msb_a_neon;
+#endif
+	  return row_0888_msb_a;
+	}
+#ifdef BDK_SIMD_X86
+      if (flags & BDK_SIMD_SSSE3)
+	return row_0888_msb_ssse3;
+#endif
+#ifdef BDK_SIMD_ARM_NEON
+      if (flags & BDK_SIMD_NEON)
+	return row_0888_msb_neon;
+#endif
+      return row_0888_msb;
+
+    case BDK_UNPACK_ROW_565_LSB:
+      if (alpha)
+	{
+#ifdef BDK_SIMD_X86
+	  if (flags & BDK_SIMD_AVX2)
+	    return row_565_lsb_a_avx2;
+	  if (flags & BDK_SIMD_SSSE3)
+	    return row_565_lsb_a_ssse3;
+#endif
+#ifdef BDK_SIMD_ARM_NEON
+	  if (flags & BDK_SIMD_NEON)
+	    return row_565_lsb_a_neon;
+#endif
+	  return row_565_lsb_a;
+	}
+#ifdef BDK_SIMD_X86
+      if (flags & BDK_SIMD_SSSE3)
+	return row_565_lsb_ssse3;
+#endif
+#ifdef BDK_SIMD_ARM_NEON
+      if (flags & BDK_SIMD_NEON)
+	return row_565_lsb_neon;
+#endif
+      return row_565_lsb;
+
+    case BDK_UNPACK_ROW_565_MSB:
+      if (alpha)
+	{
+#ifdef BDK_SIMD_X86
+	  if (flags & BDK_SIMD_AVX2)
+	    return row_565_msb_a_avx2;
+	  if (flags & BDK_SIMD_SSSE3)
+	    return row_565_msb_a_ssse3;
+#endif
+#ifdef BDK_SIMD_ARM_NEON
+	  if (flags & BDK_SIMD_NEON)
+	    return row_565_msb_a_neon;
+#endif
+	  return row_565_msb_a;
+	}
+#ifdef BDK_SIMD_X86
+      if (flags & BDK_SIMD_SSSE3)
+	return row_565_msb_ssse3;
+#endif
+#ifdef BDK_SIMD_ARM_NEON
+      if (flags & BDK_SIMD_NEON)
+	return row_565_msb_neon;
+#endif
+      return row_565_msb;
+    }
+
+  return NULL;
+}
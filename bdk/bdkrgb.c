@@ -40,6 +40,7 @@
 
 #include "bdkrgb.h"
 #include "bdkscreen.h"
+#include "bdksimd.h"
 #include "bdkalias.h"
 #include <bunnylib/gprintf.h>
 
@@ -96,6 +97,12 @@ struct _BdkRgbInfo
   BdkRgbConvFunc conv_indexed;
   BdkRgbConvFunc conv_indexed_d;
 
+  /* Vector row loops behind the conv functions, if the CPU has them */
+  BdkRgbRowFunc row;
+  BdkRgbRowFunc row_d;
+  BdkRgbRowFunc row_32;
+  BdkRgbRowFunc row_32_to_stage;
+
   buchar *colorcube;
   buchar *colorcube_d;
 
@@ -2155,29 +2162,6 @@ bdk_rgb_convert_0888 (BdkRgbInfo *image_info, BdkImage *image,
     }
 }
 
-#ifdef USE_MEDIALIB25
-/* convert 24-bit packed to 32-bit unpacked */
-static void
-bdk_rgb_convert_0888_medialib (BdkRgbInfo *image_info, BdkImage *image,
-			       bint x0, bint y0, bint width, bint height,
-			       const buchar *buf, int rowstride,
-			       bint x_align, bint y_align, BdkRgbCmap *cmap)
-{
-  int y, w;
-  buchar *obuf, *p;
-  bint bpl;
-  const buchar *bptr, *bp2;
-
-  bptr = buf;
-  bpl = image->bpl;
-  obuf = ((buchar *)image->mem) + y0 * bpl + x0 * 4;
-
-  mlib_VideoColorRGBint_to_BGRAint (obuf, bptr, NULL, 0xff,
-                                    width, height, bpl, 
-                                    rowstride, 0);
-}
-#endif
-
 static void
 bdk_rgb_convert_0888_br (BdkRgbInfo *image_info, BdkImage *image,
 			 bint x0, bint y0, bint width, bint height,
@@ -2242,6 +2226,91 @@ bdk_rgb_convert_8880_br (BdkRgbInfo *image_info, BdkImage *image,
     }
 }
 
+/* Conversion functions for the vector row loops of bdksimd.h, which
+   are used instead of the ones above when the CPU has them. */
+static void
+bdk_rgb_convert_row (BdkRgbInfo *image_info, BdkImage *image,
+		     bint x0, bint y0, bint width, bint height,
+		     const buchar *buf, int rowstride,
+		     bint x_align, bint y_align, BdkRgbCmap *cmap)
+{
+  int y;
+  buchar *obuf;
+  bint bpl;
+  const buchar *bptr;
+
+  bptr = buf;
+  bpl = image->bpl;
+  obuf = ((buchar *)image->mem) + y0 * bpl + x0 * image->bpp;
+  for (y = 0; y < height; y++)
+    {
+      (*image_info->row) (bptr, obuf, width, NULL, 0);
+      bptr += rowstride;
+      obuf += bpl;
+    }
+}
+
+static void
+bdk_rgb_convert_row_d (BdkRgbInfo *image_info, BdkImage *image,
+		       bint x0, bint y0, bint width, bint height,
+		       const buchar *buf, int rowstride,
+		       bint x_align, bint y_align, BdkRgbCmap *cmap)
+{
+  int y;
+  buchar *obuf;
+  bint bpl;
+  const buchar *bptr;
+
+  bptr = buf;
+  bpl = image->bpl;
+  obuf = ((buchar *)image->mem) + y0 * bpl + x0 * image->bpp;
+  for (y = y_align; y < y_align + height; y++)
+    {
+      const buint32 *dmp = DM_565 + ((y & (DM_HEIGHT - 1)) << DM_WIDTH_SHIFT);
+
+      (*image_info->row_d) (bptr, obuf, width, dmp, x_align);
+      bptr += rowstride;
+      obuf += bpl;
+    }
+}
+
+/* 32bit RGB straight to the image, without the stage buffer */
+static void
+bdk_rgb_convert_32_row (BdkRgbInfo *image_info, BdkImage *image,
+			bint x0, bint y0, bint width, bint height,
+			const buchar *buf, int rowstride,
+			bint x_align, bint y_align, BdkRgbCmap *cmap)
+{
+  int y;
+  buchar *obuf;
+  bint bpl;
+  const buchar *bptr;
+
+  bptr = buf;
+  bpl = image->bpl;
+  obuf = ((buchar *)image->mem) + y0 * bpl + x0 * image->bpp;
+  for (y = 0; y < height; y++)
+    {
+      (*image_info->row_32) (bptr, obuf, width, NULL, 0);
+      bptr += rowstride;
+      obuf += bpl;
+    }
+}
+
+/* Returns the vector row loop for @format, or %NULL if the CPU has
+   none and the plain C converters should be used. */
+static BdkRgbRowFunc
+bdk_rgb_get_row_func (BdkRgbRowFormat format)
+{
+  BdkRgbRowFunc func;
+
+  func = _bdk_rgb_row_get_func (format, _bdk_simd_get_flags ());
+  if (func == _bdk_rgb_row_get_func (format, 0))
+    return NULL;
+
+  return func;
+}
+
 /* Generic truecolor/directcolor conversion function. Slow, but these
    are oddball modes. */
 static void
@@ -2869,14 +2938,19 @@ bdk_rgb_32_to_stage (BdkRgbInfo *image_info,
   po_start = bdk_rgb_ensure_stage (image_info);
   for (y = 0; y < height; y++)
     {
-      pi = pi_start;
-      po = po_start;
-      for (x = 0; x < width; x++)
+      if (image_info->row_32_to_stage)
+	(*image_info->row_32_to_stage) (pi_start, po_start, width, NULL, 0);
+      else
 	{
-	  *po++ = *pi++;
-	  *po++ = *pi++;
-	  *po++ = *pi++;
-	  pi++;
+	  pi = pi_start;
+	  po = po_start;
+	  for (x = 0; x < width; x++)
+	    {
+	      *po++ = *pi++;
+	      *po++ = *pi++;
+	      *po++ = *pi++;
+	      pi++;
+	    }
 	}
       pi_start += rowstride;
       po_start += STAGE_ROWSTRIDE;
@@ -3157,16 +3231,7 @@ bdk_rgb_select_conv (BdkRgbInfo *image_info)
 	   (depth == 24 || depth == 32) &&
 	   vtype == BDK_VISUAL_TRUE_COLOR &&
 	   (mask_rgb && byte_order == BDK_LSB_FIRST))
-    {
-#ifdef USE_MEDIALIB25
-      if (_bdk_use_medialib ())
-        conv = bdk_rgb_convert_0888_medialib;
-      else
-        conv = bdk_rgb_convert_0888;
-#else
-      conv = bdk_rgb_convert_0888;
-#endif
-    }
+    conv = bdk_rgb_convert_0888;
   
 #if G_BYTE_ORDER == G_BIG_ENDIAN
   else if (bpp == 32 && depth == 24 && vtype == BDK_VISUAL_TRUE_COLOR &&
@@ -3184,16 +3249,7 @@ bdk_rgb_select_conv (BdkRgbInfo *image_info)
     conv = bdk_rgb_convert_8880_br;
   else if (bpp == 32 && depth == 32 && vtype == BDK_VISUAL_TRUE_COLOR &&
 	   (mask_rgb && byte_order == BDK_LSB_FIRST))
-    {
-#ifdef USE_MEDIALIB25
-      if (_bdk_use_medialib ())
-        conv = bdk_rgb_convert_0888_medialib;
-      else
-        conv = bdk_rgb_convert_0888;
-#else
-      conv = bdk_rgb_convert_0888;
-#endif
-    }
+    conv = bdk_rgb_convert_0888;
 #endif
   else if (vtype == BDK_VISUAL_TRUE_COLOR && byte_order == BDK_LSB_FIRST)
     {
@@ -3272,6 +3328,34 @@ bdk_rgb_select_conv (BdkRgbInfo *image_info)
              vtype, depth, bpp,
              byte_order == BDK_LSB_FIRST ? "lsb" : "msb");
 
+  /* Use the vector loops for the common truecolor formats */
+  if (conv == bdk_rgb_convert_0888)
+    {
+      image_info->row = bdk_rgb_get_row_func (BDK_RGB_ROW_0888);
+      image_info->row_32 = bdk_rgb_get_row_func (BDK_RGB_ROW_32_0888);
+      if (image_info->row_32)
+	{
+	  conv_32 = bdk_rgb_convert_32_row;
+	  conv_32_d = bdk_rgb_convert_32_row;
+	}
+    }
+  else if (conv == bdk_rgb_convert_0888_br)
+    image_info->row = bdk_rgb_get_row_func (BDK_RGB_ROW_0888_BR);
+  else if (conv == bdk_rgb_convert_888_lsb)
+    image_info->row = bdk_rgb_get_row_func (BDK_RGB_ROW_888_LSB);
+  else if (conv == bdk_rgb_convert_565)
+    {
+      image_info->row = bdk_rgb_get_row_func (BDK_RGB_ROW_565);
+#if DM_WIDTH == BDK_RGB_ROW_DITHER_WIDTH
+      image_info->row_d = bdk_rgb_get_row_func (BDK_RGB_ROW_565_D);
+      if (image_info->row_d)
+	conv_d = bdk_rgb_convert_row_d;
+#endif
+    }
+  if (image_info->row)
+    conv = bdk_rgb_convert_row;
+  image_info->row_32_to_stage = bdk_rgb_get_row_func (BDK_RGB_ROW_32_TO_24);
+
   if (conv_d == NULL)
     conv_d = conv;
 
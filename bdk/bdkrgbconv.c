@@ -0,0 +1,1003 @@
+/* BDK - The GIMP Drawing Kit
+ * Copyright (C) 1995-1997 Peter Mattis, Spencer Kimball and Josh MacDonald
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/*
+ * Modified by the BTK+ Team and others 1997-2000.  See the AUTHORS
+ * file for a list of people on the BTK+ Team.  See the ChangeLog
+ * files for a list of changes.  These files are distributed with
+ * BTK+ at ftp://ftp.btk.org/pub/btk/.
+ */
+
+/* Row conversion loops for the truecolor visuals of BdkRGB
+ *
+ * The plain C versions here define the results; they do the same as
+ * the hand-tuned converters in bdkrgb.c, which are still used when
+ * there is no vector version for the CPU.
+ *
+ * The dithered 5-6-5 conversion works on all three channels packed
+ * into one 32 bit word as r << 20 | g << 10 | b, exactly like
+ * bdk_rgb_convert_565_d(), so the vector versions use 32 bit lanes.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include "bdksimd.h"
+
+#ifdef BDK_SIMD_X86
+#include <immintrin.h>
+#endif
+
+#ifdef BDK_SIMD_ARM_NEON
+#include <arm_neon.h>
+#endif
+
+#define DITHER_MASK (BDK_RGB_ROW_DITHER_WIDTH - 1)
+
+/* Plain C */
+
+static inline buint16
+pixel_565 (const buchar *p)
+{
+  return ((p[0] & 0xf8) << 8) | ((p[1] & 0xfc) << 3) | (p[2] >> 3);
+}
+
+static inline buint16
+pixel_565_d (const buchar *p,
+	     buint32       dith)
+{
+  buint32 rgb = (p[0] << 20) + (p[1] << 10) + p[2] + dith;
+
+  rgb += 0x10040100
+    - ((rgb & 0x1e0001e0) >> 5)
+    - ((rgb & 0x00070000) >> 6);
+
+  return ((rgb & 0x0f800000) >> 12) |
+    ((rgb & 0x0003f000) >> 7) |
+    ((rgb & 0x000000f8) >> 3);
+}
+
+static void
+row_0888 (const buchar  *src,
+	  buchar        *dest,
+	  bint           width,
+	  const buint32 *dither,
+	  bint           x)
+{
+  while (width--)
+    {
+      dest[0] = src[2];
+      dest[1] = src[1];
+      dest[2] = src[0];
+      dest[3] = 0xff;
+      src += 3;
+      dest += 4;
+    }
+}
+
+static void
+row_0888_br (const buchar  *src,
+	     buchar        *dest,
+	     bint           width,
+	     const buint32 *dither,
+	     bint           x)
+{
+  while (width--)
+    {
+      dest[0] = 0xff;
+      dest[1] = src[0];
+      dest[2] = src[1];
+      dest[3] = src[2];
+      src += 3;
+      dest += 4;
+    }
+}
+
+static void
+row_888_lsb (const buchar  *src,
+	     buchar        *dest,
+	     bint           width,
+	     const buint32 *dither,
+	     bint           x)
+{
+  while (width--)
+    {
+      dest[0] = src[2];
+      dest[1] = src[1];
+      dest[2] = src[0];
+      src += 3;
+      dest += 3;
+    }
+}
+
+static void
+row_565 (const buchar  *src,
+	 buchar        *dest,
+	 bint           width,
+	 const buint32 *dither,
+	 bint           x)
+{
+  buint16 *q = (buint16 *) dest;
+
+  while (width--)
+    {
+      *q++ = pixel_565 (src);
+      src += 3;
+    }
+}
+
+static void
+row_565_d (const buchar  *src,
+	   buchar        *dest,
+	   bint           width,
+	   const buint32 *dither,
+	   bint           x)
+{
+  buint16 *q = (buint16 *) dest;
+
+  while (width--)
+    {
+      *q++ = pixel_565_d (src, dither[x++ & DITHER_MASK]);
+      src += 3;
+    }
+}
+
+static void
+row_32_0888 (const buchar  *src,
+	     buchar        *dest,
+	     bint           width,
+	     const buint32 *dither,
+	     bint           x)
+{
+  while (width--)
+    {
+      dest[0] = src[2];
+      dest[1] = src[1];
+      dest[2] = src[0];
+      dest[3] = 0xff;
+      src += 4;
+      dest += 4;
+    }
+}
+
+static void
+row_32_to_24 (const buchar  *src,
+	      buchar        *dest,
+	      bint           width,
+	      const buint32 *dither,
+	      bint           x)
+{
+  while (width--)
+    {
+      dest[0] = src[0];
+      dest[1] = src[1];
+      dest[2] = src[2];
+      src += 4;
+      dest += 3;
+    }
+}
+
+/* Returns @n dither values starting at column @x, copying them to
+ * @tmp if they wrap around the end of the row.
+ */
+static inline const buint32 *
+get_dither (const buint32 *dither,
+	    bint           x,
+	    bint           n,
+	    buint32       *tmp)
+{
+  bint i;
+
+  x &= DITHER_MASK;
+  if (x + n <= BDK_RGB_ROW_DITHER_WIDTH)
+    return dither + x;
+
+  for (i = 0; i < n; i++)
+    tmp[i] = dither[(x + i) & DITHER_MASK];
+
+  return tmp;
+}
+
+#ifdef BDK_SIMD_X86
+
+#define TARGET_SSSE3 __attribute__ ((target ("ssse3")))
+#define TARGET_AVX2  __attribute__ ((target ("avx2")))
+
+/* SSSE3
+ *
+ * Packed RGB is read 16 pixels at a time, as three full loads that
+ * are then split into four vectors of 4 pixels in their low 12 bytes.
+ */
+
+static inline void TARGET_SSSE3
+load_rgb_ssse3 (const buchar *src,
+		__m128i       p[4])
+{
+  __m128i a = _mm_loadu_si128 ((const __m128i *) src);
+  __m128i b = _mm_loadu_si128 ((const __m128i *) (src + 16));
+  __m128i c = _mm_loadu_si128 ((const __m128i *) (src + 32));
+
+  p[0] = a;
+  p[1] = _mm_alignr_epi8 (b, a, 12);
+  p[2] = _mm_alignr_epi8 (c, b, 8);
+  p[3] = _mm_srli_si128 (c, 4);
+}
+
+/* The reverse: four vectors of 4 pixels in their low 12 bytes, with
+ * the top 4 bytes clear, to 48 bytes of packed pixels.
+ */
+static inline void TARGET_SSSE3
+store_rgb_ssse3 (buchar  *dest,
+		 __m128i  p[4])
+{
+  _mm_storeu_si128 ((__m128i *) dest,
+		    _mm_or_si128 (p[0], _mm_slli_si128 (p[1], 12)));
+  _mm_storeu_si128 ((__m128i *) (dest + 16),
+		    _mm_or_si128 (_mm_srli_si128 (p[1], 4), _mm_slli_si128 (p[2], 8)));
+  _mm_storeu_si128 ((__m128i *) (dest + 32),
+		    _mm_or_si128 (_mm_srli_si128 (p[2], 8), _mm_slli_si128 (p[3], 4)));
+}
+
+/* r << 20 | g << 10 | b for 4 pixels, from the low 12 bytes of @p */
+static inline __m128i TARGET_SSSE3
+unpack_d_ssse3 (__m128i p)
+{
+  const __m128i r = _mm_setr_epi8 (-1, -1, 0, -1, -1, -1, 3, -1,
+				   -1, -1, 6, -1, -1, -1, 9, -1);
+  const __m128i g = _mm_setr_epi8 (-1, 1, -1, -1, -1, 4, -1, -1,
+				   -1, 7, -1, -1, -1, 10, -1, -1);
+  const __m128i b = _mm_setr_epi8 (2, -1, -1, -1, 5, -1, -1, -1,
+				   8, -1, -1, -1, 11, -1, -1, -1);
+
+  return _mm_add_epi32 (_mm_add_epi32 (_mm_slli_epi32 (_mm_shuffle_epi8 (p, r), 4),
+				       _mm_slli_epi32 (_mm_shuffle_epi8 (p, g), 2)),
+			_mm_shuffle_epi8 (p, b));
+}
+
+/* pixel_565_d() on 32 bit lanes, the result sign extended so that it
+ * can be packed with _mm_packs_epi32()
+ */
+static inline __m128i TARGET_SSSE3
+dither_565_ssse3 (__m128i rgb,
+		  __m128i dith)
+{
+  __m128i t;
+
+  rgb = _mm_add_epi32 (rgb, dith);
+  t = _mm_add_epi32 (rgb, _mm_set1_epi32 (0x10040100));
+  t = _mm_sub_epi32 (t, _mm_srli_epi32 (_mm_and_si128 (rgb, _mm_set1_epi32 (0x1e0001e0)), 5));
+  t = _mm_sub_epi32 (t, _mm_srli_epi32 (_mm_and_si128 (rgb, _mm_set1_epi32 (0x00070000)), 6));
+
+  t = _mm_or_si128 (_mm_or_si128 (_mm_srli_epi32 (_mm_and_si128 (t, _mm_set1_epi32 (0x0f800000)), 12),
+				  _mm_srli_epi32 (_mm_and_si128 (t, _mm_set1_epi32 (0x0003f000)), 7)),
+		    _mm_srli_epi32 (_mm_and_si128 (t, _mm_set1_epi32 (0x000000f8)), 3));
+
+  return _mm_srai_epi32 (_mm_slli_epi32 (t, 16), 16);
+}
+
+static void TARGET_SSSE3
+row_0888_ssse3 (const buchar  *src,
+		buchar        *dest,
+		bint           width,
+		const buint32 *dither,
+		bint           x)
+{
+  const __m128i shuffle = _mm_setr_epi8 (2, 1, 0, -1, 5, 4, 3, -1,
+					 8, 7, 6, -1, 11, 10, 9, -1);
+  const __m128i alpha = _mm_set1_epi32 (0xff000000);
+
+  for (; width >= 16; width -= 16, src += 48, dest += 64)
+    {
+      __m128i p[4];
+      bint i;
+
+      load_rgb_ssse3 (src, p);
+      for (i = 0; i < 4; i++)
+	_mm_storeu_si128 ((__m128i *) (dest + 16 * i),
+			  _mm_or_si128 (_mm_shuffle_epi8 (p[i], shuffle), alpha));
+    }
+
+  row_0888 (src, dest, width, dither, x);
+}
+
+static void TARGET_SSSE3
+row_0888_br_ssse3 (const buchar  *src,
+		   buchar        *dest,
+		   bint           width,
+		   const buint32 *dither,
+		   bint           x)
+{
+  const __m128i shuffle = _mm_setr_epi8 (-1, 0, 1, 2, -1, 3, 4, 5,
+					 -1, 6, 7, 8, -1, 9, 10, 11);
+  const __m128i alpha = _mm_set1_epi32 (0x000000ff);
+
+  for (; width >= 16; width -= 16, src += 48, dest += 64)
+    {
+      __m128i p[4];
+      bint i;
+
+      load_rgb_ssse3 (src, p);
+      for (i = 0; i < 4; i++)
+	_mm_storeu_si128 ((__m128i *) (dest + 16 * i),
+			  _mm_or_si128 (_mm_shuffle_epi8 (p[i], shuffle), alpha));
+    }
+
+  row_0888_br (src, dest, width, dither, x);
+}
+
+static void TARGET_SSSE3
+row_888_lsb_ssse3 (const buchar  *src,
+		   buchar        *dest,
+		   bint           width,
+		   const buint32 *dither,
+		   bint           x)
+{
+  const __m128i shuffle = _mm_setr_epi8 (2, 1, 0, 5, 4, 3, 8, 7,
+					 6, 11, 10, 9, -1, -1, -1, -1);
+
+  for (; width >= 16; width -= 16, src += 48, dest += 48)
+    {
+      __m128i p[4];
+      bint i;
+
+      load_rgb_ssse3 (src, p);
+      for (i = 0; i < 4; i++)
+	p[i] = _mm_shuffle_epi8 (p[i], shuffle);
+      store_rgb_ssse3 (dest, p);
+    }
+
+  row_888_lsb (src, dest, width, dither, x);
+}
+
+static void TARGET_SSSE3
+row_565_ssse3 (const buchar  *src,
+	       buchar        *dest,
+	       bint           width,
+	       const buint32 *dither,
+	       bint           x)
+{
+  /* R to the high byte, G and B to the low byte of 16 bit lanes; the
+   * first of each pair of masks fills lanes 0-3, the second 4-7
+   */
+  const __m128i r_lo = _mm_setr_epi8 (-1, 0, -1, 3, -1, 6, -1, 9,
+				      -1, -1, -1, -1, -1, -1, -1, -1);
+  const __m128i r_hi = _mm_setr_epi8 (-1, -1, -1, -1, -1, -1, -1, -1,
+				      -1, 0, -1, 3, -1, 6, -1, 9);
+  const __m128i g_lo = _mm_setr_epi8 (1, -1, 4, -1, 7, -1, 10, -1,
+				      -1, -1, -1, -1, -1, -1, -1, -1);
+  const __m128i g_hi = _mm_setr_epi8 (-1, -1, -1, -1, -1, -1, -1, -1,
+				      1, -1, 4, -1, 7, -1, 10, -1);
+  const __m128i b_lo = _mm_setr_epi8 (2, -1, 5, -1, 8, -1, 11, -1,
+				      -1, -1, -1, -1, -1, -1, -1, -1);
+  const __m128i b_hi = _mm_setr_epi8 (-1, -1, -1, -1, -1, -1, -1, -1,
+				      2, -1, 5, -1, 8, -1, 11, -1);
+
+  for (; width >= 16; width -= 16, src += 48, dest += 32)
+    {
+      __m128i p[4];
+      bint i;
+
+      load_rgb_ssse3 (src, p);
+      for (i = 0; i < 2; i++)
+	{
+	  __m128i a = p[2 * i], b = p[2 * i + 1];
+	  __m128i r, g, bl;
+
+	  r = _mm_or_si128 (_mm_shuffle_epi8 (a, r_lo), _mm_shuffle_epi8 (b, r_hi));
+	  g = _mm_or_si128 (_mm_shuffle_epi8 (a, g_lo), _mm_shuffle_epi8 (b, g_hi));
+	  bl = _mm_or_si128 (_mm_shuffle_epi8 (a, b_lo), _mm_shuffle_epi8 (b, b_hi));
+
+	  _mm_storeu_si128 ((__m128i *) (dest + 16 * i),
+			    _mm_or_si128 (_mm_or_si128 (_mm_and_si128 (r, _mm_set1_epi16 (0xf800)),
+							_mm_and_si128 (_mm_slli_epi16 (g, 3),
+								       _mm_set1_epi16 (0x07e0))),
+					  _mm_srli_epi16 (bl, 3)));
+	}
+    }
+
+  row_565 (src, dest, width, dither, x);
+}
+
+static void TARGET_SSSE3
+row_565_d_ssse3 (const buchar  *src,
+		 buchar        *dest,
+		 bint           width,
+		 const buint32 *dither,
+		 bint           x)
+{
+  for (; width >= 16; width -= 16, src += 48, dest += 32, x += 16)
+    {
+      buint32 tmp[16];
+      const buint32 *dith = get_dither (dither, x, 16, tmp);
+      __m128i p[4], d[4];
+      bint i;
+
+      load_rgb_ssse3 (src, p);
+      for (i = 0; i < 4; i++)
+	d[i] = dither_565_ssse3 (unpack_d_ssse3 (p[i]),
+				 _mm_loadu_si128 ((const __m128i *) (dith + 4 * i)));
+
+      _mm_storeu_si128 ((__m128i *) dest, _mm_packs_epi32 (d[0], d[1]));
+      _mm_storeu_si128 ((__m128i *) (dest + 16), _mm_packs_epi32 (d[2], d[3]));
+    }
+
+  row_565_d (src, dest, width, dither, x);
+}
+
+static void TARGET_SSSE3
+row_32_0888_ssse3 (const buchar  *src,
+		   buchar        *dest,
+		   bint           width,
+		   const buint32 *dither,
+		   bint           x)
+{
+  const __m128i shuffle = _mm_setr_epi8 (2, 1, 0, -1, 6, 5, 4, -1,
+					 10, 9, 8, -1, 14, 13, 12, -1);
+  const __m128i alpha = _mm_set1_epi32 (0xff000000);
+
+  for (; width >= 4; width -= 4, src += 16, dest += 16)
+    _mm_storeu_si128 ((__m128i *) dest,
+		      _mm_or_si128 (_mm_shuffle_epi8 (_mm_loadu_si128 ((const __m128i *) src),
+						      shuffle),
+				    alpha));
+
+  row_32_0888 (src, dest, width, dither, x);
+}
+
+static void TARGET_SSSE3
+row_32_to_24_ssse3 (const buchar  *src,
+		    buchar        *dest,
+		    bint           width,
+		    const buint32 *dither,
+		    bint           x)
+{
+  const __m128i shuffle = _mm_setr_epi8 (0, 1, 2, 4, 5, 6, 8, 9,
+					 10, 12, 13, 14, -1, -1, -1, -1);
+
+  for (; width >= 16; width -= 16, src += 64, dest += 48)
+    {
+      __m128i p[4];
+      bint i;
+
+      for (i = 0; i < 4; i++)
+	p[i] = _mm_shuffle_epi8 (_mm_loadu_si128 ((const __m128i *) (src + 16 * i)),
+				 shuffle);
+      store_rgb_ssse3 (dest, p);
+    }
+
+  row_32_to_24 (src, dest, width, dither, x);
+}
+
+/* AVX2
+ *
+ * The byte shuffles only work within 128 bit halves, so packed RGB
+ * is split as for SSSE3 and each pair of 4 pixel vectors is joined.
+ */
+
+static inline __m256i TARGET_AVX2
+join_avx2 (__m128i lo,
+	   __m128i hi)
+{
+  return _mm256_inserti128_si256 (_mm256_castsi128_si256 (lo), hi, 1);
+}
+
+static void TARGET_AVX2
+row_0888_avx2 (const buchar  *src,
+	       buchar        *dest,
+	       bint           width,
+	       const buint32 *dither,
+	       bint           x)
+{
+  const __m256i shuffle = _mm256_setr_epi8 (2, 1, 0, -1, 5, 4, 3, -1,
+					    8, 7, 6, -1, 11, 10, 9, -1,
+					    2, 1, 0, -1, 5, 4, 3, -1,
+					    8, 7, 6, -1, 11, 10, 9, -1);
+  const __m256i alpha = _mm256_set1_epi32 (0xff000000);
+
+  for (; width >= 16; width -= 16, src += 48, dest += 64)
+    {
+      __m128i p[4];
+
+      load_rgb_ssse3 (src, p);
+      _mm256_storeu_si256 ((__m256i *) dest,
+			   _mm256_or_si256 (_mm256_shuffle_epi8 (join_avx2 (p[0], p[1]), shuffle),
+					    alpha));
+      _mm256_storeu_si256 ((__m256i *) (dest + 32),
+			   _mm256_or_si256 (_mm256_shuffle_epi8 (join_avx2 (p[2], p[3]), shuffle),
+					    alpha));
+    }
+
+  row_0888 (src, dest, width, dither, x);
+}
+
+static void TARGET_AVX2
+row_565_avx2 (const buchar  *src,
+	      buchar        *dest,
+	      bint           width,
+	      const buint32 *dither,
+	      bint           x)
+{
+  /* As for SSSE3, but the second 8 pixels go to the high 8 bytes of
+   * each half, so the 64 bit quarters need reordering at the end
+   */
+  const __m256i r_lo = _mm256_setr_epi8 (-1, 0, -1, 3, -1, 6, -1, 9,
+					 -1, -1, -1, -1, -1, -1, -1, -1,
+					 -1, 0, -1, 3, -1, 6, -1, 9,
+					 -1, -1, -1, -1, -1, -1, -1, -1);
+  const __m256i r_hi = _mm256_setr_epi8 (-1, -1, -1, -1, -1, -1, -1, -1,
+					 -1, 0, -1, 3, -1, 6, -1, 9,
+					 -1, -1, -1, -1, -1, -1, -1, -1,
+					 -1, 0, -1, 3, -1, 6, -1, 9);
+  const __m256i g_lo = _mm256_setr_epi8 (1, -1, 4, -1, 7, -1, 10, -1,
+					 -1, -1, -1, -1, -1, -1, -1, -1,
+					 1, -1, 4, -1, 7, -1, 10, -1,
+					 -1, -1, -1, -1, -1, -1, -1, -1);
+  const __m256i g_hi = _mm256_setr_epi8 (-1, -1, -1, -1, -1, -1, -1, -1,
+					 1, -1, 4, -1, 7, -1, 10, -1,
+					 -1, -1, -1, -1, -1, -1, -1, -1,
+					 1, -1, 4, -1, 7, -1, 10, -1);
+  const __m256i b_lo = _mm256_setr_epi8 (2, -1, 5, -1, 8, -1, 11, -1,
+					 -1, -1, -1, -1, -1, -1, -1, -1,
+					 2, -1, 5, -1, 8, -1, 11, -1,
+					 -1, -1, -1, -1, -1, -1, -1, -1);
+  const __m256i b_hi = _mm256_setr_epi8 (-1, -1, -1, -1, -1, -1, -1, -1,
+					 2, -1, 5, -1, 8, -1, 11, -1,
+					 -1, -1, -1, -1, -1, -1, -1, -1,
+					 2, -1, 5, -1, 8, -1, 11, -1);
+
+  for (; width >= 16; width -= 16, src += 48, dest += 32)
+    {
+      __m128i p[4];
+      __m256i a, b, r, g, bl, q;
+
+      load_rgb_ssse3 (src, p);
+      a = join_avx2 (p[0], p[1]);
+      b = join_avx2 (p[2], p[3]);
+
+      r = _mm256_or_si256 (_mm256_shuffle_epi8 (a, r_lo), _mm256_shuffle_epi8 (b, r_hi));
+      g = _mm256_or_si256 (_mm256_shuffle_epi8 (a, g_lo), _mm256_shuffle_epi8 (b, g_hi));
+      bl = _mm256_or_si256 (_mm256_shuffle_epi8 (a, b_lo), _mm256_shuffle_epi8 (b, b_hi));
+
+      q = _mm256_or_si256 (_mm256_or_si256 (_mm256_and_si256 (r, _mm256_set1_epi16 (0xf800)),
+					    _mm256_and_si256 (_mm256_slli_epi16 (g, 3),
+							      _mm256_set1_epi16 (0x07e0))),
+			   _mm256_srli_epi16 (bl, 3));
+
+      _mm256_storeu_si256 ((__m256i *) dest,
+			   _mm256_permute4x64_epi64 (q, _MM_SHUFFLE (3, 1, 2, 0)));
+    }
+
+  row_565 (src, dest, width, dither, x);
+}
+
+static inline __m256i TARGET_AVX2
+unpack_d_avx2 (__m256i p)
+{
+  const __m256i r = _mm256_setr_epi8 (-1, -1, 0, -1, -1, -1, 3, -1,
+				      -1, -1, 6, -1, -1, -1, 9, -1,
+				      -1, -1, 0, -1, -1, -1, 3, -1,
+				      -1, -1, 6, -1, -1, -1, 9, -1);
+  const __m256i g = _mm256_setr_epi8 (-1, 1, -1, -1, -1, 4, -1, -1,
+				      -1, 7, -1, -1, -1, 10, -1, -1,
+				      -1, 1, -1, -1, -1, 4, -1, -1,
+				      -1, 7, -1, -1, -1, 10, -1, -1);
+  const __m256i b = _mm256_setr_epi8 (2, -1, -1, -1, 5, -1, -1, -1,
+				      8, -1, -1, -1, 11, -1, -1, -1,
+				      2, -1, -1, -1, 5, -1, -1, -1,
+				      8, -1, -1, -1, 11, -1, -1, -1);
+
+  return _mm256_add_epi32 (_mm256_add_epi32 (_mm256_slli_epi32 (_mm256_shuffle_epi8 (p, r), 4),
+					     _mm256_slli_epi32 (_mm256_shuffle_epi8 (p, g), 2)),
+			   _mm256_shuffle_epi8 (p, b));
+}
+
+static inline __m256i TARGET_AVX2
+dither_565_avx2 (__m256i rgb,
+		 __m256i dith)
+{
+  __m256i t;
+
+  rgb = _mm256_add_epi32 (rgb, dith);
+  t = _mm256_add_epi32 (rgb, _mm256_set1_epi32 (0x10040100));
+  t = _mm256_sub_epi32 (t, _mm256_srli_epi32 (_mm256_and_si256 (rgb, _mm256_set1_epi32 (0x1e0001e0)), 5));
+  t = _mm256_sub_epi32 (t, _mm256_srli_epi32 (_mm256_and_si256 (rgb, _mm256_set1_epi32 (0x00070000)), 6));
+
+  t = _mm256_or_si256 (_mm256_or_si256 (_mm256_srli_epi32 (_mm256_and_si256 (t, _mm256_set1_epi32 (0x0f800000)), 12),
+					_mm256_srli_epi32 (_mm256_and_si256 (t, _mm256_set1_epi32 (0x0003f000)), 7)),
+		       _mm256_srli_epi32 (_mm256_and_si256 (t, _mm256_set1_epi32 (0x000000f8)), 3));
+
+  return _mm256_srai_epi32 (_mm256_slli_epi32 (t, 16), 16);
+}
+
+static void TARGET_AVX2
+row_565_d_avx2 (const buchar  *src,
+		buchar        *dest,
+		bint           width,
+		const buint32 *dither,
+		bint           x)
+{
+  for (; width >= 16; width -= 16, src += 48, dest += 32, x += 16)
+    {
+      buint32 tmp[16];
+      const buint32 *dith = get_dither (dither, x, 16, tmp);
+      __m128i p[4];
+      __m256i a, b;
+
+      load_rgb_ssse3 (src, p);
+      a = dither_565_avx2 (unpack_d_avx2 (join_avx2 (p[0], p[1])),
+			   _mm256_loadu_si256 ((const __m256i *) dith));
+      b = dither_565_avx2 (unpack_d_avx2 (join_avx2 (p[2], p[3])),
+			   _mm256_loadu_si256 ((const __m256i *) (dith + 8)));
+
+      _mm256_storeu_si256 ((__m256i *) dest,
+			   _mm256_permute4x64_epi64 (_mm256_packs_epi32 (a, b),
+						     _MM_SHUFFLE (3, 1, 2, 0)));
+    }
+
+  row_565_d (src, dest, width, dither, x);
+}
+
+static void TARGET_AVX2
+row_32_0888_avx2 (const buchar  *src,
+		  buchar        *dest,
+		  bint           width,
+		  const buint32 *dither,
+		  bint           x)
+{
+  const __m256i shuffle = _mm256_setr_epi8 (2, 1, 0, -1, 6, 5, 4, -1,
+					    10, 9, 8, -1, 14, 13, 12, -1,
+					    2, 1, 0, -1, 6, 5, 4, -1,
+					    10, 9, 8, -1, 14, 13, 12, -1);
+  const __m256i alpha = _mm256_set1_epi32 (0xff000000);
+
+  for (; width >= 8; width -= 8, src += 32, dest += 32)
+    _mm256_storeu_si256 ((__m256i *) dest,
+			 _mm256_or_si256 (_mm256_shuffle_epi8 (_mm256_loadu_si256 ((const __m256i *) src),
+							       shuffle),
+					  alpha));
+
+  row_32_0888 (src, dest, width, dither, x);
+}
+
+#endif /* BDK_SIMD_X86 */
+
+#ifdef BDK_SIMD_ARM_NEON
+
+/* NEON
+ *
+ * The structure loads and stores do the (de)interleaving, 16 pixels
+ * at a time.
+ */
+
+static void
+row_0888_neon (const buchar  *src,
+	       buchar        *dest,
+	       bint           width,
+	       const buint32 *dither,
+	       bint           x)
+{
+  for (; width >= 16; width -= 16, src += 48, dest += 64)
+    {
+      uint8x16x3_t p = vld3q_u8 (src);
+      uint8x16x4_t q;
+
+      q.val[0] = p.val[2];
+      q.val[1] = p.val[1];
+      q.val[2] = p.val[0];
+      q.val[3] = vdupq_n_u8 (0xff);
+      vst4q_u8 (dest, q);
+    }
+
+  row_0888 (src, dest, width, dither, x);
+}
+
+static void
+row_0888_br_neon (const buchar  *src,
+		  buchar        *dest,
+		  bint           width,
+		  const buint32 *dither,
+		  bint           x)
+{
+  for (; width >= 16; width -= 16, src += 48, dest += 64)
+    {
+      uint8x16x3_t p = vld3q_u8 (src);
+      uint8x16x4_t q;
+
+      q.val[0] = vdupq_n_u8 (0xff);
+      q.val[1] = p.val[0];
+      q.val[2] = p.val[1];
+      q.val[3] = p.val[2];
+      vst4q_u8 (dest, q);
+    }
+
+  row_0888_br (src, dest, width, dither, x);
+}
+
+static void
+row_888_lsb_neon (const buchar  *src,
+		  buchar        *dest,
+		  bint           width,
+		  const buint32 *dither,
+		  bint           x)
+{
+  for (; width >= 16; width -= 16, src += 48, dest += 48)
+    {
+      uint8x16x3_t p = vld3q_u8 (src);
+      uint8x16x3_t q;
+
+      q.val[0] = p.val[2];
+      q.val[1] = p.val[1];
+      q.val[2] = p.val[0];
+      vst3q_u8 (dest, q);
+    }
+
+  row_888_lsb (src, dest, width, dither, x);
+}
+
+static inline uint16x8_t
+pack_565_neon (uint8x8_t r,
+	       uint8x8_t g,
+	       uint8x8_t b)
+{
+  uint16x8_t q;
+
+  q = vandq_u16 (vshll_n_u8 (r, 8), vdupq_n_u16 (0xf800));
+  q = vorrq_u16 (q, vandq_u16 (vshll_n_u8 (g, 3), vdupq_n_u16 (0x07e0)));
+  q = vorrq_u16 (q, vmovl_u8 (vshr_n_u8 (b, 3)));
+
+  return q;
+}
+
+static void
+row_565_neon (const buchar  *src,
+	      buchar        *dest,
+	      bint           width,
+	      const buint32 *dither,
+	      bint           x)
+{
+  for (; width >= 16; width -= 16, src += 48, dest += 32)
+    {
+      uint8x16x3_t p = vld3q_u8 (src);
+
+      vst1q_u8 (dest,
+		vreinterpretq_u8_u16 (pack_565_neon (vget_low_u8 (p.val[0]),
+						     vget_low_u8 (p.val[1]),
+						     vget_low_u8 (p.val[2]))));
+      vst1q_u8 (dest + 16,
+		vreinterpretq_u8_u16 (pack_565_neon (vget_high_u8 (p.val[0]),
+						     vget_high_u8 (p.val[1]),
+						     vget_high_u8 (p.val[2]))));
+    }
+
+  row_565 (src, dest, width, dither, x);
+}
+
+/* pixel_565_d() for 4 pixels, given as 16 bit lanes */
+static inline uint16x4_t
+dither_565_neon (uint16x4_t     r,
+		 uint16x4_t     g,
+		 uint16x4_t     b,
+		 const buint32 *dith)
+{
+  uint32x4_t rgb, t;
+
+  rgb = vshlq_n_u32 (vmovl_u16 (r), 20);
+  rgb = vaddq_u32 (rgb, vshlq_n_u32 (vmovl_u16 (g), 10));
+  rgb = vaddq_u32 (rgb, vmovl_u16 (b));
+  rgb = vaddq_u32 (rgb, vld1q_u32 (dith));
+
+  t = vaddq_u32 (rgb, vdupq_n_u32 (0x10040100));
+  t = vsubq_u32 (t, vshrq_n_u32 (vandq_u32 (rgb, vdupq_n_u32 (0x1e0001e0)), 5));
+  t = vsubq_u32 (t, vshrq_n_u32 (vandq_u32 (rgb, vdupq_n_u32 (0x00070000)), 6));
+
+  t = vorrq_u32 (vorrq_u32 (vshrq_n_u32 (vandq_u32 (t, vdupq_n_u32 (0x0f800000)), 12),
+			    vshrq_n_u32 (vandq_u32 (t, vdupq_n_u32 (0x0003f000)), 7)),
+		 vshrq_n_u32 (vandq_u32 (t, vdupq_n_u32 (0x000000f8)), 3));
+
+  return vmovn_u32 (t);
+}
+
+static void
+row_565_d_neon (const buchar  *src,
+		buchar        *dest,
+		bint           width,
+		const buint32 *dither,
+		bint           x)
+{
+  for (; width >= 16; width -= 16, src += 48, dest += 32, x += 16)
+    {
+      buint32 tmp[16];
+      const buint32 *dith = get_dither (dither, x, 16, tmp);
+      uint8x16x3_t p = vld3q_u8 (src);
+      uint16x8_t r, g, b;
+      bint i;
+
+      for (i = 0; i < 2; i++)
+	{
+	  if (i == 0)
+	    {
+	      r = vmovl_u8 (vget_low_u8 (p.val[0]));
+	      g = vmovl_u8 (vget_low_u8 (p.val[1]));
+	      b = vmovl_u8 (vget_low_u8 (p.val[2]));
+	    }
+	  else
+	    {
+	      r = vmovl_u8 (vget_high_u8 (p.val[0]));
+	      g = vmovl_u8 (vget_high_u8 (p.val[1]));
+	      b = vmovl_u8 (vget_high_u8 (p.val[2]));
+	    }
+
+	  vst1q_u8 (dest + 16 * i,
+		    vreinterpretq_u8_u16 (vcombine_u16 (dither_565_neon (vget_low_u16 (r),
+									 vget_low_u16 (g),
+									 vget_low_u16 (b),
+									 dith + 8 * i),
+							dither_565_neon (vget_high_u16 (r),
+									 vget_high_u16 (g),
+									 vget_high_u16 (b),
+									 dith + 8 * i + 4))));
+	}
+    }
+
+  row_565_d (src, dest, width, dither, x);
+}
+
+static void
+row_32_0888_neon (const buchar  *src,
+		  buchar        *dest,
+		  bint           width,
+		  const buint32 *dither,
+		  bint           x)
+{
+  for (; width >= 16; width -= 16, src += 64, dest += 64)
+    {
+      uint8x16x4_t p = vld4q_u8 (src);
+      uint8x16x4_t q;
+
+      q.val[0] = p.val[2];
+      q.val[1] = p.val[1];
+      q.val[2] = p.val[0];
+      q.val[3] = vdupq_n_u8 (0xff);
+      vst4q_u8 (dest, q);
+    }
+
+  row_32_0888 (src, dest, width, dither, x);
+}
+
+static void
+row_32_to_24_neon (const buchar  *src,
+		   buchar        *dest,
+		   bint           width,
+		   const buint32 *dither,
+		   bint           x)
+{
+  for (; width >= 16; width -= 16, src += 64, dest += 48)
+    {
+      uint8x16x4_t p = vld4q_u8 (src);
+      uint8x16x3_t q;
+
+      q.val[0] = p.val[0];
+      q.val[1] = p.val[1];
+      q.val[2] = p.val[2];
+      vst3q_u8 (dest, q);
+    }
+
+  row_32_to_24 (src, dest, width, dither, x);
+}
+
+#endif /* BDK_SIMD_ARM_NEON */
+
+/* Returns the fastest row conversion for @format that only uses the
+ * instruction sets in @flags.  Pass 0 to get the plain C one.
+ */
+BdkRgbRowFunc
+_bdk_rgb_row_get_func (BdkRgbRowFormat format,
+		       BdkSimdFlags    flags)
+{
+  switch (format)
+    {
+    case BDK_RGB_ROW_0888:
+#ifdef BDK_SIMD_X86
+      if (flags & BDK_SIMD_AVX2)
+	return row_0888_avx2;
+      if (flags & BDK_SIMD_SSSE3)
+	return row_0888_ssse3;
+#endif
+#ifdef BDK_SIMD_ARM_NEON
+      if (flags & BDK_SIMD_NEON)
+	return row_0888_neon;
+#endif
+      return row_0888;
+
+    case BDK_RGB_ROW_0888_BR:
+#ifdef BDK_SIMD_X86
+      if (flags & BDK_SIMD_SSSE3)
+	return row_0888_br_ssse3;
+#endif
+#ifdef BDK_SIMD_ARM_NEON
+      if (flags & BDK_SIMD_NEON)
+	return row_0888_br_neon;
+#endif
+      return row_0888_br;
+
+    case BDK_RGB_ROW_888_LSB:
+#ifdef BDK_SIMD_X86
+      if (flags & BDK_SIMD_SSSE3)
+	return row_888_lsb_ssse3;
+#endif
+#ifdef BDK_SIMD_ARM_NEON
+      if (flags & BDK_SIMD_NEON)
+	return row_888_lsb_neon;
+#endif
+      return row_888_lsb;
+
+    case BDK_RGB_ROW_565:
+#ifdef BDK_SIMD_X86
+      if (flags & BDK_SIMD_AVX2)
+	return row_565_avx2;
+      if (flags & BDK_SIMD_SSSE3)
+	return row_565_ssse3;
+#endif
+#ifdef BDK_SIMD_ARM_NEON
+      if (flags & BDK_SIMD_NEON)
+	return row_565_neon;
+#endif
+      return row_565;
+
+    case BDK_RGB_ROW_565_D:
+#ifdef BDK_SIMD_X86
+      if (flags & BDK_SIMD_AVX2)
+	return row_565_d_avx2;
+      if (flags & BDK_SIMD_SSSE3)
+	return row_565_d_ssse3;
+#endif
+#ifdef BDK_SIMD_ARM_NEON
+      if (flags & BDK_SIMD_NEON)
+	return row_565_d_neon;
+#endif
+      return row_565_d;
+
+    case BDK_RGB_ROW_32_0888:
+#ifdef BDK_SIMD_X86
+      if (flags & BDK_SIMD_AVX2)
+	return row_32_0888_avx2;
+      if (flags & BDK_SIMD_SSSE3)
+	return row_32_0888_ssse3;
+#endif
+#ifdef BDK_SIMD_ARM_NEON
+      if (flags & BDK_SIMD_NEON)
+	return row_32_0888_neon;
+#endif
+      return row_32_0888;
+
+    case BDK_RGB_ROW_32_TO_24:
+#ifdef BDK_SIMD_X86
+      if (flags & BDK_SIMD_SSSE3)
+	return row_32_to_24_ssse3;
+#endif
+#ifdef BDK_SIMD_ARM_NEON
+      if (flags & BDK_SIMD_NEON)
+	return row_32_to_24_neon;
+#endif
+      return row_32_to_24;
+    }
+
+  return NULL;
+}
@@ -0,0 +1,69 @@
+/* BDK - The GIMP Drawing Kit
+ * Copyright (C) 1995-1997 Peter Mattis, Spencer Kimball and Josh MacDonald
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include "config.h"
+
+#include <stdlib.h>
+
+#include "bdksimd.h"
+
+static BdkSimdFlags
+detect_flags (void)
+{
+  BdkSimdFlags flags = 0;
+
+#ifdef BDK_SIMD_X86
+  __builtin_cpu_init ();
+
+  if (__builtin_cpu_supports ("sse2"))
+    flags |= BDK_SIMD_SSE2;
+  if (__builtin_cpu_supports ("ssse3"))
+    flags |= BDK_SIMD_SSSE3;
+  /* This also checks that the OS saves the AVX registers */
+  if (__builtin_cpu_supports ("avx2"))
+    flags |= BDK_SIMD_AVX2;
+#endif
+
+#ifdef BDK_SIMD_ARM_NEON
+  /* Built for a CPU that has it */
+  flags |= BDK_SIMD_NEON;
+#endif
+
+  return flags;
+}
+
+/* Returns the vector instruction sets that the pixel loops may use.
+ * Setting BDK_DISABLE_SIMD in the environment turns them all off, so
+ * that the portable code can be compared against.
+ */
+BdkSimdFlags
+_bdk_simd_get_flags (void)
+{
+  static bint flags = -1;
+
+  if (flags < 0)
+    {
+      if (getenv ("BDK_DISABLE_SIMD"))
+	flags = 0;
+      else
+	flags = detect_flags ();
+    }
+
+  return flags;
+}
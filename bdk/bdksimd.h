@@ -0,0 +1,125 @@
+/* BDK - The GIMP Drawing Kit
+ * Copyright (C) 1995-1997 Peter Mattis, Spencer Kimball and Josh MacDonald
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Uninstalled header for the vectorized pixel loops in BDK.
+ * The compositing loops are in bdkcomposite.c, the BdkRGB ones in
+ * bdkrgbconv.c and the image to pixbuf ones in bdkpixbufconv.c.
+ *
+ * Every kernel has a portable C version, which defines the results;
+ * the vector versions must match it bit for bit.  Which versions are
+ * used is decided at runtime from the CPU features, see
+ * _bdk_simd_get_flags().
+ */
+
+#ifndef __BDK_SIMD_H__
+#define __BDK_SIMD_H__
+
+#include <bdk/bdktypes.h>
+
+B_BEGIN_DECLS
+
+/* The vector code needs per-function target attributes so that the
+ * rest of BDK can still be built for the baseline CPU.
+ */
+#if (defined (__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)) || \
+     defined (__clang__)) && (defined (__i386__) || defined (__x86_64__))
+#define BDK_SIMD_X86 1
+#endif
+
+#if defined (__ARM_NEON) || defined (__ARM_NEON__)
+#define BDK_SIMD_ARM_NEON 1
+#endif
+
+typedef enum {
+  BDK_SIMD_SSE2  = 1 << 0,
+  BDK_SIMD_SSSE3 = 1 << 1,
+  BDK_SIMD_AVX2  = 1 << 2,
+  BDK_SIMD_NEON  = 1 << 3
+} BdkSimdFlags;
+
+BdkSimdFlags _bdk_simd_get_flags (void);
+
+/* Alpha compositing of RGBA pixbuf data onto image data, as done by
+ * bdk_draw_pixbuf().  @dest_byte_order is only used for the 0888 format.
+ */
+typedef void (*BdkCompositeFunc) (buchar       *src_buf,
+				  bint          src_rowstride,
+				  buchar       *dest_buf,
+				  bint          dest_rowstride,
+				  BdkByteOrder  dest_byte_order,
+				  bint          width,
+				  bint          height);
+
+typedef enum {
+  BDK_COMPOSITE_RGB,	/* packed 24 bit R, G, B */
+  BDK_COMPOSITE_0888,	/* 32 bit 0x00rrggbb words */
+  BDK_COMPOSITE_565	/* 16 bit 5-6-5 words in host byte order */
+} BdkCompositeFormat;
+
+BdkCompositeFunc _bdk_composite_get_func (BdkCompositeFormat format,
+					  BdkSimdFlags       flags);
+
+/* Conversion of one row of packed RGB (RGBx for the _32 formats) to
+ * image data, as done by BdkRGB for truecolor visuals.  @dither is a
+ * row of the 5-6-5 dither matrix, indexed from @x and wrapping every
+ * BDK_RGB_ROW_DITHER_WIDTH pixels; only BDK_RGB_ROW_565_D uses them.
+ */
+typedef void (*BdkRgbRowFunc) (const buchar  *src,
+			       buchar        *dest,
+			       bint           width,
+			       const buint32 *dither,
+			       bint           x);
+
+#define BDK_RGB_ROW_DITHER_WIDTH 128
+
+typedef enum {
+  BDK_RGB_ROW_0888,	/* B, G, R, 0xff bytes */
+  BDK_RGB_ROW_0888_BR,	/* 0xff, R, G, B bytes */
+  BDK_RGB_ROW_888_LSB,	/* B, G, R bytes */
+  BDK_RGB_ROW_565,	/* 16 bit 5-6-5 words in host byte order */
+  BDK_RGB_ROW_565_D,	/* the same, dithered */
+  BDK_RGB_ROW_32_0888,	/* RGBx to B, G, R, 0xff bytes */
+  BDK_RGB_ROW_32_TO_24	/* RGBx to packed R, G, B */
+} BdkRgbRowFormat;
+
+BdkRgbRowFunc _bdk_rgb_row_get_func (BdkRgbRowFormat format,
+				     BdkSimdFlags    flags);
+
+/* Conversion of one row of image data to packed RGB, or RGBA with
+ * opaque alpha, as done by bdk_pixbuf_get_from_image() for the common
+ * truecolor visuals.
+ */
+typedef void (*BdkUnpackRowFunc) (const buchar *src,
+				  buchar       *dest,
+				  bint          width);
+
+typedef enum {
+  BDK_UNPACK_ROW_0888_LSB,	/* B, G, R, x bytes */
+  BDK_UNPACK_ROW_0888_MSB,	/* x, R, G, B bytes */
+  BDK_UNPACK_ROW_565_LSB,	/* 16 bit 5-6-5 words, least significant byte first */
+  BDK_UNPACK_ROW_565_MSB	/* the same, most significant byte first */
+} BdkUnpackRowFormat;
+
+BdkUnpackRowFunc _bdk_unpack_row_get_func (BdkUnpackRowFormat format,
+					   bboolean           alpha,
+					   BdkSimdFlags       flags);
+
+B_END_DECLS
+
+#endif /* __BDK_SIMD_H__ */
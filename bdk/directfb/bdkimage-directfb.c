@@ -396,6 +396,21 @@ bdk_directfb_image_destroy (BdkImage *image)
   image->windowing_data = NULL;
 }
 
+bboolean
+_bdk_windowing_image_wait (BdkImage *image)
+{
+  return FALSE;
+}
+
+BdkImage *
+_bdk_windowing_image_get_readback (BdkScreen *screen,
+                                   bint       width,
+                                   bint       height,
+                                   bint       depth)
+{
+  return NULL;
+}
+
 bint
 _bdk_windowing_get_bits_for_depth (BdkDisplay *display,
                                    bint        depth)
@@ -373,6 +373,21 @@ bdk_image_put_pixel (BdkImage *image,
   *(buint32 *)ptr = pixel;
 }
 
+bboolean
+_bdk_windowing_image_wait (BdkImage *image)
+{
+  return FALSE;
+}
+
+BdkImage *
+_bdk_windowing_image_get_readback (BdkScreen *screen,
+				   bint       width,
+				   bint       height,
+				   bint       depth)
+{
+  return NULL;
+}
+
 bint
 _bdk_windowing_get_bits_for_depth (BdkDisplay *display,
 				   bint        depth)
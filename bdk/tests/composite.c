@@ -0,0 +1,152 @@
+/* Tests for the vectorized compositing loops
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <string.h>
+
+#include "bdk/bdksimd.h"
+
+/* Every set of flags that selects a different loop */
+static const BdkSimdFlags flag_sets[] = {
+  BDK_SIMD_SSE2,
+  BDK_SIMD_SSE2 | BDK_SIMD_SSSE3,
+  BDK_SIMD_SSE2 | BDK_SIMD_SSSE3 | BDK_SIMD_AVX2,
+  BDK_SIMD_NEON
+};
+
+static void
+fill_source (GRand  *rand,
+	     buchar *buf,
+	     bint    len)
+{
+  bint i;
+
+  for (i = 0; i < len; i++)
+    buf[i] = g_rand_int_range (rand, 0, 256);
+
+  /* Lots of fully transparent and opaque pixels, and a transparent
+   * run at the start, like icons have
+   */
+  for (i = 3; i < len; i += 4)
+    {
+      switch (g_rand_int_range (rand, 0, 4))
+	{
+	case 0:
+	  buf[i] = 0;
+	  break;
+	case 1:
+	  buf[i] = 255;
+	  break;
+	}
+    }
+  for (i = 3; i < MIN (len, 64); i += 4)
+    buf[i] = 0;
+}
+
+static void
+check_format (BdkCompositeFormat format,
+	      bint               bpp)
+{
+  BdkSimdFlags available = _bdk_simd_get_flags ();
+  BdkCompositeFunc reference;
+  GRand *rand;
+  bint i, width, height, order;
+
+  reference = _bdk_composite_get_func (format, 0);
+  rand = g_rand_new_with_seed (42);
+
+  for (i = 0; i < (bint) G_N_ELEMENTS (flag_sets); i++)
+    {
+      BdkCompositeFunc func;
+
+      if ((flag_sets[i] & available) != flag_sets[i])
+	continue;
+
+      func = _bdk_composite_get_func (format, flag_sets[i]);
+      if (func == reference)
+	continue;
+
+      for (order = BDK_LSB_FIRST; order <= BDK_MSB_FIRST; order++)
+	for (width = 0; width < 70; width++)
+	  for (height = 1; height < 4; height++)
+	    {
+	      /* Odd strides and offsets so nothing is aligned beyond
+	       * the size of a pixel
+	       */
+	      bint src_rowstride = width * 4 + 5;
+	      bint dest_rowstride = width * bpp + (bpp == 2 ? 6 : 7);
+	      bint dest_offset = bpp == 2 ? 2 : 1;
+	      bint dest_size = dest_rowstride * height + dest_offset;
+	      buchar *src, *expected, *dest;
+
+	      src = g_malloc (src_rowstride * height + 1);
+	      expected = g_malloc (dest_size);
+	      dest = g_malloc (dest_size);
+
+	      fill_source (rand, src + 1, src_rowstride * height);
+	      fill_source (rand, expected, dest_size);
+	      memcpy (dest, expected, dest_size);
+
+	      reference (src + 1, src_rowstride,
+			 expected + dest_offset, dest_rowstride,
+			 order, width, height);
+	      func (src + 1, src_rowstride,
+		    dest + dest_offset, dest_rowstride,
+		    order, width, height);
+
+	      if (memcmp (expected, dest, dest_size) != 0)
+		g_error ("flags %x, byte order %d, %d x %d differs from the C version",
+			 flag_sets[i], order, width, height);
+
+	      g_free (src);
+	      g_free (expected);
+	      g_free (dest);
+	    }
+    }
+
+  g_rand_free (rand);
+}
+
+static void
+test_composite_rgb (void)
+{
+  check_format (BDK_COMPOSITE_RGB, 3);
+}
+
+static void
+test_composite_0888 (void)
+{
+  check_format (BDK_COMPOSITE_0888, 4);
+}
+
+static void
+test_composite_565 (void)
+{
+  check_format (BDK_COMPOSITE_565, 2);
+}
+
+int
+main (int argc, char **argv)
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/composite/rgb", test_composite_rgb);
+  g_test_add_func ("/composite/0888", test_composite_0888);
+  g_test_add_func ("/composite/565", test_composite_565);
+
+  return g_test_run ();
+}
@@ -0,0 +1,139 @@
+/* Tests for the vectorized image to pixbuf unpacking loops
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <string.h>
+
+#include "bdk/bdksimd.h"
+
+/* Every set of flags that selects a different loop */
+static const BdkSimdFlags flag_sets[] = {
+  BDK_SIMD_SSE2 | BDK_SIMD_SSSE3,
+  BDK_SIMD_SSE2 | BDK_SIMD_SSSE3 | BDK_SIMD_AVX2,
+  BDK_SIMD_NEON
+};
+
+static void
+check_format (BdkUnpackRowFormat format,
+	      bboolean           alpha,
+	      bint               src_bpp)
+{
+  BdkSimdFlags available = _bdk_simd_get_flags ();
+  BdkUnpackRowFunc reference;
+  bint dest_bpp = alpha ? 4 : 3;
+  GRand *rand;
+  bint i, j, width;
+
+  reference = _bdk_unpack_row_get_func (format, alpha, 0);
+  rand = g_rand_new_with_seed (42);
+
+  for (i = 0; i < (bint) G_N_ELEMENTS (flag_sets); i++)
+    {
+      BdkUnpackRowFunc func;
+
+      if ((flag_sets[i] & available) != flag_sets[i])
+	continue;
+
+      func = _bdk_unpack_row_get_func (format, alpha, flag_sets[i]);
+      if (func == reference)
+	continue;
+
+      for (width = 0; width < 100; width++)
+	{
+	  /* The source is only aligned to its pixel size, like
+	   * BdkImage rows, the destination is unaligned like
+	   * pixbuf rows at an odd x
+	   */
+	  bint dest_size = width * dest_bpp + 8;
+	  buchar *src, *expected, *dest;
+
+	  src = g_malloc (width * src_bpp + src_bpp);
+	  expected = g_malloc (dest_size);
+	  dest = g_malloc (dest_size);
+
+	  for (j = 0; j < width * src_bpp; j++)
+	    src[j + src_bpp] = g_rand_int_range (rand, 0, 256);
+	  for (j = 0; j < dest_size; j++)
+	    expected[j] = g_rand_int_range (rand, 0, 256);
+	  memcpy (dest, expected, dest_size);
+
+	  reference (src + src_bpp, expected + 3, width);
+	  func (src + src_bpp, dest + 3, width);
+
+	  if (memcmp (expected, dest, dest_size) != 0)
+	    g_error ("format %d, alpha %d, flags %x, width %d differs from the C version",
+		     format, alpha, flag_sets[i], width);
+
+	  g_free (src);
+	  g_free (expected);
+	  g_free (dest);
+	}
+    }
+
+  g_rand_free (rand);
+}
+
+/* The C versions against the conversions in bdkpixbuf-drawable.c */
+static void
+test_reference (void)
+{
+  const buchar src_0888[] = { 0x12, 0x34, 0x56, 0x78 };
+  const buchar src_565[] = { 0xff, 0xff, 0x1f, 0x00, 0xe0, 0x07, 0x00, 0xf8,
+			     0x00, 0x00, 0x5a, 0xa5 };
+  const buchar rgb_565[] = { 0xff, 0xff, 0xff, 0x00, 0x00, 0xff,
+			     0x00, 0xff, 0x00, 0xff, 0x00, 0x00,
+			     0x00, 0x00, 0x00, 0xa5, 0xaa, 0xd6 };
+  buchar dest[24];
+
+  _bdk_unpack_row_get_func (BDK_UNPACK_ROW_0888_LSB, TRUE, 0) (src_0888, dest, 1);
+  g_assert (memcmp (dest, "\x56\x34\x12\xff", 4) == 0);
+  _bdk_unpack_row_get_func (BDK_UNPACK_ROW_0888_MSB, FALSE, 0) (src_0888, dest, 1);
+  g_assert (memcmp (dest, "\x34\x56\x78", 3) == 0);
+
+  _bdk_unpack_row_get_func (BDK_UNPACK_ROW_565_LSB, FALSE, 0) (src_565, dest, 6);
+  g_assert (memcmp (dest, rgb_565, sizeof (rgb_565)) == 0);
+}
+
+static void
+test_unpack_0888 (void)
+{
+  check_format (BDK_UNPACK_ROW_0888_LSB, FALSE, 4);
+  check_format (BDK_UNPACK_ROW_0888_LSB, TRUE, 4);
+  check_format (BDK_UNPACK_ROW_0888_MSB, FALSE, 4);
+  check_format (BDK_UNPACK_ROW_0888_MSB, TRUE, 4);
+}
+
+static void
+test_unpack_565 (void)
+{
+  check_format (BDK_UNPACK_ROW_565_LSB, FALSE, 2);
+  check_format (BDK_UNPACK_ROW_565_LSB, TRUE, 2);
+  check_format (BDK_UNPACK_ROW_565_MSB, FALSE, 2);
+  check_format (BDK_UNPACK_ROW_565_MSB, TRUE, 2);
+}
+
+int
+main (int argc, char **argv)
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/pixbufconv/reference", test_reference);
+  g_test_add_func ("/pixbufconv/0888", test_unpack_0888);
+  g_test_add_func ("/pixbufconv/565", test_unpack_565);
+
+  return g_test_run ();
+}
@@ -0,0 +1,166 @@
+/* Tests for the server side copies kept by bdkpixbuf-render.c
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <string.h>
+
+#include <bdk/bdk.h>
+
+#define WIDTH  3
+#define HEIGHT 2
+
+/* The FNV-1a steps of the checksum in bdkpixbuf-render.c */
+#define FNV_BASIS 2166136261u
+#define FNV_PRIME 16777619u
+
+static void
+fill_pixbuf (BdkPixbuf *pixbuf,
+	     buchar     seed)
+{
+  buchar *pixels = bdk_pixbuf_get_pixels (pixbuf);
+  bint rowstride = bdk_pixbuf_get_rowstride (pixbuf);
+  bint x, y;
+
+  for (y = 0; y < HEIGHT; y++)
+    for (x = 0; x < WIDTH * 3; x++)
+      pixels[y * rowstride + x] = seed + 37 * y + 11 * x;
+}
+
+/* Changes the first two words of @pixbuf, keeping its checksum */
+static void
+change_keeping_checksum (BdkPixbuf *pixbuf)
+{
+  buchar *pixels = bdk_pixbuf_get_pixels (pixbuf);
+  buint32 a1, a2, b1, b2;
+
+  memcpy (&a1, pixels, 4);
+  memcpy (&a2, pixels + 4, 4);
+
+  b1 = a1 ^ 0x00ff00ff;
+  b2 = ((FNV_BASIS ^ b1) * FNV_PRIME) ^ ((FNV_BASIS ^ a1) * FNV_PRIME) ^ a2;
+
+  memcpy (pixels, &b1, 4);
+  memcpy (pixels + 4, &b2, 4);
+}
+
+/* Renders @pixbuf like a window icon and checks that the server has
+ * its current pixels
+ */
+static void
+render_and_check (BdkPixbuf   *pixbuf,
+		  BdkColormap *colormap)
+{
+  BdkPixmap *pixmap;
+  BdkPixbuf *result;
+  bint y;
+
+  bdk_pixbuf_render_pixmap_and_mask_for_colormap (pixbuf, colormap,
+						  &pixmap, NULL, 128);
+  result = bdk_pixbuf_get_from_drawable (NULL, pixmap, colormap,
+					 0, 0, 0, 0, WIDTH, HEIGHT);
+  g_assert (result != NULL);
+
+  for (y = 0; y < HEIGHT; y++)
+    g_assert (memcmp (bdk_pixbuf_get_pixels (pixbuf) + y * bdk_pixbuf_get_rowstride (pixbuf),
+		      bdk_pixbuf_get_pixels (result) + y * bdk_pixbuf_get_rowstride (result),
+		      WIDTH * 3) == 0);
+
+  g_object_unref (result);
+  g_object_unref (pixmap);
+}
+
+static BdkColormap *
+get_truecolor_colormap (void)
+{
+  BdkColormap *colormap = bdk_screen_get_system_colormap (bdk_screen_get_default ());
+  BdkVisual *visual = bdk_colormap_get_visual (colormap);
+
+  /* Only these get server side copies, and read back exactly */
+  if (visual->type != BDK_VISUAL_TRUE_COLOR || visual->depth < 24)
+    {
+      g_test_message ("The system visual is not 24 bit truecolor, skipping");
+      return NULL;
+    }
+
+  return colormap;
+}
+
+static void
+test_changed_pixels (void)
+{
+  BdkColormap *colormap;
+  BdkPixbuf *pixbuf;
+
+  colormap = get_truecolor_colormap ();
+  if (!colormap)
+    return;
+
+  pixbuf = bdk_pixbuf_new (BDK_COLORSPACE_RGB, FALSE, 8, WIDTH, HEIGHT);
+
+  /* The second time makes server side copies, the third uses them */
+  fill_pixbuf (pixbuf, 0);
+  render_and_check (pixbuf, colormap);
+  render_and_check (pixbuf, colormap);
+  render_and_check (pixbuf, colormap);
+
+  /* Changing the pixels in place must not show the copies */
+  fill_pixbuf (pixbuf, 100);
+  render_and_check (pixbuf, colormap);
+  render_and_check (pixbuf, colormap);
+  render_and_check (pixbuf, colormap);
+
+  g_object_unref (pixbuf);
+}
+
+static void
+test_checksum_collision (void)
+{
+  BdkColormap *colormap;
+  BdkPixbuf *pixbuf;
+
+  colormap = get_truecolor_colormap ();
+  if (!colormap)
+    return;
+
+  pixbuf = bdk_pixbuf_new (BDK_COLORSPACE_RGB, FALSE, 8, WIDTH, HEIGHT);
+  fill_pixbuf (pixbuf, 0);
+
+  /* Different pixels with the same checksum, before and after the
+   * copies are made
+   */
+  render_and_check (pixbuf, colormap);
+  change_keeping_checksum (pixbuf);
+  render_and_check (pixbuf, colormap);
+  render_and_check (pixbuf, colormap);
+  change_keeping_checksum (pixbuf);
+  render_and_check (pixbuf, colormap);
+  render_and_check (pixbuf, colormap);
+
+  g_object_unref (pixbuf);
+}
+
+int
+main (int argc, char **argv)
+{
+  g_test_init (&argc, &argv, NULL);
+  bdk_init (&argc, &argv);
+
+  g_test_add_func ("/pixbufrender/changed-pixels", test_changed_pixels);
+  g_test_add_func ("/pixbufrender/checksum-collision", test_checksum_collision);
+
+  return g_test_run ();
+}
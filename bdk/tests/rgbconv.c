@@ -0,0 +1,141 @@
+/* Tests for the vectorized BdkRGB conversion loops
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <string.h>
+
+#include "bdk/bdksimd.h"
+
+/* Every set of flags that selects a different loop */
+static const BdkSimdFlags flag_sets[] = {
+  BDK_SIMD_SSE2 | BDK_SIMD_SSSE3,
+  BDK_SIMD_SSE2 | BDK_SIMD_SSSE3 | BDK_SIMD_AVX2,
+  BDK_SIMD_NEON
+};
+
+/* Dither values in the format of DM_565 in bdkrgb.c */
+static void
+fill_dither (GRand   *rand,
+	     buint32 *dither)
+{
+  bint i;
+
+  for (i = 0; i < BDK_RGB_ROW_DITHER_WIDTH; i++)
+    {
+      buint32 dith = g_rand_int_range (rand, 0, 8);
+
+      dither[i] = (dith << 20) | dith | (((7 - dith) >> 1) << 10);
+    }
+}
+
+static void
+check_format (BdkRgbRowFormat format,
+	      bint            src_bpp,
+	      bint            dest_bpp)
+{
+  BdkSimdFlags available = _bdk_simd_get_flags ();
+  BdkRgbRowFunc reference;
+  buint32 dither[BDK_RGB_ROW_DITHER_WIDTH];
+  GRand *rand;
+  bint i, j, width, x;
+
+  reference = _bdk_rgb_row_get_func (format, 0);
+  rand = g_rand_new_with_seed (42);
+  fill_dither (rand, dither);
+
+  for (i = 0; i < (bint) G_N_ELEMENTS (flag_sets); i++)
+    {
+      BdkRgbRowFunc func;
+
+      if ((flag_sets[i] & available) != flag_sets[i])
+	continue;
+
+      func = _bdk_rgb_row_get_func (format, flag_sets[i]);
+      if (func == reference)
+	continue;
+
+      for (width = 0; width < 100; width++)
+	for (x = 0; x < BDK_RGB_ROW_DITHER_WIDTH; x += 13)
+	  {
+	    /* The source is unaligned, the destination only aligned
+	     * to its pixel size, like BdkImage rows
+	     */
+	    bint dest_size = width * dest_bpp + 8;
+	    buchar *src, *expected, *dest;
+
+	    src = g_malloc (width * src_bpp + 1);
+	    expected = g_malloc (dest_size);
+	    dest = g_malloc (dest_size);
+
+	    for (j = 0; j < width * src_bpp; j++)
+	      src[j + 1] = g_rand_int_range (rand, 0, 256);
+	    /* Saturated channels are where dithering can overflow */
+	    for (j = 0; j < width * src_bpp; j += 5)
+	      src[j + 1] = 0xff;
+	    for (j = 0; j < dest_size; j++)
+	      expected[j] = g_rand_int_range (rand, 0, 256);
+	    memcpy (dest, expected, dest_size);
+
+	    reference (src + 1, expected + 2, width, dither, x);
+	    func (src + 1, dest + 2, width, dither, x);
+
+	    if (memcmp (expected, dest, dest_size) != 0)
+	      g_error ("format %d, flags %x, width %d, x %d differs from the C version",
+		       format, flag_sets[i], width, x);
+
+	    g_free (src);
+	    g_free (expected);
+	    g_free (dest);
+	  }
+    }
+
+  g_rand_free (rand);
+}
+
+static void
+test_rgb_0888 (void)
+{
+  check_format (BDK_RGB_ROW_0888, 3, 4);
+  check_format (BDK_RGB_ROW_0888_BR, 3, 4);
+  check_format (BDK_RGB_ROW_32_0888, 4, 4);
+}
+
+static void
+test_rgb_888 (void)
+{
+  check_format (BDK_RGB_ROW_888_LSB, 3, 3);
+  check_format (BDK_RGB_ROW_32_TO_24, 4, 3);
+}
+
+static void
+test_rgb_565 (void)
+{
+  check_format (BDK_RGB_ROW_565, 3, 2);
+  check_format (BDK_RGB_ROW_565_D, 3, 2);
+}
+
+int
+main (int argc, char **argv)
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/rgbconv/0888", test_rgb_0888);
+  g_test_add_func ("/rgbconv/888", test_rgb_888);
+  g_test_add_func ("/rgbconv/565", test_rgb_565);
+
+  return g_test_run ();
+}
@@ -844,9 +844,17 @@ bdk_x11_draw_image     (BdkDrawable     *drawable,
 
 #ifdef USE_SHM  
   if (image->type == BDK_IMAGE_SHARED)
-    XShmPutImage (BDK_SCREEN_XDISPLAY (impl->screen), impl->xid,
-                  BDK_GC_GET_XGC (gc), BDK_IMAGE_XIMAGE (image),
-                  xsrc, ysrc, xdest, ydest, width, height, False);
+    {
+      Display *xdisplay = BDK_SCREEN_XDISPLAY (impl->screen);
+
+      /* Ask for a ShmCompletion event, so that the image can be reused
+       * as soon as the server is done with it, without a round trip.
+       */
+      XShmPutImage (xdisplay, impl->xid,
+                    BDK_GC_GET_XGC (gc), BDK_IMAGE_XIMAGE (image),
+                    xsrc, ysrc, xdest, ydest, width, height, True);
+      _bdk_x11_image_set_fence (image, NextRequest (xdisplay) - 1, TRUE);
+    }
   else
 #endif
     XPutImage (BDK_SCREEN_XDISPLAY (impl->screen), impl->xid,
@@ -1455,6 +1463,7 @@ draw_with_pixmaps (BdkDrawable       *drawable,
 	  XRenderComposite (xdisplay, PictOpOver, pict, mask, dest_pict, 
 			    xs0, ys0, xs0, ys0, x0 + dest_x, y0 + dest_y,
 			    width1, height1);
+	  _bdk_x11_image_set_fence (image, NextRequest (xdisplay) - 1, FALSE);
 	}
     }
 
@@ -63,7 +63,15 @@ struct _BdkImagePrivateX11
   XImage *ximage;
   BdkScreen *screen;
   bpointer x_shm_info;
+  bsize shm_size;
   Pixmap shm_pixmap;
+
+  /* The last request reading from the shared memory segment, and
+   * whether the server sends a ShmCompletion event for it.
+   */
+  bulong fence_serial;
+  buint fence_pending : 1;
+  buint fence_completion : 1;
 };
 
 static GList *image_list = NULL;
@@ -293,6 +301,7 @@ _bdk_image_new_for_depth (BdkScreen    *screen,
 		  goto error;
 		}
 
+	      private->shm_size = private->ximage->bytes_per_line * private->ximage->height;
 	      x_shm_info->readOnly = False;
 	      x_shm_info->shmaddr = shmat (x_shm_info->shmid, NULL, 0);
 	      private->ximage->data = x_shm_info->shmaddr;
@@ -416,6 +425,193 @@ _bdk_x11_image_get_shm_pixmap (BdkImage *image)
 #endif    
 }
 
+/**
+ * _bdk_x11_image_set_fence:
+ * @image: a shared #BdkImage
+ * @serial: serial of a request that reads from @image
+ * @completion: whether the server sends a ShmCompletion event
+ *   for the request
+ *
+ * Records the last request using the shared memory of @image,
+ * for _bdk_windowing_image_wait().
+ **/
+void
+_bdk_x11_image_set_fence (BdkImage *image,
+			  bulong    serial,
+			  bboolean  completion)
+{
+  BdkImagePrivateX11 *private = PRIVATE_DATA (image);
+
+  private->fence_serial = serial;
+  private->fence_pending = TRUE;
+  private->fence_completion = completion != FALSE;
+}
+
+#ifdef USE_SHM
+/* Waiting longer than this for a ShmCompletion event means something
+ * went wrong; we fall back to a round trip then.
+ */
+#define FENCE_TIMEOUT 100
+
+static Bool
+no_event_predicate (Display *display,
+		    XEvent  *xevent,
+		    XPointer arg)
+{
+  return False;
+}
+
+static bboolean
+fence_passed (Display *xdisplay,
+	      bulong   serial)
+{
+  /* an overflow-safe (serial <= LastKnownRequestProcessed (xdisplay)) */
+  return LastKnownRequestProcessed (xdisplay) - serial <= (bulong) B_MAXLONG;
+}
+#endif /* USE_SHM */
+
+bboolean
+_bdk_windowing_image_wait (BdkImage *image)
+{
+#ifdef USE_SHM
+  BdkImagePrivateX11 *private = PRIVATE_DATA (image);
+  Display *xdisplay;
+
+  if (!private->fence_pending || private->screen->closed)
+    return TRUE;
+
+  xdisplay = BDK_SCREEN_XDISPLAY (private->screen);
+
+  while (!fence_passed (xdisplay, private->fence_serial))
+    {
+      GPollFD poll_fd;
+      XEvent xevent;
+
+      /* This flushes our requests and reads whatever the server sent
+       * so far, which updates LastKnownRequestProcessed(); the events
+       * themselves stay in the queue.
+       */
+      XCheckIfEvent (xdisplay, &xevent, no_event_predicate, NULL);
+      if (fence_passed (xdisplay, private->fence_serial))
+	break;
+
+      /* Nothing will arrive for the request, so ask */
+      if (!private->fence_completion)
+	{
+	  XSync (xdisplay, False);
+	  break;
+	}
+
+      poll_fd.fd = ConnectionNumber (xdisplay);
+      poll_fd.events = G_IO_IN;
+      poll_fd.revents = 0;
+
+      if (g_poll (&poll_fd, 1, FENCE_TIMEOUT) == 0)
+	{
+	  XSync (xdisplay, False);
+	  break;
+	}
+    }
+
+  private->fence_pending = FALSE;
+#endif /* USE_SHM */
+
+  return TRUE;
+}
+
+#ifdef USE_SHM
+/* Readback images up to this size, or up to the size of a grab of
+ * the whole screen if that is bigger, stay around for the next
+ * bdk_pixbuf_get_from_drawable(); bigger ones are freed after use.
+ */
+#define READBACK_CACHE_SIZE (16 * 1024 * 1024)
+
+static bsize
+readback_cache_size (BdkScreen *screen)
+{
+  /* 32 bits per pixel is the most a grab of the screen needs */
+  bsize screen_size = (bsize) bdk_screen_get_width (screen) * bdk_screen_get_height (screen) * 4;
+
+  return MAX (screen_size, READBACK_CACHE_SIZE);
+}
+
+/* Points the XImage of a shared image at a different size, if the
+ * shared memory segment is large enough.
+ */
+static bboolean
+resize_shared_image (BdkImage *image,
+		     bint      width,
+		     bint      height)
+{
+  BdkImagePrivateX11 *private = PRIVATE_DATA (image);
+  Display *xdisplay = BDK_SCREEN_XDISPLAY (private->screen);
+  XShmSegmentInfo *x_shm_info = private->x_shm_info;
+  XImage *ximage;
+
+  if (image->width == width && image->height == height)
+    return TRUE;
+
+  ximage = XShmCreateImage (xdisplay, NULL, image->depth, ZPixmap,
+			    x_shm_info->shmaddr, x_shm_info, width, height);
+  if (ximage == NULL)
+    return FALSE;
+
+  if ((bsize) ximage->bytes_per_line * height > private->shm_size)
+    {
+      XDestroyImage (ximage);
+      return FALSE;
+    }
+
+  /* The pixmap has the old size */
+  if (private->shm_pixmap)
+    {
+      XFreePixmap (xdisplay, private->shm_pixmap);
+      private->shm_pixmap = None;
+    }
+
+  /* Only frees the header, the data is in the segment */
+  XDestroyImage (private->ximage);
+  private->ximage = ximage;
+
+  image->width = width;
+  image->height = height;
+  image->mem = ximage->data;
+  image->bpl = ximage->bytes_per_line;
+
+  return TRUE;
+}
+#endif /* USE_SHM */
+
+BdkImage *
+_bdk_windowing_image_get_readback (BdkScreen *screen,
+				   bint       width,
+				   bint       height,
+				   bint       depth)
+{
+#ifdef USE_SHM
+  BdkImage *image;
+
+  if (screen->closed ||
+      !BDK_DISPLAY_X11 (BDK_SCREEN_DISPLAY (screen))->use_xshm)
+    return NULL;
+
+  image = g_object_get_data (B_OBJECT (screen), "bdk-x11-readback-image");
+  if (image && image->depth == depth &&
+      resize_shared_image (image, width, height))
+    return g_object_ref (image);
+
+  image = _bdk_image_new_for_depth (screen, BDK_IMAGE_SHARED, NULL,
+				    width, height, depth);
+  if (image && PRIVATE_DATA (image)->shm_size <= readback_cache_size (screen))
+    g_object_set_data_full (B_OBJECT (screen), "bdk-x11-readback-image",
+			    g_object_ref (image), g_object_unref);
+
+  return image;
+#else
+  return NULL;
+#endif /* USE_SHM */
+}
+
 static BdkImage*
 get_full_image (BdkDrawable    *drawable,
 		bint            src_x,
@@ -602,7 +798,8 @@ _bdk_x11_copy_to_image (BdkDrawable    *drawable,
   else
     {
       bboolean created_image = FALSE;
-      
+      bboolean got_image;
+
       if (!image)
 	{
 	  image = _bdk_image_new_for_depth (impl->screen, BDK_IMAGE_NORMAL, 
@@ -613,14 +810,25 @@ _bdk_x11_copy_to_image (BdkDrawable    *drawable,
 
       private = PRIVATE_DATA (image);
 
-      /* In the ShmImage but no ShmPixmap case, we could use XShmGetImage when
-       * we are getting the entire image.
+#ifdef USE_SHM
+      /* In the ShmImage but no ShmPixmap case, the server can write
+       * straight into the segment when we are getting the entire image.
        */
-      if (XGetSubImage (xdisplay, impl->xid,
-			req.x, req.y, req.width, req.height,
-			AllPlanes, ZPixmap,
-			private->ximage,
-			dest_x + req.x - src_x, dest_y + req.y - src_y) == None)
+      if (image->type == BDK_IMAGE_SHARED &&
+	  dest_x == 0 && dest_y == 0 &&
+	  req.x == src_x && req.y == src_y &&
+	  req.width == image->width && req.height == image->height)
+	got_image = XShmGetImage (xdisplay, impl->xid, private->ximage,
+				  req.x, req.y, AllPlanes);
+      else
+#endif /* USE_SHM */
+	got_image = XGetSubImage (xdisplay, impl->xid,
+				  req.x, req.y, req.width, req.height,
+				  AllPlanes, ZPixmap,
+				  private->ximage,
+				  dest_x + req.x - src_x, dest_y + req.y - src_y) != None;
+
+      if (!got_image)
 	{
 	  if (created_image)
 	    g_object_unref (image);
@@ -113,6 +113,9 @@ BdkImage *_bdk_x11_copy_to_image       (BdkDrawable *drawable,
 					bint         width,
 					bint         height);
 Pixmap   _bdk_x11_image_get_shm_pixmap (BdkImage    *image);
+void     _bdk_x11_image_set_fence      (BdkImage    *image,
+					bulong       serial,
+					bboolean     completion);
 
 /* Routines from bdkgeometry-x11.c */
 void _bdk_window_move_resize_child (BdkWindow     *window,
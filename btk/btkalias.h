@@ -4832,6 +4832,9 @@ extern __typeof (btk_icon_view_get_columns) IA__btk_icon_view_get_columns __attr
 extern __typeof (btk_icon_view_get_cursor) IA__btk_icon_view_get_cursor __attribute((visibility("hidden")));
 #define btk_icon_view_get_cursor IA__btk_icon_view_get_cursor
 
+extern __typeof (btk_icon_view_get_fixed_size_mode) IA__btk_icon_view_get_fixed_size_mode __attribute((visibility("hidden")));
+#define btk_icon_view_get_fixed_size_mode IA__btk_icon_view_get_fixed_size_mode
+
 extern __typeof (btk_icon_view_get_item_padding) IA__btk_icon_view_get_item_padding __attribute((visibility("hidden")));
 #define btk_icon_view_get_item_padding IA__btk_icon_view_get_item_padding
 
@@ -4919,6 +4922,9 @@ extern __typeof (btk_icon_view_set_columns) IA__btk_icon_view_set_columns __attr
 extern __typeof (btk_icon_view_set_cursor) IA__btk_icon_view_set_cursor __attribute((visibility("hidden")));
 #define btk_icon_view_set_cursor IA__btk_icon_view_set_cursor
 
+extern __typeof (btk_icon_view_set_fixed_size_mode) IA__btk_icon_view_set_fixed_size_mode __attribute((visibility("hidden")));
+#define btk_icon_view_set_fixed_size_mode IA__btk_icon_view_set_fixed_size_mode
+
 extern __typeof (btk_icon_view_set_item_padding) IA__btk_icon_view_set_item_padding __attribute((visibility("hidden")));
 #define btk_icon_view_set_item_padding IA__btk_icon_view_set_item_padding
 
@@ -5698,6 +5704,9 @@ extern __typeof (btk_list_store_append) IA__btk_list_store_append __attribute((v
 extern __typeof (btk_list_store_clear) IA__btk_list_store_clear __attribute((visibility("hidden")));
 #define btk_list_store_clear IA__btk_list_store_clear
 
+extern __typeof (btk_list_store_get_columnar) IA__btk_list_store_get_columnar __attribute((visibility("hidden")));
+#define btk_list_store_get_columnar IA__btk_list_store_get_columnar
+
 extern __typeof (btk_list_store_get_type) IA__btk_list_store_get_type __attribute((visibility("hidden"))) B_GNUC_CONST;
 #define btk_list_store_get_type IA__btk_list_store_get_type
 
@@ -5710,6 +5719,9 @@ extern __typeof (btk_list_store_insert_after) IA__btk_list_store_insert_after __
 extern __typeof (btk_list_store_insert_before) IA__btk_list_store_insert_before __attribute((visibility("hidden")));
 #define btk_list_store_insert_before IA__btk_list_store_insert_before
 
+extern __typeof (btk_list_store_insert_rows) IA__btk_list_store_insert_rows __attribute((visibility("hidden")));
+#define btk_list_store_insert_rows IA__btk_list_store_insert_rows
+
 extern __typeof (btk_list_store_insert_with_values) IA__btk_list_store_insert_with_values __attribute((visibility("hidden")));
 #define btk_list_store_insert_with_values IA__btk_list_store_insert_with_values
 
@@ -5746,6 +5758,9 @@ extern __typeof (btk_list_store_set) IA__btk_list_store_set __attribute((visibil
 extern __typeof (btk_list_store_set_column_types) IA__btk_list_store_set_column_types __attribute((visibility("hidden")));
 #define btk_list_store_set_column_types IA__btk_list_store_set_column_types
 
+extern __typeof (btk_list_store_set_columnar) IA__btk_list_store_set_columnar __attribute((visibility("hidden")));
+#define btk_list_store_set_columnar IA__btk_list_store_set_columnar
+
 extern __typeof (btk_list_store_set_valist) IA__btk_list_store_set_valist __attribute((visibility("hidden")));
 #define btk_list_store_set_valist IA__btk_list_store_set_valist
 
@@ -8621,6 +8636,9 @@ extern __typeof (btk_test_widget_send_key) IA__btk_test_widget_send_key __attrib
 extern __typeof (btk_text_buffer_deserialize) IA__btk_text_buffer_deserialize __attribute((visibility("hidden")));
 #define btk_text_buffer_deserialize IA__btk_text_buffer_deserialize
 
+extern __typeof (btk_text_buffer_deserialize_from_stream) IA__btk_text_buffer_deserialize_from_stream __attribute((visibility("hidden")));
+#define btk_text_buffer_deserialize_from_stream IA__btk_text_buffer_deserialize_from_stream
+
 extern __typeof (btk_text_buffer_deserialize_get_can_create_tags) IA__btk_text_buffer_deserialize_get_can_create_tags __attribute((visibility("hidden")));
 #define btk_text_buffer_deserialize_get_can_create_tags IA__btk_text_buffer_deserialize_get_can_create_tags
 
@@ -8648,6 +8666,9 @@ extern __typeof (btk_text_buffer_register_serialize_tagset) IA__btk_text_buffer_
 extern __typeof (btk_text_buffer_serialize) IA__btk_text_buffer_serialize __attribute((visibility("hidden")));
 #define btk_text_buffer_serialize IA__btk_text_buffer_serialize
 
+extern __typeof (btk_text_buffer_serialize_to_stream) IA__btk_text_buffer_serialize_to_stream __attribute((visibility("hidden")));
+#define btk_text_buffer_serialize_to_stream IA__btk_text_buffer_serialize_to_stream
+
 extern __typeof (btk_text_buffer_unregister_deserialize_format) IA__btk_text_buffer_unregister_deserialize_format __attribute((visibility("hidden")));
 #define btk_text_buffer_unregister_deserialize_format IA__btk_text_buffer_unregister_deserialize_format
 
@@ -9484,6 +9505,9 @@ extern __typeof (btk_text_buffer_apply_tag) IA__btk_text_buffer_apply_tag __attr
 extern __typeof (btk_text_buffer_apply_tag_by_name) IA__btk_text_buffer_apply_tag_by_name __attribute((visibility("hidden")));
 #define btk_text_buffer_apply_tag_by_name IA__btk_text_buffer_apply_tag_by_name
 
+extern __typeof (btk_text_buffer_apply_tag_ranges) IA__btk_text_buffer_apply_tag_ranges __attribute((visibility("hidden")));
+#define btk_text_buffer_apply_tag_ranges IA__btk_text_buffer_apply_tag_ranges
+
 extern __typeof (btk_text_buffer_backspace) IA__btk_text_buffer_backspace __attribute((visibility("hidden")));
 #define btk_text_buffer_backspace IA__btk_text_buffer_backspace
 
@@ -9526,6 +9550,9 @@ extern __typeof (btk_text_buffer_delete_selection) IA__btk_text_buffer_delete_se
 extern __typeof (btk_text_buffer_end_user_action) IA__btk_text_buffer_end_user_action __attribute((visibility("hidden")));
 #define btk_text_buffer_end_user_action IA__btk_text_buffer_end_user_action
 
+extern __typeof (btk_text_buffer_find_all) IA__btk_text_buffer_find_all __attribute((visibility("hidden")));
+#define btk_text_buffer_find_all IA__btk_text_buffer_find_all
+
 extern __typeof (btk_text_buffer_get_bounds) IA__btk_text_buffer_get_bounds __attribute((visibility("hidden")));
 #define btk_text_buffer_get_bounds IA__btk_text_buffer_get_bounds
 
@@ -9595,6 +9622,9 @@ extern __typeof (btk_text_buffer_get_text) IA__btk_text_buffer_get_text __attrib
 extern __typeof (btk_text_buffer_get_type) IA__btk_text_buffer_get_type __attribute((visibility("hidden"))) B_GNUC_CONST;
 #define btk_text_buffer_get_type IA__btk_text_buffer_get_type
 
+extern __typeof (btk_text_buffer_highlight_all) IA__btk_text_buffer_highlight_all __attribute((visibility("hidden")));
+#define btk_text_buffer_highlight_all IA__btk_text_buffer_highlight_all
+
 extern __typeof (btk_text_buffer_insert) IA__btk_text_buffer_insert __attribute((visibility("hidden")));
 #define btk_text_buffer_insert IA__btk_text_buffer_insert
 
@@ -9625,6 +9655,9 @@ extern __typeof (btk_text_buffer_insert_with_tags) IA__btk_text_buffer_insert_wi
 extern __typeof (btk_text_buffer_insert_with_tags_by_name) IA__btk_text_buffer_insert_with_tags_by_name __attribute((visibility("hidden"))) B_GNUC_NULL_TERMINATED;
 #define btk_text_buffer_insert_with_tags_by_name IA__btk_text_buffer_insert_with_tags_by_name
 
+extern __typeof (btk_text_buffer_load_stream) IA__btk_text_buffer_load_stream __attribute((visibility("hidden")));
+#define btk_text_buffer_load_stream IA__btk_text_buffer_load_stream
+
 extern __typeof (btk_text_buffer_move_mark) IA__btk_text_buffer_move_mark __attribute((visibility("hidden")));
 #define btk_text_buffer_move_mark IA__btk_text_buffer_move_mark
 
@@ -9976,6 +10009,9 @@ extern __typeof (btk_text_layout_get_cursor_locations) IA__btk_text_layout_get_c
 extern __typeof (btk_text_layout_get_cursor_visible) IA__btk_text_layout_get_cursor_visible __attribute((visibility("hidden")));
 #define btk_text_layout_get_cursor_visible IA__btk_text_layout_get_cursor_visible
 
+extern __typeof (btk_text_layout_get_display_cache_stats) IA__btk_text_layout_get_display_cache_stats __attribute((visibility("hidden")));
+#define btk_text_layout_get_display_cache_stats IA__btk_text_layout_get_display_cache_stats
+
 extern __typeof (btk_text_layout_get_iter_at_line) IA__btk_text_layout_get_iter_at_line __attribute((visibility("hidden")));
 #define btk_text_layout_get_iter_at_line IA__btk_text_layout_get_iter_at_line
 
@@ -10069,6 +10105,9 @@ extern __typeof (btk_text_layout_spew) IA__btk_text_layout_spew __attribute((vis
 extern __typeof (btk_text_layout_validate) IA__btk_text_layout_validate __attribute((visibility("hidden")));
 #define btk_text_layout_validate IA__btk_text_layout_validate
 
+extern __typeof (btk_text_layout_validate_in_background) IA__btk_text_layout_validate_in_background __attribute((visibility("hidden")));
+#define btk_text_layout_validate_in_background IA__btk_text_layout_validate_in_background
+
 extern __typeof (btk_text_layout_validate_yrange) IA__btk_text_layout_validate_yrange __attribute((visibility("hidden")));
 #define btk_text_layout_validate_yrange IA__btk_text_layout_validate_yrange
 
@@ -11169,6 +11208,9 @@ extern __typeof (btk_tree_model_row_has_child_toggled) IA__btk_tree_model_row_ha
 extern __typeof (btk_tree_model_row_inserted) IA__btk_tree_model_row_inserted __attribute((visibility("hidden")));
 #define btk_tree_model_row_inserted IA__btk_tree_model_row_inserted
 
+extern __typeof (btk_tree_model_rows_inserted) IA__btk_tree_model_rows_inserted __attribute((visibility("hidden")));
+#define btk_tree_model_rows_inserted IA__btk_tree_model_rows_inserted
+
 extern __typeof (btk_tree_model_rows_reordered) IA__btk_tree_model_rows_reordered __attribute((visibility("hidden")));
 #define btk_tree_model_rows_reordered IA__btk_tree_model_rows_reordered
 
@@ -11265,6 +11307,9 @@ extern __typeof (btk_tree_row_reference_new_proxy) IA__btk_tree_row_reference_ne
 extern __typeof (btk_tree_row_reference_reordered) IA__btk_tree_row_reference_reordered __attribute((visibility("hidden")));
 #define btk_tree_row_reference_reordered IA__btk_tree_row_reference_reordered
 
+extern __typeof (btk_tree_row_reference_rows_inserted) IA__btk_tree_row_reference_rows_inserted __attribute((visibility("hidden")));
+#define btk_tree_row_reference_rows_inserted IA__btk_tree_row_reference_rows_inserted
+
 extern __typeof (btk_tree_row_reference_valid) IA__btk_tree_row_reference_valid __attribute((visibility("hidden")));
 #define btk_tree_row_reference_valid IA__btk_tree_row_reference_valid
 
@@ -11333,6 +11378,9 @@ extern __typeof (btk_tree_model_filter_new) IA__btk_tree_model_filter_new __attr
 extern __typeof (btk_tree_model_filter_refilter) IA__btk_tree_model_filter_refilter __attribute((visibility("hidden")));
 #define btk_tree_model_filter_refilter IA__btk_tree_model_filter_refilter
 
+extern __typeof (btk_tree_model_filter_refilter_async) IA__btk_tree_model_filter_refilter_async __attribute((visibility("hidden")));
+#define btk_tree_model_filter_refilter_async IA__btk_tree_model_filter_refilter_async
+
 extern __typeof (btk_tree_model_filter_set_modify_func) IA__btk_tree_model_filter_set_modify_func __attribute((visibility("hidden")));
 #define btk_tree_model_filter_set_modify_func IA__btk_tree_model_filter_set_modify_func
 
@@ -11444,6 +11492,9 @@ extern __typeof (btk_tree_store_append) IA__btk_tree_store_append __attribute((v
 extern __typeof (btk_tree_store_clear) IA__btk_tree_store_clear __attribute((visibility("hidden")));
 #define btk_tree_store_clear IA__btk_tree_store_clear
 
+extern __typeof (btk_tree_store_get_columnar) IA__btk_tree_store_get_columnar __attribute((visibility("hidden")));
+#define btk_tree_store_get_columnar IA__btk_tree_store_get_columnar
+
 extern __typeof (btk_tree_store_get_type) IA__btk_tree_store_get_type __attribute((visibility("hidden"))) B_GNUC_CONST;
 #define btk_tree_store_get_type IA__btk_tree_store_get_type
 
@@ -11498,6 +11549,9 @@ extern __typeof (btk_tree_store_set) IA__btk_tree_store_set __attribute((visibil
 extern __typeof (btk_tree_store_set_column_types) IA__btk_tree_store_set_column_types __attribute((visibility("hidden")));
 #define btk_tree_store_set_column_types IA__btk_tree_store_set_column_types
 
+extern __typeof (btk_tree_store_set_columnar) IA__btk_tree_store_set_columnar __attribute((visibility("hidden")));
+#define btk_tree_store_set_columnar IA__btk_tree_store_set_columnar
+
 extern __typeof (btk_tree_store_set_valist) IA__btk_tree_store_set_valist __attribute((visibility("hidden")));
 #define btk_tree_store_set_valist IA__btk_tree_store_set_valist
 
@@ -11748,6 +11802,9 @@ extern __typeof (btk_tree_view_get_drag_dest_row) IA__btk_tree_view_get_drag_des
 extern __typeof (btk_tree_view_get_enable_search) IA__btk_tree_view_get_enable_search __attribute((visibility("hidden")));
 #define btk_tree_view_get_enable_search IA__btk_tree_view_get_enable_search
 
+extern __typeof (btk_tree_view_get_enable_search_index) IA__btk_tree_view_get_enable_search_index __attribute((visibility("hidden")));
+#define btk_tree_view_get_enable_search_index IA__btk_tree_view_get_enable_search_index
+
 extern __typeof (btk_tree_view_get_enable_tree_lines) IA__btk_tree_view_get_enable_tree_lines __attribute((visibility("hidden")));
 #define btk_tree_view_get_enable_tree_lines IA__btk_tree_view_get_enable_tree_lines
 
@@ -11889,6 +11946,9 @@ extern __typeof (btk_tree_view_set_drag_dest_row) IA__btk_tree_view_set_drag_des
 extern __typeof (btk_tree_view_set_enable_search) IA__btk_tree_view_set_enable_search __attribute((visibility("hidden")));
 #define btk_tree_view_set_enable_search IA__btk_tree_view_set_enable_search
 
+extern __typeof (btk_tree_view_set_enable_search_index) IA__btk_tree_view_set_enable_search_index __attribute((visibility("hidden")));
+#define btk_tree_view_set_enable_search_index IA__btk_tree_view_set_enable_search_index
+
 extern __typeof (btk_tree_view_set_enable_tree_lines) IA__btk_tree_view_set_enable_tree_lines __attribute((visibility("hidden")));
 #define btk_tree_view_set_enable_tree_lines IA__btk_tree_view_set_enable_tree_lines
 
@@ -4835,6 +4835,9 @@ extern __typeof (btk_icon_view_get_columns) btk_icon_view_get_columns __attribut
 #undef btk_icon_view_get_cursor 
 extern __typeof (btk_icon_view_get_cursor) btk_icon_view_get_cursor __attribute((alias("IA__btk_icon_view_get_cursor"), visibility("default")));
 
+#undef btk_icon_view_get_fixed_size_mode 
+extern __typeof (btk_icon_view_get_fixed_size_mode) btk_icon_view_get_fixed_size_mode __attribute((alias("IA__btk_icon_view_get_fixed_size_mode"), visibility("default")));
+
 #undef btk_icon_view_get_item_padding 
 extern __typeof (btk_icon_view_get_item_padding) btk_icon_view_get_item_padding __attribute((alias("IA__btk_icon_view_get_item_padding"), visibility("default")));
 
@@ -4922,6 +4925,9 @@ extern __typeof (btk_icon_view_set_columns) btk_icon_view_set_columns __attribut
 #undef btk_icon_view_set_cursor 
 extern __typeof (btk_icon_view_set_cursor) btk_icon_view_set_cursor __attribute((alias("IA__btk_icon_view_set_cursor"), visibility("default")));
 
+#undef btk_icon_view_set_fixed_size_mode 
+extern __typeof (btk_icon_view_set_fixed_size_mode) btk_icon_view_set_fixed_size_mode __attribute((alias("IA__btk_icon_view_set_fixed_size_mode"), visibility("default")));
+
 #undef btk_icon_view_set_item_padding 
 extern __typeof (btk_icon_view_set_item_padding) btk_icon_view_set_item_padding __attribute((alias("IA__btk_icon_view_set_item_padding"), visibility("default")));
 
@@ -5701,6 +5707,9 @@ extern __typeof (btk_list_store_append) btk_list_store_append __attribute((alias
 #undef btk_list_store_clear 
 extern __typeof (btk_list_store_clear) btk_list_store_clear __attribute((alias("IA__btk_list_store_clear"), visibility("default")));
 
+#undef btk_list_store_get_columnar 
+extern __typeof (btk_list_store_get_columnar) btk_list_store_get_columnar __attribute((alias("IA__btk_list_store_get_columnar"), visibility("default")));
+
 #undef btk_list_store_get_type 
 extern __typeof (btk_list_store_get_type) btk_list_store_get_type __attribute((alias("IA__btk_list_store_get_type"), visibility("default")));
 
@@ -5713,6 +5722,9 @@ extern __typeof (btk_list_store_insert_after) btk_list_store_insert_after __attr
 #undef btk_list_store_insert_before 
 extern __typeof (btk_list_store_insert_before) btk_list_store_insert_before __attribute((alias("IA__btk_list_store_insert_before"), visibility("default")));
 
+#undef btk_list_store_insert_rows 
+extern __typeof (btk_list_store_insert_rows) btk_list_store_insert_rows __attribute((alias("IA__btk_list_store_insert_rows"), visibility("default")));
+
 #undef btk_list_store_insert_with_values 
 extern __typeof (btk_list_store_insert_with_values) btk_list_store_insert_with_values __attribute((alias("IA__btk_list_store_insert_with_values"), visibility("default")));
 
@@ -5749,6 +5761,9 @@ extern __typeof (btk_list_store_set) btk_list_store_set __attribute((alias("IA__
 #undef btk_list_store_set_column_types 
 extern __typeof (btk_list_store_set_column_types) btk_list_store_set_column_types __attribute((alias("IA__btk_list_store_set_column_types"), visibility("default")));
 
+#undef btk_list_store_set_columnar 
+extern __typeof (btk_list_store_set_columnar) btk_list_store_set_columnar __attribute((alias("IA__btk_list_store_set_columnar"), visibility("default")));
+
 #undef btk_list_store_set_valist 
 extern __typeof (btk_list_store_set_valist) btk_list_store_set_valist __attribute((alias("IA__btk_list_store_set_valist"), visibility("default")));
 
@@ -8624,6 +8639,9 @@ extern __typeof (btk_test_widget_send_key) btk_test_widget_send_key __attribute(
 #undef btk_text_buffer_deserialize 
 extern __typeof (btk_text_buffer_deserialize) btk_text_buffer_deserialize __attribute((alias("IA__btk_text_buffer_deserialize"), visibility("default")));
 
+#undef btk_text_buffer_deserialize_from_stream 
+extern __typeof (btk_text_buffer_deserialize_from_stream) btk_text_buffer_deserialize_from_stream __attribute((alias("IA__btk_text_buffer_deserialize_from_stream"), visibility("default")));
+
 #undef btk_text_buffer_deserialize_get_can_create_tags 
 extern __typeof (btk_text_buffer_deserialize_get_can_create_tags) btk_text_buffer_deserialize_get_can_create_tags __attribute((alias("IA__btk_text_buffer_deserialize_get_can_create_tags"), visibility("default")));
 
@@ -8651,6 +8669,9 @@ extern __typeof (btk_text_buffer_register_serialize_tagset) btk_text_buffer_regi
 #undef btk_text_buffer_serialize 
 extern __typeof (btk_text_buffer_serialize) btk_text_buffer_serialize __attribute((alias("IA__btk_text_buffer_serialize"), visibility("default")));
 
+#undef btk_text_buffer_serialize_to_stream 
+extern __typeof (btk_text_buffer_serialize_to_stream) btk_text_buffer_serialize_to_stream __attribute((alias("IA__btk_text_buffer_serialize_to_stream"), visibility("default")));
+
 #undef btk_text_buffer_unregister_deserialize_format 
 extern __typeof (btk_text_buffer_unregister_deserialize_format) btk_text_buffer_unregister_deserialize_format __attribute((alias("IA__btk_text_buffer_unregister_deserialize_format"), visibility("default")));
 
@@ -9487,6 +9508,9 @@ extern __typeof (btk_text_buffer_apply_tag) btk_text_buffer_apply_tag __attribut
 #undef btk_text_buffer_apply_tag_by_name 
 extern __typeof (btk_text_buffer_apply_tag_by_name) btk_text_buffer_apply_tag_by_name __attribute((alias("IA__btk_text_buffer_apply_tag_by_name"), visibility("default")));
 
+#undef btk_text_buffer_apply_tag_ranges 
+extern __typeof (btk_text_buffer_apply_tag_ranges) btk_text_buffer_apply_tag_ranges __attribute((alias("IA__btk_text_buffer_apply_tag_ranges"), visibility("default")));
+
 #undef btk_text_buffer_backspace 
 extern __typeof (btk_text_buffer_backspace) btk_text_buffer_backspace __attribute((alias("IA__btk_text_buffer_backspace"), visibility("default")));
 
@@ -9529,6 +9553,9 @@ extern __typeof (btk_text_buffer_delete_selection) btk_text_buffer_delete_select
 #undef btk_text_buffer_end_user_action 
 extern __typeof (btk_text_buffer_end_user_action) btk_text_buffer_end_user_action __attribute((alias("IA__btk_text_buffer_end_user_action"), visibility("default")));
 
+#undef btk_text_buffer_find_all 
+extern __typeof (btk_text_buffer_find_all) btk_text_buffer_find_all __attribute((alias("IA__btk_text_buffer_find_all"), visibility("default")));
+
 #undef btk_text_buffer_get_bounds 
 extern __typeof (btk_text_buffer_get_bounds) btk_text_buffer_get_bounds __attribute((alias("IA__btk_text_buffer_get_bounds"), visibility("default")));
 
@@ -9598,6 +9625,9 @@ extern __typeof (btk_text_buffer_get_text) btk_text_buffer_get_text __attribute(
 #undef btk_text_buffer_get_type 
 extern __typeof (btk_text_buffer_get_type) btk_text_buffer_get_type __attribute((alias("IA__btk_text_buffer_get_type"), visibility("default")));
 
+#undef btk_text_buffer_highlight_all 
+extern __typeof (btk_text_buffer_highlight_all) btk_text_buffer_highlight_all __attribute((alias("IA__btk_text_buffer_highlight_all"), visibility("default")));
+
 #undef btk_text_buffer_insert 
 extern __typeof (btk_text_buffer_insert) btk_text_buffer_insert __attribute((alias("IA__btk_text_buffer_insert"), visibility("default")));
 
@@ -9628,6 +9658,9 @@ extern __typeof (btk_text_buffer_insert_with_tags) btk_text_buffer_insert_with_t
 #undef btk_text_buffer_insert_with_tags_by_name 
 extern __typeof (btk_text_buffer_insert_with_tags_by_name) btk_text_buffer_insert_with_tags_by_name __attribute((alias("IA__btk_text_buffer_insert_with_tags_by_name"), visibility("default")));
 
+#undef btk_text_buffer_load_stream 
+extern __typeof (btk_text_buffer_load_stream) btk_text_buffer_load_stream __attribute((alias("IA__btk_text_buffer_load_stream"), visibility("default")));
+
 #undef btk_text_buffer_move_mark 
 extern __typeof (btk_text_buffer_move_mark) btk_text_buffer_move_mark __attribute((alias("IA__btk_text_buffer_move_mark"), visibility("default")));
 
@@ -9979,6 +10012,9 @@ extern __typeof (btk_text_layout_get_cursor_locations) btk_text_layout_get_curso
 #undef btk_text_layout_get_cursor_visible 
 extern __typeof (btk_text_layout_get_cursor_visible) btk_text_layout_get_cursor_visible __attribute((alias("IA__btk_text_layout_get_cursor_visible"), visibility("default")));
 
+#undef btk_text_layout_get_display_cache_stats 
+extern __typeof (btk_text_layout_get_display_cache_stats) btk_text_layout_get_display_cache_stats __attribute((alias("IA__btk_text_layout_get_display_cache_stats"), visibility("default")));
+
 #undef btk_text_layout_get_iter_at_line 
 extern __typeof (btk_text_layout_get_iter_at_line) btk_text_layout_get_iter_at_line __attribute((alias("IA__btk_text_layout_get_iter_at_line"), visibility("default")));
 
@@ -10072,6 +10108,9 @@ extern __typeof (btk_text_layout_spew) btk_text_layout_spew __attribute((alias("
 #undef btk_text_layout_validate 
 extern __typeof (btk_text_layout_validate) btk_text_layout_validate __attribute((alias("IA__btk_text_layout_validate"), visibility("default")));
 
+#undef btk_text_layout_validate_in_background 
+extern __typeof (btk_text_layout_validate_in_background) btk_text_layout_validate_in_background __attribute((alias("IA__btk_text_layout_validate_in_background"), visibility("default")));
+
 #undef btk_text_layout_validate_yrange 
 extern __typeof (btk_text_layout_validate_yrange) btk_text_layout_validate_yrange __attribute((alias("IA__btk_text_layout_validate_yrange"), visibility("default")));
 
@@ -11172,6 +11211,9 @@ extern __typeof (btk_tree_model_row_has_child_toggled) btk_tree_model_row_has_ch
 #undef btk_tree_model_row_inserted 
 extern __typeof (btk_tree_model_row_inserted) btk_tree_model_row_inserted __attribute((alias("IA__btk_tree_model_row_inserted"), visibility("default")));
 
+#undef btk_tree_model_rows_inserted 
+extern __typeof (btk_tree_model_rows_inserted) btk_tree_model_rows_inserted __attribute((alias("IA__btk_tree_model_rows_inserted"), visibility("default")));
+
 #undef btk_tree_model_rows_reordered 
 extern __typeof (btk_tree_model_rows_reordered) btk_tree_model_rows_reordered __attribute((alias("IA__btk_tree_model_rows_reordered"), visibility("default")));
 
@@ -11268,6 +11310,9 @@ extern __typeof (btk_tree_row_reference_new_proxy) btk_tree_row_reference_new_pr
 #undef btk_tree_row_reference_reordered 
 extern __typeof (btk_tree_row_reference_reordered) btk_tree_row_reference_reordered __attribute((alias("IA__btk_tree_row_reference_reordered"), visibility("default")));
 
+#undef btk_tree_row_reference_rows_inserted 
+extern __typeof (btk_tree_row_reference_rows_inserted) btk_tree_row_reference_rows_inserted __attribute((alias("IA__btk_tree_row_reference_rows_inserted"), visibility("default")));
+
 #undef btk_tree_row_reference_valid 
 extern __typeof (btk_tree_row_reference_valid) btk_tree_row_reference_valid __attribute((alias("IA__btk_tree_row_reference_valid"), visibility("default")));
 
@@ -11336,6 +11381,9 @@ extern __typeof (btk_tree_model_filter_new) btk_tree_model_filter_new __attribut
 #undef btk_tree_model_filter_refilter 
 extern __typeof (btk_tree_model_filter_refilter) btk_tree_model_filter_refilter __attribute((alias("IA__btk_tree_model_filter_refilter"), visibility("default")));
 
+#undef btk_tree_model_filter_refilter_async 
+extern __typeof (btk_tree_model_filter_refilter_async) btk_tree_model_filter_refilter_async __attribute((alias("IA__btk_tree_model_filter_refilter_async"), visibility("default")));
+
 #undef btk_tree_model_filter_set_modify_func 
 extern __typeof (btk_tree_model_filter_set_modify_func) btk_tree_model_filter_set_modify_func __attribute((alias("IA__btk_tree_model_filter_set_modify_func"), visibility("default")));
 
@@ -11447,6 +11495,9 @@ extern __typeof (btk_tree_store_append) btk_tree_store_append __attribute((alias
 #undef btk_tree_store_clear 
 extern __typeof (btk_tree_store_clear) btk_tree_store_clear __attribute((alias("IA__btk_tree_store_clear"), visibility("default")));
 
+#undef btk_tree_store_get_columnar 
+extern __typeof (btk_tree_store_get_columnar) btk_tree_store_get_columnar __attribute((alias("IA__btk_tree_store_get_columnar"), visibility("default")));
+
 #undef btk_tree_store_get_type 
 extern __typeof (btk_tree_store_get_type) btk_tree_store_get_type __attribute((alias("IA__btk_tree_store_get_type"), visibility("default")));
 
@@ -11501,6 +11552,9 @@ extern __typeof (btk_tree_store_set) btk_tree_store_set __attribute((alias("IA__
 #undef btk_tree_store_set_column_types 
 extern __typeof (btk_tree_store_set_column_types) btk_tree_store_set_column_types __attribute((alias("IA__btk_tree_store_set_column_types"), visibility("default")));
 
+#undef btk_tree_store_set_columnar 
+extern __typeof (btk_tree_store_set_columnar) btk_tree_store_set_columnar __attribute((alias("IA__btk_tree_store_set_columnar"), visibility("default")));
+
 #undef btk_tree_store_set_valist 
 extern __typeof (btk_tree_store_set_valist) btk_tree_store_set_valist __attribute((alias("IA__btk_tree_store_set_valist"), visibility("default")));
 
@@ -11751,6 +11805,9 @@ extern __typeof (btk_tree_view_get_drag_dest_row) btk_tree_view_get_drag_dest_ro
 #undef btk_tree_view_get_enable_search 
 extern __typeof (btk_tree_view_get_enable_search) btk_tree_view_get_enable_search __attribute((alias("IA__btk_tree_view_get_enable_search"), visibility("default")));
 
+#undef btk_tree_view_get_enable_search_index 
+extern __typeof (btk_tree_view_get_enable_search_index) btk_tree_view_get_enable_search_index __attribute((alias("IA__btk_tree_view_get_enable_search_index"), visibility("default")));
+
 #undef btk_tree_view_get_enable_tree_lines 
 extern __typeof (btk_tree_view_get_enable_tree_lines) btk_tree_view_get_enable_tree_lines __attribute((alias("IA__btk_tree_view_get_enable_tree_lines"), visibility("default")));
 
@@ -11892,6 +11949,9 @@ extern __typeof (btk_tree_view_set_drag_dest_row) btk_tree_view_set_drag_dest_ro
 #undef btk_tree_view_set_enable_search 
 extern __typeof (btk_tree_view_set_enable_search) btk_tree_view_set_enable_search __attribute((alias("IA__btk_tree_view_set_enable_search"), visibility("default")));
 
+#undef btk_tree_view_set_enable_search_index 
+extern __typeof (btk_tree_view_set_enable_search_index) btk_tree_view_set_enable_search_index __attribute((alias("IA__btk_tree_view_set_enable_search_index"), visibility("default")));
+
 #undef btk_tree_view_set_enable_tree_lines 
 extern __typeof (btk_tree_view_set_enable_tree_lines) btk_tree_view_set_enable_tree_lines __attribute((alias("IA__btk_tree_view_set_enable_tree_lines"), visibility("default")));
 
@@ -47,6 +47,9 @@
 
 #define SCROLL_EDGE_SIZE 15
 
+/* Models with more items than this are measured lazily */
+#define LAZY_LAYOUT_THRESHOLD 500
+
 #define BTK_ICON_VIEW_GET_PRIVATE(obj) (B_TYPE_INSTANCE_GET_PRIVATE ((obj), BTK_TYPE_ICON_VIEW, BtkIconViewPrivate))
 
 typedef struct _BtkIconViewItem BtkIconViewItem;
@@ -74,6 +77,14 @@ struct _BtkIconViewItem
   buint selected : 1;
   buint selected_before_rubberbanding : 1;
 
+  /* The size is a guess, the cells have not been measured */
+  buint estimated : 1;
+
+  /* Fixed size mode: the cell boxes are still to be placed, see
+   * btk_icon_view_item_ensure_box()
+   */
+  buint box_pending : 1;
+
 };
 
 typedef struct _BtkIconViewCellInfo BtkIconViewCellInfo;
@@ -115,6 +126,40 @@ struct _BtkIconViewPrivate
   BtkTreeModel *model;
   
   GList *items;
+  bint n_items;
+
+  /* The items by index, built by the layout and dropped whenever
+   * items are added, removed or reordered.
+   */
+  GPtrArray *item_array;
+  bint fixed_items_per_row;
+  bint fixed_row_height;
+
+  /* Lazy measurement: size and cell boxes (relative to the item
+   * origin) assumed for unmeasured items, or in fixed size mode
+   * those of every item, the widest item measured so far, and the
+   * vertical band that was measured by the last layout.
+   */
+  bint estimated_width;
+  bint estimated_height;
+  BdkRectangle *estimated_box;
+  bint *estimated_before;
+  bint *estimated_after;
+  bint natural_width;
+  bint n_estimated;
+  bint measured_y1;
+  bint measured_y2;
+
+  /* Item to keep in place once a queued remeasure has run, and
+   * whether that remeasure may lay out just the rows around the
+   * visible area; it may while the allocated width and the column
+   * width stay the same as in the last layout.
+   */
+  bint measure_anchor_index;
+  bint measure_anchor_offset;
+  bboolean measure_band_only;
+  bint measured_alloc_width;
+  bint measured_item_width;
   
   BtkAdjustment *hadjustment;
   BtkAdjustment *vadjustment;
@@ -187,6 +232,8 @@ struct _BtkIconViewPrivate
   buint extend_selection_pressed : 1;
 
   buint draw_focus : 1;
+
+  buint fixed_size_mode : 1;
 };
 
 /* Signals */
@@ -222,7 +269,8 @@ enum
   PROP_MARGIN,
   PROP_REORDERABLE,
   PROP_TOOLTIP_COLUMN,
-  PROP_ITEM_PADDING
+  PROP_ITEM_PADDING,
+  PROP_FIXED_SIZE_MODE
 };
 
 /* BObject vfuncs */
@@ -288,6 +336,9 @@ static bboolean         btk_icon_view_real_activate_cursor_item (BtkIconView
 static void                 btk_icon_view_adjustment_changed             (BtkAdjustment          *adjustment,
 									  BtkIconView            *icon_view);
 static void                 btk_icon_view_layout                         (BtkIconView            *icon_view);
+static void                 btk_icon_view_layout_fixed                   (BtkIconView            *icon_view,
+									  bint                   *y,
+									  bint                   *maximum_width);
 static void                 btk_icon_view_paint_item                     (BtkIconView            *icon_view,
 									  bairo_t *cr,
 
@@ -312,7 +363,8 @@ static void                 btk_icon_view_start_rubberbanding            (BtkIco
 									  bint                    x,
 									  bint                    y);
 static void                 btk_icon_view_stop_rubberbanding             (BtkIconView            *icon_view);
-static void                 btk_icon_view_update_rubberband_selection    (BtkIconView            *icon_view);
+static void                 btk_icon_view_update_rubberband_selection    (BtkIconView            *icon_view,
+									  BdkRectangle           *old_area);
 static bboolean             btk_icon_view_item_hit_test                  (BtkIconView            *icon_view,
 									  BtkIconViewItem        *item,
 									  bint                    x,
@@ -320,6 +372,10 @@ static bboolean             btk_icon_view_item_hit_test                  (BtkIco
 									  bint                    width,
 									  bint                    height);
 static bboolean             btk_icon_view_unselect_all_internal          (BtkIconView            *icon_view);
+static void                 btk_icon_view_item_ensure_cells              (BtkIconView            *icon_view,
+									  BtkIconViewItem        *item);
+static void                 btk_icon_view_item_ensure_box                (BtkIconView            *icon_view,
+									  BtkIconViewItem        *item);
 static void                 btk_icon_view_calculate_item_size            (BtkIconView            *icon_view,
 									  BtkIconViewItem        *item);
 static void                 btk_icon_view_calculate_item_size2           (BtkIconView            *icon_view,
@@ -327,6 +383,13 @@ static void                 btk_icon_view_calculate_item_size2           (BtkIco
 									  bint                   *max_height);
 static void                 btk_icon_view_update_rubberband              (bpointer                data);
 static void                 btk_icon_view_item_invalidate_size           (BtkIconViewItem        *item);
+static GPtrArray *          btk_icon_view_get_item_array                 (BtkIconView            *icon_view);
+static void                 btk_icon_view_drop_item_array                (BtkIconView            *icon_view);
+static bboolean             btk_icon_view_get_fixed_range                (BtkIconView            *icon_view,
+									  bint                    y1,
+									  bint                    y2,
+									  bint                   *first,
+									  bint                   *last);
 static void                 btk_icon_view_invalidate_sizes               (BtkIconView            *icon_view);
 static void                 btk_icon_view_add_move_binding               (BtkBindingSet          *binding_set,
 									  buint                   keyval,
@@ -794,6 +857,23 @@ btk_icon_view_class_init (BtkIconViewClass *klass)
 						     0, B_MAXINT, 6,
 						     BTK_PARAM_READWRITE));
 
+  /**
+   * BtkIconView:fixed-size-mode:
+   *
+   * Setting the ::fixed-size-mode property to %TRUE speeds up
+   * #BtkIconView by assuming that all items have the same size.
+   * See btk_icon_view_set_fixed_size_mode().
+   *
+   * Since: 2.24.34
+   */
+  g_object_class_install_property (bobject_class,
+                                   PROP_FIXED_SIZE_MODE,
+                                   g_param_spec_boolean ("fixed-size-mode",
+							 P_("Fixed Size Mode"),
+							 P_("Speeds up BtkIconView by assuming that all items have the same size"),
+							 FALSE,
+							 BTK_PARAM_READWRITE));
+
 
 
   /* Style properties */
@@ -1125,6 +1205,8 @@ btk_icon_view_init (BtkIconView *icon_view)
   icon_view->priv->text_cell = -1;
   icon_view->priv->pixbuf_cell = -1;  
   icon_view->priv->tooltip_column = -1;  
+  icon_view->priv->natural_width = -1;
+  icon_view->priv->measure_anchor_index = -1;
 
   btk_widget_set_can_focus (BTK_WIDGET (icon_view), TRUE);
   
@@ -1191,6 +1273,12 @@ btk_icon_view_destroy (BtkObject *object)
 static void
 btk_icon_view_finalize (BObject *object)
 {
+  BtkIconView *icon_view = BTK_ICON_VIEW (object);
+
+  g_free (icon_view->priv->estimated_box);
+  g_free (icon_view->priv->estimated_before);
+  g_free (icon_view->priv->estimated_after);
+
   btk_icon_view_cell_layout_clear (BTK_CELL_LAYOUT (object));
 
   B_OBJECT_CLASS (btk_icon_view_parent_class)->finalize (object);
@@ -1258,6 +1346,10 @@ btk_icon_view_set_property (BObject      *object,
       btk_icon_view_set_item_padding (icon_view, b_value_get_int (value));
       break;
 
+    case PROP_FIXED_SIZE_MODE:
+      btk_icon_view_set_fixed_size_mode (icon_view, b_value_get_boolean (value));
+      break;
+
     default:
       B_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1324,6 +1416,10 @@ btk_icon_view_get_property (BObject      *object,
       b_value_set_int (value, icon_view->priv->item_padding);
       break;
 
+    case PROP_FIXED_SIZE_MODE:
+      b_value_set_boolean (value, icon_view->priv->fixed_size_mode);
+      break;
+
     default:
       B_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1472,7 +1568,10 @@ btk_icon_view_allocate_children (BtkIconView *icon_view)
 	}
       else
 	{
-	  BdkRectangle *box = &child->item->box[child->cell];
+	  BdkRectangle *box;
+
+	  btk_icon_view_item_ensure_box (icon_view, child->item);
+	  box = &child->item->box[child->cell];
 
 	  allocation.x = box->x;
 	  allocation.y = box->y;
@@ -1550,6 +1649,30 @@ btk_icon_view_size_allocate (BtkWidget      *widget,
     }
 }
 
+static bboolean
+btk_icon_view_expose_item (BtkIconView     *icon_view,
+			   bairo_t         *cr,
+			   BtkIconViewItem *item,
+			   BdkEventExpose  *expose)
+{
+  BdkRectangle area;
+
+  area.x = item->x;
+  area.y = item->y;
+  area.width = item->width;
+  area.height = item->height;
+
+  if (bdk_rebunnyion_rect_in (expose->rebunnyion, &area) == BDK_OVERLAP_RECTANGLE_OUT)
+    return FALSE;
+
+  btk_icon_view_paint_item (icon_view, cr, item, &expose->area,
+			    icon_view->priv->bin_window,
+			    item->x, item->y,
+			    icon_view->priv->draw_focus);
+
+  return TRUE;
+}
+
 static bboolean
 btk_icon_view_expose (BtkWidget *widget,
 		      BdkEventExpose *expose)
@@ -1561,6 +1684,7 @@ btk_icon_view_expose (BtkWidget *widget,
   bint dest_index;
   BtkIconViewDropPosition dest_pos;
   BtkIconViewItem *dest_item = NULL;
+  bint first, last, i;
 
   icon_view = BTK_ICON_VIEW (widget);
 
@@ -1585,26 +1709,30 @@ btk_icon_view_expose (BtkWidget *widget,
   else
     dest_index = -1;
 
-  for (icons = icon_view->priv->items; icons; icons = icons->next) 
+  if (btk_icon_view_get_fixed_range (icon_view,
+				     expose->area.y,
+				     expose->area.y + expose->area.height,
+				     &first, &last))
     {
-      BtkIconViewItem *item = icons->data;
-      BdkRectangle area;
-      
-      area.x = item->x;
-      area.y = item->y;
-      area.width = item->width;
-      area.height = item->height;
-	
-      if (bdk_rebunnyion_rect_in (expose->rebunnyion, &area) == BDK_OVERLAP_RECTANGLE_OUT)
-	continue;
-      
-      btk_icon_view_paint_item (icon_view, cr, item, &expose->area, 
-				icon_view->priv->bin_window,
-				item->x, item->y,
-				icon_view->priv->draw_focus); 
- 
-      if (dest_index == item->index)
-	dest_item = item;
+      for (i = first; i < last; i++)
+	{
+	  BtkIconViewItem *item = g_ptr_array_index (icon_view->priv->item_array, i);
+
+	  if (btk_icon_view_expose_item (icon_view, cr, item, expose) &&
+	      dest_index == item->index)
+	    dest_item = item;
+	}
+    }
+  else
+    {
+      for (icons = icon_view->priv->items; icons; icons = icons->next) 
+	{
+	  BtkIconViewItem *item = icons->data;
+
+	  if (btk_icon_view_expose_item (icon_view, cr, item, expose) &&
+	      dest_index == item->index)
+	    dest_item = item;
+	}
     }
 
   if (dest_item)
@@ -2383,7 +2511,7 @@ btk_icon_view_update_rubberband (bpointer data)
   icon_view->priv->rubberband_x2 = x;
   icon_view->priv->rubberband_y2 = y;  
 
-  btk_icon_view_update_rubberband_selection (icon_view);
+  btk_icon_view_update_rubberband_selection (icon_view, &old_area);
 }
 
 static void
@@ -2425,11 +2553,38 @@ btk_icon_view_stop_rubberbanding (BtkIconView *icon_view)
   btk_widget_queue_draw (BTK_WIDGET (icon_view));
 }
 
+static bboolean
+btk_icon_view_update_rubberband_item (BtkIconView     *icon_view,
+				      BtkIconViewItem *item,
+				      bint             x,
+				      bint             y,
+				      bint             width,
+				      bint             height)
+{
+  bboolean is_in;
+  bboolean selected;
+
+  is_in = btk_icon_view_item_hit_test (icon_view, item,
+				       x, y, width, height);
+
+  selected = is_in ^ item->selected_before_rubberbanding;
+
+  if (item->selected == selected)
+    return FALSE;
+
+  item->selected = selected;
+  btk_icon_view_queue_draw_item (icon_view, item);
+
+  return TRUE;
+}
+
 static void
-btk_icon_view_update_rubberband_selection (BtkIconView *icon_view)
+btk_icon_view_update_rubberband_selection (BtkIconView  *icon_view,
+					   BdkRectangle *old_area)
 {
   GList *items;
   bint x, y, width, height;
+  bint first, last, i;
   bboolean dirty = FALSE;
   
   x = MIN (icon_view->priv->rubberband_x1,
@@ -2441,23 +2596,24 @@ btk_icon_view_update_rubberband_selection (BtkIconView *icon_view)
   height = ABS (icon_view->priv->rubberband_y1 - 
 		icon_view->priv->rubberband_y2);
   
-  for (items = icon_view->priv->items; items; items = items->next)
+  /* Items that are outside both the old and the new rubberband
+   * keep their state, so only the rows under either need a look.
+   */
+  if (btk_icon_view_get_fixed_range (icon_view,
+				     MIN (y, old_area->y),
+				     MAX (y + height, old_area->y + old_area->height),
+				     &first, &last))
     {
-      BtkIconViewItem *item = items->data;
-      bboolean is_in;
-      bboolean selected;
-      
-      is_in = btk_icon_view_item_hit_test (icon_view, item, 
-					   x, y, width, height);
-
-      selected = is_in ^ item->selected_before_rubberbanding;
-
-      if (item->selected != selected)
-	{
-	  item->selected = selected;
-	  dirty = TRUE;
-	  btk_icon_view_queue_draw_item (icon_view, item);
-	}
+      for (i = first; i < last; i++)
+	dirty |= btk_icon_view_update_rubberband_item (icon_view,
+						       g_ptr_array_index (icon_view->priv->item_array, i),
+						       x, y, width, height);
+    }
+  else
+    {
+      for (items = icon_view->priv->items; items; items = items->next)
+	dirty |= btk_icon_view_update_rubberband_item (icon_view, items->data,
+						       x, y, width, height);
     }
 
   if (dirty)
@@ -2670,12 +2826,80 @@ btk_icon_view_real_toggle_cursor_item (BtkIconView *icon_view)
 }
 
 /* Internal functions */
+/* Returns the index of the first laid out item that ends at or
+ * below @y, or the number of items if there is none.
+ */
+static bint
+btk_icon_view_find_item_index (BtkIconView *icon_view,
+			       bint         y)
+{
+  GPtrArray *item_array = btk_icon_view_get_item_array (icon_view);
+  bint low = 0, high = item_array->len;
+
+  /* Rows are laid out top to bottom, so the bottom edges of the
+   * items never decrease with their index.
+   */
+  while (low < high)
+    {
+      bint mid = low + (high - low) / 2;
+      BtkIconViewItem *item = g_ptr_array_index (item_array, mid);
+
+      if (item->y + item->height >= y)
+	high = mid;
+      else
+	low = mid + 1;
+    }
+
+  return low;
+}
+
+/* Queues a layout if the visible area is getting close to items whose
+ * size is only estimated. This runs from ::value-changed, so the first
+ * visible item is only remembered here and put back in place by
+ * btk_icon_view_layout().
+ */
+static void
+btk_icon_view_measure_visible (BtkIconView *icon_view)
+{
+  BtkIconViewPrivate *priv = icon_view->priv;
+  BtkIconViewItem *item;
+  bint page;
+  bint value;
+  bint index;
+
+  if (priv->fixed_size_mode || priv->n_estimated == 0 ||
+      priv->layout_idle_id != 0)
+    return;
+
+  page = MAX (BTK_WIDGET (icon_view)->allocation.height, 1);
+  value = priv->vadjustment->value;
+
+  if (value - page / 2 >= priv->measured_y1 &&
+      value + page + page / 2 <= priv->measured_y2)
+    return;
+
+  priv->measure_anchor_index = -1;
+
+  index = btk_icon_view_find_item_index (icon_view, value);
+  if (index < priv->item_array->len)
+    {
+      item = g_ptr_array_index (priv->item_array, index);
+      priv->measure_anchor_index = index;
+      priv->measure_anchor_offset = item->y - value;
+    }
+
+  btk_icon_view_queue_layout (icon_view);
+  priv->measure_band_only = TRUE;
+}
+
 static void
 btk_icon_view_adjustment_changed (BtkAdjustment *adjustment,
 				  BtkIconView   *icon_view)
 {
   if (btk_widget_get_realized (BTK_WIDGET (icon_view)))
     {
+      btk_icon_view_measure_visible (icon_view);
+
       bdk_window_move (icon_view->priv->bin_window,
 		       - icon_view->priv->hadjustment->value,
 		       - icon_view->priv->vadjustment->value);
@@ -2687,17 +2911,116 @@ btk_icon_view_adjustment_changed (BtkAdjustment *adjustment,
     }
 }
 
-static GList *
+static void
+btk_icon_view_item_move (BtkIconViewItem *item,
+			 bint             x,
+			 bint             y)
+{
+  bint dx = x - item->x;
+  bint dy = y - item->y;
+  bint i;
+
+  for (i = 0; i < item->n_cells; i++)
+    {
+      item->box[i].x += dx;
+      item->box[i].y += dy;
+    }
+
+  item->x = x;
+  item->y = y;
+}
+
+static void
+btk_icon_view_estimate_item_size (BtkIconView     *icon_view,
+				  BtkIconViewItem *item)
+{
+  bint i;
+
+  btk_icon_view_item_ensure_cells (icon_view, item);
+
+  item->width = icon_view->priv->estimated_width;
+  item->height = icon_view->priv->estimated_height;
+
+  for (i = 0; i < item->n_cells; i++)
+    {
+      if (icon_view->priv->estimated_box)
+	{
+	  item->box[i] = icon_view->priv->estimated_box[i];
+	  item->box[i].x += item->x;
+	  item->box[i].y += item->y;
+	  item->before[i] = icon_view->priv->estimated_before[i];
+	  item->after[i] = icon_view->priv->estimated_after[i];
+	}
+      else
+	{
+	  item->box[i].x = item->x;
+	  item->box[i].y = item->y;
+	  item->box[i].width = 0;
+	  item->box[i].height = 0;
+	  item->before[i] = 0;
+	  item->after[i] = 0;
+	}
+    }
+
+  if (!item->estimated)
+    icon_view->priv->n_estimated++;
+  item->estimated = TRUE;
+  item->box_pending = FALSE;
+}
+
+/* Measures @item and keeps its size and cell boxes as the estimate
+ * for items that are not measured yet.
+ */
+static void
+btk_icon_view_update_estimate (BtkIconView     *icon_view,
+			       BtkIconViewItem *item)
+{
+  BtkIconViewPrivate *priv = icon_view->priv;
+  bint *max_height;
+  bint i;
+
+  btk_icon_view_calculate_item_size (icon_view, item);
+
+  priv->estimated_width = item->width;
+
+  max_height = g_new0 (bint, priv->n_cells);
+  for (i = 0; i < priv->n_cells; i++)
+    max_height[i] = item->box[i].height;
+
+  /* The item is placed again when its row is laid out */
+  item->x = 0;
+  item->y = 0;
+  btk_icon_view_calculate_item_size2 (icon_view, item, max_height);
+  g_free (max_height);
+
+  priv->estimated_height = item->height;
+
+  g_free (priv->estimated_box);
+  g_free (priv->estimated_before);
+  g_free (priv->estimated_after);
+  priv->estimated_box = g_memdup (item->box, priv->n_cells * sizeof (BdkRectangle));
+  priv->estimated_before = g_memdup (item->before, priv->n_cells * sizeof (bint));
+  priv->estimated_after = g_memdup (item->after, priv->n_cells * sizeof (bint));
+}
+
+/* Lays out the row that starts with the item at @first_item and
+ * returns the index of the item that starts the next one. Rows that
+ * are not measured keep the sizes their items already have, or get
+ * estimated ones, and their cells are only moved.
+ */
+static bint
 btk_icon_view_layout_single_row (BtkIconView *icon_view, 
-				 GList       *first_item, 
+				 bint         first_item, 
 				 bint         item_width,
 				 bint         row,
+				 bboolean     measure,
 				 bint        *y, 
 				 bint        *maximum_width)
 {
+  GPtrArray *item_array = icon_view->priv->item_array;
   bint focus_width;
   bint x, current_width;
-  GList *items, *last_item;
+  bint items, last_item;
   bint col;
   bint colspan;
   bint *max_height;
@@ -2720,11 +3043,15 @@ btk_icon_view_layout_single_row (BtkIconView *icon_view,
   current_width += 2 * (icon_view->priv->margin + focus_width);
 
   items = first_item;
-  while (items)
+  while (items < item_array->len)
     {
-      BtkIconViewItem *item = items->data;
+      BtkIconViewItem *item = g_ptr_array_index (item_array, items);
+
+      if (measure)
+	btk_icon_view_calculate_item_size (icon_view, item);
+      else if (item->width == -1 || item->estimated)
+	btk_icon_view_estimate_item_size (icon_view, item);
 
-      btk_icon_view_calculate_item_size (icon_view, item);
       colspan = 1 + (item->width - 1) / (item_width + icon_view->priv->column_spacing);
 
       item->width = colspan * item_width + (colspan - 1) * icon_view->priv->column_spacing;
@@ -2740,8 +3067,13 @@ btk_icon_view_layout_single_row (BtkIconView *icon_view,
 
       current_width += icon_view->priv->column_spacing + 2 * focus_width;
 
-      item->y = *y + focus_width;
-      item->x = x;
+      if (measure)
+	{
+	  item->y = *y + focus_width;
+	  item->x = x;
+	}
+      else
+	btk_icon_view_item_move (item, x, *y + focus_width);
 
       x = current_width - (icon_view->priv->margin + focus_width); 
 
@@ -2755,23 +3087,27 @@ btk_icon_view_layout_single_row (BtkIconView *icon_view,
       item->col = col;
 
       col += colspan;
-      items = items->next;
+      items++;
     }
 
   last_item = items;
 
   /* Now go through the row again and align the icons */
-  for (items = first_item; items != last_item; items = items->next)
+  for (items = first_item; items != last_item; items++)
     {
-      BtkIconViewItem *item = items->data;
+      BtkIconViewItem *item = g_ptr_array_index (item_array, items);
 
       if (rtl)
 	{
-	  item->x = *maximum_width - item->width - item->x;
+	  if (measure)
+	    item->x = *maximum_width - item->width - item->x;
+	  else
+	    btk_icon_view_item_move (item, *maximum_width - item->width - item->x, item->y);
 	  item->col = col - 1 - item->col;
 	}
 
-      btk_icon_view_calculate_item_size2 (icon_view, item, max_height);
+      if (measure)
+	btk_icon_view_calculate_item_size2 (icon_view, item, max_height);
 
       /* We may want to readjust the new y coordinate. */
       if (item->y + item->height + focus_width + icon_view->priv->row_spacing > *y)
@@ -2783,6 +3119,199 @@ btk_icon_view_layout_single_row (BtkIconView *icon_view,
   return last_item;
 }
 
+/* Lays the items out on a grid of equally sized cells, measuring
+ * only the first item; see btk_icon_view_set_fixed_size_mode().
+ */
+static void
+btk_icon_view_layout_fixed (BtkIconView *icon_view,
+			    bint        *y,
+			    bint        *maximum_width)
+{
+  BtkIconViewPrivate *priv = icon_view->priv;
+  BtkIconViewItem *first;
+  bint *max_height;
+  bint focus_width;
+  bint item_width, colspan;
+  bint width, height;
+  bint col_pitch;
+  bint n_items, per_row, n_rows;
+  bint i, j;
+  bboolean rtl;
+
+  rtl = btk_widget_get_direction (BTK_WIDGET (icon_view)) == BTK_TEXT_DIR_RTL;
+
+  btk_widget_style_get (BTK_WIDGET (icon_view),
+			"focus-line-width", &focus_width,
+			NULL);
+
+  n_items = btk_icon_view_get_item_array (icon_view)->len;
+  priv->fixed_items_per_row = 1;
+  priv->fixed_row_height = 1;
+  priv->n_estimated = 0;
+
+  if (n_items == 0)
+    return;
+
+  first = g_ptr_array_index (priv->item_array, 0);
+
+  btk_icon_view_item_invalidate_size (first);
+  btk_icon_view_calculate_item_size (icon_view, first);
+  adjust_wrap_width (icon_view, first);
+  btk_icon_view_item_invalidate_size (first);
+  btk_icon_view_calculate_item_size (icon_view, first);
+
+  item_width = priv->item_width > 0 ? priv->item_width : first->width;
+  colspan = 1 + (first->width - 1) / (item_width + priv->column_spacing);
+  first->width = colspan * item_width + (colspan - 1) * priv->column_spacing;
+
+  max_height = g_new0 (bint, priv->n_cells);
+  for (j = 0; j < priv->n_cells; j++)
+    max_height[j] = first->box[j].height;
+
+  /* Place the cells relative to the item origin; they are moved
+   * to an item's position when it is drawn or looked at.
+   */
+  first->x = 0;
+  first->y = 0;
+  btk_icon_view_calculate_item_size2 (icon_view, first, max_height);
+  g_free (max_height);
+
+  width = first->width;
+  height = first->height;
+
+  g_free (priv->estimated_box);
+  g_free (priv->estimated_before);
+  g_free (priv->estimated_after);
+  priv->estimated_box = g_memdup (first->box, priv->n_cells * sizeof (BdkRectangle));
+  priv->estimated_before = g_memdup (first->before, priv->n_cells * sizeof (bint));
+  priv->estimated_after = g_memdup (first->after, priv->n_cells * sizeof (bint));
+
+  col_pitch = width + priv->column_spacing + 2 * focus_width;
+
+  if (priv->columns > 0)
+    per_row = (priv->columns + colspan - 1) / colspan;
+  else
+    per_row = (BTK_WIDGET (icon_view)->allocation.width
+	       - 2 * (priv->margin + focus_width)
+	       + priv->column_spacing + 2 * focus_width) / col_pitch;
+  per_row = CLAMP (per_row, 1, n_items);
+  n_rows = (n_items + per_row - 1) / per_row;
+
+  priv->fixed_items_per_row = per_row;
+  priv->fixed_row_height = MAX (height + 2 * focus_width + priv->row_spacing, 1);
+
+  *maximum_width = MAX (*maximum_width,
+			2 * (priv->margin + focus_width) + per_row * width
+			+ (per_row - 1) * (priv->column_spacing + 2 * focus_width));
+
+  for (i = 0; i < n_items; i++)
+    {
+      BtkIconViewItem *item = g_ptr_array_index (priv->item_array, i);
+      bint row = i / per_row;
+      bint col = i % per_row;
+
+      item->width = width;
+      item->height = height;
+      item->estimated = FALSE;
+      item->row = row;
+      item->x = priv->margin + focus_width + col * col_pitch;
+      item->y = *y + row * priv->fixed_row_height + focus_width;
+
+      if (rtl)
+	{
+	  bint in_row = MIN (per_row, n_items - row * per_row);
+
+	  item->x = *maximum_width - width - item->x;
+	  item->col = in_row * colspan - 1 - col * colspan;
+	}
+      else
+	item->col = col * colspan;
+
+      item->box_pending = TRUE;
+    }
+
+  *y += n_rows * priv->fixed_row_height;
+}
+
+/* Moves the cell boxes of the fixed size layout to @item, which is
+ * only done for items that are drawn or looked at.
+ */
+static void
+btk_icon_view_item_ensure_box (BtkIconView     *icon_view,
+			       BtkIconViewItem *item)
+{
+  bint i;
+
+  if (!item->box_pending)
+    return;
+
+  btk_icon_view_item_ensure_cells (icon_view, item);
+
+  for (i = 0; i < item->n_cells; i++)
+    {
+      item->box[i] = icon_view->priv->estimated_box[i];
+      item->box[i].x += item->x;
+      item->box[i].y += item->y;
+      item->before[i] = icon_view->priv->estimated_before[i];
+      item->after[i] = icon_view->priv->estimated_after[i];
+    }
+
+  item->box_pending = FALSE;
+}
+
+static GPtrArray *
+btk_icon_view_get_item_array (BtkIconView *icon_view)
+{
+  GList *icons;
+
+  if (icon_view->priv->item_array == NULL)
+    {
+      icon_view->priv->item_array = g_ptr_array_sized_new (icon_view->priv->n_items);
+      for (icons = icon_view->priv->items; icons; icons = icons->next)
+	g_ptr_array_add (icon_view->priv->item_array, icons->data);
+    }
+
+  return icon_view->priv->item_array;
+}
+
+static void
+btk_icon_view_drop_item_array (BtkIconView *icon_view)
+{
+  if (icon_view->priv->item_array)
+    {
+      g_ptr_array_free (icon_view->priv->item_array, TRUE);
+      icon_view->priv->item_array = NULL;
+    }
+}
+
+/* In fixed size mode, sets [*first, *last) to the indices of the items
+ * in the rows between @y1 and @y2 and returns %TRUE. Returns %FALSE if
+ * the caller has to go through all items.
+ */
+static bboolean
+btk_icon_view_get_fixed_range (BtkIconView *icon_view,
+			       bint         y1,
+			       bint         y2,
+			       bint        *first,
+			       bint        *last)
+{
+  BtkIconViewPrivate *priv = icon_view->priv;
+  bint n_items;
+  bint first_row, last_row;
+
+  if (!priv->fixed_size_mode || priv->item_array == NULL)
+    return FALSE;
+
+  n_items = priv->item_array->len;
+  first_row = MAX (y1 - priv->margin, 0) / priv->fixed_row_height;
+  last_row = MAX (y2 - priv->margin, 0) / priv->fixed_row_height + 1;
+
+  *first = MIN (first_row * priv->fixed_items_per_row, n_items);
+  *last = MIN (last_row * priv->fixed_items_per_row, n_items);
+
+  return TRUE;
+}
+
 static void
 btk_icon_view_set_adjustment_upper (BtkAdjustment *adj,
 				    bdouble        upper)
@@ -2807,6 +3336,85 @@ btk_icon_view_set_adjustment_upper (BtkAdjustment *adj,
     }
 }
 
+/* Measures the rows of the last lazy layout that lie between @band_y1
+ * and @band_y2 and moves the rows below them by the height they gained
+ * or lost; the rows above are left alone. Returns %FALSE if that would
+ * change which items share a row or the width of the view, in which
+ * case everything has to be laid out again.
+ */
+static bboolean
+btk_icon_view_layout_band (BtkIconView *icon_view,
+			   bint         band_y1,
+			   bint         band_y2,
+			   bint         item_width,
+			   bint        *y,
+			   bint        *maximum_width)
+{
+  BtkIconViewPrivate *priv = icon_view->priv;
+  GPtrArray *item_array = btk_icon_view_get_item_array (icon_view);
+  BtkIconViewItem *item;
+  bint focus_width;
+  bint first, next;
+  bint row;
+  bint dy;
+  bint i;
+  bboolean rtl;
+
+  rtl = btk_widget_get_direction (BTK_WIDGET (icon_view)) == BTK_TEXT_DIR_RTL;
+
+  btk_widget_style_get (BTK_WIDGET (icon_view),
+			"focus-line-width", &focus_width,
+			NULL);
+
+  first = btk_icon_view_find_item_index (icon_view, band_y1);
+  if (first == item_array->len)
+    return FALSE;
+
+  item = g_ptr_array_index (item_array, first);
+  row = item->row;
+  while (first > 0 &&
+	 ((BtkIconViewItem *)g_ptr_array_index (item_array, first - 1))->row == row)
+    first--;
+
+  item = g_ptr_array_index (item_array, first);
+  *y = item->y - focus_width;
+  *maximum_width = priv->width;
+
+  next = first;
+  while (next < item_array->len && *y <= band_y2)
+    next = btk_icon_view_layout_single_row (icon_view, next,
+					    item_width, row++, TRUE,
+					    y, maximum_width);
+
+  if (*maximum_width != priv->width)
+    return FALSE;
+
+  if (next == item_array->len)
+    return TRUE;
+
+  /* The rows below are only moved, so the next one must still
+   * start with the same item.
+   */
+  item = g_ptr_array_index (item_array, next);
+  if (item->row != row)
+    return FALSE;
+  if (rtl ? item->x + item->width != priv->width - priv->margin - focus_width
+          : item->x != priv->margin + focus_width)
+    return FALSE;
+
+  dy = *y + focus_width - item->y;
+  if (dy != 0)
+    for (i = next; i < item_array->len; i++)
+      {
+	item = g_ptr_array_index (item_array, i);
+	btk_icon_view_item_move (item, item->x, item->y + dy);
+      }
+
+  *y = priv->height - priv->margin + dy;
+
+  return TRUE;
+}
+
 static void
 btk_icon_view_layout (BtkIconView *icon_view)
 {
@@ -2815,49 +3423,125 @@ btk_icon_view_layout (BtkIconView *icon_view)
   BtkWidget *widget;
   bint row;
   bint item_width;
+  bboolean band_only;
 
   if (icon_view->priv->layout_idle_id != 0)
     {
       g_source_remove (icon_view->priv->layout_idle_id);
       icon_view->priv->layout_idle_id = 0;
     }
+
+  band_only = icon_view->priv->measure_band_only;
+  icon_view->priv->measure_band_only = FALSE;
   
   if (icon_view->priv->model == NULL)
     return;
 
   widget = BTK_WIDGET (icon_view);
 
-  item_width = icon_view->priv->item_width;
-
-  if (item_width < 0)
+  if (icon_view->priv->fixed_size_mode)
     {
-      for (icons = icon_view->priv->items; icons; icons = icons->next)
+      y += icon_view->priv->margin;
+      btk_icon_view_layout_fixed (icon_view, &y, &maximum_width);
+    }
+  else
+    {
+      bboolean lazy;
+      bint band_y1, band_y2;
+
+      /* Big models only measure the items around the visible area,
+       * one page above and below it; the rest get the size of the
+       * first item until they scroll into view.
+       */
+      lazy = icon_view->priv->n_items > LAZY_LAYOUT_THRESHOLD;
+
+      if (lazy)
 	{
-	  BtkIconViewItem *item = icons->data;
-	  btk_icon_view_calculate_item_size (icon_view, item);
-	  item_width = MAX (item_width, item->width);
+	  bint page = MAX (widget->allocation.height, 1);
+
+	  band_y1 = icon_view->priv->vadjustment->value - page;
+	  band_y2 = icon_view->priv->vadjustment->value + 2 * page;
+	}
+      else
+	{
+	  band_y1 = G_MININT;
+	  band_y2 = G_MAXINT;
 	}
-    }
 
+      icon_view->priv->measured_y1 = band_y1;
+      icon_view->priv->measured_y2 = band_y2;
 
-  icons = icon_view->priv->items;
-  y += icon_view->priv->margin;
-  row = 0;
+      item_width = icon_view->priv->item_width;
+      if (item_width < 0 && lazy)
+	item_width = icon_view->priv->natural_width;
 
-  if (icons)
-    {
-      btk_icon_view_set_cell_data (icon_view, icons->data);
-      adjust_wrap_width (icon_view, icons->data);
-    }
-  
-  do
-    {
-      icons = btk_icon_view_layout_single_row (icon_view, icons, 
-					       item_width, row,
-					       &y, &maximum_width);
-      row++;
+      /* Scrolling into estimated rows only measures those, as long
+       * as nothing else changed since the last layout.
+       */
+      if (!band_only || !lazy ||
+	  widget->allocation.width != icon_view->priv->measured_alloc_width ||
+	  item_width != icon_view->priv->measured_item_width ||
+	  !btk_icon_view_layout_band (icon_view, band_y1, band_y2, item_width,
+				      &y, &maximum_width))
+	{
+	  GPtrArray *item_array = btk_icon_view_get_item_array (icon_view);
+	  bint next;
+
+	  y = 0;
+	  maximum_width = 0;
+	  item_width = icon_view->priv->item_width;
+
+	  if (icon_view->priv->items)
+	    btk_icon_view_update_estimate (icon_view, icon_view->priv->items->data);
+
+	  if (item_width < 0)
+	    {
+	      /* Items that were laid out before are widened to whole
+	       * columns, so lazy layouts go by the natural width of the
+	       * items measured so far instead.
+	       */
+	      if (lazy)
+		item_width = icon_view->priv->natural_width;
+	      else
+		for (icons = icon_view->priv->items; icons; icons = icons->next)
+		  {
+		    BtkIconViewItem *item = icons->data;
+
+		    btk_icon_view_calculate_item_size (icon_view, item);
+		    item_width = MAX (item_width, item->width);
+		  }
+	    }
+
+	  y += icon_view->priv->margin;
+	  row = 0;
+
+	  if (icon_view->priv->items)
+	    {
+	      btk_icon_view_set_cell_data (icon_view, icon_view->priv->items->data);
+	      adjust_wrap_width (icon_view, icon_view->priv->items->data);
+	    }
+
+	  for (next = 0; next < item_array->len; row++)
+	    {
+	      bboolean measure;
+
+	      measure = y + icon_view->priv->estimated_height >= band_y1 && y <= band_y2;
+	      next = btk_icon_view_layout_single_row (icon_view, next,
+						      item_width, row, measure,
+						      &y, &maximum_width);
+	    }
+	}
+
+      icon_view->priv->measured_alloc_width = widget->allocation.width;
+      icon_view->priv->measured_item_width = item_width;
+
+      /* Newly measured items may be wider than the ones the
+       * columns were sized for.
+       */
+      if (lazy && icon_view->priv->item_width < 0 &&
+	  icon_view->priv->natural_width > item_width)
+	btk_icon_view_queue_layout (icon_view);
     }
-  while (icons != NULL);
 
   if (maximum_width != icon_view->priv->width)
     icon_view->priv->width = maximum_width;
@@ -2881,6 +3565,23 @@ btk_icon_view_layout (BtkIconView *icon_view)
 		       MAX (icon_view->priv->width, widget->allocation.width),
 		       MAX (icon_view->priv->height, widget->allocation.height));
 
+  if (icon_view->priv->measure_anchor_index >= 0)
+    {
+      BtkIconViewItem *anchor;
+      BtkAdjustment *vadj = icon_view->priv->vadjustment;
+
+      anchor = NULL;
+      if (icon_view->priv->measure_anchor_index < icon_view->priv->n_items)
+	anchor = g_ptr_array_index (btk_icon_view_get_item_array (icon_view),
+				    icon_view->priv->measure_anchor_index);
+      icon_view->priv->measure_anchor_index = -1;
+
+      if (anchor)
+	btk_adjustment_set_value (vadj,
+				  CLAMP (anchor->y - icon_view->priv->measure_anchor_offset,
+					 vadj->lower, vadj->upper - vadj->page_size));
+    }
+
   if (icon_view->priv->scroll_to_path)
     {
       BtkTreePath *path;
@@ -2905,6 +3606,8 @@ btk_icon_view_get_cell_area (BtkIconView         *icon_view,
 			     BtkIconViewCellInfo *info,
 			     BdkRectangle        *cell_area)
 {
+  btk_icon_view_item_ensure_box (icon_view, item);
+
   g_return_if_fail (info->position < item->n_cells);
 
   if (icon_view->priv->item_orientation == BTK_ORIENTATION_HORIZONTAL)
@@ -2931,6 +3634,8 @@ btk_icon_view_get_cell_box (BtkIconView         *icon_view,
 			    BtkIconViewCellInfo *info,
 			    BdkRectangle        *box)
 {
+  btk_icon_view_item_ensure_box (icon_view, item);
+
   g_return_if_fail (info->position < item->n_cells);
 
   *box = item->box[info->position];
@@ -2985,15 +3690,9 @@ adjust_wrap_width (BtkIconView     *icon_view,
 }
 
 static void
-btk_icon_view_calculate_item_size (BtkIconView     *icon_view,
-				   BtkIconViewItem *item)
+btk_icon_view_item_ensure_cells (BtkIconView     *icon_view,
+				 BtkIconViewItem *item)
 {
-  bint spacing;
-  GList *l;
-
-  if (item->width != -1 && item->height != -1) 
-    return;
-
   if (item->n_cells != icon_view->priv->n_cells)
     {
       g_free (item->before);
@@ -3006,6 +3705,23 @@ btk_icon_view_calculate_item_size (BtkIconView     *icon_view,
 
       item->n_cells = icon_view->priv->n_cells;
     }
+}
+
+static void
+btk_icon_view_calculate_item_size (BtkIconView     *icon_view,
+				   BtkIconViewItem *item)
+{
+  bint spacing;
+  GList *l;
+
+  if (item->width != -1 && item->height != -1 && !item->estimated) 
+    return;
+
+  if (item->estimated)
+    icon_view->priv->n_estimated--;
+  item->estimated = FALSE;
+
+  btk_icon_view_item_ensure_cells (icon_view, item);
 
   btk_icon_view_set_cell_data (icon_view, item);
 
@@ -3040,6 +3756,8 @@ btk_icon_view_calculate_item_size (BtkIconView     *icon_view,
 
   item->width += icon_view->priv->item_padding * 2;
   item->height += icon_view->priv->item_padding * 2;
+
+  icon_view->priv->natural_width = MAX (icon_view->priv->natural_width, item->width);
 }
 
 static void
@@ -3059,6 +3777,7 @@ btk_icon_view_calculate_item_size2 (BtkIconView     *icon_view,
 
   spacing = icon_view->priv->spacing;
 
+  item->box_pending = FALSE;
   item->height = 0;
   for (i = 0; i < icon_view->priv->n_cells; i++)
     {
@@ -3141,6 +3860,7 @@ btk_icon_view_calculate_item_size2 (BtkIconView     *icon_view,
 static void
 btk_icon_view_invalidate_sizes (BtkIconView *icon_view)
 {
+  icon_view->priv->natural_width = -1;
   g_list_foreach (icon_view->priv->items,
 		  (GFunc)btk_icon_view_item_invalidate_size, NULL);
 }
@@ -3412,6 +4132,8 @@ layout_callback (bpointer user_data)
 static void
 btk_icon_view_queue_layout (BtkIconView *icon_view)
 {
+  icon_view->priv->measure_band_only = FALSE;
+
   if (icon_view->priv->layout_idle_id != 0)
     return;
 
@@ -3486,61 +4208,92 @@ btk_icon_view_item_free (BtkIconViewItem *item)
 }
 
 
-static BtkIconViewItem *
-btk_icon_view_get_item_at_coords (BtkIconView          *icon_view,
-				  bint                  x,
-				  bint                  y,
-				  bboolean              only_in_cell,
-				  BtkIconViewCellInfo **cell_at_pos)
+static bboolean
+btk_icon_view_item_at_coords (BtkIconView          *icon_view,
+			      BtkIconViewItem      *item,
+			      bint                  x,
+			      bint                  y,
+			      bboolean              only_in_cell,
+			      BtkIconViewCellInfo **cell_at_pos,
+			      BtkIconViewItem     **result)
 {
-  GList *items, *l;
+  GList *l;
   BdkRectangle box;
 
-  if (cell_at_pos)
-    *cell_at_pos = NULL;
+  if (!(x >= item->x - icon_view->priv->column_spacing/2 && x <= item->x + item->width + icon_view->priv->column_spacing/2 &&
+	y >= item->y - icon_view->priv->row_spacing/2 && y <= item->y + item->height + icon_view->priv->row_spacing/2))
+    return FALSE;
 
-  for (items = icon_view->priv->items; items; items = items->next)
+  *result = item;
+
+  if (only_in_cell || cell_at_pos)
     {
-      BtkIconViewItem *item = items->data;
+      btk_icon_view_set_cell_data (icon_view, item);
 
-      if (x >= item->x - icon_view->priv->column_spacing/2 && x <= item->x + item->width + icon_view->priv->column_spacing/2 &&
-	  y >= item->y - icon_view->priv->row_spacing/2 && y <= item->y + item->height + icon_view->priv->row_spacing/2)
+      for (l = icon_view->priv->cell_list; l; l = l->next)
 	{
-	  if (only_in_cell || cell_at_pos)
+	  BtkIconViewCellInfo *info = (BtkIconViewCellInfo *)l->data;
+
+	  if (!info->cell->visible)
+	    continue;
+
+	  btk_icon_view_get_cell_box (icon_view, item, info, &box);
+
+	  if ((x >= box.x && x <= box.x + box.width &&
+	       y >= box.y && y <= box.y + box.height) ||
+	      (x >= box.x  &&
+	       x <= box.x + box.width &&
+	       y >= box.y &&
+	       y <= box.y + box.height))
 	    {
-	      btk_icon_view_set_cell_data (icon_view, item);
+	      if (cell_at_pos)
+		*cell_at_pos = info;
 
-	      for (l = icon_view->priv->cell_list; l; l = l->next)
-		{
-		  BtkIconViewCellInfo *info = (BtkIconViewCellInfo *)l->data;
+	      return TRUE;
+	    }
+	}
 
-		  if (!info->cell->visible)
-		    continue;
+      if (only_in_cell)
+	*result = NULL;
+    }
 
-		  btk_icon_view_get_cell_box (icon_view, item, info, &box);
+  return TRUE;
+}
 
-		  if ((x >= box.x && x <= box.x + box.width &&
-		       y >= box.y && y <= box.y + box.height) ||
-		      (x >= box.x  &&
-		       x <= box.x + box.width &&
-		       y >= box.y &&
-		       y <= box.y + box.height))
-		    {
-		      if (cell_at_pos)
-			*cell_at_pos = info;
+static BtkIconViewItem *
+btk_icon_view_get_item_at_coords (BtkIconView          *icon_view,
+				  bint                  x,
+				  bint                  y,
+				  bboolean              only_in_cell,
+				  BtkIconViewCellInfo **cell_at_pos)
+{
+  GList *items;
+  BtkIconViewItem *result = NULL;
+  bint first, last, i;
 
-		      return item;
-		    }
-		}
+  if (cell_at_pos)
+    *cell_at_pos = NULL;
 
-	      if (only_in_cell)
-		return NULL;
-	    }
+  /* In fixed size mode only the rows within reach of @y can match */
+  if (btk_icon_view_get_fixed_range (icon_view,
+				     y - icon_view->priv->row_spacing/2 - 1,
+				     y + icon_view->priv->row_spacing/2 + 1,
+				     &first, &last))
+    {
+      for (i = first; i < last; i++)
+	if (btk_icon_view_item_at_coords (icon_view,
+					  g_ptr_array_index (icon_view->priv->item_array, i),
+					  x, y, only_in_cell, cell_at_pos, &result))
+	  return result;
 
-	  return item;
-	}
+      return NULL;
     }
 
+  for (items = icon_view->priv->items; items; items = items->next)
+    if (btk_icon_view_item_at_coords (icon_view, items->data,
+				      x, y, only_in_cell, cell_at_pos, &result))
+      return result;
+
   return NULL;
 }
 
@@ -3606,6 +4359,10 @@ verify_items (BtkIconView *icon_view)
 
       i++;
     }
+
+  if (i != icon_view->priv->n_items)
+    g_error ("Item count does not match the list: "
+	     "count %d and list length %d\n", icon_view->priv->n_items, i);
 }
 
 static void
@@ -3656,12 +4413,15 @@ btk_icon_view_row_inserted (BtkTreeModel *model,
 
   item->index = index;
 
+  btk_icon_view_drop_item_array (icon_view);
+
   /* FIXME: We can be more efficient here,
      we can store a tail pointer and use that when
      appending (which is a rather common operation)
   */
   icon_view->priv->items = g_list_insert (icon_view->priv->items,
 					 item, index);
+  icon_view->priv->n_items++;
   
   list = g_list_nth (icon_view->priv->items, index + 1);
   for (; list; list = list->next)
@@ -3704,7 +4464,11 @@ btk_icon_view_row_deleted (BtkTreeModel *model,
 
   if (item->selected)
     emit = TRUE;
+
+  if (item->estimated)
+    icon_view->priv->n_estimated--;
   
+  btk_icon_view_drop_item_array (icon_view);
   btk_icon_view_item_free (item);
 
   for (next = list->next; next; next = next->next)
@@ -3715,6 +4479,7 @@ btk_icon_view_row_deleted (BtkTreeModel *model,
     }
   
   icon_view->priv->items = g_list_delete_link (icon_view->priv->items, list);
+  icon_view->priv->n_items--;
 
   verify_items (icon_view);  
   
@@ -3741,6 +4506,7 @@ btk_icon_view_rows_reordered (BtkTreeModel *model,
   icon_view = BTK_ICON_VIEW (data);
 
   btk_icon_view_stop_editing (icon_view, TRUE);
+  btk_icon_view_drop_item_array (icon_view);
 
   length = btk_tree_model_iter_n_children (model, NULL);
 
@@ -3800,6 +4566,7 @@ btk_icon_view_build_items (BtkIconView *icon_view)
     } while (btk_tree_model_iter_next (icon_view->priv->model, &iter));
 
   icon_view->priv->items = g_list_reverse (items);
+  icon_view->priv->n_items = i;
 }
 
 static void
@@ -5179,6 +5946,23 @@ btk_icon_view_get_tooltip_column (BtkIconView *icon_view)
   return icon_view->priv->tooltip_column;
 }
 
+static void
+btk_icon_view_update_visible_range (BtkIconView     *icon_view,
+				    BtkIconViewItem *item,
+				    bint            *start_index,
+				    bint            *end_index)
+{
+  if ((item->x + item->width >= (int)icon_view->priv->hadjustment->value) &&
+      (item->y + item->height >= (int)icon_view->priv->vadjustment->value) &&
+      (item->x <= (int) (icon_view->priv->hadjustment->value + icon_view->priv->hadjustment->page_size)) &&
+      (item->y <= (int) (icon_view->priv->vadjustment->value + icon_view->priv->vadjustment->page_size)))
+    {
+      if (*start_index == -1)
+	*start_index = item->index;
+      *end_index = item->index;
+    }
+}
+
 /**
  * btk_icon_view_get_visible_range:
  * @icon_view: A #BtkIconView
@@ -5202,6 +5986,7 @@ btk_icon_view_get_visible_range (BtkIconView  *icon_view,
   bint start_index = -1;
   bint end_index = -1;
   GList *icons;
+  bint first, last, i;
 
   g_return_val_if_fail (BTK_IS_ICON_VIEW (icon_view), FALSE);
 
@@ -5211,20 +5996,22 @@ btk_icon_view_get_visible_range (BtkIconView  *icon_view,
 
   if (start_path == NULL && end_path == NULL)
     return FALSE;
-  
-  for (icons = icon_view->priv->items; icons; icons = icons->next) 
-    {
-      BtkIconViewItem *item = icons->data;
 
-      if ((item->x + item->width >= (int)icon_view->priv->hadjustment->value) &&
-	  (item->y + item->height >= (int)icon_view->priv->vadjustment->value) &&
-	  (item->x <= (int) (icon_view->priv->hadjustment->value + icon_view->priv->hadjustment->page_size)) &&
-	  (item->y <= (int) (icon_view->priv->vadjustment->value + icon_view->priv->vadjustment->page_size)))
-	{
-	  if (start_index == -1)
-	    start_index = item->index;
-	  end_index = item->index;
-	}
+  if (btk_icon_view_get_fixed_range (icon_view,
+				     icon_view->priv->vadjustment->value - 1,
+				     icon_view->priv->vadjustment->value + icon_view->priv->vadjustment->page_size + 1,
+				     &first, &last))
+    {
+      for (i = first; i < last; i++)
+	btk_icon_view_update_visible_range (icon_view,
+					    g_ptr_array_index (icon_view->priv->item_array, i),
+					    &start_index, &end_index);
+    }
+  else
+    {
+      for (icons = icon_view->priv->items; icons; icons = icons->next) 
+	btk_icon_view_update_visible_range (icon_view, icons->data,
+					    &start_index, &end_index);
     }
 
   if (start_path && start_index != -1)
@@ -5389,14 +6176,19 @@ btk_icon_view_set_model (BtkIconView *icon_view,
 
       g_object_unref (icon_view->priv->model);
       
+      btk_icon_view_drop_item_array (icon_view);
       g_list_foreach (icon_view->priv->items, (GFunc)btk_icon_view_item_free, NULL);
       g_list_free (icon_view->priv->items);
       icon_view->priv->items = NULL;
+      icon_view->priv->n_items = 0;
       icon_view->priv->anchor_item = NULL;
       icon_view->priv->cursor_item = NULL;
       icon_view->priv->last_single_clicked = NULL;
       icon_view->priv->width = 0;
       icon_view->priv->height = 0;
+      icon_view->priv->natural_width = -1;
+      icon_view->priv->n_estimated = 0;
+      icon_view->priv->measure_anchor_index = -1;
     }
 
   icon_view->priv->model = model;
@@ -6464,6 +7256,60 @@ btk_icon_view_get_item_padding (BtkIconView *icon_view)
   return icon_view->priv->item_padding;
 }
 
+/**
+ * btk_icon_view_set_fixed_size_mode:
+ * @icon_view: a #BtkIconView
+ * @enable: %TRUE to enable fixed size mode
+ *
+ * Enables or disables the fixed size mode of @icon_view.
+ * Fixed size mode speeds up #BtkIconView by assuming that all
+ * items have the same size as the first one: only that item is
+ * measured, the others are placed on a regular grid, and finding
+ * the item at a position or the items in an area only looks at
+ * the affected rows. Only enable this option if all items are
+ * the same size.
+ *
+ * Since: 2.24.34
+ */
+void
+btk_icon_view_set_fixed_size_mode (BtkIconView *icon_view,
+				   bboolean     enable)
+{
+  g_return_if_fail (BTK_IS_ICON_VIEW (icon_view));
+
+  enable = enable != FALSE;
+
+  if (icon_view->priv->fixed_size_mode != enable)
+    {
+      icon_view->priv->fixed_size_mode = enable;
+
+      btk_icon_view_drop_item_array (icon_view);
+      btk_icon_view_stop_editing (icon_view, TRUE);
+      btk_icon_view_invalidate_sizes (icon_view);
+      btk_icon_view_queue_layout (icon_view);
+
+      g_object_notify (B_OBJECT (icon_view), "fixed-size-mode");
+    }
+}
+
+/**
+ * btk_icon_view_get_fixed_size_mode:
+ * @icon_view: a #BtkIconView
+ *
+ * Returns whether fixed size mode is turned on for @icon_view.
+ *
+ * Return value: %TRUE if @icon_view is in fixed size mode
+ *
+ * Since: 2.24.34
+ */
+bboolean
+btk_icon_view_get_fixed_size_mode (BtkIconView *icon_view)
+{
+  g_return_val_if_fail (BTK_IS_ICON_VIEW (icon_view), FALSE);
+
+  return icon_view->priv->fixed_size_mode;
+}
+
 /* Get/set whether drag_motion requested the drag data and
  * drag_data_received should thus not actually insert the data,
  * since the data doesn't result from a drop.
@@ -131,6 +131,9 @@ bint           btk_icon_view_get_margin        (BtkIconView    *icon_view);
 void           btk_icon_view_set_item_padding  (BtkIconView    *icon_view, 
 					        bint            item_padding);
 bint           btk_icon_view_get_item_padding  (BtkIconView    *icon_view);
+void           btk_icon_view_set_fixed_size_mode (BtkIconView  *icon_view,
+						  bboolean      enable);
+bboolean       btk_icon_view_get_fixed_size_mode (BtkIconView  *icon_view);
 
 
 BtkTreePath *  btk_icon_view_get_path_at_pos   (BtkIconView     *icon_view,
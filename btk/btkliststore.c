@@ -26,14 +26,27 @@
 #include "btkliststore.h"
 #include "btktreedatalist.h"
 #include "btktreednd.h"
+#include "btktreeprivate.h"
 #include "btkintl.h"
 #include "btkbuildable.h"
 #include "btkbuilderprivate.h"
 #include "btkalias.h"
 
+#define BTK_LIST_STORE_GET_PRIVATE(obj) (B_TYPE_INSTANCE_GET_PRIVATE ((obj), BTK_TYPE_LIST_STORE, BtkListStorePrivate))
+
 #define BTK_LIST_STORE_IS_SORTED(list) (((BtkListStore*)(list))->sort_column_id != BTK_TREE_SORTABLE_UNSORTED_SORT_COLUMN_ID)
 #define VALID_ITER(iter, list_store) ((iter)!= NULL && (iter)->user_data != NULL && list_store->stamp == (iter)->stamp && !g_sequence_iter_is_end ((iter)->user_data) && g_sequence_iter_get_sequence ((iter)->user_data) == list_store->seq)
 
+typedef struct _BtkListStorePrivate BtkListStorePrivate;
+
+struct _BtkListStorePrivate
+{
+  /* created on first use when columnar is set */
+  BtkTreeDataColumns *columns;
+
+  buint columnar : 1;
+};
+
 static void         btk_list_store_tree_model_init (BtkTreeModelIface *iface);
 static void         btk_list_store_drag_source_init(BtkTreeDragSourceIface *iface);
 static void         btk_list_store_drag_dest_init  (BtkTreeDragDestIface   *iface);
@@ -153,6 +166,8 @@ btk_list_store_class_init (BtkListStoreClass *class)
   object_class = (BObjectClass*) class;
 
   object_class->finalize = btk_list_store_finalize;
+
+  g_type_class_add_private (class, sizeof (BtkListStorePrivate));
 }
 
 static void
@@ -333,6 +348,84 @@ btk_list_store_set_column_types (BtkListStore *list_store,
     }
 }
 
+/**
+ * btk_list_store_set_columnar:
+ * @list_store: A #BtkListStore
+ * @columnar: %TRUE to keep the values in per-column arrays
+ *
+ * Chooses how @list_store keeps its values.  By default every value is
+ * allocated on its own.  A columnar store keeps one array per column
+ * instead, and shares the memory of equal strings, which takes a lot
+ * less memory for large stores and is faster to scan when sorting or
+ * filtering.
+ *
+ * Each shared string counts the cells using it, and is freed as soon
+ * as the last of them is changed or removed, so changing strings does
+ * not make a columnar store grow.
+ *
+ * Like btk_list_store_set_column_types(), this must be called before a
+ * row has been added or a method of the #BtkTreeModel interface has
+ * been called.
+ *
+ * Since: 2.24.34
+ **/
+void
+btk_list_store_set_columnar (BtkListStore *list_store,
+			     bboolean      columnar)
+{
+  BtkListStorePrivate *priv;
+
+  g_return_if_fail (BTK_IS_LIST_STORE (list_store));
+  g_return_if_fail (list_store->columns_dirty == 0);
+
+  priv = BTK_LIST_STORE_GET_PRIVATE (list_store);
+  priv->columnar = columnar != FALSE;
+}
+
+/**
+ * btk_list_store_get_columnar:
+ * @list_store: A #BtkListStore
+ *
+ * Returns whether @list_store keeps its values in per-column arrays.
+ * See btk_list_store_set_columnar().
+ *
+ * Return value: %TRUE if @list_store is columnar
+ *
+ * Since: 2.24.34
+ **/
+bboolean
+btk_list_store_get_columnar (BtkListStore *list_store)
+{
+  g_return_val_if_fail (BTK_IS_LIST_STORE (list_store), FALSE);
+
+  return BTK_LIST_STORE_GET_PRIVATE (list_store)->columnar;
+}
+
+static BtkTreeDataColumns *
+btk_list_store_get_columns (BtkListStore *list_store)
+{
+  BtkListStorePrivate *priv = BTK_LIST_STORE_GET_PRIVATE (list_store);
+
+  /* the column types can't change anymore once there are rows */
+  if (priv->columnar && priv->columns == NULL)
+    priv->columns = _btk_tree_data_columns_new (list_store->n_columns,
+						list_store->column_headers);
+
+  return priv->columns;
+}
+
+static void
+btk_list_store_free_row (BtkListStore *list_store,
+			 bpointer      row)
+{
+  BtkListStorePrivate *priv = BTK_LIST_STORE_GET_PRIVATE (list_store);
+
+  if (!priv->columnar)
+    _btk_tree_data_list_free (row, list_store->column_headers);
+  else if (priv->columns)
+    _btk_tree_data_columns_row_free (priv->columns, row);
+}
+
 static void
 btk_list_store_set_n_columns (BtkListStore *list_store,
 			      bint          n_columns)
@@ -370,9 +463,13 @@ static void
 btk_list_store_finalize (BObject *object)
 {
   BtkListStore *list_store = BTK_LIST_STORE (object);
+  BtkListStorePrivate *priv = BTK_LIST_STORE_GET_PRIVATE (list_store);
 
-  g_sequence_foreach (list_store->seq,
-		      (GFunc) _btk_tree_data_list_free, list_store->column_headers);
+  if (priv->columns)
+    _btk_tree_data_columns_free (priv->columns);
+  else if (!priv->columnar)
+    g_sequence_foreach (list_store->seq,
+			(GFunc) _btk_tree_data_list_free, list_store->column_headers);
 
   g_sequence_free (list_store->seq);
 
@@ -475,7 +572,15 @@ btk_list_store_get_value (BtkTreeModel *tree_model,
 
   g_return_if_fail (column < list_store->n_columns);
   g_return_if_fail (VALID_ITER (iter, list_store));
-		    
+
+  if (BTK_LIST_STORE_GET_PRIVATE (list_store)->columnar)
+    {
+      _btk_tree_data_columns_get_value (btk_list_store_get_columns (list_store),
+					g_sequence_get (iter->user_data),
+					column, value);
+      return;
+    }
+
   list = g_sequence_get (iter->user_data);
 
   while (tmp_column-- > 0 && list)
@@ -624,6 +729,28 @@ btk_list_store_real_set_value (BtkListStore *list_store,
       converted = TRUE;
     }
 
+  if (BTK_LIST_STORE_GET_PRIVATE (list_store)->columnar)
+    {
+      BtkTreeDataColumns *columns = btk_list_store_get_columns (list_store);
+      bpointer row = g_sequence_get (iter->user_data);
+
+      if (row == NULL)
+	{
+	  row = _btk_tree_data_columns_row_alloc (columns);
+	  g_sequence_set (iter->user_data, row);
+	}
+
+      _btk_tree_data_columns_set_value (columns, row, column,
+					converted ? &real_value : value);
+
+      if (converted)
+	b_value_unset (&real_value);
+      if (sort && BTK_LIST_STORE_IS_SORTED (list_store))
+	btk_list_store_sort_iter_changed (list_store, iter, old_column);
+
+      return TRUE;
+    }
+
   prev = list = g_sequence_get (iter->user_data);
 
   while (list != NULL)
@@ -968,7 +1095,7 @@ btk_list_store_remove (BtkListStore *list_store,
   ptr = iter->user_data;
   next = g_sequence_iter_next (ptr);
   
-  _btk_tree_data_list_free (g_sequence_get (ptr), list_store->column_headers);
+  btk_list_store_free_row (list_store, g_sequence_get (ptr));
   g_sequence_remove (iter->user_data);
 
   list_store->length--;
@@ -1320,28 +1447,40 @@ btk_list_store_drag_data_received (BtkTreeDragDest   *drag_dest,
           BtkTreeDataList *copy_prev = NULL;
           BtkTreeDataList *copy_iter = NULL;
 	  BtkTreePath *path;
+          bpointer copy = NULL;
           bint col;
 
-          col = 0;
-          while (dl)
+          if (BTK_LIST_STORE_GET_PRIVATE (list_store)->columnar)
             {
-              copy_iter = _btk_tree_data_list_node_copy (dl,
-                                                         list_store->column_headers[col]);
+              if (dl)
+                copy = _btk_tree_data_columns_row_copy (btk_list_store_get_columns (list_store),
+                                                        dl);
+            }
+          else
+            {
+              col = 0;
+              while (dl)
+                {
+                  copy_iter = _btk_tree_data_list_node_copy (dl,
+                                                             list_store->column_headers[col]);
+
+                  if (copy_head == NULL)
+                    copy_head = copy_iter;
 
-              if (copy_head == NULL)
-                copy_head = copy_iter;
+                  if (copy_prev)
+                    copy_prev->next = copy_iter;
 
-              if (copy_prev)
-                copy_prev->next = copy_iter;
+                  copy_prev = copy_iter;
 
-              copy_prev = copy_iter;
+                  dl = dl->next;
+                  ++col;
+                }
 
-              dl = dl->next;
-              ++col;
+              copy = copy_head;
             }
 
 	  dest_iter.stamp = list_store->stamp;
-          g_sequence_set (dest_iter.user_data, copy_head);
+          g_sequence_set (dest_iter.user_data, copy);
 
 	  path = btk_list_store_get_path (tree_model, &dest_iter);
 	  btk_tree_model_row_changed (tree_model, path, &dest_iter);
@@ -1696,6 +1835,54 @@ btk_list_store_compare_func (GSequenceIter *a,
   return retval;
 }
 
+/* Sorts by the keys of the rows when the column compare function is
+ * the default one; returns the new order, or %NULL if nothing was done.
+ */
+static bint *
+btk_list_store_sort_by_key (BtkListStore *list_store)
+{
+  BtkTreeDataSortHeader *header;
+  GSequenceIter *ptr, *end;
+  BtkTreeIter *iters;
+  bint *new_order;
+  bint i, n_rows;
+
+  if (list_store->sort_column_id == BTK_TREE_SORTABLE_DEFAULT_SORT_COLUMN_ID)
+    return NULL;
+
+  header = _btk_tree_data_list_get_header (list_store->sort_list,
+					   list_store->sort_column_id);
+  if (header == NULL || header->func != _btk_tree_data_list_compare_func)
+    return NULL;
+
+  n_rows = g_sequence_get_length (list_store->seq);
+  iters = g_new (BtkTreeIter, n_rows);
+
+  ptr = g_sequence_get_begin_iter (list_store->seq);
+  for (i = 0; i < n_rows; i++)
+    {
+      iters[i].stamp = list_store->stamp;
+      iters[i].user_data = ptr;
+      ptr = g_sequence_iter_next (ptr);
+    }
+
+  new_order = _btk_tree_data_list_sort_by_key (BTK_TREE_MODEL (list_store),
+					       iters, n_rows,
+					       header->func, header->data,
+					       list_store->order);
+
+  if (new_order)
+    {
+      end = g_sequence_get_end_iter (list_store->seq);
+      for (i = 0; i < n_rows; i++)
+	g_sequence_move (iters[new_order[i]].user_data, end);
+    }
+
+  g_free (iters);
+
+  return new_order;
+}
+
 static void
 btk_list_store_sort (BtkListStore *list_store)
 {
@@ -1707,12 +1894,17 @@ btk_list_store_sort (BtkListStore *list_store)
       g_sequence_get_length (list_store->seq) <= 1)
     return;
 
-  old_positions = save_positions (list_store->seq);
+  new_order = btk_list_store_sort_by_key (list_store);
+  if (!new_order)
+    {
+      old_positions = save_positions (list_store->seq);
 
-  g_sequence_sort_iter (list_store->seq, btk_list_store_compare_func, list_store);
+      g_sequence_sort_iter (list_store->seq, btk_list_store_compare_func, list_store);
+
+      new_order = generate_order (list_store->seq, old_positions);
+    }
 
   /* Let the world know about our new order */
-  new_order = generate_order (list_store->seq, old_positions);
 
   path = btk_tree_path_new ();
   btk_tree_model_rows_reordered (BTK_TREE_MODEL (list_store),
@@ -2042,6 +2234,117 @@ btk_list_store_insert_with_valuesv (BtkListStore *list_store,
   btk_tree_path_free (path);
 }
 
+/**
+ * btk_list_store_insert_rows:
+ * @list_store: A #BtkListStore
+ * @position: position to insert the first new row, or -1 to append
+ * @n_rows: the number of rows to insert
+ * @columns: (array length=n_values): an array of column numbers
+ * @values: an array of @n_values * @n_rows BValues
+ * @n_values: the length of the @columns array
+ *
+ * Inserts @n_rows new rows at @position in one operation.  @values is
+ * laid out column by column: the value for row @r in column
+ * @columns[@i] is @values[@i * @n_rows + @r].
+ *
+ * Views and proxy models that support it are notified with a single
+ * #BtkTreeModel::rows-inserted emission instead of one
+ * #BtkTreeModel::row-inserted per row.  If something connected to
+ * @list_store only handles single rows, the rows are inserted one by
+ * one as with btk_list_store_insert_with_valuesv().
+ *
+ * If @list_store is sorted, the new rows are added at the end and then
+ * moved to their sorted positions with one #BtkTreeModel::rows-reordered
+ * emission.
+ *
+ * To replace the contents of @list_store, call btk_list_store_clear()
+ * first.  Its removals are still announced with one
+ * #BtkTreeModel::row-deleted per row: #BtkTreeModel has no signal for
+ * a range of deleted rows, and every view, proxy model and row
+ * reference would have to handle one before it could be emitted.  For
+ * very large replacements it is faster to take the model away from
+ * its views while it is cleared and refilled.
+ *
+ * Since: 2.24.34
+ */
+void
+btk_list_store_insert_rows (BtkListStore *list_store,
+			    bint          position,
+			    bint          n_rows,
+			    bint         *columns,
+			    BValue       *values,
+			    bint          n_values)
+{
+  BtkTreePath *path;
+  GSequence *seq;
+  GSequenceIter *ptr;
+  BtkTreeIter iter;
+  bint length;
+  bint i, r;
+
+  g_return_if_fail (BTK_IS_LIST_STORE (list_store));
+  g_return_if_fail (n_rows >= 0);
+  g_return_if_fail (n_values >= 0);
+  g_return_if_fail (n_values == 0 || (columns != NULL && values != NULL));
+
+  if (n_rows == 0)
+    return;
+
+  seq = list_store->seq;
+
+  length = g_sequence_get_length (seq);
+  if (position < 0 || position > length || BTK_LIST_STORE_IS_SORTED (list_store))
+    position = length;
+
+  if (!_btk_tree_model_rows_inserted_supported (BTK_TREE_MODEL (list_store)))
+    {
+      BValue *row_values;
+
+      row_values = g_new (BValue, MAX (n_values, 1));
+
+      for (r = 0; r < n_rows; r++)
+	{
+	  /* shallow copies, the values are only read */
+	  for (i = 0; i < n_values; i++)
+	    row_values[i] = values[i * n_rows + r];
+
+	  btk_list_store_insert_with_valuesv (list_store, NULL,
+					      position + r,
+					      columns, row_values, n_values);
+	}
+
+      g_free (row_values);
+      return;
+    }
+
+  list_store->columns_dirty = TRUE;
+
+  iter.stamp = list_store->stamp;
+
+  ptr = g_sequence_get_iter_at_pos (seq, position);
+  for (r = 0; r < n_rows; r++)
+    {
+      iter.user_data = g_sequence_insert_before (ptr, NULL);
+
+      for (i = 0; i < n_values; i++)
+	btk_list_store_real_set_value (list_store, &iter,
+				       columns[i],
+				       &values[i * n_rows + r],
+				       FALSE);
+    }
+
+  list_store->length += n_rows;
+
+  iter.user_data = g_sequence_get_iter_at_pos (seq, position);
+
+  path = btk_tree_path_new ();
+  btk_tree_path_append_index (path, position);
+  btk_tree_model_rows_inserted (BTK_TREE_MODEL (list_store), path, &iter, n_rows);
+  btk_tree_path_free (path);
+
+  btk_list_store_sort (list_store);
+}
+
 /* BtkBuildable custom tag implementation
  *
  * <columns>
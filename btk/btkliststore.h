@@ -82,6 +82,9 @@ BtkListStore *btk_list_store_newv             (bint          n_columns,
 void          btk_list_store_set_column_types (BtkListStore *list_store,
 					       bint          n_columns,
 					       GType        *types);
+void          btk_list_store_set_columnar     (BtkListStore *list_store,
+					       bboolean      columnar);
+bboolean      btk_list_store_get_columnar     (BtkListStore *list_store);
 
 /* NOTE: use btk_tree_model_get to get values from a BtkListStore */
 
@@ -121,6 +124,12 @@ void          btk_list_store_insert_with_valuesv (BtkListStore *list_store,
 						  bint         *columns,
 						  BValue       *values,
 						  bint          n_values);
+void          btk_list_store_insert_rows         (BtkListStore *list_store,
+						  bint          position,
+						  bint          n_rows,
+						  bint         *columns,
+						  BValue       *values,
+						  bint          n_values);
 void          btk_list_store_prepend          (BtkListStore *list_store,
 					       BtkTreeIter  *iter);
 void          btk_list_store_append           (BtkListStore *list_store,
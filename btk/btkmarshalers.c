@@ -1265,7 +1265,46 @@ _btk_marshal_VOID__BOXED_BOXED (GClosure     *closure,
             data2);
 }
 
-/* VOID:BOXED,BOXED,POINTER (./btkmarshalers.list:58) */
+/* VOID:BOXED,BOXED,INT (./btkmarshalers.list:58) */
+void
+_btk_marshal_VOID__BOXED_BOXED_INT (GClosure     *closure,
+                                    BValue       *return_value B_GNUC_UNUSED,
+                                    buint         n_param_values,
+                                    const BValue *param_values,
+                                    bpointer      invocation_hint B_GNUC_UNUSED,
+                                    bpointer      marshal_data)
+{
+  typedef void (*GMarshalFunc_VOID__BOXED_BOXED_INT) (bpointer data1,
+                                                      bpointer arg1,
+                                                      bpointer arg2,
+                                                      bint     arg3,
+                                                      bpointer data2);
+  GCClosure *cc = (GCClosure *) closure;
+  bpointer data1, data2;
+  GMarshalFunc_VOID__BOXED_BOXED_INT callback;
+
+  g_return_if_fail (n_param_values == 4);
+
+  if (G_CCLOSURE_SWAP_DATA (closure))
+    {
+      data1 = closure->data;
+      data2 = b_value_peek_pointer (param_values + 0);
+    }
+  else
+    {
+      data1 = b_value_peek_pointer (param_values + 0);
+      data2 = closure->data;
+    }
+  callback = (GMarshalFunc_VOID__BOXED_BOXED_INT) (marshal_data ? marshal_data : cc->callback);
+
+  callback (data1,
+            g_marshal_value_peek_boxed (param_values + 1),
+            g_marshal_value_peek_boxed (param_values + 2),
+            g_marshal_value_peek_int (param_values + 3),
+            data2);
+}
+
+/* VOID:BOXED,BOXED,POINTER (./btkmarshalers.list:59) */
 void
 _btk_marshal_VOID__BOXED_BOXED_POINTER (GClosure     *closure,
                                         BValue       *return_value B_GNUC_UNUSED,
@@ -1304,7 +1343,7 @@ _btk_marshal_VOID__BOXED_BOXED_POINTER (GClosure     *closure,
             data2);
 }
 
-/* VOID:BOXED,OBJECT (./btkmarshalers.list:59) */
+/* VOID:BOXED,OBJECT (./btkmarshalers.list:60) */
 void
 _btk_marshal_VOID__BOXED_OBJECT (GClosure     *closure,
                                  BValue       *return_value B_GNUC_UNUSED,
@@ -1341,7 +1380,7 @@ _btk_marshal_VOID__BOXED_OBJECT (GClosure     *closure,
             data2);
 }
 
-/* VOID:BOXED,STRING,INT (./btkmarshalers.list:60) */
+/* VOID:BOXED,STRING,INT (./btkmarshalers.list:61) */
 void
 _btk_marshal_VOID__BOXED_STRING_INT (GClosure     *closure,
                                      BValue       *return_value B_GNUC_UNUSED,
@@ -1380,7 +1419,7 @@ _btk_marshal_VOID__BOXED_STRING_INT (GClosure     *closure,
             data2);
 }
 
-/* VOID:BOXED,UINT (./btkmarshalers.list:61) */
+/* VOID:BOXED,UINT (./btkmarshalers.list:62) */
 void
 _btk_marshal_VOID__BOXED_UINT (GClosure     *closure,
                                BValue       *return_value B_GNUC_UNUSED,
@@ -1417,7 +1456,7 @@ _btk_marshal_VOID__BOXED_UINT (GClosure     *closure,
             data2);
 }
 
-/* VOID:BOXED,UINT,FLAGS (./btkmarshalers.list:62) */
+/* VOID:BOXED,UINT,FLAGS (./btkmarshalers.list:63) */
 void
 _btk_marshal_VOID__BOXED_UINT_FLAGS (GClosure     *closure,
                                      BValue       *return_value B_GNUC_UNUSED,
@@ -1456,7 +1495,7 @@ _btk_marshal_VOID__BOXED_UINT_FLAGS (GClosure     *closure,
             data2);
 }
 
-/* VOID:BOXED,UINT,UINT (./btkmarshalers.list:63) */
+/* VOID:BOXED,UINT,UINT (./btkmarshalers.list:64) */
 void
 _btk_marshal_VOID__BOXED_UINT_UINT (GClosure     *closure,
                                     BValue       *return_value B_GNUC_UNUSED,
@@ -1495,7 +1534,7 @@ _btk_marshal_VOID__BOXED_UINT_UINT (GClosure     *closure,
             data2);
 }
 
-/* VOID:ENUM,BOOLEAN (./btkmarshalers.list:65) */
+/* VOID:ENUM,BOOLEAN (./btkmarshalers.list:66) */
 void
 _btk_marshal_VOID__ENUM_BOOLEAN (GClosure     *closure,
                                  BValue       *return_value B_GNUC_UNUSED,
@@ -1532,7 +1571,7 @@ _btk_marshal_VOID__ENUM_BOOLEAN (GClosure     *closure,
             data2);
 }
 
-/* VOID:ENUM,ENUM (./btkmarshalers.list:66) */
+/* VOID:ENUM,ENUM (./btkmarshalers.list:67) */
 void
 _btk_marshal_VOID__ENUM_ENUM (GClosure     *closure,
                               BValue       *return_value B_GNUC_UNUSED,
@@ -1569,7 +1608,7 @@ _btk_marshal_VOID__ENUM_ENUM (GClosure     *closure,
             data2);
 }
 
-/* VOID:ENUM,FLOAT (./btkmarshalers.list:67) */
+/* VOID:ENUM,FLOAT (./btkmarshalers.list:68) */
 void
 _btk_marshal_VOID__ENUM_FLOAT (GClosure     *closure,
                                BValue       *return_value B_GNUC_UNUSED,
@@ -1606,7 +1645,7 @@ _btk_marshal_VOID__ENUM_FLOAT (GClosure     *closure,
             data2);
 }
 
-/* VOID:ENUM,FLOAT,BOOLEAN (./btkmarshalers.list:68) */
+/* VOID:ENUM,FLOAT,BOOLEAN (./btkmarshalers.list:69) */
 void
 _btk_marshal_VOID__ENUM_FLOAT_BOOLEAN (GClosure     *closure,
                                        BValue       *return_value B_GNUC_UNUSED,
@@ -1645,7 +1684,7 @@ _btk_marshal_VOID__ENUM_FLOAT_BOOLEAN (GClosure     *closure,
             data2);
 }
 
-/* VOID:ENUM,INT (./btkmarshalers.list:69) */
+/* VOID:ENUM,INT (./btkmarshalers.list:70) */
 void
 _btk_marshal_VOID__ENUM_INT (GClosure     *closure,
                              BValue       *return_value B_GNUC_UNUSED,
@@ -1682,7 +1721,7 @@ _btk_marshal_VOID__ENUM_INT (GClosure     *closure,
             data2);
 }
 
-/* VOID:ENUM,INT,BOOLEAN (./btkmarshalers.list:70) */
+/* VOID:ENUM,INT,BOOLEAN (./btkmarshalers.list:71) */
 void
 _btk_marshal_VOID__ENUM_INT_BOOLEAN (GClosure     *closure,
                                      BValue       *return_value B_GNUC_UNUSED,
@@ -1721,7 +1760,7 @@ _btk_marshal_VOID__ENUM_INT_BOOLEAN (GClosure     *closure,
             data2);
 }
 
-/* VOID:ENUM,BOXED (./btkmarshalers.list:71) */
+/* VOID:ENUM,BOXED (./btkmarshalers.list:72) */
 void
 _btk_marshal_VOID__ENUM_BOXED (GClosure     *closure,
                                BValue       *return_value B_GNUC_UNUSED,
@@ -1758,7 +1797,7 @@ _btk_marshal_VOID__ENUM_BOXED (GClosure     *closure,
             data2);
 }
 
-/* VOID:INT,BOOLEAN (./btkmarshalers.list:73) */
+/* VOID:INT,BOOLEAN (./btkmarshalers.list:74) */
 void
 _btk_marshal_VOID__INT_BOOLEAN (GClosure     *closure,
                                 BValue       *return_value B_GNUC_UNUSED,
@@ -1795,7 +1834,7 @@ _btk_marshal_VOID__INT_BOOLEAN (GClosure     *closure,
             data2);
 }
 
-/* VOID:INT,INT (./btkmarshalers.list:74) */
+/* VOID:INT,INT (./btkmarshalers.list:75) */
 void
 _btk_marshal_VOID__INT_INT (GClosure     *closure,
                             BValue       *return_value B_GNUC_UNUSED,
@@ -1832,7 +1871,7 @@ _btk_marshal_VOID__INT_INT (GClosure     *closure,
             data2);
 }
 
-/* VOID:INT,INT,BOXED (./btkmarshalers.list:75) */
+/* VOID:INT,INT,BOXED (./btkmarshalers.list:76) */
 void
 _btk_marshal_VOID__INT_INT_BOXED (GClosure     *closure,
                                   BValue       *return_value B_GNUC_UNUSED,
@@ -1871,7 +1910,7 @@ _btk_marshal_VOID__INT_INT_BOXED (GClosure     *closure,
             data2);
 }
 
-/* VOID:INT,INT,INT (./btkmarshalers.list:76) */
+/* VOID:INT,INT,INT (./btkmarshalers.list:77) */
 void
 _btk_marshal_VOID__INT_INT_INT (GClosure     *closure,
                                 BValue       *return_value B_GNUC_UNUSED,
@@ -1910,7 +1949,44 @@ _btk_marshal_VOID__INT_INT_INT (GClosure     *closure,
             data2);
 }
 
-/* VOID:OBJECT,BOOLEAN (./btkmarshalers.list:78) */
+/* VOID:INT64,INT64 (./btkmarshalers.list:78) */
+void
+_btk_marshal_VOID__INT64_INT64 (GClosure     *closure,
+                                BValue       *return_value B_GNUC_UNUSED,
+                                buint         n_param_values,
+                                const BValue *param_values,
+                                bpointer      invocation_hint B_GNUC_UNUSED,
+                                bpointer      marshal_data)
+{
+  typedef void (*GMarshalFunc_VOID__INT64_INT64) (bpointer data1,
+                                                  bint64   arg1,
+                                                  bint64   arg2,
+                                                  bpointer data2);
+  GCClosure *cc = (GCClosure *) closure;
+  bpointer data1, data2;
+  GMarshalFunc_VOID__INT64_INT64 callback;
+
+  g_return_if_fail (n_param_values == 3);
+
+  if (G_CCLOSURE_SWAP_DATA (closure))
+    {
+      data1 = closure->data;
+      data2 = b_value_peek_pointer (param_values + 0);
+    }
+  else
+    {
+      data1 = b_value_peek_pointer (param_values + 0);
+      data2 = closure->data;
+    }
+  callback = (GMarshalFunc_VOID__INT64_INT64) (marshal_data ? marshal_data : cc->callback);
+
+  callback (data1,
+            g_marshal_value_peek_int64 (param_values + 1),
+            g_marshal_value_peek_int64 (param_values + 2),
+            data2);
+}
+
+/* VOID:OBJECT,BOOLEAN (./btkmarshalers.list:80) */
 void
 _btk_marshal_VOID__OBJECT_BOOLEAN (GClosure     *closure,
                                    BValue       *return_value B_GNUC_UNUSED,
@@ -1947,7 +2023,7 @@ _btk_marshal_VOID__OBJECT_BOOLEAN (GClosure     *closure,
             data2);
 }
 
-/* VOID:OBJECT,BOXED,BOXED (./btkmarshalers.list:79) */
+/* VOID:OBJECT,BOXED,BOXED (./btkmarshalers.list:81) */
 void
 _btk_marshal_VOID__OBJECT_BOXED_BOXED (GClosure     *closure,
                                        BValue       *return_value B_GNUC_UNUSED,
@@ -1986,7 +2062,7 @@ _btk_marshal_VOID__OBJECT_BOXED_BOXED (GClosure     *closure,
             data2);
 }
 
-/* VOID:OBJECT,BOXED,UINT,UINT (./btkmarshalers.list:80) */
+/* VOID:OBJECT,BOXED,UINT,UINT (./btkmarshalers.list:82) */
 void
 _btk_marshal_VOID__OBJECT_BOXED_UINT_UINT (GClosure     *closure,
                                            BValue       *return_value B_GNUC_UNUSED,
@@ -2027,7 +2103,7 @@ _btk_marshal_VOID__OBJECT_BOXED_UINT_UINT (GClosure     *closure,
             data2);
 }
 
-/* VOID:OBJECT,INT (./btkmarshalers.list:81) */
+/* VOID:OBJECT,INT (./btkmarshalers.list:83) */
 void
 _btk_marshal_VOID__OBJECT_INT (GClosure     *closure,
                                BValue       *return_value B_GNUC_UNUSED,
@@ -2064,7 +2140,7 @@ _btk_marshal_VOID__OBJECT_INT (GClosure     *closure,
             data2);
 }
 
-/* VOID:OBJECT,INT,OBJECT (./btkmarshalers.list:82) */
+/* VOID:OBJECT,INT,OBJECT (./btkmarshalers.list:84) */
 void
 _btk_marshal_VOID__OBJECT_INT_OBJECT (GClosure     *closure,
                                       BValue       *return_value B_GNUC_UNUSED,
@@ -2103,7 +2179,7 @@ _btk_marshal_VOID__OBJECT_INT_OBJECT (GClosure     *closure,
             data2);
 }
 
-/* VOID:OBJECT,INT,INT (./btkmarshalers.list:83) */
+/* VOID:OBJECT,INT,INT (./btkmarshalers.list:85) */
 void
 _btk_marshal_VOID__OBJECT_INT_INT (GClosure     *closure,
                                    BValue       *return_value B_GNUC_UNUSED,
@@ -2142,7 +2218,7 @@ _btk_marshal_VOID__OBJECT_INT_INT (GClosure     *closure,
             data2);
 }
 
-/* VOID:OBJECT,INT,INT,BOXED,UINT,UINT (./btkmarshalers.list:84) */
+/* VOID:OBJECT,INT,INT,BOXED,UINT,UINT (./btkmarshalers.list:86) */
 void
 _btk_marshal_VOID__OBJECT_INT_INT_BOXED_UINT_UINT (GClosure     *closure,
                                                    BValue       *return_value B_GNUC_UNUSED,
@@ -2187,7 +2263,7 @@ _btk_marshal_VOID__OBJECT_INT_INT_BOXED_UINT_UINT (GClosure     *closure,
             data2);
 }
 
-/* VOID:OBJECT,OBJECT (./btkmarshalers.list:85) */
+/* VOID:OBJECT,OBJECT (./btkmarshalers.list:87) */
 void
 _btk_marshal_VOID__OBJECT_OBJECT (GClosure     *closure,
                                   BValue       *return_value B_GNUC_UNUSED,
@@ -2224,7 +2300,7 @@ _btk_marshal_VOID__OBJECT_OBJECT (GClosure     *closure,
             data2);
 }
 
-/* VOID:OBJECT,STRING (./btkmarshalers.list:86) */
+/* VOID:OBJECT,STRING (./btkmarshalers.list:88) */
 void
 _btk_marshal_VOID__OBJECT_STRING (GClosure     *closure,
                                   BValue       *return_value B_GNUC_UNUSED,
@@ -2261,7 +2337,7 @@ _btk_marshal_VOID__OBJECT_STRING (GClosure     *closure,
             data2);
 }
 
-/* VOID:OBJECT,STRING,STRING (./btkmarshalers.list:87) */
+/* VOID:OBJECT,STRING,STRING (./btkmarshalers.list:89) */
 void
 _btk_marshal_VOID__OBJECT_STRING_STRING (GClosure     *closure,
                                          BValue       *return_value B_GNUC_UNUSED,
@@ -2300,7 +2376,7 @@ _btk_marshal_VOID__OBJECT_STRING_STRING (GClosure     *closure,
             data2);
 }
 
-/* VOID:OBJECT,UINT (./btkmarshalers.list:88) */
+/* VOID:OBJECT,UINT (./btkmarshalers.list:90) */
 void
 _btk_marshal_VOID__OBJECT_UINT (GClosure     *closure,
                                 BValue       *return_value B_GNUC_UNUSED,
@@ -2337,7 +2413,7 @@ _btk_marshal_VOID__OBJECT_UINT (GClosure     *closure,
             data2);
 }
 
-/* VOID:OBJECT,UINT,FLAGS (./btkmarshalers.list:89) */
+/* VOID:OBJECT,UINT,FLAGS (./btkmarshalers.list:91) */
 void
 _btk_marshal_VOID__OBJECT_UINT_FLAGS (GClosure     *closure,
                                       BValue       *return_value B_GNUC_UNUSED,
@@ -2376,7 +2452,7 @@ _btk_marshal_VOID__OBJECT_UINT_FLAGS (GClosure     *closure,
             data2);
 }
 
-/* VOID:OBJECT,OBJECT,OBJECT (./btkmarshalers.list:91) */
+/* VOID:OBJECT,OBJECT,OBJECT (./btkmarshalers.list:93) */
 void
 _btk_marshal_VOID__OBJECT_OBJECT_OBJECT (GClosure     *closure,
                                          BValue       *return_value B_GNUC_UNUSED,
@@ -2415,7 +2491,7 @@ _btk_marshal_VOID__OBJECT_OBJECT_OBJECT (GClosure     *closure,
             data2);
 }
 
-/* VOID:POINTER,INT (./btkmarshalers.list:93) */
+/* VOID:POINTER,INT (./btkmarshalers.list:95) */
 void
 _btk_marshal_VOID__POINTER_INT (GClosure     *closure,
                                 BValue       *return_value B_GNUC_UNUSED,
@@ -2452,7 +2528,7 @@ _btk_marshal_VOID__POINTER_INT (GClosure     *closure,
             data2);
 }
 
-/* VOID:POINTER,BOOLEAN (./btkmarshalers.list:94) */
+/* VOID:POINTER,BOOLEAN (./btkmarshalers.list:96) */
 void
 _btk_marshal_VOID__POINTER_BOOLEAN (GClosure     *closure,
                                     BValue       *return_value B_GNUC_UNUSED,
@@ -2489,7 +2565,7 @@ _btk_marshal_VOID__POINTER_BOOLEAN (GClosure     *closure,
             data2);
 }
 
-/* VOID:POINTER,POINTER,BOOLEAN (./btkmarshalers.list:95) */
+/* VOID:POINTER,POINTER,BOOLEAN (./btkmarshalers.list:97) */
 void
 _btk_marshal_VOID__POINTER_POINTER_BOOLEAN (GClosure     *closure,
                                             BValue       *return_value B_GNUC_UNUSED,
@@ -2528,7 +2604,7 @@ _btk_marshal_VOID__POINTER_POINTER_BOOLEAN (GClosure     *closure,
             data2);
 }
 
-/* VOID:POINTER,POINTER,POINTER (./btkmarshalers.list:96) */
+/* VOID:POINTER,POINTER,POINTER (./btkmarshalers.list:98) */
 void
 _btk_marshal_VOID__POINTER_POINTER_POINTER (GClosure     *closure,
                                             BValue       *return_value B_GNUC_UNUSED,
@@ -2567,7 +2643,7 @@ _btk_marshal_VOID__POINTER_POINTER_POINTER (GClosure     *closure,
             data2);
 }
 
-/* VOID:POINTER,UINT (./btkmarshalers.list:97) */
+/* VOID:POINTER,UINT (./btkmarshalers.list:99) */
 void
 _btk_marshal_VOID__POINTER_UINT (GClosure     *closure,
                                  BValue       *return_value B_GNUC_UNUSED,
@@ -2604,7 +2680,7 @@ _btk_marshal_VOID__POINTER_UINT (GClosure     *closure,
             data2);
 }
 
-/* VOID:STRING,BOXED (./btkmarshalers.list:99) */
+/* VOID:STRING,BOXED (./btkmarshalers.list:101) */
 void
 _btk_marshal_VOID__STRING_BOXED (GClosure     *closure,
                                  BValue       *return_value B_GNUC_UNUSED,
@@ -2641,7 +2717,7 @@ _btk_marshal_VOID__STRING_BOXED (GClosure     *closure,
             data2);
 }
 
-/* VOID:STRING,STRING (./btkmarshalers.list:100) */
+/* VOID:STRING,STRING (./btkmarshalers.list:102) */
 void
 _btk_marshal_VOID__STRING_STRING (GClosure     *closure,
                                   BValue       *return_value B_GNUC_UNUSED,
@@ -2678,7 +2754,7 @@ _btk_marshal_VOID__STRING_STRING (GClosure     *closure,
             data2);
 }
 
-/* VOID:STRING,STRING,STRING (./btkmarshalers.list:101) */
+/* VOID:STRING,STRING,STRING (./btkmarshalers.list:103) */
 void
 _btk_marshal_VOID__STRING_STRING_STRING (GClosure     *closure,
                                          BValue       *return_value B_GNUC_UNUSED,
@@ -2717,7 +2793,7 @@ _btk_marshal_VOID__STRING_STRING_STRING (GClosure     *closure,
             data2);
 }
 
-/* VOID:STRING,INT,POINTER (./btkmarshalers.list:102) */
+/* VOID:STRING,INT,POINTER (./btkmarshalers.list:104) */
 void
 _btk_marshal_VOID__STRING_INT_POINTER (GClosure     *closure,
                                        BValue       *return_value B_GNUC_UNUSED,
@@ -2756,7 +2832,7 @@ _btk_marshal_VOID__STRING_INT_POINTER (GClosure     *closure,
             data2);
 }
 
-/* VOID:STRING,UINT,FLAGS (./btkmarshalers.list:103) */
+/* VOID:STRING,UINT,FLAGS (./btkmarshalers.list:105) */
 void
 _btk_marshal_VOID__STRING_UINT_FLAGS (GClosure     *closure,
                                       BValue       *return_value B_GNUC_UNUSED,
@@ -2795,7 +2871,7 @@ _btk_marshal_VOID__STRING_UINT_FLAGS (GClosure     *closure,
             data2);
 }
 
-/* VOID:STRING,UINT,FLAGS,UINT (./btkmarshalers.list:104) */
+/* VOID:STRING,UINT,FLAGS,UINT (./btkmarshalers.list:106) */
 void
 _btk_marshal_VOID__STRING_UINT_FLAGS_UINT (GClosure     *closure,
                                            BValue       *return_value B_GNUC_UNUSED,
@@ -2836,7 +2912,7 @@ _btk_marshal_VOID__STRING_UINT_FLAGS_UINT (GClosure     *closure,
             data2);
 }
 
-/* VOID:UINT,FLAGS,BOXED (./btkmarshalers.list:105) */
+/* VOID:UINT,FLAGS,BOXED (./btkmarshalers.list:107) */
 void
 _btk_marshal_VOID__UINT_FLAGS_BOXED (GClosure     *closure,
                                      BValue       *return_value B_GNUC_UNUSED,
@@ -2875,7 +2951,7 @@ _btk_marshal_VOID__UINT_FLAGS_BOXED (GClosure     *closure,
             data2);
 }
 
-/* VOID:UINT,UINT (./btkmarshalers.list:106) */
+/* VOID:UINT,UINT (./btkmarshalers.list:108) */
 void
 _btk_marshal_VOID__UINT_UINT (GClosure     *closure,
                               BValue       *return_value B_GNUC_UNUSED,
@@ -2912,7 +2988,7 @@ _btk_marshal_VOID__UINT_UINT (GClosure     *closure,
             data2);
 }
 
-/* VOID:UINT,STRING (./btkmarshalers.list:107) */
+/* VOID:UINT,STRING (./btkmarshalers.list:109) */
 void
 _btk_marshal_VOID__UINT_STRING (GClosure     *closure,
                                 BValue       *return_value B_GNUC_UNUSED,
@@ -2949,7 +3025,7 @@ _btk_marshal_VOID__UINT_STRING (GClosure     *closure,
             data2);
 }
 
-/* VOID:UINT,BOXED,UINT,FLAGS,FLAGS (./btkmarshalers.list:108) */
+/* VOID:UINT,BOXED,UINT,FLAGS,FLAGS (./btkmarshalers.list:110) */
 void
 _btk_marshal_VOID__UINT_BOXED_UINT_FLAGS_FLAGS (GClosure     *closure,
                                                 BValue       *return_value B_GNUC_UNUSED,
@@ -2992,7 +3068,7 @@ _btk_marshal_VOID__UINT_BOXED_UINT_FLAGS_FLAGS (GClosure     *closure,
             data2);
 }
 
-/* VOID:UINT,OBJECT,UINT,FLAGS,FLAGS (./btkmarshalers.list:109) */
+/* VOID:UINT,OBJECT,UINT,FLAGS,FLAGS (./btkmarshalers.list:111) */
 void
 _btk_marshal_VOID__UINT_OBJECT_UINT_FLAGS_FLAGS (GClosure     *closure,
                                                  BValue       *return_value B_GNUC_UNUSED,
@@ -3035,7 +3111,7 @@ _btk_marshal_VOID__UINT_OBJECT_UINT_FLAGS_FLAGS (GClosure     *closure,
             data2);
 }
 
-/* VOID:UINT,STRING,UINT (./btkmarshalers.list:110) */
+/* VOID:UINT,STRING,UINT (./btkmarshalers.list:112) */
 void
 _btk_marshal_VOID__UINT_STRING_UINT (GClosure     *closure,
                                      BValue       *return_value B_GNUC_UNUSED,
@@ -3074,7 +3150,7 @@ _btk_marshal_VOID__UINT_STRING_UINT (GClosure     *closure,
             data2);
 }
 
-/* OBJECT:OBJECT,INT,INT (./btkmarshalers.list:113) */
+/* OBJECT:OBJECT,INT,INT (./btkmarshalers.list:115) */
 void
 _btk_marshal_OBJECT__OBJECT_INT_INT (GClosure     *closure,
                                      BValue       *return_value,
@@ -3117,7 +3193,7 @@ _btk_marshal_OBJECT__OBJECT_INT_INT (GClosure     *closure,
   b_value_take_object (return_value, v_return);
 }
 
-/* VOID:POINTER,POINTER,POINTER,POINTER,STRING (./btkmarshalers.list:114) */
+/* VOID:POINTER,POINTER,POINTER,POINTER,STRING (./btkmarshalers.list:116) */
 void
 _btk_marshal_VOID__POINTER_POINTER_POINTER_POINTER_STRING (GClosure     *closure,
                                                            BValue       *return_value B_GNUC_UNUSED,
@@ -3159,4 +3235,3 @@ _btk_marshal_VOID__POINTER_POINTER_POINTER_POINTER_STRING (GClosure     *closure
             g_marshal_value_peek_string (param_values + 5),
             data2);
 }
-
@@ -288,7 +288,16 @@ void _btk_marshal_VOID__BOXED_BOXED (GClosure     *closure,
                                      bpointer      invocation_hint,
                                      bpointer      marshal_data);
 
-/* VOID:BOXED,BOXED,POINTER (./btkmarshalers.list:58) */
+/* VOID:BOXED,BOXED,INT (./btkmarshalers.list:58) */
+extern
+void _btk_marshal_VOID__BOXED_BOXED_INT (GClosure     *closure,
+                                         BValue       *return_value,
+                                         buint         n_param_values,
+                                         const BValue *param_values,
+                                         bpointer      invocation_hint,
+                                         bpointer      marshal_data);
+
+/* VOID:BOXED,BOXED,POINTER (./btkmarshalers.list:59) */
 extern
 void _btk_marshal_VOID__BOXED_BOXED_POINTER (GClosure     *closure,
                                              BValue       *return_value,
@@ -297,7 +306,7 @@ void _btk_marshal_VOID__BOXED_BOXED_POINTER (GClosure     *closure,
                                              bpointer      invocation_hint,
                                              bpointer      marshal_data);
 
-/* VOID:BOXED,OBJECT (./btkmarshalers.list:59) */
+/* VOID:BOXED,OBJECT (./btkmarshalers.list:60) */
 extern
 void _btk_marshal_VOID__BOXED_OBJECT (GClosure     *closure,
                                       BValue       *return_value,
@@ -306,7 +315,7 @@ void _btk_marshal_VOID__BOXED_OBJECT (GClosure     *closure,
                                       bpointer      invocation_hint,
                                       bpointer      marshal_data);
 
-/* VOID:BOXED,STRING,INT (./btkmarshalers.list:60) */
+/* VOID:BOXED,STRING,INT (./btkmarshalers.list:61) */
 extern
 void _btk_marshal_VOID__BOXED_STRING_INT (GClosure     *closure,
                                           BValue       *return_value,
@@ -315,7 +324,7 @@ void _btk_marshal_VOID__BOXED_STRING_INT (GClosure     *closure,
                                           bpointer      invocation_hint,
                                           bpointer      marshal_data);
 
-/* VOID:BOXED,UINT (./btkmarshalers.list:61) */
+/* VOID:BOXED,UINT (./btkmarshalers.list:62) */
 extern
 void _btk_marshal_VOID__BOXED_UINT (GClosure     *closure,
                                     BValue       *return_value,
@@ -324,7 +333,7 @@ void _btk_marshal_VOID__BOXED_UINT (GClosure     *closure,
                                     bpointer      invocation_hint,
                                     bpointer      marshal_data);
 
-/* VOID:BOXED,UINT,FLAGS (./btkmarshalers.list:62) */
+/* VOID:BOXED,UINT,FLAGS (./btkmarshalers.list:63) */
 extern
 void _btk_marshal_VOID__BOXED_UINT_FLAGS (GClosure     *closure,
                                           BValue       *return_value,
@@ -333,7 +342,7 @@ void _btk_marshal_VOID__BOXED_UINT_FLAGS (GClosure     *closure,
                                           bpointer      invocation_hint,
                                           bpointer      marshal_data);
 
-/* VOID:BOXED,UINT,UINT (./btkmarshalers.list:63) */
+/* VOID:BOXED,UINT,UINT (./btkmarshalers.list:64) */
 extern
 void _btk_marshal_VOID__BOXED_UINT_UINT (GClosure     *closure,
                                          BValue       *return_value,
@@ -342,10 +351,10 @@ void _btk_marshal_VOID__BOXED_UINT_UINT (GClosure     *closure,
                                          bpointer      invocation_hint,
                                          bpointer      marshal_data);
 
-/* VOID:ENUM (./btkmarshalers.list:64) */
+/* VOID:ENUM (./btkmarshalers.list:65) */
 #define _btk_marshal_VOID__ENUM	g_cclosure_marshal_VOID__ENUM
 
-/* VOID:ENUM,BOOLEAN (./btkmarshalers.list:65) */
+/* VOID:ENUM,BOOLEAN (./btkmarshalers.list:66) */
 extern
 void _btk_marshal_VOID__ENUM_BOOLEAN (GClosure     *closure,
                                       BValue       *return_value,
@@ -354,7 +363,7 @@ void _btk_marshal_VOID__ENUM_BOOLEAN (GClosure     *closure,
                                       bpointer      invocation_hint,
                                       bpointer      marshal_data);
 
-/* VOID:ENUM,ENUM (./btkmarshalers.list:66) */
+/* VOID:ENUM,ENUM (./btkmarshalers.list:67) */
 extern
 void _btk_marshal_VOID__ENUM_ENUM (GClosure     *closure,
                                    BValue       *return_value,
@@ -363,7 +372,7 @@ void _btk_marshal_VOID__ENUM_ENUM (GClosure     *closure,
                                    bpointer      invocation_hint,
                                    bpointer      marshal_data);
 
-/* VOID:ENUM,FLOAT (./btkmarshalers.list:67) */
+/* VOID:ENUM,FLOAT (./btkmarshalers.list:68) */
 extern
 void _btk_marshal_VOID__ENUM_FLOAT (GClosure     *closure,
                                     BValue       *return_value,
@@ -372,7 +381,7 @@ void _btk_marshal_VOID__ENUM_FLOAT (GClosure     *closure,
                                     bpointer      invocation_hint,
                                     bpointer      marshal_data);
 
-/* VOID:ENUM,FLOAT,BOOLEAN (./btkmarshalers.list:68) */
+/* VOID:ENUM,FLOAT,BOOLEAN (./btkmarshalers.list:69) */
 extern
 void _btk_marshal_VOID__ENUM_FLOAT_BOOLEAN (GClosure     *closure,
                                             BValue       *return_value,
@@ -381,7 +390,7 @@ void _btk_marshal_VOID__ENUM_FLOAT_BOOLEAN (GClosure     *closure,
                                             bpointer      invocation_hint,
                                             bpointer      marshal_data);
 
-/* VOID:ENUM,INT (./btkmarshalers.list:69) */
+/* VOID:ENUM,INT (./btkmarshalers.list:70) */
 extern
 void _btk_marshal_VOID__ENUM_INT (GClosure     *closure,
                                   BValue       *return_value,
@@ -390,7 +399,7 @@ void _btk_marshal_VOID__ENUM_INT (GClosure     *closure,
                                   bpointer      invocation_hint,
                                   bpointer      marshal_data);
 
-/* VOID:ENUM,INT,BOOLEAN (./btkmarshalers.list:70) */
+/* VOID:ENUM,INT,BOOLEAN (./btkmarshalers.list:71) */
 extern
 void _btk_marshal_VOID__ENUM_INT_BOOLEAN (GClosure     *closure,
                                           BValue       *return_value,
@@ -399,7 +408,7 @@ void _btk_marshal_VOID__ENUM_INT_BOOLEAN (GClosure     *closure,
                                           bpointer      invocation_hint,
                                           bpointer      marshal_data);
 
-/* VOID:ENUM,BOXED (./btkmarshalers.list:71) */
+/* VOID:ENUM,BOXED (./btkmarshalers.list:72) */
 extern
 void _btk_marshal_VOID__ENUM_BOXED (GClosure     *closure,
                                     BValue       *return_value,
@@ -408,10 +417,10 @@ void _btk_marshal_VOID__ENUM_BOXED (GClosure     *closure,
                                     bpointer      invocation_hint,
                                     bpointer      marshal_data);
 
-/* VOID:INT (./btkmarshalers.list:72) */
+/* VOID:INT (./btkmarshalers.list:73) */
 #define _btk_marshal_VOID__INT	g_cclosure_marshal_VOID__INT
 
-/* VOID:INT,BOOLEAN (./btkmarshalers.list:73) */
+/* VOID:INT,BOOLEAN (./btkmarshalers.list:74) */
 extern
 void _btk_marshal_VOID__INT_BOOLEAN (GClosure     *closure,
                                      BValue       *return_value,
@@ -420,7 +429,7 @@ void _btk_marshal_VOID__INT_BOOLEAN (GClosure     *closure,
                                      bpointer      invocation_hint,
                                      bpointer      marshal_data);
 
-/* VOID:INT,INT (./btkmarshalers.list:74) */
+/* VOID:INT,INT (./btkmarshalers.list:75) */
 extern
 void _btk_marshal_VOID__INT_INT (GClosure     *closure,
                                  BValue       *return_value,
@@ -429,7 +438,7 @@ void _btk_marshal_VOID__INT_INT (GClosure     *closure,
                                  bpointer      invocation_hint,
                                  bpointer      marshal_data);
 
-/* VOID:INT,INT,BOXED (./btkmarshalers.list:75) */
+/* VOID:INT,INT,BOXED (./btkmarshalers.list:76) */
 extern
 void _btk_marshal_VOID__INT_INT_BOXED (GClosure     *closure,
                                        BValue       *return_value,
@@ -438,7 +447,7 @@ void _btk_marshal_VOID__INT_INT_BOXED (GClosure     *closure,
                                        bpointer      invocation_hint,
                                        bpointer      marshal_data);
 
-/* VOID:INT,INT,INT (./btkmarshalers.list:76) */
+/* VOID:INT,INT,INT (./btkmarshalers.list:77) */
 extern
 void _btk_marshal_VOID__INT_INT_INT (GClosure     *closure,
                                      BValue       *return_value,
@@ -447,10 +456,19 @@ void _btk_marshal_VOID__INT_INT_INT (GClosure     *closure,
                                      bpointer      invocation_hint,
                                      bpointer      marshal_data);
 
-/* VOID:OBJECT (./btkmarshalers.list:77) */
+/* VOID:INT64,INT64 (./btkmarshalers.list:78) */
+extern
+void _btk_marshal_VOID__INT64_INT64 (GClosure     *closure,
+                                     BValue       *return_value,
+                                     buint         n_param_values,
+                                     const BValue *param_values,
+                                     bpointer      invocation_hint,
+                                     bpointer      marshal_data);
+
+/* VOID:OBJECT (./btkmarshalers.list:79) */
 #define _btk_marshal_VOID__OBJECT	g_cclosure_marshal_VOID__OBJECT
 
-/* VOID:OBJECT,BOOLEAN (./btkmarshalers.list:78) */
+/* VOID:OBJECT,BOOLEAN (./btkmarshalers.list:80) */
 extern
 void _btk_marshal_VOID__OBJECT_BOOLEAN (GClosure     *closure,
                                         BValue       *return_value,
@@ -459,7 +477,7 @@ void _btk_marshal_VOID__OBJECT_BOOLEAN (GClosure     *closure,
                                         bpointer      invocation_hint,
                                         bpointer      marshal_data);
 
-/* VOID:OBJECT,BOXED,BOXED (./btkmarshalers.list:79) */
+/* VOID:OBJECT,BOXED,BOXED (./btkmarshalers.list:81) */
 extern
 void _btk_marshal_VOID__OBJECT_BOXED_BOXED (GClosure     *closure,
                                             BValue       *return_value,
@@ -468,7 +486,7 @@ void _btk_marshal_VOID__OBJECT_BOXED_BOXED (GClosure     *closure,
                                             bpointer      invocation_hint,
                                             bpointer      marshal_data);
 
-/* VOID:OBJECT,BOXED,UINT,UINT (./btkmarshalers.list:80) */
+/* VOID:OBJECT,BOXED,UINT,UINT (./btkmarshalers.list:82) */
 extern
 void _btk_marshal_VOID__OBJECT_BOXED_UINT_UINT (GClosure     *closure,
                                                 BValue       *return_value,
@@ -477,7 +495,7 @@ void _btk_marshal_VOID__OBJECT_BOXED_UINT_UINT (GClosure     *closure,
                                                 bpointer      invocation_hint,
                                                 bpointer      marshal_data);
 
-/* VOID:OBJECT,INT (./btkmarshalers.list:81) */
+/* VOID:OBJECT,INT (./btkmarshalers.list:83) */
 extern
 void _btk_marshal_VOID__OBJECT_INT (GClosure     *closure,
                                     BValue       *return_value,
@@ -486,7 +504,7 @@ void _btk_marshal_VOID__OBJECT_INT (GClosure     *closure,
                                     bpointer      invocation_hint,
                                     bpointer      marshal_data);
 
-/* VOID:OBJECT,INT,OBJECT (./btkmarshalers.list:82) */
+/* VOID:OBJECT,INT,OBJECT (./btkmarshalers.list:84) */
 extern
 void _btk_marshal_VOID__OBJECT_INT_OBJECT (GClosure     *closure,
                                            BValue       *return_value,
@@ -495,7 +513,7 @@ void _btk_marshal_VOID__OBJECT_INT_OBJECT (GClosure     *closure,
                                            bpointer      invocation_hint,
                                            bpointer      marshal_data);
 
-/* VOID:OBJECT,INT,INT (./btkmarshalers.list:83) */
+/* VOID:OBJECT,INT,INT (./btkmarshalers.list:85) */
 extern
 void _btk_marshal_VOID__OBJECT_INT_INT (GClosure     *closure,
                                         BValue       *return_value,
@@ -504,7 +522,7 @@ void _btk_marshal_VOID__OBJECT_INT_INT (GClosure     *closure,
                                         bpointer      invocation_hint,
                                         bpointer      marshal_data);
 
-/* VOID:OBJECT,INT,INT,BOXED,UINT,UINT (./btkmarshalers.list:84) */
+/* VOID:OBJECT,INT,INT,BOXED,UINT,UINT (./btkmarshalers.list:86) */
 extern
 void _btk_marshal_VOID__OBJECT_INT_INT_BOXED_UINT_UINT (GClosure     *closure,
                                                         BValue       *return_value,
@@ -513,7 +531,7 @@ void _btk_marshal_VOID__OBJECT_INT_INT_BOXED_UINT_UINT (GClosure     *closure,
                                                         bpointer      invocation_hint,
                                                         bpointer      marshal_data);
 
-/* VOID:OBJECT,OBJECT (./btkmarshalers.list:85) */
+/* VOID:OBJECT,OBJECT (./btkmarshalers.list:87) */
 extern
 void _btk_marshal_VOID__OBJECT_OBJECT (GClosure     *closure,
                                        BValue       *return_value,
@@ -522,7 +540,7 @@ void _btk_marshal_VOID__OBJECT_OBJECT (GClosure     *closure,
                                        bpointer      invocation_hint,
                                        bpointer      marshal_data);
 
-/* VOID:OBJECT,STRING (./btkmarshalers.list:86) */
+/* VOID:OBJECT,STRING (./btkmarshalers.list:88) */
 extern
 void _btk_marshal_VOID__OBJECT_STRING (GClosure     *closure,
                                        BValue       *return_value,
@@ -531,7 +549,7 @@ void _btk_marshal_VOID__OBJECT_STRING (GClosure     *closure,
                                        bpointer      invocation_hint,
                                        bpointer      marshal_data);
 
-/* VOID:OBJECT,STRING,STRING (./btkmarshalers.list:87) */
+/* VOID:OBJECT,STRING,STRING (./btkmarshalers.list:89) */
 extern
 void _btk_marshal_VOID__OBJECT_STRING_STRING (GClosure     *closure,
                                               BValue       *return_value,
@@ -540,7 +558,7 @@ void _btk_marshal_VOID__OBJECT_STRING_STRING (GClosure     *closure,
                                               bpointer      invocation_hint,
                                               bpointer      marshal_data);
 
-/* VOID:OBJECT,UINT (./btkmarshalers.list:88) */
+/* VOID:OBJECT,UINT (./btkmarshalers.list:90) */
 extern
 void _btk_marshal_VOID__OBJECT_UINT (GClosure     *closure,
                                      BValue       *return_value,
@@ -549,7 +567,7 @@ void _btk_marshal_VOID__OBJECT_UINT (GClosure     *closure,
                                      bpointer      invocation_hint,
                                      bpointer      marshal_data);
 
-/* VOID:OBJECT,UINT,FLAGS (./btkmarshalers.list:89) */
+/* VOID:OBJECT,UINT,FLAGS (./btkmarshalers.list:91) */
 extern
 void _btk_marshal_VOID__OBJECT_UINT_FLAGS (GClosure     *closure,
                                            BValue       *return_value,
@@ -558,7 +576,7 @@ void _btk_marshal_VOID__OBJECT_UINT_FLAGS (GClosure     *closure,
                                            bpointer      invocation_hint,
                                            bpointer      marshal_data);
 
-/* VOID:OBJECT,OBJECT,OBJECT (./btkmarshalers.list:91) */
+/* VOID:OBJECT,OBJECT,OBJECT (./btkmarshalers.list:93) */
 extern
 void _btk_marshal_VOID__OBJECT_OBJECT_OBJECT (GClosure     *closure,
                                               BValue       *return_value,
@@ -567,10 +585,10 @@ void _btk_marshal_VOID__OBJECT_OBJECT_OBJECT (GClosure     *closure,
                                               bpointer      invocation_hint,
                                               bpointer      marshal_data);
 
-/* VOID:POINTER (./btkmarshalers.list:92) */
+/* VOID:POINTER (./btkmarshalers.list:94) */
 #define _btk_marshal_VOID__POINTER	g_cclosure_marshal_VOID__POINTER
 
-/* VOID:POINTER,INT (./btkmarshalers.list:93) */
+/* VOID:POINTER,INT (./btkmarshalers.list:95) */
 extern
 void _btk_marshal_VOID__POINTER_INT (GClosure     *closure,
                                      BValue       *return_value,
@@ -579,7 +597,7 @@ void _btk_marshal_VOID__POINTER_INT (GClosure     *closure,
                                      bpointer      invocation_hint,
                                      bpointer      marshal_data);
 
-/* VOID:POINTER,BOOLEAN (./btkmarshalers.list:94) */
+/* VOID:POINTER,BOOLEAN (./btkmarshalers.list:96) */
 extern
 void _btk_marshal_VOID__POINTER_BOOLEAN (GClosure     *closure,
                                          BValue       *return_value,
@@ -588,7 +606,7 @@ void _btk_marshal_VOID__POINTER_BOOLEAN (GClosure     *closure,
                                          bpointer      invocation_hint,
                                          bpointer      marshal_data);
 
-/* VOID:POINTER,POINTER,BOOLEAN (./btkmarshalers.list:95) */
+/* VOID:POINTER,POINTER,BOOLEAN (./btkmarshalers.list:97) */
 extern
 void _btk_marshal_VOID__POINTER_POINTER_BOOLEAN (GClosure     *closure,
                                                  BValue       *return_value,
@@ -597,7 +615,7 @@ void _btk_marshal_VOID__POINTER_POINTER_BOOLEAN (GClosure     *closure,
                                                  bpointer      invocation_hint,
                                                  bpointer      marshal_data);
 
-/* VOID:POINTER,POINTER,POINTER (./btkmarshalers.list:96) */
+/* VOID:POINTER,POINTER,POINTER (./btkmarshalers.list:98) */
 extern
 void _btk_marshal_VOID__POINTER_POINTER_POINTER (GClosure     *closure,
                                                  BValue       *return_value,
@@ -606,7 +624,7 @@ void _btk_marshal_VOID__POINTER_POINTER_POINTER (GClosure     *closure,
                                                  bpointer      invocation_hint,
                                                  bpointer      marshal_data);
 
-/* VOID:POINTER,UINT (./btkmarshalers.list:97) */
+/* VOID:POINTER,UINT (./btkmarshalers.list:99) */
 extern
 void _btk_marshal_VOID__POINTER_UINT (GClosure     *closure,
                                       BValue       *return_value,
@@ -615,10 +633,10 @@ void _btk_marshal_VOID__POINTER_UINT (GClosure     *closure,
                                       bpointer      invocation_hint,
                                       bpointer      marshal_data);
 
-/* VOID:STRING (./btkmarshalers.list:98) */
+/* VOID:STRING (./btkmarshalers.list:100) */
 #define _btk_marshal_VOID__STRING	g_cclosure_marshal_VOID__STRING
 
-/* VOID:STRING,BOXED (./btkmarshalers.list:99) */
+/* VOID:STRING,BOXED (./btkmarshalers.list:101) */
 extern
 void _btk_marshal_VOID__STRING_BOXED (GClosure     *closure,
                                       BValue       *return_value,
@@ -627,7 +645,7 @@ void _btk_marshal_VOID__STRING_BOXED (GClosure     *closure,
                                       bpointer      invocation_hint,
                                       bpointer      marshal_data);
 
-/* VOID:STRING,STRING (./btkmarshalers.list:100) */
+/* VOID:STRING,STRING (./btkmarshalers.list:102) */
 extern
 void _btk_marshal_VOID__STRING_STRING (GClosure     *closure,
                                        BValue       *return_value,
@@ -636,7 +654,7 @@ void _btk_marshal_VOID__STRING_STRING (GClosure     *closure,
                                        bpointer      invocation_hint,
                                        bpointer      marshal_data);
 
-/* VOID:STRING,STRING,STRING (./btkmarshalers.list:101) */
+/* VOID:STRING,STRING,STRING (./btkmarshalers.list:103) */
 extern
 void _btk_marshal_VOID__STRING_STRING_STRING (GClosure     *closure,
                                               BValue       *return_value,
@@ -645,7 +663,7 @@ void _btk_marshal_VOID__STRING_STRING_STRING (GClosure     *closure,
                                               bpointer      invocation_hint,
                                               bpointer      marshal_data);
 
-/* VOID:STRING,INT,POINTER (./btkmarshalers.list:102) */
+/* VOID:STRING,INT,POINTER (./btkmarshalers.list:104) */
 extern
 void _btk_marshal_VOID__STRING_INT_POINTER (GClosure     *closure,
                                             BValue       *return_value,
@@ -654,7 +672,7 @@ void _btk_marshal_VOID__STRING_INT_POINTER (GClosure     *closure,
                                             bpointer      invocation_hint,
                                             bpointer      marshal_data);
 
-/* VOID:STRING,UINT,FLAGS (./btkmarshalers.list:103) */
+/* VOID:STRING,UINT,FLAGS (./btkmarshalers.list:105) */
 extern
 void _btk_marshal_VOID__STRING_UINT_FLAGS (GClosure     *closure,
                                            BValue       *return_value,
@@ -663,7 +681,7 @@ void _btk_marshal_VOID__STRING_UINT_FLAGS (GClosure     *closure,
                                            bpointer      invocation_hint,
                                            bpointer      marshal_data);
 
-/* VOID:STRING,UINT,FLAGS,UINT (./btkmarshalers.list:104) */
+/* VOID:STRING,UINT,FLAGS,UINT (./btkmarshalers.list:106) */
 extern
 void _btk_marshal_VOID__STRING_UINT_FLAGS_UINT (GClosure     *closure,
                                                 BValue       *return_value,
@@ -672,7 +690,7 @@ void _btk_marshal_VOID__STRING_UINT_FLAGS_UINT (GClosure     *closure,
                                                 bpointer      invocation_hint,
                                                 bpointer      marshal_data);
 
-/* VOID:UINT,FLAGS,BOXED (./btkmarshalers.list:105) */
+/* VOID:UINT,FLAGS,BOXED (./btkmarshalers.list:107) */
 extern
 void _btk_marshal_VOID__UINT_FLAGS_BOXED (GClosure     *closure,
                                           BValue       *return_value,
@@ -681,7 +699,7 @@ void _btk_marshal_VOID__UINT_FLAGS_BOXED (GClosure     *closure,
                                           bpointer      invocation_hint,
                                           bpointer      marshal_data);
 
-/* VOID:UINT,UINT (./btkmarshalers.list:106) */
+/* VOID:UINT,UINT (./btkmarshalers.list:108) */
 extern
 void _btk_marshal_VOID__UINT_UINT (GClosure     *closure,
                                    BValue       *return_value,
@@ -690,7 +708,7 @@ void _btk_marshal_VOID__UINT_UINT (GClosure     *closure,
                                    bpointer      invocation_hint,
                                    bpointer      marshal_data);
 
-/* VOID:UINT,STRING (./btkmarshalers.list:107) */
+/* VOID:UINT,STRING (./btkmarshalers.list:109) */
 extern
 void _btk_marshal_VOID__UINT_STRING (GClosure     *closure,
                                      BValue       *return_value,
@@ -699,7 +717,7 @@ void _btk_marshal_VOID__UINT_STRING (GClosure     *closure,
                                      bpointer      invocation_hint,
                                      bpointer      marshal_data);
 
-/* VOID:UINT,BOXED,UINT,FLAGS,FLAGS (./btkmarshalers.list:108) */
+/* VOID:UINT,BOXED,UINT,FLAGS,FLAGS (./btkmarshalers.list:110) */
 extern
 void _btk_marshal_VOID__UINT_BOXED_UINT_FLAGS_FLAGS (GClosure     *closure,
                                                      BValue       *return_value,
@@ -708,7 +726,7 @@ void _btk_marshal_VOID__UINT_BOXED_UINT_FLAGS_FLAGS (GClosure     *closure,
                                                      bpointer      invocation_hint,
                                                      bpointer      marshal_data);
 
-/* VOID:UINT,OBJECT,UINT,FLAGS,FLAGS (./btkmarshalers.list:109) */
+/* VOID:UINT,OBJECT,UINT,FLAGS,FLAGS (./btkmarshalers.list:111) */
 extern
 void _btk_marshal_VOID__UINT_OBJECT_UINT_FLAGS_FLAGS (GClosure     *closure,
                                                       BValue       *return_value,
@@ -717,7 +735,7 @@ void _btk_marshal_VOID__UINT_OBJECT_UINT_FLAGS_FLAGS (GClosure     *closure,
                                                       bpointer      invocation_hint,
                                                       bpointer      marshal_data);
 
-/* VOID:UINT,STRING,UINT (./btkmarshalers.list:110) */
+/* VOID:UINT,STRING,UINT (./btkmarshalers.list:112) */
 extern
 void _btk_marshal_VOID__UINT_STRING_UINT (GClosure     *closure,
                                           BValue       *return_value,
@@ -726,10 +744,10 @@ void _btk_marshal_VOID__UINT_STRING_UINT (GClosure     *closure,
                                           bpointer      invocation_hint,
                                           bpointer      marshal_data);
 
-/* VOID:VOID (./btkmarshalers.list:112) */
+/* VOID:VOID (./btkmarshalers.list:114) */
 #define _btk_marshal_VOID__VOID	g_cclosure_marshal_VOID__VOID
 
-/* OBJECT:OBJECT,INT,INT (./btkmarshalers.list:113) */
+/* OBJECT:OBJECT,INT,INT (./btkmarshalers.list:115) */
 extern
 void _btk_marshal_OBJECT__OBJECT_INT_INT (GClosure     *closure,
                                           BValue       *return_value,
@@ -738,7 +756,7 @@ void _btk_marshal_OBJECT__OBJECT_INT_INT (GClosure     *closure,
                                           bpointer      invocation_hint,
                                           bpointer      marshal_data);
 
-/* VOID:POINTER,POINTER,POINTER,POINTER,STRING (./btkmarshalers.list:114) */
+/* VOID:POINTER,POINTER,POINTER,POINTER,STRING (./btkmarshalers.list:116) */
 extern
 void _btk_marshal_VOID__POINTER_POINTER_POINTER_POINTER_STRING (GClosure     *closure,
                                                                 BValue       *return_value,
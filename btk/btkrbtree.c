@@ -40,12 +40,33 @@ static inline void _fixup_parity                  (BtkRBTree  *tree,
 
 
 
+/* Number of nodes in one block allocated by _btk_rbtree_populate();
+ * must fit in BtkRBNode::block_offset.
+ */
+#define NODE_BLOCK_SIZE 1024
+
+typedef struct _BtkRBNodeBlock BtkRBNodeBlock;
+
+struct _BtkRBNodeBlock
+{
+  /* Nodes of the block that have not been freed yet; the block is
+   * freed with the last one.
+   */
+  bint n_live;
+  BtkRBNode nodes[1];
+};
+
+#define NODE_BLOCK(node) \
+  ((BtkRBNodeBlock *) ((bchar *) ((node) - ((node)->block_offset - 1)) - \
+		       G_STRUCT_OFFSET (BtkRBNodeBlock, nodes)))
+
 static BtkRBNode *
 _btk_rbnode_new (BtkRBTree *tree,
 		 bint       height)
 {
   BtkRBNode *node = g_slice_new (BtkRBNode);
 
+  node->block_offset = 0;
   node->left = tree->nil;
   node->right = tree->nil;
   node->parent = tree->nil;
@@ -69,7 +90,16 @@ _btk_rbnode_free (BtkRBNode *node)
       node->count = 56789;
       node->flags = 0;
     }
-  g_slice_free (BtkRBNode, node);
+
+  if (node->block_offset)
+    {
+      BtkRBNodeBlock *block = NODE_BLOCK (node);
+
+      if (--block->n_live == 0)
+	g_free (block);
+    }
+  else
+    g_slice_free (BtkRBNode, node);
 }
 
 static void
@@ -337,6 +367,7 @@ _btk_rbtree_new (void)
   retval->parent_node = NULL;
 
   retval->nil = g_slice_new (BtkRBNode);
+  retval->nil->block_offset = 0;
   retval->nil->left = NULL;
   retval->nil->right = NULL;
   retval->nil->parent = NULL;
@@ -595,6 +626,145 @@ _btk_rbtree_insert_before (BtkRBTree *tree,
   return node;
 }
 
+typedef struct
+{
+  BtkRBNodeBlock *block;
+  bint n_used;
+  bint n_block;
+  bint n_remaining;
+} NodeBlockAllocator;
+
+/* Hands out the nodes of a populated tree from blocks of up to
+ * NODE_BLOCK_SIZE, which saves the per-allocation overhead of
+ * creating them one by one.
+ */
+static BtkRBNode *
+node_block_allocator_new_node (NodeBlockAllocator *allocator,
+			       BtkRBTree          *tree,
+			       bint                height)
+{
+  BtkRBNode *node;
+
+  if (allocator->block == NULL || allocator->n_used == allocator->n_block)
+    {
+      allocator->n_block = MIN (allocator->n_remaining, NODE_BLOCK_SIZE);
+      allocator->n_remaining -= allocator->n_block;
+      allocator->n_used = 0;
+      allocator->block = g_malloc (G_STRUCT_OFFSET (BtkRBNodeBlock, nodes) +
+				   allocator->n_block * sizeof (BtkRBNode));
+      allocator->block->n_live = allocator->n_block;
+    }
+
+  node = &allocator->block->nodes[allocator->n_used++];
+  node->block_offset = allocator->n_used;
+  node->left = tree->nil;
+  node->right = tree->nil;
+  node->parent = tree->nil;
+  node->flags = BTK_RBNODE_RED;
+  node->parity = 1;
+  node->count = 1;
+  node->children = NULL;
+  node->offset = height;
+
+  return node;
+}
+
+static BtkRBNode *
+_btk_rbtree_populate_helper (BtkRBTree          *tree,
+			     NodeBlockAllocator *allocator,
+			     BtkRBNode          *parent,
+			     bint                n_nodes,
+			     bint                depth,
+			     bint                red_depth,
+			     bint                height,
+			     buint               flags)
+{
+  BtkRBNode *node;
+  bint n_left;
+
+  if (n_nodes == 0)
+    return tree->nil;
+
+  /* Split the range in half so that sibling subtrees never differ by
+   * more than one node; all leaves then end up on the last two levels.
+   */
+  n_left = n_nodes / 2;
+
+  node = node_block_allocator_new_node (allocator, tree, height);
+  node->parent = parent;
+  node->flags = flags | (depth == red_depth ? BTK_RBNODE_RED : BTK_RBNODE_BLACK);
+  node->left = _btk_rbtree_populate_helper (tree, allocator, node, n_left,
+					    depth + 1, red_depth,
+					    height, flags);
+  node->right = _btk_rbtree_populate_helper (tree, allocator, node,
+					     n_nodes - n_left - 1,
+					     depth + 1, red_depth,
+					     height, flags);
+  node->count = n_nodes;
+  node->parity = n_nodes & 1;
+  node->offset = n_nodes * height;
+
+  return node;
+}
+
+/* Fills an empty tree with @n_nodes nodes of @height in one go.  The
+ * tree is built balanced from the start, so unlike a sequence of
+ * _btk_rbtree_insert_after() calls this is O(n) and does no rotations,
+ * and the nodes are allocated in blocks rather than one at a time.
+ * The nodes at the deepest level are colored red, which keeps the
+ * black height equal on every path.
+ */
+void
+_btk_rbtree_populate (BtkRBTree *tree,
+		      bint       n_nodes,
+		      bint       height,
+		      bboolean   valid)
+{
+  NodeBlockAllocator allocator;
+  BtkRBNode *tmp_node;
+  BtkRBTree *tmp_tree;
+  bint red_depth;
+  buint flags;
+
+  g_return_if_fail (tree->root == tree->nil);
+
+  if (n_nodes <= 0)
+    return;
+
+  /* The deepest level of a tree built by halving is floor(log2 (n)) */
+  red_depth = g_bit_storage (n_nodes) - 1;
+  if (red_depth == 0)
+    red_depth = -1;
+
+  flags = valid ? 0 : (BTK_RBNODE_INVALID | BTK_RBNODE_DESCENDANTS_INVALID);
+
+  allocator.block = NULL;
+  allocator.n_remaining = n_nodes;
+  tree->root = _btk_rbtree_populate_helper (tree, &allocator, tree->nil, n_nodes,
+					    0, red_depth, height, flags);
+
+  tmp_node = tree->parent_node;
+  tmp_tree = tree->parent_tree;
+  while (tmp_tree && tmp_node && tmp_node != tmp_tree->nil)
+    {
+      tmp_node->parity += n_nodes;
+      tmp_node->offset += n_nodes * height;
+      if (!valid)
+	BTK_RBNODE_SET_FLAG (tmp_node, BTK_RBNODE_DESCENDANTS_INVALID);
+      tmp_node = tmp_node->parent;
+      if (tmp_node == tmp_tree->nil)
+	{
+	  tmp_node = tmp_tree->parent_node;
+	  tmp_tree = tmp_tree->parent_tree;
+	}
+    }
+
+#ifdef G_ENABLE_DEBUG  
+  if (btk_debug_flags & BTK_DEBUG_TREE)
+    _btk_rbtree_test (B_STRLOC, tree);
+#endif
+}
+
 BtkRBNode *
 _btk_rbtree_find_count (BtkRBTree *tree,
 			bint       count)
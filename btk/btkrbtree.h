@@ -81,6 +81,12 @@ struct _BtkRBNode
    */
 
   buint parity : 1;
+
+  /* Nodes created by _btk_rbtree_populate() are allocated in blocks;
+   * this is the index of the node in its block plus 1, or 0 for nodes
+   * allocated one at a time.  It fits in the padding after the flags.
+   */
+  buint block_offset : 16;
   
   BtkRBNode *left;
   BtkRBNode *right;
@@ -123,6 +129,10 @@ BtkRBNode *_btk_rbtree_insert_after     (BtkRBTree              *tree,
 					 BtkRBNode              *node,
 					 bint                    height,
 					 bboolean                valid);
+void       _btk_rbtree_populate         (BtkRBTree              *tree,
+					 bint                    n_nodes,
+					 bint                    height,
+					 bboolean                valid);
 void       _btk_rbtree_remove_node      (BtkRBTree              *tree,
 					 BtkRBNode              *node);
 void       _btk_rbtree_reorder          (BtkRBTree              *tree,
@@ -71,24 +71,6 @@
  */
 
 
-/*
- * The structure below is used to pass information between
- * _btk_text_btree_get_tags and inc_count:
- */
-
-typedef struct TagInfo {
-  int numTags;                  /* Number of tags for which there
-                                 * is currently information in
-                                 * tags and counts. */
-  int arraySize;                        /* Number of entries allocated for
-                                         * tags and counts. */
-  BtkTextTag **tags;           /* Array of tags seen so far.
-                                * Malloc-ed. */
-  int *counts;                  /* Toggle count (so far) for each
-                                 * entry in tags.  Malloc-ed. */
-} TagInfo;
-
-
 /*
  * This is used to store per-view width/height info at the tree nodes.
  */
@@ -140,6 +122,16 @@ struct _BtkTextBTreeNode {
   Summary *summary;             /* First in malloc-ed list of info
                                  * about tags in this subtree (NULL if
                                  * no tag info in the subtree). */
+  buint32 *tag_bits;            /* Two bitsets of n_tag_words words
+                                 * over BtkTextTagInfo::index, built
+                                 * from summary: the tags that have a
+                                 * summary here, then the tags whose
+                                 * toggle_count is odd. */
+  int n_tag_words;
+  bboolean tag_bits_valid;      /* FALSE if summary changed since
+                                 * tag_bits was computed. */
+  int num_toggles;              /* Number of toggles of any tag in
+                                 * the subtree rooted here. */
   int level;                            /* Level of this node in the B-tree.
                                          * 0 refers to the bottom of the tree
                                          * (children are lines, not nodes). */
@@ -183,6 +175,9 @@ struct _BtkTextBTree {
   BtkTextBuffer *buffer;
   BTreeView *views;
   GSList *tag_infos;
+  GHashTable *tag_info_table;   /* BtkTextTagInfo by tag */
+  GPtrArray *tag_slots;         /* BtkTextTagInfo by index, NULL
+                                 * for unused indices */
   bulong tag_changed_handler;
 
   /* Incremented when a segment with a byte size > 0
@@ -213,6 +208,26 @@ struct _BtkTextBTree {
   buint end_iter_segment_stamp;
   
   GHashTable *child_anchor_table;
+
+  /* While tag redisplay is frozen, the ranges of characters whose
+   * tags changed are collected here and redisplayed when it is thawed.
+   */
+  bint tag_redisplay_freeze;
+  GArray *tag_redisplay;        /* TagRedisplay */
+
+  /* Text inserted into the buffer is appended to this chunk; see
+   * btktextsegment.c
+   */
+  BtkTextChunk *append_chunk;
+};
+
+typedef struct _TagRedisplay TagRedisplay;
+
+struct _TagRedisplay
+{
+  bint start;                   /* character offsets */
+  bint end;
+  bboolean size;                /* relayout, not just redraw */
 };
 
 
@@ -243,6 +258,11 @@ struct _BtkTextBTree {
 #define MIN_CHILDREN 3
 #endif
 
+/* Size of the nodes a large insertion is cut into; halfway between
+ * the limits, so that later insertions do not split them right away.
+ */
+#define FILL_CHILDREN ((MIN_CHILDREN + MAX_CHILDREN) / 2)
+
 /*
  * Prototypes
  */
@@ -260,7 +280,7 @@ static void              btk_text_btree_node_adjust_toggle_count (BtkTextBTreeNo
                                                                   BtkTextTagInfo   *info,
                                                                   bint              adjust);
 static bboolean          btk_text_btree_node_has_tag             (BtkTextBTreeNode *node,
-                                                                  BtkTextTag       *tag);
+                                                                  BtkTextTagInfo   *info);
 
 static void             segments_changed                (BtkTextBTree     *tree);
 static void             chars_changed                   (BtkTextBTree     *tree);
@@ -320,9 +340,6 @@ static void tag_changed_cb        (BtkTextTagTable  *table,
 static void cleanup_line          (BtkTextLine      *line);
 static void recompute_node_counts (BtkTextBTree     *tree,
                                    BtkTextBTreeNode *node);
-static void inc_count             (BtkTextTag       *tag,
-                                   int               inc,
-                                   TagInfo          *tagInfoPtr);
 
 static void summary_destroy       (Summary          *summary);
 
@@ -359,6 +376,102 @@ chars_changed (BtkTextBTree *tree)
   tree->chars_changed_stamp += 1;
 }
 
+/*
+ * Tag bitsets
+ *
+ * Next to its summary list every node keeps a bitset of the tags that
+ * have a summary there, and one of the tags whose summary has an odd
+ * toggle count, indexed by BtkTextTagInfo::index.  They are rebuilt
+ * from the summary list the first time they are needed after it
+ * changed, and let tag lookups combine a node in a few word
+ * operations instead of walking one summary per tag.
+ */
+
+#define TAG_BITS_WORD(index)     ((index) / 32)
+#define TAG_BITS_MASK(index)     (1u << ((index) % 32))
+#define TAG_BITS_TOGGLE(bits, index) \
+  ((bits)[TAG_BITS_WORD (index)] ^= TAG_BITS_MASK (index))
+
+/* Enough for 256 tags without allocating in _btk_text_btree_get_tags */
+#define NUM_STACK_TAG_WORDS 8
+
+static inline int
+bits_count (buint32 word)
+{
+  int n = 0;
+
+  while (word != 0)
+    {
+      word &= word - 1;
+      n++;
+    }
+
+  return n;
+}
+
+static inline void
+btk_text_btree_node_tags_changed (BtkTextBTreeNode *node)
+{
+  node->tag_bits_valid = FALSE;
+}
+
+static void
+btk_text_btree_node_update_tag_bits (BtkTextBTreeNode *node)
+{
+  Summary *summary;
+  int max_index, n_words;
+
+  max_index = -1;
+  for (summary = node->summary; summary != NULL; summary = summary->next)
+    max_index = MAX (max_index, summary->info->index);
+
+  n_words = max_index < 0 ? 0 : TAG_BITS_WORD (max_index) + 1;
+  if (n_words != node->n_tag_words)
+    {
+      g_free (node->tag_bits);
+      node->tag_bits = n_words > 0 ? g_new (buint32, 2 * n_words) : NULL;
+      node->n_tag_words = n_words;
+    }
+
+  if (n_words > 0)
+    memset (node->tag_bits, 0, 2 * n_words * sizeof (buint32));
+
+  for (summary = node->summary; summary != NULL; summary = summary->next)
+    {
+      int index = summary->info->index;
+
+      node->tag_bits[TAG_BITS_WORD (index)] |= TAG_BITS_MASK (index);
+      if (summary->toggle_count & 1)
+        node->tag_bits[n_words + TAG_BITS_WORD (index)] |= TAG_BITS_MASK (index);
+    }
+
+  node->tag_bits_valid = TRUE;
+}
+
+/* Returns node->n_tag_words words with a bit set for each tag
+ * that toggles an odd number of times below node.
+ */
+static inline const buint32 *
+btk_text_btree_node_get_odd_tags (BtkTextBTreeNode *node)
+{
+  if (!node->tag_bits_valid)
+    btk_text_btree_node_update_tag_bits (node);
+
+  return node->tag_bits + node->n_tag_words;
+}
+
+static inline bboolean
+btk_text_btree_node_tag_is_odd (BtkTextBTreeNode *node,
+                                BtkTextTagInfo   *info)
+{
+  if (!node->tag_bits_valid)
+    btk_text_btree_node_update_tag_bits (node);
+
+  return TAG_BITS_WORD (info->index) < node->n_tag_words &&
+    (node->tag_bits[node->n_tag_words + TAG_BITS_WORD (info->index)] &
+     TAG_BITS_MASK (info->index)) != 0;
+}
+
 /*
  * BTree operations
  */
@@ -400,17 +513,17 @@ _btk_text_btree_new (BtkTextTagTable *table,
   line->parent = root_node;
   line->next = line2;
 
-  line->segments = _btk_char_segment_new ("\n", 1);
-
   line2->parent = root_node;
   line2->next = NULL;
-  line2->segments = _btk_char_segment_new ("\n", 1);
 
   /* Create the tree itself */
 
   tree = g_new0(BtkTextBTree, 1);
   tree->root_node = root_node;
   tree->table = table;
+
+  line->segments = _btk_char_segment_new (&tree->append_chunk, "\n", 1);
+  line2->segments = _btk_char_segment_new (&tree->append_chunk, "\n", 1);
   tree->views = NULL;
 
   /* Set these to values that are unlikely to be found
@@ -438,6 +551,8 @@ _btk_text_btree_new (BtkTextTagTable *table,
 
   tree->mark_table = g_hash_table_new (g_str_hash, g_str_equal);
   tree->child_anchor_table = NULL;
+  tree->tag_info_table = g_hash_table_new (NULL, NULL);
+  tree->tag_slots = g_ptr_array_new ();
   
   /* We don't ref the buffer, since the buffer owns us;
    * we'd have some circularity issues. The buffer always
@@ -511,6 +626,9 @@ _btk_text_btree_unref (BtkTextBTree *tree)
       
       btk_text_btree_node_destroy (tree, tree->root_node);
       tree->root_node = NULL;
+
+      if (tree->append_chunk != NULL)
+        _btk_text_chunk_unref (tree->append_chunk);
       
       g_assert (g_hash_table_size (tree->mark_table) == 0);
       g_hash_table_destroy (tree->mark_table);
@@ -521,6 +639,14 @@ _btk_text_btree_unref (BtkTextBTree *tree)
 	  tree->child_anchor_table = NULL;
 	}
 
+      g_hash_table_destroy (tree->tag_info_table);
+      tree->tag_info_table = NULL;
+      g_ptr_array_free (tree->tag_slots, TRUE);
+      tree->tag_slots = NULL;
+
+      if (tree->tag_redisplay != NULL)
+        g_array_free (tree->tag_redisplay, TRUE);
+
       g_object_unref (tree->insert_mark);
       tree->insert_mark = NULL;
       g_object_unref (tree->selection_bound_mark);
@@ -596,7 +722,7 @@ btk_text_btree_resolve_bidi (BtkTextIter *start,
             {
 	      BangoDirection bango_dir;
 
-              bango_dir = bango_find_base_dir (seg->body.chars,
+              bango_dir = bango_find_base_dir (seg->body.text.chars,
 					       seg->byte_count);
 	      
               if (bango_dir != BANGO_DIRECTION_NEUTRAL)
@@ -1116,6 +1242,8 @@ _btk_text_btree_insert (BtkTextIter *iter,
   BtkTextBTree *tree;
   bint start_byte_index;
   BtkTextLine *start_line;
+  BtkTextChunk *chunk;                 /* Holds our copy of text */
+  bchar *chars;
 
   g_return_if_fail (text != NULL);
   g_return_if_fail (iter != NULL);
@@ -1145,9 +1273,12 @@ _btk_text_btree_insert (BtkTextIter *iter,
   /*
    * Chop the text up into lines and create a new segment for
    * each line, plus a new line for the leftovers from the
-   * previous line.
+   * previous line.  The text is copied only once, and the
+   * segments refer to their part of the copy.
    */
 
+  chunk = _btk_text_chunk_add (&tree->append_chunk, text, len, &chars);
+
   eol = 0;
   sol = 0;
   line_count_delta = 0;
@@ -1174,7 +1305,7 @@ _btk_text_btree_insert (BtkTextIter *iter,
       chunk_len = eol - sol;
 
       g_assert (g_utf8_validate (&text[sol], chunk_len, NULL));
-      seg = _btk_char_segment_new (&text[sol], chunk_len);
+      seg = _btk_char_segment_new_from_chunk (chunk, chars + sol, chunk_len);
 
       char_count_delta += seg->char_count;
 
@@ -1212,6 +1343,8 @@ _btk_text_btree_insert (BtkTextIter *iter,
       line_count_delta++;
     }
 
+  _btk_text_chunk_unref (chunk);
+
   /*
    * Cleanup the starting line for the insertion, plus the ending
    * line if it's different.
@@ -1743,6 +1876,40 @@ queue_tag_redisplay (BtkTextBTree      *tree,
                      const BtkTextIter *start,
                      const BtkTextIter *end)
 {
+  if (tree->tag_redisplay_freeze > 0)
+    {
+      TagRedisplay range;
+
+      range.size = _btk_text_tag_affects_size (tag);
+      if (!range.size && !_btk_text_tag_affects_nonsize_appearance (tag))
+        return;
+
+      range.start = btk_text_iter_get_offset (start);
+      range.end = btk_text_iter_get_offset (end);
+
+      if (tree->tag_redisplay == NULL)
+        tree->tag_redisplay = g_array_new (FALSE, FALSE, sizeof (TagRedisplay));
+
+      /* Ranges tagged one after another usually touch */
+      if (tree->tag_redisplay->len > 0)
+        {
+          TagRedisplay *last = &g_array_index (tree->tag_redisplay, TagRedisplay,
+                                               tree->tag_redisplay->len - 1);
+
+          if (range.start <= last->end && range.end >= last->start &&
+              range.size == last->size)
+            {
+              last->start = MIN (last->start, range.start);
+              last->end = MAX (last->end, range.end);
+              return;
+            }
+        }
+
+      g_array_append_val (tree->tag_redisplay, range);
+
+      return;
+    }
+
   if (_btk_text_tag_affects_size (tag))
     {
       DV (g_print ("invalidating due to size-affecting tag (%s)\n", B_STRLOC));
@@ -1757,6 +1924,74 @@ queue_tag_redisplay (BtkTextBTree      *tree,
   /* We don't need to do anything if the tag doesn't affect display */
 }
 
+static bint
+tag_redisplay_compare (gconstpointer a,
+                       gconstpointer b)
+{
+  const TagRedisplay *ra = a;
+  const TagRedisplay *rb = b;
+
+  return ra->start < rb->start ? -1 : ra->start > rb->start;
+}
+
+/* Collects the redisplay for all the tag changes until the matching
+ * _btk_text_btree_thaw_tag_redisplay(), which redisplays each of the
+ * changed ranges once, with overlapping ones merged; lines between
+ * them are left alone.
+ */
+void
+_btk_text_btree_freeze_tag_redisplay (BtkTextBTree *tree)
+{
+  tree->tag_redisplay_freeze++;
+}
+
+void
+_btk_text_btree_thaw_tag_redisplay (BtkTextBTree *tree)
+{
+  GArray *ranges;
+  buint i, j;
+
+  g_return_if_fail (tree->tag_redisplay_freeze > 0);
+
+  tree->tag_redisplay_freeze--;
+
+  if (tree->tag_redisplay_freeze > 0 ||
+      tree->tag_redisplay == NULL)
+    return;
+
+  ranges = tree->tag_redisplay;
+  tree->tag_redisplay = NULL;
+
+  g_array_sort (ranges, tag_redisplay_compare);
+
+  for (i = 0; i < ranges->len; i = j)
+    {
+      TagRedisplay range = g_array_index (ranges, TagRedisplay, i);
+      BtkTextIter start, end;
+
+      for (j = i + 1; j < ranges->len; j++)
+        {
+          TagRedisplay *next = &g_array_index (ranges, TagRedisplay, j);
+
+          if (next->start > range.end)
+            break;
+
+          range.end = MAX (range.end, next->end);
+          range.size |= next->size;
+        }
+
+      _btk_text_btree_get_iter_at_char (tree, &start, range.start);
+      _btk_text_btree_get_iter_at_char (tree, &end, range.end);
+
+      if (range.size)
+        _btk_text_btree_invalidate_rebunnyion (tree, &start, &end, FALSE);
+      else
+        redisplay_rebunnyion (tree, &start, &end, FALSE);
+    }
+
+  g_array_free (ranges, TRUE);
+}
+
 void
 _btk_text_btree_tag (const BtkTextIter *start_orig,
                      const BtkTextIter *end_orig,
@@ -2204,23 +2439,35 @@ BtkTextTag**
 _btk_text_btree_get_tags (const BtkTextIter *iter,
                          bint *num_tags)
 {
+  BtkTextBTree *tree;
   BtkTextBTreeNode *node;
   BtkTextLine *siblingline;
   BtkTextLineSegment *seg;
-  int src, dst, index;
-  TagInfo tagInfo;
+  BtkTextTag **tags;
   BtkTextLine *line;
   bint byte_index;
+  int index, n_words, n, i;
+  buint32 stack_bits[NUM_STACK_TAG_WORDS];
+  buint32 *bits;
 
-#define NUM_TAG_INFOS 10
-
+  tree = _btk_text_iter_get_btree (iter);
   line = _btk_text_iter_get_text_line (iter);
   byte_index = btk_text_iter_get_line_index (iter);
 
-  tagInfo.numTags = 0;
-  tagInfo.arraySize = NUM_TAG_INFOS;
-  tagInfo.tags = g_new (BtkTextTag*, NUM_TAG_INFOS);
-  tagInfo.counts = g_new (int, NUM_TAG_INFOS);
+  /*
+   * Only the parity of the toggle count of each tag matters, so
+   * collect it in a bitset over the tag indices; a tag is on at
+   * the iter if its bit ends up set.
+   */
+
+  n_words = TAG_BITS_WORD (tree->tag_slots->len) + 1;
+  if (n_words <= NUM_STACK_TAG_WORDS)
+    {
+      bits = stack_bits;
+      memset (bits, 0, n_words * sizeof (buint32));
+    }
+  else
+    bits = g_new0 (buint32, n_words);
 
   /*
    * Record tag toggles within the line of indexPtr but preceding
@@ -2235,7 +2482,7 @@ _btk_text_btree_get_tags (const BtkTextIter *iter,
       if ((seg->type == &btk_text_toggle_on_type)
           || (seg->type == &btk_text_toggle_off_type))
         {
-          inc_count (seg->body.toggle.info->tag, 1, &tagInfo);
+          TAG_BITS_TOGGLE (bits, seg->body.toggle.info->index);
         }
     }
 
@@ -2254,7 +2501,7 @@ _btk_text_btree_get_tags (const BtkTextIter *iter,
           if ((seg->type == &btk_text_toggle_on_type)
               || (seg->type == &btk_text_toggle_off_type))
             {
-              inc_count (seg->body.toggle.info->tag, 1, &tagInfo);
+              TAG_BITS_TOGGLE (bits, seg->body.toggle.info->index);
             }
         }
     }
@@ -2268,51 +2515,64 @@ _btk_text_btree_get_tags (const BtkTextIter *iter,
        node = node->parent)
     {
       BtkTextBTreeNode *siblingPtr;
-      Summary *summary;
 
       for (siblingPtr = node->parent->children.node;
            siblingPtr != node; siblingPtr = siblingPtr->next)
         {
-          for (summary = siblingPtr->summary; summary != NULL;
-               summary = summary->next)
-            {
-              if (summary->toggle_count & 1)
-                {
-                  inc_count (summary->info->tag, summary->toggle_count,
-                             &tagInfo);
-                }
-            }
+          const buint32 *odd;
+
+          if (siblingPtr->summary == NULL)
+            continue;
+
+          odd = btk_text_btree_node_get_odd_tags (siblingPtr);
+          for (i = 0; i < siblingPtr->n_tag_words; i++)
+            bits[i] ^= odd[i];
         }
     }
 
   /*
-   * Go through the tag information and squash out all of the tags
-   * that have even toggle counts (these tags exist before the point
-   * of interest, but not at the desired character itself).
+   * Whatever is left set are the tags with odd toggle counts, i.e.
+   * the tags that are on at the desired character itself.
    */
 
-  for (src = 0, dst = 0; src < tagInfo.numTags; src++)
+  n = 0;
+  for (i = 0; i < n_words; i++)
+    n += bits_count (bits[i]);
+
+  *num_tags = n;
+  if (n == 0)
     {
-      if (tagInfo.counts[src] & 1)
-        {
-          g_assert (BTK_IS_TEXT_TAG (tagInfo.tags[src]));
-          tagInfo.tags[dst] = tagInfo.tags[src];
-          dst++;
-        }
+      if (bits != stack_bits)
+        g_free (bits);
+      return NULL;
     }
 
-  *num_tags = dst;
-  g_free (tagInfo.counts);
-  if (dst == 0)
+  tags = g_new (BtkTextTag*, n);
+  n = 0;
+  for (i = 0; i < n_words; i++)
     {
-      g_free (tagInfo.tags);
-      return NULL;
+      buint32 word = bits[i];
+
+      while (word != 0)
+        {
+          BtkTextTagInfo *info;
+
+          index = i * 32 + g_bit_nth_lsf (word, -1);
+          word &= word - 1;
+
+          info = g_ptr_array_index (tree->tag_slots, index);
+          g_assert (info != NULL && BTK_IS_TEXT_TAG (info->tag));
+          tags[n++] = info->tag;
+        }
     }
 
+  if (bits != stack_bits)
+    g_free (bits);
+
   /* Sort tags in ascending order of priority */
-  _btk_text_tag_array_sort (tagInfo.tags, dst);
+  _btk_text_tag_array_sort (tags, n);
 
-  return tagInfo.tags;
+  return tags;
 }
 
 static void
@@ -2366,7 +2626,7 @@ copy_segment (GString *string,
           g_assert ((copy_start + copy_bytes) <= seg->byte_count);
 
           g_string_append_len (string,
-                               seg->body.chars + copy_start,
+                               seg->body.text.chars + copy_start,
                                copy_bytes);
         }
 
@@ -3067,7 +3327,7 @@ _btk_text_btree_first_could_contain_tag (BtkTextBTree *tree,
           node = node->children.node;
           while (node != NULL)
             {
-              if (btk_text_btree_node_has_tag (node, tag))
+              if (btk_text_btree_node_has_tag (node, info))
                 goto continue_outer_loop;
 
               node = node->next;
@@ -3121,7 +3381,7 @@ _btk_text_btree_last_could_contain_tag (BtkTextBTree *tree,
           node = node->children.node;
           while (node != NULL)
             {
-              if (btk_text_btree_node_has_tag (node, tag))
+              if (btk_text_btree_node_has_tag (node, info))
                 last_node = node;
               node = node->next;
             }
@@ -3312,16 +3572,8 @@ find_toggle_outside_current_line (BtkTextLine *line,
       sibling_node = node->parent->children.node;
       while (sibling_node != node)
         {
-          Summary *summary;
-
-          summary = sibling_node->summary;
-          while (summary != NULL)
-            {
-              if (summary->info == info)
-                toggles += summary->toggle_count;
-
-              summary = summary->next;
-            }
+          if (btk_text_btree_node_tag_is_odd (sibling_node, info))
+            toggles++;
 
           sibling_node = sibling_node->next;
         }
@@ -3441,7 +3693,7 @@ ensure_end_iter_segment (BtkTextBTree *tree)
       tree->end_iter_segment_stamp = tree->segments_changed_stamp;
 
       g_assert (tree->end_iter_segment->type == &btk_text_char_type);
-      g_assert (tree->end_iter_segment->body.chars[tree->end_iter_segment_byte_index] == '\n');
+      g_assert (tree->end_iter_segment->body.text.chars[tree->end_iter_segment_byte_index] == '\n');
     }
 }
 
@@ -3947,7 +4199,7 @@ _btk_text_line_byte_to_char (BtkTextLine *line,
   else
     {
       if (seg->type == &btk_text_char_type)
-        return char_offset + g_utf8_strlen (seg->body.chars, byte_offset);
+        return char_offset + g_utf8_strlen (seg->body.text.chars, byte_offset);
       else
         {
           g_assert (seg->char_count == 1);
@@ -4154,7 +4406,7 @@ _btk_text_line_byte_to_char_offsets (BtkTextLine *line,
 
   if (seg->type == &btk_text_char_type)
     {
-      *seg_char_offset = g_utf8_strlen (seg->body.chars, offset);
+      *seg_char_offset = g_utf8_strlen (seg->body.text.chars, offset);
 
       g_assert (*seg_char_offset < seg->char_count);
 
@@ -4203,12 +4455,12 @@ _btk_text_line_char_to_byte_offsets (BtkTextLine *line,
 
       /* if in the last fourth of the segment walk backwards */
       if (seg->char_count - offset < seg->char_count / 4)
-        p = g_utf8_offset_to_pointer (seg->body.chars + seg->byte_count, 
+        p = g_utf8_offset_to_pointer (seg->body.text.chars + seg->byte_count, 
                                       offset - seg->char_count);
       else
-        p = g_utf8_offset_to_pointer (seg->body.chars, offset);
+        p = g_utf8_offset_to_pointer (seg->body.text.chars, offset);
 
-      *seg_byte_offset = p - seg->body.chars;
+      *seg_byte_offset = p - seg->body.text.chars;
 
       g_assert (*seg_byte_offset < seg->byte_count);
 
@@ -4333,10 +4585,37 @@ _btk_text_line_next_could_contain_tag (BtkTextLine  *line,
 
   if (tag == NULL)
     {
-      /* Right now we can only offer linear-search if the user wants
-       * to know about any tag toggle at all.
+      /* For any tag at all we only know the total toggle counts,
+       * which still lets us skip the nodes without toggles.
        */
-      return _btk_text_line_next_excluding_last (line);
+      if (line->next)
+        return _btk_text_line_next_excluding_last (line);
+
+      node = line->parent;
+      while (node != NULL)
+        {
+          if (node->next == NULL)
+            node = node->parent;
+          else
+            {
+              node = node->next;
+
+              if (node->num_toggles > 0)
+                break;
+            }
+        }
+
+      if (node == NULL)
+        return NULL;
+
+      while (node->level > 0)
+        {
+          node = node->children.node;
+          while (node->num_toggles == 0)
+            node = node->next;
+        }
+
+      return node->children.line;
     }
 
   /* Our tag summaries only have node precision, not line
@@ -4393,7 +4672,7 @@ _btk_text_line_next_could_contain_tag (BtkTextLine  *line,
             {
               node = node->next;
 
-              if (btk_text_btree_node_has_tag (node, tag))
+              if (btk_text_btree_node_has_tag (node, info))
                 goto found;
             }
         }
@@ -4439,7 +4718,7 @@ _btk_text_line_next_could_contain_tag (BtkTextLine  *line,
       node = node->children.node;
       while (node != NULL)
         {
-          if (btk_text_btree_node_has_tag (node, tag))
+          if (btk_text_btree_node_has_tag (node, info))
             break;
           node = node->next;
         }
@@ -4496,10 +4775,48 @@ _btk_text_line_previous_could_contain_tag (BtkTextLine  *line,
 
   if (tag == NULL)
     {
-      /* Right now we can only offer linear-search if the user wants
-       * to know about any tag toggle at all.
-       */
-      return _btk_text_line_previous (line);
+      /* See above; skip the nodes without toggles. */
+      prev = prev_line_under_node (line->parent, line);
+      if (prev)
+        return prev;
+
+      found_node = NULL;
+      node = line->parent;
+      while (node->parent != NULL && found_node == NULL)
+        {
+          BtkTextBTreeNode *sibling;
+
+          for (sibling = node->parent->children.node;
+               sibling != node;
+               sibling = sibling->next)
+            {
+              if (sibling->num_toggles > 0)
+                found_node = sibling;
+            }
+
+          node = node->parent;
+        }
+
+      if (found_node == NULL)
+        return NULL;
+
+      node = found_node;
+      while (node->level > 0)
+        {
+          found_node = NULL;
+          for (node = node->children.node; node != NULL; node = node->next)
+            {
+              if (node->num_toggles > 0)
+                found_node = node;
+            }
+          node = found_node;
+        }
+
+      prev = node->children.line;
+      while (prev->next)
+        prev = prev->next;
+
+      return prev;
     }
 
   /* Return same-node line, if any. */
@@ -4574,7 +4891,7 @@ _btk_text_line_previous_could_contain_tag (BtkTextLine  *line,
 
               g_assert (this_node != line_ancestor);
 
-              if (btk_text_btree_node_has_tag (this_node, tag))
+              if (btk_text_btree_node_has_tag (this_node, info))
                 {
                   found_node = this_node;
                   b_slist_free (child_nodes);
@@ -4649,7 +4966,7 @@ _btk_text_line_previous_could_contain_tag (BtkTextLine  *line,
       iter = child_nodes;
       while (iter != NULL)
         {
-          if (btk_text_btree_node_has_tag (iter->data, tag))
+          if (btk_text_btree_node_has_tag (iter->data, info))
             {
               /* recurse into this node. */
               node = iter->data;
@@ -4733,14 +5050,16 @@ btk_text_line_destroy (BtkTextBTree *tree, BtkTextLine *line)
 {
   BtkTextLineData *ld;
   BtkTextLineData *next;
+  BTreeView *view;
 
   g_return_if_fail (line != NULL);
 
+  for (view = tree->views; view != NULL; view = view->next)
+    _btk_text_layout_line_deleted (view->layout, line);
+
   ld = line->views;
   while (ld != NULL)
     {
-      BTreeView *view;
-
       view = btk_text_btree_get_view (tree, ld->view_id);
 
       g_assert (view != NULL);
@@ -4865,6 +5184,10 @@ btk_text_btree_node_new (void)
   node = g_new (BtkTextBTreeNode, 1);
 
   node->node_data = NULL;
+  node->tag_bits = NULL;
+  node->n_tag_words = 0;
+  node->tag_bits_valid = FALSE;
+  node->num_toggles = 0;
 
   return node;
 }
@@ -4898,27 +5221,25 @@ btk_text_btree_node_adjust_toggle_count (BtkTextBTreeNode  *node,
       summary->next = node->summary;
       node->summary = summary;
     }
+
+  btk_text_btree_node_tags_changed (node);
 }
 
 /* Note that the tag root and above do not have summaries
    for the tag; only nodes below the tag root have
-   the summaries. */
+   the summaries. A NULL info means any tag. */
 static bboolean
-btk_text_btree_node_has_tag (BtkTextBTreeNode *node, BtkTextTag *tag)
+btk_text_btree_node_has_tag (BtkTextBTreeNode *node, BtkTextTagInfo *info)
 {
-  Summary *summary;
-
-  summary = node->summary;
-  while (summary != NULL)
-    {
-      if (tag == NULL ||
-          summary->info->tag == tag)
-        return TRUE;
+  if (info == NULL)
+    return node->summary != NULL;
 
-      summary = summary->next;
-    }
+  if (!node->tag_bits_valid)
+    btk_text_btree_node_update_tag_bits (node);
 
-  return FALSE;
+  return TAG_BITS_WORD (info->index) < node->n_tag_words &&
+    (node->tag_bits[TAG_BITS_WORD (info->index)] &
+     TAG_BITS_MASK (info->index)) != 0;
 }
 
 /* Add node and all children to the damage rebunnyion. */
@@ -5036,6 +5357,58 @@ _btk_text_btree_is_valid (BtkTextBTree *tree,
   return (nd && nd->valid);
 }
 
+/**
+ * _btk_text_btree_find_invalid_line:
+ * @tree: a #BtkTextBTree
+ * @view_id: view id
+ *
+ * Finds the line _btk_text_btree_validate() would start validating
+ * at, using the per-node validity to skip valid parts of the tree.
+ *
+ * Return value: the first line that is not valid for @view_id, or
+ * %NULL if the entire tree is valid.
+ **/
+BtkTextLine *
+_btk_text_btree_find_invalid_line (BtkTextBTree *tree,
+                                   bpointer      view_id)
+{
+  BtkTextBTreeNode *node;
+  BtkTextLine *line;
+  NodeData *nd;
+
+  g_return_val_if_fail (tree != NULL, NULL);
+
+  node = tree->root_node;
+  nd = node_data_find (node->node_data, view_id);
+  if (nd && nd->valid)
+    return NULL;
+
+  while (node->level > 0)
+    {
+      node = node->children.node;
+      while (node)
+        {
+          nd = node_data_find (node->node_data, view_id);
+          if (!nd || !nd->valid)
+            break;
+          node = node->next;
+        }
+
+      if (node == NULL)
+        return NULL;
+    }
+
+  for (line = node->children.line; line != NULL; line = line->next)
+    {
+      BtkTextLineData *ld = _btk_text_line_get_data (line, view_id);
+
+      if (!ld || !ld->valid)
+        return line;
+    }
+
+  return NULL;
+}
+
 typedef struct _ValidateState ValidateState;
 
 struct _ValidateState
@@ -5513,6 +5886,7 @@ btk_text_btree_node_free_empty (BtkTextBTree *tree,
 
   summary_list_destroy (node->summary);
   node_data_list_destroy (node->node_data);
+  g_free (node->tag_bits);
   g_free (node);
 }
 
@@ -5716,19 +6090,29 @@ btk_text_btree_rebalance (BtkTextBTree *tree,
     {
       BtkTextBTreeNode *new_node, *child;
       BtkTextLine *line;
-      int i;
+      int i, keep;
 
       /*
        * Check to see if the BtkTextBTreeNode has too many children.  If it does,
        * then split off all but the first MIN_CHILDREN into a separate
        * BtkTextBTreeNode following the original one.  Then repeat until the
        * BtkTextBTreeNode has a decent size.
+       *
+       * A node that got many children at once (a large insertion) is
+       * instead cut into nodes of FILL_CHILDREN, as long as that
+       * leaves enough children for the remainder; this builds fewer
+       * nodes for big documents while leaving them room to grow.
        */
 
       if (node->num_children > MAX_CHILDREN)
         {
           while (1)
             {
+              if (node->num_children - FILL_CHILDREN >= MIN_CHILDREN)
+                keep = FILL_CHILDREN;
+              else
+                keep = MIN_CHILDREN;
+
               /*
                * If the BtkTextBTreeNode being split is the root
                * BtkTextBTreeNode, then make a new root BtkTextBTreeNode above
@@ -5752,10 +6136,10 @@ btk_text_btree_rebalance (BtkTextBTree *tree,
               node->next = new_node;
               new_node->summary = NULL;
               new_node->level = node->level;
-              new_node->num_children = node->num_children - MIN_CHILDREN;
+              new_node->num_children = node->num_children - keep;
               if (node->level == 0)
                 {
-                  for (i = MIN_CHILDREN-1,
+                  for (i = keep-1,
                          line = node->children.line;
                        i > 0; i--, line = line->next)
                     {
@@ -5766,7 +6150,7 @@ btk_text_btree_rebalance (BtkTextBTree *tree,
                 }
               else
                 {
-                  for (i = MIN_CHILDREN-1,
+                  for (i = keep-1,
                          child = node->children.node;
                        i > 0; i--, child = child->next)
                     {
@@ -5980,21 +6364,7 @@ static BtkTextTagInfo*
 btk_text_btree_get_existing_tag_info (BtkTextBTree *tree,
                                       BtkTextTag   *tag)
 {
-  BtkTextTagInfo *info;
-  GSList *list;
-
-
-  list = tree->tag_infos;
-  while (list != NULL)
-    {
-      info = list->data;
-      if (info->tag == tag)
-        return info;
-
-      list = b_slist_next (list);
-    }
-
-  return NULL;
+  return g_hash_table_lookup (tree->tag_info_table, tag);
 }
 
 static BtkTextTagInfo*
@@ -6016,7 +6386,19 @@ btk_text_btree_get_tag_info (BtkTextBTree *tree,
       info->tag_root = NULL;
       info->toggle_count = 0;
 
+      /* Reuse the index of a removed tag to keep the bitsets short */
+      info->index = 0;
+      while (info->index < (bint) tree->tag_slots->len &&
+             g_ptr_array_index (tree->tag_slots, info->index) != NULL)
+        info->index++;
+
+      if (info->index == (bint) tree->tag_slots->len)
+        g_ptr_array_add (tree->tag_slots, info);
+      else
+        g_ptr_array_index (tree->tag_slots, info->index) = info;
+
       tree->tag_infos = b_slist_prepend (tree->tag_infos, info);
+      g_hash_table_insert (tree->tag_info_table, tag, info);
 
 #if 0
       g_print ("Created tag info %p for tag %s(%p)\n",
@@ -6060,6 +6442,9 @@ btk_text_btree_remove_tag_info (BtkTextBTree *tree,
           list->next = NULL;
           b_slist_free (list);
 
+          g_ptr_array_index (tree->tag_slots, info->index) = NULL;
+          g_hash_table_remove (tree->tag_info_table, tag);
+
           g_object_unref (info->tag);
 
           g_slice_free (BtkTextTagInfo, info);
@@ -6107,6 +6492,7 @@ recompute_level_zero_counts (BtkTextBTreeNode *node)
               info = seg->body.toggle.info;
 
               btk_text_btree_node_adjust_toggle_count (node, info, 1);
+              node->num_toggles += 1;
             }
 
           seg = seg->next;
@@ -6130,6 +6516,7 @@ recompute_level_nonzero_counts (BtkTextBTreeNode *node)
       node->num_children += 1;
       node->num_lines += child->num_lines;
       node->num_chars += child->num_chars;
+      node->num_toggles += child->num_toggles;
 
       if (child->parent != node)
         {
@@ -6194,6 +6581,8 @@ recompute_node_counts (BtkTextBTree *tree, BtkTextBTreeNode *node)
   node->num_children = 0;
   node->num_lines = 0;
   node->num_chars = 0;
+  node->num_toggles = 0;
+  btk_text_btree_node_tags_changed (node);
 
   /*
    * Scan through the children, adding the childrens' tag counts into
@@ -6272,6 +6661,14 @@ _btk_change_node_toggle_count (BtkTextBTreeNode *node,
 
   info->toggle_count += delta;
 
+  /*
+   * The total toggle counts are kept all the way up to the root,
+   * independent of the tag root.
+   */
+
+  for (node2Ptr = node; node2Ptr != NULL; node2Ptr = node2Ptr->parent)
+    node2Ptr->num_toggles += delta;
+
   if (info->tag_root == (BtkTextBTreeNode *) NULL)
     {
       info->tag_root = node;
@@ -6293,6 +6690,8 @@ _btk_change_node_toggle_count (BtkTextBTreeNode *node,
 
   for ( ; node != info->tag_root; node = node->parent)
     {
+      btk_text_btree_node_tags_changed (node);
+
       /*
        * See if there's already an entry for this tag for this BtkTextBTreeNode.  If so,
        * perhaps all we have to do is adjust its count.
@@ -6367,6 +6766,7 @@ _btk_change_node_toggle_count (BtkTextBTreeNode *node,
               summary->toggle_count = info->toggle_count - delta;
               summary->next = rootnode->summary;
               rootnode->summary = summary;
+              btk_text_btree_node_tags_changed (rootnode);
               rootnode = rootnode->parent;
               rootLevel = rootnode->level;
               info->tag_root = rootnode;
@@ -6440,6 +6840,7 @@ _btk_change_node_toggle_count (BtkTextBTreeNode *node,
               prevPtr->next = summary->next;
             }
           summary_destroy (summary);
+          btk_text_btree_node_tags_changed (node2Ptr);
           info->tag_root = node2Ptr;
           break;
         }
@@ -6447,72 +6848,6 @@ _btk_change_node_toggle_count (BtkTextBTreeNode *node,
     }
 }
 
-/*
- *----------------------------------------------------------------------
- *
- * inc_count --
- *
- *      This is a utility procedure used by _btk_text_btree_get_tags.  It
- *      increments the count for a particular tag, adding a new
- *      entry for that tag if there wasn't one previously.
- *
- * Results:
- *      None.
- *
- * Side effects:
- *      The information at *tagInfoPtr may be modified, and the arrays
- *      may be reallocated to make them larger.
- *
- *----------------------------------------------------------------------
- */
-
-static void
-inc_count (BtkTextTag *tag, int inc, TagInfo *tagInfoPtr)
-{
-  BtkTextTag **tag_p;
-  int count;
-
-  for (tag_p = tagInfoPtr->tags, count = tagInfoPtr->numTags;
-       count > 0; tag_p++, count--)
-    {
-      if (*tag_p == tag)
-        {
-          tagInfoPtr->counts[tagInfoPtr->numTags-count] += inc;
-          return;
-        }
-    }
-
-  /*
-   * There isn't currently an entry for this tag, so we have to
-   * make a new one.  If the arrays are full, then enlarge the
-   * arrays first.
-   */
-
-  if (tagInfoPtr->numTags == tagInfoPtr->arraySize)
-    {
-      BtkTextTag **newTags;
-      int *newCounts, newSize;
-
-      newSize = 2*tagInfoPtr->arraySize;
-      newTags = (BtkTextTag **) g_malloc ((unsigned)
-                                          (newSize*sizeof (BtkTextTag *)));
-      memcpy ((void *) newTags, (void *) tagInfoPtr->tags,
-              tagInfoPtr->arraySize  *sizeof (BtkTextTag *));
-      g_free ((char *) tagInfoPtr->tags);
-      tagInfoPtr->tags = newTags;
-      newCounts = (int *) g_malloc ((unsigned) (newSize*sizeof (int)));
-      memcpy ((void *) newCounts, (void *) tagInfoPtr->counts,
-              tagInfoPtr->arraySize  *sizeof (int));
-      g_free ((char *) tagInfoPtr->counts);
-      tagInfoPtr->counts = newCounts;
-      tagInfoPtr->arraySize = newSize;
-    }
-
-  tagInfoPtr->tags[tagInfoPtr->numTags] = tag;
-  tagInfoPtr->counts[tagInfoPtr->numTags] = inc;
-  tagInfoPtr->numTags++;
-}
-
 static void
 btk_text_btree_link_segment (BtkTextLineSegment *seg,
                              const BtkTextIter *iter)
@@ -6692,6 +7027,7 @@ btk_text_btree_node_check_consistency (BtkTextBTree     *tree,
   BtkTextLine *line;
   BtkTextLineSegment *segPtr;
   int num_children, num_lines, num_chars, toggle_count, min_children;
+  int num_toggles, num_summaries, i;
   BtkTextLineData *ld;
   NodeData *nd;
 
@@ -6723,6 +7059,7 @@ btk_text_btree_node_check_consistency (BtkTextBTree     *tree,
   num_children = 0;
   num_lines = 0;
   num_chars = 0;
+  num_toggles = 0;
   if (node->level == 0)
     {
       for (line = node->children.line; line != NULL;
@@ -6765,6 +7102,10 @@ btk_text_btree_node_check_consistency (BtkTextBTree     *tree,
                 }
 
               num_chars += segPtr->char_count;
+
+              if ((segPtr->type == &btk_text_toggle_on_type)
+                  || (segPtr->type == &btk_text_toggle_off_type))
+                num_toggles++;
             }
 
           num_children++;
@@ -6811,6 +7152,7 @@ btk_text_btree_node_check_consistency (BtkTextBTree     *tree,
           num_children++;
           num_lines += childnode->num_lines;
           num_chars += childnode->num_chars;
+          num_toggles += childnode->num_toggles;
         }
     }
   if (num_children != node->num_children)
@@ -6828,6 +7170,34 @@ btk_text_btree_node_check_consistency (BtkTextBTree     *tree,
       g_error ("btk_text_btree_node_check_consistency: mismatch in num_chars (%d %d)",
                num_chars, node->num_chars);
     }
+  if (num_toggles != node->num_toggles)
+    {
+      g_error ("btk_text_btree_node_check_consistency: mismatch in num_toggles (%d %d)",
+               num_toggles, node->num_toggles);
+    }
+
+  if (node->tag_bits_valid)
+    {
+      num_summaries = 0;
+      for (summary = node->summary; summary != NULL;
+           summary = summary->next)
+        {
+          if (!btk_text_btree_node_has_tag (node, summary->info) ||
+              btk_text_btree_node_tag_is_odd (node, summary->info) !=
+              ((summary->toggle_count & 1) != 0))
+            {
+              g_error ("btk_text_btree_node_check_consistency: stale tag bits for \"%s\"",
+                       summary->info->tag->name);
+            }
+          num_summaries++;
+        }
+      for (i = 0; i < node->n_tag_words; i++)
+        num_summaries -= bits_count (node->tag_bits[i]);
+      if (num_summaries != 0)
+        {
+          g_error ("btk_text_btree_node_check_consistency: stale tag bits");
+        }
+    }
 
   for (summary = node->summary; summary != NULL;
        summary = summary->next)
@@ -7074,10 +7444,10 @@ _btk_text_btree_check (BtkTextBTree *tree)
       g_error ("_btk_text_btree_check: last line has wrong # characters: %d",
                seg->byte_count);
     }
-  if ((seg->body.chars[0] != '\n') || (seg->body.chars[1] != 0))
+  if ((seg->byte_count != 1) || (seg->body.text.chars[0] != '\n'))
     {
-      g_error ("_btk_text_btree_check: last line had bad value: %s",
-               seg->body.chars);
+      g_error ("_btk_text_btree_check: last line had bad value: %.*s",
+               seg->byte_count, seg->body.text.chars);
     }
 }
 
@@ -7153,7 +7523,7 @@ _btk_text_btree_spew_line_short (BtkTextLine *line, int indent)
     {
       if (seg->type == &btk_text_char_type)
         {
-          bchar* str = g_strndup (seg->body.chars, MIN (seg->byte_count, 10));
+          bchar* str = g_strndup (seg->body.text.chars, MIN (seg->byte_count, 10));
           bchar* s;
           s = str;
           while (*s)
@@ -7263,7 +7633,7 @@ _btk_text_btree_spew_segment (BtkTextBTree* tree, BtkTextLineSegment * seg)
 
   if (seg->type == &btk_text_char_type)
     {
-      bchar* str = g_strndup (seg->body.chars, seg->byte_count);
+      bchar* str = g_strndup (seg->body.text.chars, seg->byte_count);
       printf ("       `%s'\n", str);
       g_free (str);
     }
@@ -100,6 +100,8 @@ void         _btk_text_btree_get_view_size     (BtkTextBTree      *tree,
                                                 bint              *height);
 bboolean     _btk_text_btree_is_valid          (BtkTextBTree      *tree,
                                                 bpointer           view_id);
+BtkTextLine *_btk_text_btree_find_invalid_line  (BtkTextBTree      *tree,
+                                                bpointer           view_id);
 bboolean     _btk_text_btree_validate          (BtkTextBTree      *tree,
                                                 bpointer           view_id,
                                                 bint               max_pixels,
@@ -116,6 +118,8 @@ void _btk_text_btree_tag (const BtkTextIter *start,
                           const BtkTextIter *end,
                           BtkTextTag        *tag,
                           bboolean           apply);
+void _btk_text_btree_freeze_tag_redisplay (BtkTextBTree *tree);
+void _btk_text_btree_thaw_tag_redisplay   (BtkTextBTree *tree);
 
 /* "Getters" */
 
@@ -27,6 +27,7 @@
 
 #include "config.h"
 #include <string.h>
+#include <stdlib.h>
 #include <stdarg.h>
 
 #define BTK_TEXT_USE_INTERNAL_UNSUPPORTED_API
@@ -36,6 +37,7 @@
 #include "btkmarshalers.h"
 #include "btktextbuffer.h"
 #include "btktextbufferrichtext.h"
+#include "btktextbufferserialize.h"
 #include "btktextbtree.h"
 #include "btktextiterprivate.h"
 #include "btkprivate.h"
@@ -46,6 +48,9 @@
 #define BTK_TEXT_BUFFER_GET_PRIVATE(obj) (B_TYPE_INSTANCE_GET_PRIVATE ((obj), BTK_TYPE_TEXT_BUFFER, BtkTextBufferPrivate))
 
 typedef struct _BtkTextBufferPrivate BtkTextBufferPrivate;
+typedef struct _BtkTextBufferLoad    BtkTextBufferLoad;
+typedef struct _BtkTextBufferIndex   BtkTextBufferIndex;
+typedef struct _BtkTextBufferHighlight BtkTextBufferHighlight;
 
 struct _BtkTextBufferPrivate
 {
@@ -56,6 +61,79 @@ struct _BtkTextBufferPrivate
   BtkTargetList  *paste_target_list;
   BtkTargetEntry *paste_target_entries;
   bint            n_paste_target_entries;
+
+  BtkTextBufferLoad *load;
+
+  BtkTextBufferIndex     *search_index;
+  BtkTextBufferHighlight *highlight;
+};
+
+/* Bytes read from the stream per main loop iteration while loading */
+#define LOAD_CHUNK_SIZE 65536
+
+struct _BtkTextBufferLoad
+{
+  BtkTextBuffer *buffer;        /* NULL once the load has finished */
+  GInputStream  *stream;
+  GCancellable  *cancellable;
+  GCancellable  *user_cancellable;
+  bulong         cancelled_id;
+
+  /* Right gravity, so it stays after the text loaded so far */
+  BtkTextMark   *mark;
+
+  bint64         bytes_read;
+  bint64         total_bytes;
+
+  /* Bytes at the start of data that could not be inserted yet: an
+   * incomplete UTF-8 character, or a \r that may start a \r\n.
+   */
+  bsize          n_pending;
+  bchar          data[LOAD_CHUNK_SIZE + 8];
+};
+
+/* The text of the buffer in one piece, for searching */
+struct _BtkTextBufferIndex
+{
+  buint  stamp;                 /* chars changed stamp of the btree */
+  bchar *text;                  /* as from btk_text_buffer_get_slice() */
+  bsize  len;
+  bsize *line_starts;           /* byte offset of every line in text */
+  bint   n_lines;
+
+  /* Case folded copy, made by the first case insensitive search.
+   * If folding changed the bytes of any non-ASCII character, folded_map
+   * has the offset in text of the character every byte came from.
+   */
+  bchar *folded;
+  bsize  folded_len;
+  bsize *folded_map;
+};
+
+struct _BtkTextBufferHighlight
+{
+  BtkTextTag        *tag;
+  bchar             *str;
+  BtkTextSearchFlags flags;
+  bint               n_newlines;  /* a match spans this many more lines */
+
+  buint              idle_id;
+
+  /* The first pass finds all the matches with the search index and
+   * tags them a batch at a time; everything before done is tagged.
+   * If the text changes meanwhile, the rest is found again from done.
+   */
+  bboolean           scanning;
+  BtkTextMark       *done;
+  buint              stamp;
+  GArray            *matches;   /* start and end offsets into the index */
+  buint              next;
+
+  /* Whole lines around the edits made since, to be searched again
+   * without the index
+   */
+  GSList            *damage;    /* start and end marks, newest first */
+  bint               n_damage;
 };
 
 
@@ -84,6 +162,8 @@ enum {
   BEGIN_USER_ACTION,
   END_USER_ACTION,
   PASTE_DONE,
+  LOAD_PROGRESS,
+  LOAD_FINISHED,
   LAST_SIGNAL
 };
 
@@ -125,6 +205,11 @@ static void btk_text_buffer_real_remove_tag            (BtkTextBuffer     *buffe
                                                         const BtkTextIter *start_char,
                                                         const BtkTextIter *end_char);
 static void btk_text_buffer_real_changed               (BtkTextBuffer     *buffer);
+static void search_index_forget                        (BtkTextBuffer     *buffer);
+static void highlight_stop                             (BtkTextBuffer     *buffer);
+static void highlight_damage                           (BtkTextBuffer     *buffer,
+                                                        bint               start_line,
+                                                        const BtkTextIter *end);
 static void btk_text_buffer_real_mark_set              (BtkTextBuffer     *buffer,
                                                         const BtkTextIter *iter,
                                                         BtkTextMark       *mark);
@@ -603,6 +688,52 @@ btk_text_buffer_class_init (BtkTextBufferClass *klass)
                   1,
                   BTK_TYPE_CLIPBOARD);
 
+  /**
+   * BtkTextBuffer::load-progress:
+   * @textbuffer: the object which received the signal
+   * @bytes_read: the number of bytes read from the stream so far
+   * @total_bytes: the size of the stream, or -1 if it is not known
+   *
+   * The ::load-progress signal is emitted each time a chunk of text
+   * read by btk_text_buffer_load_stream() has been added to the buffer.
+   *
+   * Since: 2.24.34
+   */
+  signals[LOAD_PROGRESS] =
+    g_signal_new (I_("load-progress"),
+                  B_OBJECT_CLASS_TYPE (object_class),
+                  G_SIGNAL_RUN_LAST,
+                  0,
+                  NULL, NULL,
+                  _btk_marshal_VOID__INT64_INT64,
+                  B_TYPE_NONE,
+                  2,
+                  B_TYPE_INT64,
+                  B_TYPE_INT64);
+
+  /**
+   * BtkTextBuffer::load-finished:
+   * @textbuffer: the object which received the signal
+   * @error: (allow-none): a #GError if loading failed or was
+   *     cancelled, or %NULL
+   *
+   * The ::load-finished signal is emitted when a load started with
+   * btk_text_buffer_load_stream() ends.  If it failed, the buffer
+   * holds the text that was read before the error.
+   *
+   * Since: 2.24.34
+   */
+  signals[LOAD_FINISHED] =
+    g_signal_new (I_("load-finished"),
+                  B_OBJECT_CLASS_TYPE (object_class),
+                  G_SIGNAL_RUN_LAST,
+                  0,
+                  NULL, NULL,
+                  _btk_marshal_VOID__BOXED,
+                  B_TYPE_NONE,
+                  1,
+                  B_TYPE_ERROR);
+
   g_type_class_add_private (object_class, sizeof (BtkTextBufferPrivate));
 }
 
@@ -760,6 +891,9 @@ btk_text_buffer_finalize (BObject *object)
 
   remove_all_selection_clipboards (buffer);
 
+  highlight_stop (buffer);
+  search_index_forget (buffer);
+
   if (buffer->tag_table)
     {
       _btk_text_tag_table_remove_buffer (buffer->tag_table, buffer);
@@ -850,7 +984,276 @@ btk_text_buffer_set_text (BtkTextBuffer *buffer,
   g_object_notify (B_OBJECT (buffer), "text");
 }
 
- 
+/*
+ * Loading
+ */
+
+static void
+load_free (BtkTextBufferLoad *load)
+{
+  if (load->user_cancellable)
+    {
+      g_cancellable_disconnect (load->user_cancellable, load->cancelled_id);
+      g_object_unref (load->user_cancellable);
+    }
+
+  g_object_unref (load->cancellable);
+  g_object_unref (load->stream);
+  g_free (load);
+}
+
+/* Ends the load as far as the buffer is concerned.  If a read is
+ * still in flight, its callback frees the load.
+ */
+static void
+load_detach (BtkTextBufferLoad *load,
+             const GError      *error)
+{
+  BtkTextBuffer *buffer = load->buffer;
+
+  BTK_TEXT_BUFFER_GET_PRIVATE (buffer)->load = NULL;
+  load->buffer = NULL;
+
+  btk_text_buffer_delete_mark (buffer, load->mark);
+  load->mark = NULL;
+
+  g_signal_emit (buffer, signals[LOAD_FINISHED], 0, error);
+
+  g_object_unref (buffer);
+}
+
+static void
+load_cancel (BtkTextBuffer *buffer)
+{
+  BtkTextBufferLoad *load = BTK_TEXT_BUFFER_GET_PRIVATE (buffer)->load;
+  GError *error;
+
+  g_cancellable_cancel (load->cancellable);
+
+  error = g_error_new_literal (G_IO_ERROR, G_IO_ERROR_CANCELLED,
+                               _("Loading was cancelled"));
+  load_detach (load, error);
+  g_error_free (error);
+}
+
+static void
+load_cancelled_cb (GCancellable *user_cancellable,
+                   bpointer      data)
+{
+  g_cancellable_cancel (G_CANCELLABLE (data));
+}
+
+/* Inserts the complete characters among the first @n_bytes of
+ * load->data and keeps the rest for the next chunk.
+ */
+static bboolean
+load_insert (BtkTextBufferLoad  *load,
+             bsize               n_bytes,
+             bboolean            at_end,
+             GError            **error)
+{
+  const bchar *end;
+  bsize n_valid;
+
+  if (!g_utf8_validate (load->data, n_bytes, &end))
+    {
+      n_valid = end - load->data;
+
+      /* A character may be split between two reads */
+      if (at_end ||
+          g_utf8_get_char_validated (end, n_bytes - n_valid) != (gunichar)-2)
+        {
+          g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                               _("The text is not valid UTF-8"));
+          return FALSE;
+        }
+    }
+  else
+    n_valid = n_bytes;
+
+  /* Don't split a \r\n paragraph delimiter */
+  if (!at_end && n_valid > 0 && load->data[n_valid - 1] == '\r')
+    n_valid--;
+
+  if (n_valid > 0)
+    {
+      BtkTextIter iter;
+
+      btk_text_buffer_get_iter_at_mark (load->buffer, &iter, load->mark);
+      btk_text_buffer_insert (load->buffer, &iter, load->data, n_valid);
+    }
+
+  load->n_pending = n_bytes - n_valid;
+  memmove (load->data, load->data + n_valid, load->n_pending);
+
+  return TRUE;
+}
+
+static void load_read_cb (GObject      *source,
+                          GAsyncResult *result,
+                          bpointer      data);
+
+static void
+load_read_next (BtkTextBufferLoad *load)
+{
+  /* Reading one chunk per main loop iteration, at idle priority,
+   * keeps redraws and input going while a large file loads.
+   */
+  g_input_stream_read_async (load->stream,
+                             load->data + load->n_pending,
+                             LOAD_CHUNK_SIZE,
+                             G_PRIORITY_DEFAULT_IDLE,
+                             load->cancellable,
+                             load_read_cb,
+                             load);
+}
+
+static void
+load_read_cb (GObject      *source,
+              GAsyncResult *result,
+              bpointer      data)
+{
+  BtkTextBufferLoad *load = data;
+  GError *error = NULL;
+  bssize n_read;
+
+  n_read = g_input_stream_read_finish (G_INPUT_STREAM (source), result, &error);
+
+  if (load->buffer == NULL)
+    {
+      g_clear_error (&error);
+      load_free (load);
+      return;
+    }
+
+  bdk_threads_enter ();
+
+  if (n_read < 0 ||
+      !load_insert (load, load->n_pending + n_read, n_read == 0, &error))
+    {
+      load_detach (load, error);
+      g_error_free (error);
+    }
+  else if (load->buffer != NULL)
+    {
+      if (n_read == 0)
+        load_detach (load, NULL);
+      else
+        {
+          load->bytes_read += n_read;
+          g_signal_emit (load->buffer, signals[LOAD_PROGRESS], 0,
+                         load->bytes_read, load->total_bytes);
+        }
+    }
+
+  /* A signal handler may have cancelled the load */
+  if (load->buffer != NULL)
+    load_read_next (load);
+  else
+    load_free (load);
+
+  bdk_threads_leave ();
+}
+
+static void
+load_query_info_cb (GObject      *source,
+                    GAsyncResult *result,
+                    bpointer      data)
+{
+  BtkTextBufferLoad *load = data;
+  GFileInfo *info;
+
+  /* Not knowing the size is not an error */
+  info = g_file_input_stream_query_info_finish (G_FILE_INPUT_STREAM (source),
+                                                result, NULL);
+  if (info)
+    {
+      if (g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_STANDARD_SIZE))
+        load->total_bytes = g_file_info_get_size (info);
+      g_object_unref (info);
+    }
+
+  if (load->buffer == NULL)
+    load_free (load);
+  else
+    load_read_next (load);
+}
+
+/**
+ * btk_text_buffer_load_stream:
+ * @buffer: a #BtkTextBuffer
+ * @stream: a #GInputStream with UTF-8 text
+ * @cancellable: (allow-none): a #GCancellable, or %NULL
+ *
+ * Replaces the contents of @buffer with the text read from @stream.
+ *
+ * The stream is read asynchronously, and the text is added to the
+ * buffer in chunks from the main loop, so the user interface stays
+ * responsive and only a single chunk of the file is held in memory
+ * besides the buffer itself.  This is the preferred way to put large
+ * files into a buffer; open them with g_file_read().
+ *
+ * #BtkTextBuffer::load-progress is emitted after every chunk, and
+ * #BtkTextBuffer::load-finished once the whole stream has been read,
+ * an error occurred, the text turned out not to be valid UTF-8, or
+ * the load was cancelled with @cancellable.  Starting another load
+ * cancels the one in progress.
+ *
+ * The text is inserted with btk_text_buffer_insert() as it arrives,
+ * after the current end of the loaded text; edits elsewhere in the
+ * buffer are allowed during the load.  The buffer keeps a reference
+ * to itself until the load has finished.
+ *
+ * Since: 2.24.34
+ **/
+void
+btk_text_buffer_load_stream (BtkTextBuffer *buffer,
+                             GInputStream  *stream,
+                             GCancellable  *cancellable)
+{
+  BtkTextBufferPrivate *priv;
+  BtkTextBufferLoad *load;
+  BtkTextIter start, end;
+
+  g_return_if_fail (BTK_IS_TEXT_BUFFER (buffer));
+  g_return_if_fail (G_IS_INPUT_STREAM (stream));
+  g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+  priv = BTK_TEXT_BUFFER_GET_PRIVATE (buffer);
+
+  if (priv->load)
+    load_cancel (buffer);
+
+  btk_text_buffer_get_bounds (buffer, &start, &end);
+  btk_text_buffer_delete (buffer, &start, &end);
+
+  load = g_new0 (BtkTextBufferLoad, 1);
+  load->buffer = g_object_ref (buffer);
+  load->stream = g_object_ref (stream);
+  load->cancellable = g_cancellable_new ();
+  load->mark = btk_text_buffer_create_mark (buffer, NULL, &start, FALSE);
+  load->total_bytes = -1;
+
+  priv->load = load;
+
+  if (cancellable)
+    {
+      load->user_cancellable = g_object_ref (cancellable);
+      load->cancelled_id = g_cancellable_connect (cancellable,
+                                                  G_CALLBACK (load_cancelled_cb),
+                                                  load->cancellable, NULL);
+    }
+
+  if (G_IS_FILE_INPUT_STREAM (stream))
+    g_file_input_stream_query_info_async (G_FILE_INPUT_STREAM (stream),
+                                          G_FILE_ATTRIBUTE_STANDARD_SIZE,
+                                          G_PRIORITY_DEFAULT_IDLE,
+                                          load->cancellable,
+                                          load_query_info_cb,
+                                          load);
+  else
+    load_read_next (load);
+}
 
 /*
  * Insertion
@@ -862,10 +1265,14 @@ btk_text_buffer_real_insert_text (BtkTextBuffer *buffer,
                                   const bchar   *text,
                                   bint           len)
 {
+  bint line;
+
   g_return_if_fail (BTK_IS_TEXT_BUFFER (buffer));
   g_return_if_fail (iter != NULL);
   
+  line = btk_text_iter_get_line (iter);
   _btk_text_btree_insert (iter, text, len);
+  highlight_damage (buffer, line, iter);
 
   g_signal_emit (buffer, signals[CHANGED], 0);
   g_object_notify (B_OBJECT (buffer), "cursor-position");
@@ -1581,6 +1988,7 @@ btk_text_buffer_real_delete_range (BtkTextBuffer *buffer,
   g_return_if_fail (end != NULL);
 
   _btk_text_btree_delete (start, end);
+  highlight_damage (buffer, btk_text_iter_get_line (start), start);
 
   /* may have deleted the selection... */
   update_selection_clipboards (buffer);
@@ -1870,7 +2278,10 @@ btk_text_buffer_real_insert_pixbuf (BtkTextBuffer *buffer,
                                     BtkTextIter   *iter,
                                     BdkPixbuf     *pixbuf)
 { 
+  bint line = btk_text_iter_get_line (iter);
+
   _btk_text_btree_insert_pixbuf (iter, pixbuf);
+  highlight_damage (buffer, line, iter);
 
   g_signal_emit (buffer, signals[CHANGED], 0);
 }
@@ -1914,7 +2325,10 @@ btk_text_buffer_real_insert_anchor (BtkTextBuffer      *buffer,
                                     BtkTextIter        *iter,
                                     BtkTextChildAnchor *anchor)
 {
+  bint line = btk_text_iter_get_line (iter);
+
   _btk_text_btree_insert_child_anchor (iter, anchor);
+  highlight_damage (buffer, line, iter);
 
   g_signal_emit (buffer, signals[CHANGED], 0);
 }
@@ -2509,6 +2923,9 @@ static void
 btk_text_buffer_real_changed (BtkTextBuffer *buffer)
 {
   btk_text_buffer_set_modified (buffer, TRUE);
+
+  /* Don't keep a stale copy of a large buffer around */
+  search_index_forget (buffer);
 }
 
 static void
@@ -2696,6 +3113,126 @@ btk_text_buffer_remove_tag_by_name (BtkTextBuffer     *buffer,
   btk_text_buffer_emit_tag (buffer, tag, FALSE, start, end);
 }
 
+static int
+tag_range_compare_tag (const void *a,
+                       const void *b)
+{
+  const BtkTextBufferTagRange *range_a = a;
+  const BtkTextBufferTagRange *range_b = b;
+
+  if (range_a->tag != range_b->tag)
+    return range_a->tag < range_b->tag ? -1 : 1;
+
+  return range_a->start_offset - range_b->start_offset;
+}
+
+static int
+tag_range_compare_start (const void *a,
+                         const void *b)
+{
+  const BtkTextBufferTagRange *range_a = a;
+  const BtkTextBufferTagRange *range_b = b;
+
+  if (range_a->start_offset != range_b->start_offset)
+    return range_a->start_offset - range_b->start_offset;
+
+  return range_a->tag->priority - range_b->tag->priority;
+}
+
+/**
+ * btk_text_buffer_apply_tag_ranges:
+ * @buffer: a #BtkTextBuffer
+ * @ranges: (array length=n_ranges): the ranges to tag
+ * @n_ranges: the number of elements in @ranges
+ *
+ * Applies the tag of each of @ranges to the characters between its
+ * offsets, as when re-highlighting the visible part of a buffer.
+ *
+ * The ranges of each tag are sorted, and those that overlap or touch
+ * are merged; the #BtkTextBuffer::apply-tag signal is then emitted
+ * once for each merged range, in the order of the buffer.  The views
+ * of @buffer are updated when all the ranges are tagged, rather than
+ * for every call of btk_text_buffer_apply_tag(), and only the lines
+ * the ranges touch are laid out again.
+ *
+ * The offsets of a range do not have to be in order, and offsets
+ * past the end of the buffer refer to the end.
+ *
+ * Since: 2.24.34
+ **/
+void
+btk_text_buffer_apply_tag_ranges (BtkTextBuffer               *buffer,
+                                  const BtkTextBufferTagRange *ranges,
+                                  bint                         n_ranges)
+{
+  BtkTextBufferTagRange *sorted;
+  BtkTextIter start, end;
+  bint i, n, n_merged;
+
+  g_return_if_fail (BTK_IS_TEXT_BUFFER (buffer));
+  g_return_if_fail (n_ranges >= 0);
+  g_return_if_fail (ranges != NULL || n_ranges == 0);
+
+  for (i = 0; i < n_ranges; i++)
+    {
+      g_return_if_fail (BTK_IS_TEXT_TAG (ranges[i].tag));
+      g_return_if_fail (ranges[i].tag->table == buffer->tag_table);
+      g_return_if_fail (ranges[i].start_offset >= 0);
+      g_return_if_fail (ranges[i].end_offset >= 0);
+    }
+
+  sorted = g_new (BtkTextBufferTagRange, MAX (n_ranges, 1));
+
+  n = 0;
+  for (i = 0; i < n_ranges; i++)
+    {
+      sorted[n].tag = ranges[i].tag;
+      sorted[n].start_offset = MIN (ranges[i].start_offset, ranges[i].end_offset);
+      sorted[n].end_offset = MAX (ranges[i].start_offset, ranges[i].end_offset);
+
+      if (sorted[n].start_offset < sorted[n].end_offset)
+        n++;
+    }
+
+  if (n == 0)
+    {
+      g_free (sorted);
+      return;
+    }
+
+  /* Merge the ranges of each tag that overlap or touch... */
+  qsort (sorted, n, sizeof (BtkTextBufferTagRange), tag_range_compare_tag);
+
+  for (i = 1, n_merged = 1; i < n; i++)
+    {
+      BtkTextBufferTagRange *last = &sorted[n_merged - 1];
+
+      if (sorted[i].tag == last->tag &&
+          sorted[i].start_offset <= last->end_offset)
+        last->end_offset = MAX (last->end_offset, sorted[i].end_offset);
+      else
+        sorted[n_merged++] = sorted[i];
+    }
+  n = n_merged;
+
+  /* ...and apply them from the start of the buffer on */
+  qsort (sorted, n, sizeof (BtkTextBufferTagRange), tag_range_compare_start);
+
+  _btk_text_btree_freeze_tag_redisplay (get_btree (buffer));
+
+  for (i = 0; i < n; i++)
+    {
+      btk_text_buffer_get_iter_at_offset (buffer, &start, sorted[i].start_offset);
+      btk_text_buffer_get_iter_at_offset (buffer, &end, sorted[i].end_offset);
+
+      btk_text_buffer_emit_tag (buffer, sorted[i].tag, TRUE, &start, &end);
+    }
+
+  _btk_text_btree_thaw_tag_redisplay (get_btree (buffer));
+
+  g_free (sorted);
+}
+
 static bint
 pointer_cmp (gconstpointer a,
              gconstpointer b)
@@ -2820,44 +3357,1001 @@ btk_text_buffer_remove_all_tags (BtkTextBuffer     *buffer,
   b_slist_free (tags);
 }
 
-
 /*
- * Obtain various iterators
+ * Searching
  */
 
-/**
- * btk_text_buffer_get_iter_at_line_offset:
- * @buffer: a #BtkTextBuffer
- * @iter: (out): iterator to initialize
- * @line_number: line number counting from 0
- * @char_offset: char offset from start of line
- *
- * Obtains an iterator pointing to @char_offset within the given
- * line. The @char_offset must exist, offsets off the end of the line
- * are not allowed. Note <emphasis>characters</emphasis>, not bytes;
- * UTF-8 may encode one character as multiple bytes.
- **/
-void
-btk_text_buffer_get_iter_at_line_offset (BtkTextBuffer *buffer,
-                                         BtkTextIter   *iter,
-                                         bint           line_number,
-                                         bint           char_offset)
+/* Matches tagged per main loop iteration by btk_text_buffer_highlight_all() */
+#define HIGHLIGHT_BATCH_SIZE 500
+
+/* Edits the highlight searches again line by line; past this many
+ * separate ranges, or lines in one range, it finds all the matches
+ * again with the search index instead.
+ */
+#define HIGHLIGHT_MAX_DAMAGE       32
+#define HIGHLIGHT_MAX_DAMAGE_LINES 1000
+
+typedef struct _Horspool Horspool;
+
+/* Boyer-Moore-Horspool search for one pattern */
+struct _Horspool
 {
-  g_return_if_fail (iter != NULL);
-  g_return_if_fail (BTK_IS_TEXT_BUFFER (buffer));
+  const buchar *pattern;
+  bsize         len;
+  bboolean      backward;
+  bsize         skip[256];
+};
 
-  _btk_text_btree_get_iter_at_line_char (get_btree (buffer),
-                                         iter, line_number, char_offset);
+static void
+horspool_init (Horspool    *h,
+               const bchar *pattern,
+               bsize        len,
+               bboolean     backward)
+{
+  bsize i;
+
+  h->pattern = (const buchar *) pattern;
+  h->len = len;
+  h->backward = backward;
+
+  for (i = 0; i < 256; i++)
+    h->skip[i] = len;
+
+  /* How far the window can move when it holds a byte at its last
+   * (forward) or first (backward) position
+   */
+  if (backward)
+    for (i = len - 1; i > 0; i--)
+      h->skip[h->pattern[i]] = i;
+  else
+    for (i = 0; i + 1 < len; i++)
+      h->skip[h->pattern[i]] = len - 1 - i;
 }
 
-/**
- * btk_text_buffer_get_iter_at_line_index:
- * @buffer: a #BtkTextBuffer 
- * @iter: (out): iterator to initialize 
- * @line_number: line number counting from 0
- * @byte_index: byte index from start of line
- *
- * Obtains an iterator pointing to @byte_index within the given line.
+/* Returns the start of the first match in text[from, to), or -1 */
+static bssize
+horspool_find (const Horspool *h,
+               const bchar    *text,
+               bsize           from,
+               bsize           to)
+{
+  const buchar *t = (const buchar *) text;
+  bsize last = h->len - 1;
+  bsize pos = from;
+
+  if (h->len == 1)
+    {
+      const buchar *found = memchr (t + from, h->pattern[0], to - from);
+
+      return found ? found - t : -1;
+    }
+
+  while (pos + h->len <= to)
+    {
+      buchar c = t[pos + last];
+
+      if (c == h->pattern[last] &&
+          memcmp (t + pos, h->pattern, last) == 0)
+        return pos;
+
+      pos += h->skip[c];
+    }
+
+  return -1;
+}
+
+/* Returns the start of the last match in text[from, to), or -1 */
+static bssize
+horspool_rfind (const Horspool *h,
+                const bchar    *text,
+                bsize           from,
+                bsize           to)
+{
+  const buchar *t = (const buchar *) text;
+  bsize pos;
+
+  if (to < from + h->len)
+    return -1;
+
+  pos = to - h->len;
+
+  while (TRUE)
+    {
+      buchar c = t[pos];
+
+      if (c == h->pattern[0] &&
+          memcmp (t + pos + 1, h->pattern + 1, h->len - 1) == 0)
+        return pos;
+
+      if (pos < from + h->skip[c])
+        return -1;
+
+      pos -= h->skip[c];
+    }
+}
+
+static void
+search_index_free (BtkTextBufferIndex *index)
+{
+  g_free (index->text);
+  g_free (index->line_starts);
+  g_free (index->folded);
+  g_free (index->folded_map);
+  g_free (index);
+}
+
+static void
+search_index_forget (BtkTextBuffer *buffer)
+{
+  BtkTextBufferPrivate *priv = BTK_TEXT_BUFFER_GET_PRIVATE (buffer);
+
+  if (priv->search_index)
+    {
+      search_index_free (priv->search_index);
+      priv->search_index = NULL;
+    }
+}
+
+/* Returns the flat copy of the buffer text, made anew if the text
+ * changed since the last search.
+ */
+static BtkTextBufferIndex *
+search_index_get (BtkTextBuffer *buffer)
+{
+  BtkTextBufferPrivate *priv = BTK_TEXT_BUFFER_GET_PRIVATE (buffer);
+  BtkTextBufferIndex *index;
+  BtkTextIter start, end;
+  GArray *line_starts;
+  bint n_lines;
+  bsize offset;
+  buint stamp;
+
+  stamp = _btk_text_btree_get_chars_changed_stamp (get_btree (buffer));
+
+  if (priv->search_index && priv->search_index->stamp == stamp)
+    return priv->search_index;
+
+  search_index_forget (buffer);
+
+  index = g_new0 (BtkTextBufferIndex, 1);
+  index->stamp = stamp;
+
+  btk_text_buffer_get_bounds (buffer, &start, &end);
+  index->text = btk_text_buffer_get_slice (buffer, &start, &end, TRUE);
+  index->len = strlen (index->text);
+
+  /* Lines are indexed by byte, with 0xFFFC for pixbufs and child
+   * anchors, just like the slice
+   */
+  n_lines = btk_text_buffer_get_line_count (buffer);
+  line_starts = g_array_sized_new (FALSE, FALSE, sizeof (bsize), n_lines);
+  offset = 0;
+  do
+    {
+      g_array_append_val (line_starts, offset);
+      offset += btk_text_iter_get_bytes_in_line (&start);
+    }
+  while (btk_text_iter_forward_line (&start));
+
+  /* The empty last line after a trailing delimiter */
+  if (line_starts->len < n_lines)
+    g_array_append_val (line_starts, offset);
+
+  index->n_lines = line_starts->len;
+  index->line_starts = (bsize *) g_array_free (line_starts, FALSE);
+
+  priv->search_index = index;
+
+  return index;
+}
+
+/* Makes the case folded copy of the text.  As long as folding keeps
+ * every non-ASCII character as it is, offsets into the copy are
+ * offsets into the text; when it doesn't, folded_map is made to
+ * translate them and to tell where the folding of a character ends.
+ * That is needed even if the length stays the same, as "ß" folds to
+ * "ss", and a match must not end in the middle of it.
+ */
+static void
+search_index_fold (BtkTextBufferIndex *index)
+{
+  GString *folded;
+  GArray *map = NULL;
+  const bchar *p, *end;
+
+  if (index->folded)
+    return;
+
+  folded = g_string_sized_new (index->len + 1);
+  p = index->text;
+  end = index->text + index->len;
+
+  while (p < end)
+    {
+      const bchar *next;
+      bchar *fold;
+      bsize fold_len;
+      bsize char_start = p - index->text;
+
+      if ((buchar) *p < 0x80)
+        {
+          g_string_append_c (folded, g_ascii_tolower (*p));
+          if (map)
+            g_array_append_val (map, char_start);
+          p++;
+          continue;
+        }
+
+      next = g_utf8_next_char (p);
+      fold = g_utf8_casefold (p, next - p);
+      fold_len = strlen (fold);
+
+      if (map == NULL &&
+          (fold_len != next - p || memcmp (fold, p, fold_len) != 0))
+        {
+          const bchar *q;
+
+          /* Everything up to here kept its length */
+          map = g_array_sized_new (FALSE, FALSE, sizeof (bsize), index->len + 1);
+          for (q = index->text; q < p; )
+            {
+              const bchar *q_next = g_utf8_next_char (q);
+              bsize start = q - index->text;
+
+              for (; q < q_next; q++)
+                g_array_append_val (map, start);
+            }
+        }
+
+      g_string_append_len (folded, fold, fold_len);
+      if (map)
+        {
+          bsize i;
+
+          for (i = 0; i < fold_len; i++)
+            g_array_append_val (map, char_start);
+        }
+
+      g_free (fold);
+      p = next;
+    }
+
+  index->folded_len = folded->len;
+  index->folded = g_string_free (folded, FALSE);
+
+  if (map)
+    {
+      g_array_append_val (map, index->len);
+      index->folded_map = (bsize *) g_array_free (map, FALSE);
+    }
+}
+
+/* Translates an offset into the text to one into the folded text */
+static bsize
+search_index_to_folded (BtkTextBufferIndex *index,
+                        bsize               offset)
+{
+  bsize low, high;
+
+  if (index->folded_map == NULL)
+    return offset;
+
+  /* The first folded byte that came from at or after offset */
+  low = 0;
+  high = index->folded_len;
+  while (low < high)
+    {
+      bsize mid = (low + high) / 2;
+
+      if (index->folded_map[mid] < offset)
+        low = mid + 1;
+      else
+        high = mid;
+    }
+
+  return low;
+}
+
+static bsize
+search_index_iter_to_offset (BtkTextBufferIndex *index,
+                             const BtkTextIter  *iter)
+{
+  return index->line_starts[btk_text_iter_get_line (iter)] +
+         btk_text_iter_get_line_index (iter);
+}
+
+static void
+search_index_offset_to_iter (BtkTextBuffer      *buffer,
+                             BtkTextBufferIndex *index,
+                             bsize               offset,
+                             BtkTextIter        *iter)
+{
+  bint low, high;
+
+  /* The last line starting at or before offset */
+  low = 0;
+  high = index->n_lines - 1;
+  while (low < high)
+    {
+      bint mid = (low + high + 1) / 2;
+
+      if (index->line_starts[mid] <= offset)
+        low = mid;
+      else
+        high = mid - 1;
+    }
+
+  btk_text_buffer_get_iter_at_line_index (buffer, iter, low,
+                                          offset - index->line_starts[low]);
+}
+
+typedef struct _SearchState SearchState;
+
+struct _SearchState
+{
+  BtkTextBufferIndex *index;
+  Horspool            horspool;
+  bchar              *pattern;
+  bboolean            folded;
+};
+
+static void
+search_state_init (SearchState        *state,
+                   BtkTextBufferIndex *index,
+                   const bchar        *str,
+                   BtkTextSearchFlags  flags,
+                   bboolean            backward)
+{
+  state->index = index;
+  state->folded = (flags & BTK_TEXT_SEARCH_CASE_INSENSITIVE) != 0;
+
+  if (state->folded)
+    {
+      search_index_fold (index);
+      state->pattern = g_utf8_casefold (str, -1);
+    }
+  else
+    state->pattern = g_strdup (str);
+
+  horspool_init (&state->horspool, state->pattern, strlen (state->pattern),
+                 backward);
+}
+
+static void
+search_state_clear (SearchState *state)
+{
+  g_free (state->pattern);
+}
+
+/* Finds the first (or, if the state was made for searching backward,
+ * last) match within text[from, to).  Offsets are into the text, not
+ * the folded copy.
+ */
+static bboolean
+search_state_find (SearchState *state,
+                   bsize        from,
+                   bsize        to,
+                   bsize       *match_start,
+                   bsize       *match_end)
+{
+  BtkTextBufferIndex *index = state->index;
+  const bsize *map = index->folded_map;
+  const bchar *text;
+  bssize found;
+
+  if (!state->folded)
+    {
+      if (state->horspool.backward)
+        found = horspool_rfind (&state->horspool, index->text, from, to);
+      else
+        found = horspool_find (&state->horspool, index->text, from, to);
+
+      if (found < 0)
+        return FALSE;
+
+      *match_start = found;
+      *match_end = found + state->horspool.len;
+      return TRUE;
+    }
+
+  text = index->folded;
+  from = search_index_to_folded (index, from);
+  to = search_index_to_folded (index, to);
+
+  while (TRUE)
+    {
+      bsize end;
+
+      if (state->horspool.backward)
+        found = horspool_rfind (&state->horspool, text, from, to);
+      else
+        found = horspool_find (&state->horspool, text, from, to);
+
+      if (found < 0)
+        return FALSE;
+
+      end = found + state->horspool.len;
+
+      if (map == NULL)
+        {
+          *match_start = found;
+          *match_end = end;
+          return TRUE;
+        }
+
+      /* Matching part of the folding of a character doesn't count */
+      if ((found == 0 || map[found - 1] != map[found]) &&
+          map[end] != map[end - 1])
+        {
+          *match_start = map[found];
+          *match_end = map[end];
+          return TRUE;
+        }
+
+      if (state->horspool.backward)
+        to = end - 1;
+      else
+        from = found + 1;
+    }
+}
+
+/* Returns a #GArray of start and end byte offsets into the text */
+static GArray *
+search_index_find_all (BtkTextBufferIndex *index,
+                       const bchar        *str,
+                       BtkTextSearchFlags  flags,
+                       bsize               from,
+                       bsize               to)
+{
+  SearchState state;
+  GArray *matches;
+  bsize match_start, match_end;
+
+  matches = g_array_new (FALSE, FALSE, sizeof (bsize));
+
+  search_state_init (&state, index, str, flags, FALSE);
+
+  while (search_state_find (&state, from, to, &match_start, &match_end))
+    {
+      g_array_append_val (matches, match_start);
+      g_array_append_val (matches, match_end);
+      from = match_end;
+    }
+
+  search_state_clear (&state);
+
+  return matches;
+}
+
+bboolean
+_btk_text_buffer_has_search_index (BtkTextBuffer *buffer)
+{
+  BtkTextBufferPrivate *priv = BTK_TEXT_BUFFER_GET_PRIVATE (buffer);
+
+  return priv->search_index != NULL &&
+         priv->search_index->stamp == _btk_text_btree_get_chars_changed_stamp (get_btree (buffer));
+}
+
+/* The engine behind btk_text_iter_forward_search() and
+ * btk_text_iter_backward_search() while the search index is up to
+ * date, if neither %BTK_TEXT_SEARCH_VISIBLE_ONLY nor
+ * %BTK_TEXT_SEARCH_TEXT_ONLY is given.
+ */
+bboolean
+_btk_text_buffer_search (BtkTextBuffer      *buffer,
+                         const BtkTextIter  *iter,
+                         const bchar        *str,
+                         BtkTextSearchFlags  flags,
+                         bboolean            backward,
+                         BtkTextIter        *match_start,
+                         BtkTextIter        *match_end,
+                         const BtkTextIter  *limit)
+{
+  BtkTextBufferIndex *index;
+  SearchState state;
+  bsize from, to;
+  bsize start, end;
+  bboolean found;
+
+  index = search_index_get (buffer);
+
+  if (backward)
+    {
+      from = limit ? search_index_iter_to_offset (index, limit) : 0;
+      to = search_index_iter_to_offset (index, iter);
+    }
+  else
+    {
+      from = search_index_iter_to_offset (index, iter);
+      to = limit ? search_index_iter_to_offset (index, limit) : index->len;
+    }
+
+  if (from >= to)
+    return FALSE;
+
+  search_state_init (&state, index, str, flags, backward);
+  found = search_state_find (&state, from, to, &start, &end);
+  search_state_clear (&state);
+
+  if (found)
+    {
+      if (match_start)
+        search_index_offset_to_iter (buffer, index, start, match_start);
+      if (match_end)
+        search_index_offset_to_iter (buffer, index, end, match_end);
+    }
+
+  return found;
+}
+
+/**
+ * btk_text_buffer_find_all:
+ * @buffer: a #BtkTextBuffer
+ * @str: a search string
+ * @flags: flags affecting how the search is done
+ * @start: (allow-none): where to start searching, or %NULL for the
+ *     start of the buffer
+ * @end: (allow-none): where to stop searching, or %NULL for the end
+ *     of the buffer
+ *
+ * Finds all the occurrences of @str between @start and @end that do
+ * not overlap, in the same way as btk_text_iter_forward_search()
+ * would find them one by one.  %BTK_TEXT_SEARCH_VISIBLE_ONLY and
+ * %BTK_TEXT_SEARCH_TEXT_ONLY are not supported.
+ *
+ * The first search makes a copy of the whole text of the buffer to
+ * search in, which is kept for later searches until the text
+ * changes, so searching a large buffer repeatedly is cheap.
+ *
+ * Return value: (element-type BtkTextBufferMatch) (transfer full): a
+ *     #GArray of #BtkTextBufferMatch, in the order of the buffer.
+ *     Free it with g_array_free().
+ *
+ * Since: 2.24.34
+ **/
+GArray *
+btk_text_buffer_find_all (BtkTextBuffer      *buffer,
+                          const bchar        *str,
+                          BtkTextSearchFlags  flags,
+                          const BtkTextIter  *start,
+                          const BtkTextIter  *end)
+{
+  BtkTextBufferIndex *index;
+  GArray *offsets;
+  GArray *matches;
+  bsize from, to;
+  bsize pos;
+  bint char_offset;
+  buint i;
+
+  g_return_val_if_fail (BTK_IS_TEXT_BUFFER (buffer), NULL);
+  g_return_val_if_fail (str != NULL, NULL);
+  g_return_val_if_fail ((flags & (BTK_TEXT_SEARCH_VISIBLE_ONLY |
+                                  BTK_TEXT_SEARCH_TEXT_ONLY)) == 0, NULL);
+  g_return_val_if_fail (start == NULL || btk_text_iter_get_buffer (start) == buffer, NULL);
+  g_return_val_if_fail (end == NULL || btk_text_iter_get_buffer (end) == buffer, NULL);
+
+  matches = g_array_new (FALSE, FALSE, sizeof (BtkTextBufferMatch));
+
+  if (*str == '\0')
+    return matches;
+
+  index = search_index_get (buffer);
+
+  from = start ? search_index_iter_to_offset (index, start) : 0;
+  to = end ? search_index_iter_to_offset (index, end) : index->len;
+  if (from >= to)
+    return matches;
+
+  offsets = search_index_find_all (index, str, flags, from, to);
+
+  /* Count characters from one match to the next */
+  pos = from;
+  char_offset = start ? btk_text_iter_get_offset (start) : 0;
+  for (i = 0; i < offsets->len; i += 2)
+    {
+      BtkTextBufferMatch match;
+      bsize match_start = g_array_index (offsets, bsize, i);
+      bsize match_end = g_array_index (offsets, bsize, i + 1);
+
+      char_offset += g_utf8_strlen (index->text + pos, match_start - pos);
+      match.start_offset = char_offset;
+      char_offset += g_utf8_strlen (index->text + match_start, match_end - match_start);
+      match.end_offset = char_offset;
+      pos = match_end;
+
+      g_array_append_val (matches, match);
+    }
+
+  g_array_free (offsets, TRUE);
+
+  return matches;
+}
+
+static void
+highlight_forget_damage (BtkTextBuffer          *buffer,
+                         BtkTextBufferHighlight *highlight)
+{
+  GSList *l;
+
+  for (l = highlight->damage; l; l = l->next)
+    _btk_text_btree_remove_mark (get_btree (buffer), l->data);
+
+  b_slist_free (highlight->damage);
+  highlight->damage = NULL;
+  highlight->n_damage = 0;
+}
+
+static void
+highlight_free (BtkTextBuffer          *buffer,
+                BtkTextBufferHighlight *highlight)
+{
+  if (highlight->idle_id)
+    g_source_remove (highlight->idle_id);
+  highlight_forget_damage (buffer, highlight);
+  _btk_text_btree_remove_mark (get_btree (buffer), highlight->done);
+  g_object_unref (highlight->tag);
+  g_free (highlight->str);
+  if (highlight->matches)
+    g_array_free (highlight->matches, TRUE);
+  g_free (highlight);
+}
+
+static void
+highlight_stop (BtkTextBuffer *buffer)
+{
+  BtkTextBufferPrivate *priv = BTK_TEXT_BUFFER_GET_PRIVATE (buffer);
+
+  if (priv->highlight)
+    {
+      highlight_free (buffer, priv->highlight);
+      priv->highlight = NULL;
+    }
+}
+
+/* Tags the next batch of the matches found with the search index */
+static void
+highlight_scan (BtkTextBuffer *buffer)
+{
+  BtkTextBufferPrivate *priv = BTK_TEXT_BUFFER_GET_PRIVATE (buffer);
+  BtkTextBufferHighlight *highlight = priv->highlight;
+  BtkTextBufferIndex *index;
+  BtkTextIter start, end;
+  buint last;
+
+  index = search_index_get (buffer);
+
+  if (highlight->matches == NULL || highlight->stamp != index->stamp)
+    {
+      /* Text inserted after done may have come with the tag */
+      btk_text_buffer_get_iter_at_mark (buffer, &start, highlight->done);
+      btk_text_buffer_get_end_iter (buffer, &end);
+      btk_text_buffer_remove_tag (buffer, highlight->tag, &start, &end);
+
+      if (highlight->matches)
+        g_array_free (highlight->matches, TRUE);
+
+      highlight->matches = search_index_find_all (index, highlight->str,
+                                                  highlight->flags,
+                                                  search_index_iter_to_offset (index, &start),
+                                                  index->len);
+      highlight->stamp = index->stamp;
+      highlight->next = 0;
+    }
+
+  last = MIN (highlight->next + 2 * HIGHLIGHT_BATCH_SIZE, highlight->matches->len);
+
+  _btk_text_btree_freeze_tag_redisplay (get_btree (buffer));
+
+  for (; highlight->next < last; highlight->next += 2)
+    {
+      search_index_offset_to_iter (buffer, index,
+                                   g_array_index (highlight->matches, bsize, highlight->next),
+                                   &start);
+      search_index_offset_to_iter (buffer, index,
+                                   g_array_index (highlight->matches, bsize, highlight->next + 1),
+                                   &end);
+      btk_text_buffer_apply_tag (buffer, highlight->tag, &start, &end);
+    }
+
+  _btk_text_btree_thaw_tag_redisplay (get_btree (buffer));
+
+  if (highlight->next < highlight->matches->len)
+    {
+      _btk_text_btree_set_mark (get_btree (buffer), highlight->done, NULL,
+                                TRUE, &end, TRUE);
+      return;
+    }
+
+  btk_text_buffer_get_end_iter (buffer, &end);
+  _btk_text_btree_set_mark (get_btree (buffer), highlight->done, NULL,
+                            TRUE, &end, TRUE);
+
+  highlight->scanning = FALSE;
+  g_array_free (highlight->matches, TRUE);
+  highlight->matches = NULL;
+}
+
+/* Searches the lines around the edits again, without the index,
+ * which would have to be made anew for every edit.
+ */
+static void
+highlight_rescan_damage (BtkTextBuffer *buffer)
+{
+  BtkTextBufferPrivate *priv = BTK_TEXT_BUFFER_GET_PRIVATE (buffer);
+  BtkTextBufferHighlight *highlight = priv->highlight;
+  GSList *l;
+
+  _btk_text_btree_freeze_tag_redisplay (get_btree (buffer));
+
+  for (l = highlight->damage; l; l = l->next->next)
+    {
+      BtkTextIter start, end;
+      BtkTextIter search, limit;
+      BtkTextIter match_start, match_end;
+
+      btk_text_buffer_get_iter_at_mark (buffer, &start, l->data);
+      btk_text_buffer_get_iter_at_mark (buffer, &end, l->next->data);
+
+      /* The range holds every match that touched an edit; matches
+       * reaching into it from around it are tagged again in full.
+       */
+      btk_text_buffer_remove_tag (buffer, highlight->tag, &start, &end);
+
+      search = start;
+      btk_text_iter_backward_lines (&search, highlight->n_newlines);
+      limit = end;
+      btk_text_iter_forward_lines (&limit, highlight->n_newlines);
+
+      while (btk_text_iter_forward_search (&search, highlight->str,
+                                           highlight->flags,
+                                           &match_start, &match_end,
+                                           &limit))
+        {
+          btk_text_buffer_apply_tag (buffer, highlight->tag,
+                                     &match_start, &match_end);
+          search = match_end;
+        }
+    }
+
+  _btk_text_btree_thaw_tag_redisplay (get_btree (buffer));
+
+  highlight_forget_damage (buffer, highlight);
+}
+
+static bboolean
+highlight_idle (bpointer data)
+{
+  BtkTextBuffer *buffer = data;
+  BtkTextBufferPrivate *priv = BTK_TEXT_BUFFER_GET_PRIVATE (buffer);
+  BtkTextBufferHighlight *highlight = priv->highlight;
+
+  if (highlight->scanning)
+    {
+      highlight_scan (buffer);
+      if (highlight->scanning)
+        return TRUE;
+    }
+
+  highlight_rescan_damage (buffer);
+
+  /* Done until the text changes again */
+  highlight->idle_id = 0;
+
+  return FALSE;
+}
+
+static void
+highlight_queue (BtkTextBuffer *buffer)
+{
+  BtkTextBufferPrivate *priv = BTK_TEXT_BUFFER_GET_PRIVATE (buffer);
+  BtkTextBufferHighlight *highlight = priv->highlight;
+
+  if (highlight->idle_id == 0)
+    highlight->idle_id = bdk_threads_add_idle_full (G_PRIORITY_DEFAULT_IDLE,
+                                                    highlight_idle,
+                                                    buffer, NULL);
+}
+
+/* Finds all the matches again with the search index */
+static void
+highlight_restart (BtkTextBuffer *buffer)
+{
+  BtkTextBufferPrivate *priv = BTK_TEXT_BUFFER_GET_PRIVATE (buffer);
+  BtkTextBufferHighlight *highlight = priv->highlight;
+  BtkTextIter start;
+
+  highlight_forget_damage (buffer, highlight);
+
+  btk_text_buffer_get_start_iter (buffer, &start);
+  _btk_text_btree_set_mark (get_btree (buffer), highlight->done, NULL,
+                            TRUE, &start, TRUE);
+
+  highlight->scanning = TRUE;
+  if (highlight->matches)
+    g_array_free (highlight->matches, TRUE);
+  highlight->matches = NULL;
+
+  highlight_queue (buffer);
+}
+
+/* Called when the text from the start of @start_line to @end changed */
+static void
+highlight_damage (BtkTextBuffer     *buffer,
+                  bint               start_line,
+                  const BtkTextIter *end)
+{
+  BtkTextBufferPrivate *priv = BTK_TEXT_BUFFER_GET_PRIVATE (buffer);
+  BtkTextBufferHighlight *highlight = priv->highlight;
+  BtkTextBTree *tree;
+  BtkTextIter line_start, line_end;
+  bboolean merged = FALSE;
+
+  if (highlight == NULL)
+    return;
+
+  /* A match can't reach further than this from the edit */
+  btk_text_buffer_get_iter_at_line (buffer, &line_start, start_line);
+  btk_text_iter_backward_lines (&line_start, highlight->n_newlines);
+  line_end = *end;
+  btk_text_iter_forward_line (&line_end);
+  btk_text_iter_forward_lines (&line_end, highlight->n_newlines);
+
+  tree = get_btree (buffer);
+
+  /* Typing keeps growing the same range */
+  if (highlight->damage)
+    {
+      BtkTextMark *last_start = highlight->damage->data;
+      BtkTextMark *last_end = highlight->damage->next->data;
+      BtkTextIter start, stop;
+
+      btk_text_buffer_get_iter_at_mark (buffer, &start, last_start);
+      btk_text_buffer_get_iter_at_mark (buffer, &stop, last_end);
+
+      if (btk_text_iter_compare (&line_start, &stop) <= 0 &&
+          btk_text_iter_compare (&line_end, &start) >= 0)
+        {
+          if (btk_text_iter_compare (&line_start, &start) < 0)
+            _btk_text_btree_set_mark (tree, last_start, NULL,
+                                      TRUE, &line_start, TRUE);
+          else
+            line_start = start;
+
+          if (btk_text_iter_compare (&line_end, &stop) > 0)
+            _btk_text_btree_set_mark (tree, last_end, NULL,
+                                      FALSE, &line_end, TRUE);
+          else
+            line_end = stop;
+
+          merged = TRUE;
+        }
+    }
+
+  if ((!merged && highlight->n_damage >= HIGHLIGHT_MAX_DAMAGE) ||
+      btk_text_iter_get_line (&line_end) -
+      btk_text_iter_get_line (&line_start) > HIGHLIGHT_MAX_DAMAGE_LINES)
+    {
+      highlight_restart (buffer);
+      return;
+    }
+
+  if (!merged)
+    {
+      /* The range grows with text inserted at either end */
+      highlight->damage = b_slist_prepend (highlight->damage,
+                                           _btk_text_btree_set_mark (tree, NULL, NULL,
+                                                                     FALSE, &line_end,
+                                                                     FALSE));
+      highlight->damage = b_slist_prepend (highlight->damage,
+                                           _btk_text_btree_set_mark (tree, NULL, NULL,
+                                                                     TRUE, &line_start,
+                                                                     FALSE));
+      highlight->n_damage++;
+    }
+
+  highlight_queue (buffer);
+}
+
+/**
+ * btk_text_buffer_highlight_all:
+ * @buffer: a #BtkTextBuffer
+ * @tag: a #BtkTextTag in the tag table of @buffer
+ * @str: (allow-none): a search string, or %NULL to stop highlighting
+ * @flags: flags affecting how the search is done
+ *
+ * Applies @tag to all the occurrences of @str in @buffer, as found
+ * by btk_text_buffer_find_all(), and removes it everywhere else.
+ *
+ * The tag is applied from the main loop, a few hundred matches at a
+ * time, so that highlighting a search in a large buffer does not
+ * block the user interface.  The highlight follows changes to the
+ * text, searching the lines around every edit again, until this
+ * function is called again, or with %NULL for @str, which just
+ * removes @tag from the buffer.
+ *
+ * Since: 2.24.34
+ **/
+void
+btk_text_buffer_highlight_all (BtkTextBuffer      *buffer,
+                               BtkTextTag         *tag,
+                               const bchar        *str,
+                               BtkTextSearchFlags  flags)
+{
+  BtkTextBufferPrivate *priv;
+  BtkTextBufferHighlight *highlight;
+  BtkTextIter start, end;
+
+  g_return_if_fail (BTK_IS_TEXT_BUFFER (buffer));
+  g_return_if_fail (BTK_IS_TEXT_TAG (tag));
+  g_return_if_fail (tag->table == buffer->tag_table);
+  g_return_if_fail ((flags & (BTK_TEXT_SEARCH_VISIBLE_ONLY |
+                              BTK_TEXT_SEARCH_TEXT_ONLY)) == 0);
+
+  priv = BTK_TEXT_BUFFER_GET_PRIVATE (buffer);
+
+  highlight_stop (buffer);
+
+  btk_text_buffer_get_bounds (buffer, &start, &end);
+  btk_text_buffer_remove_tag (buffer, tag, &start, &end);
+
+  if (str == NULL || *str == '\0')
+    return;
+
+  highlight = g_new0 (BtkTextBufferHighlight, 1);
+  highlight->tag = g_object_ref (tag);
+  highlight->str = g_strdup (str);
+  highlight->flags = flags;
+  for (; *str; str++)
+    if (*str == '\n')
+      highlight->n_newlines++;
+
+  highlight->scanning = TRUE;
+  highlight->done = _btk_text_btree_set_mark (get_btree (buffer), NULL, NULL,
+                                              TRUE, &start, FALSE);
+
+  priv->highlight = highlight;
+  highlight_queue (buffer);
+}
+
+
+/*
+ * Obtain various iterators
+ */
+
+/**
+ * btk_text_buffer_get_iter_at_line_offset:
+ * @buffer: a #BtkTextBuffer
+ * @iter: (out): iterator to initialize
+ * @line_number: line number counting from 0
+ * @char_offset: char offset from start of line
+ *
+ * Obtains an iterator pointing to @char_offset within the given
+ * line. The @char_offset must exist, offsets off the end of the line
+ * are not allowed. Note <emphasis>characters</emphasis>, not bytes;
+ * UTF-8 may encode one character as multiple bytes.
+ **/
+void
+btk_text_buffer_get_iter_at_line_offset (BtkTextBuffer *buffer,
+                                         BtkTextIter   *iter,
+                                         bint           line_number,
+                                         bint           char_offset)
+{
+  g_return_if_fail (iter != NULL);
+  g_return_if_fail (BTK_IS_TEXT_BUFFER (buffer));
+
+  _btk_text_btree_get_iter_at_line_char (get_btree (buffer),
+                                         iter, line_number, char_offset);
+}
+
+/**
+ * btk_text_buffer_get_iter_at_line_index:
+ * @buffer: a #BtkTextBuffer 
+ * @iter: (out): iterator to initialize 
+ * @line_number: line number counting from 0
+ * @byte_index: byte index from start of line
+ *
+ * Obtains an iterator pointing to @byte_index within the given line.
  * @byte_index must be the start of a UTF-8 character, and must not be
  * beyond the end of the line.  Note <emphasis>bytes</emphasis>, not
  * characters; UTF-8 may encode one character as multiple bytes.
@@ -3414,10 +4908,6 @@ selection_data_get_buffer (BtkSelectionData *selection_data,
   
   g_return_val_if_fail (BTK_IS_TEXT_BUFFER (src_buffer), NULL);
 
-  if (btk_text_buffer_get_tag_table (src_buffer) !=
-      btk_text_buffer_get_tag_table (request_data->buffer))
-    return NULL;
-  
   return src_buffer;
 }
 
@@ -3503,12 +4993,19 @@ clipboard_rich_text_received (BtkClipboard *clipboard,
                               data);
 }
 
+/* Pastes the text between @start and @end of @src_buffer.  If the
+ * buffers have different tag tables, @compact_format is the shared
+ * rich text format to paste the text in, see
+ * _btk_text_buffer_get_compact_format().
+ */
 static void
 paste_from_buffer (BtkClipboard      *clipboard,
                    ClipboardRequest  *request_data,
                    BtkTextBuffer     *src_buffer,
                    const BtkTextIter *start,
-                   const BtkTextIter *end)
+                   const BtkTextIter *end,
+                   BtkTextBuffer     *register_buffer,
+                   BdkAtom            compact_format)
 {
   BtkTextIter insert_point;
   BtkTextBuffer *buffer = request_data->buffer;
@@ -3521,11 +5018,25 @@ paste_from_buffer (BtkClipboard      *clipboard,
   if (request_data->interactive) 
     btk_text_buffer_begin_user_action (buffer);
 
-  if (!btk_text_iter_equal (start, end))
+  if (!btk_text_iter_equal (start, end) &&
+      (!request_data->interactive ||
+       btk_text_iter_can_insert (&insert_point,
+                                 request_data->default_editable)))
     {
-      if (!request_data->interactive ||
-          (btk_text_iter_can_insert (&insert_point,
-                                     request_data->default_editable)))
+      if (compact_format != BDK_NONE)
+        {
+          GError *error = NULL;
+
+          if (!_btk_text_buffer_paste_compact (buffer, compact_format,
+                                               &insert_point,
+                                               register_buffer, src_buffer,
+                                               start, end, &error))
+            {
+              g_warning ("error pasting: %s\n", error->message);
+              g_clear_error (&error);
+            }
+        }
+      else
         btk_text_buffer_real_insert_range (buffer,
                                            &insert_point,
                                            start,
@@ -3552,9 +5063,30 @@ clipboard_clipboard_buffer_received (BtkClipboard     *clipboard,
 {
   ClipboardRequest *request_data = data;
   BtkTextBuffer *src_buffer;
+  BtkTextBuffer *register_buffer = NULL;
+  BdkAtom compact_format = BDK_NONE;
 
   src_buffer = selection_data_get_buffer (selection_data, request_data); 
 
+  /* Between buffers with different tag tables within the process,
+   * paste rich text in the compact format rather than having it
+   * serialized to XML and parsed again through the selection.
+   */
+  if (src_buffer &&
+      btk_text_buffer_get_tag_table (src_buffer) !=
+      btk_text_buffer_get_tag_table (request_data->buffer))
+    {
+      register_buffer = g_object_get_data (B_OBJECT (src_buffer),
+                                           "btk-text-buffer-clipboard-source");
+      if (register_buffer == NULL)
+        register_buffer = src_buffer;
+
+      compact_format = _btk_text_buffer_get_compact_format (register_buffer,
+                                                            request_data->buffer);
+      if (compact_format == BDK_NONE)
+        src_buffer = NULL;
+    }
+
   if (src_buffer)
     {
       BtkTextIter start, end;
@@ -3564,13 +5096,13 @@ clipboard_clipboard_buffer_received (BtkClipboard     *clipboard,
 	  btk_text_buffer_get_bounds (src_buffer, &start, &end);
 
 	  paste_from_buffer (clipboard, request_data, src_buffer,
-			     &start, &end);
+			     &start, &end, register_buffer, compact_format);
 	}
       else
 	{
 	  if (btk_text_buffer_get_selection_bounds (src_buffer, &start, &end))
 	    paste_from_buffer (clipboard, request_data, src_buffer,
-			       &start, &end);
+			       &start, &end, register_buffer, compact_format);
 	}
     }
   else
@@ -4395,6 +5927,11 @@ _btk_text_buffer_notify_will_remove_tag (BtkTextBuffer *buffer,
    * code messing things up at this point; the tag MUST be removed
    * entirely.
    */
+  BtkTextBufferPrivate *priv = BTK_TEXT_BUFFER_GET_PRIVATE (buffer);
+
+  if (priv->highlight && priv->highlight->tag == tag)
+    highlight_stop (buffer);
+
   if (buffer->btree)
     _btk_text_btree_notify_will_remove_tag (buffer->btree, tag);
 }
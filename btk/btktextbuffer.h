@@ -62,6 +62,41 @@ typedef struct _BtkTextBTree BtkTextBTree;
 
 typedef struct _BtkTextLogAttrCache BtkTextLogAttrCache;
 
+typedef struct _BtkTextBufferMatch BtkTextBufferMatch;
+typedef struct _BtkTextBufferTagRange BtkTextBufferTagRange;
+
+/**
+ * BtkTextBufferMatch:
+ * @start_offset: character offset of the start of the match
+ * @end_offset: character offset of the end of the match
+ *
+ * A match found by btk_text_buffer_find_all().
+ *
+ * Since: 2.24.34
+ */
+struct _BtkTextBufferMatch
+{
+  bint start_offset;
+  bint end_offset;
+};
+
+/**
+ * BtkTextBufferTagRange:
+ * @tag: the #BtkTextTag to apply
+ * @start_offset: character offset of one end of the range
+ * @end_offset: character offset of the other end of the range
+ *
+ * A range to tag with btk_text_buffer_apply_tag_ranges().
+ *
+ * Since: 2.24.34
+ */
+struct _BtkTextBufferTagRange
+{
+  BtkTextTag *tag;
+  bint start_offset;
+  bint end_offset;
+};
+
 #define BTK_TYPE_TEXT_BUFFER            (btk_text_buffer_get_type ())
 #define BTK_TEXT_BUFFER(obj)            (B_TYPE_CHECK_INSTANCE_CAST ((obj), BTK_TYPE_TEXT_BUFFER, BtkTextBuffer))
 #define BTK_TEXT_BUFFER_CLASS(klass)    (B_TYPE_CHECK_CLASS_CAST ((klass), BTK_TYPE_TEXT_BUFFER, BtkTextBufferClass))
@@ -171,6 +206,11 @@ void btk_text_buffer_set_text          (BtkTextBuffer *buffer,
                                         const bchar   *text,
                                         bint           len);
 
+/* Delete whole buffer, then insert the contents of a stream */
+void btk_text_buffer_load_stream       (BtkTextBuffer *buffer,
+                                        GInputStream  *stream,
+                                        GCancellable  *cancellable);
+
 /* Insert into the buffer */
 void btk_text_buffer_insert            (BtkTextBuffer *buffer,
                                         BtkTextIter   *iter,
@@ -306,6 +346,20 @@ void btk_text_buffer_remove_tag_by_name    (BtkTextBuffer     *buffer,
 void btk_text_buffer_remove_all_tags       (BtkTextBuffer     *buffer,
                                             const BtkTextIter *start,
                                             const BtkTextIter *end);
+void btk_text_buffer_apply_tag_ranges      (BtkTextBuffer               *buffer,
+                                            const BtkTextBufferTagRange *ranges,
+                                            bint                         n_ranges);
+
+/* Searching */
+GArray *btk_text_buffer_find_all           (BtkTextBuffer      *buffer,
+                                            const bchar        *str,
+                                            BtkTextSearchFlags  flags,
+                                            const BtkTextIter  *start,
+                                            const BtkTextIter  *end);
+void    btk_text_buffer_highlight_all      (BtkTextBuffer      *buffer,
+                                            BtkTextTag         *tag,
+                                            const bchar        *str,
+                                            BtkTextSearchFlags  flags);
 
 
 /* You can either ignore the return value, or use it to
@@ -404,6 +458,16 @@ const BangoLogAttr* _btk_text_buffer_get_line_log_attrs (BtkTextBuffer     *buff
 void _btk_text_buffer_notify_will_remove_tag (BtkTextBuffer *buffer,
                                               BtkTextTag    *tag);
 
+bboolean _btk_text_buffer_has_search_index (BtkTextBuffer      *buffer);
+bboolean _btk_text_buffer_search           (BtkTextBuffer      *buffer,
+                                            const BtkTextIter  *iter,
+                                            const bchar        *str,
+                                            BtkTextSearchFlags  flags,
+                                            bboolean            backward,
+                                            BtkTextIter        *match_start,
+                                            BtkTextIter        *match_end,
+                                            const BtkTextIter  *limit);
+
 B_END_DECLS
 
 #endif
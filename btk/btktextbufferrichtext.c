@@ -39,6 +39,15 @@ typedef struct
   GDestroyNotify  user_data_destroy;
 } BtkRichTextFormat;
 
+typedef struct
+{
+  GSList      *tags;
+  BtkTextMark *left_end;
+  BtkTextMark *right_start;
+  GSList      *left_start_list;
+  GSList      *right_end_list;
+} SplitTags;
+
 
 static GList   * register_format   (GList             *formats,
                                     const bchar       *mime_type,
@@ -54,6 +63,14 @@ static void      free_format       (BtkRichTextFormat *format);
 static void      free_format_list  (GList             *formats);
 static GQuark    serialize_quark   (void);
 static GQuark    deserialize_quark (void);
+static BtkRichTextFormat *
+                 find_format       (GList             *formats,
+                                    BdkAtom            atom);
+static void      split_tags_at_iter (BtkTextBuffer    *content_buffer,
+                                     BtkTextIter      *iter,
+                                     SplitTags        *split);
+static void      rejoin_split_tags (BtkTextBuffer     *content_buffer,
+                                    SplitTags         *split);
 
 
 /**
@@ -567,79 +584,10 @@ btk_text_buffer_deserialize (BtkTextBuffer  *register_buffer,
       if (fmt->atom == format)
         {
           BtkTextBufferDeserializeFunc function = fmt->function;
+          SplitTags                    split;
           bboolean                     success;
-          GSList                      *split_tags;
-          GSList                      *list;
-          BtkTextMark                 *left_end        = NULL;
-          BtkTextMark                 *right_start     = NULL;
-          GSList                      *left_start_list = NULL;
-          GSList                      *right_end_list  = NULL;
-
-          /*  We don't want the tags that are effective at the insertion
-           *  point to affect the pasted text, therefore we remove and
-           *  remember them, so they can be re-applied left and right of
-           *  the inserted text after pasting
-           */
-          split_tags = btk_text_iter_get_tags (iter);
-
-          list = split_tags;
-          while (list)
-            {
-              BtkTextTag *tag = list->data;
 
-              list = b_slist_next (list);
-
-              /*  If a tag begins at the insertion point, ignore it
-               *  because it doesn't affect the pasted text
-               */
-              if (btk_text_iter_begins_tag (iter, tag))
-                split_tags = b_slist_remove (split_tags, tag);
-            }
-
-          if (split_tags)
-            {
-              /*  Need to remember text marks, because text iters
-               *  don't survive pasting
-               */
-              left_end = btk_text_buffer_create_mark (content_buffer,
-                                                      NULL, iter, TRUE);
-              right_start = btk_text_buffer_create_mark (content_buffer,
-                                                         NULL, iter, FALSE);
-
-              for (list = split_tags; list; list = b_slist_next (list))
-                {
-                  BtkTextTag  *tag             = list->data;
-                  BtkTextIter *backward_toggle = btk_text_iter_copy (iter);
-                  BtkTextIter *forward_toggle  = btk_text_iter_copy (iter);
-                  BtkTextMark *left_start      = NULL;
-                  BtkTextMark *right_end       = NULL;
-
-                  btk_text_iter_backward_to_tag_toggle (backward_toggle, tag);
-                  left_start = btk_text_buffer_create_mark (content_buffer,
-                                                            NULL,
-                                                            backward_toggle,
-                                                            FALSE);
-
-                  btk_text_iter_forward_to_tag_toggle (forward_toggle, tag);
-                  right_end = btk_text_buffer_create_mark (content_buffer,
-                                                           NULL,
-                                                           forward_toggle,
-                                                           TRUE);
-
-                  left_start_list = b_slist_prepend (left_start_list, left_start);
-                  right_end_list = b_slist_prepend (right_end_list, right_end);
-
-                  btk_text_buffer_remove_tag (content_buffer, tag,
-                                              backward_toggle,
-                                              forward_toggle);
-
-                  btk_text_iter_free (forward_toggle);
-                  btk_text_iter_free (backward_toggle);
-                }
-
-              left_start_list = b_slist_reverse (left_start_list);
-              right_end_list = b_slist_reverse (right_end_list);
-            }
+          split_tags_at_iter (content_buffer, iter, &split);
 
           success = function (register_buffer, content_buffer,
                               iter, data, length,
@@ -652,56 +600,7 @@ btk_text_buffer_deserialize (BtkTextBuffer  *register_buffer,
                          _("Unknown error when trying to deserialize %s"),
                          bdk_atom_name (format));
 
-          if (split_tags)
-            {
-              GSList      *left_list;
-              GSList      *right_list;
-              BtkTextIter  left_e;
-              BtkTextIter  right_s;
-
-              /*  Turn the remembered marks back into iters so they
-               *  can by used to re-apply the remembered tags
-               */
-              btk_text_buffer_get_iter_at_mark (content_buffer,
-                                                &left_e, left_end);
-              btk_text_buffer_get_iter_at_mark (content_buffer,
-                                                &right_s, right_start);
-
-              for (list = split_tags,
-                     left_list = left_start_list,
-                     right_list = right_end_list;
-                   list && left_list && right_list;
-                   list = b_slist_next (list),
-                     left_list = b_slist_next (left_list),
-                     right_list = b_slist_next (right_list))
-                {
-                  BtkTextTag  *tag        = list->data;
-                  BtkTextMark *left_start = left_list->data;
-                  BtkTextMark *right_end  = right_list->data;
-                  BtkTextIter  left_s;
-                  BtkTextIter  right_e;
-
-                  btk_text_buffer_get_iter_at_mark (content_buffer,
-                                                    &left_s, left_start);
-                  btk_text_buffer_get_iter_at_mark (content_buffer,
-                                                    &right_e, right_end);
-
-                  btk_text_buffer_apply_tag (content_buffer, tag,
-                                             &left_s, &left_e);
-                  btk_text_buffer_apply_tag (content_buffer, tag,
-                                             &right_s, &right_e);
-
-                  btk_text_buffer_delete_mark (content_buffer, left_start);
-                  btk_text_buffer_delete_mark (content_buffer, right_end);
-                }
-
-              btk_text_buffer_delete_mark (content_buffer, left_end);
-              btk_text_buffer_delete_mark (content_buffer, right_start);
-
-              b_slist_free (split_tags);
-              b_slist_free (left_start_list);
-              b_slist_free (right_end_list);
-            }
+          rejoin_split_tags (content_buffer, &split);
 
           return success;
         }
@@ -715,8 +614,415 @@ btk_text_buffer_deserialize (BtkTextBuffer  *register_buffer,
 }
 
 
+/**
+ * btk_text_buffer_serialize_to_stream:
+ * @register_buffer: the #BtkTextBuffer @format is registered with
+ * @content_buffer: the #BtkTextBuffer to serialize
+ * @format: the rich text format to use for serializing
+ * @start: start of block of text to serialize
+ * @end: end of block of text to serialize
+ * @stream: the #GOutputStream to write to
+ * @cancellable: (allow-none): a #GCancellable, or %NULL
+ * @error: return location for a #GError
+ *
+ * Like btk_text_buffer_serialize(), but writes the serialized data
+ * to @stream.
+ *
+ * For BTK+'s internal rich text format (see
+ * btk_text_buffer_register_serialize_tagset()) the data is written
+ * as it is produced, so only a small part of it is held in memory at
+ * any time, no matter how much text is serialized.  Other formats are
+ * serialized in memory first.
+ *
+ * Return value: %TRUE on success, %FALSE otherwise.
+ *
+ * Since: 2.24.34
+ **/
+bboolean
+btk_text_buffer_serialize_to_stream (BtkTextBuffer     *register_buffer,
+                                     BtkTextBuffer     *content_buffer,
+                                     BdkAtom            format,
+                                     const BtkTextIter *start,
+                                     const BtkTextIter *end,
+                                     GOutputStream     *stream,
+                                     GCancellable      *cancellable,
+                                     GError           **error)
+{
+  BtkRichTextFormat *fmt;
+  BtkTextBufferSerializeFunc function;
+  buint8 *data;
+  bsize length;
+  bboolean success;
+
+  g_return_val_if_fail (BTK_IS_TEXT_BUFFER (register_buffer), FALSE);
+  g_return_val_if_fail (BTK_IS_TEXT_BUFFER (content_buffer), FALSE);
+  g_return_val_if_fail (format != BDK_NONE, FALSE);
+  g_return_val_if_fail (start != NULL, FALSE);
+  g_return_val_if_fail (end != NULL, FALSE);
+  g_return_val_if_fail (G_IS_OUTPUT_STREAM (stream), FALSE);
+  g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+  fmt = find_format (g_object_get_qdata (B_OBJECT (register_buffer),
+                                         serialize_quark ()),
+                     format);
+
+  if (!fmt)
+    {
+      g_set_error (error, 0, 0,
+                   _("No serialize function found for format %s"),
+                   bdk_atom_name (format));
+      return FALSE;
+    }
+
+  if (fmt->function == (bpointer) _btk_text_buffer_serialize_rich_text)
+    return _btk_text_buffer_serialize_rich_text_to_stream (content_buffer,
+                                                           start, end,
+                                                           stream,
+                                                           cancellable,
+                                                           error);
+
+  function = fmt->function;
+  data = function (register_buffer, content_buffer,
+                   start, end, &length, fmt->user_data);
+
+  if (!data)
+    {
+      g_set_error (error, 0, 0,
+                   _("Unknown error when trying to serialize %s"),
+                   bdk_atom_name (format));
+      return FALSE;
+    }
+
+  success = g_output_stream_write_all (stream, data, length, NULL,
+                                       cancellable, error);
+  g_free (data);
+
+  return success;
+}
+
+/**
+ * btk_text_buffer_deserialize_from_stream:
+ * @register_buffer: the #BtkTextBuffer @format is registered with
+ * @content_buffer: the #BtkTextBuffer to deserialize into
+ * @format: the rich text format to use for deserializing
+ * @iter: insertion point for the deserialized text
+ * @stream: the #GInputStream to read from
+ * @cancellable: (allow-none): a #GCancellable, or %NULL
+ * @error: return location for a #GError
+ *
+ * Like btk_text_buffer_deserialize(), but reads the data from
+ * @stream, up to its end.
+ *
+ * For BTK+'s internal rich text format (see
+ * btk_text_buffer_register_deserialize_tagset()) the stream is read
+ * in chunks, and text is inserted as soon as it has been parsed, so
+ * the data never has to be held in memory as a whole.  If an error
+ * occurs, the text inserted up to that point is removed again.  Other
+ * formats are read into memory first.
+ *
+ * Return value: %TRUE on success, %FALSE otherwise.
+ *
+ * Since: 2.24.34
+ **/
+bboolean
+btk_text_buffer_deserialize_from_stream (BtkTextBuffer  *register_buffer,
+                                         BtkTextBuffer  *content_buffer,
+                                         BdkAtom         format,
+                                         BtkTextIter    *iter,
+                                         GInputStream   *stream,
+                                         GCancellable   *cancellable,
+                                         GError        **error)
+{
+  BtkRichTextFormat *fmt;
+  GOutputStream *memory;
+  SplitTags split;
+  bboolean success;
+
+  g_return_val_if_fail (BTK_IS_TEXT_BUFFER (register_buffer), FALSE);
+  g_return_val_if_fail (BTK_IS_TEXT_BUFFER (content_buffer), FALSE);
+  g_return_val_if_fail (format != BDK_NONE, FALSE);
+  g_return_val_if_fail (iter != NULL, FALSE);
+  g_return_val_if_fail (G_IS_INPUT_STREAM (stream), FALSE);
+  g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+  fmt = find_format (g_object_get_qdata (B_OBJECT (register_buffer),
+                                         deserialize_quark ()),
+                     format);
+
+  if (!fmt)
+    {
+      g_set_error (error, 0, 0,
+                   _("No deserialize function found for format %s"),
+                   bdk_atom_name (format));
+      return FALSE;
+    }
+
+  if (fmt->function != (bpointer) _btk_text_buffer_deserialize_rich_text)
+    {
+      memory = g_memory_output_stream_new (NULL, 0, g_realloc, g_free);
+
+      success = g_output_stream_splice (memory, stream,
+                                        G_OUTPUT_STREAM_SPLICE_CLOSE_TARGET,
+                                        cancellable, error) >= 0;
+
+      if (success)
+        {
+          GMemoryOutputStream *data = G_MEMORY_OUTPUT_STREAM (memory);
+
+          if (g_memory_output_stream_get_data_size (data) == 0)
+            {
+              g_set_error (error, 0, 0,
+                           _("Unknown error when trying to deserialize %s"),
+                           bdk_atom_name (format));
+              success = FALSE;
+            }
+          else
+            success = btk_text_buffer_deserialize (register_buffer,
+                                                   content_buffer,
+                                                   format, iter,
+                                                   g_memory_output_stream_get_data (data),
+                                                   g_memory_output_stream_get_data_size (data),
+                                                   error);
+        }
+
+      g_object_unref (memory);
+
+      return success;
+    }
+
+  split_tags_at_iter (content_buffer, iter, &split);
+
+  success = _btk_text_buffer_deserialize_rich_text_from_stream (content_buffer,
+                                                                iter, stream,
+                                                                fmt->can_create_tags,
+                                                                cancellable,
+                                                                error);
+
+  rejoin_split_tags (content_buffer, &split);
+
+  return success;
+}
+
+/* Returns the internal rich text format that @buffer deserializes
+ * and @register_buffer serializes, with the same tagset, or
+ * %BDK_NONE.  Text between such buffers can be pasted with the
+ * compact format instead.
+ */
+BdkAtom
+_btk_text_buffer_get_compact_format (BtkTextBuffer *register_buffer,
+                                     BtkTextBuffer *buffer)
+{
+  GList *serialize_formats;
+  GList *list;
+
+  serialize_formats = g_object_get_qdata (B_OBJECT (register_buffer),
+                                          serialize_quark ());
+
+  for (list = g_object_get_qdata (B_OBJECT (buffer), deserialize_quark ());
+       list;
+       list = g_list_next (list))
+    {
+      BtkRichTextFormat *fmt = list->data;
+      BtkRichTextFormat *serialize_fmt;
+
+      if (fmt->function != (bpointer) _btk_text_buffer_deserialize_rich_text)
+        continue;
+
+      serialize_fmt = find_format (serialize_formats, fmt->atom);
+
+      if (serialize_fmt &&
+          serialize_fmt->function == (bpointer) _btk_text_buffer_serialize_rich_text)
+        return fmt->atom;
+    }
+
+  return BDK_NONE;
+}
+
+/* Inserts the text between @start and @end of @src_buffer at @iter,
+ * as if it had been serialized in @format for @register_buffer and
+ * deserialized, but using the compact format.
+ */
+bboolean
+_btk_text_buffer_paste_compact (BtkTextBuffer     *buffer,
+                                BdkAtom            format,
+                                BtkTextIter       *iter,
+                                BtkTextBuffer     *register_buffer,
+                                BtkTextBuffer     *src_buffer,
+                                const BtkTextIter *start,
+                                const BtkTextIter *end,
+                                GError           **error)
+{
+  BtkRichTextFormat *fmt;
+  SplitTags split;
+  buint8 *data;
+  bsize length;
+  bboolean success;
+
+  fmt = find_format (g_object_get_qdata (B_OBJECT (buffer),
+                                         deserialize_quark ()),
+                     format);
+
+  g_return_val_if_fail (fmt != NULL, FALSE);
+
+  data = _btk_text_buffer_serialize_compact (register_buffer, src_buffer,
+                                             start, end, &length, NULL);
+
+  split_tags_at_iter (buffer, iter, &split);
+
+  success = _btk_text_buffer_deserialize_compact (buffer, buffer, iter,
+                                                  data, length,
+                                                  fmt->can_create_tags,
+                                                  NULL, error);
+
+  rejoin_split_tags (buffer, &split);
+
+  g_free (data);
+
+  return success;
+}
+
+
 /*  private functions  */
 
+/*  We don't want the tags that are effective at the insertion
+ *  point to affect the pasted text, therefore we remove and
+ *  remember them, so they can be re-applied left and right of
+ *  the inserted text after pasting
+ */
+static void
+split_tags_at_iter (BtkTextBuffer *content_buffer,
+                    BtkTextIter   *iter,
+                    SplitTags     *split)
+{
+  GSList *split_tags;
+  GSList *list;
+
+  split->left_end        = NULL;
+  split->right_start     = NULL;
+  split->left_start_list = NULL;
+  split->right_end_list  = NULL;
+
+  split_tags = btk_text_iter_get_tags (iter);
+
+  list = split_tags;
+  while (list)
+    {
+      BtkTextTag *tag = list->data;
+
+      list = b_slist_next (list);
+
+      /*  If a tag begins at the insertion point, ignore it
+       *  because it doesn't affect the pasted text
+       */
+      if (btk_text_iter_begins_tag (iter, tag))
+        split_tags = b_slist_remove (split_tags, tag);
+    }
+
+  split->tags = split_tags;
+
+  if (!split_tags)
+    return;
+
+  /*  Need to remember text marks, because text iters
+   *  don't survive pasting
+   */
+  split->left_end = btk_text_buffer_create_mark (content_buffer,
+                                                 NULL, iter, TRUE);
+  split->right_start = btk_text_buffer_create_mark (content_buffer,
+                                                    NULL, iter, FALSE);
+
+  for (list = split_tags; list; list = b_slist_next (list))
+    {
+      BtkTextTag  *tag             = list->data;
+      BtkTextIter *backward_toggle = btk_text_iter_copy (iter);
+      BtkTextIter *forward_toggle  = btk_text_iter_copy (iter);
+      BtkTextMark *left_start      = NULL;
+      BtkTextMark *right_end       = NULL;
+
+      btk_text_iter_backward_to_tag_toggle (backward_toggle, tag);
+      left_start = btk_text_buffer_create_mark (content_buffer,
+                                                NULL,
+                                                backward_toggle,
+                                                FALSE);
+
+      btk_text_iter_forward_to_tag_toggle (forward_toggle, tag);
+      right_end = btk_text_buffer_create_mark (content_buffer,
+                                               NULL,
+                                               forward_toggle,
+                                               TRUE);
+
+      split->left_start_list = b_slist_prepend (split->left_start_list, left_start);
+      split->right_end_list = b_slist_prepend (split->right_end_list, right_end);
+
+      btk_text_buffer_remove_tag (content_buffer, tag,
+                                  backward_toggle,
+                                  forward_toggle);
+
+      btk_text_iter_free (forward_toggle);
+      btk_text_iter_free (backward_toggle);
+    }
+
+  split->left_start_list = b_slist_reverse (split->left_start_list);
+  split->right_end_list = b_slist_reverse (split->right_end_list);
+}
+
+static void
+rejoin_split_tags (BtkTextBuffer *content_buffer,
+                   SplitTags     *split)
+{
+  GSList      *list;
+  GSList      *left_list;
+  GSList      *right_list;
+  BtkTextIter  left_e;
+  BtkTextIter  right_s;
+
+  if (!split->tags)
+    return;
+
+  /*  Turn the remembered marks back into iters so they
+   *  can by used to re-apply the remembered tags
+   */
+  btk_text_buffer_get_iter_at_mark (content_buffer,
+                                    &left_e, split->left_end);
+  btk_text_buffer_get_iter_at_mark (content_buffer,
+                                    &right_s, split->right_start);
+
+  for (list = split->tags,
+         left_list = split->left_start_list,
+         right_list = split->right_end_list;
+       list && left_list && right_list;
+       list = b_slist_next (list),
+         left_list = b_slist_next (left_list),
+         right_list = b_slist_next (right_list))
+    {
+      BtkTextTag  *tag        = list->data;
+      BtkTextMark *left_start = left_list->data;
+      BtkTextMark *right_end  = right_list->data;
+      BtkTextIter  left_s;
+      BtkTextIter  right_e;
+
+      btk_text_buffer_get_iter_at_mark (content_buffer,
+                                        &left_s, left_start);
+      btk_text_buffer_get_iter_at_mark (content_buffer,
+                                        &right_e, right_end);
+
+      btk_text_buffer_apply_tag (content_buffer, tag,
+                                 &left_s, &left_e);
+      btk_text_buffer_apply_tag (content_buffer, tag,
+                                 &right_s, &right_e);
+
+      btk_text_buffer_delete_mark (content_buffer, left_start);
+      btk_text_buffer_delete_mark (content_buffer, right_end);
+    }
+
+  btk_text_buffer_delete_mark (content_buffer, split->left_end);
+  btk_text_buffer_delete_mark (content_buffer, split->right_start);
+
+  b_slist_free (split->tags);
+  b_slist_free (split->left_start_list);
+  b_slist_free (split->right_end_list);
+}
+
 static GList *
 register_format (GList          *formats,
                  const bchar    *mime_type,
@@ -743,6 +1049,23 @@ register_format (GList          *formats,
   return g_list_append (formats, format);
 }
 
+static BtkRichTextFormat *
+find_format (GList   *formats,
+             BdkAtom  atom)
+{
+  GList *list;
+
+  for (list = formats; list; list = g_list_next (list))
+    {
+      BtkRichTextFormat *format = list->data;
+
+      if (format->atom == atom)
+        return format;
+    }
+
+  return NULL;
+}
+
 static GList *
 unregister_format (GList   *formats,
                    BdkAtom  atom)
@@ -91,6 +91,22 @@ bboolean  btk_text_buffer_deserialize                 (BtkTextBuffer
                                                        bsize                         length,
                                                        GError                      **error);
 
+bboolean  btk_text_buffer_serialize_to_stream         (BtkTextBuffer                *register_buffer,
+                                                       BtkTextBuffer                *content_buffer,
+                                                       BdkAtom                       format,
+                                                       const BtkTextIter            *start,
+                                                       const BtkTextIter            *end,
+                                                       GOutputStream                *stream,
+                                                       GCancellable                 *cancellable,
+                                                       GError                      **error);
+bboolean  btk_text_buffer_deserialize_from_stream     (BtkTextBuffer                *register_buffer,
+                                                       BtkTextBuffer                *content_buffer,
+                                                       BdkAtom                       format,
+                                                       BtkTextIter                  *iter,
+                                                       GInputStream                 *stream,
+                                                       GCancellable                 *cancellable,
+                                                       GError                      **error);
+
 B_END_DECLS
 
 #endif /* __BTK_TEXT_BUFFER_RICH_TEXT_H__ */
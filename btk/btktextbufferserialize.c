@@ -36,10 +36,30 @@
 #include "btkalias.h"
 
 
+/* Where serialized data goes.  It is appended to @str, which, when
+ * streaming, is written to @stream whenever it grows past
+ * OUTPUT_CHUNK_SIZE.  With @count_only set nothing is stored at all
+ * and only @length is updated.
+ */
+typedef struct
+{
+  GString       *str;
+  GOutputStream *stream;
+  GCancellable  *cancellable;
+  bsize          length;
+  bboolean       count_only;
+  bboolean       split_text;
+  GError        *error;
+} SerializeOutput;
+
+#define OUTPUT_CHUNK_SIZE 65536
+
+/* Characters of text that are escaped at a time */
+#define TEXT_SLICE_CHARS 16384
+
 typedef struct
 {
-  GString *tag_table_str;
-  GString *text_str;
+  SerializeOutput *out;
   GHashTable *tags;
   BtkTextIter start, end;
 
@@ -49,8 +69,112 @@ typedef struct
   GHashTable *tag_id_tags;
 } SerializationContext;
 
+static void
+output_init (SerializeOutput *out,
+             GString         *str,
+             GOutputStream   *stream,
+             GCancellable    *cancellable)
+{
+  out->str = str;
+  out->stream = stream;
+  out->cancellable = cancellable;
+  out->length = 0;
+  out->count_only = (str == NULL);
+  out->split_text = FALSE;
+  out->error = NULL;
+}
+
+static void
+output_flush (SerializeOutput *out)
+{
+  if (out->stream == NULL || out->error != NULL || out->str->len == 0)
+    return;
+
+  g_output_stream_write_all (out->stream, out->str->str, out->str->len,
+                             NULL, out->cancellable, &out->error);
+  g_string_truncate (out->str, 0);
+}
+
+static void
+output_append_len (SerializeOutput *out,
+                   const bchar     *data,
+                   bsize            len)
+{
+  out->length += len;
+
+  if (out->count_only || out->error != NULL)
+    return;
+
+  g_string_append_len (out->str, data, len);
+
+  if (out->stream && out->str->len >= OUTPUT_CHUNK_SIZE)
+    output_flush (out);
+}
+
+static void
+output_append (SerializeOutput *out,
+               const bchar     *str)
+{
+  output_append_len (out, str, strlen (str));
+}
+
+static void
+output_append_printf (SerializeOutput *out,
+                      const bchar     *format,
+                      ...)
+{
+  va_list args;
+  bchar *str;
+
+  va_start (args, format);
+  str = g_strdup_vprintf (format, args);
+  va_end (args);
+
+  output_append (out, str);
+  g_free (str);
+}
+
+/* Appends the escaped text between @start and @end.  Long runs are
+ * escaped a slice at a time, so that neither the slice nor its
+ * escaped copy grow with the document.  GMarkup only reports text
+ * once it sees the next '<', so when streaming the slices are also
+ * separated by empty comments; otherwise a reader would have to
+ * buffer all of an untagged document before inserting any of it.
+ */
+static void
+output_append_text (SerializeOutput   *out,
+                    const BtkTextIter *start,
+                    const BtkTextIter *end)
+{
+  BtkTextIter slice_start, slice_end;
+
+  slice_start = *start;
+
+  while (btk_text_iter_compare (&slice_start, end) < 0)
+    {
+      bchar *text, *escaped;
+
+      slice_end = slice_start;
+      btk_text_iter_forward_chars (&slice_end, TEXT_SLICE_CHARS);
+      if (btk_text_iter_compare (&slice_end, end) > 0)
+        slice_end = *end;
+
+      if (out->split_text && !btk_text_iter_equal (&slice_start, start))
+        output_append (out, "<!-- -->");
+
+      text = btk_text_iter_get_slice (&slice_start, &slice_end);
+      escaped = g_markup_escape_text (text, -1);
+      output_append (out, escaped);
+      g_free (escaped);
+      g_free (text);
+
+      slice_start = slice_end;
+    }
+}
+
+/* Returns the unescaped string form of @value, or %NULL */
 static bchar *
-serialize_value (BValue *value)
+value_to_string (BValue *value)
 {
   if (b_value_type_transformable (value->g_type, B_TYPE_STRING))
     {
@@ -60,7 +184,7 @@ serialize_value (BValue *value)
       b_value_init (&text_value, B_TYPE_STRING);
       b_value_transform (value, &text_value);
 
-      tmp = g_markup_escape_text (b_value_get_string (&text_value), -1);
+      tmp = g_strdup (b_value_get_string (&text_value));
       b_value_unset (&text_value);
 
       return tmp;
@@ -83,6 +207,21 @@ serialize_value (BValue *value)
   return NULL;
 }
 
+static bchar *
+serialize_value (BValue *value)
+{
+  bchar *str, *escaped;
+
+  str = value_to_string (value);
+  if (str == NULL)
+    return NULL;
+
+  escaped = g_markup_escape_text (str, -1);
+  g_free (str);
+
+  return escaped;
+}
+
 static bboolean
 deserialize_value (const bchar *str,
                    BValue      *value)
@@ -280,6 +419,7 @@ serialize_tag (bpointer key,
                bpointer user_data)
 {
   SerializationContext *context = user_data;
+  SerializeOutput *out = context->out;
   BtkTextTag *tag = data;
   bchar *tag_name;
   bint tag_id;
@@ -287,23 +427,23 @@ serialize_tag (bpointer key,
   buint n_pspecs;
   int i;
 
-  g_string_append (context->tag_table_str, "  <tag ");
+  output_append (out, "  <tag ");
 
   /* Handle anonymous tags */
   if (tag->name)
     {
       tag_name = g_markup_escape_text (tag->name, -1);
-      g_string_append_printf (context->tag_table_str, "name=\"%s\"", tag_name);
+      output_append_printf (out, "name=\"%s\"", tag_name);
       g_free (tag_name);
     }
   else
     {
       tag_id = BPOINTER_TO_INT (g_hash_table_lookup (context->tag_id_tags, tag));
 
-      g_string_append_printf (context->tag_table_str, "id=\"%d\"", tag_id);
+      output_append_printf (out, "id=\"%d\"", tag_id);
     }
 
-  g_string_append_printf (context->tag_table_str, " priority=\"%d\">\n", tag->priority);
+  output_append_printf (out, " priority=\"%d\">\n", tag->priority);
 
   /* Serialize properties */
   pspecs = g_object_class_list_properties (B_OBJECT_GET_CLASS (tag), &n_pspecs);
@@ -326,11 +466,11 @@ serialize_tag (bpointer key,
       if (tmp2)
 	{
 	  tmp = g_markup_escape_text (pspecs[i]->name, -1);
-	  g_string_append_printf (context->tag_table_str, "   <attr name=\"%s\" ", tmp);
+	  output_append_printf (out, "   <attr name=\"%s\" ", tmp);
 	  g_free (tmp);
 
 	  tmp = g_markup_escape_text (g_type_name (pspecs[i]->value_type), -1);
-	  g_string_append_printf (context->tag_table_str, "type=\"%s\" value=\"%s\" />\n", tmp, tmp2);
+	  output_append_printf (out, "type=\"%s\" value=\"%s\" />\n", tmp, tmp2);
 
 	  g_free (tmp);
 	  g_free (tmp2);
@@ -341,16 +481,16 @@ serialize_tag (bpointer key,
 
   g_free (pspecs);
 
-  g_string_append (context->tag_table_str, "  </tag>\n");
+  output_append (out, "  </tag>\n");
 }
 
 static void
 serialize_tags (SerializationContext *context)
 {
-  g_string_append (context->tag_table_str, " <text_view_markup>\n");
-  g_string_append (context->tag_table_str, " <tags>\n");
+  output_append (context->out, " <text_view_markup>\n");
+  output_append (context->out, " <tags>\n");
   g_hash_table_foreach (context->tags, serialize_tag, context);
-  g_string_append (context->tag_table_str, " </tags>\n");
+  output_append (context->out, " </tags>\n");
 }
 
 #if 0
@@ -414,30 +554,34 @@ find_list_delta (GSList  *old_list,
 }
 
 static void
-serialize_section_header (GString     *str,
-			  const bchar *name,
-			  bint         length)
+serialize_section_header (SerializeOutput *out,
+			  const bchar     *name,
+			  bint             length)
 {
+  bchar bytes[4];
+
   g_return_if_fail (strlen (name) == 26);
 
-  g_string_append (str, name);
+  output_append (out, name);
 
-  g_string_append_c (str, length >> 24);
+  bytes[0] = length >> 24;
+  bytes[1] = (length >> 16) & 0xff;
+  bytes[2] = (length >> 8) & 0xff;
+  bytes[3] = length & 0xff;
 
-  g_string_append_c (str, (length >> 16) & 0xff);
-  g_string_append_c (str, (length >> 8) & 0xff);
-  g_string_append_c (str, length & 0xff);
+  output_append_len (out, bytes, 4);
 }
 
 static void
 serialize_text (BtkTextBuffer        *buffer,
                 SerializationContext *context)
 {
+  SerializeOutput *out = context->out;
   BtkTextIter iter, old_iter;
   GSList *tag_list, *new_tag_list;
   GSList *active_tags;
 
-  g_string_append (context->text_str, "<text>");
+  output_append (out, "<text>");
 
   iter = context->start;
   tag_list = NULL;
@@ -447,7 +591,6 @@ serialize_text (BtkTextBuffer        *buffer,
     {
       GList *added, *removed;
       GList *tmp;
-      bchar *tmp_text, *escaped_text;
 
       new_tag_list = btk_text_iter_get_tags (&iter);
       find_list_delta (tag_list, new_tag_list, &added, &removed);
@@ -462,7 +605,7 @@ serialize_text (BtkTextBuffer        *buffer,
            */
           if (b_slist_find (active_tags, tag))
             {
-              g_string_append (context->text_str, "</apply_tag>");
+              output_append (out, "</apply_tag>");
 
               /* Drop all tags that were opened after this one (which are
                * above this on in the stack)
@@ -471,7 +614,7 @@ serialize_text (BtkTextBuffer        *buffer,
                 {
                   added = g_list_prepend (added, active_tags->data);
                   active_tags = b_slist_remove (active_tags, active_tags->data);
-                  g_string_append_printf (context->text_str, "</apply_tag>");
+                  output_append (out, "</apply_tag>");
                 }
 
               active_tags = b_slist_remove (active_tags, active_tags->data);
@@ -491,7 +634,7 @@ serialize_text (BtkTextBuffer        *buffer,
 	    {
 	      tag_name = g_markup_escape_text (tag->name, -1);
 
-	      g_string_append_printf (context->text_str, "<apply_tag name=\"%s\">", tag_name);
+	      output_append_printf (out, "<apply_tag name=\"%s\">", tag_name);
 	      g_free (tag_name);
 	    }
 	  else
@@ -507,7 +650,7 @@ serialize_text (BtkTextBuffer        *buffer,
 		  g_hash_table_insert (context->tag_id_tags, tag, tag_id);
 		}
 
-	      g_string_append_printf (context->text_str, "<apply_tag id=\"%d\">", BPOINTER_TO_INT (tag_id));
+	      output_append_printf (out, "<apply_tag id=\"%d\">", BPOINTER_TO_INT (tag_id));
 	    }
 
 	  active_tags = b_slist_prepend (active_tags, tag);
@@ -533,18 +676,13 @@ serialize_text (BtkTextBuffer        *buffer,
 	      if (pixbuf)
 		{
 		  /* Append the text before the pixbuf */
-		  tmp_text = btk_text_iter_get_slice (&old_iter, &iter);
-		  escaped_text = g_markup_escape_text (tmp_text, -1);
-		  g_free (tmp_text);
+		  output_append_text (out, &old_iter, &iter);
 
 		  /* Forward so we don't get the 0xfffc char */
 		  btk_text_iter_forward_char (&iter);
 		  old_iter = iter;
 
-		  g_string_append (context->text_str, escaped_text);
-		  g_free (escaped_text);
-
-		  g_string_append_printf (context->text_str, "<pixbuf index=\"%d\" />", context->n_pixbufs);
+		  output_append_printf (out, "<pixbuf index=\"%d\" />", context->n_pixbufs);
 
 		  context->n_pixbufs++;
 		  context->pixbufs = g_list_prepend (context->pixbufs, pixbuf);
@@ -566,26 +704,20 @@ serialize_text (BtkTextBuffer        *buffer,
 	iter = context->end;
 
       /* Append the text */
-      tmp_text = btk_text_iter_get_slice (&old_iter, &iter);
-      escaped_text = g_markup_escape_text (tmp_text, -1);
-      g_free (tmp_text);
-
-      g_string_append (context->text_str, escaped_text);
-      g_free (escaped_text);
+      output_append_text (out, &old_iter, &iter);
     }
   while (!btk_text_iter_equal (&iter, &context->end));
 
   /* Close any open tags */
   for (tag_list = active_tags; tag_list; tag_list = tag_list->next)
-    g_string_append (context->text_str, "</apply_tag>");
+    output_append (out, "</apply_tag>");
 
   b_slist_free (active_tags);
-  g_string_append (context->text_str, "</text>\n</text_view_markup>\n");
+  output_append (out, "</text>\n</text_view_markup>\n");
 }
 
 static void
-serialize_pixbufs (SerializationContext *context,
-		   GString              *text)
+serialize_pixbufs (SerializationContext *context)
 {
   GList *list;
 
@@ -599,12 +731,35 @@ serialize_pixbufs (SerializationContext *context,
       bdk_pixdata_from_pixbuf (&pixdata, pixbuf, FALSE);
       tmp = bdk_pixdata_serialize (&pixdata, &len);
 
-      serialize_section_header (text, "BTKTEXTBUFFERPIXBDATA-0001", len);
-      g_string_append_len (text, (bchar *) tmp, len);
+      serialize_section_header (context->out, "BTKTEXTBUFFERPIXBDATA-0001", len);
+      output_append_len (context->out, (bchar *) tmp, len);
       g_free (tmp);
     }
 }
 
+static void
+serialization_context_init (SerializationContext *context,
+                            const BtkTextIter    *start,
+                            const BtkTextIter    *end)
+{
+  context->out = NULL;
+  context->tags = g_hash_table_new (NULL, NULL);
+  context->start = *start;
+  context->end = *end;
+  context->n_pixbufs = 0;
+  context->pixbufs = NULL;
+  context->tag_id = 0;
+  context->tag_id_tags = g_hash_table_new (NULL, NULL);
+}
+
+static void
+serialization_context_clear (SerializationContext *context)
+{
+  g_hash_table_destroy (context->tags);
+  g_list_free (context->pixbufs);
+  g_hash_table_destroy (context->tag_id_tags);
+}
+
 buint8 *
 _btk_text_buffer_serialize_rich_text (BtkTextBuffer     *register_buffer,
                                       BtkTextBuffer     *content_buffer,
@@ -614,42 +769,108 @@ _btk_text_buffer_serialize_rich_text (BtkTextBuffer     *register_buffer,
                                       bpointer           user_data)
 {
   SerializationContext context;
-  GString *text;
+  SerializeOutput text_out, tags_out, header_out;
 
-  context.tags = g_hash_table_new (NULL, NULL);
-  context.text_str = g_string_new (NULL);
-  context.tag_table_str = g_string_new (NULL);
-  context.start = *start;
-  context.end = *end;
-  context.n_pixbufs = 0;
-  context.pixbufs = NULL;
-  context.tag_id = 0;
-  context.tag_id_tags = g_hash_table_new (NULL, NULL);
+  serialization_context_init (&context, start, end);
 
   /* We need to serialize the text before the tag table so we know
      what tags are used */
+  output_init (&text_out, g_string_new (NULL), NULL, NULL);
+  context.out = &text_out;
   serialize_text (content_buffer, &context);
+
+  output_init (&tags_out, g_string_new (NULL), NULL, NULL);
+  context.out = &tags_out;
   serialize_tags (&context);
 
-  text = g_string_new (NULL);
-  serialize_section_header (text, "BTKTEXTBUFFERCONTENTS-0001",
-                            context.tag_table_str->len + context.text_str->len);
+  output_init (&header_out, g_string_sized_new (30), NULL, NULL);
+  serialize_section_header (&header_out, "BTKTEXTBUFFERCONTENTS-0001",
+                            tags_out.length + text_out.length);
 
-  g_string_append_len (text, context.tag_table_str->str, context.tag_table_str->len);
-  g_string_append_len (text, context.text_str->str, context.text_str->len);
+  /* Put the header and the tag table in front of the text rather
+   * than copying all of them into a third string
+   */
+  g_string_prepend_len (text_out.str, tags_out.str->str, tags_out.str->len);
+  g_string_prepend_len (text_out.str, header_out.str->str, header_out.str->len);
+  g_string_free (tags_out.str, TRUE);
+  g_string_free (header_out.str, TRUE);
 
+  context.out = &text_out;
   context.pixbufs = g_list_reverse (context.pixbufs);
-  serialize_pixbufs (&context, text);
+  serialize_pixbufs (&context);
+
+  serialization_context_clear (&context);
+
+  *length = text_out.str->len;
+
+  return (buint8 *) g_string_free (text_out.str, FALSE);
+}
+
+/* Writes the same data as _btk_text_buffer_serialize_rich_text() to
+ * @stream, holding no more than OUTPUT_CHUNK_SIZE bytes of it (and
+ * one pixbuf) in memory at a time.  Since the contents section starts
+ * with its length, and the tag table in it lists the tags used by
+ * the text after it, the text is walked twice: once to measure it
+ * and once to write it.
+ */
+bboolean
+_btk_text_buffer_serialize_rich_text_to_stream (BtkTextBuffer     *content_buffer,
+                                                const BtkTextIter *start,
+                                                const BtkTextIter *end,
+                                                GOutputStream     *stream,
+                                                GCancellable      *cancellable,
+                                                GError           **error)
+{
+  SerializationContext context;
+  SerializeOutput out;
+  bsize contents_length;
+
+  serialization_context_init (&context, start, end);
+
+  output_init (&out, NULL, NULL, NULL);
+  out.split_text = TRUE;
+  context.out = &out;
+  serialize_text (content_buffer, &context);
+  serialize_tags (&context);
+  contents_length = out.length;
 
-  g_hash_table_destroy (context.tags);
   g_list_free (context.pixbufs);
-  g_string_free (context.text_str, TRUE);
-  g_string_free (context.tag_table_str, TRUE);
-  g_hash_table_destroy (context.tag_id_tags);
+  context.pixbufs = NULL;
+  context.n_pixbufs = 0;
+
+  if (contents_length > B_MAXINT)
+    {
+      g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                           _("The text is too large to be serialized"));
+      serialization_context_clear (&context);
+      return FALSE;
+    }
 
-  *length = text->len;
+  output_init (&out, g_string_sized_new (OUTPUT_CHUNK_SIZE + 4096),
+               stream, cancellable);
+  out.split_text = TRUE;
 
-  return (buint8 *) g_string_free (text, FALSE);
+  /* The anonymous tag ids were assigned by the first pass, so the
+   * tag table and text come out the same as they were measured.
+   */
+  serialize_section_header (&out, "BTKTEXTBUFFERCONTENTS-0001", contents_length);
+  serialize_tags (&context);
+  serialize_text (content_buffer, &context);
+
+  context.pixbufs = g_list_reverse (context.pixbufs);
+  serialize_pixbufs (&context);
+  output_flush (&out);
+
+  serialization_context_clear (&context);
+  g_string_free (out.str, TRUE);
+
+  if (out.error)
+    {
+      g_propagate_error (error, out.error);
+      return FALSE;
+    }
+
+  return TRUE;
 }
 
 typedef enum
@@ -714,6 +935,15 @@ typedef struct
 
   bboolean parsed_text;
   bboolean parsed_tags;
+
+  /* When reading from a stream, text is inserted at @iter as soon as
+   * it has been parsed, instead of being collected in @spans.  Since
+   * the pixbufs follow the text, marks are left where they go, in
+   * lists keyed by pixbuf index.
+   */
+  BtkTextIter *iter;
+  BtkTextMark *span_start;
+  GHashTable *pending_pixbufs;
 } ParseInfo;
 
 static void
@@ -1126,6 +1356,21 @@ parse_apply_tag_element (GMarkupParseContext  *context,
 	return;
 
       int_id = atoi (pixbuf_id);
+
+      if (info->iter)
+        {
+          GSList *marks;
+
+          marks = g_hash_table_lookup (info->pending_pixbufs, BINT_TO_POINTER (int_id));
+          marks = b_slist_prepend (marks,
+                                   btk_text_buffer_create_mark (info->buffer, NULL,
+                                                                info->iter, TRUE));
+          g_hash_table_insert (info->pending_pixbufs, BINT_TO_POINTER (int_id), marks);
+
+          push_state (info, STATE_PIXBUF);
+          return;
+        }
+
       pixbuf = get_pixbuf_from_headers (info->headers, int_id, error);
 
       span = g_new0 (TextSpan, 1);
@@ -1223,27 +1468,40 @@ parse_attr_element (GMarkupParseContext  *context,
 }
 
 
+/* Returns @tag_name, or @tag_name with a number appended if @table
+ * already has a tag of that name
+ */
 static bchar *
-get_tag_name (ParseInfo   *info,
-	      const bchar *tag_name)
+unique_tag_name (BtkTextTagTable *table,
+                 const bchar     *tag_name)
 {
   bchar *name;
   bint i;
 
   name = g_strdup (tag_name);
-
-  if (!info->create_tags)
-    return name;
-
   i = 0;
 
-  while (btk_text_tag_table_lookup (info->buffer->tag_table, name) != NULL)
+  while (btk_text_tag_table_lookup (table, name) != NULL)
     {
       g_free (name);
       name = g_strdup_printf ("%s-%d", tag_name, ++i);
     }
 
-  if (i != 0)
+  return name;
+}
+
+static bchar *
+get_tag_name (ParseInfo   *info,
+	      const bchar *tag_name)
+{
+  bchar *name;
+
+  if (!info->create_tags)
+    return g_strdup (tag_name);
+
+  name = unique_tag_name (info->buffer->tag_table, tag_name);
+
+  if (strcmp (name, tag_name) != 0)
     {
       g_hash_table_insert (info->substitutions, g_strdup (tag_name), g_strdup (name));
     }
@@ -1554,6 +1812,23 @@ all_whitespace (const char *text,
   return TRUE;
 }
 
+/* Inserts @text at info->iter and applies the open tags to it */
+static void
+insert_text_now (ParseInfo   *info,
+                 const bchar *text,
+                 bsize        text_len)
+{
+  BtkTextIter start;
+  GSList *tags;
+
+  btk_text_buffer_move_mark (info->buffer, info->span_start, info->iter);
+  btk_text_buffer_insert (info->buffer, info->iter, text, text_len);
+  btk_text_buffer_get_iter_at_mark (info->buffer, &start, info->span_start);
+
+  for (tags = info->tag_stack; tags; tags = tags->next)
+    btk_text_buffer_apply_tag (info->buffer, tags->data, &start, info->iter);
+}
+
 static void
 text_handler (GMarkupParseContext  *context,
 	      const bchar          *text,
@@ -1579,6 +1854,12 @@ text_handler (GMarkupParseContext  *context,
       if (text_len == 0)
 	return;
 
+      if (info->iter)
+        {
+          insert_text_now (info, text, text_len);
+          return;
+        }
+
       span = g_new0 (TextSpan, 1);
       span->text = g_strndup (text, text_len);
       span->tags = b_slist_copy (info->tag_stack);
@@ -1611,6 +1892,9 @@ parse_info_init (ParseInfo     *info,
   info->current_tag = NULL;
   info->current_tag_prio = -1;
   info->tag_priorities = NULL;
+  info->iter = NULL;
+  info->span_start = NULL;
+  info->pending_pixbufs = NULL;
 
   info->buffer = buffer;
 }
@@ -1659,6 +1943,26 @@ parse_info_free (ParseInfo *info)
     }
   g_list_free (info->tag_priorities);
 
+  if (info->span_start)
+    btk_text_buffer_delete_mark (info->buffer, info->span_start);
+
+  if (info->pending_pixbufs)
+    {
+      GHashTableIter iter;
+      bpointer marks;
+
+      g_hash_table_iter_init (&iter, info->pending_pixbufs);
+      while (g_hash_table_iter_next (&iter, NULL, &marks))
+        {
+          GSList *l;
+
+          for (l = marks; l; l = l->next)
+            btk_text_buffer_delete_mark (info->buffer, l->data);
+          b_slist_free (marks);
+        }
+
+      g_hash_table_destroy (info->pending_pixbufs);
+    }
 }
 
 static void
@@ -1782,6 +2086,14 @@ read_headers (const bchar *start,
   return NULL;
 }
 
+static const GMarkupParser rich_text_parser = {
+  start_element_handler,
+  end_element_handler,
+  text_handler,
+  NULL,
+  NULL
+};
+
 static bboolean
 deserialize_text (BtkTextBuffer *buffer,
 		  BtkTextIter   *iter,
@@ -1795,14 +2107,6 @@ deserialize_text (BtkTextBuffer *buffer,
   ParseInfo info;
   bboolean retval = FALSE;
 
-  static const GMarkupParser rich_text_parser = {
-    start_element_handler,
-    end_element_handler,
-    text_handler,
-    NULL,
-    NULL
-  };
-
   parse_info_init (&info, buffer, create_tags, headers);
 
   context = g_markup_parse_context_new (&rich_text_parser,
@@ -1871,3 +2175,934 @@ _btk_text_buffer_deserialize_rich_text (BtkTextBuffer *register_buffer,
 
   return retval;
 }
+
+/* Bytes of XML fed to the parser at a time when reading a stream */
+#define READ_CHUNK_SIZE 65536
+
+static void
+set_malformed_error (GError **error)
+{
+  g_set_error_literal (error,
+                       G_MARKUP_ERROR,
+                       G_MARKUP_ERROR_PARSE,
+                       _("Serialized data is malformed"));
+}
+
+/* Reads the header of the next section of @stream.  @length is set
+ * to -1 at the end of the stream, or if the section is not an @id
+ * section.
+ */
+static bboolean
+read_section_header (GInputStream  *stream,
+                     const bchar   *id,
+                     bint          *length,
+                     GCancellable  *cancellable,
+                     GError       **error)
+{
+  bchar header[30];
+  bsize n_read;
+
+  *length = -1;
+
+  if (!g_input_stream_read_all (stream, header, sizeof (header), &n_read,
+                                cancellable, error))
+    return FALSE;
+
+  if (n_read == 0)
+    return TRUE;
+
+  if (n_read < sizeof (header))
+    {
+      set_malformed_error (error);
+      return FALSE;
+    }
+
+  if (strncmp (header, id, 26) != 0)
+    return TRUE;
+
+  *length = read_int ((const buchar *) header + 26);
+
+  if (*length < 0)
+    {
+      set_malformed_error (error);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+static bboolean
+skip_bytes (GInputStream  *stream,
+            bsize          count,
+            GCancellable  *cancellable,
+            GError       **error)
+{
+  while (count > 0)
+    {
+      bssize n_skipped;
+
+      n_skipped = g_input_stream_skip (stream, count, cancellable, error);
+
+      if (n_skipped < 0)
+        return FALSE;
+
+      if (n_skipped == 0)
+        {
+          set_malformed_error (error);
+          return FALSE;
+        }
+
+      count -= n_skipped;
+    }
+
+  return TRUE;
+}
+
+/* Inserts the pixbuf of the next pixbuf section of @stream at the
+ * pending marks for it
+ */
+static bboolean
+insert_pending_pixbuf (ParseInfo     *info,
+                       GInputStream  *stream,
+                       bint           index,
+                       bint           length,
+                       GCancellable  *cancellable,
+                       GError       **error)
+{
+  GSList *marks, *l;
+  BdkPixdata pixdata;
+  BdkPixbuf *pixbuf;
+  buint8 *data;
+  bsize n_read;
+
+  marks = g_hash_table_lookup (info->pending_pixbufs, BINT_TO_POINTER (index));
+
+  if (marks == NULL)
+    return skip_bytes (stream, length, cancellable, error);
+
+  data = g_malloc (length);
+
+  if (!g_input_stream_read_all (stream, data, length, &n_read,
+                                cancellable, error))
+    {
+      g_free (data);
+      return FALSE;
+    }
+
+  if (n_read < (bsize) length)
+    {
+      g_free (data);
+      set_malformed_error (error);
+      return FALSE;
+    }
+
+  pixbuf = NULL;
+  if (bdk_pixdata_deserialize (&pixdata, length, data, error))
+    pixbuf = bdk_pixbuf_from_pixdata (&pixdata, TRUE, error);
+
+  g_free (data);
+
+  if (pixbuf == NULL)
+    return FALSE;
+
+  g_hash_table_remove (info->pending_pixbufs, BINT_TO_POINTER (index));
+
+  for (l = marks; l; l = l->next)
+    {
+      BtkTextIter iter;
+
+      btk_text_buffer_get_iter_at_mark (info->buffer, &iter, l->data);
+      btk_text_buffer_insert_pixbuf (info->buffer, &iter, pixbuf);
+      btk_text_buffer_delete_mark (info->buffer, l->data);
+    }
+
+  b_slist_free (marks);
+  g_object_unref (pixbuf);
+
+  return TRUE;
+}
+
+/* Reads what _btk_text_buffer_serialize_rich_text() writes from
+ * @stream, a chunk at a time.  Text is inserted at @iter as soon as
+ * it has been parsed, so memory use does not depend on the size of
+ * the text.  If an error occurs, whatever was inserted is deleted
+ * again; either way @iter is left after the inserted text.
+ */
+bboolean
+_btk_text_buffer_deserialize_rich_text_from_stream (BtkTextBuffer *content_buffer,
+                                                    BtkTextIter   *iter,
+                                                    GInputStream  *stream,
+                                                    bboolean       create_tags,
+                                                    GCancellable  *cancellable,
+                                                    GError       **error)
+{
+  GMarkupParseContext *context;
+  ParseInfo info;
+  BtkTextMark *start_mark, *end_mark;
+  BtkTextIter start;
+  bchar *chunk;
+  bint length, index;
+  bboolean retval = FALSE;
+
+  if (!read_section_header (stream, "BTKTEXTBUFFERCONTENTS-0001", &length,
+                            cancellable, error))
+    return FALSE;
+
+  if (length < 0)
+    {
+      g_set_error_literal (error,
+                           G_MARKUP_ERROR,
+                           G_MARKUP_ERROR_PARSE,
+                           _("Serialized data is malformed. First section isn't BTKTEXTBUFFERCONTENTS-0001"));
+      return FALSE;
+    }
+
+  parse_info_init (&info, content_buffer, create_tags, NULL);
+  info.iter = iter;
+  info.span_start = btk_text_buffer_create_mark (content_buffer, NULL, iter, TRUE);
+  info.pending_pixbufs = g_hash_table_new (NULL, NULL);
+
+  start_mark = btk_text_buffer_create_mark (content_buffer, NULL, iter, TRUE);
+  end_mark = btk_text_buffer_create_mark (content_buffer, NULL, iter, FALSE);
+
+  context = g_markup_parse_context_new (&rich_text_parser, 0, &info, NULL);
+  chunk = g_malloc (READ_CHUNK_SIZE);
+
+  while (length > 0)
+    {
+      bsize n_wanted = MIN (length, READ_CHUNK_SIZE);
+      bsize n_read;
+
+      if (!g_input_stream_read_all (stream, chunk, n_wanted, &n_read,
+                                    cancellable, error))
+        goto out;
+
+      if (n_read < n_wanted)
+        {
+          set_malformed_error (error);
+          goto out;
+        }
+
+      if (!g_markup_parse_context_parse (context, chunk, n_read, error))
+        goto out;
+
+      length -= n_read;
+    }
+
+  if (!g_markup_parse_context_end_parse (context, error))
+    goto out;
+
+  /* The pixbufs follow the text, in the order of their indices */
+  for (index = 0; ; index++)
+    {
+      if (!read_section_header (stream, "BTKTEXTBUFFERPIXBDATA-0001", &length,
+                                cancellable, error))
+        goto out;
+
+      if (length < 0)
+        break;
+
+      if (!insert_pending_pixbuf (&info, stream, index, length,
+                                  cancellable, error))
+        goto out;
+    }
+
+  retval = TRUE;
+
+ out:
+  if (!retval)
+    {
+      btk_text_buffer_get_iter_at_mark (content_buffer, &start, start_mark);
+      btk_text_buffer_get_iter_at_mark (content_buffer, iter, end_mark);
+      btk_text_buffer_delete (content_buffer, &start, iter);
+    }
+
+  btk_text_buffer_get_iter_at_mark (content_buffer, iter, end_mark);
+  btk_text_buffer_delete_mark (content_buffer, start_mark);
+  btk_text_buffer_delete_mark (content_buffer, end_mark);
+
+  parse_info_free (&info);
+  g_markup_parse_context_free (context);
+  g_free (chunk);
+
+  return retval;
+}
+
+/* The compact format
+ *
+ * Used instead of the XML format when pasting between the text
+ * buffers of one process, where nothing else needs to read it.  It
+ * starts with COMPACT_MAGIC, followed by records that start with one
+ * of the opcodes below:
+ *
+ *   COMPACT_TAG      id, name, n_attrs, n_attrs * (name, type, value)
+ *   COMPACT_TEXT     string of UTF-8 text
+ *   COMPACT_TAG_ON   id
+ *   COMPACT_TAG_OFF  id
+ *   COMPACT_PIXBUF   string holding a serialized BdkPixdata
+ *
+ * Numbers are unsigned LEB128, and strings are their length followed
+ * by their bytes.  The tag name is stored with its length plus one,
+ * and a length of 0 for anonymous tags.  All tags are defined before
+ * the text, in order of priority; a tag applies from its
+ * COMPACT_TAG_ON to its COMPACT_TAG_OFF or the end of the data.
+ */
+
+#define COMPACT_MAGIC "BTKTEXTBUFFERCOMPACT-0001"
+
+enum
+{
+  COMPACT_TAG     = 'g',
+  COMPACT_TEXT    = 't',
+  COMPACT_TAG_ON  = '+',
+  COMPACT_TAG_OFF = '-',
+  COMPACT_PIXBUF  = 'p'
+};
+
+typedef struct
+{
+  GString *data;
+  GHashTable *tag_ids;  /* BtkTextTag -> id + 1 */
+  GPtrArray *tags;
+} CompactWriter;
+
+static void
+compact_append_uint (GString *data,
+                     buint    value)
+{
+  while (value >= 0x80)
+    {
+      g_string_append_c (data, (value & 0x7f) | 0x80);
+      value >>= 7;
+    }
+
+  g_string_append_c (data, value);
+}
+
+static void
+compact_append_string (GString     *data,
+                       const bchar *str,
+                       bsize        len)
+{
+  compact_append_uint (data, len);
+  g_string_append_len (data, str, len);
+}
+
+static void
+compact_append_toggle (CompactWriter *writer,
+                       BtkTextTag    *tag,
+                       bboolean       on)
+{
+  bint id;
+
+  id = BPOINTER_TO_INT (g_hash_table_lookup (writer->tag_ids, tag));
+
+  if (id == 0)
+    {
+      g_ptr_array_add (writer->tags, tag);
+      id = writer->tags->len;
+      g_hash_table_insert (writer->tag_ids, tag, BINT_TO_POINTER (id));
+    }
+
+  g_string_append_c (writer->data, on ? COMPACT_TAG_ON : COMPACT_TAG_OFF);
+  compact_append_uint (writer->data, id - 1);
+}
+
+static void
+compact_append_tag (GString    *data,
+                    BtkTextTag *tag,
+                    bint        id)
+{
+  GString *attrs;
+  BParamSpec **pspecs;
+  buint n_pspecs, n_attrs, i;
+
+  g_string_append_c (data, COMPACT_TAG);
+  compact_append_uint (data, id);
+
+  if (tag->name)
+    {
+      compact_append_uint (data, strlen (tag->name) + 1);
+      g_string_append (data, tag->name);
+    }
+  else
+    compact_append_uint (data, 0);
+
+  attrs = g_string_new (NULL);
+  n_attrs = 0;
+
+  pspecs = g_object_class_list_properties (B_OBJECT_GET_CLASS (tag), &n_pspecs);
+
+  for (i = 0; i < n_pspecs; i++)
+    {
+      BValue value = { 0 };
+      const bchar *type_name;
+      bchar *str;
+
+      if (!(pspecs[i]->flags & G_PARAM_READABLE) ||
+	  !(pspecs[i]->flags & G_PARAM_WRITABLE))
+	continue;
+
+      if (!is_param_set (B_OBJECT (tag), pspecs[i], &value))
+	continue;
+
+      str = value_to_string (&value);
+
+      if (str)
+        {
+          type_name = g_type_name (pspecs[i]->value_type);
+
+          compact_append_string (attrs, pspecs[i]->name, strlen (pspecs[i]->name));
+          compact_append_string (attrs, type_name, strlen (type_name));
+          compact_append_string (attrs, str, strlen (str));
+          n_attrs++;
+
+          g_free (str);
+        }
+
+      b_value_unset (&value);
+    }
+
+  g_free (pspecs);
+
+  compact_append_uint (data, n_attrs);
+  g_string_append_len (data, attrs->str, attrs->len);
+  g_string_free (attrs, TRUE);
+}
+
+static void
+compact_append_pixbuf (GString   *data,
+                       BdkPixbuf *pixbuf)
+{
+  BdkPixdata pixdata;
+  buint8 *tmp;
+  buint len;
+
+  bdk_pixdata_from_pixbuf (&pixdata, pixbuf, FALSE);
+  tmp = bdk_pixdata_serialize (&pixdata, &len);
+
+  g_string_append_c (data, COMPACT_PIXBUF);
+  compact_append_string (data, (bchar *) tmp, len);
+  g_free (tmp);
+}
+
+/* Appends the text between @start and @end, which has no tag
+ * toggles, as COMPACT_TEXT and COMPACT_PIXBUF records
+ */
+static void
+compact_append_text (GString           *data,
+                     const BtkTextIter *start,
+                     const BtkTextIter *end)
+{
+  BtkTextIter iter;
+  bchar *text, *run, *p, *q;
+
+  text = btk_text_iter_get_slice (start, end);
+  iter = *start;
+  run = q = text;
+
+  /* Pixbufs and child anchors both show up as U+FFFC */
+  for (p = strstr (text, "\xef\xbf\xbc"); p; p = strstr (p + 3, "\xef\xbf\xbc"))
+    {
+      BdkPixbuf *pixbuf;
+
+      btk_text_iter_forward_chars (&iter, g_utf8_strlen (q, p - q));
+      q = p;
+
+      pixbuf = btk_text_iter_get_pixbuf (&iter);
+
+      if (pixbuf)
+        {
+          if (p > run)
+            {
+              g_string_append_c (data, COMPACT_TEXT);
+              compact_append_string (data, run, p - run);
+            }
+
+          compact_append_pixbuf (data, pixbuf);
+          run = p + 3;
+        }
+    }
+
+  if (*run)
+    {
+      g_string_append_c (data, COMPACT_TEXT);
+      compact_append_string (data, run, strlen (run));
+    }
+
+  g_free (text);
+}
+
+static bint
+compare_tag_priority (gconstpointer a,
+                      gconstpointer b)
+{
+  const BtkTextTag *tag_a = *(BtkTextTag **) a;
+  const BtkTextTag *tag_b = *(BtkTextTag **) b;
+
+  return tag_a->priority - tag_b->priority;
+}
+
+buint8 *
+_btk_text_buffer_serialize_compact (BtkTextBuffer     *register_buffer,
+                                    BtkTextBuffer     *content_buffer,
+                                    const BtkTextIter *start,
+                                    const BtkTextIter *end,
+                                    bsize             *length,
+                                    bpointer           user_data)
+{
+  CompactWriter writer;
+  GString *header;
+  BtkTextIter iter, next;
+  GSList *tags, *l;
+  buint i;
+
+  writer.data = g_string_new (NULL);
+  writer.tag_ids = g_hash_table_new (NULL, NULL);
+  writer.tags = g_ptr_array_new ();
+
+  iter = *start;
+
+  tags = btk_text_iter_get_tags (&iter);
+  for (l = tags; l; l = l->next)
+    compact_append_toggle (&writer, l->data, TRUE);
+  b_slist_free (tags);
+
+  while (btk_text_iter_compare (&iter, end) < 0)
+    {
+      next = iter;
+      btk_text_iter_forward_to_tag_toggle (&next, NULL);
+      if (btk_text_iter_compare (&next, end) > 0)
+        next = *end;
+
+      compact_append_text (writer.data, &iter, &next);
+
+      iter = next;
+      if (btk_text_iter_equal (&iter, end))
+        break;
+
+      tags = btk_text_iter_get_toggled_tags (&iter, FALSE);
+      for (l = tags; l; l = l->next)
+        compact_append_toggle (&writer, l->data, FALSE);
+      b_slist_free (tags);
+
+      tags = btk_text_iter_get_toggled_tags (&iter, TRUE);
+      for (l = tags; l; l = l->next)
+        compact_append_toggle (&writer, l->data, TRUE);
+      b_slist_free (tags);
+    }
+
+  /* Now that the tags are known, put their definitions in front */
+  header = g_string_new (COMPACT_MAGIC);
+
+  g_ptr_array_sort (writer.tags, compare_tag_priority);
+
+  for (i = 0; i < writer.tags->len; i++)
+    {
+      BtkTextTag *tag = g_ptr_array_index (writer.tags, i);
+      bint id = BPOINTER_TO_INT (g_hash_table_lookup (writer.tag_ids, tag));
+
+      compact_append_tag (header, tag, id - 1);
+    }
+
+  g_string_prepend_len (writer.data, header->str, header->len);
+  g_string_free (header, TRUE);
+
+  g_hash_table_destroy (writer.tag_ids);
+  g_ptr_array_free (writer.tags, TRUE);
+
+  *length = writer.data->len;
+
+  return (buint8 *) g_string_free (writer.data, FALSE);
+}
+
+typedef struct
+{
+  const buchar *p;
+  const buchar *end;
+} CompactReader;
+
+static bboolean
+compact_read_uint (CompactReader *reader,
+                   buint         *value)
+{
+  buint result = 0;
+  bint shift;
+
+  for (shift = 0; shift < 32 && reader->p < reader->end; shift += 7)
+    {
+      buchar byte = *reader->p++;
+
+      result |= (buint) (byte & 0x7f) << shift;
+
+      if (!(byte & 0x80))
+        {
+          *value = result;
+          return TRUE;
+        }
+    }
+
+  return FALSE;
+}
+
+static bboolean
+compact_read_bytes (CompactReader  *reader,
+                    buint           len,
+                    const bchar   **bytes)
+{
+  if (len > reader->end - reader->p)
+    return FALSE;
+
+  *bytes = (const bchar *) reader->p;
+  reader->p += len;
+
+  return TRUE;
+}
+
+static bchar *
+compact_read_string (CompactReader *reader)
+{
+  const bchar *bytes;
+  buint len;
+
+  if (!compact_read_uint (reader, &len) ||
+      !compact_read_bytes (reader, len, &bytes))
+    return NULL;
+
+  return g_strndup (bytes, len);
+}
+
+static bboolean
+compact_set_attribute (BtkTextTag   *tag,
+                       const bchar  *name,
+                       const bchar  *type,
+                       const bchar  *value,
+                       GError      **error)
+{
+  GType gtype;
+  BValue gvalue = { 0 };
+  BParamSpec *pspec;
+
+  gtype = g_type_from_name (type);
+
+  if (gtype == B_TYPE_INVALID)
+    {
+      g_set_error (error, G_MARKUP_ERROR, G_MARKUP_ERROR_PARSE,
+                   _("\"%s\" is not a valid attribute type"), type);
+      return FALSE;
+    }
+
+  if (!(pspec = g_object_class_find_property (B_OBJECT_GET_CLASS (tag), name)))
+    {
+      g_set_error (error, G_MARKUP_ERROR, G_MARKUP_ERROR_PARSE,
+                   _("\"%s\" is not a valid attribute name"), name);
+      return FALSE;
+    }
+
+  b_value_init (&gvalue, gtype);
+
+  if (!deserialize_value (value, &gvalue))
+    {
+      g_set_error (error, G_MARKUP_ERROR, G_MARKUP_ERROR_PARSE,
+                   _("\"%s\" could not be converted to a value of type \"%s\" for attribute \"%s\""),
+                   value, type, name);
+      b_value_unset (&gvalue);
+      return FALSE;
+    }
+
+  if (g_param_value_validate (pspec, &gvalue))
+    {
+      g_set_error (error, G_MARKUP_ERROR, G_MARKUP_ERROR_PARSE,
+                   _("\"%s\" is not a valid value for attribute \"%s\""),
+                   value, name);
+      b_value_unset (&gvalue);
+      return FALSE;
+    }
+
+  g_object_set_property (B_OBJECT (tag), name, &gvalue);
+  b_value_unset (&gvalue);
+
+  return TRUE;
+}
+
+/* Reads a COMPACT_TAG record, and stores the tag in @tags */
+static bboolean
+compact_read_tag (CompactReader  *reader,
+                  BtkTextBuffer  *buffer,
+                  bboolean        create_tags,
+                  GPtrArray      *tags,
+                  GError        **error)
+{
+  BtkTextTag *tag = NULL;
+  const bchar *bytes;
+  bchar *name = NULL;
+  buint id, name_len, n_attrs, i;
+  bboolean retval = FALSE;
+
+  /* Every tag takes a few bytes, which bounds the ids */
+  if (!compact_read_uint (reader, &id) ||
+      id >= reader->end - reader->p ||
+      (id < tags->len && g_ptr_array_index (tags, id) != NULL) ||
+      !compact_read_uint (reader, &name_len) ||
+      (name_len > 0 && !compact_read_bytes (reader, name_len - 1, &bytes)) ||
+      !compact_read_uint (reader, &n_attrs))
+    {
+      set_malformed_error (error);
+      return FALSE;
+    }
+
+  if (name_len > 0)
+    name = g_strndup (bytes, name_len - 1);
+
+  if (create_tags)
+    {
+      bchar *tag_name = NULL;
+
+      if (name)
+        tag_name = unique_tag_name (buffer->tag_table, name);
+
+      tag = btk_text_tag_new (tag_name);
+      g_free (tag_name);
+    }
+  else if (name == NULL)
+    {
+      g_set_error_literal (error, G_MARKUP_ERROR, G_MARKUP_ERROR_PARSE,
+                           _("Anonymous tag found and tags can not be created."));
+      goto out;
+    }
+  else
+    {
+      tag = btk_text_tag_table_lookup (buffer->tag_table, name);
+
+      if (tag == NULL)
+        {
+          g_set_error (error, G_MARKUP_ERROR, G_MARKUP_ERROR_PARSE,
+                       _("Tag \"%s\" does not exist in buffer and tags can not be created."),
+                       name);
+          goto out;
+        }
+
+      g_object_ref (tag);
+    }
+
+  for (i = 0; i < n_attrs; i++)
+    {
+      bchar *attr_name, *type, *value;
+      bboolean ok;
+
+      attr_name = compact_read_string (reader);
+      type = compact_read_string (reader);
+      value = compact_read_string (reader);
+
+      if (!attr_name || !type || !value)
+        {
+          set_malformed_error (error);
+          ok = FALSE;
+        }
+      else if (create_tags)
+        ok = compact_set_attribute (tag, attr_name, type, value, error);
+      else
+        ok = TRUE;
+
+      g_free (attr_name);
+      g_free (type);
+      g_free (value);
+
+      if (!ok)
+        goto out;
+    }
+
+  if (create_tags)
+    btk_text_tag_table_add (buffer->tag_table, tag);
+
+  if (id >= tags->len)
+    g_ptr_array_set_size (tags, id + 1);
+
+  g_ptr_array_index (tags, id) = tag;
+  tag = NULL;
+
+  retval = TRUE;
+
+ out:
+  if (tag)
+    g_object_unref (tag);
+  g_free (name);
+
+  return retval;
+}
+
+static bboolean
+compact_insert_pixbuf (BtkTextBuffer  *buffer,
+                       BtkTextIter    *iter,
+                       const bchar    *bytes,
+                       buint           len,
+                       GError        **error)
+{
+  BdkPixdata pixdata;
+  BdkPixbuf *pixbuf;
+
+  if (!bdk_pixdata_deserialize (&pixdata, len, (const buint8 *) bytes, error))
+    return FALSE;
+
+  pixbuf = bdk_pixbuf_from_pixdata (&pixdata, TRUE, error);
+
+  if (pixbuf == NULL)
+    return FALSE;
+
+  btk_text_buffer_insert_pixbuf (buffer, iter, pixbuf);
+  g_object_unref (pixbuf);
+
+  return TRUE;
+}
+
+static void
+compact_close_tag (GArray     *ranges,
+                   GArray     *starts,
+                   BtkTextTag *tag,
+                   buint       id,
+                   bint        offset)
+{
+  BtkTextBufferTagRange range;
+
+  range.tag = tag;
+  range.start_offset = g_array_index (starts, bint, id);
+  range.end_offset = offset;
+  g_array_append_val (ranges, range);
+
+  g_array_index (starts, bint, id) = -1;
+}
+
+/* Inserts what _btk_text_buffer_serialize_compact() produced.  The
+ * text is inserted first and the tags are applied in one batch at the
+ * end.  On errors, the inserted text is deleted again.
+ */
+bboolean
+_btk_text_buffer_deserialize_compact (BtkTextBuffer *register_buffer,
+                                      BtkTextBuffer *content_buffer,
+                                      BtkTextIter   *iter,
+                                      const buint8  *data,
+                                      bsize          length,
+                                      bboolean       create_tags,
+                                      bpointer       user_data,
+                                      GError       **error)
+{
+  CompactReader reader;
+  GPtrArray *tags;      /* BtkTextTag by id */
+  GArray *starts;       /* offset a tag was turned on at, by id, or -1 */
+  GArray *ranges;       /* BtkTextBufferTagRange */
+  BtkTextMark *start_mark;
+  BtkTextIter start;
+  bsize magic_len;
+  buint i;
+  bboolean retval = FALSE;
+
+  magic_len = strlen (COMPACT_MAGIC);
+
+  if (length < magic_len || memcmp (data, COMPACT_MAGIC, magic_len) != 0)
+    {
+      set_malformed_error (error);
+      return FALSE;
+    }
+
+  reader.p = data + magic_len;
+  reader.end = data + length;
+
+  tags = g_ptr_array_new ();
+  starts = g_array_new (FALSE, FALSE, sizeof (bint));
+  ranges = g_array_new (FALSE, FALSE, sizeof (BtkTextBufferTagRange));
+
+  start_mark = btk_text_buffer_create_mark (content_buffer, NULL, iter, TRUE);
+
+  while (reader.p < reader.end)
+    {
+      buchar op = *reader.p++;
+      const bchar *bytes;
+      buint value;
+
+      switch (op)
+        {
+        case COMPACT_TAG:
+          if (!compact_read_tag (&reader, content_buffer, create_tags, tags, error))
+            goto out;
+
+          while (starts->len < tags->len)
+            {
+              bint none = -1;
+              g_array_append_val (starts, none);
+            }
+          break;
+
+        case COMPACT_TEXT:
+          if (!compact_read_uint (&reader, &value) ||
+              !compact_read_bytes (&reader, value, &bytes) ||
+              !g_utf8_validate (bytes, value, NULL))
+            goto malformed;
+
+          btk_text_buffer_insert (content_buffer, iter, bytes, value);
+          break;
+
+        case COMPACT_PIXBUF:
+          if (!compact_read_uint (&reader, &value) ||
+              !compact_read_bytes (&reader, value, &bytes))
+            goto malformed;
+
+          if (!compact_insert_pixbuf (content_buffer, iter, bytes, value, error))
+            goto out;
+          break;
+
+        case COMPACT_TAG_ON:
+        case COMPACT_TAG_OFF:
+          if (!compact_read_uint (&reader, &value) ||
+              value >= tags->len ||
+              g_ptr_array_index (tags, value) == NULL)
+            goto malformed;
+
+          if (op == COMPACT_TAG_ON)
+            {
+              if (g_array_index (starts, bint, value) < 0)
+                g_array_index (starts, bint, value) = btk_text_iter_get_offset (iter);
+            }
+          else if (g_array_index (starts, bint, value) >= 0)
+            compact_close_tag (ranges, starts, g_ptr_array_index (tags, value),
+                               value, btk_text_iter_get_offset (iter));
+          break;
+
+        default:
+          goto malformed;
+        }
+    }
+
+  for (i = 0; i < starts->len; i++)
+    if (g_array_index (starts, bint, i) >= 0)
+      compact_close_tag (ranges, starts, g_ptr_array_index (tags, i),
+                         i, btk_text_iter_get_offset (iter));
+
+  btk_text_buffer_apply_tag_ranges (content_buffer,
+                                    (BtkTextBufferTagRange *) ranges->data,
+                                    ranges->len);
+
+  retval = TRUE;
+  goto out;
+
+ malformed:
+  set_malformed_error (error);
+
+ out:
+  if (!retval)
+    {
+      btk_text_buffer_get_iter_at_mark (content_buffer, &start, start_mark);
+      btk_text_buffer_delete (content_buffer, &start, iter);
+    }
+
+  btk_text_buffer_delete_mark (content_buffer, start_mark);
+
+  for (i = 0; i < tags->len; i++)
+    if (g_ptr_array_index (tags, i))
+      g_object_unref (g_ptr_array_index (tags, i));
+
+  g_ptr_array_free (tags, TRUE);
+  g_array_free (starts, TRUE);
+  g_array_free (ranges, TRUE);
+
+  return retval;
+}
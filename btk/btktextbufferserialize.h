@@ -39,5 +39,45 @@ bboolean _btk_text_buffer_deserialize_rich_text (BtkTextBuffer     *register_buf
                                                  bpointer           user_data,
                                                  GError           **error);
 
+bboolean _btk_text_buffer_serialize_rich_text_to_stream     (BtkTextBuffer     *content_buffer,
+                                                             const BtkTextIter *start,
+                                                             const BtkTextIter *end,
+                                                             GOutputStream     *stream,
+                                                             GCancellable      *cancellable,
+                                                             GError           **error);
+bboolean _btk_text_buffer_deserialize_rich_text_from_stream (BtkTextBuffer     *content_buffer,
+                                                             BtkTextIter       *iter,
+                                                             GInputStream      *stream,
+                                                             bboolean           create_tags,
+                                                             GCancellable      *cancellable,
+                                                             GError           **error);
+
+buint8 * _btk_text_buffer_serialize_compact     (BtkTextBuffer     *register_buffer,
+                                                 BtkTextBuffer     *content_buffer,
+                                                 const BtkTextIter *start,
+                                                 const BtkTextIter *end,
+                                                 bsize             *length,
+                                                 bpointer           user_data);
+bboolean _btk_text_buffer_deserialize_compact   (BtkTextBuffer     *register_buffer,
+                                                 BtkTextBuffer     *content_buffer,
+                                                 BtkTextIter       *iter,
+                                                 const buint8      *data,
+                                                 bsize              length,
+                                                 bboolean           create_tags,
+                                                 bpointer           user_data,
+                                                 GError           **error);
+
+/* In btktextbufferrichtext.c */
+BdkAtom  _btk_text_buffer_get_compact_format    (BtkTextBuffer     *register_buffer,
+                                                 BtkTextBuffer     *buffer);
+bboolean _btk_text_buffer_paste_compact         (BtkTextBuffer     *buffer,
+                                                 BdkAtom            format,
+                                                 BtkTextIter       *iter,
+                                                 BtkTextBuffer     *register_buffer,
+                                                 BtkTextBuffer     *src_buffer,
+                                                 const BtkTextIter *start,
+                                                 const BtkTextIter *end,
+                                                 GError           **error);
+
 
 #endif /* __BTK_TEXT_BUFFER_SERIALIZE_H__ */
@@ -274,7 +274,7 @@ iter_init_from_byte_offset (BtkTextIter *iter,
   iter_set_from_byte_offset (real, line, line_byte_offset);
 
   if (real->segment->type == &btk_text_char_type &&
-      (real->segment->body.chars[real->segment_byte_offset] & 0xc0) == 0x80)
+      (real->segment->body.text.chars[real->segment_byte_offset] & 0xc0) == 0x80)
     g_warning ("Incorrect line byte index %d falls in the middle of a UTF-8 "
                "character; this will crash the text buffer. "
                "Byte indexes must refer to the start of a character.",
@@ -851,7 +851,7 @@ btk_text_iter_get_char (const BtkTextIter *iter)
     {
       ensure_byte_offsets (real);
       
-      return g_utf8_get_char (real->segment->body.chars +
+      return g_utf8_get_char (real->segment->body.text.chars +
                               real->segment_byte_offset);
     }
   else
@@ -1884,7 +1884,7 @@ forward_char (BtkTextRealIter *real)
         {
           bint bytes;
           const char * start =
-            real->segment->body.chars + real->segment_byte_offset;
+            real->segment->body.text.chars + real->segment_byte_offset;
 
           bytes = g_utf8_next_char (start) - start;
 
@@ -2365,13 +2365,13 @@ btk_text_iter_backward_chars (BtkTextIter *iter, bint count)
 
           /* if in the last fourth of the segment walk backwards */
           if (count < real->segment_char_offset / 4)
-            p = g_utf8_offset_to_pointer (real->segment->body.chars + real->segment_byte_offset, 
+            p = g_utf8_offset_to_pointer (real->segment->body.text.chars + real->segment_byte_offset, 
                                           -count);
           else
-            p = g_utf8_offset_to_pointer (real->segment->body.chars,
+            p = g_utf8_offset_to_pointer (real->segment->body.text.chars,
                                           real->segment_char_offset - count);
 
-          new_byte_offset = p - real->segment->body.chars;
+          new_byte_offset = p - real->segment->body.text.chars;
           real->line_byte_offset -= (real->segment_byte_offset - new_byte_offset);
           real->segment_byte_offset = new_byte_offset;
         }
@@ -3813,7 +3813,7 @@ btk_text_iter_set_line_index (BtkTextIter *iter,
     btk_text_iter_forward_line (iter);
 
   if (real->segment->type == &btk_text_char_type &&
-      (real->segment->body.chars[real->segment_byte_offset] & 0xc0) == 0x80)
+      (real->segment->body.text.chars[real->segment_byte_offset] & 0xc0) == 0x80)
     g_warning ("%s: Incorrect byte offset %d falls in the middle of a UTF-8 "
                "character; this will crash the text buffer. "
                "Byte indexes must refer to the start of a character.",
@@ -4411,17 +4411,92 @@ forward_chars_with_skipping (BtkTextIter *iter,
     }
 }
 
+/* If @text starts with @folded, a case folded string, returns the
+ * end of the match in @text.  Matching part of the folding of a
+ * character doesn't count, as in the buffer's search index.
+ */
+static const bchar *
+caseless_prefix (const bchar *text,
+                 const bchar *folded)
+{
+  while (*folded != '\0')
+    {
+      const bchar *next;
+      bchar *fold;
+      bsize fold_len;
+      bboolean matched;
+
+      if (*text == '\0')
+        return NULL;
+
+      if ((buchar) *text < 0x80)
+        {
+          if (g_ascii_tolower (*text) != *folded)
+            return NULL;
+
+          text++;
+          folded++;
+          continue;
+        }
+
+      next = g_utf8_next_char (text);
+      fold = g_utf8_casefold (text, next - text);
+      fold_len = strlen (fold);
+      matched = strncmp (fold, folded, fold_len) == 0;
+      g_free (fold);
+
+      if (!matched)
+        return NULL;
+
+      folded += fold_len;
+      text = next;
+    }
+
+  return text;
+}
+
+/* Case insensitive strstr(), or with @backward g_strrstr(); the end
+ * of the match is returned in @match_end.
+ */
+static const bchar *
+caseless_find (const bchar  *text,
+               const bchar  *folded,
+               bboolean      backward,
+               const bchar **match_end)
+{
+  const bchar *found = NULL;
+  const bchar *p;
+
+  for (p = text; *p != '\0'; p = g_utf8_next_char (p))
+    {
+      const bchar *end = caseless_prefix (p, folded);
+
+      if (end)
+        {
+          found = p;
+          *match_end = end;
+
+          if (!backward)
+            break;
+        }
+    }
+
+  return found;
+}
+
 static bboolean
 lines_match (const BtkTextIter *start,
              const bchar **lines,
              bboolean visible_only,
              bboolean slice,
+             bboolean case_insensitive,
              BtkTextIter *match_start,
              BtkTextIter *match_end)
 {
   BtkTextIter next;
   bchar *line_text;
   const bchar *found;
+  const bchar *found_end;
   bint offset;
 
   if (*lines == NULL || **lines == '\0')
@@ -4458,17 +4533,33 @@ lines_match (const BtkTextIter *start,
         line_text = btk_text_iter_get_text (start, &next);
     }
 
-  if (match_start) /* if this is the first line we're matching */
-    found = strstr (line_text, *lines);
+  if (case_insensitive)
+    {
+      if (match_start) /* if this is the first line we're matching */
+        found = caseless_find (line_text, *lines, FALSE, &found_end);
+      else
+        {
+          found_end = caseless_prefix (line_text, *lines);
+          found = found_end ? line_text : NULL;
+        }
+    }
   else
     {
-      /* If it's not the first line, we have to match from the
-       * start of the line.
-       */
-      if (strncmp (line_text, *lines, strlen (*lines)) == 0)
-        found = line_text;
+      if (match_start) /* if this is the first line we're matching */
+        found = strstr (line_text, *lines);
       else
-        found = NULL;
+        {
+          /* If it's not the first line, we have to match from the
+           * start of the line.
+           */
+          if (strncmp (line_text, *lines, strlen (*lines)) == 0)
+            found = line_text;
+          else
+            found = NULL;
+        }
+
+      if (found)
+        found_end = found + strlen (*lines);
     }
 
   if (found == NULL)
@@ -4494,7 +4585,7 @@ lines_match (const BtkTextIter *start,
     }
 
   /* Go to end of search string */
-  offset += g_utf8_strlen (*lines, -1);
+  offset += g_utf8_strlen (found, found_end - found);
 
   forward_chars_with_skipping (&next, offset,
                                visible_only, !slice);
@@ -4509,7 +4600,8 @@ lines_match (const BtkTextIter *start,
   /* pass NULL for match_start, since we don't need to find the
    * start again.
    */
-  return lines_match (&next, lines, visible_only, slice, NULL, match_end);
+  return lines_match (&next, lines, visible_only, slice, case_insensitive,
+                      NULL, match_end);
 }
 
 /* strsplit () that retains the delimiter as part of the string. */
@@ -4568,6 +4660,23 @@ strbreakup (const char *string,
   return str_array;
 }
 
+/* The buffer can search a flat copy of its text, which is much
+ * faster than walking the lines.  The copy is made for
+ * btk_text_buffer_find_all() and btk_text_buffer_highlight_all(),
+ * and dropped when the text changes; single searches use it while it
+ * is up to date, but never make it, since a search that stops at the
+ * first match usually looks at a few lines only.
+ */
+static bboolean
+use_search_index (const BtkTextIter *iter,
+                  BtkTextSearchFlags flags)
+{
+  if (flags & (BTK_TEXT_SEARCH_VISIBLE_ONLY | BTK_TEXT_SEARCH_TEXT_ONLY))
+    return FALSE;
+
+  return _btk_text_buffer_has_search_index (btk_text_iter_get_buffer (iter));
+}
+
 /**
  * btk_text_iter_forward_search:
  * @iter: start of search
@@ -4592,6 +4701,9 @@ strbreakup (const char *string,
  * flags are not given, the match must be exact; the special 0xFFFC
  * character in @str will match embedded pixbufs or child widgets.
  *
+ * With #BTK_TEXT_SEARCH_CASE_INSENSITIVE, @str matches regardless of
+ * case; this flag can't be combined with the other two.
+ *
  * Return value: whether a match was found
  **/
 bboolean
@@ -4608,9 +4720,13 @@ btk_text_iter_forward_search (const BtkTextIter *iter,
   BtkTextIter search;
   bboolean visible_only;
   bboolean slice;
+  bboolean case_insensitive;
   
   g_return_val_if_fail (iter != NULL, FALSE);
   g_return_val_if_fail (str != NULL, FALSE);
+  g_return_val_if_fail ((flags & BTK_TEXT_SEARCH_CASE_INSENSITIVE) == 0 ||
+                        (flags & (BTK_TEXT_SEARCH_VISIBLE_ONLY |
+                                  BTK_TEXT_SEARCH_TEXT_ONLY)) == 0, FALSE);
 
   if (limit &&
       btk_text_iter_compare (iter, limit) >= 0)
@@ -4637,12 +4753,26 @@ btk_text_iter_forward_search (const BtkTextIter *iter,
         return FALSE;
     }
 
+  if (use_search_index (iter, flags))
+    return _btk_text_buffer_search (btk_text_iter_get_buffer (iter),
+                                    iter, str, flags, FALSE,
+                                    match_start, match_end, limit);
+
   visible_only = (flags & BTK_TEXT_SEARCH_VISIBLE_ONLY) != 0;
   slice = (flags & BTK_TEXT_SEARCH_TEXT_ONLY) == 0;
+  case_insensitive = (flags & BTK_TEXT_SEARCH_CASE_INSENSITIVE) != 0;
   
   /* locate all lines */
 
-  lines = strbreakup (str, "\n", -1);
+  if (case_insensitive)
+    {
+      bchar *folded = g_utf8_casefold (str, -1);
+
+      lines = strbreakup (folded, "\n", -1);
+      g_free (folded);
+    }
+  else
+    lines = strbreakup (str, "\n", -1);
 
   search = *iter;
 
@@ -4659,7 +4789,7 @@ btk_text_iter_forward_search (const BtkTextIter *iter,
         break;
       
       if (lines_match (&search, (const bchar**)lines,
-                       visible_only, slice, &match, &end))
+                       visible_only, slice, case_insensitive, &match, &end))
         {
           if (limit == NULL ||
               (limit &&
@@ -4732,6 +4862,33 @@ vectors_equal_ignoring_trailing (bchar **vec1,
     return TRUE;
 }
 
+/* Like vectors_equal_ignoring_trailing(), for case folded lines in
+ * @folded; adds the length of the match in @vec2, in characters, to
+ * @n_chars.
+ */
+static bboolean
+vectors_match_caseless (bchar **folded,
+                        bchar **vec2,
+                        bint   *n_chars)
+{
+  while (*folded && *vec2)
+    {
+      const bchar *end = caseless_prefix (*vec2, *folded);
+
+      /* Only the last line may have trailing chars */
+      if (end == NULL ||
+          (*end != '\0' && *(vec2 + 1) != NULL))
+        return FALSE;
+
+      *n_chars += g_utf8_strlen (*vec2, end - *vec2);
+
+      ++folded;
+      ++vec2;
+    }
+
+  return *folded == NULL && *vec2 == NULL;
+}
+
 typedef struct _LinesWindow LinesWindow;
 
 struct _LinesWindow
@@ -4893,9 +5050,13 @@ btk_text_iter_backward_search (const BtkTextIter *iter,
   bboolean retval = FALSE;
   bboolean visible_only;
   bboolean slice;
+  bboolean case_insensitive;
   
   g_return_val_if_fail (iter != NULL, FALSE);
   g_return_val_if_fail (str != NULL, FALSE);
+  g_return_val_if_fail ((flags & BTK_TEXT_SEARCH_CASE_INSENSITIVE) == 0 ||
+                        (flags & (BTK_TEXT_SEARCH_VISIBLE_ONLY |
+                                  BTK_TEXT_SEARCH_TEXT_ONLY)) == 0, FALSE);
 
   if (limit &&
       btk_text_iter_compare (limit, iter) > 0)
@@ -4921,12 +5082,26 @@ btk_text_iter_backward_search (const BtkTextIter *iter,
         return FALSE;
     }
 
+  if (use_search_index (iter, flags))
+    return _btk_text_buffer_search (btk_text_iter_get_buffer (iter),
+                                    iter, str, flags, TRUE,
+                                    match_start, match_end, limit);
+
   visible_only = (flags & BTK_TEXT_SEARCH_VISIBLE_ONLY) != 0;
   slice = (flags & BTK_TEXT_SEARCH_TEXT_ONLY) == 0;
+  case_insensitive = (flags & BTK_TEXT_SEARCH_CASE_INSENSITIVE) != 0;
   
   /* locate all lines */
 
-  lines = strbreakup (str, "\n", -1);
+  if (case_insensitive)
+    {
+      bchar *folded = g_utf8_casefold (str, -1);
+
+      lines = strbreakup (folded, "\n", -1);
+      g_free (folded);
+    }
+  else
+    lines = strbreakup (str, "\n", -1);
 
   l = lines;
   n_lines = 0;
@@ -4947,7 +5122,10 @@ btk_text_iter_backward_search (const BtkTextIter *iter,
 
   do
     {
-      bchar *first_line_match;
+      const bchar *first_line_match;
+      const bchar *first_line_match_end;
+      bboolean matched;
+      bint n_chars = 0;
 
       if (limit &&
           btk_text_iter_compare (limit, &win.first_line_end) > 0)
@@ -4960,10 +5138,24 @@ btk_text_iter_backward_search (const BtkTextIter *iter,
        * end in '\n', so this will only match at the
        * end of the first line, which is correct.
        */
-      first_line_match = g_strrstr (*win.lines, *lines);
+      if (case_insensitive)
+        {
+          first_line_match = caseless_find (*win.lines, *lines, TRUE,
+                                            &first_line_match_end);
+          matched = first_line_match &&
+                    vectors_match_caseless (lines + 1, win.lines + 1, &n_chars);
+          if (matched)
+            n_chars += g_utf8_strlen (first_line_match,
+                                      first_line_match_end - first_line_match);
+        }
+      else
+        {
+          first_line_match = g_strrstr (*win.lines, *lines);
+          matched = first_line_match &&
+                    vectors_equal_ignoring_trailing (lines + 1, win.lines + 1);
+        }
 
-      if (first_line_match &&
-          vectors_equal_ignoring_trailing (lines + 1, win.lines + 1))
+      if (matched)
         {
           /* Match! */
           bint offset;
@@ -4986,11 +5178,16 @@ btk_text_iter_backward_search (const BtkTextIter *iter,
             *match_start = start_tmp;
 
           /* Go to end of search string */
-          l = lines;
-          while (*l)
+          if (case_insensitive)
+            offset += n_chars;
+          else
             {
-              offset += g_utf8_strlen (*l, -1);
-              ++l;
+              l = lines;
+              while (*l)
+                {
+                  offset += g_utf8_strlen (*l, -1);
+                  ++l;
+                }
             }
 
           forward_chars_with_skipping (&next, offset,
@@ -5470,7 +5667,7 @@ _btk_text_iter_check (const BtkTextIter *iter)
           if (byte_segment->type == &btk_text_char_type)
             {
               const bchar *p;
-              p = byte_segment->body.chars + seg_byte_offset;
+              p = byte_segment->body.text.chars + seg_byte_offset;
               
               if (!btk_text_byte_begins_utf8_char (p))
                 g_error ("broken iterator byte index pointed into the middle of a character");
@@ -5501,7 +5698,7 @@ _btk_text_iter_check (const BtkTextIter *iter)
           if (char_segment->type == &btk_text_char_type)
             {
               const bchar *p;
-              p = g_utf8_offset_to_pointer (char_segment->body.chars,
+              p = g_utf8_offset_to_pointer (char_segment->body.text.chars,
                                             seg_char_offset);
 
               /* hmm, not likely to happen eh */
@@ -5527,7 +5724,7 @@ _btk_text_iter_check (const BtkTextIter *iter)
           bint char_offset = 0;
           while (char_offset < seg_char_offset)
             {
-              const char * start = char_segment->body.chars + byte_offset;
+              const char * start = char_segment->body.text.chars + byte_offset;
               byte_offset += g_utf8_next_char (start) - start;
               char_offset += 1;
             }
@@ -5536,12 +5733,12 @@ _btk_text_iter_check (const BtkTextIter *iter)
             g_error ("byte offset did not correspond to char offset");
 
           char_offset =
-            g_utf8_strlen (char_segment->body.chars, seg_byte_offset);
+            g_utf8_strlen (char_segment->body.text.chars, seg_byte_offset);
 
           if (char_offset != seg_char_offset)
             g_error ("char offset did not correspond to byte offset");
 
-          if (!btk_text_byte_begins_utf8_char (char_segment->body.chars + seg_byte_offset))
+          if (!btk_text_byte_begins_utf8_char (char_segment->body.text.chars + seg_byte_offset))
             g_error ("byte index for iterator does not index the start of a character");
         }
     }
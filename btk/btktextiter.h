@@ -37,9 +37,10 @@
 B_BEGIN_DECLS
 
 typedef enum {
-  BTK_TEXT_SEARCH_VISIBLE_ONLY = 1 << 0,
-  BTK_TEXT_SEARCH_TEXT_ONLY    = 1 << 1
-  /* Possible future plans: SEARCH_CASE_INSENSITIVE, SEARCH_REGEXP */
+  BTK_TEXT_SEARCH_VISIBLE_ONLY     = 1 << 0,
+  BTK_TEXT_SEARCH_TEXT_ONLY        = 1 << 1,
+  BTK_TEXT_SEARCH_CASE_INSENSITIVE = 1 << 2
+  /* Possible future plans: SEARCH_REGEXP */
 } BtkTextSearchFlags;
 
 /*
@@ -93,14 +93,81 @@
 
 typedef struct _BtkTextLayoutPrivate BtkTextLayoutPrivate;
 
+typedef struct _WrapLine  WrapLine;
+typedef struct _WrapBatch WrapBatch;
+
+struct _WrapLine
+{
+  BtkTextLine *line;            /* never dereferenced by the wrap thread */
+  bint offset;                  /* into the batch text */
+  bint length;
+  bboolean rtl;
+
+  /* Filled in by the wrap thread */
+  bint width;
+  bint height;
+};
+
+/* A run of paragraphs to measure on the wrap thread, along with
+ * copies of everything the thread needs to know about the layout.
+ */
+struct _WrapBatch
+{
+  BtkTextLayout *layout;
+  buint stamp;
+  volatile bint cancelled;
+
+  BtkTextAttributes *style;
+  bint screen_width;
+  bboolean default_font_type;   /* if the layout's isn't a bairo font map */
+  bairo_font_type_t font_type;
+  bdouble resolution;
+  bairo_font_options_t *font_options;
+  BangoLanguage *language;
+
+  GString *text;
+  GArray *lines;
+};
+
 struct _BtkTextLayoutPrivate
 {
   /* Cache the line that the cursor is positioned on, as the keyboard
      direction only influences the direction of the cursor line.
   */
   BtkTextLine *cursor_line;
+
+  /* Recently drawn line displays, most recently used first, so that
+   * exposes and scrolling don't rebuild the Bango layouts of every
+   * visible line.  Size-only displays made while wrapping go to
+   * one_display_cache instead, so validating offscreen lines does
+   * not push the visible ones out.
+   */
+  GHashTable *display_cache;    /* BtkTextLine -> link in display_lru */
+  GQueue      display_lru;
+  buint       display_cache_hits;
+  buint       display_cache_misses;
+
+  /* Heights of offscreen paragraphs measured by the wrap thread,
+   * waiting to be fed into the btree; see
+   * btk_text_layout_validate_in_background().  Invalidating a line
+   * throws away its height, and marks it stale if it may be in the
+   * batch being measured, so edits don't cost the rest of the batch.
+   */
+  GHashTable *wrapped_lines;    /* BtkTextLine -> WrapLine */
+  GSList     *wrap_batches;     /* finished batches owning the WrapLines */
+  WrapBatch  *wrap_batch;       /* batch being measured, if any */
+  GHashTable *wrap_stale;       /* lines invalidated since wrap_batch began */
+  buint       wrap_stamp;
+  buint       wrap_idle;        /* feeds measured heights into the btree */
 };
 
+/* Enough for a few screenfuls of lines */
+#define DISPLAY_CACHE_SIZE 256
+
+/* How much to hand to the wrap thread at once */
+#define WRAP_BATCH_LINES 512
+#define WRAP_BATCH_BYTES (256 * 1024)
+
 static BtkTextLineData *btk_text_layout_real_wrap (BtkTextLayout *layout,
                                                    BtkTextLine *line,
                                                    /* may be NULL */
@@ -117,6 +184,10 @@ static void btk_text_layout_real_invalidate_cursors(BtkTextLayout     *layout,
 static void btk_text_layout_invalidate_cache       (BtkTextLayout     *layout,
 						    BtkTextLine       *line,
 						    bboolean           cursors_only);
+static void btk_text_layout_invalidate_cache_range (BtkTextLayout     *layout,
+                                                    BtkTextLine       *first_line,
+                                                    BtkTextLine       *last_line,
+                                                    bboolean           cursors_only);
 static void btk_text_layout_invalidate_cursor_line (BtkTextLayout     *layout,
 						    bboolean           cursors_only);
 static void btk_text_layout_real_free_line_data    (BtkTextLayout     *layout,
@@ -147,6 +218,13 @@ static void btk_text_layout_buffer_delete_range (BtkTextBuffer     *textbuffer,
 
 static void btk_text_layout_update_cursor_line (BtkTextLayout *layout);
 
+static void set_bango_para_values     (BangoLayout       *bango_layout,
+                                       BangoDirection     base_dir,
+                                       BtkTextAttributes *style,
+                                       bint               screen_width);
+static bint strip_paragraph_delimiter (const bchar       *text,
+                                       bint               length);
+
 static void line_display_index_to_iter (BtkTextLayout      *layout,
 	                                BtkTextLineDisplay *display,
 			                BtkTextIter        *iter,
@@ -233,7 +311,14 @@ btk_text_layout_class_init (BtkTextLayoutClass *klass)
 static void
 btk_text_layout_init (BtkTextLayout *text_layout)
 {
+  BtkTextLayoutPrivate *priv = BTK_TEXT_LAYOUT_GET_PRIVATE (text_layout);
+
   text_layout->cursor_visible = TRUE;
+
+  priv->display_cache = g_hash_table_new (g_direct_hash, g_direct_equal);
+  g_queue_init (&priv->display_lru);
+  priv->wrapped_lines = g_hash_table_new (g_direct_hash, g_direct_equal);
+  priv->wrap_stale = g_hash_table_new (g_direct_hash, g_direct_equal);
 }
 
 BtkTextLayout*
@@ -252,12 +337,177 @@ free_style_cache (BtkTextLayout *text_layout)
     }
 }
 
+static void
+line_display_free (BtkTextLineDisplay *display)
+{
+  if (display->layout)
+    g_object_unref (display->layout);
+
+  if (display->cursors)
+    {
+      b_slist_foreach (display->cursors, (GFunc)g_free, NULL);
+      b_slist_free (display->cursors);
+    }
+  b_slist_free (display->shaped_objects);
+
+  if (display->pg_bg_color)
+    bdk_color_free (display->pg_bg_color);
+
+  g_free (display);
+}
+
+static BtkTextLineDisplay *
+display_cache_lookup (BtkTextLayout *layout,
+                      BtkTextLine   *line)
+{
+  BtkTextLayoutPrivate *priv = BTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  GList *link;
+
+  link = g_hash_table_lookup (priv->display_cache, line);
+  if (link == NULL)
+    return NULL;
+
+  if (link != priv->display_lru.head)
+    {
+      g_queue_unlink (&priv->display_lru, link);
+      g_queue_push_head_link (&priv->display_lru, link);
+    }
+
+  return link->data;
+}
+
+static void
+display_cache_remove (BtkTextLayout *layout,
+                      GList         *link)
+{
+  BtkTextLayoutPrivate *priv = BTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  BtkTextLineDisplay *display = link->data;
+
+  g_hash_table_remove (priv->display_cache, display->line);
+  g_queue_delete_link (&priv->display_lru, link);
+  line_display_free (display);
+}
+
+static void
+display_cache_insert (BtkTextLayout      *layout,
+                      BtkTextLineDisplay *display)
+{
+  BtkTextLayoutPrivate *priv = BTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+
+  if (priv->display_lru.length >= DISPLAY_CACHE_SIZE)
+    display_cache_remove (layout, priv->display_lru.tail);
+
+  g_queue_push_head (&priv->display_lru, display);
+  g_hash_table_insert (priv->display_cache, display->line,
+                       priv->display_lru.head);
+}
+
+static bboolean
+display_is_cached (BtkTextLayout      *layout,
+                   BtkTextLineDisplay *display)
+{
+  BtkTextLayoutPrivate *priv = BTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  GList *link;
+
+  if (display == layout->one_display_cache)
+    return TRUE;
+
+  link = g_hash_table_lookup (priv->display_cache, display->line);
+
+  return link != NULL && link->data == display;
+}
+
+static void
+free_display_cache (BtkTextLayout *layout)
+{
+  BtkTextLayoutPrivate *priv = BTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+
+  while (priv->display_lru.head)
+    display_cache_remove (layout, priv->display_lru.head);
+
+  if (layout->one_display_cache)
+    {
+      BtkTextLineDisplay *tmp_display = layout->one_display_cache;
+      layout->one_display_cache = NULL;
+      line_display_free (tmp_display);
+    }
+}
+
+static void
+wrap_batch_free (WrapBatch *batch)
+{
+  btk_text_attributes_unref (batch->style);
+  if (batch->font_options)
+    bairo_font_options_destroy (batch->font_options);
+  g_string_free (batch->text, TRUE);
+  g_array_free (batch->lines, TRUE);
+  g_free (batch);
+}
+
+static void
+free_wrap_batches (BtkTextLayout *layout)
+{
+  BtkTextLayoutPrivate *priv = BTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+
+  b_slist_foreach (priv->wrap_batches, (GFunc) wrap_batch_free, NULL);
+  b_slist_free (priv->wrap_batches);
+  priv->wrap_batches = NULL;
+}
+
+/* Drops all measured heights, and the results of the batch that is
+ * being measured, for changes that affect every line such as a new
+ * style, screen width or buffer.
+ */
+static void
+forget_wrapped_lines (BtkTextLayout *layout)
+{
+  BtkTextLayoutPrivate *priv = BTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+
+  priv->wrap_stamp++;
+
+  if (priv->wrap_batch)
+    {
+      /* Freed when the wrap thread hands it back */
+      g_atomic_int_set (&priv->wrap_batch->cancelled, TRUE);
+      priv->wrap_batch = NULL;
+    }
+
+  if (priv->wrap_idle)
+    {
+      g_source_remove (priv->wrap_idle);
+      priv->wrap_idle = 0;
+    }
+
+  g_hash_table_remove_all (priv->wrapped_lines);
+  g_hash_table_remove_all (priv->wrap_stale);
+  free_wrap_batches (layout);
+}
+
+/* Drops the measured height of @line only, since it changed or is
+ * being freed; the rest of the batches stay usable.
+ */
+static void
+forget_wrapped_line (BtkTextLayout *layout,
+                     BtkTextLine   *line)
+{
+  BtkTextLayoutPrivate *priv = BTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+
+  if (priv->wrap_batch)
+    g_hash_table_insert (priv->wrap_stale, line, line);
+
+  if (g_hash_table_remove (priv->wrapped_lines, line) &&
+      g_hash_table_size (priv->wrapped_lines) == 0)
+    free_wrap_batches (layout);
+}
+
 static void
 btk_text_layout_finalize (BObject *object)
 {
   BtkTextLayout *layout;
+  BtkTextLayoutPrivate *priv;
 
   layout = BTK_TEXT_LAYOUT (object);
+  priv = BTK_TEXT_LAYOUT_GET_PRIVATE (layout);
 
   btk_text_layout_set_buffer (layout, NULL);
 
@@ -276,12 +526,11 @@ btk_text_layout_finalize (BObject *object)
       layout->rtl_context = NULL;
     }
   
-  if (layout->one_display_cache) 
-    {
-      BtkTextLineDisplay *tmp_display = layout->one_display_cache;
-      layout->one_display_cache = NULL;
-      btk_text_layout_free_line_display (layout, tmp_display);
-    }
+  free_display_cache (layout);
+  g_hash_table_destroy (priv->display_cache);
+  forget_wrapped_lines (layout);
+  g_hash_table_destroy (priv->wrapped_lines);
+  g_hash_table_destroy (priv->wrap_stale);
 
   if (layout->preedit_string)
     {
@@ -314,6 +563,8 @@ btk_text_layout_set_buffer (BtkTextLayout *layout,
     return;
 
   free_style_cache (layout);
+  free_display_cache (layout);
+  forget_wrapped_lines (layout);
 
   if (layout->buffer)
     {
@@ -639,18 +890,23 @@ text_layout_changed (BtkTextLayout *layout,
                      bint           new_height,
                      bboolean       cursors_only)
 {
-  /* Check if the range intersects our cached line display,
-   * and invalidate the cached line if so.
-   */
-  if (layout->one_display_cache)
+  /* Invalidate the cached line displays in the changed range */
+  if (old_height > 0)
     {
-      BtkTextLine *line = layout->one_display_cache->line;
-      bint cache_y = _btk_text_btree_find_line_top (_btk_text_buffer_get_btree (layout->buffer),
-						    line, layout);
-      bint cache_height = layout->one_display_cache->height;
+      BtkTextBTree *btree = _btk_text_buffer_get_btree (layout->buffer);
+      BtkTextLine *first_line, *last_line;
+
+      first_line = _btk_text_btree_find_line_by_y (btree, layout, y, NULL);
+      if (first_line)
+        {
+          last_line = _btk_text_btree_find_line_by_y (btree, layout,
+                                                      y + old_height - 1, NULL);
+          if (!last_line)
+            last_line = _btk_text_btree_get_end_iter_line (btree);
 
-      if (cache_y + cache_height > y && cache_y < y + old_height)
-	btk_text_layout_invalidate_cache (layout, line, cursors_only);
+          btk_text_layout_invalidate_cache_range (layout, first_line, last_line,
+                                                  cursors_only);
+        }
     }
 
   btk_text_layout_emit_changed (layout, y, old_height, new_height);
@@ -812,34 +1068,124 @@ btk_text_layout_invalidate_all (BtkTextLayout *layout)
   if (layout->buffer == NULL)
     return;
 
+  forget_wrapped_lines (layout);
+
   btk_text_buffer_get_bounds (layout->buffer, &start, &end);
 
   btk_text_layout_invalidate (layout, &start, &end);
 }
 
+static void
+invalidate_display_cursors (BtkTextLineDisplay *display)
+{
+  b_slist_foreach (display->cursors, (GFunc)g_free, NULL);
+  b_slist_free (display->cursors);
+  display->cursors = NULL;
+  display->cursors_invalid = TRUE;
+  display->has_block_cursor = FALSE;
+}
+
 static void
 btk_text_layout_invalidate_cache (BtkTextLayout *layout,
                                   BtkTextLine   *line,
 				  bboolean       cursors_only)
 {
+  BtkTextLayoutPrivate *priv = BTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  GList *link;
+
   if (layout->one_display_cache && line == layout->one_display_cache->line)
     {
       BtkTextLineDisplay *display = layout->one_display_cache;
 
       if (cursors_only)
-	{
-	  b_slist_foreach (display->cursors, (GFunc)g_free, NULL);
-	  b_slist_free (display->cursors);
-	  display->cursors = NULL;
-	  display->cursors_invalid = TRUE;
-	  display->has_block_cursor = FALSE;
-	}
+	invalidate_display_cursors (display);
       else
 	{
 	  layout->one_display_cache = NULL;
-	  btk_text_layout_free_line_display (layout, display);
+	  line_display_free (display);
 	}
     }
+
+  link = g_hash_table_lookup (priv->display_cache, line);
+  if (link)
+    {
+      if (cursors_only)
+        invalidate_display_cursors (link->data);
+      else
+        display_cache_remove (layout, link);
+    }
+}
+
+/* Invalidates the cached displays of the lines from @first_line to
+ * @last_line, without walking a long range line by line.
+ */
+static void
+btk_text_layout_invalidate_cache_range (BtkTextLayout *layout,
+                                        BtkTextLine   *first_line,
+                                        BtkTextLine   *last_line,
+                                        bboolean       cursors_only)
+{
+  BtkTextLayoutPrivate *priv = BTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  bint first, last;
+  GList *link, *next;
+
+  if (priv->display_lru.length == 0 && layout->one_display_cache == NULL)
+    return;
+
+  first = _btk_text_line_get_number (first_line);
+  last = _btk_text_line_get_number (last_line);
+  if (first > last)
+    {
+      bint tmp = first;
+      BtkTextLine *tmp_line = first_line;
+
+      first = last;
+      last = tmp;
+      first_line = last_line;
+      last_line = tmp_line;
+    }
+
+  if (last - first < (bint) priv->display_lru.length + 1)
+    {
+      BtkTextLine *line = first_line;
+
+      while (TRUE)
+        {
+          btk_text_layout_invalidate_cache (layout, line, cursors_only);
+
+          if (line == last_line)
+            break;
+
+          line = _btk_text_line_next_excluding_last (line);
+        }
+      return;
+    }
+
+  for (link = priv->display_lru.head; link; link = next)
+    {
+      BtkTextLineDisplay *display = link->data;
+      bint n = _btk_text_line_get_number (display->line);
+
+      next = link->next;
+
+      if (n >= first && n <= last)
+        {
+          if (cursors_only)
+            invalidate_display_cursors (display);
+          else
+            display_cache_remove (layout, link);
+        }
+    }
+
+  if (layout->one_display_cache)
+    {
+      bint n = _btk_text_line_get_number (layout->one_display_cache->line);
+
+      if (n >= first && n <= last)
+        btk_text_layout_invalidate_cache (layout,
+                                          layout->one_display_cache->line,
+                                          cursors_only);
+    }
 }
 
 /* Now invalidate the paragraph containing the cursor
@@ -912,6 +1258,7 @@ btk_text_layout_real_invalidate (BtkTextLayout *layout,
       BtkTextLineData *line_data = _btk_text_line_get_data (line, layout);
 
       btk_text_layout_invalidate_cache (layout, line, FALSE);
+      forget_wrapped_line (layout, line);
       
       if (line_data)
         _btk_text_line_invalidate_wrap (line, line_data);
@@ -930,37 +1277,26 @@ btk_text_layout_real_invalidate_cursors (BtkTextLayout     *layout,
 					 const BtkTextIter *start,
 					 const BtkTextIter *end)
 {
-  /* Check if the range intersects our cached line display,
-   * and invalidate the cached line if so.
-   */
-  if (layout->one_display_cache)
-    {
-      BtkTextIter line_start, line_end;
-      BtkTextLine *line = layout->one_display_cache->line;
-
-      _btk_text_btree_get_iter_at_line (_btk_text_buffer_get_btree (layout->buffer),
-                                        &line_start, line, 0);
-      line_end = line_start;
-      if (!btk_text_iter_ends_line (&line_end))
-	btk_text_iter_forward_to_line_end (&line_end);
-
-      if (btk_text_iter_compare (start, end) > 0)
-	{
-	  const BtkTextIter *tmp = start;
-	  start = end;
-	  end = tmp;
-	}
-
-      if (btk_text_iter_compare (&line_start, end) <= 0 &&
-	  btk_text_iter_compare (start, &line_end) <= 0)
-	{
-	  btk_text_layout_invalidate_cache (layout, line, TRUE);
-	}
-    }
+  /* Invalidate the cursors of the cached line displays in the range */
+  btk_text_layout_invalidate_cache_range (layout,
+                                          _btk_text_iter_get_text_line (start),
+                                          _btk_text_iter_get_text_line (end),
+                                          TRUE);
 
   btk_text_layout_invalidated (layout);
 }
 
+/* Called by the btree for every line it destroys, whether or not the
+ * layout has line data for it, so no cached display outlives its line.
+ */
+void
+_btk_text_layout_line_deleted (BtkTextLayout *layout,
+                               BtkTextLine   *line)
+{
+  btk_text_layout_invalidate_cache (layout, line, FALSE);
+  forget_wrapped_line (layout, line);
+}
+
 static void
 btk_text_layout_real_free_line_data (BtkTextLayout     *layout,
                                      BtkTextLine       *line,
@@ -984,167 +1320,668 @@ btk_text_layout_is_valid (BtkTextLayout *layout)
 {
   g_return_val_if_fail (BTK_IS_TEXT_LAYOUT (layout), FALSE);
 
-  return _btk_text_btree_is_valid (_btk_text_buffer_get_btree (layout->buffer),
-                                  layout);
-}
+  return _btk_text_btree_is_valid (_btk_text_buffer_get_btree (layout->buffer),
+                                  layout);
+}
+
+static void
+update_layout_size (BtkTextLayout *layout)
+{
+  _btk_text_btree_get_view_size (_btk_text_buffer_get_btree (layout->buffer),
+				layout,
+				&layout->width, &layout->height);
+}
+
+/* Consecutive lines validated by btk_text_layout_validate_yrange() */
+typedef struct
+{
+  BtkTextLine *first_line;
+  bint         line_top;
+  bint         old_height;
+  bint         new_height;
+} ValidatedRun;
+
+/* Validates @line if needed, adding it to the last run in @runs if
+ * @in_run, or to a new one otherwise.  @backward says whether lines
+ * are visited bottom up.  Returns the line's height.
+ */
+static bint
+validate_yrange_line (BtkTextLayout *layout,
+                      BtkTextLine   *line,
+                      bboolean       backward,
+                      GArray        *runs,
+                      bboolean      *in_run)
+{
+  BtkTextLineData *line_data;
+  ValidatedRun *run;
+  bint old_height, new_height;
+
+  line_data = _btk_text_line_get_data (line, layout);
+
+  if (line_data && line_data->valid)
+    {
+      *in_run = FALSE;
+      return line_data->height;
+    }
+
+  old_height = line_data ? line_data->height : 0;
+
+  _btk_text_btree_validate_line (_btk_text_buffer_get_btree (layout->buffer),
+                                 line, layout);
+  line_data = _btk_text_line_get_data (line, layout);
+
+  new_height = line_data ? line_data->height : 0;
+
+  if (!*in_run)
+    {
+      g_array_set_size (runs, runs->len + 1);
+      *in_run = TRUE;
+    }
+
+  run = &g_array_index (runs, ValidatedRun, runs->len - 1);
+  if (backward || run->first_line == NULL)
+    run->first_line = line;
+  run->old_height += old_height;
+  run->new_height += new_height;
+
+  return new_height;
+}
+
+/**
+ * btk_text_layout_validate_yrange:
+ * @layout: a #BtkTextLayout
+ * @anchor: iter pointing into a line that will be used as the
+ *          coordinate origin
+ * @y0_: offset from the top of the line pointed to by @anchor at
+ *       which to begin validation. (The offset here is in pixels
+ *       after validation.)
+ * @y1_: offset from the top of the line pointed to by @anchor at
+ *       which to end validation. (The offset here is in pixels
+ *       after validation.)
+ *
+ * Ensure that a rebunnyion of a #BtkTextLayout is valid. The ::changed
+ * signal will be emitted for every run of consecutive lines that had
+ * to be validated, from top to bottom, so that lines in between that
+ * were valid need not be redrawn.
+ */
+void
+btk_text_layout_validate_yrange (BtkTextLayout *layout,
+                                 BtkTextIter   *anchor,
+                                 bint           y0,
+                                 bint           y1)
+{
+  BtkTextLine *line;
+  GArray *runs;
+  bint n_backward_runs;
+  bboolean in_run;
+  bint seen;
+  bint i;
+
+  g_return_if_fail (BTK_IS_TEXT_LAYOUT (layout));
+
+  if (y0 > 0)
+    y0 = 0;
+  if (y1 < 0)
+    y1 = 0;
+
+  runs = g_array_new (FALSE, TRUE, sizeof (ValidatedRun));
+
+  /* Validate backwards from the anchor line to y0; these runs are
+   * collected bottom up.
+   */
+  line = _btk_text_iter_get_text_line (anchor);
+  line = _btk_text_line_previous (line);
+  seen = 0;
+  in_run = FALSE;
+  while (line && seen < -y0)
+    {
+      seen += validate_yrange_line (layout, line, TRUE, runs, &in_run);
+      line = _btk_text_line_previous (line);
+    }
+
+  n_backward_runs = runs->len;
+
+  /* Validate forwards to y1 */
+  line = _btk_text_iter_get_text_line (anchor);
+  seen = 0;
+  in_run = FALSE;
+  while (line && seen < y1)
+    {
+      seen += validate_yrange_line (layout, line, FALSE, runs, &in_run);
+      line = _btk_text_line_next_excluding_last (line);
+    }
+
+  /* If we found and validated any invalid lines, update size and
+   * emit the changed signal
+   */
+  if (runs->len > 0)
+    {
+      update_layout_size (layout);
+
+      /* Find all the tops before emitting anything, since handlers
+       * may change the buffer
+       */
+      for (i = 0; i < (bint) runs->len; i++)
+        {
+          ValidatedRun *run = &g_array_index (runs, ValidatedRun, i);
+
+          run->line_top = _btk_text_btree_find_line_top (_btk_text_buffer_get_btree (layout->buffer),
+                                                         run->first_line, layout);
+        }
+
+      for (i = n_backward_runs - 1; i >= 0; i--)
+        {
+          ValidatedRun *run = &g_array_index (runs, ValidatedRun, i);
+
+          btk_text_layout_emit_changed (layout, run->line_top,
+                                        run->old_height, run->new_height);
+        }
+
+      for (i = n_backward_runs; i < (bint) runs->len; i++)
+        {
+          ValidatedRun *run = &g_array_index (runs, ValidatedRun, i);
+
+          btk_text_layout_emit_changed (layout, run->line_top,
+                                        run->old_height, run->new_height);
+        }
+    }
+
+  g_array_free (runs, TRUE);
+}
+
+/**
+ * btk_text_layout_validate:
+ * @tree: a #BtkTextLayout
+ * @max_pixels: the maximum number of pixels to validate. (No more
+ *              than one paragraph beyond this limit will be validated)
+ *
+ * Validate rebunnyions of a #BtkTextLayout. The ::changed signal will
+ * be emitted for each rebunnyion validated.
+ **/
+void
+btk_text_layout_validate (BtkTextLayout *layout,
+                          bint           max_pixels)
+{
+  bint y, old_height, new_height;
+
+  g_return_if_fail (BTK_IS_TEXT_LAYOUT (layout));
+
+  while (max_pixels > 0 &&
+         _btk_text_btree_validate (_btk_text_buffer_get_btree (layout->buffer),
+                                   layout,  max_pixels,
+                                   &y, &old_height, &new_height))
+    {
+      max_pixels -= new_height;
+
+      update_layout_size (layout);
+      btk_text_layout_emit_changed (layout, y, old_height, new_height);
+    }
+}
+
+/*
+ * Background wrapping
+ *
+ * Measuring the height of a paragraph is the expensive part of
+ * validation, so for plain paragraphs (no tags, pixbufs, children or
+ * preedit) it is done on a worker thread instead.  The worker makes
+ * its own contexts from the layout's font map, set up like the
+ * layout's contexts, so that it measures with the same fonts, and only
+ * ever sees copies of the text; the heights it finds are fed into the
+ * btree by the main thread through the normal validation path.
+ */
+
+static GThreadPool *wrap_pool = NULL;
+
+static bboolean
+wrap_thread_supported (void)
+{
+  return g_thread_supported ();
+}
+
+/* Whether the size of @line depends only on its text and the default
+ * style, so that it can be measured without looking at the buffer.
+ */
+static bboolean
+line_wraps_in_background (BtkTextLayout *layout,
+                          BtkTextLine   *line,
+                          bboolean       check_tags)
+{
+  BtkTextLayoutPrivate *priv = BTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  BtkTextLineSegment *seg;
+
+  /* The cursor line has the preedit string and keyboard direction */
+  if (line == priv->cursor_line)
+    return FALSE;
+
+  for (seg = line->segments; seg != NULL; seg = seg->next)
+    {
+      if (seg->type != &btk_text_char_type &&
+          seg->type != &btk_text_right_mark_type &&
+          seg->type != &btk_text_left_mark_type)
+        return FALSE;
+    }
+
+  if (check_tags)
+    {
+      BtkTextIter iter;
+      BtkTextTag **tags;
+      bint n_tags;
+
+      _btk_text_btree_get_iter_at_line (_btk_text_buffer_get_btree (layout->buffer),
+                                        &iter, line, 0);
+      tags = _btk_text_btree_get_tags (&iter, &n_tags);
+      g_free (tags);
+
+      if (n_tags > 0)
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+static void
+wrap_batch_add_line (WrapBatch   *batch,
+                     BtkTextLine *line)
+{
+  BtkTextLineSegment *seg;
+  BangoDirection base_dir;
+  WrapLine wrap_line;
+
+  wrap_line.line = line;
+  wrap_line.offset = batch->text->len;
+
+  for (seg = line->segments; seg != NULL; seg = seg->next)
+    if (seg->type == &btk_text_char_type)
+      g_string_append_len (batch->text, seg->body.text.chars, seg->byte_count);
+
+  wrap_line.length = strip_paragraph_delimiter (batch->text->str + wrap_line.offset,
+                                                batch->text->len - wrap_line.offset);
+
+  /* Same as in btk_text_layout_get_line_display() */
+  base_dir = line->dir_propagated_forward;
+  if (base_dir == BANGO_DIRECTION_NEUTRAL)
+    base_dir = line->dir_propagated_back;
+
+  if (base_dir == BANGO_DIRECTION_NEUTRAL)
+    wrap_line.rtl = batch->style->direction == BTK_TEXT_DIR_RTL;
+  else
+    wrap_line.rtl = base_dir == BANGO_DIRECTION_RTL;
+
+  wrap_line.width = 0;
+  wrap_line.height = 0;
+
+  g_array_append_val (batch->lines, wrap_line);
+}
+
+static WrapBatch *
+wrap_batch_new (BtkTextLayout *layout)
+{
+  BtkTextLayoutPrivate *priv = BTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  const bairo_font_options_t *font_options;
+  BangoFontMap *font_map;
+  WrapBatch *batch;
+
+  batch = g_new0 (WrapBatch, 1);
+  batch->layout = g_object_ref (layout);
+  batch->stamp = priv->wrap_stamp;
+
+  batch->style = btk_text_attributes_copy (layout->default_style);
+  batch->screen_width = layout->screen_width;
+  font_map = bango_context_get_font_map (layout->ltr_context);
+  if (BANGO_IS_BAIRO_FONT_MAP (font_map))
+    batch->font_type = bango_bairo_font_map_get_font_type (BANGO_BAIRO_FONT_MAP (font_map));
+  else
+    batch->default_font_type = TRUE;
+  batch->resolution = bango_bairo_context_get_resolution (layout->ltr_context);
+  font_options = bango_bairo_context_get_font_options (layout->ltr_context);
+  if (font_options)
+    batch->font_options = bairo_font_options_copy (font_options);
+  batch->language = bango_context_get_language (layout->ltr_context);
+
+  batch->text = g_string_sized_new (WRAP_BATCH_BYTES);
+  batch->lines = g_array_sized_new (FALSE, FALSE, sizeof (WrapLine),
+                                    WRAP_BATCH_LINES);
+
+  return batch;
+}
+
+/* Feeds the measured heights into the btree, and keeps validating
+ * until the next batch goes to the wrap thread.  Only the lines that
+ * get validated are reported, through ::changed, so the view does not
+ * have to revalidate what is onscreen for every batch.
+ */
+static bboolean
+wrap_idle_callback (bpointer data)
+{
+  BtkTextLayout *layout = data;
+  BtkTextLayoutPrivate *priv = BTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+
+  if (!btk_text_layout_is_valid (layout) &&
+      btk_text_layout_validate_in_background (layout, 2000) &&
+      !btk_text_layout_is_valid (layout))
+    return TRUE;
+
+  priv->wrap_idle = 0;
+
+  return FALSE;
+}
+
+static bboolean
+wrap_batch_done (bpointer data)
+{
+  WrapBatch *batch = data;
+  BtkTextLayout *layout = batch->layout;
+  BtkTextLayoutPrivate *priv = BTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  buint i;
+
+  if (!batch->cancelled && batch->stamp == priv->wrap_stamp)
+    {
+      priv->wrap_batch = NULL;
+
+      /* Lines edited or freed while the batch was measured are left
+       * for the main thread to lay out again.
+       */
+      for (i = 0; i < batch->lines->len; i++)
+        {
+          WrapLine *wrap_line = &g_array_index (batch->lines, WrapLine, i);
+
+          if (!g_hash_table_lookup (priv->wrap_stale, wrap_line->line))
+            g_hash_table_insert (priv->wrapped_lines, wrap_line->line, wrap_line);
+        }
+      g_hash_table_remove_all (priv->wrap_stale);
+
+      if (g_hash_table_size (priv->wrapped_lines) > 0)
+        priv->wrap_batches = b_slist_prepend (priv->wrap_batches, batch);
+      else
+        wrap_batch_free (batch);
+
+      if (layout->buffer && priv->wrap_idle == 0)
+        priv->wrap_idle = bdk_threads_add_idle_full (G_PRIORITY_DEFAULT_IDLE,
+                                                     wrap_idle_callback,
+                                                     layout, NULL);
+    }
+  else
+    wrap_batch_free (batch);
+
+  g_object_unref (layout);
+
+  return FALSE;
+}
+
+/* Bango objects are not thread-safe, so the wrap thread has a font
+ * map of its own, of the same font type as the layout's.
+ */
+typedef struct
+{
+  BangoFontMap *font_map;
+  bboolean default_font_type;
+  bairo_font_type_t font_type;
+} WrapFontMap;
+
+static GStaticPrivate wrap_font_map = G_STATIC_PRIVATE_INIT;
+
+static void
+wrap_font_map_free (WrapFontMap *wrap)
+{
+  g_object_unref (wrap->font_map);
+  g_free (wrap);
+}
+
+static BangoFontMap *
+wrap_batch_get_font_map (WrapBatch *batch)
+{
+  WrapFontMap *wrap;
+
+  wrap = g_static_private_get (&wrap_font_map);
+  if (wrap &&
+      wrap->default_font_type == batch->default_font_type &&
+      (batch->default_font_type || wrap->font_type == batch->font_type))
+    return wrap->font_map;
+
+  wrap = g_new0 (WrapFontMap, 1);
+  wrap->default_font_type = batch->default_font_type;
+  wrap->font_type = batch->font_type;
+
+  if (!batch->default_font_type)
+    wrap->font_map = bango_bairo_font_map_new_for_font_type (batch->font_type);
+
+  /* Fall back to the default type if the layout's is not supported */
+  if (wrap->font_map == NULL)
+    wrap->font_map = bango_bairo_font_map_new ();
+
+  /* Frees the font map of the previous type, if any */
+  g_static_private_set (&wrap_font_map, wrap, (GDestroyNotify) wrap_font_map_free);
+
+  return wrap->font_map;
+}
+
+/* Runs on the wrap thread.  The font map, contexts and layouts used
+ * here never leave it.
+ */
+static void
+wrap_batch_measure (bpointer data,
+                    bpointer user_data)
+{
+  WrapBatch *batch = data;
+  BtkTextAttributes *style = batch->style;
+  BangoFontMap *font_map;
+  BangoLayout *layouts[2];
+  BangoAttrList *attrs;
+  BangoAttribute *attr;
+  buint i;
+
+  /* The attributes btk_text_layout_get_line_display() would use
+   * for a paragraph in the default style
+   */
+  attrs = bango_attr_list_new ();
+  bango_attr_list_insert (attrs, bango_attr_font_desc_new (style->font));
+  if (style->font_scale != 1.0)
+    bango_attr_list_insert (attrs, bango_attr_scale_new (style->font_scale));
+  if (style->appearance.rise != 0)
+    bango_attr_list_insert (attrs, bango_attr_rise_new (style->appearance.rise));
+
+  font_map = wrap_batch_get_font_map (batch);
+
+  for (i = 0; i < 2; i++)
+    {
+      BangoDirection base_dir = i ? BANGO_DIRECTION_RTL : BANGO_DIRECTION_LTR;
+      BangoContext *context;
+
+      context = bango_font_map_create_context (font_map);
+      bango_bairo_context_set_resolution (context, batch->resolution);
+      if (batch->font_options)
+        bango_bairo_context_set_font_options (context, batch->font_options);
+      bango_context_set_language (context, batch->language);
+      bango_context_set_base_dir (context, base_dir);
+
+      layouts[i] = bango_layout_new (context);
+      set_bango_para_values (layouts[i], base_dir, style, batch->screen_width);
+      bango_layout_set_attributes (layouts[i], attrs);
+
+      g_object_unref (context);
+    }
+
+  for (i = 0; i < batch->lines->len; i++)
+    {
+      WrapLine *wrap_line = &g_array_index (batch->lines, WrapLine, i);
+      BangoLayout *bango_layout = layouts[wrap_line->rtl ? 1 : 0];
+      BangoRectangle extents;
 
-static void
-update_layout_size (BtkTextLayout *layout)
-{
-  _btk_text_btree_get_view_size (_btk_text_buffer_get_btree (layout->buffer),
-				layout,
-				&layout->width, &layout->height);
+      if (g_atomic_int_get (&batch->cancelled))
+        break;
+
+      bango_layout_set_text (bango_layout,
+                             batch->text->str + wrap_line->offset,
+                             wrap_line->length);
+      bango_layout_get_extents (bango_layout, NULL, &extents);
+
+      wrap_line->width = PIXEL_BOUND (extents.width) + style->left_margin + style->right_margin;
+      wrap_line->height = style->pixels_above_lines + style->pixels_below_lines +
+                          BANGO_PIXELS (extents.height);
+    }
+
+  g_object_unref (layouts[0]);
+  g_object_unref (layouts[1]);
+  bango_attr_list_unref (attrs);
+
+  bdk_threads_add_idle_full (G_PRIORITY_DEFAULT_IDLE, wrap_batch_done, batch, NULL);
 }
 
-/**
- * btk_text_layout_validate_yrange:
- * @layout: a #BtkTextLayout
- * @anchor: iter pointing into a line that will be used as the
- *          coordinate origin
- * @y0_: offset from the top of the line pointed to by @anchor at
- *       which to begin validation. (The offset here is in pixels
- *       after validation.)
- * @y1_: offset from the top of the line pointed to by @anchor at
- *       which to end validation. (The offset here is in pixels
- *       after validation.)
- *
- * Ensure that a rebunnyion of a #BtkTextLayout is valid. The ::changed
- * signal will be emitted if any lines are validated.
+/* Collects the plain paragraphs among the invalid lines from @line
+ * on, and hands them to the wrap thread.
  */
-void
-btk_text_layout_validate_yrange (BtkTextLayout *layout,
-                                 BtkTextIter   *anchor,
-                                 bint           y0,
-                                 bint           y1)
+static void
+wrap_batch_start (BtkTextLayout *layout,
+                  BtkTextLine   *line,
+                  bboolean       check_tags)
 {
-  BtkTextLine *line;
-  BtkTextLine *first_line = NULL;
-  BtkTextLine *last_line = NULL;
-  bint seen;
-  bint delta_height = 0;
-  bint first_line_y = 0;        /* Quiet GCC */
-  bint last_line_y = 0;         /* Quiet GCC */
+  BtkTextLayoutPrivate *priv = BTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  WrapBatch *batch;
+  bint n_seen;
 
-  g_return_if_fail (BTK_IS_TEXT_LAYOUT (layout));
+  batch = wrap_batch_new (layout);
 
-  if (y0 > 0)
-    y0 = 0;
-  if (y1 < 0)
-    y1 = 0;
-  
-  /* Validate backwards from the anchor line to y0
+  /* Lines that have to be laid out here are skipped, but they still
+   * count, so that a mostly tagged buffer does not make us walk all
+   * of it.
    */
-  line = _btk_text_iter_get_text_line (anchor);
-  line = _btk_text_line_previous (line);
-  seen = 0;
-  while (line && seen < -y0)
+  for (n_seen = 0;
+       line != NULL && n_seen < 4 * WRAP_BATCH_LINES &&
+       batch->lines->len < WRAP_BATCH_LINES &&
+       batch->text->len < WRAP_BATCH_BYTES;
+       line = _btk_text_line_next (line), n_seen++)
     {
       BtkTextLineData *line_data = _btk_text_line_get_data (line, layout);
-      if (!line_data || !line_data->valid)
-        {
-          bint old_height, new_height;
-	  
-	  old_height = line_data ? line_data->height : 0;
 
-          _btk_text_btree_validate_line (_btk_text_buffer_get_btree (layout->buffer),
-                                         line, layout);
-          line_data = _btk_text_line_get_data (line, layout);
-
-	  new_height = line_data ? line_data->height : 0;
-
-          delta_height += new_height - old_height;
-          
-          first_line = line;
-          first_line_y = -seen - new_height;
-          if (!last_line)
-            {
-              last_line = line;
-              last_line_y = -seen;
-            }
-        }
+      if ((line_data && line_data->valid) ||
+          g_hash_table_lookup (priv->wrapped_lines, line) ||
+          !line_wraps_in_background (layout, line, check_tags))
+        continue;
 
-      seen += line_data ? line_data->height : 0;
-      line = _btk_text_line_previous (line);
+      wrap_batch_add_line (batch, line);
     }
 
-  /* Validate forwards to y1 */
-  line = _btk_text_iter_get_text_line (anchor);
-  seen = 0;
-  while (line && seen < y1)
-    {
-      BtkTextLineData *line_data = _btk_text_line_get_data (line, layout);
-      if (!line_data || !line_data->valid)
-        {
-          bint old_height, new_height;
-	  
-	  old_height = line_data ? line_data->height : 0;
+  if (wrap_pool == NULL)
+    wrap_pool = g_thread_pool_new (wrap_batch_measure, NULL, 1, FALSE, NULL);
 
-          _btk_text_btree_validate_line (_btk_text_buffer_get_btree (layout->buffer),
-                                         line, layout);
-          line_data = _btk_text_line_get_data (line, layout);
-	  new_height = line_data ? line_data->height : 0;
+  priv->wrap_batch = batch;
+  g_thread_pool_push (wrap_pool, batch, NULL);
+}
 
-          delta_height += new_height - old_height;
-          
-          if (!first_line)
-            {
-              first_line = line;
-              first_line_y = seen;
-            }
-          last_line = line;
-          last_line_y = seen + new_height;
-        }
+/* Uses the height the wrap thread found for @line, if any */
+static bboolean
+take_wrapped_line (BtkTextLayout   *layout,
+                   BtkTextLine     *line,
+                   BtkTextLineData *line_data)
+{
+  BtkTextLayoutPrivate *priv = BTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  WrapLine *wrap_line;
+  bboolean found = FALSE;
 
-      seen += line_data ? line_data->height : 0;
-      line = _btk_text_line_next_excluding_last (line);
-    }
+  wrap_line = g_hash_table_lookup (priv->wrapped_lines, line);
+  if (wrap_line == NULL)
+    return FALSE;
 
-  /* If we found and validated any invalid lines, update size and
-   * emit the changed signal
-   */
-  if (first_line)
+  /* It may have become the cursor line since it was measured */
+  if (line != priv->cursor_line)
     {
-      bint line_top;
+      line_data->width = wrap_line->width;
+      line_data->height = wrap_line->height;
+      line_data->valid = TRUE;
+      found = TRUE;
+    }
 
-      update_layout_size (layout);
+  g_hash_table_remove (priv->wrapped_lines, line);
 
-      line_top = _btk_text_btree_find_line_top (_btk_text_buffer_get_btree (layout->buffer),
-                                                first_line, layout);
+  if (g_hash_table_size (priv->wrapped_lines) == 0)
+    free_wrap_batches (layout);
 
-      btk_text_layout_emit_changed (layout,
-				    line_top,
-				    last_line_y - first_line_y - delta_height,
-				    last_line_y - first_line_y);
-    }
+  return found;
 }
 
 /**
- * btk_text_layout_validate:
- * @tree: a #BtkTextLayout
+ * btk_text_layout_validate_in_background:
+ * @layout: a #BtkTextLayout
  * @max_pixels: the maximum number of pixels to validate. (No more
  *              than one paragraph beyond this limit will be validated)
  *
- * Validate rebunnyions of a #BtkTextLayout. The ::changed signal will
- * be emitted for each rebunnyion validated.
+ * Like btk_text_layout_validate(), but paragraphs that can be
+ * measured without the buffer are handed to a worker thread instead
+ * of being laid out here.  Whenever a batch of them is ready, the
+ * layout feeds their heights into the btree from an idle of its own,
+ * and emits ::changed for the lines that were validated.  Without
+ * thread support this is btk_text_layout_validate().
+ *
+ * Return value: %FALSE if nothing more can be validated until the
+ *     worker thread is done
+ *
+ * Since: 2.24.34
  **/
-void
-btk_text_layout_validate (BtkTextLayout *layout,
-                          bint           max_pixels)
+bboolean
+btk_text_layout_validate_in_background (BtkTextLayout *layout,
+                                        bint           max_pixels)
 {
-  bint y, old_height, new_height;
+  BtkTextLayoutPrivate *priv;
+  BtkTextLine *line;
+  bboolean check_tags;
+  bint pixels = 0;
+  bint n_lines = 0;
 
-  g_return_if_fail (BTK_IS_TEXT_LAYOUT (layout));
+  g_return_val_if_fail (BTK_IS_TEXT_LAYOUT (layout), FALSE);
 
-  while (max_pixels > 0 &&
-         _btk_text_btree_validate (_btk_text_buffer_get_btree (layout->buffer),
-                                   layout,  max_pixels,
-                                   &y, &old_height, &new_height))
+  priv = BTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+
+  if (!wrap_thread_supported () ||
+      layout->ltr_context == NULL || layout->default_style == NULL)
     {
-      max_pixels -= new_height;
+      btk_text_layout_validate (layout, max_pixels);
+      return TRUE;
+    }
 
-      update_layout_size (layout);
-      btk_text_layout_emit_changed (layout, y, old_height, new_height);
+  if (priv->wrap_batch)
+    return FALSE;
+
+  line = _btk_text_btree_find_invalid_line (_btk_text_buffer_get_btree (layout->buffer),
+                                            layout);
+  check_tags = btk_text_tag_table_get_size (btk_text_buffer_get_tag_table (layout->buffer)) > 0;
+
+  /* Validate the start of the invalid rebunnyion as far as it is made
+   * of lines that were measured already or have to be laid out here;
+   * the budget ends the validation right after them.
+   */
+  while (line != NULL && pixels < max_pixels)
+    {
+      BtkTextLineData *line_data = _btk_text_line_get_data (line, layout);
+      WrapLine *wrap_line;
+
+      if (line_data && line_data->valid)
+        break;
+
+      wrap_line = g_hash_table_lookup (priv->wrapped_lines, line);
+      if (wrap_line)
+        pixels += wrap_line->height;
+      else if (!line_wraps_in_background (layout, line, check_tags))
+        pixels += line_data ? MAX (line_data->height, 1) : 1;
+      else
+        break;
+
+      n_lines++;
+      line = _btk_text_line_next (line);
+    }
+
+  if (n_lines > 0)
+    {
+      btk_text_layout_validate (layout, MAX (pixels, 1));
+      return TRUE;
+    }
+
+  if (line != NULL)
+    {
+      wrap_batch_start (layout, line, check_tags);
+      return FALSE;
     }
+
+  return TRUE;
 }
 
 static BtkTextLineData*
@@ -1164,6 +2001,9 @@ btk_text_layout_real_wrap (BtkTextLayout   *layout,
       _btk_text_line_add_data (line, line_data);
     }
 
+  if (take_wrapped_line (layout, line, line_data))
+    return line_data;
+
   display = btk_text_layout_get_line_display (layout, line, TRUE);
   line_data->width = display->width;
   line_data->height = display->height;
@@ -1307,41 +2147,18 @@ totally_invisible_line (BtkTextLayout *layout,
   return TRUE;
 }
 
+/* Sets up the paragraph-wide values of @style on a layout for a
+ * paragraph with the given (non-neutral) base direction.
+ */
 static void
-set_para_values (BtkTextLayout      *layout,
-                 BangoDirection      base_dir,
-                 BtkTextAttributes  *style,
-                 BtkTextLineDisplay *display)
+set_bango_para_values (BangoLayout       *bango_layout,
+                       BangoDirection     base_dir,
+                       BtkTextAttributes *style,
+                       bint               screen_width)
 {
   BangoAlignment bango_align = BANGO_ALIGN_LEFT;
   BangoWrapMode bango_wrap = BANGO_WRAP_WORD;
 
-  switch (base_dir)
-    {
-    /* If no base direction was found, then use the style direction */
-    case BANGO_DIRECTION_NEUTRAL :
-      display->direction = style->direction;
-
-      /* Override the base direction */
-      if (display->direction == BTK_TEXT_DIR_RTL)
-        base_dir = BANGO_DIRECTION_RTL;
-      else
-        base_dir = BANGO_DIRECTION_LTR;
-      
-      break;
-    case BANGO_DIRECTION_RTL :
-      display->direction = BTK_TEXT_DIR_RTL;
-      break;
-    default:
-      display->direction = BTK_TEXT_DIR_LTR;
-      break;
-    }
-  
-  if (display->direction == BTK_TEXT_DIR_RTL)
-    display->layout = bango_layout_new (layout->rtl_context);
-  else
-    display->layout = bango_layout_new (layout->ltr_context);
-
   switch (style->justification)
     {
     case BTK_JUSTIFY_LEFT:
@@ -1355,29 +2172,21 @@ set_para_values (BtkTextLayout      *layout,
       break;
     case BTK_JUSTIFY_FILL:
       bango_align = (base_dir == BANGO_DIRECTION_LTR) ? BANGO_ALIGN_LEFT : BANGO_ALIGN_RIGHT;
-      bango_layout_set_justify (display->layout, TRUE);
+      bango_layout_set_justify (bango_layout, TRUE);
       break;
     default:
       g_assert_not_reached ();
       break;
     }
 
-  bango_layout_set_alignment (display->layout, bango_align);
-  bango_layout_set_spacing (display->layout,
+  bango_layout_set_alignment (bango_layout, bango_align);
+  bango_layout_set_spacing (bango_layout,
                             style->pixels_inside_wrap * BANGO_SCALE);
 
   if (style->tabs)
-    bango_layout_set_tabs (display->layout, style->tabs);
-
-  display->top_margin = style->pixels_above_lines;
-  display->height = style->pixels_above_lines + style->pixels_below_lines;
-  display->bottom_margin = style->pixels_below_lines;
-  display->left_margin = style->left_margin;
-  display->right_margin = style->right_margin;
-  
-  display->x_offset = display->left_margin;
+    bango_layout_set_tabs (bango_layout, style->tabs);
 
-  bango_layout_set_indent (display->layout,
+  bango_layout_set_indent (bango_layout,
                            style->indent * BANGO_SCALE);
 
   switch (style->wrap_mode)
@@ -1399,10 +2208,54 @@ set_para_values (BtkTextLayout      *layout,
 
   if (style->wrap_mode != BTK_WRAP_NONE)
     {
-      int layout_width = (layout->screen_width - display->left_margin - display->right_margin);
-      bango_layout_set_width (display->layout, layout_width * BANGO_SCALE);
-      bango_layout_set_wrap (display->layout, bango_wrap);
+      int layout_width = (screen_width - style->left_margin - style->right_margin);
+      bango_layout_set_width (bango_layout, layout_width * BANGO_SCALE);
+      bango_layout_set_wrap (bango_layout, bango_wrap);
+    }
+}
+
+static void
+set_para_values (BtkTextLayout      *layout,
+                 BangoDirection      base_dir,
+                 BtkTextAttributes  *style,
+                 BtkTextLineDisplay *display)
+{
+  switch (base_dir)
+    {
+    /* If no base direction was found, then use the style direction */
+    case BANGO_DIRECTION_NEUTRAL :
+      display->direction = style->direction;
+
+      /* Override the base direction */
+      if (display->direction == BTK_TEXT_DIR_RTL)
+        base_dir = BANGO_DIRECTION_RTL;
+      else
+        base_dir = BANGO_DIRECTION_LTR;
+      
+      break;
+    case BANGO_DIRECTION_RTL :
+      display->direction = BTK_TEXT_DIR_RTL;
+      break;
+    default:
+      display->direction = BTK_TEXT_DIR_LTR;
+      break;
     }
+  
+  if (display->direction == BTK_TEXT_DIR_RTL)
+    display->layout = bango_layout_new (layout->rtl_context);
+  else
+    display->layout = bango_layout_new (layout->ltr_context);
+
+  set_bango_para_values (display->layout, base_dir, style,
+                         layout->screen_width);
+
+  display->top_margin = style->pixels_above_lines;
+  display->height = style->pixels_above_lines + style->pixels_below_lines;
+  display->bottom_margin = style->pixels_below_lines;
+  display->left_margin = style->left_margin;
+  display->right_margin = style->right_margin;
+  
+  display->x_offset = display->left_margin;
 
   display->total_width = MAX (layout->screen_width, layout->width) - display->left_margin - display->right_margin;
   
@@ -2137,6 +2990,38 @@ tags_array_toggle_tag (GPtrArray  *array,
   return array;
 }
 
+/* Returns the length of @text without its trailing paragraph
+ * delimiter, which Bango doesn't want.
+ */
+static bint
+strip_paragraph_delimiter (const bchar *text,
+                           bint         length)
+{
+  /* Only one character has type G_UNICODE_PARAGRAPH_SEPARATOR in
+   * Unicode 3.0; update this if that changes.
+   */
+#define PARAGRAPH_SEPARATOR 0x2029
+  gunichar ch = 0;
+
+  if (length > 0)
+    {
+      const char *prev = g_utf8_prev_char (text + length);
+      ch = g_utf8_get_char (prev);
+      if (ch == PARAGRAPH_SEPARATOR || ch == '\r' || ch == '\n')
+        length = prev - text; /* chop off */
+
+      if (ch == '\n' && length > 0)
+        {
+          /* Possibly chop a CR as well */
+          prev = g_utf8_prev_char (text + length);
+          if (*prev == '\r')
+            --length;
+        }
+    }
+
+  return length;
+}
+
 BtkTextLineDisplay *
 btk_text_layout_get_line_display (BtkTextLayout *layout,
                                   BtkTextLine   *line,
@@ -2162,23 +3047,35 @@ btk_text_layout_get_line_display (BtkTextLayout *layout,
   
   g_return_val_if_fail (line != NULL, NULL);
 
+  /* A full display will do for a size-only request as well */
+  display = display_cache_lookup (layout, line);
+  if (display)
+    {
+      priv->display_cache_hits++;
+      if (!size_only)
+        update_text_display_cursors (layout, line, display);
+      if (display->has_child_widgets)
+        allocate_child_widgets (layout, display);
+      return display;
+    }
+
   if (layout->one_display_cache)
     {
-      if (line == layout->one_display_cache->line &&
-          (size_only || !layout->one_display_cache->size_only))
+      if (line == layout->one_display_cache->line && size_only)
 	{
-	  if (!size_only)
-            update_text_display_cursors (layout, line, layout->one_display_cache);
+          priv->display_cache_hits++;
 	  return layout->one_display_cache;
 	}
-      else
+      else if (size_only || line == layout->one_display_cache->line)
         {
           BtkTextLineDisplay *tmp_display = layout->one_display_cache;
           layout->one_display_cache = NULL;
-          btk_text_layout_free_line_display (layout, tmp_display);
+          line_display_free (tmp_display);
         }
     }
 
+  priv->display_cache_misses++;
+
   DV (g_print ("creating one line display cache (%s)\n", B_STRLOC));
 
   display = g_new0 (BtkTextLineDisplay, 1);
@@ -2273,7 +3170,7 @@ btk_text_layout_get_line_display (BtkTextLayout *layout,
                     {
                       if (seg->type == &btk_text_char_type)
                         {
-                          memcpy (text + layout_byte_offset, seg->body.chars, seg->byte_count);
+                          memcpy (text + layout_byte_offset, seg->body.text.chars, seg->byte_count);
                           layout_byte_offset += seg->byte_count;
                           buffer_byte_offset += seg->byte_count;
                           bytes += seg->byte_count;
@@ -2427,30 +3324,7 @@ btk_text_layout_get_line_display (BtkTextLayout *layout,
     }
   
   /* Bango doesn't want the trailing paragraph delimiters */
-
-  {
-    /* Only one character has type G_UNICODE_PARAGRAPH_SEPARATOR in
-     * Unicode 3.0; update this if that changes.
-     */
-#define PARAGRAPH_SEPARATOR 0x2029
-    gunichar ch = 0;
-
-    if (layout_byte_offset > 0)
-      {
-        const char *prev = g_utf8_prev_char (text + layout_byte_offset);
-        ch = g_utf8_get_char (prev);
-        if (ch == PARAGRAPH_SEPARATOR || ch == '\r' || ch == '\n')
-          layout_byte_offset = prev - text; /* chop off */
-
-        if (ch == '\n' && layout_byte_offset > 0)
-          {
-            /* Possibly chop a CR as well */
-            prev = g_utf8_prev_char (text + layout_byte_offset);
-            if (*prev == '\r')
-              --layout_byte_offset;
-          }
-      }
-  }
+  layout_byte_offset = strip_paragraph_delimiter (text, layout_byte_offset);
   
   bango_layout_set_text (display->layout, text, layout_byte_offset);
   bango_layout_set_attributes (display->layout, attrs);
@@ -2501,8 +3375,12 @@ btk_text_layout_get_line_display (BtkTextLayout *layout,
   if (tags != NULL)
     g_ptr_array_free (tags, TRUE);
 
-  layout->one_display_cache = display;
+  if (size_only)
+    layout->one_display_cache = display;
+  else
+    display_cache_insert (layout, display);
 
+  display->has_child_widgets = saw_widget;
   if (saw_widget)
     allocate_child_widgets (layout, display);
   
@@ -2513,23 +3391,39 @@ void
 btk_text_layout_free_line_display (BtkTextLayout      *layout,
                                    BtkTextLineDisplay *display)
 {
-  if (display != layout->one_display_cache)
-    {
-      if (display->layout)
-        g_object_unref (display->layout);
+  /* Cached displays are freed when they get invalidated or evicted */
+  if (!display_is_cached (layout, display))
+    line_display_free (display);
+}
 
-      if (display->cursors)
-        {
-          b_slist_foreach (display->cursors, (GFunc)g_free, NULL);
-          b_slist_free (display->cursors);
-        }
-      b_slist_free (display->shaped_objects);
-      
-      if (display->pg_bg_color)
-        bdk_color_free (display->pg_bg_color);
+/**
+ * btk_text_layout_get_display_cache_stats:
+ * @layout: a #BtkTextLayout
+ * @hits: (out) (allow-none): return location for the number of line
+ *     displays found in the cache
+ * @misses: (out) (allow-none): return location for the number of
+ *     line displays that had to be laid out
+ *
+ * Returns how often btk_text_layout_get_line_display() could reuse a
+ * cached line display since the layout was created.
+ *
+ * Since: 2.24.34
+ */
+void
+btk_text_layout_get_display_cache_stats (BtkTextLayout *layout,
+                                         buint         *hits,
+                                         buint         *misses)
+{
+  BtkTextLayoutPrivate *priv;
 
-      g_free (display);
-    }
+  g_return_if_fail (BTK_IS_TEXT_LAYOUT (layout));
+
+  priv = BTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+
+  if (hits)
+    *hits = priv->display_cache_hits;
+  if (misses)
+    *misses = priv->display_cache_misses;
 }
 
 /* Functions to convert iter <=> index for the line of a BtkTextLineDisplay
@@ -146,8 +146,8 @@ struct _BtkTextLayout
    * over long runs with the same style. */
   BtkTextAttributes *one_style_cache;
 
-  /* A cache of one line display. Getting the same line
-   * many times in a row is the most common case.
+  /* The last size-only line display made while wrapping; full
+   * displays are kept in a separate LRU cache.
    */
   BtkTextLineDisplay *one_display_cache;
 
@@ -263,6 +263,7 @@ struct _BtkTextLineDisplay
   buint cursors_invalid : 1;
   buint has_block_cursor : 1;
   buint cursor_at_line_end : 1;
+  buint has_child_widgets : 1;
 };
 
 extern BangoAttrType btk_text_attr_appearance_type;
@@ -321,6 +322,9 @@ BtkTextLineDisplay* btk_text_layout_get_line_display  (BtkTextLayout      *layou
                                                        bboolean            size_only);
 void                btk_text_layout_free_line_display (BtkTextLayout      *layout,
                                                        BtkTextLineDisplay *display);
+void                btk_text_layout_get_display_cache_stats (BtkTextLayout *layout,
+                                                             buint         *hits,
+                                                             buint         *misses);
 
 void btk_text_layout_get_line_at_y     (BtkTextLayout     *layout,
                                         BtkTextIter       *target_iter,
@@ -341,6 +345,8 @@ void btk_text_layout_invalidate        (BtkTextLayout     *layout,
 void btk_text_layout_invalidate_cursors(BtkTextLayout     *layout,
                                         const BtkTextIter *start,
                                         const BtkTextIter *end);
+void _btk_text_layout_line_deleted    (BtkTextLayout     *layout,
+                                        BtkTextLine       *line);
 void btk_text_layout_free_line_data    (BtkTextLayout     *layout,
                                         BtkTextLine       *line,
                                         BtkTextLineData   *line_data);
@@ -352,6 +358,8 @@ void     btk_text_layout_validate_yrange (BtkTextLayout *layout,
                                           bint           y1_);
 void     btk_text_layout_validate        (BtkTextLayout *layout,
                                           bint           max_pixels);
+bboolean btk_text_layout_validate_in_background (BtkTextLayout *layout,
+                                                 bint           max_pixels);
 
 /* This function should return the passed-in line data,
  * OR remove the existing line data from the line, and
@@ -154,11 +154,130 @@ btk_text_line_segment_split (const BtkTextIter *iter)
  * Macros that determine how much space to allocate for new segments:
  */
 
-#define CSEG_SIZE(chars) ((unsigned) (G_STRUCT_OFFSET (BtkTextLineSegment, body) \
-        + 1 + (chars)))
+#define CSEG_SIZE ((unsigned) (G_STRUCT_OFFSET (BtkTextLineSegment, body) \
+        + sizeof (BtkTextCharBody)))
 #define TSEG_SIZE ((unsigned) (G_STRUCT_OFFSET (BtkTextLineSegment, body) \
         + sizeof (BtkTextToggleBody)))
 
+/*
+ * Text chunks
+ *
+ * The text of char segments lives in chunks that are only ever
+ * appended to, and that are shared by all the segments whose text
+ * they hold.  Splitting a segment doesn't copy its text, joining two
+ * segments only does if their text isn't already contiguous, and an
+ * insertion copies the inserted text exactly once, however many
+ * lines it spans.  A chunk is freed with the last segment using it.
+ *
+ * Small insertions are appended to a chunk of the btree they go
+ * into, so that typing doesn't allocate a chunk per keystroke.
+ * Chunks are only used by the thread using their buffer, like the
+ * rest of the btree, so they need no locking.
+ *
+ * Once most of the text of a chunk has been deleted, the segments
+ * still using it are copied out as their lines are cleaned up, so
+ * that a few survivors don't keep a large chunk alive.
+ */
+
+#define CHUNK_SIZE (64 * 1024)
+
+/* A chunk is compacted when less than 1/CHUNK_SPARSE of it is used */
+#define CHUNK_SPARSE 4
+
+struct _BtkTextChunk {
+  bint ref_count;
+  bsize length;                 /* Bytes of data in use */
+  bsize allocated;              /* Bytes of data allocated */
+  bsize live;                   /* Bytes of data used by segments */
+  char data[1];
+};
+
+static BtkTextChunk *
+btk_text_chunk_new (bsize allocated)
+{
+  BtkTextChunk *chunk;
+
+  chunk = g_malloc (G_STRUCT_OFFSET (BtkTextChunk, data) + allocated);
+  chunk->ref_count = 1;
+  chunk->length = 0;
+  chunk->allocated = allocated;
+  chunk->live = 0;
+
+  return chunk;
+}
+
+static inline BtkTextChunk *
+btk_text_chunk_ref (BtkTextChunk *chunk)
+{
+  chunk->ref_count++;
+  return chunk;
+}
+
+void
+_btk_text_chunk_unref (BtkTextChunk *chunk)
+{
+  g_assert (chunk->ref_count > 0);
+
+  chunk->ref_count--;
+  if (chunk->ref_count == 0)
+    g_free (chunk);
+}
+
+/* Reserves len bytes at the end of *append_chunk, or of a chunk of
+ * their own if they don't fit, returning a reference to the chunk
+ * and the reserved bytes in chars.
+ */
+static BtkTextChunk *
+btk_text_chunk_reserve (BtkTextChunk **append_chunk,
+                        bsize          len,
+                        bchar        **chars)
+{
+  BtkTextChunk *chunk;
+
+  if (append_chunk == NULL ||
+      *append_chunk == NULL ||
+      (*append_chunk)->allocated - (*append_chunk)->length < len)
+    {
+      if (append_chunk == NULL || len > CHUNK_SIZE / 4)
+        {
+          /* Large insertions get a chunk of their own */
+          chunk = btk_text_chunk_new (len);
+          chunk->length = len;
+          *chars = chunk->data;
+
+          return chunk;
+        }
+
+      if (*append_chunk != NULL)
+        _btk_text_chunk_unref (*append_chunk);
+      *append_chunk = btk_text_chunk_new (CHUNK_SIZE);
+    }
+
+  chunk = *append_chunk;
+  *chars = chunk->data + chunk->length;
+  chunk->length += len;
+
+  return btk_text_chunk_ref (chunk);
+}
+
+/* Copies text into *append_chunk, the chunk of a btree that its
+ * insertions are appended to, returning a reference to the chunk and
+ * the copy in chars.
+ */
+BtkTextChunk *
+_btk_text_chunk_add (BtkTextChunk **append_chunk,
+                     const bchar   *text,
+                     buint          len,
+                     bchar        **chars)
+{
+  BtkTextChunk *chunk;
+
+  chunk = btk_text_chunk_reserve (append_chunk, len, chars);
+  memcpy (*chars, text, len);
+
+  return chunk;
+}
+
 /*
  * Type functions
  */
@@ -177,32 +296,42 @@ char_segment_self_check (BtkTextLineSegment *seg)
       g_error ("segment has size <= 0");
     }
 
-  if (strlen (seg->body.chars) != seg->byte_count)
+  if (memchr (seg->body.text.chars, '\0', seg->byte_count) != NULL)
     {
       g_error ("segment has wrong size");
     }
 
-  if (g_utf8_strlen (seg->body.chars, seg->byte_count) != seg->char_count)
+  if (seg->body.text.chars < seg->body.text.chunk->data ||
+      seg->body.text.chars + seg->byte_count >
+      seg->body.text.chunk->data + seg->body.text.chunk->length)
+    {
+      g_error ("segment is outside of its text chunk");
+    }
+
+  if (g_utf8_strlen (seg->body.text.chars, seg->byte_count) != seg->char_count)
     {
       g_error ("char segment has wrong character count");
     }
 }
 
-BtkTextLineSegment*
-_btk_char_segment_new (const bchar *text, buint len)
+static BtkTextLineSegment *
+char_segment_new (BtkTextChunk *chunk,
+                  bchar        *chars,
+                  buint         len,
+                  buint         char_count)
 {
   BtkTextLineSegment *seg;
 
-  g_assert (btk_text_byte_begins_utf8_char (text));
+  g_assert (btk_text_byte_begins_utf8_char (chars));
 
-  seg = g_malloc (CSEG_SIZE (len));
+  seg = g_slice_alloc (CSEG_SIZE);
   seg->type = (BtkTextLineSegmentClass *)&btk_text_char_type;
   seg->next = NULL;
   seg->byte_count = len;
-  memcpy (seg->body.chars, text, len);
-  seg->body.chars[len] = '\0';
-
-  seg->char_count = g_utf8_strlen (seg->body.chars, seg->byte_count);
+  seg->char_count = char_count;
+  seg->body.text.chars = chars;
+  seg->body.text.chunk = btk_text_chunk_ref (chunk);
+  chunk->live += len;
 
   if (btk_debug_flags & BTK_DEBUG_TEXT)
     char_segment_self_check (seg);
@@ -210,6 +339,66 @@ _btk_char_segment_new (const bchar *text, buint len)
   return seg;
 }
 
+static void
+char_segment_free (BtkTextLineSegment *seg)
+{
+  seg->body.text.chunk->live -= seg->byte_count;
+  _btk_text_chunk_unref (seg->body.text.chunk);
+  g_slice_free1 (CSEG_SIZE, seg);
+}
+
+/* Moves the text of seg to a chunk of its own, if its chunk is
+ * mostly unused, so that the chunk can go away.
+ */
+static void
+char_segment_compact (BtkTextLineSegment *seg)
+{
+  BtkTextChunk *chunk = seg->body.text.chunk;
+  BtkTextChunk *copy;
+  bchar *chars;
+
+  if (chunk->allocated < CHUNK_SIZE / 4 ||
+      chunk->live >= chunk->length / CHUNK_SPARSE)
+    return;
+
+  copy = btk_text_chunk_reserve (NULL, seg->byte_count, &chars);
+  memcpy (chars, seg->body.text.chars, seg->byte_count);
+  copy->live = seg->byte_count;
+
+  chunk->live -= seg->byte_count;
+  _btk_text_chunk_unref (chunk);
+
+  seg->body.text.chars = chars;
+  seg->body.text.chunk = copy;
+}
+
+/* Creates a segment for len bytes of text at chars in chunk,
+ * without copying them.
+ */
+BtkTextLineSegment*
+_btk_char_segment_new_from_chunk (BtkTextChunk *chunk,
+                                  bchar        *chars,
+                                  buint         len)
+{
+  return char_segment_new (chunk, chars, len, g_utf8_strlen (chars, len));
+}
+
+BtkTextLineSegment*
+_btk_char_segment_new (BtkTextChunk **append_chunk,
+                       const bchar   *text,
+                       buint          len)
+{
+  BtkTextLineSegment *seg;
+  BtkTextChunk *chunk;
+  bchar *chars;
+
+  chunk = _btk_text_chunk_add (append_chunk, text, len, &chars);
+  seg = _btk_char_segment_new_from_chunk (chunk, chars, len);
+  _btk_text_chunk_unref (chunk);
+
+  return seg;
+}
+
 BtkTextLineSegment*
 _btk_char_segment_new_from_two_strings (const bchar *text1, 
 					buint        len1, 
@@ -219,22 +408,18 @@ _btk_char_segment_new_from_two_strings (const bchar *text1,
 					buint        chars2)
 {
   BtkTextLineSegment *seg;
+  BtkTextChunk *chunk;
+  bchar *chars;
 
   g_assert (btk_text_byte_begins_utf8_char (text1));
   g_assert (btk_text_byte_begins_utf8_char (text2));
 
-  seg = g_malloc (CSEG_SIZE (len1+len2));
-  seg->type = &btk_text_char_type;
-  seg->next = NULL;
-  seg->byte_count = len1 + len2;
-  memcpy (seg->body.chars, text1, len1);
-  memcpy (seg->body.chars + len1, text2, len2);
-  seg->body.chars[len1+len2] = '\0';
+  chunk = btk_text_chunk_reserve (NULL, len1 + len2, &chars);
+  memcpy (chars, text1, len1);
+  memcpy (chars + len1, text2, len2);
 
-  seg->char_count = chars1 + chars2;
-
-  if (btk_debug_flags & BTK_DEBUG_TEXT)
-    char_segment_self_check (seg);
+  seg = char_segment_new (chunk, chars, len1 + len2, chars1 + chars2);
+  _btk_text_chunk_unref (chunk);
 
   return seg;
 }
@@ -252,7 +437,8 @@ _btk_char_segment_new_from_two_strings (const bchar *text1,
  *      among the two segments.
  *
  * Side effects:
- *      Storage for segPtr is freed.
+ *      segPtr is reused as the first of the two segments, which
+ *      share its text.
  *
  *--------------------------------------------------------------
  */
@@ -261,6 +447,7 @@ static BtkTextLineSegment *
 char_segment_split_func (BtkTextLineSegment *seg, int index)
 {
   BtkTextLineSegment *new1, *new2;
+  int char_count;
 
   g_assert (index < seg->byte_count);
 
@@ -269,16 +456,29 @@ char_segment_split_func (BtkTextLineSegment *seg, int index)
       char_segment_self_check (seg);
     }
 
-  new1 = _btk_char_segment_new (seg->body.chars, index);
-  new2 = _btk_char_segment_new (seg->body.chars + index, seg->byte_count - index);
-
-  g_assert (btk_text_byte_begins_utf8_char (new1->body.chars));
-  g_assert (btk_text_byte_begins_utf8_char (new2->body.chars));
-  g_assert (new1->byte_count + new2->byte_count == seg->byte_count);
-  g_assert (new1->char_count + new2->char_count == seg->char_count);
+  /* The two halves share the text of seg, so only count the
+   * characters of the shorter one.
+   */
+  if (index < seg->byte_count / 2)
+    char_count = g_utf8_strlen (seg->body.text.chars, index);
+  else
+    char_count = seg->char_count -
+      g_utf8_strlen (seg->body.text.chars + index, seg->byte_count - index);
+
+  new2 = char_segment_new (seg->body.text.chunk,
+                           seg->body.text.chars + index,
+                           seg->byte_count - index,
+                           seg->char_count - char_count);
+  new2->next = seg->next;
 
+  new1 = seg;
+  new1->body.text.chunk->live -= new1->byte_count - index;
+  new1->byte_count = index;
+  new1->char_count = char_count;
   new1->next = new2;
-  new2->next = seg->next;
+
+  g_assert (btk_text_byte_begins_utf8_char (new1->body.text.chars));
+  g_assert (btk_text_byte_begins_utf8_char (new2->body.text.chars));
 
   if (btk_debug_flags & BTK_DEBUG_TEXT)
     {
@@ -286,7 +486,6 @@ char_segment_split_func (BtkTextLineSegment *seg, int index)
       char_segment_self_check (new2);
     }
 
-  g_free (seg);
   return new1;
 }
 
@@ -325,14 +524,35 @@ char_segment_cleanup_func (BtkTextLineSegment *segPtr, BtkTextLine *line)
   segPtr2 = segPtr->next;
   if ((segPtr2 == NULL) || (segPtr2->type != &btk_text_char_type))
     {
+      char_segment_compact (segPtr);
+      return segPtr;
+    }
+
+  if (segPtr->body.text.chunk == segPtr2->body.text.chunk &&
+      segPtr->body.text.chars + segPtr->byte_count == segPtr2->body.text.chars)
+    {
+      /* The text is already contiguous, as after a split or
+       * when typing at the end of the text typed before.
+       */
+      segPtr->byte_count += segPtr2->byte_count;
+      segPtr->char_count += segPtr2->char_count;
+      segPtr->next = segPtr2->next;
+
+      /* The text of segPtr2 stays in use */
+      segPtr->body.text.chunk->live += segPtr2->byte_count;
+      char_segment_free (segPtr2);
+
+      if (btk_debug_flags & BTK_DEBUG_TEXT)
+        char_segment_self_check (segPtr);
+
       return segPtr;
     }
 
   newPtr =
-    _btk_char_segment_new_from_two_strings (segPtr->body.chars, 
+    _btk_char_segment_new_from_two_strings (segPtr->body.text.chars, 
 					    segPtr->byte_count,
 					    segPtr->char_count,
-                                            segPtr2->body.chars, 
+                                            segPtr2->body.text.chars, 
 					    segPtr2->byte_count,
 					    segPtr2->char_count);
 
@@ -341,8 +561,8 @@ char_segment_cleanup_func (BtkTextLineSegment *segPtr, BtkTextLine *line)
   if (btk_debug_flags & BTK_DEBUG_TEXT)
     char_segment_self_check (newPtr);
 
-  g_free (segPtr);
-  g_free (segPtr2);
+  char_segment_free (segPtr);
+  char_segment_free (segPtr2);
   return newPtr;
 }
 
@@ -372,7 +592,7 @@ char_segment_cleanup_func (BtkTextLineSegment *segPtr, BtkTextLine *line)
 static int
 char_segment_delete_func (BtkTextLineSegment *segPtr, BtkTextLine *line, int treeGone)
 {
-  g_free ((char*) segPtr);
+  char_segment_free (segPtr);
   return 0;
 }
 
@@ -51,6 +51,18 @@ struct _BtkTextTagInfo {
   BtkTextTag *tag;
   BtkTextBTreeNode *tag_root; /* highest-level node containing the tag */
   bint toggle_count;      /* total toggles of this tag below tag_root */
+  bint index;             /* bit in the per-node tag bitsets */
+};
+
+/* Chunk of text shared by char segments, see btktextsegment.c */
+typedef struct _BtkTextChunk BtkTextChunk;
+
+/* Body of a char segment */
+typedef struct _BtkTextCharBody BtkTextCharBody;
+struct _BtkTextCharBody {
+  char *chars;                      /* Characters of the segment, not
+                                     * nul-terminated; points into chunk. */
+  BtkTextChunk *chunk;              /* Holds a reference on the chunk. */
 };
 
 /* Body of a segment that toggles a tag on or off */
@@ -141,9 +153,8 @@ struct _BtkTextLineSegment {
   int byte_count;                       /* Size of this segment (# of bytes
                                          * of index space it occupies). */
   union {
-    char chars[4];                      /* Characters that make up character
-                                         * info.  Actual length varies to
-                                         * hold as many characters as needed.*/
+    BtkTextCharBody text;               /* Characters that make up character
+                                         * info. */
     BtkTextToggleBody toggle;              /* Information about tag toggle. */
     BtkTextMarkBody mark;              /* Information about mark. */
     BtkTextPixbuf pixbuf;              /* Child pixbuf */
@@ -154,7 +165,16 @@ struct _BtkTextLineSegment {
 
 BtkTextLineSegment  *btk_text_line_segment_split (const BtkTextIter *iter);
 
-BtkTextLineSegment *_btk_char_segment_new                  (const bchar    *text,
+BtkTextChunk       *_btk_text_chunk_add                    (BtkTextChunk  **append_chunk,
+                                                            const bchar    *text,
+                                                            buint           len,
+                                                            bchar         **chars);
+void                _btk_text_chunk_unref                  (BtkTextChunk   *chunk);
+BtkTextLineSegment *_btk_char_segment_new_from_chunk       (BtkTextChunk   *chunk,
+                                                            bchar          *chars,
+                                                            buint           len);
+BtkTextLineSegment *_btk_char_segment_new                  (BtkTextChunk  **append_chunk,
+                                                            const bchar    *text,
                                                             buint           len);
 BtkTextLineSegment *_btk_char_segment_new_from_two_strings (const bchar    *text1,
                                                             buint           len1,
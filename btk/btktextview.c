@@ -72,6 +72,13 @@
  *   - otherwise, validate the onscreen lines
  *   - DO NOT process updates
  *
+ * When validation changes the height of onscreen lines, changed_handler()
+ * moves the pixels of the lines below them with bdk_window_move_rebunnyion()
+ * rather than invalidating everything down to the bottom of the screen,
+ * so only the changed lines and the area uncovered by the move get
+ * redrawn. The layout emits one "changed" signal per run of lines it
+ * validated, top to bottom, so valid lines in between are not redrawn.
+ *
  * In both cases, validating the onscreen lines can trigger a scroll
  * due to maintaining the first_para on the top of the screen.
  * If validation triggers a scroll, we jump to the top of the code path
@@ -431,6 +438,9 @@ static void           text_window_scroll          (BtkTextWindow     *win,
                                                    bint               dy);
 static void           text_window_invalidate_rect (BtkTextWindow     *win,
                                                    BdkRectangle      *rect);
+static void           text_window_move_rect       (BtkTextWindow     *win,
+                                                   BdkRectangle      *rect,
+                                                   bint               dy);
 static void           text_window_invalidate_cursors (BtkTextWindow  *win);
 
 static bint           text_window_get_width       (BtkTextWindow     *win);
@@ -3639,7 +3649,15 @@ incremental_validate_callback (bpointer data)
 
   DV(g_print(B_STRLOC"\n"));
   
-  btk_text_layout_validate (text_view->layout, 2000);
+  /* Offscreen paragraphs are measured on a worker thread where
+   * possible; the layout validates them itself once they are
+   * measured, and we follow along in changed_handler().
+   */
+  if (!btk_text_layout_validate_in_background (text_view->layout, 2000))
+    {
+      text_view->incremental_validate_idle = 0;
+      return FALSE;
+    }
 
   btk_text_view_update_adjustments (text_view);
   
@@ -3718,6 +3736,30 @@ changed_handler (BtkTextLayout     *layout,
 
       if (old_height == new_height)
         redraw_rect.height = old_height;
+      else if (start_y >= visible_rect.y)
+        {
+          BdkRectangle move_rect;
+
+          /* Move what is below the changed lines instead of redrawing it */
+          move_rect.x = visible_rect.x;
+          move_rect.width = visible_rect.width;
+          move_rect.y = start_y + old_height;
+          move_rect.height = visible_rect.y + visible_rect.height - move_rect.y;
+
+          if (move_rect.height > 0)
+            {
+              text_window_move_rect (text_view->text_window, &move_rect,
+                                     new_height - old_height);
+              if (text_view->left_window)
+                text_window_move_rect (text_view->left_window, &move_rect,
+                                       new_height - old_height);
+              if (text_view->right_window)
+                text_window_move_rect (text_view->right_window, &move_rect,
+                                       new_height - old_height);
+            }
+
+          redraw_rect.height = new_height;
+        }
       else if (start_y + old_height > visible_rect.y)
         redraw_rect.height = MAX (0, visible_rect.y + visible_rect.height - start_y);
       else
@@ -3751,7 +3793,12 @@ changed_handler (BtkTextLayout     *layout,
           queue_update_im_spot_location (text_view);
         }
     }
-  
+
+  /* The layout validates the lines measured in the background on its
+   * own, so the scrollbars have to follow from here.
+   */
+  btk_text_view_update_adjustments (text_view);
+
   if (old_height != new_height)
     {
       bboolean yoffset_changed = FALSE;
@@ -8302,6 +8349,52 @@ text_window_invalidate_rect (BtkTextWindow *win,
 #endif
 }
 
+/* Moves the contents of @rect, in buffer coordinates, by @dy pixels.
+ * Whatever the move uncovers gets invalidated.
+ */
+static void
+text_window_move_rect (BtkTextWindow *win,
+                       BdkRectangle  *rect,
+                       bint           dy)
+{
+  BdkRectangle window_rect;
+  BdkRebunnyion *rebunnyion;
+
+  if (dy == 0)
+    return;
+
+  btk_text_view_buffer_to_window_coords (BTK_TEXT_VIEW (win->widget),
+                                         win->type,
+                                         rect->x,
+                                         rect->y,
+                                         &window_rect.x,
+                                         &window_rect.y);
+
+  window_rect.width = rect->width;
+  window_rect.height = rect->height;
+
+  switch (win->type)
+    {
+    case BTK_TEXT_WINDOW_TEXT:
+      break;
+
+    case BTK_TEXT_WINDOW_LEFT:
+    case BTK_TEXT_WINDOW_RIGHT:
+      window_rect.x = 0;
+      window_rect.width = win->allocation.width;
+      break;
+
+    default:
+      g_warning ("%s: bug!", B_STRFUNC);
+      return;
+      break;
+    }
+
+  rebunnyion = bdk_rebunnyion_rectangle (&window_rect);
+  bdk_window_move_rebunnyion (win->bin_window, rebunnyion, 0, dy);
+  bdk_rebunnyion_destroy (rebunnyion);
+}
+
 static void
 text_window_invalidate_cursors (BtkTextWindow *win)
 {
@@ -449,6 +449,364 @@ _btk_tree_data_list_compare_func (BtkTreeModel *model,
 }
 
 
+/* Sorting by key
+ *
+ * With the default compare function on a number or string column, the
+ * sort key of every row can be taken out of the model once, strings
+ * turned into collation keys, and sorted without calling back into the
+ * model.  Large sorts are split over a few threads, each sorting one
+ * part; the parts are merged afterwards.  Ties are broken by the
+ * current position, so the result is the same as that of a stable sort
+ * with the compare function.
+ */
+
+/* rows; below this comparing through the model is cheap enough */
+#define MIN_KEYED_SORT 256
+/* rows a thread gets at least */
+#define MIN_THREADED_SORT 32768
+
+typedef enum
+{
+  SORT_KEY_INT,
+  SORT_KEY_UINT,
+  SORT_KEY_DOUBLE,
+  SORT_KEY_STRING
+} SortKeyKind;
+
+typedef struct
+{
+  union
+  {
+    bint64   v_int;
+    buint64  v_uint;
+    bdouble  v_double;
+    bchar   *v_string;
+  } key;
+  bint index;
+} SortKey;
+
+typedef struct
+{
+  SortKeyKind kind;
+  bboolean    descending;
+} SortKeyInfo;
+
+typedef struct
+{
+  SortKey     *keys;
+  bint         n_keys;
+  SortKeyInfo *info;
+} SortKeyChunk;
+
+static bboolean
+sort_key_kind (GType        type,
+               SortKeyKind *kind)
+{
+  switch (get_fundamental_type (type))
+    {
+    case B_TYPE_BOOLEAN:
+    case B_TYPE_CHAR:
+    case B_TYPE_INT:
+    case B_TYPE_LONG:
+    case B_TYPE_INT64:
+    case B_TYPE_ENUM:
+      *kind = SORT_KEY_INT;
+      return TRUE;
+    case B_TYPE_UCHAR:
+    case B_TYPE_UINT:
+    case B_TYPE_ULONG:
+    case B_TYPE_UINT64:
+    case B_TYPE_FLAGS:
+      *kind = SORT_KEY_UINT;
+      return TRUE;
+    case B_TYPE_FLOAT:
+    case B_TYPE_DOUBLE:
+      *kind = SORT_KEY_DOUBLE;
+      return TRUE;
+    case B_TYPE_STRING:
+      *kind = SORT_KEY_STRING;
+      return TRUE;
+    default:
+      return FALSE;
+    }
+}
+
+static void
+sort_key_set (SortKey *key,
+              BValue  *value)
+{
+  switch (get_fundamental_type (G_VALUE_TYPE (value)))
+    {
+    case B_TYPE_BOOLEAN:
+      key->key.v_int = b_value_get_boolean (value);
+      break;
+    case B_TYPE_CHAR:
+      key->key.v_int = b_value_get_char (value);
+      break;
+    case B_TYPE_INT:
+      key->key.v_int = b_value_get_int (value);
+      break;
+    case B_TYPE_LONG:
+      key->key.v_int = b_value_get_long (value);
+      break;
+    case B_TYPE_INT64:
+      key->key.v_int = b_value_get_int64 (value);
+      break;
+    case B_TYPE_ENUM:
+      key->key.v_int = b_value_get_enum (value);
+      break;
+    case B_TYPE_UCHAR:
+      key->key.v_uint = b_value_get_uchar (value);
+      break;
+    case B_TYPE_UINT:
+      key->key.v_uint = b_value_get_uint (value);
+      break;
+    case B_TYPE_ULONG:
+      key->key.v_uint = b_value_get_ulong (value);
+      break;
+    case B_TYPE_UINT64:
+      key->key.v_uint = b_value_get_uint64 (value);
+      break;
+    case B_TYPE_FLAGS:
+      key->key.v_uint = b_value_get_flags (value);
+      break;
+    case B_TYPE_FLOAT:
+      key->key.v_double = b_value_get_float (value);
+      break;
+    case B_TYPE_DOUBLE:
+      key->key.v_double = b_value_get_double (value);
+      break;
+    case B_TYPE_STRING:
+      /* turned into a collation key by the sorting thread */
+      key->key.v_string = b_value_dup_string (value);
+      if (key->key.v_string == NULL)
+        key->key.v_string = g_strdup ("");
+      break;
+    default:
+      g_assert_not_reached ();
+      break;
+    }
+}
+
+static bint
+sort_key_compare (gconstpointer a,
+                  gconstpointer b,
+                  bpointer      user_data)
+{
+  const SortKey *ka = a;
+  const SortKey *kb = b;
+  SortKeyInfo *info = user_data;
+  bint retval;
+
+  switch (info->kind)
+    {
+    case SORT_KEY_INT:
+      retval = ka->key.v_int < kb->key.v_int ? -1 : ka->key.v_int > kb->key.v_int;
+      break;
+    case SORT_KEY_UINT:
+      retval = ka->key.v_uint < kb->key.v_uint ? -1 : ka->key.v_uint > kb->key.v_uint;
+      break;
+    case SORT_KEY_DOUBLE:
+      if (ka->key.v_double < kb->key.v_double)
+        retval = -1;
+      else if (ka->key.v_double == kb->key.v_double)
+        retval = 0;
+      else
+        retval = 1;
+      break;
+    case SORT_KEY_STRING:
+      retval = strcmp (ka->key.v_string, kb->key.v_string);
+      break;
+    default:
+      g_assert_not_reached ();
+      retval = 0;
+      break;
+    }
+
+  if (info->descending)
+    retval = -retval;
+
+  if (retval == 0)
+    retval = ka->index - kb->index;
+
+  return retval;
+}
+
+static void
+sort_key_chunk (bpointer data,
+                bpointer user_data)
+{
+  SortKeyChunk *chunk = data;
+  bint i;
+
+  if (chunk->info->kind == SORT_KEY_STRING)
+    for (i = 0; i < chunk->n_keys; i++)
+      {
+        bchar *str = chunk->keys[i].key.v_string;
+
+        chunk->keys[i].key.v_string = g_utf8_collate_key (str, -1);
+        g_free (str);
+      }
+
+  g_qsort_with_data (chunk->keys, chunk->n_keys, sizeof (SortKey),
+                     sort_key_compare, chunk->info);
+}
+
+static void
+sort_key_merge (SortKey     *a,
+                bint         n_a,
+                SortKey     *b,
+                bint         n_b,
+                SortKey     *dest,
+                SortKeyInfo *info)
+{
+  while (n_a > 0 && n_b > 0)
+    {
+      if (sort_key_compare (a, b, info) <= 0)
+        {
+          *dest++ = *a++;
+          n_a--;
+        }
+      else
+        {
+          *dest++ = *b++;
+          n_b--;
+        }
+    }
+
+  memcpy (dest, a, n_a * sizeof (SortKey));
+  memcpy (dest + n_a, b, n_b * sizeof (SortKey));
+}
+
+static bint
+sort_key_n_threads (bint n_keys)
+{
+  bint n_threads;
+
+  if (n_keys < 2 * MIN_THREADED_SORT || !g_thread_supported ())
+    return 1;
+
+#if BUNNYLIB_CHECK_VERSION (2, 36, 0)
+  n_threads = g_get_num_processors ();
+#else
+  n_threads = 4;
+#endif
+
+  return CLAMP (n_keys / MIN_THREADED_SORT, 1, n_threads);
+}
+
+/* Returns the new order of @iters, in the form rows-reordered expects,
+ * or %NULL if @func can't be sorted by key; the caller must compare
+ * through the model in that case.
+ */
+bint *
+_btk_tree_data_list_sort_by_key (BtkTreeModel           *model,
+                                 BtkTreeIter            *iters,
+                                 bint                    n_iters,
+                                 BtkTreeIterCompareFunc  func,
+                                 bpointer                data,
+                                 BtkSortType             order)
+{
+  bint column = BPOINTER_TO_INT (data);
+  SortKeyInfo info;
+  SortKeyChunk *chunks;
+  SortKey *keys, *tmp, *swap;
+  GThreadPool *pool = NULL;
+  BValue value = { 0, };
+  bint *bounds;
+  bint *new_order;
+  bint n_chunks, i;
+
+  if (func != _btk_tree_data_list_compare_func || n_iters < MIN_KEYED_SORT)
+    return NULL;
+
+  if (!sort_key_kind (btk_tree_model_get_column_type (model, column), &info.kind))
+    return NULL;
+
+  info.descending = (order == BTK_SORT_DESCENDING);
+
+  /* the model is only ever accessed from here */
+  keys = g_new (SortKey, n_iters);
+  for (i = 0; i < n_iters; i++)
+    {
+      btk_tree_model_get_value (model, &iters[i], column, &value);
+      sort_key_set (&keys[i], &value);
+      keys[i].index = i;
+      b_value_unset (&value);
+    }
+
+  n_chunks = sort_key_n_threads (n_iters);
+  chunks = g_new (SortKeyChunk, n_chunks);
+  bounds = g_new (bint, n_chunks + 1);
+
+  for (i = 0; i < n_chunks; i++)
+    {
+      bounds[i] = (bint64) n_iters * i / n_chunks;
+      chunks[i].keys = keys + bounds[i];
+      chunks[i].info = &info;
+    }
+  bounds[n_chunks] = n_iters;
+  for (i = 0; i < n_chunks; i++)
+    chunks[i].n_keys = bounds[i + 1] - bounds[i];
+
+  if (n_chunks > 1)
+    pool = g_thread_pool_new (sort_key_chunk, NULL, n_chunks - 1, TRUE, NULL);
+
+  for (i = 1; i < n_chunks; i++)
+    {
+      if (pool)
+        g_thread_pool_push (pool, &chunks[i], NULL);
+      else
+        sort_key_chunk (&chunks[i], NULL);
+    }
+
+  sort_key_chunk (&chunks[0], NULL);
+
+  if (pool)
+    g_thread_pool_free (pool, FALSE, TRUE);
+
+  /* merge neighbouring parts until one is left */
+  tmp = n_chunks > 1 ? g_new (SortKey, n_iters) : NULL;
+  while (n_chunks > 1)
+    {
+      bint n_merged = 0;
+
+      for (i = 0; i < n_chunks; i += 2)
+        {
+          if (i + 1 < n_chunks)
+            sort_key_merge (keys + bounds[i], bounds[i + 1] - bounds[i],
+                            keys + bounds[i + 1], bounds[i + 2] - bounds[i + 1],
+                            tmp + bounds[i], &info);
+          else
+            memcpy (tmp + bounds[i], keys + bounds[i],
+                    (bounds[i + 1] - bounds[i]) * sizeof (SortKey));
+
+          bounds[n_merged++] = bounds[i];
+        }
+      bounds[n_merged] = n_iters;
+      n_chunks = n_merged;
+
+      swap = keys;
+      keys = tmp;
+      tmp = swap;
+    }
+
+  new_order = g_new (bint, n_iters);
+  for (i = 0; i < n_iters; i++)
+    {
+      new_order[i] = keys[i].index;
+      if (info.kind == SORT_KEY_STRING)
+        g_free (keys[i].key.v_string);
+    }
+
+  g_free (keys);
+  g_free (tmp);
+  g_free (bounds);
+  g_free (chunks);
+
+  return new_order;
+}
+
 GList *
 _btk_tree_data_list_header_new (bint   n_columns,
 				GType *types)
@@ -555,3 +913,325 @@ _btk_tree_data_list_set_header (GList                  *header_list,
 
   return header_list;
 }
+
+/* Column storage
+ *
+ * Instead of a list of cells per row, every column gets one array with
+ * a cell for each row, sized for the type of the column.  A row is a
+ * slot in those arrays; its handle is the slot index plus one, so that
+ * NULL still means "no values set yet".  Strings are interned and
+ * shared between cells; each interned string counts the cells using
+ * it and is freed with the last of them.
+ */
+struct _BtkTreeDataColumns
+{
+  bint          n_columns;
+  GType        *types;
+  buint        *sizes;
+  GArray      **cells;
+  GArray       *free_slots;
+  GHashTable   *strings;
+  buint         n_slots;
+};
+
+#define ROW_SLOT(row) (BPOINTER_TO_UINT (row) - 1)
+#define SLOT_ROW(slot) (BUINT_TO_POINTER ((slot) + 1))
+
+#define COLUMN_CELL(columns, slot, column) \
+  ((columns)->cells[column]->data + (slot) * (columns)->sizes[column])
+
+static buint
+cell_size (GType type)
+{
+  switch (get_fundamental_type (type))
+    {
+    case B_TYPE_CHAR:
+    case B_TYPE_UCHAR:
+      return sizeof (bint8);
+    case B_TYPE_BOOLEAN:
+    case B_TYPE_INT:
+    case B_TYPE_UINT:
+    case B_TYPE_ENUM:
+    case B_TYPE_FLAGS:
+      return sizeof (bint);
+    case B_TYPE_FLOAT:
+      return sizeof (bfloat);
+    case B_TYPE_LONG:
+    case B_TYPE_ULONG:
+      return sizeof (blong);
+    case B_TYPE_INT64:
+    case B_TYPE_UINT64:
+      return sizeof (bint64);
+    case B_TYPE_DOUBLE:
+      return sizeof (bdouble);
+    default:
+      return sizeof (bpointer);
+    }
+}
+
+/* Every member of the cell union starts at its beginning, so copying
+ * the first sizes[column] bytes moves exactly the member in use.
+ */
+static inline void
+load_cell (BtkTreeDataColumns *columns,
+           buint               slot,
+           bint                column,
+           BtkTreeDataList    *cell)
+{
+  memset (cell, 0, sizeof (BtkTreeDataList));
+  memcpy (&cell->data, COLUMN_CELL (columns, slot, column),
+          columns->sizes[column]);
+}
+
+static inline void
+store_cell (BtkTreeDataColumns *columns,
+            buint               slot,
+            bint                column,
+            BtkTreeDataList    *cell)
+{
+  memcpy (COLUMN_CELL (columns, slot, column), &cell->data,
+          columns->sizes[column]);
+}
+
+static const bchar *
+ref_string (BtkTreeDataColumns *columns,
+            const bchar        *str)
+{
+  bpointer key, count;
+
+  if (g_hash_table_lookup_extended (columns->strings, str, &key, &count))
+    {
+      g_hash_table_insert (columns->strings, key,
+                           BUINT_TO_POINTER (BPOINTER_TO_UINT (count) + 1));
+      return key;
+    }
+
+  key = g_strdup (str);
+  g_hash_table_insert (columns->strings, key, BUINT_TO_POINTER (1));
+
+  return key;
+}
+
+static void
+unref_string (BtkTreeDataColumns *columns,
+              const bchar        *str)
+{
+  buint count;
+
+  count = BPOINTER_TO_UINT (g_hash_table_lookup (columns->strings, str));
+  if (count > 1)
+    g_hash_table_insert (columns->strings, (bpointer) str,
+                         BUINT_TO_POINTER (count - 1));
+  else
+    g_hash_table_remove (columns->strings, str);
+}
+
+static void
+release_cell (BtkTreeDataColumns *columns,
+              buint               slot,
+              bint                column)
+{
+  GType type = columns->types[column];
+  BtkTreeDataList cell;
+
+  load_cell (columns, slot, column, &cell);
+
+  if (get_fundamental_type (type) == B_TYPE_STRING)
+    {
+      if (cell.data.v_pointer != NULL)
+        unref_string (columns, cell.data.v_pointer);
+    }
+  else if (g_type_is_a (type, B_TYPE_OBJECT) && cell.data.v_pointer != NULL)
+    g_object_unref (cell.data.v_pointer);
+  else if (g_type_is_a (type, B_TYPE_BOXED) && cell.data.v_pointer != NULL)
+    g_boxed_free (type, cell.data.v_pointer);
+}
+
+BtkTreeDataColumns *
+_btk_tree_data_columns_new (bint   n_columns,
+                            GType *types)
+{
+  BtkTreeDataColumns *columns;
+  bint i;
+
+  columns = g_slice_new0 (BtkTreeDataColumns);
+  columns->n_columns = n_columns;
+  columns->types = g_memdup (types, n_columns * sizeof (GType));
+  columns->sizes = g_new (buint, n_columns);
+  columns->cells = g_new (GArray *, n_columns);
+
+  for (i = 0; i < n_columns; i++)
+    {
+      columns->sizes[i] = cell_size (types[i]);
+      columns->cells[i] = g_array_new (FALSE, TRUE, columns->sizes[i]);
+    }
+
+  columns->free_slots = g_array_new (FALSE, FALSE, sizeof (buint));
+  columns->strings = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                            g_free, NULL);
+
+  return columns;
+}
+
+void
+_btk_tree_data_columns_free (BtkTreeDataColumns *columns)
+{
+  buint slot;
+  bint i;
+
+  /* free slots are zeroed, so releasing every slot is safe */
+  for (i = 0; i < columns->n_columns; i++)
+    {
+      for (slot = 0; slot < columns->n_slots; slot++)
+        release_cell (columns, slot, i);
+
+      g_array_free (columns->cells[i], TRUE);
+    }
+
+  g_array_free (columns->free_slots, TRUE);
+  g_hash_table_destroy (columns->strings);
+  g_free (columns->cells);
+  g_free (columns->sizes);
+  g_free (columns->types);
+
+  g_slice_free (BtkTreeDataColumns, columns);
+}
+
+bpointer
+_btk_tree_data_columns_row_alloc (BtkTreeDataColumns *columns)
+{
+  buint slot;
+  bint i;
+
+  if (columns->free_slots->len > 0)
+    {
+      slot = g_array_index (columns->free_slots, buint,
+                            columns->free_slots->len - 1);
+      g_array_set_size (columns->free_slots, columns->free_slots->len - 1);
+
+      return SLOT_ROW (slot);
+    }
+
+  slot = columns->n_slots++;
+  for (i = 0; i < columns->n_columns; i++)
+    g_array_set_size (columns->cells[i], columns->n_slots);
+
+  return SLOT_ROW (slot);
+}
+
+void
+_btk_tree_data_columns_row_free (BtkTreeDataColumns *columns,
+                                 bpointer            row)
+{
+  buint slot;
+  bint i;
+
+  if (row == NULL)
+    return;
+
+  slot = ROW_SLOT (row);
+
+  for (i = 0; i < columns->n_columns; i++)
+    {
+      release_cell (columns, slot, i);
+      memset (COLUMN_CELL (columns, slot, i), 0, columns->sizes[i]);
+    }
+
+  g_array_append_val (columns->free_slots, slot);
+
+  /* last row gone, start over to give back the arrays */
+  if (columns->free_slots->len == columns->n_slots)
+    {
+      for (i = 0; i < columns->n_columns; i++)
+        g_array_set_size (columns->cells[i], 0);
+
+      g_array_set_size (columns->free_slots, 0);
+      columns->n_slots = 0;
+    }
+}
+
+bpointer
+_btk_tree_data_columns_row_copy (BtkTreeDataColumns *columns,
+                                 bpointer            row)
+{
+  bpointer copy;
+  BtkTreeDataList cell;
+  GType type;
+  bint i;
+
+  g_return_val_if_fail (row != NULL, NULL);
+
+  copy = _btk_tree_data_columns_row_alloc (columns);
+
+  for (i = 0; i < columns->n_columns; i++)
+    {
+      type = columns->types[i];
+
+      load_cell (columns, ROW_SLOT (row), i, &cell);
+
+      /* interned strings are shared */
+      if (get_fundamental_type (type) == B_TYPE_STRING)
+        {
+          if (cell.data.v_pointer != NULL)
+            ref_string (columns, cell.data.v_pointer);
+        }
+      else if (g_type_is_a (type, B_TYPE_OBJECT) && cell.data.v_pointer != NULL)
+        g_object_ref (cell.data.v_pointer);
+      else if (g_type_is_a (type, B_TYPE_BOXED) && cell.data.v_pointer != NULL)
+        cell.data.v_pointer = g_boxed_copy (type, cell.data.v_pointer);
+
+      store_cell (columns, ROW_SLOT (copy), i, &cell);
+    }
+
+  return copy;
+}
+
+void
+_btk_tree_data_columns_get_value (BtkTreeDataColumns *columns,
+                                  bpointer            row,
+                                  bint                column,
+                                  BValue             *value)
+{
+  BtkTreeDataList cell;
+
+  if (row == NULL)
+    {
+      b_value_init (value, columns->types[column]);
+      return;
+    }
+
+  load_cell (columns, ROW_SLOT (row), column, &cell);
+  _btk_tree_data_list_node_to_value (&cell, columns->types[column], value);
+}
+
+void
+_btk_tree_data_columns_set_value (BtkTreeDataColumns *columns,
+                                  bpointer            row,
+                                  bint                column,
+                                  BValue             *value)
+{
+  BtkTreeDataList cell;
+  const bchar *str;
+
+  g_return_if_fail (row != NULL);
+
+  if (get_fundamental_type (G_VALUE_TYPE (value)) == B_TYPE_STRING)
+    {
+      str = b_value_get_string (value);
+
+      /* take the new reference first, the string may be the same */
+      memset (&cell, 0, sizeof (BtkTreeDataList));
+      if (str)
+        cell.data.v_pointer = (bpointer) ref_string (columns, str);
+
+      release_cell (columns, ROW_SLOT (row), column);
+    }
+  else
+    {
+      /* start from the old value, so it gets released */
+      load_cell (columns, ROW_SLOT (row), column, &cell);
+      _btk_tree_data_list_value_to_node (&cell, value);
+    }
+
+  store_cell (columns, ROW_SLOT (row), column, &cell);
+}
@@ -63,6 +63,34 @@ void             _btk_tree_data_list_value_to_node  (BtkTreeDataList *list,
 BtkTreeDataList *_btk_tree_data_list_node_copy      (BtkTreeDataList *list,
                                                      GType            type);
 
+/* Column storage */
+typedef struct _BtkTreeDataColumns BtkTreeDataColumns;
+
+BtkTreeDataColumns *_btk_tree_data_columns_new       (bint                n_columns,
+                                                      GType              *types);
+void                _btk_tree_data_columns_free      (BtkTreeDataColumns *columns);
+bpointer            _btk_tree_data_columns_row_alloc (BtkTreeDataColumns *columns);
+void                _btk_tree_data_columns_row_free  (BtkTreeDataColumns *columns,
+                                                      bpointer            row);
+bpointer            _btk_tree_data_columns_row_copy  (BtkTreeDataColumns *columns,
+                                                      bpointer            row);
+void                _btk_tree_data_columns_get_value (BtkTreeDataColumns *columns,
+                                                      bpointer            row,
+                                                      bint                column,
+                                                      BValue             *value);
+void                _btk_tree_data_columns_set_value (BtkTreeDataColumns *columns,
+                                                      bpointer            row,
+                                                      bint                column,
+                                                      BValue             *value);
+
+/* Sorting */
+bint               *_btk_tree_data_list_sort_by_key  (BtkTreeModel           *model,
+                                                      BtkTreeIter            *iters,
+                                                      bint                    n_iters,
+                                                      BtkTreeIterCompareFunc  func,
+                                                      bpointer                data,
+                                                      BtkSortType             order);
+
 /* Header code */
 bint                   _btk_tree_data_list_compare_func (BtkTreeModel *model,
 							 BtkTreeIter  *a,
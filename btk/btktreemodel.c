@@ -40,6 +40,7 @@
     }B_STMT_END
 
 #define ROW_REF_DATA_STRING "btk-tree-row-refs"
+#define RANGE_HANDLERS_DATA_STRING "btk-tree-model-range-handlers"
 
 enum {
   ROW_CHANGED,
@@ -47,6 +48,7 @@ enum {
   ROW_HAS_CHILD_TOGGLED,
   ROW_DELETED,
   ROWS_REORDERED,
+  ROWS_INSERTED,
   LAST_SIGNAL
 };
 
@@ -84,10 +86,17 @@ static void      rows_reordered_marshal     (GClosure          *closure,
                                              const BValue      *param_values,
                                              bpointer           invocation_hint,
                                              bpointer           marshal_data);
+static void      rows_inserted_marshal      (GClosure          *closure,
+                                             BValue /* out */  *return_value,
+                                             buint              n_param_value,
+                                             const BValue      *param_values,
+                                             bpointer           invocation_hint,
+                                             bpointer           marshal_data);
 
 static void      btk_tree_row_ref_inserted  (RowRefList        *refs,
                                              BtkTreePath       *path,
-                                             BtkTreeIter       *iter);
+                                             BtkTreeIter       *iter,
+                                             bint               n_rows);
 static void      btk_tree_row_ref_deleted   (RowRefList        *refs,
                                              BtkTreePath       *path);
 static void      btk_tree_row_ref_reordered (RowRefList        *refs,
@@ -136,6 +145,7 @@ btk_tree_model_base_init (bpointer g_class)
       GType row_inserted_params[2];
       GType row_deleted_params[1];
       GType rows_reordered_params[3];
+      GType rows_inserted_params[3];
 
       row_inserted_params[0] = BTK_TYPE_TREE_PATH | G_SIGNAL_TYPE_STATIC_SCOPE;
       row_inserted_params[1] = BTK_TYPE_TREE_ITER;
@@ -146,6 +156,10 @@ btk_tree_model_base_init (bpointer g_class)
       rows_reordered_params[1] = BTK_TYPE_TREE_ITER;
       rows_reordered_params[2] = B_TYPE_POINTER;
 
+      rows_inserted_params[0] = BTK_TYPE_TREE_PATH | G_SIGNAL_TYPE_STATIC_SCOPE;
+      rows_inserted_params[1] = BTK_TYPE_TREE_ITER;
+      rows_inserted_params[2] = B_TYPE_INT;
+
       /**
        * BtkTreeModel::row-changed:
        * @tree_model: the #BtkTreeModel on which the signal is emitted
@@ -276,6 +290,35 @@ btk_tree_model_base_init (bpointer g_class)
                        _btk_marshal_VOID__BOXED_BOXED_POINTER,
                        B_TYPE_NONE, 3,
                        rows_reordered_params);
+
+      /**
+       * BtkTreeModel::rows-inserted:
+       * @tree_model: the #BtkTreeModel on which the signal is emitted
+       * @path: a #BtkTreePath identifying the first new row
+       * @iter: a valid #BtkTreeIter pointing to the first new row
+       * @n_rows: the number of consecutive rows that were inserted
+       *
+       * This signal is emitted when @n_rows consecutive rows have been
+       * inserted in one go, starting at @path.  It replaces the
+       * #BtkTreeModel::row-inserted emissions for those rows, so the
+       * models in BTK+ only emit it when none of the
+       * #BtkTreeModel::row-inserted handlers needs the rows one at a
+       * time.  Models that implement the row_inserted vfunc but not
+       * rows_inserted still get one call per row.
+       *
+       * Since: 2.24.34
+       */
+      closure = g_closure_new_simple (sizeof (GClosure), NULL);
+      g_closure_set_marshal (closure, rows_inserted_marshal);
+      tree_model_signals[ROWS_INSERTED] =
+        g_signal_newv (I_("rows-inserted"),
+                       BTK_TYPE_TREE_MODEL,
+                       G_SIGNAL_RUN_FIRST,
+                       closure,
+                       NULL, NULL,
+                       _btk_marshal_VOID__BOXED_BOXED_INT,
+                       B_TYPE_NONE, 3,
+                       rows_inserted_params);
       initialized = TRUE;
     }
 }
@@ -300,7 +343,7 @@ row_inserted_marshal (GClosure          *closure,
 
   /* first, we need to update internal row references */
   btk_tree_row_ref_inserted ((RowRefList *)g_object_get_data (model, ROW_REF_DATA_STRING),
-                             path, iter);
+                             path, iter, 1);
                                
   /* fetch the interface ->row_inserted implementation */
   iface = BTK_TREE_MODEL_GET_IFACE (model);
@@ -377,6 +420,51 @@ rows_reordered_marshal (GClosure          *closure,
     rows_reordered_callback (BTK_TREE_MODEL (model), path, iter, new_order);
 }
 
+static void
+rows_inserted_marshal (GClosure          *closure,
+                       BValue /* out */  *return_value,
+                       buint              n_param_values,
+                       const BValue      *param_values,
+                       bpointer           invocation_hint,
+                       bpointer           marshal_data)
+{
+  BtkTreeModelIface *iface;
+
+  BObject *model = b_value_get_object (param_values + 0);
+  BtkTreePath *path = (BtkTreePath *)b_value_get_boxed (param_values + 1);
+  BtkTreeIter *iter = (BtkTreeIter *)b_value_get_boxed (param_values + 2);
+  bint n_rows = b_value_get_int (param_values + 3);
+
+  /* first, we need to update internal row references */
+  btk_tree_row_ref_inserted ((RowRefList *)g_object_get_data (model, ROW_REF_DATA_STRING),
+                             path, iter, n_rows);
+
+  iface = BTK_TREE_MODEL_GET_IFACE (model);
+
+  if (iface->rows_inserted)
+    iface->rows_inserted (BTK_TREE_MODEL (model), path, iter, n_rows);
+  else if (iface->row_inserted)
+    {
+      BtkTreePath *row_path;
+      BtkTreeIter row_iter;
+      bint i;
+
+      /* a model that only knows about single rows gets them one by one */
+      row_path = btk_tree_path_copy (path);
+      row_iter = *iter;
+      for (i = 0; i < n_rows; i++)
+        {
+          iface->row_inserted (BTK_TREE_MODEL (model), row_path, &row_iter);
+
+          if (i + 1 < n_rows &&
+              !btk_tree_model_iter_next (BTK_TREE_MODEL (model), &row_iter))
+            break;
+          btk_tree_path_next (row_path);
+        }
+      btk_tree_path_free (row_path);
+    }
+}
+
 /**
  * btk_tree_path_new:
  *
@@ -1525,6 +1613,112 @@ btk_tree_model_row_inserted (BtkTreeModel *tree_model,
   g_signal_emit (tree_model, tree_model_signals[ROW_INSERTED], 0, path, iter);
 }
 
+/**
+ * btk_tree_model_rows_inserted:
+ * @tree_model: A #BtkTreeModel
+ * @path: A #BtkTreePath pointing to the first inserted row
+ * @iter: A valid #BtkTreeIter pointing to the first inserted row
+ * @n_rows: the number of consecutive rows that were inserted
+ *
+ * Emits the "rows-inserted" signal on @tree_model.  This should be
+ * called by models after @n_rows consecutive rows have been inserted,
+ * instead of calling btk_tree_model_row_inserted() for each of them,
+ * when none of the #BtkTreeModel::row-inserted handlers relies on
+ * per-row notification.
+ *
+ * Since: 2.24.34
+ **/
+void
+btk_tree_model_rows_inserted (BtkTreeModel *tree_model,
+			      BtkTreePath  *path,
+			      BtkTreeIter  *iter,
+			      bint          n_rows)
+{
+  g_return_if_fail (BTK_IS_TREE_MODEL (tree_model));
+  g_return_if_fail (path != NULL);
+  g_return_if_fail (iter != NULL);
+  g_return_if_fail (n_rows > 0);
+
+  g_signal_emit (tree_model, tree_model_signals[ROWS_INSERTED], 0, path, iter, n_rows);
+}
+
+static void
+free_range_handlers (bpointer data)
+{
+  g_array_free (data, TRUE);
+}
+
+/* Marks the ::row-inserted handler @handler_id on @tree_model as one
+ * that belongs to an object which is also connected to ::rows-inserted
+ * and does not need the rows one at a time.
+ */
+void
+_btk_tree_model_add_range_handler (BtkTreeModel *tree_model,
+                                   bulong        handler_id)
+{
+  GArray *handlers;
+
+  g_return_if_fail (BTK_IS_TREE_MODEL (tree_model));
+
+  handlers = g_object_get_data (B_OBJECT (tree_model), RANGE_HANDLERS_DATA_STRING);
+  if (!handlers)
+    {
+      handlers = g_array_new (FALSE, FALSE, sizeof (bulong));
+      g_object_set_data_full (B_OBJECT (tree_model),
+                              I_(RANGE_HANDLERS_DATA_STRING),
+                              handlers, free_range_handlers);
+    }
+
+  g_array_append_val (handlers, handler_id);
+}
+
+/* Whether @tree_model may announce a run of new rows with a single
+ * ::rows-inserted.  That is the case when the model's own interface
+ * does not handle ::row-inserted without also handling ::rows-inserted,
+ * and every ::row-inserted handler connected to it was registered with
+ * _btk_tree_model_add_range_handler().
+ */
+bboolean
+_btk_tree_model_rows_inserted_supported (BtkTreeModel *tree_model)
+{
+  BtkTreeModelIface *iface;
+  GArray *handlers;
+  bboolean pending;
+  bint i;
+
+  g_return_val_if_fail (BTK_IS_TREE_MODEL (tree_model), FALSE);
+
+  iface = BTK_TREE_MODEL_GET_IFACE (tree_model);
+  if (iface->row_inserted && !iface->rows_inserted)
+    return FALSE;
+
+  handlers = g_object_get_data (B_OBJECT (tree_model), RANGE_HANDLERS_DATA_STRING);
+  if (!handlers)
+    return !g_signal_has_handler_pending (tree_model,
+                                          tree_model_signals[ROW_INSERTED],
+                                          0, FALSE);
+
+  /* forget about handlers that have been disconnected since; handler
+   * ids are not reused, so this can not hit a different handler
+   */
+  for (i = handlers->len - 1; i >= 0; i--)
+    if (!g_signal_handler_is_connected (tree_model,
+                                        g_array_index (handlers, bulong, i)))
+      g_array_remove_index_fast (handlers, i);
+
+  for (i = 0; i < handlers->len; i++)
+    g_signal_handler_block (tree_model, g_array_index (handlers, bulong, i));
+
+  pending = g_signal_has_handler_pending (tree_model,
+                                          tree_model_signals[ROW_INSERTED],
+                                          0, FALSE);
+
+  for (i = 0; i < handlers->len; i++)
+    g_signal_handler_unblock (tree_model, g_array_index (handlers, bulong, i));
+
+  return !pending;
+}
+
 /**
  * btk_tree_model_row_has_child_toggled:
  * @tree_model: A #BtkTreeModel
@@ -1713,7 +1907,8 @@ release_row_references (bpointer data)
 static void
 btk_tree_row_ref_inserted (RowRefList  *refs,
 			   BtkTreePath *path,
-			   BtkTreeIter *iter)
+			   BtkTreeIter *iter,
+			   bint         n_rows)
 {
   GSList *tmp_list;
 
@@ -1755,7 +1950,7 @@ btk_tree_row_ref_inserted (RowRefList  *refs,
 	    goto done;
 
 	  if (path->indices[path->depth-1] <= reference->path->indices[path->depth-1])
-	    reference->path->indices[path->depth-1] += 1;
+	    reference->path->indices[path->depth-1] += n_rows;
 	}
     done:
       tmp_list = b_slist_next (tmp_list);
@@ -2149,7 +2344,28 @@ btk_tree_row_reference_inserted (BObject     *proxy,
 {
   g_return_if_fail (G_IS_OBJECT (proxy));
 
-  btk_tree_row_ref_inserted ((RowRefList *)g_object_get_data (proxy, ROW_REF_DATA_STRING), path, NULL);
+  btk_tree_row_ref_inserted ((RowRefList *)g_object_get_data (proxy, ROW_REF_DATA_STRING), path, NULL, 1);
+}
+
+/**
+ * btk_tree_row_reference_rows_inserted:
+ * @proxy: A #BObject
+ * @path: The position of the first inserted row
+ * @n_rows: The number of rows that were inserted
+ *
+ * Lets a set of row reference created by btk_tree_row_reference_new_proxy()
+ * know that the model emitted the "rows-inserted" signal.
+ *
+ * Since: 2.24.34
+ **/
+void
+btk_tree_row_reference_rows_inserted (BObject     *proxy,
+				      BtkTreePath *path,
+				      bint         n_rows)
+{
+  g_return_if_fail (G_IS_OBJECT (proxy));
+
+  btk_tree_row_ref_inserted ((RowRefList *)g_object_get_data (proxy, ROW_REF_DATA_STRING), path, NULL, n_rows);
 }
 
 /**
@@ -118,6 +118,12 @@ struct _BtkTreeModelIface
 				    BtkTreeIter  *iter);
   void         (* unref_node)      (BtkTreeModel *tree_model,
 				    BtkTreeIter  *iter);
+
+  /* Signals, continued */
+  void         (* rows_inserted)   (BtkTreeModel *tree_model,
+				    BtkTreePath  *path,
+				    BtkTreeIter  *iter,
+				    bint          n_rows);
 };
 
 
@@ -171,10 +177,13 @@ BtkTreeModel        *btk_tree_row_reference_get_model (BtkTreeRowReference *refe
 bboolean             btk_tree_row_reference_valid     (BtkTreeRowReference *reference);
 BtkTreeRowReference *btk_tree_row_reference_copy      (BtkTreeRowReference *reference);
 void                 btk_tree_row_reference_free      (BtkTreeRowReference *reference);
-/* These two functions are only needed if you created the row reference with a
+/* These functions are only needed if you created the row reference with a
  * proxy object */
 void                 btk_tree_row_reference_inserted  (BObject     *proxy,
 						       BtkTreePath *path);
+void                 btk_tree_row_reference_rows_inserted (BObject     *proxy,
+							   BtkTreePath *path,
+							   bint         n_rows);
 void                 btk_tree_row_reference_deleted   (BObject     *proxy,
 						       BtkTreePath *path);
 void                 btk_tree_row_reference_reordered (BObject     *proxy,
@@ -264,6 +273,10 @@ void btk_tree_model_rows_reordered        (BtkTreeModel *tree_model,
 					   BtkTreePath  *path,
 					   BtkTreeIter  *iter,
 					   bint         *new_order);
+void btk_tree_model_rows_inserted         (BtkTreeModel *tree_model,
+					   BtkTreePath  *path,
+					   BtkTreeIter  *iter,
+					   bint          n_rows);
 
 B_END_DECLS
 
@@ -23,6 +23,7 @@
 #include "btkintl.h"
 #include "btktreednd.h"
 #include "btkprivate.h"
+#include "btktreeprivate.h"
 #include "btkalias.h"
 #include <string.h>
 
@@ -107,9 +108,14 @@ struct _BtkTreeModelFilterPrivate
   bboolean in_row_deleted;
   bboolean virtual_root_deleted;
 
+  /* incremental refilter: the next child row to look at */
+  BtkTreeRowReference *refilter_row;
+  buint refilter_id;
+
   /* signal ids */
   buint changed_id;
   buint inserted_id;
+  buint rows_inserted_id;
   buint has_child_toggled_id;
   buint deleted_id;
   buint reordered_id;
@@ -154,6 +160,11 @@ static void         btk_tree_model_filter_row_inserted                    (BtkTr
                                                                            BtkTreePath            *c_path,
                                                                            BtkTreeIter            *c_iter,
                                                                            bpointer                data);
+static void         btk_tree_model_filter_rows_inserted                   (BtkTreeModel           *c_model,
+                                                                           BtkTreePath            *c_path,
+                                                                           BtkTreeIter            *c_iter,
+                                                                           bint                    n_rows,
+                                                                           bpointer                data);
 static void         btk_tree_model_filter_row_has_child_toggled           (BtkTreeModel           *c_model,
                                                                            BtkTreePath            *c_path,
                                                                            BtkTreeIter            *c_iter,
@@ -233,6 +244,7 @@ static BtkTreePath *btk_tree_model_filter_remove_root                     (BtkTr
                                                                            BtkTreePath            *root);
 
 static void         btk_tree_model_filter_increment_stamp                 (BtkTreeModelFilter     *filter);
+static void         btk_tree_model_filter_cancel_refilter                 (BtkTreeModelFilter     *filter);
 
 static bboolean     btk_tree_model_filter_visible                         (BtkTreeModelFilter     *filter,
                                                                            BtkTreeIter            *child_iter);
@@ -1391,6 +1403,92 @@ done:
     btk_tree_path_free (c_path);
 }
 
+/* Moves the virtual root along when @n_rows rows are inserted at
+ * @c_path in the child model before it.
+ */
+static void
+btk_tree_model_filter_shift_virtual_root (BtkTreeModelFilter *filter,
+                                          BtkTreePath        *c_path,
+                                          bint                n_rows)
+{
+  bint i, level;
+  bint *v_indices, *c_indices;
+
+  if (!filter->priv->virtual_root ||
+      btk_tree_path_get_depth (filter->priv->virtual_root) <
+      btk_tree_path_get_depth (c_path))
+    return;
+
+  level = btk_tree_path_get_depth (c_path) - 1;
+  v_indices = btk_tree_path_get_indices (filter->priv->virtual_root);
+  c_indices = btk_tree_path_get_indices (c_path);
+
+  for (i = 0; i < level; i++)
+    if (v_indices[i] != c_indices[i])
+      return;
+
+  if (v_indices[level] >= c_indices[level])
+    v_indices[level] += n_rows;
+}
+
+/* Returns the level a row inserted at @real_path goes into, or %NULL
+ * if the filter does not cover it.  When the parent row is known but
+ * its children have not been built, ::row-has-child-toggled is emitted
+ * for it instead.
+ */
+static FilterLevel *
+btk_tree_model_filter_find_insert_level (BtkTreeModelFilter *filter,
+                                         BtkTreePath        *real_path)
+{
+  FilterLevel *level = FILTER_LEVEL (filter->priv->root);
+  FilterElt *elt;
+  bint i;
+
+  for (i = 0; i < btk_tree_path_get_depth (real_path) - 1; i++)
+    {
+      bint j;
+
+      if (!level)
+        /* we don't cover this signal */
+        return NULL;
+
+      elt = bsearch_elt_with_offset (level->array,
+                                     btk_tree_path_get_indices (real_path)[i],
+                                     &j);
+
+      if (!elt)
+        /* parent is probably being filtered out */
+        return NULL;
+
+      if (!elt->children)
+        {
+          BtkTreePath *tmppath;
+          BtkTreeIter  tmpiter;
+
+          tmpiter.stamp = filter->priv->stamp;
+          tmpiter.user_data = level;
+          tmpiter.user_data2 = elt;
+
+          tmppath = btk_tree_model_get_path (BTK_TREE_MODEL (filter),
+                                             &tmpiter);
+
+          if (tmppath)
+            {
+              btk_tree_model_row_has_child_toggled (BTK_TREE_MODEL (filter),
+                                                    tmppath, &tmpiter);
+              btk_tree_path_free (tmppath);
+            }
+
+          /* not covering this signal */
+          return NULL;
+        }
+
+      level = elt->children;
+    }
+
+  return level;
+}
+
 static void
 btk_tree_model_filter_row_inserted (BtkTreeModel *c_model,
                                     BtkTreePath  *c_path,
@@ -1404,11 +1502,9 @@ btk_tree_model_filter_row_inserted (BtkTreeModel *c_model,
 
   BtkTreeIter real_c_iter;
 
-  FilterElt *elt;
   FilterLevel *level;
-  FilterLevel *parent_level;
 
-  bint i = 0, offset;
+  bint i, offset;
 
   bboolean free_c_path = FALSE;
 
@@ -1428,30 +1524,7 @@ btk_tree_model_filter_row_inserted (BtkTreeModel *c_model,
   /* the row has already been inserted. so we need to fixup the
    * virtual root here first
    */
-  if (filter->priv->virtual_root)
-    {
-      if (btk_tree_path_get_depth (filter->priv->virtual_root) >=
-          btk_tree_path_get_depth (c_path))
-        {
-          bint level;
-          bint *v_indices, *c_indices;
-          bboolean common_prefix = TRUE;
-
-          level = btk_tree_path_get_depth (c_path) - 1;
-          v_indices = btk_tree_path_get_indices (filter->priv->virtual_root);
-          c_indices = btk_tree_path_get_indices (c_path);
-
-          for (i = 0; i < level; i++)
-            if (v_indices[i] != c_indices[i])
-              {
-                common_prefix = FALSE;
-                break;
-              }
-
-          if (common_prefix && v_indices[level] >= c_indices[level])
-            (v_indices[level])++;
-        }
-    }
+  btk_tree_model_filter_shift_virtual_root (filter, c_path, 1);
 
   if (!filter->priv->root)
     {
@@ -1470,8 +1543,6 @@ btk_tree_model_filter_row_inserted (BtkTreeModel *c_model,
         goto done;
     }
 
-  parent_level = level = FILTER_LEVEL (filter->priv->root);
-
   /* subtract virtual root if necessary */
   if (filter->priv->virtual_root)
     {
@@ -1484,55 +1555,8 @@ btk_tree_model_filter_row_inserted (BtkTreeModel *c_model,
   else
     real_path = btk_tree_path_copy (c_path);
 
-  if (btk_tree_path_get_depth (real_path) - 1 >= 1)
-    {
-      /* find the parent level */
-      while (i < btk_tree_path_get_depth (real_path) - 1)
-        {
-          bint j;
-
-          if (!level)
-            /* we don't cover this signal */
-            goto done;
-
-          elt = bsearch_elt_with_offset (level->array,
-                                         btk_tree_path_get_indices (real_path)[i],
-                                         &j);
-
-          if (!elt)
-            /* parent is probably being filtered out */
-            goto done;
-
-          if (!elt->children)
-            {
-              BtkTreePath *tmppath;
-              BtkTreeIter  tmpiter;
-
-              tmpiter.stamp = filter->priv->stamp;
-              tmpiter.user_data = level;
-              tmpiter.user_data2 = elt;
-
-              tmppath = btk_tree_model_get_path (BTK_TREE_MODEL (data),
-                                                 &tmpiter);
-
-              if (tmppath)
-                {
-                  btk_tree_model_row_has_child_toggled (BTK_TREE_MODEL (data),
-                                                        tmppath, &tmpiter);
-                  btk_tree_path_free (tmppath);
-                }
-
-              /* not covering this signal */
-              goto done;
-            }
-
-          level = elt->children;
-          parent_level = level;
-          i++;
-        }
-    }
-
-  if (!parent_level)
+  level = btk_tree_model_filter_find_insert_level (filter, real_path);
+  if (!level)
     goto done;
 
   /* let's try to insert the value */
@@ -1626,6 +1650,237 @@ done:
     btk_tree_path_free (c_path);
 }
 
+/* Announces @n_rows consecutive visible rows, the first of which is
+ * @c_path in the child model.
+ */
+static void
+btk_tree_model_filter_emit_rows_inserted (BtkTreeModelFilter *filter,
+                                          BtkTreePath        *c_path,
+                                          bint                n_rows)
+{
+  BtkTreePath *path;
+  BtkTreeIter iter;
+  bint i;
+
+  /* NOTE: pass c_path here. This function does root subtraction itself */
+  path = btk_real_tree_model_filter_convert_child_path_to_path (filter,
+                                                                c_path,
+                                                                FALSE, TRUE);
+  if (!path)
+    return;
+
+  btk_tree_model_filter_increment_stamp (filter);
+
+  btk_tree_model_filter_get_iter_full (BTK_TREE_MODEL (filter), &iter, path);
+
+  /* get a path taking only visible nodes into account */
+  btk_tree_path_free (path);
+  path = btk_tree_model_get_path (BTK_TREE_MODEL (filter), &iter);
+
+  if (_btk_tree_model_rows_inserted_supported (BTK_TREE_MODEL (filter)))
+    btk_tree_model_rows_inserted (BTK_TREE_MODEL (filter), path, &iter, n_rows);
+  else
+    {
+      /* Announce the rows in order, so every path is valid for a
+       * listener that has only seen the rows before it.
+       */
+      for (i = 0; i < n_rows; i++)
+        {
+          if (i > 0)
+            {
+              btk_tree_path_next (path);
+              if (!btk_tree_model_get_iter (BTK_TREE_MODEL (filter), &iter, path))
+                break;
+            }
+
+          btk_tree_model_row_inserted (BTK_TREE_MODEL (filter), path, &iter);
+        }
+    }
+
+  btk_tree_path_free (path);
+}
+
+static void
+btk_tree_model_filter_rows_inserted (BtkTreeModel *c_model,
+                                     BtkTreePath  *c_path,
+                                     BtkTreeIter  *c_iter,
+                                     bint          n_rows,
+                                     bpointer      data)
+{
+  BtkTreeModelFilter *filter = BTK_TREE_MODEL_FILTER (data);
+  BtkTreePath *real_path = NULL;
+  BtkTreePath *first_path;
+  BtkTreeIter c_child;
+
+  FilterElt *elt;
+  FilterLevel *level;
+  GArray *new_elts;
+
+  bint i, index, offset;
+  bint first_visible = -1;
+
+  g_return_if_fail (c_path != NULL && c_iter != NULL);
+
+  /* Without listeners for the range the rows are handed to the single
+   * row handler one by one.  Building the root level pulls in all of
+   * them at once though, so that case is handled below either way.
+   */
+  if (filter->priv->root &&
+      !_btk_tree_model_rows_inserted_supported (BTK_TREE_MODEL (filter)))
+    {
+      real_path = btk_tree_path_copy (c_path);
+      c_child = *c_iter;
+      for (i = 0; i < n_rows; i++)
+        {
+          btk_tree_model_filter_row_inserted (c_model, real_path, &c_child, data);
+
+          if (i + 1 < n_rows && !btk_tree_model_iter_next (c_model, &c_child))
+            break;
+          btk_tree_path_next (real_path);
+        }
+
+      goto done;
+    }
+
+  /* the rows have already been inserted. so we need to fixup the
+   * virtual root here first
+   */
+  btk_tree_model_filter_shift_virtual_root (filter, c_path, n_rows);
+
+  /* subtract virtual root if necessary */
+  if (filter->priv->virtual_root)
+    {
+      real_path = btk_tree_model_filter_remove_root (c_path,
+                                                     filter->priv->virtual_root);
+      /* not our children */
+      if (!real_path)
+        goto done;
+    }
+  else
+    real_path = btk_tree_path_copy (c_path);
+
+  offset = btk_tree_path_get_indices (real_path)[btk_tree_path_get_depth (real_path) - 1];
+
+  if (!filter->priv->root)
+    {
+      /* build level will pull in the new children */
+      btk_tree_model_filter_build_level (filter, NULL, -1, FALSE);
+
+      level = FILTER_LEVEL (filter->priv->root);
+      if (!level || btk_tree_path_get_depth (real_path) != 1)
+        goto done;
+
+      /* the visible new rows are a consecutive run of the level */
+      index = 0;
+      for (i = 0; i < level->array->len; i++)
+        {
+          elt = &g_array_index (level->array, FilterElt, i);
+          if (elt->offset >= offset + n_rows)
+            break;
+          if (elt->offset >= offset && elt->visible)
+            {
+              if (first_visible < 0)
+                first_visible = elt->offset - offset;
+              index++;
+            }
+        }
+
+      goto done_and_emit;
+    }
+
+  level = btk_tree_model_filter_find_insert_level (filter, real_path);
+  if (!level)
+    goto done;
+
+  /* update the offsets of the rows after the new ones in one pass */
+  for (i = 0; i < level->array->len; i++)
+    {
+      FilterElt *e = &g_array_index (level->array, FilterElt, i);
+      if (e->offset >= offset)
+        e->offset += n_rows;
+    }
+
+  /* collect the visible new rows; they end up next to each other */
+  new_elts = g_array_new (FALSE, FALSE, sizeof (FilterElt));
+
+  c_child = *c_iter;
+  for (i = 0; i < n_rows; i++)
+    {
+      if (btk_tree_model_filter_visible (filter, &c_child))
+        {
+          FilterElt felt;
+
+          if (BTK_TREE_MODEL_FILTER_CACHE_CHILD_ITERS (filter))
+            felt.iter = c_child;
+
+          felt.offset = offset + i;
+          felt.zero_ref_count = 0;
+          felt.ref_count = 0;
+          felt.visible = TRUE;
+          felt.children = NULL;
+
+          g_array_append_val (new_elts, felt);
+
+          if (first_visible < 0)
+            first_visible = i;
+        }
+
+      if (i + 1 < n_rows && !btk_tree_model_iter_next (c_model, &c_child))
+        break;
+    }
+
+  index = new_elts->len;
+  if (index > 0)
+    {
+      bint start;
+
+      for (start = 0; start < level->array->len; start++)
+        if (g_array_index (level->array, FilterElt, start).offset > offset)
+          break;
+
+      g_array_insert_vals (level->array, start, new_elts->data, new_elts->len);
+      level->visible_nodes += new_elts->len;
+
+      if (level->parent_level || filter->priv->virtual_root)
+        for (i = start; i < start + new_elts->len; i++)
+          {
+            BtkTreeIter f_iter;
+
+            f_iter.stamp = filter->priv->stamp;
+            f_iter.user_data = level;
+            f_iter.user_data2 = &g_array_index (level->array, FilterElt, i);
+
+            btk_tree_model_filter_ref_node (BTK_TREE_MODEL (filter), &f_iter);
+          }
+
+      /* another iteration to update the references of children to parents. */
+      for (i = 0; i < level->array->len; i++)
+        {
+          FilterElt *e = &g_array_index (level->array, FilterElt, i);
+          if (e->children)
+            e->children->parent_elt_index = i;
+        }
+    }
+
+  g_array_free (new_elts, TRUE);
+
+done_and_emit:
+  /* index is the number of visible new rows here */
+  if (first_visible < 0)
+    goto done;
+
+  first_path = btk_tree_path_copy (c_path);
+  btk_tree_path_get_indices (first_path)[btk_tree_path_get_depth (first_path) - 1] += first_visible;
+
+  btk_tree_model_filter_emit_rows_inserted (filter, first_path, index);
+
+  btk_tree_path_free (first_path);
+
+done:
+  if (real_path)
+    btk_tree_path_free (real_path);
+}
+
 static void
 btk_tree_model_filter_row_has_child_toggled (BtkTreeModel *c_model,
                                              BtkTreePath  *c_path,
@@ -2853,6 +3108,8 @@ btk_tree_model_filter_set_model (BtkTreeModelFilter *filter,
                                    filter->priv->changed_id);
       g_signal_handler_disconnect (filter->priv->child_model,
                                    filter->priv->inserted_id);
+      g_signal_handler_disconnect (filter->priv->child_model,
+                                   filter->priv->rows_inserted_id);
       g_signal_handler_disconnect (filter->priv->child_model,
                                    filter->priv->has_child_toggled_id);
       g_signal_handler_disconnect (filter->priv->child_model,
@@ -2860,6 +3117,8 @@ btk_tree_model_filter_set_model (BtkTreeModelFilter *filter,
       g_signal_handler_disconnect (filter->priv->child_model,
                                    filter->priv->reordered_id);
 
+      btk_tree_model_filter_cancel_refilter (filter);
+
       /* reset our state */
       if (filter->priv->root)
         btk_tree_model_filter_free_level (filter, filter->priv->root);
@@ -2884,6 +3143,12 @@ btk_tree_model_filter_set_model (BtkTreeModelFilter *filter,
         g_signal_connect (child_model, "row-inserted",
                           G_CALLBACK (btk_tree_model_filter_row_inserted),
                           filter);
+      _btk_tree_model_add_range_handler (child_model,
+                                         filter->priv->inserted_id);
+      filter->priv->rows_inserted_id =
+        g_signal_connect (child_model, "rows-inserted",
+                          G_CALLBACK (btk_tree_model_filter_rows_inserted),
+                          filter);
       filter->priv->has_child_toggled_id =
         g_signal_connect (child_model, "row-has-child-toggled",
                           G_CALLBACK (btk_tree_model_filter_row_has_child_toggled),
@@ -3459,6 +3724,169 @@ btk_tree_model_filter_refilter_helper (BtkTreeModel *model,
   return FALSE;
 }
 
+static BtkTreePath *
+btk_tree_model_filter_refilter_start (BtkTreeModelFilter *filter)
+{
+  BtkTreePath *path;
+
+  if (filter->priv->virtual_root)
+    {
+      path = btk_tree_path_copy (filter->priv->virtual_root);
+      btk_tree_path_down (path);
+    }
+  else
+    path = btk_tree_path_new_first ();
+
+  return path;
+}
+
+/* Moves @iter and @path to the next row in depth first order, not
+ * leaving the subtree the walk started in.
+ */
+static bboolean
+btk_tree_model_filter_refilter_next (BtkTreeModelFilter *filter,
+                                     BtkTreePath        *path,
+                                     BtkTreeIter        *iter)
+{
+  BtkTreeModel *model = filter->priv->child_model;
+  BtkTreeIter tmp;
+  bint min_depth;
+
+  if (btk_tree_model_iter_children (model, &tmp, iter))
+    {
+      *iter = tmp;
+      btk_tree_path_down (path);
+      return TRUE;
+    }
+
+  min_depth = filter->priv->virtual_root
+    ? btk_tree_path_get_depth (filter->priv->virtual_root) + 1 : 1;
+
+  while (TRUE)
+    {
+      tmp = *iter;
+      if (btk_tree_model_iter_next (model, &tmp))
+        {
+          *iter = tmp;
+          btk_tree_path_next (path);
+          return TRUE;
+        }
+
+      if (btk_tree_path_get_depth (path) <= min_depth ||
+          !btk_tree_model_iter_parent (model, &tmp, iter))
+        return FALSE;
+
+      *iter = tmp;
+      btk_tree_path_up (path);
+    }
+}
+
+/* time spent on one chunk of an incremental refilter, in seconds */
+#define REFILTER_SLICE 0.005
+
+static bboolean
+btk_tree_model_filter_refilter_idle (bpointer data)
+{
+  BtkTreeModelFilter *filter = BTK_TREE_MODEL_FILTER (data);
+  BtkTreePath *path;
+  BtkTreeIter iter;
+  GTimer *timer;
+  bboolean more;
+  bint n_rows = 0;
+
+  path = btk_tree_row_reference_get_path (filter->priv->refilter_row);
+  btk_tree_row_reference_free (filter->priv->refilter_row);
+  filter->priv->refilter_row = NULL;
+
+  /* the row we were going to continue with is gone, start over */
+  if (!path)
+    path = btk_tree_model_filter_refilter_start (filter);
+
+  more = btk_tree_model_get_iter (filter->priv->child_model, &iter, path);
+
+  timer = g_timer_new ();
+  while (more)
+    {
+      btk_tree_model_filter_row_changed (filter->priv->child_model,
+                                         path, &iter, filter);
+
+      more = btk_tree_model_filter_refilter_next (filter, path, &iter);
+
+      /* the timer is only checked every now and then */
+      if (more && ++n_rows % 64 == 0 &&
+          g_timer_elapsed (timer, NULL) > REFILTER_SLICE)
+        break;
+    }
+  g_timer_destroy (timer);
+
+  if (more)
+    filter->priv->refilter_row =
+      btk_tree_row_reference_new (filter->priv->child_model, path);
+  else
+    filter->priv->refilter_id = 0;
+
+  btk_tree_path_free (path);
+
+  return more;
+}
+
+static void
+btk_tree_model_filter_cancel_refilter (BtkTreeModelFilter *filter)
+{
+  if (filter->priv->refilter_id)
+    {
+      g_source_remove (filter->priv->refilter_id);
+      filter->priv->refilter_id = 0;
+    }
+
+  if (filter->priv->refilter_row)
+    {
+      btk_tree_row_reference_free (filter->priv->refilter_row);
+      filter->priv->refilter_row = NULL;
+    }
+}
+
+/**
+ * btk_tree_model_filter_refilter_async:
+ * @filter: A #BtkTreeModelFilter.
+ *
+ * Like btk_tree_model_filter_refilter(), but re-evaluates the rows in
+ * small chunks from an idle handler, so that the user interface stays
+ * responsive while a large model is refiltered.  Rows change their
+ * visibility chunk by chunk.
+ *
+ * Calling this function again, or calling btk_tree_model_filter_refilter(),
+ * abandons a refilter that is still in progress.
+ *
+ * Since: 2.24.34
+ */
+void
+btk_tree_model_filter_refilter_async (BtkTreeModelFilter *filter)
+{
+  BtkTreePath *path;
+
+  g_return_if_fail (BTK_IS_TREE_MODEL_FILTER (filter));
+
+  btk_tree_model_filter_cancel_refilter (filter);
+
+  if (!filter->priv->child_model)
+    return;
+
+  path = btk_tree_model_filter_refilter_start (filter);
+  filter->priv->refilter_row =
+    btk_tree_row_reference_new (filter->priv->child_model, path);
+  btk_tree_path_free (path);
+
+  /* nothing to filter */
+  if (!filter->priv->refilter_row)
+    return;
+
+  filter->priv->refilter_id =
+    bdk_threads_add_idle_full (G_PRIORITY_DEFAULT_IDLE,
+                               btk_tree_model_filter_refilter_idle,
+                               filter, NULL);
+}
+
 /**
  * btk_tree_model_filter_refilter:
  * @filter: A #BtkTreeModelFilter.
@@ -3473,6 +3901,8 @@ btk_tree_model_filter_refilter (BtkTreeModelFilter *filter)
 {
   g_return_if_fail (BTK_IS_TREE_MODEL_FILTER (filter));
 
+  btk_tree_model_filter_cancel_refilter (filter);
+
   /* S L O W */
   btk_tree_model_foreach (filter->priv->child_model,
                           btk_tree_model_filter_refilter_helper,
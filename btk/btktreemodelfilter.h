@@ -102,6 +102,7 @@ BtkTreePath  *btk_tree_model_filter_convert_path_to_child_path (BtkTreeModelFilt
 
 /* extras */
 void          btk_tree_model_filter_refilter                   (BtkTreeModelFilter           *filter);
+void          btk_tree_model_filter_refilter_async             (BtkTreeModelFilter           *filter);
 void          btk_tree_model_filter_clear_cache                (BtkTreeModelFilter           *filter);
 
 B_END_DECLS
@@ -47,6 +47,7 @@
 #include "btkintl.h"
 #include "btkprivate.h"
 #include "btktreednd.h"
+#include "btktreeprivate.h"
 #include "btkalias.h"
 
 typedef struct _SortElt SortElt;
@@ -69,6 +70,7 @@ struct _SortLevel
   bint       ref_count;
   bint       parent_elt_index;
   SortLevel *parent_level;
+  buint      needs_resort : 1;
 };
 
 struct _SortData
@@ -109,6 +111,23 @@ enum {
 
 #define NO_SORT_FUNC ((BtkTreeIterCompareFunc) 0x1)
 
+/* Every row that moves after a change costs a rows-reordered over its
+ * whole level.  After this many moves in one main loop iteration, the
+ * levels with changed rows are sorted once from an idle instead, or
+ * as soon as a row of them is looked up by position.
+ */
+#define MAX_MOVES_PER_ITERATION 16
+
+#define BTK_TREE_MODEL_SORT_GET_PRIVATE(obj) (B_TYPE_INSTANCE_GET_PRIVATE ((obj), BTK_TYPE_TREE_MODEL_SORT, BtkTreeModelSortPrivate))
+
+typedef struct _BtkTreeModelSortPrivate BtkTreeModelSortPrivate;
+
+struct _BtkTreeModelSortPrivate
+{
+  buint resort_id;
+  bint  n_moves;
+};
+
 #define VALID_ITER(iter, tree_model_sort) ((iter) != NULL && (iter)->user_data != NULL && (iter)->user_data2 != NULL && (tree_model_sort)->stamp == (iter)->stamp)
 
 /* general (object/interface init, etc) */
@@ -134,6 +153,11 @@ static void btk_tree_model_sort_row_inserted          (BtkTreeModel          *mo
 						       BtkTreePath           *path,
 						       BtkTreeIter           *iter,
 						       bpointer               data);
+static void btk_tree_model_sort_rows_inserted         (BtkTreeModel          *model,
+						       BtkTreePath           *path,
+						       BtkTreeIter           *iter,
+						       bint                   n_rows,
+						       bpointer               data);
 static void btk_tree_model_sort_row_has_child_toggled (BtkTreeModel          *model,
 						       BtkTreePath           *path,
 						       BtkTreeIter           *iter,
@@ -228,10 +252,11 @@ static bint         btk_tree_model_sort_level_find_insert (BtkTreeModelSort *tre
 							   SortLevel        *level,
 							   BtkTreeIter      *iter,
 							   bint             skip_index);
-static bboolean     btk_tree_model_sort_insert_value      (BtkTreeModelSort *tree_model_sort,
+static bint         btk_tree_model_sort_insert_value      (BtkTreeModelSort *tree_model_sort,
 							   SortLevel        *level,
 							   BtkTreePath      *s_path,
-							   BtkTreeIter      *s_iter);
+							   BtkTreeIter      *s_iter,
+							   bint              n_rows);
 static BtkTreePath *btk_tree_model_sort_elt_get_path      (SortLevel        *level,
 							   SortElt          *elt);
 static void         btk_tree_model_sort_set_model         (BtkTreeModelSort *tree_model_sort,
@@ -279,6 +304,8 @@ btk_tree_model_sort_class_init (BtkTreeModelSortClass *class)
 							P_("The model for the TreeModelSort to sort"),
 							BTK_TYPE_TREE_MODEL,
 							BTK_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY));
+
+  g_type_class_add_private (class, sizeof (BtkTreeModelSortPrivate));
 }
 
 static void
@@ -407,6 +434,69 @@ btk_tree_model_sort_get_property (BObject    *object,
     }
 }
 
+static void
+btk_tree_model_sort_resort_level (BtkTreeModelSort *tree_model_sort,
+				  SortLevel        *level)
+{
+  bint i;
+
+  if (level->needs_resort)
+    btk_tree_model_sort_sort_level (tree_model_sort, level, FALSE, TRUE);
+
+  for (i = 0; i < level->array->len; i++)
+    {
+      SortElt *elt = &g_array_index (level->array, SortElt, i);
+
+      if (elt->children)
+	btk_tree_model_sort_resort_level (tree_model_sort, elt->children);
+    }
+}
+
+static bboolean
+btk_tree_model_sort_resort_idle (bpointer data)
+{
+  BtkTreeModelSort *tree_model_sort = BTK_TREE_MODEL_SORT (data);
+  BtkTreeModelSortPrivate *priv = BTK_TREE_MODEL_SORT_GET_PRIVATE (tree_model_sort);
+
+  priv->resort_id = 0;
+  priv->n_moves = 0;
+
+  if (tree_model_sort->root)
+    btk_tree_model_sort_resort_level (tree_model_sort, tree_model_sort->root);
+
+  return FALSE;
+}
+
+/* Returns TRUE if a changed row that needs to move should stay where
+ * it is for now, leaving @level to be sorted from an idle.
+ */
+static bboolean
+btk_tree_model_sort_defer_resort (BtkTreeModelSort *tree_model_sort,
+				  SortLevel        *level)
+{
+  BtkTreeModelSortPrivate *priv = BTK_TREE_MODEL_SORT_GET_PRIVATE (tree_model_sort);
+
+  /* the idle marks the end of the main loop iteration */
+  if (priv->resort_id == 0)
+    {
+      priv->n_moves = 0;
+      priv->resort_id =
+	bdk_threads_add_idle_full (G_PRIORITY_HIGH_IDLE,
+				   btk_tree_model_sort_resort_idle,
+				   tree_model_sort, NULL);
+    }
+
+  if (priv->n_moves < MAX_MOVES_PER_ITERATION)
+    {
+      priv->n_moves++;
+      return FALSE;
+    }
+
+  level->needs_resort = TRUE;
+
+  return TRUE;
+}
+
 static void
 btk_tree_model_sort_row_changed (BtkTreeModel *s_model,
 				 BtkTreePath  *start_s_path,
@@ -452,7 +542,8 @@ btk_tree_model_sort_row_changed (BtkTreeModel *s_model,
 
   if (level->array->len < 2 ||
       (tree_model_sort->sort_column_id == BTK_TREE_SORTABLE_DEFAULT_SORT_COLUMN_ID &&
-       tree_model_sort->default_sort_func == NO_SORT_FUNC))
+       tree_model_sort->default_sort_func == NO_SORT_FUNC) ||
+      level->needs_resort)
     {
       if (free_s_path)
 	btk_tree_path_free (start_s_path);
@@ -486,6 +577,20 @@ btk_tree_model_sort_row_changed (BtkTreeModel *s_model,
 						   &tmpiter,
 						   old_index);
 
+  if (index != old_index &&
+      btk_tree_model_sort_defer_resort (tree_model_sort, level))
+    {
+      if (free_s_path)
+	btk_tree_path_free (start_s_path);
+
+      btk_tree_model_row_changed (BTK_TREE_MODEL (data), path, &iter);
+      btk_tree_model_sort_unref_node (BTK_TREE_MODEL (data), &iter);
+
+      btk_tree_path_free (path);
+
+      return;
+    }
+
   if (index < old_index)
     {
       g_memmove (level->array->data + ((index + 1)*sizeof (SortElt)),
@@ -501,7 +606,8 @@ btk_tree_model_sort_row_changed (BtkTreeModel *s_model,
   memcpy (level->array->data + ((index)*sizeof (SortElt)),
 	  &tmp, sizeof (SortElt));
 
-  for (i = 0; i < level->array->len; i++)
+  /* only the rows between the old and the new place moved */
+  for (i = MIN (index, old_index); i <= MAX (index, old_index); i++)
     if (g_array_index (level->array, SortElt, i).children)
       g_array_index (level->array, SortElt, i).children->parent_elt_index = i;
 
@@ -577,6 +683,54 @@ btk_tree_model_sort_row_changed (BtkTreeModel *s_model,
     btk_tree_path_free (start_s_path);
 }
 
+/* Returns the level a row inserted at @s_path goes into, or %NULL if
+ * that level has not been built.
+ */
+static SortLevel *
+btk_tree_model_sort_find_insert_level (BtkTreeModelSort *tree_model_sort,
+				       BtkTreePath      *s_path)
+{
+  SortLevel *level = SORT_LEVEL (tree_model_sort->root);
+  SortElt *elt;
+  bint i, j;
+
+  for (i = 0; i < btk_tree_path_get_depth (s_path) - 1; i++)
+    {
+      if (!level)
+	{
+	  /* level not yet build, we won't cover this signal */
+	  return NULL;
+	}
+
+      if (level->array->len < btk_tree_path_get_indices (s_path)[i])
+	{
+	  g_warning ("%s: A node was inserted with a parent that's not in the tree.\n"
+		     "This possibly means that a BtkTreeModel inserted a child node\n"
+		     "before the parent was inserted.",
+		     B_STRLOC);
+	  return NULL;
+	}
+
+      elt = NULL;
+      for (j = 0; j < level->array->len; j++)
+	if (g_array_index (level->array, SortElt, j).offset == btk_tree_path_get_indices (s_path)[i])
+	  {
+	    elt = &g_array_index (level->array, SortElt, j);
+	    break;
+	  }
+
+      g_return_val_if_fail (elt != NULL, NULL);
+
+      /* not covering this signal */
+      if (!elt->children)
+	return NULL;
+
+      level = elt->children;
+    }
+
+  return level;
+}
+
 static void
 btk_tree_model_sort_row_inserted (BtkTreeModel          *s_model,
 				  BtkTreePath           *s_path,
@@ -588,15 +742,9 @@ btk_tree_model_sort_row_inserted (BtkTreeModel          *s_model,
   BtkTreeIter iter;
   BtkTreeIter real_s_iter;
 
-  bint i = 0;
-
   bboolean free_s_path = FALSE;
 
-  SortElt *elt;
   SortLevel *level;
-  SortLevel *parent_level = NULL;
-
-  parent_level = level = SORT_LEVEL (tree_model_sort->root);
 
   g_return_if_fail (s_path != NULL || s_iter != NULL);
 
@@ -621,48 +769,8 @@ btk_tree_model_sort_row_inserted (BtkTreeModel          *s_model,
       goto done_and_submit;
     }
 
-  /* find the parent level */
-  while (i < btk_tree_path_get_depth (s_path) - 1)
-    {
-      bint j;
-
-      if (!level)
-	{
-	  /* level not yet build, we won't cover this signal */
-	  goto done;
-	}
-
-      if (level->array->len < btk_tree_path_get_indices (s_path)[i])
-	{
-	  g_warning ("%s: A node was inserted with a parent that's not in the tree.\n"
-		     "This possibly means that a BtkTreeModel inserted a child node\n"
-		     "before the parent was inserted.",
-		     B_STRLOC);
-	  goto done;
-	}
-
-      elt = NULL;
-      for (j = 0; j < level->array->len; j++)
-	if (g_array_index (level->array, SortElt, j).offset == btk_tree_path_get_indices (s_path)[i])
-	  {
-	    elt = &g_array_index (level->array, SortElt, j);
-	    break;
-	  }
-
-      g_return_if_fail (elt != NULL);
-
-      if (!elt->children)
-	{
-	  /* not covering this signal */
-	  goto done;
-	}
-
-      level = elt->children;
-      parent_level = level;
-      i++;
-    }
-
-  if (!parent_level)
+  level = btk_tree_model_sort_find_insert_level (tree_model_sort, s_path);
+  if (!level)
     goto done;
 
   if (level->ref_count == 0 && level != tree_model_sort->root)
@@ -671,11 +779,8 @@ btk_tree_model_sort_row_inserted (BtkTreeModel          *s_model,
       goto done;
     }
 
-  if (!btk_tree_model_sort_insert_value (tree_model_sort,
-					 parent_level,
-					 s_path,
-					 &real_s_iter))
-    goto done;
+  btk_tree_model_sort_insert_value (tree_model_sort, level,
+				    s_path, &real_s_iter, 1);
 
  done_and_submit:
   path = btk_real_tree_model_sort_convert_child_path_to_path (tree_model_sort,
@@ -698,6 +803,118 @@ btk_tree_model_sort_row_inserted (BtkTreeModel          *s_model,
   return;
 }
 
+static void
+btk_tree_model_sort_rows_inserted (BtkTreeModel          *s_model,
+				   BtkTreePath           *s_path,
+				   BtkTreeIter           *s_iter,
+				   bint                   n_rows,
+				   bpointer               data)
+{
+  BtkTreeModelSort *tree_model_sort = BTK_TREE_MODEL_SORT (data);
+  BtkTreePath *path;
+  BtkTreeIter iter;
+  BtkTreeIter s_child;
+
+  bint i, offset, index;
+
+  SortElt *elt;
+  SortLevel *level;
+
+  g_return_if_fail (s_path != NULL && s_iter != NULL);
+
+  if (!tree_model_sort->root)
+    {
+      btk_tree_model_sort_build_level (tree_model_sort, NULL, -1);
+
+      /* the build level already put the inserted rows in the level,
+       * they only need to be announced, in the order they ended up in.
+       */
+      level = SORT_LEVEL (tree_model_sort->root);
+      if (!level || btk_tree_path_get_depth (s_path) != 1)
+	return;
+
+      btk_tree_model_sort_increment_stamp (tree_model_sort);
+
+      if (level->array->len == n_rows &&
+	  _btk_tree_model_rows_inserted_supported (BTK_TREE_MODEL (data)))
+	{
+	  path = btk_tree_path_new_first ();
+	  btk_tree_model_get_iter (BTK_TREE_MODEL (data), &iter, path);
+	  btk_tree_model_rows_inserted (BTK_TREE_MODEL (data), path, &iter, n_rows);
+	  btk_tree_path_free (path);
+
+	  return;
+	}
+
+      offset = btk_tree_path_get_indices (s_path)[0];
+      for (i = 0; i < level->array->len; i++)
+	{
+	  elt = &g_array_index (level->array, SortElt, i);
+	  if (elt->offset < offset || elt->offset >= offset + n_rows)
+	    continue;
+
+	  path = btk_tree_path_new_from_indices (i, -1);
+	  btk_tree_model_get_iter (BTK_TREE_MODEL (data), &iter, path);
+	  btk_tree_model_row_inserted (BTK_TREE_MODEL (data), path, &iter);
+	  btk_tree_path_free (path);
+	}
+
+      return;
+    }
+
+  /* The range can only be passed on as a range if somebody listens
+   * for it.  Everything else is left to the single row handler, which
+   * copes with rows being added one at a time just fine.
+   */
+  if (!_btk_tree_model_rows_inserted_supported (BTK_TREE_MODEL (data)))
+    goto replay;
+
+  level = btk_tree_model_sort_find_insert_level (tree_model_sort, s_path);
+  if (!level)
+    return;
+
+  /* the single row handler frees the level */
+  if (level->ref_count == 0 && level != tree_model_sort->root)
+    goto replay;
+
+  /* Without a sort function the new rows keep their place in the child
+   * model, otherwise they are appended and sorted into place afterwards
+   * with a single rows-reordered.
+   */
+  index = btk_tree_model_sort_insert_value (tree_model_sort, level,
+					    s_path, s_iter, n_rows);
+
+  btk_tree_model_sort_increment_stamp (tree_model_sort);
+
+  iter.stamp = tree_model_sort->stamp;
+  iter.user_data = level;
+  iter.user_data2 = &g_array_index (level->array, SortElt, index);
+
+  path = btk_tree_model_get_path (BTK_TREE_MODEL (data), &iter);
+  btk_tree_model_rows_inserted (BTK_TREE_MODEL (data), path, &iter, n_rows);
+  btk_tree_path_free (path);
+
+  if (n_rows > 1 &&
+      !(tree_model_sort->sort_column_id == BTK_TREE_SORTABLE_DEFAULT_SORT_COLUMN_ID &&
+	tree_model_sort->default_sort_func == NO_SORT_FUNC))
+    btk_tree_model_sort_sort_level (tree_model_sort, level, FALSE, TRUE);
+
+  return;
+
+ replay:
+  path = btk_tree_path_copy (s_path);
+  s_child = *s_iter;
+  for (i = 0; i < n_rows; i++)
+    {
+      btk_tree_model_sort_row_inserted (s_model, path, &s_child, data);
+
+      if (i + 1 < n_rows && !btk_tree_model_iter_next (s_model, &s_child))
+	break;
+      btk_tree_path_next (path);
+    }
+  btk_tree_path_free (path);
+}
+
 static void
 btk_tree_model_sort_row_has_child_toggled (BtkTreeModel *s_model,
 					   BtkTreePath  *s_path,
@@ -1059,6 +1276,7 @@ btk_tree_model_sort_iter_children (BtkTreeModel *tree_model,
 	return FALSE;
 
       level = tree_model_sort->root;
+
       iter->stamp = tree_model_sort->stamp;
       iter->user_data = level;
       iter->user_data2 = level->array->data;
@@ -1550,6 +1768,45 @@ btk_tree_model_sort_offset_compare_func (gconstpointer a,
   return retval;
 }
 
+/* Sorts by the keys of the rows when the column compare function is
+ * the default one; returns the new order, or %NULL if nothing was done.
+ */
+static bint *
+btk_tree_model_sort_sort_by_key (BtkTreeModelSort *tree_model_sort,
+				 SortLevel        *level,
+				 SortData         *data)
+{
+  BtkTreeIter *iters;
+  bint *new_order;
+  bint i;
+
+  if (data->sort_func != _btk_tree_data_list_compare_func)
+    return NULL;
+
+  iters = g_new (BtkTreeIter, level->array->len);
+  for (i = 0; i < level->array->len; i++)
+    {
+      SortElt *elt = &g_array_index (level->array, SortElt, i);
+
+      if (BTK_TREE_MODEL_SORT_CACHE_CHILD_ITERS (tree_model_sort))
+	iters[i] = elt->iter;
+      else
+	{
+	  data->parent_path_indices [data->parent_path_depth-1] = elt->offset;
+	  btk_tree_model_get_iter (BTK_TREE_MODEL (tree_model_sort->child_model),
+				   &iters[i], data->parent_path);
+	}
+    }
+
+  new_order = _btk_tree_data_list_sort_by_key (tree_model_sort->child_model,
+					       iters, level->array->len,
+					       data->sort_func, data->sort_data,
+					       tree_model_sort->order);
+  g_free (iters);
+
+  return new_order;
+}
+
 static void
 btk_tree_model_sort_sort_level (BtkTreeModelSort *tree_model_sort,
 				SortLevel        *level,
@@ -1569,6 +1826,8 @@ btk_tree_model_sort_sort_level (BtkTreeModelSort *tree_model_sort,
 
   g_return_if_fail (level != NULL);
 
+  level->needs_resort = FALSE;
+
   if (level->array->len < 1 && !((SortElt *)level->array->data)->children)
     return;
 
@@ -1632,6 +1891,19 @@ btk_tree_model_sort_sort_level (BtkTreeModelSort *tree_model_sort,
     g_array_sort_with_data (sort_array,
 			    btk_tree_model_sort_offset_compare_func,
 			    &data);
+  else if ((new_order = btk_tree_model_sort_sort_by_key (tree_model_sort,
+							 level, &data)))
+    {
+      for (i = 0; i < level->array->len; i++)
+	{
+	  SortTuple *tuple = &g_array_index (sort_array, SortTuple, i);
+
+	  tuple->elt = &g_array_index (level->array, SortElt, new_order[i]);
+	  tuple->offset = new_order[i];
+	}
+
+      g_free (new_order);
+    }
   else
     g_array_sort_with_data (sort_array,
 			    btk_tree_model_sort_compare_func,
@@ -1830,47 +2102,76 @@ btk_tree_model_sort_level_find_insert (BtkTreeModelSort *tree_model_sort,
     return middle;
 }
 
-static bboolean
+/* Adds @n_rows rows, the first of which is @s_iter at @s_path, to
+ * @level and returns the index of the first one.  A single row is
+ * inserted at its sorted position, unless @level already waits for
+ * the resort idle; a run of rows is appended and has to be sorted by
+ * the caller.
+ */
+static bint
 btk_tree_model_sort_insert_value (BtkTreeModelSort *tree_model_sort,
 				  SortLevel        *level,
 				  BtkTreePath      *s_path,
-				  BtkTreeIter      *s_iter)
+				  BtkTreeIter      *s_iter,
+				  bint              n_rows)
 {
   bint offset, index, i;
 
-  SortElt elt;
+  GArray *new_elts;
+  BtkTreeIter s_child;
   SortElt *tmp_elt;
 
   offset = btk_tree_path_get_indices (s_path)[btk_tree_path_get_depth (s_path) - 1];
 
-  if (BTK_TREE_MODEL_SORT_CACHE_CHILD_ITERS (tree_model_sort))
-    elt.iter = *s_iter;
-  elt.offset = offset;
-  elt.zero_ref_count = 0;
-  elt.ref_count = 0;
-  elt.children = NULL;
+  new_elts = g_array_sized_new (FALSE, FALSE, sizeof (SortElt), n_rows);
+  s_child = *s_iter;
+  for (i = 0; i < n_rows; i++)
+    {
+      SortElt elt;
+
+      if (BTK_TREE_MODEL_SORT_CACHE_CHILD_ITERS (tree_model_sort))
+	elt.iter = s_child;
+      elt.offset = offset + i;
+      elt.zero_ref_count = 0;
+      elt.ref_count = 0;
+      elt.children = NULL;
+
+      g_array_append_val (new_elts, elt);
+
+      if (i + 1 < n_rows)
+	btk_tree_model_iter_next (tree_model_sort->child_model, &s_child);
+    }
 
   /* update all larger offsets */
   tmp_elt = SORT_ELT (level->array->data);
   for (i = 0; i < level->array->len; i++, tmp_elt++)
     if (tmp_elt->offset >= offset)
-      tmp_elt->offset++;
+      tmp_elt->offset += n_rows;
 
   if (tree_model_sort->sort_column_id == BTK_TREE_SORTABLE_DEFAULT_SORT_COLUMN_ID &&
       tree_model_sort->default_sort_func == NO_SORT_FUNC)
     index = offset;
+  else if (n_rows > 1 || level->needs_resort)
+    {
+      /* a level with rows out of place can't be binary searched;
+       * the pending resort puts the new row in place too
+       */
+      index = level->array->len;
+    }
   else
     index = btk_tree_model_sort_level_find_insert (tree_model_sort,
                                                    level, s_iter,
                                                    -1);
 
-  g_array_insert_vals (level->array, index, &elt, 1);
+  g_array_insert_vals (level->array, index, new_elts->data, n_rows);
+  g_array_free (new_elts, TRUE);
+
   tmp_elt = SORT_ELT (level->array->data);
   for (i = 0; i < level->array->len; i++, tmp_elt++)
     if (tmp_elt->children)
       tmp_elt->children->parent_elt_index = i;
 
-  return TRUE;
+  return index;
 }
 
 /* sort elt stuff */
@@ -1930,8 +2231,17 @@ btk_tree_model_sort_set_model (BtkTreeModelSort *tree_model_sort,
                                    tree_model_sort->deleted_id);
       g_signal_handler_disconnect (tree_model_sort->child_model,
 				   tree_model_sort->reordered_id);
+      g_signal_handlers_disconnect_by_func (tree_model_sort->child_model,
+					    btk_tree_model_sort_rows_inserted,
+					    tree_model_sort);
 
       /* reset our state */
+      if (BTK_TREE_MODEL_SORT_GET_PRIVATE (tree_model_sort)->resort_id)
+	{
+	  g_source_remove (BTK_TREE_MODEL_SORT_GET_PRIVATE (tree_model_sort)->resort_id);
+	  BTK_TREE_MODEL_SORT_GET_PRIVATE (tree_model_sort)->resort_id = 0;
+	}
+
       if (tree_model_sort->root)
 	btk_tree_model_sort_free_level (tree_model_sort, tree_model_sort->root);
       tree_model_sort->root = NULL;
@@ -1955,6 +2265,11 @@ btk_tree_model_sort_set_model (BtkTreeModelSort *tree_model_sort,
         g_signal_connect (child_model, "row-inserted",
                           G_CALLBACK (btk_tree_model_sort_row_inserted),
                           tree_model_sort);
+      _btk_tree_model_add_range_handler (child_model,
+                                         tree_model_sort->inserted_id);
+      g_signal_connect (child_model, "rows-inserted",
+			G_CALLBACK (btk_tree_model_sort_rows_inserted),
+			tree_model_sort);
       tree_model_sort->has_child_toggled_id =
         g_signal_connect (child_model, "row-has-child-toggled",
                           G_CALLBACK (btk_tree_model_sort_row_has_child_toggled),
@@ -2036,6 +2351,7 @@ btk_real_tree_model_sort_convert_child_path_to_path (BtkTreeModelSort *tree_mode
 	  btk_tree_path_free (retval);
 	  return NULL;
 	}
+
       for (j = 0; j < level->array->len; j++)
 	{
 	  if ((g_array_index (level->array, SortElt, j)).offset == child_indices[i])
@@ -2278,6 +2594,7 @@ btk_tree_model_sort_build_level (BtkTreeModelSort *tree_model_sort,
   new_level->ref_count = 0;
   new_level->parent_level = parent_level;
   new_level->parent_elt_index = parent_elt_index;
+  new_level->needs_resort = FALSE;
 
   if (parent_elt_index >= 0)
     parent_elt->children = new_level;
@@ -243,6 +243,15 @@ struct _BtkTreeViewPrivate
   buint search_entry_changed_id;
   buint typeselect_flush_timeout;
 
+  /* Prefix index over the search column, built lazily: the rows in
+   * view order, their keys in sorted order, and the rows whose key
+   * starts with the last looked up text, in view order
+   */
+  GSequence *search_index;
+  GSequence *search_index_rows;
+  GSequence *search_index_matches;
+  bchar *search_index_matches_key;
+
   /* Grid and tree lines */
   BtkTreeViewGridLines grid_lines;
   double grid_line_dashes[2];
@@ -287,6 +296,7 @@ struct _BtkTreeViewPrivate
   buint enable_search : 1;
   buint disable_popdown : 1;
   buint search_custom_entry_set : 1;
+  buint enable_search_index : 1;
   
   buint hover_selection : 1;
   buint hover_expand : 1;
@@ -373,6 +383,9 @@ struct _BtkTreeViewPrivate
 
 
 /* functions that shouldn't be exported */
+void         _btk_tree_model_add_range_handler        (BtkTreeModel      *tree_model,
+						       bulong             handler_id);
+bboolean     _btk_tree_model_rows_inserted_supported  (BtkTreeModel      *tree_model);
 void         _btk_tree_selection_internal_select_node (BtkTreeSelection  *selection,
 						       BtkRBNode         *node,
 						       BtkRBTree         *tree,
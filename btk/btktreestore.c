@@ -29,9 +29,20 @@
 #include "btkalias.h"
 
 #define G_NODE(node) ((GNode *)node)
+#define BTK_TREE_STORE_GET_PRIVATE(obj) (B_TYPE_INSTANCE_GET_PRIVATE ((obj), BTK_TYPE_TREE_STORE, BtkTreeStorePrivate))
 #define BTK_TREE_STORE_IS_SORTED(tree) (((BtkTreeStore*)(tree))->sort_column_id != BTK_TREE_SORTABLE_UNSORTED_SORT_COLUMN_ID)
 #define VALID_ITER(iter, tree_store) ((iter)!= NULL && (iter)->user_data != NULL && ((BtkTreeStore*)(tree_store))->stamp == (iter)->stamp)
 
+typedef struct _BtkTreeStorePrivate BtkTreeStorePrivate;
+
+struct _BtkTreeStorePrivate
+{
+  /* created on first use when columnar is set */
+  BtkTreeDataColumns *columns;
+
+  buint columnar : 1;
+};
+
 static void         btk_tree_store_tree_model_init (BtkTreeModelIface *iface);
 static void         btk_tree_store_drag_source_init(BtkTreeDragSourceIface *iface);
 static void         btk_tree_store_drag_dest_init  (BtkTreeDragDestIface   *iface);
@@ -171,6 +182,8 @@ btk_tree_store_class_init (BtkTreeStoreClass *class)
   object_class = (BObjectClass *) class;
 
   object_class->finalize = btk_tree_store_finalize;
+
+  g_type_class_add_private (class, sizeof (BtkTreeStorePrivate));
 }
 
 static void
@@ -399,11 +412,78 @@ btk_tree_store_set_column_type (BtkTreeStore *tree_store,
   tree_store->column_headers[column] = type;
 }
 
+/**
+ * btk_tree_store_set_columnar:
+ * @tree_store: A #BtkTreeStore
+ * @columnar: %TRUE to keep the values in per-column arrays
+ *
+ * Chooses how @tree_store keeps its values.  See
+ * btk_list_store_set_columnar() for the details.
+ *
+ * Like btk_tree_store_set_column_types(), this must be called before a
+ * row has been added or a method of the #BtkTreeModel interface has
+ * been called.
+ *
+ * Since: 2.24.34
+ **/
+void
+btk_tree_store_set_columnar (BtkTreeStore *tree_store,
+			     bboolean      columnar)
+{
+  BtkTreeStorePrivate *priv;
+
+  g_return_if_fail (BTK_IS_TREE_STORE (tree_store));
+  g_return_if_fail (tree_store->columns_dirty == 0);
+
+  priv = BTK_TREE_STORE_GET_PRIVATE (tree_store);
+  priv->columnar = columnar != FALSE;
+}
+
+/**
+ * btk_tree_store_get_columnar:
+ * @tree_store: A #BtkTreeStore
+ *
+ * Returns whether @tree_store keeps its values in per-column arrays.
+ * See btk_tree_store_set_columnar().
+ *
+ * Return value: %TRUE if @tree_store is columnar
+ *
+ * Since: 2.24.34
+ **/
+bboolean
+btk_tree_store_get_columnar (BtkTreeStore *tree_store)
+{
+  g_return_val_if_fail (BTK_IS_TREE_STORE (tree_store), FALSE);
+
+  return BTK_TREE_STORE_GET_PRIVATE (tree_store)->columnar;
+}
+
+static BtkTreeDataColumns *
+btk_tree_store_get_columns (BtkTreeStore *tree_store)
+{
+  BtkTreeStorePrivate *priv = BTK_TREE_STORE_GET_PRIVATE (tree_store);
+
+  /* the column types can't change anymore once there are rows */
+  if (priv->columnar && priv->columns == NULL)
+    priv->columns = _btk_tree_data_columns_new (tree_store->n_columns,
+						tree_store->column_headers);
+
+  return priv->columns;
+}
+
 static bboolean
 node_free (GNode *node, bpointer data)
 {
+  BtkTreeStore *tree_store = data;
+  BtkTreeStorePrivate *priv = BTK_TREE_STORE_GET_PRIVATE (tree_store);
+
   if (node->data)
-    _btk_tree_data_list_free (node->data, (GType*)data);
+    {
+      if (!priv->columnar)
+	_btk_tree_data_list_free (node->data, tree_store->column_headers);
+      else if (priv->columns)
+	_btk_tree_data_columns_row_free (priv->columns, node->data);
+    }
   node->data = NULL;
 
   return FALSE;
@@ -413,10 +493,13 @@ static void
 btk_tree_store_finalize (BObject *object)
 {
   BtkTreeStore *tree_store = BTK_TREE_STORE (object);
+  BtkTreeStorePrivate *priv = BTK_TREE_STORE_GET_PRIVATE (tree_store);
 
   g_node_traverse (tree_store->root, G_POST_ORDER, G_TRAVERSE_ALL, -1,
-		   node_free, tree_store->column_headers);
+		   node_free, tree_store);
   g_node_destroy (tree_store->root);
+  if (priv->columns)
+    _btk_tree_data_columns_free (priv->columns);
   _btk_tree_data_list_header_free (tree_store->sort_list);
   g_free (tree_store->column_headers);
 
@@ -579,6 +662,14 @@ btk_tree_store_get_value (BtkTreeModel *tree_model,
   g_return_if_fail (column < tree_store->n_columns);
   g_return_if_fail (VALID_ITER (iter, tree_store));
 
+  if (BTK_TREE_STORE_GET_PRIVATE (tree_store)->columnar)
+    {
+      _btk_tree_data_columns_get_value (btk_tree_store_get_columns (tree_store),
+					G_NODE (iter->user_data)->data,
+					column, value);
+      return;
+    }
+
   list = G_NODE (iter->user_data)->data;
 
   while (tmp_column-- > 0 && list)
@@ -777,6 +868,24 @@ btk_tree_store_real_set_value (BtkTreeStore *tree_store,
       converted = TRUE;
     }
 
+  if (BTK_TREE_STORE_GET_PRIVATE (tree_store)->columnar)
+    {
+      BtkTreeDataColumns *columns = btk_tree_store_get_columns (tree_store);
+
+      if (G_NODE (iter->user_data)->data == NULL)
+	G_NODE (iter->user_data)->data = _btk_tree_data_columns_row_alloc (columns);
+
+      _btk_tree_data_columns_set_value (columns, G_NODE (iter->user_data)->data,
+					column, converted ? &real_value : value);
+
+      if (converted)
+	b_value_unset (&real_value);
+      if (sort && BTK_TREE_STORE_IS_SORTED (tree_store))
+	btk_tree_store_sort_iter_changed (tree_store, iter, old_column, TRUE);
+
+      return TRUE;
+    }
+
   prev = list = G_NODE (iter->user_data)->data;
 
   while (list != NULL)
@@ -1119,7 +1228,7 @@ btk_tree_store_remove (BtkTreeStore *tree_store,
 
   if (G_NODE (iter->user_data)->data)
     g_node_traverse (G_NODE (iter->user_data), G_POST_ORDER, G_TRAVERSE_ALL,
-		     -1, node_free, tree_store->column_headers);
+		     -1, node_free, tree_store);
 
   path = btk_tree_store_get_path (BTK_TREE_MODEL (tree_store), iter);
   g_node_destroy (G_NODE (iter->user_data));
@@ -1890,6 +1999,14 @@ copy_node_data (BtkTreeStore *tree_store,
   BtkTreePath *path;
   bint col;
 
+  if (BTK_TREE_STORE_GET_PRIVATE (tree_store)->columnar)
+    {
+      if (dl)
+	G_NODE (dest_iter->user_data)->data =
+	  _btk_tree_data_columns_row_copy (btk_tree_store_get_columns (tree_store), dl);
+      goto done;
+    }
+
   col = 0;
   while (dl)
     {
@@ -1909,6 +2026,7 @@ copy_node_data (BtkTreeStore *tree_store,
 
   G_NODE (dest_iter->user_data)->data = copy_head;
 
+ done:
   path = btk_tree_store_get_path (BTK_TREE_MODEL (tree_store), dest_iter);
   btk_tree_model_row_changed (BTK_TREE_MODEL (tree_store), path, dest_iter);
   btk_tree_path_free (path);
@@ -81,6 +81,9 @@ BtkTreeStore *btk_tree_store_newv             (bint          n_columns,
 void          btk_tree_store_set_column_types (BtkTreeStore *tree_store,
 					       bint          n_columns,
 					       GType        *types);
+void          btk_tree_store_set_columnar     (BtkTreeStore *tree_store,
+					       bboolean      columnar);
+bboolean      btk_tree_store_get_columnar     (BtkTreeStore *tree_store);
 
 /* NOTE: use btk_tree_model_get to get values from a BtkTreeStore */
 
@@ -144,7 +144,8 @@ enum {
   PROP_RUBBER_BANDING,
   PROP_ENABLE_GRID_LINES,
   PROP_ENABLE_TREE_LINES,
-  PROP_TOOLTIP_COLUMN
+  PROP_TOOLTIP_COLUMN,
+  PROP_ENABLE_SEARCH_INDEX
 };
 
 /* object signals */
@@ -274,6 +275,11 @@ static void btk_tree_view_row_inserted                    (BtkTreeModel    *mode
 							   BtkTreePath     *path,
 							   BtkTreeIter     *iter,
 							   bpointer         data);
+static void btk_tree_view_rows_inserted                   (BtkTreeModel    *model,
+							   BtkTreePath     *path,
+							   BtkTreeIter     *iter,
+							   bint             n_rows,
+							   bpointer         data);
 static void btk_tree_view_row_has_child_toggled           (BtkTreeModel    *model,
 							   BtkTreePath     *path,
 							   BtkTreeIter     *iter,
@@ -439,6 +445,18 @@ static bboolean btk_tree_view_search_iter               (BtkTreeModel     *model
 							 bint              n);
 static void     btk_tree_view_search_init               (BtkWidget        *entry,
 							 BtkTreeView      *tree_view);
+static void     btk_tree_view_search_index_free         (BtkTreeView      *tree_view);
+static void     btk_tree_view_search_index_reorder      (BtkTreeView      *tree_view,
+							 bint             *new_order);
+static void     btk_tree_view_search_index_row_changed  (BtkTreeView      *tree_view,
+							 BtkTreePath      *path,
+							 BtkTreeIter      *iter);
+static void     btk_tree_view_search_index_rows_inserted (BtkTreeView     *tree_view,
+							 BtkTreePath      *path,
+							 BtkTreeIter      *iter,
+							 bint              n_rows);
+static void     btk_tree_view_search_index_row_deleted  (BtkTreeView      *tree_view,
+							 BtkTreePath      *path);
 static void     btk_tree_view_put                       (BtkTreeView      *tree_view,
 							 BtkWidget        *child_widget,
 							 bint              x,
@@ -770,6 +788,22 @@ btk_tree_view_class_init (BtkTreeViewClass *class)
 						       -1,
 						       BTK_PARAM_READWRITE));
 
+    /**
+     * BtkTreeView:enable-search-index:
+     *
+     * Whether the interactive search keeps a sorted index of the
+     * search column. See btk_tree_view_set_enable_search_index().
+     *
+     * Since: 2.24.34
+     */
+    g_object_class_install_property (o_class,
+				     PROP_ENABLE_SEARCH_INDEX,
+				     g_param_spec_boolean ("enable-search-index",
+							   P_("Enable Search Index"),
+							   P_("Whether interactive search uses an index of the search column"),
+							   FALSE,
+							   BTK_PARAM_READWRITE));
+
   /* Style properties */
 #define _TREE_VIEW_EXPANDER_SIZE 12
 #define _TREE_VIEW_VERTICAL_SEPARATOR 2
@@ -1460,6 +1494,9 @@ btk_tree_view_set_property (BObject         *object,
     case PROP_TOOLTIP_COLUMN:
       btk_tree_view_set_tooltip_column (tree_view, b_value_get_int (value));
       break;
+    case PROP_ENABLE_SEARCH_INDEX:
+      btk_tree_view_set_enable_search_index (tree_view, b_value_get_boolean (value));
+      break;
     default:
       B_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1535,6 +1572,9 @@ btk_tree_view_get_property (BObject    *object,
     case PROP_TOOLTIP_COLUMN:
       b_value_set_int (value, tree_view->priv->tooltip_column);
       break;
+    case PROP_ENABLE_SEARCH_INDEX:
+      b_value_set_boolean (value, tree_view->priv->enable_search_index);
+      break;
     default:
       B_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1544,6 +1584,8 @@ btk_tree_view_get_property (BObject    *object,
 static void
 btk_tree_view_finalize (BObject *object)
 {
+  btk_tree_view_search_index_free (BTK_TREE_VIEW (object));
+
   B_OBJECT_CLASS (btk_tree_view_parent_class)->finalize (object);
 }
 
@@ -8324,6 +8366,16 @@ btk_tree_view_row_changed (BtkTreeModel *model,
 
   g_return_if_fail (path != NULL || iter != NULL);
 
+  if (tree_view->priv->search_index != NULL)
+    {
+      if (path == NULL)
+	{
+	  path = btk_tree_model_get_path (model, iter);
+	  free_path = TRUE;
+	}
+      btk_tree_view_search_index_row_changed (tree_view, path, iter);
+    }
+
   if (tree_view->priv->cursor != NULL)
     cursor_path = btk_tree_row_reference_get_path (tree_view->priv->cursor);
   else
@@ -8387,23 +8439,28 @@ btk_tree_view_row_changed (BtkTreeModel *model,
     btk_tree_path_free (path);
 }
 
+/* Adds nodes for @n_rows rows, the first of which is @iter at @path,
+ * for both ::row-inserted and ::rows-inserted.
+ */
 static void
-btk_tree_view_row_inserted (BtkTreeModel *model,
-			    BtkTreePath  *path,
-			    BtkTreeIter  *iter,
-			    bpointer      data)
+btk_tree_view_insert_rows (BtkTreeView  *tree_view,
+			   BtkTreeModel *model,
+			   BtkTreePath  *path,
+			   BtkTreeIter  *iter,
+			   bint          n_rows)
 {
-  BtkTreeView *tree_view = (BtkTreeView *) data;
+  BtkTreeIter child;
   bint *indices;
   BtkRBTree *tmptree, *tree;
   BtkRBNode *tmpnode = NULL;
+  BtkRBNode *last = NULL;
   bint depth;
   bint i = 0;
   bint height;
-  bboolean free_path = FALSE;
   bboolean node_visible = TRUE;
+  bboolean is_list = BTK_TREE_VIEW_FLAG_SET (tree_view, BTK_TREE_VIEW_IS_LIST);
 
-  g_return_if_fail (path != NULL || iter != NULL);
+  btk_tree_view_search_index_rows_inserted (tree_view, path, iter, n_rows);
 
   if (tree_view->priv->fixed_height_mode
       && tree_view->priv->fixed_height >= 0)
@@ -8411,21 +8468,13 @@ btk_tree_view_row_inserted (BtkTreeModel *model,
   else
     height = 0;
 
-  if (path == NULL)
-    {
-      path = btk_tree_model_get_path (model, iter);
-      free_path = TRUE;
-    }
-  else if (iter == NULL)
-    btk_tree_model_get_iter (model, iter, path);
-
   if (tree_view->priv->tree == NULL)
     tree_view->priv->tree = _btk_rbtree_new ();
 
   tmptree = tree = tree_view->priv->tree;
 
   /* Update all row-references */
-  btk_tree_row_reference_inserted (B_OBJECT (data), path);
+  btk_tree_row_reference_rows_inserted (B_OBJECT (tree_view), path, n_rows);
   depth = btk_tree_path_get_depth (path);
   indices = btk_tree_path_get_indices (path);
 
@@ -8434,7 +8483,7 @@ btk_tree_view_row_inserted (BtkTreeModel *model,
     {
       if (tmptree == NULL)
 	{
-	  /* We aren't showing the node */
+	  /* We aren't showing the nodes */
 	  node_visible = FALSE;
           goto done;
 	}
@@ -8456,7 +8505,7 @@ btk_tree_view_row_inserted (BtkTreeModel *model,
 	  BtkTreePath *tmppath = _btk_tree_view_find_path (tree_view,
 							   tree,
 							   tmpnode);
-	  btk_tree_view_row_has_child_toggled (model, tmppath, NULL, data);
+	  btk_tree_view_row_has_child_toggled (model, tmppath, NULL, tree_view);
 	  btk_tree_path_free (tmppath);
           goto done;
 	}
@@ -8472,36 +8521,97 @@ btk_tree_view_row_inserted (BtkTreeModel *model,
       goto done;
     }
 
-  /* ref the node */
-  btk_tree_model_ref_node (tree_view->priv->model, iter);
-  if (indices[depth - 1] == 0)
+  /* An empty flat level can be filled without looking at the rows */
+  if (is_list && depth == 1 &&
+      tree->root == tree->nil &&
+      BTK_TREE_MODEL_GET_IFACE (model)->ref_node == NULL)
     {
-      tmpnode = _btk_rbtree_find_count (tree, 1);
-      tmpnode = _btk_rbtree_insert_before (tree, tmpnode, height, FALSE);
+      _btk_rbtree_populate (tree, n_rows, height, height > 0);
+      goto done;
     }
+
+  if (indices[depth - 1] == 0)
+    tmpnode = NULL;
   else
+    tmpnode = _btk_rbtree_find_count (tree, indices[depth - 1]);
+
+  child = *iter;
+  for (i = 0; i < n_rows; i++)
     {
-      tmpnode = _btk_rbtree_find_count (tree, indices[depth - 1]);
-      tmpnode = _btk_rbtree_insert_after (tree, tmpnode, height, FALSE);
+      btk_tree_model_ref_node (tree_view->priv->model, &child);
+
+      if (tmpnode == NULL)
+        tmpnode = _btk_rbtree_insert_before (tree,
+                                             _btk_rbtree_find_count (tree, 1),
+                                             height, height > 0);
+      else
+        tmpnode = _btk_rbtree_insert_after (tree, tmpnode,
+                                            height, height > 0);
+      last = tmpnode;
+
+      /* Unlike single insertions, ranges may come with children */
+      if (n_rows > 1 && !is_list && btk_tree_model_iter_has_child (model, &child))
+        BTK_RBNODE_SET_FLAG (tmpnode, BTK_RBNODE_IS_PARENT);
+
+      if (i + 1 < n_rows && !btk_tree_model_iter_next (model, &child))
+        break;
     }
 
  done:
   if (height > 0)
     {
-      if (tree)
-        _btk_rbtree_node_mark_valid (tree, tmpnode);
-
-      if (node_visible && node_is_visible (tree_view, tree, tmpnode))
-	btk_widget_queue_resize (BTK_WIDGET (tree_view));
-      else
+      /* A single row out of sight needs no redraw */
+      if (n_rows == 1 &&
+	  (!node_visible ||
+	   (last != NULL && !node_is_visible (tree_view, tree, last))))
 	btk_widget_queue_resize_no_redraw (BTK_WIDGET (tree_view));
+      else
+	btk_widget_queue_resize (BTK_WIDGET (tree_view));
     }
   else
     install_presize_handler (tree_view);
+}
+
+static void
+btk_tree_view_row_inserted (BtkTreeModel *model,
+			    BtkTreePath  *path,
+			    BtkTreeIter  *iter,
+			    bpointer      data)
+{
+  BtkTreeIter real_iter;
+  bboolean free_path = FALSE;
+
+  g_return_if_fail (path != NULL || iter != NULL);
+
+  if (path == NULL)
+    {
+      path = btk_tree_model_get_path (model, iter);
+      free_path = TRUE;
+    }
+  else if (iter == NULL)
+    {
+      btk_tree_model_get_iter (model, &real_iter, path);
+      iter = &real_iter;
+    }
+
+  btk_tree_view_insert_rows ((BtkTreeView *) data, model, path, iter, 1);
+
   if (free_path)
     btk_tree_path_free (path);
 }
 
+static void
+btk_tree_view_rows_inserted (BtkTreeModel *model,
+			     BtkTreePath  *path,
+			     BtkTreeIter  *iter,
+			     bint          n_rows,
+			     bpointer      data)
+{
+  g_return_if_fail (path != NULL && iter != NULL);
+
+  btk_tree_view_insert_rows ((BtkTreeView *) data, model, path, iter, n_rows);
+}
+
 static void
 btk_tree_view_row_has_child_toggled (BtkTreeModel *model,
 				     BtkTreePath  *path,
@@ -8614,6 +8724,8 @@ btk_tree_view_row_deleted (BtkTreeModel *model,
 
   btk_tree_row_reference_deleted (B_OBJECT (data), path);
 
+  btk_tree_view_search_index_row_deleted (tree_view, path);
+
   if (_btk_tree_view_find_node (tree_view, path, &tree, &node))
     return;
 
@@ -8694,6 +8806,11 @@ btk_tree_view_rows_reordered (BtkTreeModel *model,
 				    iter,
 				    new_order);
 
+  if (btk_tree_path_get_depth (parent) == 0)
+    btk_tree_view_search_index_reorder (tree_view, new_order);
+  else
+    btk_tree_view_search_index_free (tree_view);
+
   if (_btk_tree_view_find_node (tree_view,
 				parent,
 				&tree,
@@ -8848,6 +8965,25 @@ btk_tree_view_build_tree (BtkTreeView *tree_view,
   BtkTreePath *path = NULL;
   bboolean is_list = BTK_TREE_VIEW_FLAG_SET (tree_view, BTK_TREE_VIEW_IS_LIST);
 
+  /* A flat model that does not track node references has nothing to
+   * tell us per row, so the whole level can be created in one go
+   * instead of walking the model.
+   */
+  if (is_list && depth == 1 &&
+      tree->root == tree->nil &&
+      BTK_TREE_MODEL_GET_IFACE (tree_view->priv->model)->ref_node == NULL)
+    {
+      bint n_rows;
+
+      n_rows = btk_tree_model_iter_n_children (tree_view->priv->model, NULL);
+      if (tree_view->priv->fixed_height > 0)
+        _btk_rbtree_populate (tree, n_rows, tree_view->priv->fixed_height, TRUE);
+      else
+        _btk_rbtree_populate (tree, n_rows, 0, FALSE);
+
+      return;
+    }
+
   do
     {
       btk_tree_model_ref_node (tree_view->priv->model, iter);
@@ -10770,6 +10906,9 @@ btk_tree_view_set_model (BtkTreeView  *tree_view,
       g_signal_handlers_disconnect_by_func (tree_view->priv->model,
 					    btk_tree_view_row_inserted,
 					    tree_view);
+      g_signal_handlers_disconnect_by_func (tree_view->priv->model,
+					    btk_tree_view_rows_inserted,
+					    tree_view);
       g_signal_handlers_disconnect_by_func (tree_view->priv->model,
 					    btk_tree_view_row_has_child_toggled,
 					    tree_view);
@@ -10802,6 +10941,7 @@ btk_tree_view_set_model (BtkTreeView  *tree_view,
 
       g_object_unref (tree_view->priv->model);
 
+      btk_tree_view_search_index_free (tree_view);
       tree_view->priv->search_column = -1;
       tree_view->priv->fixed_height_check = 0;
       tree_view->priv->fixed_height = -1;
@@ -10815,6 +10955,7 @@ btk_tree_view_set_model (BtkTreeView  *tree_view,
   if (tree_view->priv->model)
     {
       bint i;
+      bulong inserted_id;
       BtkTreePath *path;
       BtkTreeIter iter;
       BtkTreeModelFlags flags;
@@ -10838,9 +10979,14 @@ btk_tree_view_set_model (BtkTreeView  *tree_view,
 			"row-changed",
 			G_CALLBACK (btk_tree_view_row_changed),
 			tree_view);
+      inserted_id = g_signal_connect (tree_view->priv->model,
+				      "row-inserted",
+				      G_CALLBACK (btk_tree_view_row_inserted),
+				      tree_view);
+      _btk_tree_model_add_range_handler (tree_view->priv->model, inserted_id);
       g_signal_connect (tree_view->priv->model,
-			"row-inserted",
-			G_CALLBACK (btk_tree_view_row_inserted),
+			"rows-inserted",
+			G_CALLBACK (btk_tree_view_rows_inserted),
 			tree_view);
       g_signal_connect (tree_view->priv->model,
 			"row-has-child-toggled",
@@ -13988,6 +14134,58 @@ btk_tree_view_get_enable_search (BtkTreeView *tree_view)
   return tree_view->priv->enable_search;
 }
 
+/**
+ * btk_tree_view_set_enable_search_index:
+ * @tree_view: A #BtkTreeView
+ * @enable_search_index: %TRUE to keep a search index
+ *
+ * If @enable_search_index is set, the interactive search looks rows up
+ * in a sorted index of the search column instead of comparing every row
+ * on each key press, and moving to the next or previous match no longer
+ * walks the model. The index is built the first time a search runs and
+ * is updated as rows change, get inserted, deleted or reordered.
+ *
+ * The index is only used for models with the %BTK_TREE_MODEL_LIST_ONLY
+ * flag and while the default search equal function is in use.
+ *
+ * Since: 2.24.34
+ */
+void
+btk_tree_view_set_enable_search_index (BtkTreeView *tree_view,
+				       bboolean     enable_search_index)
+{
+  g_return_if_fail (BTK_IS_TREE_VIEW (tree_view));
+
+  enable_search_index = !!enable_search_index;
+
+  if (tree_view->priv->enable_search_index != enable_search_index)
+    {
+      tree_view->priv->enable_search_index = enable_search_index;
+      if (!enable_search_index)
+	btk_tree_view_search_index_free (tree_view);
+      g_object_notify (B_OBJECT (tree_view), "enable-search-index");
+    }
+}
+
+/**
+ * btk_tree_view_get_enable_search_index:
+ * @tree_view: A #BtkTreeView
+ *
+ * Returns whether the interactive search uses a search index.
+ * See btk_tree_view_set_enable_search_index().
+ *
+ * Return value: %TRUE if the interactive search keeps an index
+ *
+ * Since: 2.24.34
+ */
+bboolean
+btk_tree_view_get_enable_search_index (BtkTreeView *tree_view)
+{
+  g_return_val_if_fail (BTK_IS_TREE_VIEW (tree_view), FALSE);
+
+  return tree_view->priv->enable_search_index;
+}
+
 
 /**
  * btk_tree_view_get_search_column:
@@ -14031,6 +14229,7 @@ btk_tree_view_set_search_column (BtkTreeView *tree_view,
     return;
 
   tree_view->priv->search_column = column;
+  btk_tree_view_search_index_free (tree_view);
   g_object_notify (B_OBJECT (tree_view), "search-column");
 }
 
@@ -14494,6 +14693,580 @@ btk_tree_view_search_key_press_event (BtkWidget *widget,
   return retval;
 }
 
+/* The search index keeps the casefolded search column keys of flat
+ * models sorted, so that a prefix lookup is a binary search instead of
+ * a walk over every row.  It is built on the first search and kept up
+ * to date as rows change, get inserted, deleted or reordered.
+ *
+ * The rows are kept in a sequence in view order, so a row is found by
+ * its number and its number by its position in O(log n), and rows
+ * around it can come and go without anything being renumbered.  The
+ * index and the matches of the last looked up text hold iters of that
+ * sequence; the index is ordered by key and then by view order, the
+ * matches by view order alone.
+ */
+typedef struct _BtkTreeViewSearchRow BtkTreeViewSearchRow;
+struct _BtkTreeViewSearchRow
+{
+  bchar         *key;
+  GSequenceIter *entry;
+  GSequenceIter *match;
+};
+
+/* Splits a sequence of row iters at the first one that is not before
+ * it, for g_sequence_search()
+ */
+typedef struct _BtkTreeViewSearchBound BtkTreeViewSearchBound;
+struct _BtkTreeViewSearchBound
+{
+  bboolean   (* before) (GSequenceIter                *row_iter,
+			 const BtkTreeViewSearchBound *bound);
+  const bchar *key;
+  bint         row;
+};
+
+#define SEARCH_INDEX_ROW(row_iter) ((BtkTreeViewSearchRow *) g_sequence_get (row_iter))
+
+static bchar *
+btk_tree_view_search_index_key (const bchar *str)
+{
+  bchar *normalized;
+  bchar *key;
+
+  normalized = g_utf8_normalize (str, -1, G_NORMALIZE_ALL);
+  if (!normalized)
+    return NULL;
+
+  key = g_utf8_casefold (normalized, -1);
+  g_free (normalized);
+
+  return key;
+}
+
+static void
+btk_tree_view_search_row_free (bpointer data)
+{
+  BtkTreeViewSearchRow *row = data;
+
+  g_free (row->key);
+  g_slice_free (BtkTreeViewSearchRow, row);
+}
+
+static bint
+btk_tree_view_search_row_compare (gconstpointer a,
+				  gconstpointer b,
+				  bpointer      user_data)
+{
+  return g_sequence_iter_compare ((GSequenceIter *) a, (GSequenceIter *) b);
+}
+
+static bint
+btk_tree_view_search_entry_compare (gconstpointer a,
+				    gconstpointer b,
+				    bpointer      user_data)
+{
+  bint retval;
+
+  retval = strcmp (SEARCH_INDEX_ROW ((GSequenceIter *) a)->key,
+		   SEARCH_INDEX_ROW ((GSequenceIter *) b)->key);
+  if (retval == 0)
+    retval = btk_tree_view_search_row_compare (a, b, NULL);
+
+  return retval;
+}
+
+static bint
+btk_tree_view_search_bound_compare (gconstpointer a,
+				    gconstpointer b,
+				    bpointer      user_data)
+{
+  const BtkTreeViewSearchBound *bound = user_data;
+
+  if (a == bound)
+    return -btk_tree_view_search_bound_compare (b, a, user_data);
+
+  return bound->before ((GSequenceIter *) a, bound) ? -1 : 1;
+}
+
+static bboolean
+btk_tree_view_search_key_before (GSequenceIter                *row_iter,
+				 const BtkTreeViewSearchBound *bound)
+{
+  return strcmp (SEARCH_INDEX_ROW (row_iter)->key, bound->key) < 0;
+}
+
+/* Keys with the prefix sort directly after the ones before it */
+static bboolean
+btk_tree_view_search_prefix_before (GSequenceIter                *row_iter,
+				    const BtkTreeViewSearchBound *bound)
+{
+  return btk_tree_view_search_key_before (row_iter, bound) ||
+         g_str_has_prefix (SEARCH_INDEX_ROW (row_iter)->key, bound->key);
+}
+
+static bboolean
+btk_tree_view_search_row_before (GSequenceIter                *row_iter,
+				 const BtkTreeViewSearchBound *bound)
+{
+  return g_sequence_iter_get_position (row_iter) < bound->row;
+}
+
+static bboolean
+btk_tree_view_search_row_not_after (GSequenceIter                *row_iter,
+				    const BtkTreeViewSearchBound *bound)
+{
+  return g_sequence_iter_get_position (row_iter) <= bound->row;
+}
+
+/* Returns the first iter of @seq that is not before @bound */
+static GSequenceIter *
+btk_tree_view_search_index_bound (GSequence              *seq,
+				  BtkTreeViewSearchBound *bound)
+{
+  return g_sequence_search (seq, bound,
+			    btk_tree_view_search_bound_compare, bound);
+}
+
+static bboolean
+btk_tree_view_search_index_usable (BtkTreeView *tree_view)
+{
+  BtkTreeViewPrivate *priv = tree_view->priv;
+
+  /* The index reproduces btk_tree_view_search_equal_func(), so custom
+   * compare functions always get the linear walk.
+   */
+  return priv->enable_search_index &&
+         priv->model != NULL &&
+         priv->search_column >= 0 &&
+         priv->search_equal_func == btk_tree_view_search_equal_func &&
+         (btk_tree_model_get_flags (priv->model) & BTK_TREE_MODEL_LIST_ONLY) != 0;
+}
+
+/* Returns the newly allocated key of the row at @iter, or %NULL if its
+ * search column has no text.
+ */
+static bchar *
+btk_tree_view_search_index_row_key (BtkTreeView *tree_view,
+				    BtkTreeIter *iter)
+{
+  BValue value = {0,};
+  BValue transformed = {0,};
+  bchar *key = NULL;
+
+  btk_tree_model_get_value (tree_view->priv->model, iter,
+			    tree_view->priv->search_column, &value);
+  b_value_init (&transformed, B_TYPE_STRING);
+
+  if (b_value_transform (&value, &transformed) &&
+      b_value_get_string (&transformed) != NULL)
+    key = btk_tree_view_search_index_key (b_value_get_string (&transformed));
+
+  b_value_unset (&transformed);
+  b_value_unset (&value);
+
+  return key;
+}
+
+/* Enters the row at @row_iter, which has its key, in the index and
+ * in the matches.
+ */
+static void
+btk_tree_view_search_index_add_row (BtkTreeView   *tree_view,
+				    GSequenceIter *row_iter)
+{
+  BtkTreeViewSearchRow *row = SEARCH_INDEX_ROW (row_iter);
+
+  if (row->key == NULL)
+    return;
+
+  row->entry = g_sequence_insert_sorted (tree_view->priv->search_index, row_iter,
+					 btk_tree_view_search_entry_compare, NULL);
+
+  if (tree_view->priv->search_index_matches &&
+      g_str_has_prefix (row->key, tree_view->priv->search_index_matches_key))
+    row->match = g_sequence_insert_sorted (tree_view->priv->search_index_matches, row_iter,
+					   btk_tree_view_search_row_compare, NULL);
+}
+
+static void
+btk_tree_view_search_index_remove_row (BtkTreeView   *tree_view,
+				       GSequenceIter *row_iter)
+{
+  BtkTreeViewSearchRow *row = SEARCH_INDEX_ROW (row_iter);
+
+  if (row->entry)
+    g_sequence_remove (row->entry);
+  if (row->match)
+    g_sequence_remove (row->match);
+
+  row->entry = NULL;
+  row->match = NULL;
+}
+
+/* Returns the iter of the row at @path, or with @allow_end the end
+ * iter just after the last row, or %NULL if the index has no such row.
+ */
+static GSequenceIter *
+btk_tree_view_search_index_get_row (BtkTreeView *tree_view,
+				    BtkTreePath *path,
+				    bboolean     allow_end)
+{
+  GSequence *rows = tree_view->priv->search_index_rows;
+  bint row;
+
+  if (path == NULL || btk_tree_path_get_depth (path) != 1)
+    return NULL;
+
+  row = btk_tree_path_get_indices (path)[0];
+  if (row < 0 || row > g_sequence_get_length (rows) ||
+      (row == g_sequence_get_length (rows) && !allow_end))
+    return NULL;
+
+  return g_sequence_get_iter_at_pos (rows, row);
+}
+
+static void
+btk_tree_view_search_index_build (BtkTreeView *tree_view)
+{
+  BtkTreeModel *model = tree_view->priv->model;
+  GSequence *index;
+  GSequence *rows;
+  BtkTreeIter iter;
+
+  index = g_sequence_new (NULL);
+  rows = g_sequence_new (btk_tree_view_search_row_free);
+
+  tree_view->priv->search_index = index;
+  tree_view->priv->search_index_rows = rows;
+
+  if (!btk_tree_model_get_iter_first (model, &iter))
+    return;
+
+  do
+    {
+      BtkTreeViewSearchRow *row;
+      GSequenceIter *row_iter;
+
+      row = g_slice_new0 (BtkTreeViewSearchRow);
+      row->key = btk_tree_view_search_index_row_key (tree_view, &iter);
+
+      row_iter = g_sequence_append (rows, row);
+      if (row->key)
+	row->entry = g_sequence_append (index, row_iter);
+    }
+  while (btk_tree_model_iter_next (model, &iter));
+
+  /* sorting keeps the iters, so the rows still point at their entries */
+  g_sequence_sort (index, btk_tree_view_search_entry_compare, NULL);
+}
+
+static void
+btk_tree_view_search_index_free_matches (BtkTreeView *tree_view)
+{
+  GSequenceIter *iter;
+
+  if (tree_view->priv->search_index_matches == NULL)
+    return;
+
+  for (iter = g_sequence_get_begin_iter (tree_view->priv->search_index_matches);
+       !g_sequence_iter_is_end (iter);
+       iter = g_sequence_iter_next (iter))
+    SEARCH_INDEX_ROW (g_sequence_get (iter))->match = NULL;
+
+  g_sequence_free (tree_view->priv->search_index_matches);
+  g_free (tree_view->priv->search_index_matches_key);
+  tree_view->priv->search_index_matches = NULL;
+  tree_view->priv->search_index_matches_key = NULL;
+}
+
+static void
+btk_tree_view_search_index_free (BtkTreeView *tree_view)
+{
+  if (tree_view->priv->search_index == NULL)
+    return;
+
+  btk_tree_view_search_index_free_matches (tree_view);
+
+  g_sequence_free (tree_view->priv->search_index);
+  g_sequence_free (tree_view->priv->search_index_rows);
+  tree_view->priv->search_index = NULL;
+  tree_view->priv->search_index_rows = NULL;
+}
+
+static void
+btk_tree_view_search_index_reorder (BtkTreeView *tree_view,
+				    bint        *new_order)
+{
+  GSequence *rows = tree_view->priv->search_index_rows;
+  GSequenceIter **row_iters;
+  GSequenceIter *iter;
+  bint n_rows, i;
+
+  if (tree_view->priv->search_index == NULL)
+    return;
+
+  n_rows = g_sequence_get_length (rows);
+  row_iters = g_new (GSequenceIter *, n_rows);
+
+  for (i = 0, iter = g_sequence_get_begin_iter (rows);
+       !g_sequence_iter_is_end (iter);
+       i++, iter = g_sequence_iter_next (iter))
+    row_iters[i] = iter;
+
+  /* moving keeps the iters the index and the matches hold */
+  for (i = 0; i < n_rows; i++)
+    g_sequence_move (row_iters[new_order[i]], g_sequence_get_end_iter (rows));
+
+  /* rows sharing a key have to be back in view order */
+  g_sequence_sort (tree_view->priv->search_index,
+		   btk_tree_view_search_entry_compare, NULL);
+  if (tree_view->priv->search_index_matches)
+    g_sequence_sort (tree_view->priv->search_index_matches,
+		     btk_tree_view_search_row_compare, NULL);
+
+  g_free (row_iters);
+}
+
+static void
+btk_tree_view_search_index_row_changed (BtkTreeView *tree_view,
+					BtkTreePath *path,
+					BtkTreeIter *iter)
+{
+  BtkTreeViewSearchRow *row;
+  GSequenceIter *row_iter;
+  BtkTreeIter real_iter;
+
+  if (tree_view->priv->search_index == NULL)
+    return;
+
+  row_iter = btk_tree_view_search_index_get_row (tree_view, path, FALSE);
+  if (row_iter == NULL)
+    {
+      btk_tree_view_search_index_free (tree_view);
+      return;
+    }
+
+  if (iter == NULL)
+    {
+      if (!btk_tree_model_get_iter (tree_view->priv->model, &real_iter, path))
+	return;
+      iter = &real_iter;
+    }
+
+  btk_tree_view_search_index_remove_row (tree_view, row_iter);
+
+  row = SEARCH_INDEX_ROW (row_iter);
+  g_free (row->key);
+  row->key = btk_tree_view_search_index_row_key (tree_view, iter);
+
+  btk_tree_view_search_index_add_row (tree_view, row_iter);
+}
+
+static void
+btk_tree_view_search_index_rows_inserted (BtkTreeView *tree_view,
+					  BtkTreePath *path,
+					  BtkTreeIter *iter,
+					  bint         n_rows)
+{
+  GSequenceIter *before;
+  BtkTreeIter real_iter;
+  bboolean valid;
+  bint i;
+
+  if (tree_view->priv->search_index == NULL)
+    return;
+
+  before = btk_tree_view_search_index_get_row (tree_view, path, TRUE);
+  if (before == NULL)
+    {
+      btk_tree_view_search_index_free (tree_view);
+      return;
+    }
+
+  /* the iter is walked over the new rows */
+  if (iter)
+    real_iter = *iter;
+  else if (!btk_tree_model_get_iter (tree_view->priv->model, &real_iter, path))
+    {
+      btk_tree_view_search_index_free (tree_view);
+      return;
+    }
+
+  valid = TRUE;
+  for (i = 0; i < n_rows; i++)
+    {
+      BtkTreeViewSearchRow *row;
+
+      if (i > 0 && valid)
+	valid = btk_tree_model_iter_next (tree_view->priv->model, &real_iter);
+
+      row = g_slice_new0 (BtkTreeViewSearchRow);
+      if (valid)
+	row->key = btk_tree_view_search_index_row_key (tree_view, &real_iter);
+
+      btk_tree_view_search_index_add_row (tree_view,
+					  g_sequence_insert_before (before, row));
+    }
+}
+
+static void
+btk_tree_view_search_index_row_deleted (BtkTreeView *tree_view,
+					BtkTreePath *path)
+{
+  GSequenceIter *row_iter;
+
+  if (tree_view->priv->search_index == NULL)
+    return;
+
+  row_iter = btk_tree_view_search_index_get_row (tree_view, path, FALSE);
+  if (row_iter == NULL)
+    {
+      btk_tree_view_search_index_free (tree_view);
+      return;
+    }
+
+  btk_tree_view_search_index_remove_row (tree_view, row_iter);
+  g_sequence_remove (row_iter);
+}
+
+/* Collects the rows whose key has @text as a prefix into the matches,
+ * unless they are there already, and returns whether there are any.
+ */
+static bboolean
+btk_tree_view_search_index_lookup (BtkTreeView *tree_view,
+				   const bchar *text)
+{
+  BtkTreeViewSearchBound bound;
+  GSequenceIter *iter, *end;
+  GSequence *matches;
+  bchar *key;
+
+  if (tree_view->priv->search_index == NULL)
+    btk_tree_view_search_index_build (tree_view);
+
+  key = btk_tree_view_search_index_key (text);
+  if (!key)
+    return FALSE;
+
+  matches = tree_view->priv->search_index_matches;
+
+  if (matches && strcmp (key, tree_view->priv->search_index_matches_key) == 0)
+    g_free (key);
+  else if (matches && g_str_has_prefix (key, tree_view->priv->search_index_matches_key))
+    {
+      /* Typing on only drops matches */
+      g_free (tree_view->priv->search_index_matches_key);
+      tree_view->priv->search_index_matches_key = key;
+
+      iter = g_sequence_get_begin_iter (matches);
+      while (!g_sequence_iter_is_end (iter))
+	{
+	  BtkTreeViewSearchRow *row = SEARCH_INDEX_ROW (g_sequence_get (iter));
+
+	  iter = g_sequence_iter_next (iter);
+	  if (!g_str_has_prefix (row->key, key))
+	    {
+	      g_sequence_remove (row->match);
+	      row->match = NULL;
+	    }
+	}
+    }
+  else
+    {
+      btk_tree_view_search_index_free_matches (tree_view);
+
+      matches = g_sequence_new (NULL);
+      tree_view->priv->search_index_matches = matches;
+      tree_view->priv->search_index_matches_key = key;
+
+      bound.key = key;
+      bound.before = btk_tree_view_search_key_before;
+      iter = btk_tree_view_search_index_bound (tree_view->priv->search_index, &bound);
+      bound.before = btk_tree_view_search_prefix_before;
+      end = btk_tree_view_search_index_bound (tree_view->priv->search_index, &bound);
+
+      for (; iter != end; iter = g_sequence_iter_next (iter))
+	SEARCH_INDEX_ROW (g_sequence_get (iter))->match =
+	  g_sequence_append (matches, g_sequence_get (iter));
+
+      g_sequence_sort (matches, btk_tree_view_search_row_compare, NULL);
+    }
+
+  return g_sequence_get_length (matches) > 0;
+}
+
+/* Returns the first match after @row, or the last one before it if
+ * @up is %TRUE, or -1 if there is none.
+ */
+static bint
+btk_tree_view_search_index_pick (BtkTreeView *tree_view,
+				 bint         row,
+				 bboolean     up)
+{
+  BtkTreeViewSearchBound bound;
+  GSequenceIter *iter;
+
+  bound.key = NULL;
+  bound.row = row;
+
+  if (up)
+    {
+      bound.before = btk_tree_view_search_row_before;
+      iter = btk_tree_view_search_index_bound (tree_view->priv->search_index_matches, &bound);
+      if (g_sequence_iter_is_begin (iter))
+	return -1;
+      iter = g_sequence_iter_prev (iter);
+    }
+  else
+    {
+      bound.before = btk_tree_view_search_row_not_after;
+      iter = btk_tree_view_search_index_bound (tree_view->priv->search_index_matches, &bound);
+      if (g_sequence_iter_is_end (iter))
+	return -1;
+    }
+
+  return g_sequence_iter_get_position (g_sequence_get (iter));
+}
+
+static void
+btk_tree_view_search_index_select (BtkTreeView      *tree_view,
+				   BtkTreeSelection *selection,
+				   bint              row)
+{
+  BtkTreePath *path;
+  BtkTreeIter iter;
+
+  path = btk_tree_path_new_from_indices (row, -1);
+
+  if (btk_tree_model_get_iter (tree_view->priv->model, &iter, path))
+    {
+      btk_tree_view_scroll_to_cell (tree_view, path, NULL,
+				    TRUE, 0.5, 0.0);
+      btk_tree_selection_select_iter (selection, &iter);
+      btk_tree_view_real_set_cursor (tree_view, path, FALSE, TRUE);
+    }
+
+  btk_tree_path_free (path);
+}
+
+static bint
+btk_tree_view_search_index_cursor_row (BtkTreeView *tree_view)
+{
+  BtkTreePath *path = NULL;
+  bint row = -1;
+
+  if (tree_view->priv->cursor)
+    path = btk_tree_row_reference_get_path (tree_view->priv->cursor);
+
+  if (path)
+    {
+      row = btk_tree_path_get_indices (path)[0];
+      btk_tree_path_free (path);
+    }
+
+  return row;
+}
+
 /*  this function returns FALSE if there is a search string but
  *  nothing was found, and TRUE otherwise.
  */
@@ -14527,6 +15300,25 @@ btk_tree_view_search_move (BtkWidget   *window,
   model = btk_tree_view_get_model (tree_view);
   selection = btk_tree_view_get_selection (tree_view);
 
+  if (btk_tree_view_search_index_usable (tree_view))
+    {
+      bint row;
+
+      if (!btk_tree_view_search_index_lookup (tree_view, text))
+	return FALSE;
+
+      row = btk_tree_view_search_index_pick (tree_view,
+					     btk_tree_view_search_index_cursor_row (tree_view),
+					     up);
+      if (row < 0)
+	return FALSE;
+
+      btk_tree_selection_unselect_all (selection);
+      btk_tree_view_search_index_select (tree_view, selection, row);
+      tree_view->priv->selected_iter += up?(-1):(1);
+      return TRUE;
+    }
+
   /* search */
   btk_tree_selection_unselect_all (selection);
   if (!btk_tree_model_get_iter_first (model, &iter))
@@ -14751,6 +15543,17 @@ btk_tree_view_search_init (BtkWidget   *entry,
   if (*text == '\0')
     return;
 
+  if (btk_tree_view_search_index_usable (tree_view))
+    {
+      if (btk_tree_view_search_index_lookup (tree_view, text))
+	{
+	  btk_tree_view_search_index_select (tree_view, selection,
+					     btk_tree_view_search_index_pick (tree_view, -1, FALSE));
+	  tree_view->priv->selected_iter = 1;
+	}
+      return;
+    }
+
   if (!btk_tree_model_get_iter_first (model, &iter))
     return;
 
@@ -310,6 +310,9 @@ BdkPixmap             *btk_tree_view_create_row_drag_icon          (BtkTreeView
 void                       btk_tree_view_set_enable_search     (BtkTreeView                *tree_view,
 								bboolean                    enable_search);
 bboolean                   btk_tree_view_get_enable_search     (BtkTreeView                *tree_view);
+void                       btk_tree_view_set_enable_search_index (BtkTreeView              *tree_view,
+								  bboolean                  enable_search_index);
+bboolean                   btk_tree_view_get_enable_search_index (BtkTreeView              *tree_view);
 bint                       btk_tree_view_get_search_column     (BtkTreeView                *tree_view);
 void                       btk_tree_view_set_search_column     (BtkTreeView                *tree_view,
 								bint                        column);
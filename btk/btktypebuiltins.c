@@ -1834,6 +1834,7 @@ btk_text_search_flags_get_type (void)
         static const GFlagsValue values[] = {
             { BTK_TEXT_SEARCH_VISIBLE_ONLY, "BTK_TEXT_SEARCH_VISIBLE_ONLY", "visible-only" },
             { BTK_TEXT_SEARCH_TEXT_ONLY, "BTK_TEXT_SEARCH_TEXT_ONLY", "text-only" },
+            { BTK_TEXT_SEARCH_CASE_INSENSITIVE, "BTK_TEXT_SEARCH_CASE_INSENSITIVE", "case-insensitive" },
             { 0, NULL, NULL }
         };
         etype = g_flags_register_static (g_intern_static_string ("BtkTextSearchFlags"), values);
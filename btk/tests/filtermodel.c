@@ -1869,6 +1869,150 @@ specific_path_dependent_filter (void)
 }
 
 
+static void
+specific_sort_many_changes_check (BtkTreeModel *sort,
+                                  bint          n_rows)
+{
+  BtkTreeIter iter;
+  bint i, value, prev = -1;
+
+  g_assert_cmpint (btk_tree_model_iter_n_children (sort, NULL), ==, n_rows);
+
+  for (i = 0; i < n_rows; i++)
+    {
+      g_assert (btk_tree_model_iter_nth_child (sort, &iter, NULL, i));
+      btk_tree_model_get (sort, &iter, 0, &value, -1);
+      g_assert_cmpint (prev, <, value);
+      prev = value;
+    }
+}
+
+static void
+specific_sort_many_changes_reordered (BtkTreeModel *model,
+                                      BtkTreePath  *path,
+                                      BtkTreeIter  *iter,
+                                      bint         *new_order,
+                                      bpointer      data)
+{
+  (* (bint *) data)++;
+}
+
+static void
+specific_sort_many_changes (void)
+{
+  /* Changing more rows than the sort model moves one by one in a
+   * single main loop iteration must still end up sorted.
+   */
+  int i;
+  bint n_reordered = 0;
+  BtkTreeIter iter;
+  BtkListStore *list;
+  BtkTreeModel *sort;
+
+  list = btk_list_store_new (1, B_TYPE_INT);
+  for (i = 0; i < 100; i++)
+    btk_list_store_insert_with_values (list, &iter, i, 0, i, -1);
+
+  sort = btk_tree_model_sort_new_with_model (BTK_TREE_MODEL (list));
+  btk_tree_sortable_set_sort_column_id (BTK_TREE_SORTABLE (sort), 0,
+                                        BTK_SORT_ASCENDING);
+
+  /* reverse the order of the rows */
+  for (i = 0; i < 100; i++)
+    {
+      btk_tree_model_iter_nth_child (BTK_TREE_MODEL (list), &iter, NULL, i);
+      btk_list_store_set (list, &iter, 0, 1000 - i, -1);
+    }
+
+  g_assert_cmpint (btk_tree_model_iter_n_children (sort, NULL), ==, 100);
+
+  /* a row inserted before the deferred sort has run must still end up
+   * in its place; lookups until then must not reorder the rows
+   */
+  btk_list_store_insert_with_values (list, &iter, 0, 0, 950, -1);
+
+  g_signal_connect (sort, "rows-reordered",
+                    G_CALLBACK (specific_sort_many_changes_reordered),
+                    &n_reordered);
+
+  g_assert_cmpint (btk_tree_model_iter_n_children (sort, NULL), ==, 101);
+  for (i = 0; i < 101; i++)
+    g_assert (btk_tree_model_iter_nth_child (sort, &iter, NULL, i));
+  g_assert_cmpint (n_reordered, ==, 0);
+
+  while (btk_events_pending ())
+    btk_main_iteration ();
+
+  g_assert_cmpint (n_reordered, >, 0);
+  specific_sort_many_changes_check (sort, 101);
+
+  g_object_unref (sort);
+  g_object_unref (list);
+}
+
+static bboolean
+specific_refilter_async_visible_func (BtkTreeModel *model,
+                                      BtkTreeIter  *iter,
+                                      bpointer      data)
+{
+  bint value;
+
+  btk_tree_model_get (model, iter, 0, &value, -1);
+
+  return value < *(bint *) data;
+}
+
+static void
+specific_refilter_async (void)
+{
+  int i;
+  bint limit = 5000;
+  BtkTreeIter iter;
+  BtkListStore *list;
+  BtkTreeModel *filter;
+
+  list = btk_list_store_new (1, B_TYPE_INT);
+  for (i = 0; i < 5000; i++)
+    btk_list_store_insert_with_values (list, &iter, i, 0, i, -1);
+
+  filter = btk_tree_model_filter_new (BTK_TREE_MODEL (list), NULL);
+  btk_tree_model_filter_set_visible_func (BTK_TREE_MODEL_FILTER (filter),
+                                          specific_refilter_async_visible_func,
+                                          &limit, NULL);
+
+  g_assert_cmpint (btk_tree_model_iter_n_children (filter, NULL), ==, 5000);
+
+  /* a second request replaces the first one */
+  limit = 100;
+  btk_tree_model_filter_refilter_async (BTK_TREE_MODEL_FILTER (filter));
+  limit = 10;
+  btk_tree_model_filter_refilter_async (BTK_TREE_MODEL_FILTER (filter));
+
+  /* rows removed while refiltering don't confuse it */
+  btk_tree_model_iter_nth_child (BTK_TREE_MODEL (list), &iter, NULL, 0);
+  btk_list_store_remove (list, &iter);
+
+  while (btk_events_pending ())
+    btk_main_iteration ();
+
+  /* values 1 up to 9 are left */
+  g_assert_cmpint (btk_tree_model_iter_n_children (filter, NULL), ==, 9);
+
+  /* a synchronous refilter cancels a pending one */
+  limit = 1000;
+  btk_tree_model_filter_refilter_async (BTK_TREE_MODEL_FILTER (filter));
+  limit = 20;
+  btk_tree_model_filter_refilter (BTK_TREE_MODEL_FILTER (filter));
+
+  while (btk_events_pending ())
+    btk_main_iteration ();
+
+  g_assert_cmpint (btk_tree_model_iter_n_children (filter, NULL), ==, 19);
+
+  g_object_unref (filter);
+  g_object_unref (list);
+}
+
 static bboolean
 specific_append_after_collapse_visible_func (BtkTreeModel *model,
                                              BtkTreeIter  *iter,
@@ -2962,6 +3106,10 @@ main (int    argc,
 
   g_test_add_func ("/FilterModel/specific/path-dependent-filter",
                    specific_path_dependent_filter);
+  g_test_add_func ("/FilterModel/specific/sort-many-changes",
+                   specific_sort_many_changes);
+  g_test_add_func ("/FilterModel/specific/refilter-async",
+                   specific_refilter_async);
   g_test_add_func ("/FilterModel/specific/append-after-collapse",
                    specific_append_after_collapse);
   g_test_add_func ("/FilterModel/specific/sort-filter-remove-node",
@@ -0,0 +1,278 @@
+/* Basic BtkIconView unit tests.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <btk/btk.h>
+
+#define N_ITEMS 2000
+
+/* Fails instead of hanging if layouts keep queueing each other */
+static void
+flush_events (void)
+{
+  bint i;
+
+  for (i = 0; i < 1000 && btk_events_pending (); i++)
+    btk_main_iteration ();
+
+  g_assert (!btk_events_pending ());
+}
+
+static BtkWidget *
+create_big_icon_view (BtkWidget **window)
+{
+  BtkListStore *store;
+  BtkWidget *sw;
+  BtkWidget *view;
+  bint i;
+
+  store = btk_list_store_new (1, B_TYPE_STRING);
+  for (i = 0; i < N_ITEMS; i++)
+    {
+      bchar *text;
+
+      /* Some wide items far down, so columns have to grow once
+       * they are measured.
+       */
+      if (i % 250 == 249)
+        text = g_strdup_printf ("A much wider item number %d", i);
+      else
+        text = g_strdup_printf ("Item %d", i);
+      btk_list_store_insert_with_values (store, NULL, i, 0, text, -1);
+      g_free (text);
+    }
+
+  view = btk_icon_view_new_with_model (BTK_TREE_MODEL (store));
+  btk_icon_view_set_text_column (BTK_ICON_VIEW (view), 0);
+  g_object_unref (store);
+
+  sw = btk_scrolled_window_new (NULL, NULL);
+  btk_container_add (BTK_CONTAINER (sw), view);
+
+  *window = btk_window_new (BTK_WINDOW_TOPLEVEL);
+  btk_window_set_default_size (BTK_WINDOW (*window), 300, 200);
+  btk_container_add (BTK_CONTAINER (*window), sw);
+  btk_widget_show_all (*window);
+
+  flush_events ();
+
+  return view;
+}
+
+static bint
+index_at (BtkIconView *view,
+          bint         x,
+          bint         y)
+{
+  BtkTreePath *path;
+  bint index;
+
+  path = btk_icon_view_get_path_at_pos (view, x, y);
+  if (!path)
+    return -1;
+
+  index = btk_tree_path_get_indices (path)[0];
+  btk_tree_path_free (path);
+
+  return index;
+}
+
+static void
+test_estimated_cells (void)
+{
+  BtkWidget *window;
+  BtkWidget *view;
+  BtkAdjustment *vadj;
+  BtkTreePath *path;
+  BtkCellRenderer *cell;
+  bint y;
+
+  view = create_big_icon_view (&window);
+  vadj = btk_scrolled_window_get_vadjustment (BTK_SCROLLED_WINDOW (btk_widget_get_parent (view)));
+
+  /* The last items are far out of view, so they are estimated;
+   * their cells still have to be found.
+   */
+  y = vadj->upper - 20;
+  g_assert (btk_icon_view_get_item_at_pos (BTK_ICON_VIEW (view), 20, y,
+                                           &path, &cell));
+  g_assert (path != NULL);
+  g_assert (cell != NULL);
+  g_assert_cmpint (btk_tree_path_get_indices (path)[0], >, N_ITEMS / 2);
+  btk_tree_path_free (path);
+
+  btk_widget_destroy (window);
+}
+
+static void
+test_remeasure_keeps_anchor (void)
+{
+  BtkWidget *window;
+  BtkWidget *view;
+  BtkAdjustment *vadj;
+  bint value;
+  bint before, after;
+
+  view = create_big_icon_view (&window);
+  vadj = btk_scrolled_window_get_vadjustment (BTK_SCROLLED_WINDOW (btk_widget_get_parent (view)));
+
+  /* Jump into the estimated part; the remeasure runs later and has
+   * to keep the item that was at the top of the view there.
+   */
+  value = (vadj->upper - vadj->page_size) / 2;
+  btk_adjustment_set_value (vadj, value);
+  before = index_at (BTK_ICON_VIEW (view), 20, value + 20);
+  g_assert_cmpint (before, >=, 0);
+
+  flush_events ();
+
+  after = index_at (BTK_ICON_VIEW (view), 20, vadj->value + 20);
+  g_assert_cmpint (after, ==, before);
+
+  btk_widget_destroy (window);
+}
+
+static void
+test_scroll_through (void)
+{
+  BtkWidget *window;
+  BtkWidget *view;
+  BtkAdjustment *vadj;
+  BtkTreePath *start, *end;
+  bint first = 0;
+
+  view = create_big_icon_view (&window);
+  vadj = btk_scrolled_window_get_vadjustment (BTK_SCROLLED_WINDOW (btk_widget_get_parent (view)));
+
+  /* Each step only measures the rows around the view; the items
+   * have to stay in order on the way down.
+   */
+  while (vadj->value < vadj->upper - vadj->page_size)
+    {
+      btk_adjustment_set_value (vadj, MIN (vadj->value + vadj->page_size / 2,
+                                           vadj->upper - vadj->page_size));
+      flush_events ();
+
+      g_assert (btk_icon_view_get_visible_range (BTK_ICON_VIEW (view), &start, &end));
+      g_assert_cmpint (btk_tree_path_get_indices (start)[0], >=, first);
+      g_assert_cmpint (btk_tree_path_get_indices (end)[0], >=,
+                       btk_tree_path_get_indices (start)[0]);
+      first = btk_tree_path_get_indices (start)[0];
+      btk_tree_path_free (start);
+      btk_tree_path_free (end);
+    }
+
+  g_assert_cmpint (first, >, N_ITEMS / 2);
+
+  btk_widget_destroy (window);
+}
+
+static void
+assert_last_visible (BtkIconView *view,
+                     bint         last)
+{
+  BtkAdjustment *vadj;
+  BtkTreePath *start, *end;
+
+  vadj = btk_scrolled_window_get_vadjustment (BTK_SCROLLED_WINDOW (btk_widget_get_parent (BTK_WIDGET (view))));
+  btk_adjustment_set_value (vadj, vadj->upper - vadj->page_size);
+  flush_events ();
+
+  g_assert (btk_icon_view_get_visible_range (view, &start, &end));
+  g_assert_cmpint (btk_tree_path_get_indices (end)[0], ==, last);
+  btk_tree_path_free (start);
+  btk_tree_path_free (end);
+}
+
+
+static void
+test_estimated_layout (void)
+{
+  BtkWidget *window;
+  BtkWidget *view;
+  BtkListStore *store;
+  BtkTreeIter iter;
+  bint n;
+
+  view = create_big_icon_view (&window);
+  store = BTK_LIST_STORE (btk_icon_view_get_model (BTK_ICON_VIEW (view)));
+
+  /* The estimated part of the layout still has room for every item */
+  assert_last_visible (BTK_ICON_VIEW (view), N_ITEMS - 1);
+
+  /* Drop below the size that is laid out lazily */
+  for (n = N_ITEMS; n > 400; n--)
+    {
+      btk_tree_model_iter_nth_child (BTK_TREE_MODEL (store), &iter, NULL, 0);
+      btk_list_store_remove (store, &iter);
+    }
+  flush_events ();
+
+  assert_last_visible (BTK_ICON_VIEW (view), 399);
+
+  btk_widget_destroy (window);
+}
+
+static void
+test_fixed_cells (void)
+{
+  BtkWidget *window;
+  BtkWidget *view;
+  BtkAdjustment *vadj;
+  BtkTreePath *path;
+  BtkCellRenderer *cell;
+  bint y;
+
+  view = create_big_icon_view (&window);
+  vadj = btk_scrolled_window_get_vadjustment (BTK_SCROLLED_WINDOW (btk_widget_get_parent (view)));
+
+  btk_icon_view_set_fixed_size_mode (BTK_ICON_VIEW (view), TRUE);
+  flush_events ();
+
+  /* The cells of items that were never drawn are placed when they
+   * are looked at.
+   */
+  y = vadj->upper - 20;
+  g_assert (btk_icon_view_get_item_at_pos (BTK_ICON_VIEW (view), 20, y,
+                                           &path, &cell));
+  g_assert (path != NULL);
+  g_assert (cell != NULL);
+  g_assert_cmpint (btk_tree_path_get_indices (path)[0], >, N_ITEMS / 2);
+  btk_tree_path_free (path);
+
+  btk_widget_destroy (window);
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  btk_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/IconView/lazy/estimated-cells",
+                   test_estimated_cells);
+  g_test_add_func ("/IconView/lazy/remeasure-keeps-anchor",
+                   test_remeasure_keeps_anchor);
+  g_test_add_func ("/IconView/lazy/scroll-through",
+                   test_scroll_through);
+  g_test_add_func ("/IconView/lazy/estimated-layout",
+                   test_estimated_layout);
+  g_test_add_func ("/IconView/fixed/cells",
+                   test_fixed_cells);
+
+  return g_test_run ();
+}
@@ -389,6 +389,279 @@ list_store_test_insert_before_NULL (void)
   g_object_unref (store);
 }
 
+static void
+count_row_inserted (BtkTreeModel *model,
+                    BtkTreePath  *path,
+                    BtkTreeIter  *iter,
+                    bint         *count)
+{
+  (*count)++;
+}
+
+static void
+count_rows_inserted (BtkTreeModel *model,
+                     BtkTreePath  *path,
+                     BtkTreeIter  *iter,
+                     bint          n_rows,
+                     bint         *count)
+{
+  g_assert (btk_tree_path_get_indices (path)[0] == 2);
+  (*count) += n_rows;
+}
+
+static void
+insert_rows (BtkListStore *store,
+             bint          position,
+             bint          first,
+             bint          n_rows)
+{
+  bint column = 0;
+  BValue *values;
+  int i;
+
+  values = g_new0 (BValue, n_rows);
+  for (i = 0; i < n_rows; i++)
+    {
+      b_value_init (&values[i], B_TYPE_INT);
+      b_value_set_int (&values[i], first + i);
+    }
+
+  btk_list_store_insert_rows (store, position, n_rows, &column, values, 1);
+
+  for (i = 0; i < n_rows; i++)
+    b_value_unset (&values[i]);
+  g_free (values);
+}
+
+static void
+check_values (BtkListStore *store,
+              bint         *expected,
+              bint          n_expected)
+{
+  BtkTreeIter iter;
+  bboolean valid;
+  bint value;
+  int i = 0;
+
+  valid = btk_tree_model_get_iter_first (BTK_TREE_MODEL (store), &iter);
+  while (valid)
+    {
+      g_assert (i < n_expected);
+
+      btk_tree_model_get (BTK_TREE_MODEL (store), &iter, 0, &value, -1);
+      g_assert_cmpint (value, ==, expected[i]);
+
+      valid = btk_tree_model_iter_next (BTK_TREE_MODEL (store), &iter);
+      i++;
+    }
+
+  g_assert_cmpint (i, ==, n_expected);
+}
+
+static void
+list_store_test_insert_rows (void)
+{
+  bint expected[7] = { 0, 1, 10, 11, 12, 2, 3 };
+  BtkListStore *store;
+  bint n_single = 0, n_range = 0;
+
+  store = btk_list_store_new (1, B_TYPE_INT);
+  insert_rows (store, -1, 0, 4);
+
+  g_signal_connect (store, "rows-inserted",
+                    G_CALLBACK (count_rows_inserted), &n_range);
+
+  insert_rows (store, 2, 10, 3);
+
+  /* one range emission */
+  g_assert_cmpint (n_range, ==, 3);
+
+  check_values (store, expected, 7);
+
+  /* a handler of row-inserted that is not known to deal with ranges
+   * gets the rows one by one, and the range is not emitted
+   */
+  g_signal_connect (store, "row-inserted",
+                    G_CALLBACK (count_row_inserted), &n_single);
+
+  insert_rows (store, 0, 20, 2);
+
+  g_assert_cmpint (n_single, ==, 2);
+  g_assert_cmpint (n_range, ==, 3);
+
+  g_object_unref (store);
+}
+
+static void
+list_store_test_insert_rows_single_listener (void)
+{
+  bint expected[7] = { 0, 1, 10, 11, 12, 2, 3 };
+  BtkListStore *store;
+  bint n_single = 0;
+
+  store = btk_list_store_new (1, B_TYPE_INT);
+  insert_rows (store, -1, 0, 4);
+
+  /* a listener that doesn't know about ranges still sees every row */
+  g_signal_connect (store, "row-inserted",
+                    G_CALLBACK (count_row_inserted), &n_single);
+
+  insert_rows (store, 2, 10, 3);
+
+  g_assert_cmpint (n_single, ==, 3);
+
+  check_values (store, expected, 7);
+
+  g_object_unref (store);
+}
+
+static void
+list_store_test_insert_rows_sorted (void)
+{
+  bint expected[7] = { 0, 1, 2, 3, 4, 5, 6 };
+  BtkListStore *store;
+
+  store = btk_list_store_new (1, B_TYPE_INT);
+  btk_tree_sortable_set_sort_column_id (BTK_TREE_SORTABLE (store), 0,
+                                        BTK_SORT_ASCENDING);
+
+  insert_rows (store, -1, 4, 3);
+  insert_rows (store, 0, 0, 4);
+
+  check_values (store, expected, 7);
+
+  g_object_unref (store);
+}
+
+static void
+list_store_test_columnar (void)
+{
+  BtkListStore *store;
+  BtkTreeIter iter;
+  bchar *str;
+  bint i, value;
+
+  store = btk_list_store_new (3, B_TYPE_INT, B_TYPE_STRING, B_TYPE_DOUBLE);
+  btk_list_store_set_columnar (store, TRUE);
+  g_assert (btk_list_store_get_columnar (store));
+
+  for (i = 0; i < 100; i++)
+    btk_list_store_insert_with_values (store, NULL, -1,
+                                       0, i,
+                                       1, i % 2 ? "odd" : "even",
+                                       -1);
+
+  /* a row that never had a value set reads back defaults */
+  btk_list_store_append (store, &iter);
+  btk_tree_model_get (BTK_TREE_MODEL (store), &iter, 0, &value, 1, &str, -1);
+  g_assert_cmpint (value, ==, 0);
+  g_assert (str == NULL);
+  btk_list_store_remove (store, &iter);
+
+  g_assert (btk_tree_model_iter_nth_child (BTK_TREE_MODEL (store), &iter, NULL, 41));
+  btk_tree_model_get (BTK_TREE_MODEL (store), &iter, 0, &value, 1, &str, -1);
+  g_assert_cmpint (value, ==, 41);
+  g_assert_cmpstr (str, ==, "odd");
+  g_free (str);
+
+  /* overwrite, then reuse the slot of a removed row */
+  btk_list_store_set (store, &iter, 1, "changed", -1);
+  btk_tree_model_get (BTK_TREE_MODEL (store), &iter, 1, &str, -1);
+  g_assert_cmpstr (str, ==, "changed");
+  g_free (str);
+
+  btk_list_store_remove (store, &iter);
+  btk_list_store_insert_with_values (store, &iter, 0, 0, 1000, -1);
+  btk_tree_model_get (BTK_TREE_MODEL (store), &iter, 0, &value, 1, &str, -1);
+  g_assert_cmpint (value, ==, 1000);
+  g_assert (str == NULL);
+
+  g_assert (btk_tree_model_iter_nth_child (BTK_TREE_MODEL (store), &iter, NULL, 42));
+  btk_tree_model_get (BTK_TREE_MODEL (store), &iter, 0, &value, 1, &str, -1);
+  g_assert_cmpint (value, ==, 42);
+  g_assert_cmpstr (str, ==, "even");
+  g_free (str);
+
+  /* sorting goes through the same accessors */
+  btk_tree_sortable_set_sort_column_id (BTK_TREE_SORTABLE (store), 0,
+                                        BTK_SORT_DESCENDING);
+  g_assert (btk_tree_model_get_iter_first (BTK_TREE_MODEL (store), &iter));
+  btk_tree_model_get (BTK_TREE_MODEL (store), &iter, 0, &value, -1);
+  g_assert_cmpint (value, ==, 1000);
+
+  btk_list_store_clear (store);
+  btk_list_store_insert_with_values (store, &iter, -1, 1, "again", -1);
+  btk_tree_model_get (BTK_TREE_MODEL (store), &iter, 1, &str, -1);
+  g_assert_cmpstr (str, ==, "again");
+  g_free (str);
+
+  g_object_unref (store);
+}
+
+static void
+list_store_test_sort_large (void)
+{
+  BtkListStore *store;
+  BtkTreeIter iter;
+  bboolean valid;
+  bint i, id, key, prev_id = -1, prev_key = -1;
+  bchar *str, *prev_str = NULL;
+
+  /* large enough to be sorted by key */
+  store = btk_list_store_new (3, B_TYPE_INT, B_TYPE_INT, B_TYPE_STRING);
+  for (i = 0; i < 1000; i++)
+    {
+      bchar *name = g_strdup_printf ("row %d", (i * 7919) % 1000);
+
+      btk_list_store_insert_with_values (store, NULL, -1,
+                                         0, i,
+                                         1, i % 10,
+                                         2, name,
+                                         -1);
+      g_free (name);
+    }
+
+  /* equal keys keep their order */
+  btk_tree_sortable_set_sort_column_id (BTK_TREE_SORTABLE (store), 1,
+                                        BTK_SORT_DESCENDING);
+
+  valid = btk_tree_model_get_iter_first (BTK_TREE_MODEL (store), &iter);
+  while (valid)
+    {
+      btk_tree_model_get (BTK_TREE_MODEL (store), &iter, 0, &id, 1, &key, -1);
+
+      if (prev_key != -1)
+        {
+          g_assert_cmpint (key, <=, prev_key);
+          if (key == prev_key)
+            g_assert_cmpint (id, >, prev_id);
+        }
+
+      prev_key = key;
+      prev_id = id;
+      valid = btk_tree_model_iter_next (BTK_TREE_MODEL (store), &iter);
+    }
+
+  btk_tree_sortable_set_sort_column_id (BTK_TREE_SORTABLE (store), 2,
+                                        BTK_SORT_ASCENDING);
+
+  valid = btk_tree_model_get_iter_first (BTK_TREE_MODEL (store), &iter);
+  while (valid)
+    {
+      btk_tree_model_get (BTK_TREE_MODEL (store), &iter, 2, &str, -1);
+
+      if (prev_str)
+        g_assert_cmpint (g_utf8_collate (prev_str, str), <=, 0);
+
+      g_free (prev_str);
+      prev_str = str;
+      valid = btk_tree_model_iter_next (BTK_TREE_MODEL (store), &iter);
+    }
+  g_free (prev_str);
+
+  g_object_unref (store);
+}
+
 /* removal */
 static void
 list_store_test_remove_begin (ListStore     *fixture,
@@ -939,6 +1212,16 @@ main (int    argc,
 		   list_store_test_insert_before);
   g_test_add_func ("/list-store/insert-before-NULL",
 		   list_store_test_insert_before_NULL);
+  g_test_add_func ("/list-store/insert-rows",
+		   list_store_test_insert_rows);
+  g_test_add_func ("/list-store/insert-rows-single-listener",
+		   list_store_test_insert_rows_single_listener);
+  g_test_add_func ("/list-store/insert-rows-sorted",
+		   list_store_test_insert_rows_sorted);
+  g_test_add_func ("/list-store/columnar",
+		   list_store_test_columnar);
+  g_test_add_func ("/list-store/sort-large",
+		   list_store_test_sort_large);
 
   /* setting values (FIXME) */
 
@@ -1320,6 +1320,687 @@ test_tag (void)
   g_object_unref (buffer);
 }
 
+#define MANY_TAGS 300
+#define MANY_TAGS_LINES 2000
+
+static void
+check_many_tags (BtkTextBuffer  *buffer,
+                 BtkTextTag    **tags,
+                 const bint     *starts)
+{
+  BtkTextIter iter;
+  bint offset, i, n_expected;
+  GSList *list;
+
+  for (offset = 0; offset < MANY_TAGS_LINES * 10; offset += 7)
+    {
+      btk_text_buffer_get_iter_at_offset (buffer, &iter, offset);
+
+      n_expected = 0;
+      for (i = 0; i < MANY_TAGS; i++)
+        {
+          bboolean expected;
+
+          if (tags[i] == NULL)
+            continue;
+
+          expected = starts[i] <= offset && offset < starts[i] + 75;
+          if (expected)
+            n_expected++;
+
+          g_assert (btk_text_iter_has_tag (&iter, tags[i]) == expected);
+        }
+
+      list = btk_text_iter_get_tags (&iter);
+      g_assert_cmpint (b_slist_length (list), ==, n_expected);
+      b_slist_free (list);
+    }
+}
+
+static void
+test_many_tags (void)
+{
+  BtkTextBuffer *buffer;
+  BtkTextTagTable *table;
+  BtkTextTag *tags[MANY_TAGS];
+  bint starts[MANY_TAGS];
+  BtkTextIter start, end;
+  GString *text;
+  bint i, n_toggles;
+
+  buffer = btk_text_buffer_new (NULL);
+  table = btk_text_buffer_get_tag_table (buffer);
+
+  /* Enough lines for a tree with several levels */
+  text = g_string_new (NULL);
+  for (i = 0; i < MANY_TAGS_LINES; i++)
+    g_string_append (text, "123456789\n");
+  btk_text_buffer_set_text (buffer, text->str, text->len);
+  g_string_free (text, TRUE);
+
+  for (i = 0; i < MANY_TAGS; i++)
+    {
+      tags[i] = btk_text_buffer_create_tag (buffer, NULL, NULL);
+      starts[i] = i * 50;
+
+      btk_text_buffer_get_iter_at_offset (buffer, &start, starts[i]);
+      btk_text_buffer_get_iter_at_offset (buffer, &end, starts[i] + 75);
+      btk_text_buffer_apply_tag (buffer, tags[i], &start, &end);
+    }
+
+  check_many_tags (buffer, tags, starts);
+
+  /* Every tag starts and ends at its own position; the toggle
+   * at the start iter itself is not found.
+   */
+  n_toggles = 0;
+  btk_text_buffer_get_start_iter (buffer, &start);
+  while (btk_text_iter_forward_to_tag_toggle (&start, NULL))
+    n_toggles++;
+  g_assert_cmpint (n_toggles, ==, 2 * MANY_TAGS - 1);
+
+  n_toggles = 0;
+  btk_text_buffer_get_end_iter (buffer, &end);
+  while (btk_text_iter_backward_to_tag_toggle (&end, NULL))
+    n_toggles++;
+  g_assert_cmpint (n_toggles, ==, 2 * MANY_TAGS);
+
+  /* Removed tags leave holes that new tags reuse */
+  for (i = 0; i < MANY_TAGS; i += 3)
+    {
+      btk_text_tag_table_remove (table, tags[i]);
+      tags[i] = NULL;
+    }
+
+  check_many_tags (buffer, tags, starts);
+
+  for (i = 0; i < MANY_TAGS; i += 6)
+    {
+      tags[i] = btk_text_buffer_create_tag (buffer, NULL, NULL);
+      starts[i] = (MANY_TAGS_LINES * 10 - 100) - i * 50;
+
+      btk_text_buffer_get_iter_at_offset (buffer, &start, starts[i]);
+      btk_text_buffer_get_iter_at_offset (buffer, &end, starts[i] + 75);
+      btk_text_buffer_apply_tag (buffer, tags[i], &start, &end);
+    }
+
+  check_many_tags (buffer, tags, starts);
+
+  g_object_unref (buffer);
+}
+
+static void
+count_apply_tag (BtkTextBuffer     *buffer,
+                 BtkTextTag        *tag,
+                 const BtkTextIter *start,
+                 const BtkTextIter *end,
+                 bpointer           data)
+{
+  bint *count = data;
+
+  (*count)++;
+}
+
+static void
+check_toggles (BtkTextBuffer *buffer,
+               BtkTextTag    *tag,
+               const bint    *expected,
+               bint           n_expected)
+{
+  BtkTextIter iter;
+  bint i;
+
+  btk_text_buffer_get_start_iter (buffer, &iter);
+  for (i = 0; i < n_expected; i++)
+    {
+      if (i > 0 || !btk_text_iter_toggles_tag (&iter, tag))
+        g_assert (btk_text_iter_forward_to_tag_toggle (&iter, tag));
+      g_assert_cmpint (btk_text_iter_get_offset (&iter), ==, expected[i]);
+    }
+
+  g_assert (!btk_text_iter_forward_to_tag_toggle (&iter, tag));
+}
+
+static void
+test_apply_tag_ranges (void)
+{
+  BtkTextBuffer *buffer;
+  BtkTextTag *bold, *italic;
+  BtkTextBufferTagRange ranges[6];
+  bint n_applied = 0;
+  const bint bold_toggles[] = { 0, 10, 12, 20 };
+  const bint italic_toggles[] = { 5, 30 };
+
+  buffer = btk_text_buffer_new (NULL);
+  btk_text_buffer_set_text (buffer, "0123456789\n0123456789\n0123456789\n", -1);
+
+  bold = btk_text_buffer_create_tag (buffer, NULL, "weight", 700, NULL);
+  italic = btk_text_buffer_create_tag (buffer, NULL, "style", BANGO_STYLE_ITALIC, NULL);
+
+  g_signal_connect (buffer, "apply-tag", G_CALLBACK (count_apply_tag), &n_applied);
+
+  /* Overlapping and touching ranges of one tag are merged, and the
+   * offsets of a range don't have to be in order.
+   */
+  ranges[0].tag = bold;   ranges[0].start_offset = 3;  ranges[0].end_offset = 10;
+  ranges[1].tag = italic; ranges[1].start_offset = 5;  ranges[1].end_offset = 15;
+  ranges[2].tag = bold;   ranges[2].start_offset = 5;  ranges[2].end_offset = 0;
+  ranges[3].tag = bold;   ranges[3].start_offset = 12; ranges[3].end_offset = 20;
+  ranges[4].tag = italic; ranges[4].start_offset = 30; ranges[4].end_offset = 15;
+  ranges[5].tag = bold;   ranges[5].start_offset = 7;  ranges[5].end_offset = 7;
+
+  btk_text_buffer_apply_tag_ranges (buffer, ranges, G_N_ELEMENTS (ranges));
+
+  g_assert_cmpint (n_applied, ==, 3);
+  check_toggles (buffer, bold, bold_toggles, G_N_ELEMENTS (bold_toggles));
+  check_toggles (buffer, italic, italic_toggles, G_N_ELEMENTS (italic_toggles));
+
+  btk_text_buffer_apply_tag_ranges (buffer, NULL, 0);
+  g_assert_cmpint (n_applied, ==, 3);
+
+  g_object_unref (buffer);
+}
+
+static void
+check_buffer_text (BtkTextBuffer *buffer,
+                   const bchar   *expected)
+{
+  BtkTextIter start, end;
+  bchar *text;
+
+  btk_text_buffer_get_bounds (buffer, &start, &end);
+  text = btk_text_buffer_get_text (buffer, &start, &end, TRUE);
+  g_assert_cmpstr (text, ==, expected);
+  g_free (text);
+}
+
+static bsize
+model_byte_offset (GString           *model,
+                   const BtkTextIter *iter)
+{
+  return g_utf8_offset_to_pointer (model->str, btk_text_iter_get_offset (iter)) - model->str;
+}
+
+static void
+test_large_insert (void)
+{
+  BtkTextBuffer *buffer;
+  BtkTextIter start, end;
+  GString *model;
+  bsize start_byte, end_byte;
+  bint i;
+
+  buffer = btk_text_buffer_new (NULL);
+
+  /* Large enough for the text to be copied to a chunk of its own */
+  model = g_string_new (NULL);
+  for (i = 0; i < 5000; i++)
+    g_string_append_printf (model, "line %d \303\251t\303\251\n", i);
+
+  btk_text_buffer_get_start_iter (buffer, &start);
+  btk_text_buffer_insert (buffer, &start, model->str, model->len);
+  check_buffer_text (buffer, model->str);
+
+  /* Typing in the middle of a line splits the segment holding it */
+  btk_text_buffer_get_iter_at_line_offset (buffer, &start, 100, 5);
+  g_string_insert (model, model_byte_offset (model, &start), "xxxxxxxxxxxxxxxxxxxx");
+  for (i = 0; i < 20; i++)
+    {
+      btk_text_buffer_get_iter_at_line_offset (buffer, &start, 100, 5 + i);
+      btk_text_buffer_insert (buffer, &start, "x", 1);
+    }
+  check_buffer_text (buffer, model->str);
+
+  /* Delete across many lines, joining what's left of two of them */
+  btk_text_buffer_get_iter_at_line_offset (buffer, &start, 10, 3);
+  btk_text_buffer_get_iter_at_line_offset (buffer, &end, 4000, 6);
+  start_byte = model_byte_offset (model, &start);
+  end_byte = model_byte_offset (model, &end);
+  g_string_erase (model, start_byte, end_byte - start_byte);
+  btk_text_buffer_delete (buffer, &start, &end);
+  check_buffer_text (buffer, model->str);
+
+  g_string_free (model, TRUE);
+  g_object_unref (buffer);
+}
+
+static void
+load_finished_cb (BtkTextBuffer *buffer,
+                  const GError  *error,
+                  bpointer       data)
+{
+  GError **result = data;
+
+  *result = error ? g_error_copy (error) : NULL;
+  btk_main_quit ();
+}
+
+static void
+load_progress_cb (BtkTextBuffer *buffer,
+                  bint64         bytes_read,
+                  bint64         total_bytes,
+                  bpointer       data)
+{
+  bint64 *last = data;
+
+  g_assert_cmpint (bytes_read, >, *last);
+  *last = bytes_read;
+}
+
+static GError *
+load_text (BtkTextBuffer *buffer,
+           const bchar   *text,
+           bsize          len,
+           bint64        *bytes_read)
+{
+  GInputStream *stream;
+  GError *error = NULL;
+  bulong finished_id, progress_id;
+
+  stream = g_memory_input_stream_new_from_data (text, len, NULL);
+
+  *bytes_read = 0;
+  finished_id = g_signal_connect (buffer, "load-finished",
+                                  G_CALLBACK (load_finished_cb), &error);
+  progress_id = g_signal_connect (buffer, "load-progress",
+                                  G_CALLBACK (load_progress_cb), bytes_read);
+
+  btk_text_buffer_load_stream (buffer, stream, NULL);
+  btk_main ();
+
+  g_signal_handler_disconnect (buffer, finished_id);
+  g_signal_handler_disconnect (buffer, progress_id);
+  g_object_unref (stream);
+
+  return error;
+}
+
+static void
+test_load_stream (void)
+{
+  BtkTextBuffer *buffer;
+  BtkTextIter start, end;
+  GString *text;
+  GError *error;
+  bint64 bytes_read;
+  bchar *contents;
+  bint lines;
+
+  buffer = btk_text_buffer_new (NULL);
+  btk_text_buffer_set_text (buffer, "replaced", -1);
+
+  /* Enough lines to span several chunks, with multibyte characters
+   * and \r\n delimiters landing on every possible chunk boundary.
+   */
+  text = g_string_new (NULL);
+  for (lines = 0; text->len < 200000; lines++)
+    g_string_append_printf (text, "l\xc3\xadne %d \xe2\x82\xac%s",
+                            lines, lines % 3 ? "\r\n" : "\n");
+
+  error = load_text (buffer, text->str, text->len, &bytes_read);
+  g_assert_no_error (error);
+  g_assert_cmpint (bytes_read, ==, text->len);
+  g_assert_cmpint (btk_text_buffer_get_line_count (buffer), ==, lines + 1);
+
+  btk_text_buffer_get_bounds (buffer, &start, &end);
+  contents = btk_text_buffer_get_text (buffer, &start, &end, TRUE);
+  g_assert_cmpstr (contents, ==, text->str);
+  g_free (contents);
+
+  /* Invalid text stops the load with an error */
+  error = load_text (buffer, "abc\xff\xfe", 5, &bytes_read);
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA);
+  g_error_free (error);
+
+  /* So does a character cut off at the end of the stream */
+  error = load_text (buffer, "abc\xe2\x82", 5, &bytes_read);
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA);
+  g_error_free (error);
+
+  g_string_free (text, TRUE);
+  g_object_unref (buffer);
+}
+
+static void
+check_matches (BtkTextBuffer      *buffer,
+               const bchar        *str,
+               BtkTextSearchFlags  flags,
+               const bint         *expected,
+               bint                n_expected)
+{
+  GArray *matches;
+  bint i;
+
+  matches = btk_text_buffer_find_all (buffer, str, flags, NULL, NULL);
+  g_assert_cmpint (matches->len, ==, n_expected);
+
+  for (i = 0; i < n_expected; i++)
+    {
+      BtkTextBufferMatch *match = &g_array_index (matches, BtkTextBufferMatch, i);
+
+      g_assert_cmpint (match->start_offset, ==, expected[2 * i]);
+      g_assert_cmpint (match->end_offset, ==, expected[2 * i + 1]);
+    }
+
+  g_array_free (matches, TRUE);
+}
+
+/* Checks that @a and @b have the same text, and tags with the same
+ * names toggled at the same places
+ */
+static void
+check_same_rich_text (BtkTextBuffer *a,
+                      BtkTextBuffer *b)
+{
+  BtkTextIter iter_a, iter_b, end;
+  bchar *text_a, *text_b;
+
+  btk_text_buffer_get_bounds (a, &iter_a, &end);
+  text_a = btk_text_buffer_get_slice (a, &iter_a, &end, TRUE);
+  btk_text_buffer_get_bounds (b, &iter_b, &end);
+  text_b = btk_text_buffer_get_slice (b, &iter_b, &end, TRUE);
+  g_assert_cmpstr (text_a, ==, text_b);
+  g_free (text_a);
+  g_free (text_b);
+
+  while (TRUE)
+    {
+      GSList *tags_a, *tags_b, *l_a, *l_b;
+      bboolean more_a, more_b;
+
+      g_assert_cmpint (btk_text_iter_get_offset (&iter_a), ==,
+                       btk_text_iter_get_offset (&iter_b));
+
+      tags_a = btk_text_iter_get_tags (&iter_a);
+      tags_b = btk_text_iter_get_tags (&iter_b);
+
+      for (l_a = tags_a, l_b = tags_b; l_a && l_b; l_a = l_a->next, l_b = l_b->next)
+        g_assert_cmpstr (BTK_TEXT_TAG (l_a->data)->name, ==,
+                         BTK_TEXT_TAG (l_b->data)->name);
+      g_assert (l_a == NULL && l_b == NULL);
+
+      b_slist_free (tags_a);
+      b_slist_free (tags_b);
+
+      more_a = btk_text_iter_forward_to_tag_toggle (&iter_a, NULL);
+      more_b = btk_text_iter_forward_to_tag_toggle (&iter_b, NULL);
+      g_assert_cmpint (more_a, ==, more_b);
+
+      if (!more_a)
+        break;
+    }
+}
+
+static BtkTextBuffer *
+deserialize_from_data (const buint8 *data,
+                       bsize         len,
+                       bboolean      from_stream,
+                       GError      **error)
+{
+  BtkTextBuffer *buffer;
+  BtkTextIter iter;
+  BdkAtom format;
+  bboolean success;
+
+  buffer = btk_text_buffer_new (NULL);
+  btk_text_buffer_set_text (buffer, "[]", -1);
+  btk_text_buffer_get_iter_at_offset (buffer, &iter, 1);
+
+  format = btk_text_buffer_register_deserialize_tagset (buffer, NULL);
+  btk_text_buffer_deserialize_set_can_create_tags (buffer, format, TRUE);
+
+  if (from_stream)
+    {
+      GInputStream *stream;
+
+      stream = g_memory_input_stream_new_from_data (data, len, NULL);
+      success = btk_text_buffer_deserialize_from_stream (buffer, buffer, format,
+                                                         &iter, stream, NULL, error);
+      g_object_unref (stream);
+    }
+  else
+    success = btk_text_buffer_deserialize (buffer, buffer, format,
+                                           &iter, data, len, error);
+
+  /* Either way, iter is after whatever was inserted */
+  g_assert_cmpint (btk_text_iter_get_char (&iter), ==, ']');
+  g_assert_cmpint (success, ==, error == NULL || *error == NULL);
+
+  return buffer;
+}
+
+static void
+test_serialize_stream (void)
+{
+  BtkTextBuffer *buffer, *from_memory, *from_stream;
+  BtkTextTag *bold, *italic, *anonymous;
+  BtkTextIter start, end;
+  GOutputStream *stream;
+  GMemoryOutputStream *memory;
+  GError *error = NULL;
+  BdkAtom format;
+  GString *text;
+  buint8 *data;
+  bsize len;
+  bint i;
+
+  buffer = btk_text_buffer_new (NULL);
+  bold = btk_text_buffer_create_tag (buffer, "bold",
+                                     "weight", BANGO_WEIGHT_BOLD, NULL);
+  italic = btk_text_buffer_create_tag (buffer, "italic & <more>",
+                                       "style", BANGO_STYLE_ITALIC, NULL);
+  anonymous = btk_text_buffer_create_tag (buffer, NULL,
+                                          "foreground", "red", NULL);
+
+  /* Long untagged runs that take several output chunks, with text
+   * that needs escaping
+   */
+  text = g_string_new (NULL);
+  for (i = 0; text->len < 300000; i++)
+    g_string_append_printf (text, "line %d <&> \xe2\x82\xac\n", i);
+  btk_text_buffer_set_text (buffer, text->str, text->len);
+
+  for (i = 0; i < 50; i++)
+    {
+      btk_text_buffer_get_iter_at_offset (buffer, &start, i * 997);
+      btk_text_buffer_get_iter_at_offset (buffer, &end, i * 997 + 200);
+      btk_text_buffer_apply_tag (buffer, i % 2 ? bold : italic, &start, &end);
+
+      btk_text_buffer_get_iter_at_offset (buffer, &start, i * 997 + 100);
+      btk_text_buffer_get_iter_at_offset (buffer, &end, i * 997 + 300);
+      btk_text_buffer_apply_tag (buffer, anonymous, &start, &end);
+    }
+
+  format = btk_text_buffer_register_serialize_tagset (buffer, NULL);
+
+  /* Part of the text, starting inside a tagged range */
+  btk_text_buffer_get_iter_at_offset (buffer, &start, 150);
+  btk_text_buffer_get_iter_at_offset (buffer, &end, 250000);
+
+  data = btk_text_buffer_serialize (buffer, buffer, format, &start, &end, &len);
+  from_memory = deserialize_from_data (data, len, FALSE, &error);
+  g_assert_no_error (error);
+  g_free (data);
+
+  stream = g_memory_output_stream_new (NULL, 0, g_realloc, g_free);
+  g_assert (btk_text_buffer_serialize_to_stream (buffer, buffer, format,
+                                                 &start, &end, stream,
+                                                 NULL, &error));
+  g_assert_no_error (error);
+  g_output_stream_close (stream, NULL, NULL);
+
+  memory = G_MEMORY_OUTPUT_STREAM (stream);
+  from_stream = deserialize_from_data (g_memory_output_stream_get_data (memory),
+                                       g_memory_output_stream_get_data_size (memory),
+                                       TRUE, &error);
+  g_assert_no_error (error);
+  check_same_rich_text (from_memory, from_stream);
+  g_object_unref (from_stream);
+
+  /* The streamed data is also readable the old way */
+  from_stream = deserialize_from_data (g_memory_output_stream_get_data (memory),
+                                       g_memory_output_stream_get_data_size (memory),
+                                       FALSE, &error);
+  g_assert_no_error (error);
+  check_same_rich_text (from_memory, from_stream);
+  g_object_unref (from_stream);
+
+  /* Truncated data inserts nothing */
+  from_stream = deserialize_from_data (g_memory_output_stream_get_data (memory),
+                                       g_memory_output_stream_get_data_size (memory) / 2,
+                                       TRUE, &error);
+  g_assert (error != NULL);
+  g_clear_error (&error);
+  btk_text_buffer_get_bounds (from_stream, &start, &end);
+  g_assert_cmpint (btk_text_iter_get_offset (&end), ==, 2);
+  g_object_unref (from_stream);
+
+  g_object_unref (stream);
+  g_object_unref (from_memory);
+  g_string_free (text, TRUE);
+  g_object_unref (buffer);
+}
+
+static void
+test_find_all (void)
+{
+  BtkTextBuffer *buffer;
+  BtkTextIter iter, start, end;
+  static const bint hello[] = { 0, 5, 12, 17 };
+  static const bint hello_nocase[] = { 0, 5, 6, 11, 12, 17, 19, 24 };
+  static const bint multiline[] = { 12, 20 };
+  static const bint strasse[] = { 25, 31 };
+  static const bint after_edit[] = { 0, 5, 12, 17, 32, 37 };
+
+  buffer = btk_text_buffer_new (NULL);
+  btk_text_buffer_set_text (buffer,
+                            "hello HELLO hello\r\nHeLLo Stra\xc3\x9f" "e\n", -1);
+
+  check_matches (buffer, "hello", 0, hello, 2);
+  check_matches (buffer, "hello", BTK_TEXT_SEARCH_CASE_INSENSITIVE,
+                 hello_nocase, 4);
+  check_matches (buffer, "hello\r\nH", 0, multiline, 1);
+
+  /* The folding of a character only matches as a whole */
+  check_matches (buffer, "STRASSE", BTK_TEXT_SEARCH_CASE_INSENSITIVE, strasse, 1);
+  check_matches (buffer, "stras", BTK_TEXT_SEARCH_CASE_INSENSITIVE, NULL, 0);
+  check_matches (buffer, "", 0, NULL, 0);
+
+  /* Iter searches agree with the index */
+  btk_text_buffer_get_iter_at_offset (buffer, &iter, 1);
+  g_assert (btk_text_iter_forward_search (&iter, "HELLO", BTK_TEXT_SEARCH_CASE_INSENSITIVE,
+                                          &start, &end, NULL));
+  g_assert_cmpint (btk_text_iter_get_offset (&start), ==, 6);
+  g_assert_cmpint (btk_text_iter_get_offset (&end), ==, 11);
+
+  btk_text_buffer_get_end_iter (buffer, &iter);
+  g_assert (btk_text_iter_backward_search (&iter, "hello", 0, &start, &end, NULL));
+  g_assert_cmpint (btk_text_iter_get_offset (&start), ==, 12);
+
+  /* A limit cutting through the match */
+  btk_text_buffer_get_iter_at_offset (buffer, &end, 16);
+  btk_text_buffer_get_iter_at_offset (buffer, &iter, 7);
+  g_assert (!btk_text_iter_forward_search (&iter, "hello", 0, NULL, NULL, &end));
+
+  /* The index follows edits */
+  btk_text_buffer_get_end_iter (buffer, &iter);
+  btk_text_buffer_insert (buffer, &iter, "hello", -1);
+  check_matches (buffer, "hello", 0, after_edit, 3);
+
+  /* Searches after an edit walk the lines instead, with the same results */
+  btk_text_buffer_get_start_iter (buffer, &iter);
+  btk_text_buffer_insert (buffer, &iter, "x", -1);
+
+  btk_text_buffer_get_start_iter (buffer, &iter);
+  g_assert (btk_text_iter_forward_search (&iter, "STRASSE", BTK_TEXT_SEARCH_CASE_INSENSITIVE,
+                                          &start, &end, NULL));
+  g_assert_cmpint (btk_text_iter_get_offset (&start), ==, 26);
+  g_assert_cmpint (btk_text_iter_get_offset (&end), ==, 32);
+  g_assert (!btk_text_iter_forward_search (&iter, "stras", BTK_TEXT_SEARCH_CASE_INSENSITIVE,
+                                           NULL, NULL, NULL));
+
+  btk_text_buffer_get_end_iter (buffer, &iter);
+  g_assert (btk_text_iter_backward_search (&iter, "HELLO", BTK_TEXT_SEARCH_CASE_INSENSITIVE,
+                                           &start, &end, NULL));
+  g_assert_cmpint (btk_text_iter_get_offset (&start), ==, 33);
+  g_assert_cmpint (btk_text_iter_get_offset (&end), ==, 38);
+
+  g_object_unref (buffer);
+}
+
+static bint
+count_tagged (BtkTextBuffer *buffer,
+              BtkTextTag    *tag)
+{
+  BtkTextIter iter;
+  bint n_tagged;
+
+  while (g_main_context_pending (NULL))
+    g_main_context_iteration (NULL, FALSE);
+
+  btk_text_buffer_get_start_iter (buffer, &iter);
+  for (n_tagged = 0; btk_text_iter_forward_to_tag_toggle (&iter, tag); )
+    if (btk_text_iter_begins_tag (&iter, tag))
+      n_tagged++;
+
+  return n_tagged;
+}
+
+static void
+test_highlight_all (void)
+{
+  BtkTextBuffer *buffer;
+  BtkTextTag *tag;
+  BtkTextIter iter, start, end;
+  GString *text;
+  bint i;
+
+  buffer = btk_text_buffer_new (NULL);
+  tag = btk_text_buffer_create_tag (buffer, "highlight", NULL);
+
+  /* More matches than are tagged in one go */
+  text = g_string_new (NULL);
+  for (i = 0; i < 2000; i++)
+    g_string_append (text, "one two three\n");
+  btk_text_buffer_set_text (buffer, text->str, text->len);
+
+  btk_text_buffer_highlight_all (buffer, tag, "TWO", BTK_TEXT_SEARCH_CASE_INSENSITIVE);
+  g_assert_cmpint (count_tagged (buffer, tag), ==, 2000);
+
+  /* Edits are followed */
+  btk_text_buffer_get_start_iter (buffer, &iter);
+  btk_text_buffer_insert (buffer, &iter, "two ", -1);
+  g_assert_cmpint (count_tagged (buffer, tag), ==, 2001);
+
+  btk_text_buffer_get_start_iter (buffer, &iter);
+  g_assert (btk_text_iter_begins_tag (&iter, tag));
+
+  /* Edits far apart, and an edit while tagging the first matches */
+  btk_text_buffer_get_iter_at_line_offset (buffer, &start, 1000, 4);
+  end = start;
+  btk_text_iter_forward_chars (&end, 3);
+  btk_text_buffer_delete (buffer, &start, &end);
+  btk_text_buffer_get_iter_at_line (buffer, &iter, 1500);
+  btk_text_buffer_insert (buffer, &iter, "Two", -1);
+  g_assert_cmpint (count_tagged (buffer, tag), ==, 2001);
+
+  btk_text_buffer_highlight_all (buffer, tag, "two", 0);
+  g_main_context_iteration (NULL, FALSE);
+  btk_text_buffer_get_end_iter (buffer, &iter);
+  btk_text_buffer_insert (buffer, &iter, "two", -1);
+  btk_text_buffer_get_start_iter (buffer, &iter);
+  btk_text_buffer_insert (buffer, &iter, "x", -1);
+  g_assert_cmpint (count_tagged (buffer, tag), ==, 2001);
+
+  /* Stopping removes the tag */
+  btk_text_buffer_highlight_all (buffer, tag, NULL, 0);
+  btk_text_buffer_get_start_iter (buffer, &iter);
+  g_assert (!btk_text_iter_forward_to_tag_toggle (&iter, tag));
+
+  g_string_free (text, TRUE);
+  g_object_unref (buffer);
+}
+
 extern void pixbuf_init (void);
 
 int
@@ -1340,6 +2021,13 @@ main (int argc, char** argv)
   g_test_add_func ("/TextBuffer/Get and Set", test_get_set);
   g_test_add_func ("/TextBuffer/Fill and Empty", test_fill_empty);
   g_test_add_func ("/TextBuffer/Tag", test_tag);
+  g_test_add_func ("/TextBuffer/Many tags", test_many_tags);
+  g_test_add_func ("/TextBuffer/Apply tag ranges", test_apply_tag_ranges);
+  g_test_add_func ("/TextBuffer/Large insert", test_large_insert);
+  g_test_add_func ("/TextBuffer/Load stream", test_load_stream);
+  g_test_add_func ("/TextBuffer/Serialize stream", test_serialize_stream);
+  g_test_add_func ("/TextBuffer/Find all", test_find_all);
+  g_test_add_func ("/TextBuffer/Highlight all", test_highlight_all);
   
   return g_test_run();
 }
@@ -0,0 +1,226 @@
+/* BtkTextLayout unit tests.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <btk/btk.h>
+
+#define BTK_TEXT_USE_INTERNAL_UNSUPPORTED_API
+#include "btk/btktextlayout.h"
+
+static BtkTextLayout *
+create_layout (BtkTextBuffer *buffer,
+               BtkWidget     *widget)
+{
+  BtkTextLayout *layout;
+  BtkTextAttributes *style;
+  BangoContext *ltr_context, *rtl_context;
+
+  layout = btk_text_layout_new ();
+  btk_text_layout_set_buffer (layout, buffer);
+
+  ltr_context = btk_widget_create_bango_context (widget);
+  bango_context_set_base_dir (ltr_context, BANGO_DIRECTION_LTR);
+  rtl_context = btk_widget_create_bango_context (widget);
+  bango_context_set_base_dir (rtl_context, BANGO_DIRECTION_RTL);
+  btk_text_layout_set_contexts (layout, ltr_context, rtl_context);
+  g_object_unref (ltr_context);
+  g_object_unref (rtl_context);
+
+  btk_widget_ensure_style (widget);
+  style = btk_text_attributes_new ();
+  style->font = bango_font_description_copy (widget->style->font_desc);
+  style->wrap_mode = BTK_WRAP_WORD;
+  btk_text_layout_set_default_style (layout, style);
+  btk_text_attributes_unref (style);
+
+  btk_text_layout_set_screen_width (layout, 200);
+
+  return layout;
+}
+
+static void
+get_line_location (BtkTextLayout *layout,
+                   BtkTextBuffer *buffer,
+                   bint           line)
+{
+  BtkTextIter iter;
+  BdkRectangle rect;
+
+  btk_text_buffer_get_iter_at_line (buffer, &iter, line);
+  btk_text_layout_get_iter_location (layout, &iter, &rect);
+}
+
+static void
+assert_cache_stats (BtkTextLayout *layout,
+                    buint         *hits,
+                    buint         *misses,
+                    buint          new_hits,
+                    buint          new_misses)
+{
+  buint h, m;
+
+  btk_text_layout_get_display_cache_stats (layout, &h, &m);
+  g_assert_cmpuint (h - *hits, ==, new_hits);
+  g_assert_cmpuint (m - *misses, ==, new_misses);
+  *hits = h;
+  *misses = m;
+}
+
+static void
+test_display_cache (void)
+{
+  BtkWidget *widget;
+  BtkTextBuffer *buffer;
+  BtkTextLayout *layout;
+  BtkTextIter start, end;
+  buint hits, misses;
+  bint i;
+
+  widget = btk_text_view_new ();
+  g_object_ref_sink (widget);
+
+  buffer = btk_text_buffer_new (NULL);
+  for (i = 0; i < 10; i++)
+    {
+      bchar *text = g_strdup_printf ("Line %d of the buffer\n", i);
+
+      btk_text_buffer_get_end_iter (buffer, &end);
+      btk_text_buffer_insert (buffer, &end, text, -1);
+      g_free (text);
+    }
+
+  layout = create_layout (buffer, widget);
+  btk_text_layout_get_display_cache_stats (layout, &hits, &misses);
+
+  /* A line is laid out once and then found in the cache */
+  get_line_location (layout, buffer, 3);
+  assert_cache_stats (layout, &hits, &misses, 0, 1);
+  get_line_location (layout, buffer, 3);
+  assert_cache_stats (layout, &hits, &misses, 1, 0);
+
+  for (i = 0; i < 10; i++)
+    get_line_location (layout, buffer, i);
+  assert_cache_stats (layout, &hits, &misses, 1, 9);
+
+  /* Displays of deleted lines go with them; the lines inserted
+   * afterwards must never be served a display from the cache, even
+   * if they reuse the memory of a deleted line.
+   */
+  btk_text_buffer_get_iter_at_line (buffer, &start, 2);
+  btk_text_buffer_get_iter_at_line (buffer, &end, 8);
+  btk_text_buffer_delete (buffer, &start, &end);
+  btk_text_buffer_insert (buffer, &start, "New\nlines\nin\nthe\nmiddle\n", -1);
+
+  btk_text_buffer_get_bounds (buffer, &start, &end);
+  btk_text_buffer_select_range (buffer, &start, &end);
+
+  for (i = 2; i < 7; i++)
+    get_line_location (layout, buffer, i);
+  assert_cache_stats (layout, &hits, &misses, 0, 5);
+
+  g_object_unref (layout);
+  g_object_unref (buffer);
+  g_object_unref (widget);
+}
+
+static void
+validate_in_background (BtkTextLayout *layout)
+{
+  bint i;
+
+  for (i = 0; i < 100000 && !btk_text_layout_is_valid (layout); i++)
+    {
+      /* A batch is on the wrap thread; its idle wakes us up */
+      if (!btk_text_layout_validate_in_background (layout, 2000))
+        btk_main_iteration_do (TRUE);
+    }
+
+  g_assert (btk_text_layout_is_valid (layout));
+}
+
+static void
+test_background_wrap (void)
+{
+  BtkWidget *widget;
+  BtkTextBuffer *buffer;
+  BtkTextLayout *foreground, *background;
+  BtkTextIter iter;
+  bchar *words;
+  bint i;
+
+  widget = btk_text_view_new ();
+  g_object_ref_sink (widget);
+
+  words = g_strnfill (300, 'w');
+  for (i = 0; i < 300; i += 6)
+    words[i] = ' ';
+
+  buffer = btk_text_buffer_new (NULL);
+  for (i = 0; i < 2000; i++)
+    {
+      bchar *text;
+
+      /* Paragraphs of different lengths, wrapped to a few lines */
+      text = g_strdup_printf ("Paragraph %d is %.*s\n", i, i % 300, words);
+      btk_text_buffer_get_end_iter (buffer, &iter);
+      btk_text_buffer_insert (buffer, &iter, text, -1);
+      g_free (text);
+    }
+  g_free (words);
+
+  background = create_layout (buffer, widget);
+  foreground = create_layout (buffer, widget);
+
+  /* Edit a line that may be in the batch being measured */
+  if (!btk_text_layout_validate_in_background (background, 2000))
+    {
+      btk_text_buffer_get_iter_at_line (buffer, &iter, 10);
+      btk_text_buffer_insert (buffer, &iter, "An edit with some more words ", -1);
+    }
+  validate_in_background (background);
+
+  btk_text_layout_validate (foreground, G_MAXINT);
+  g_assert (btk_text_layout_is_valid (foreground));
+
+  for (i = 0; i < btk_text_buffer_get_line_count (buffer); i++)
+    {
+      bint y1, height1, y2, height2;
+
+      btk_text_buffer_get_iter_at_line (buffer, &iter, i);
+      btk_text_layout_get_line_yrange (foreground, &iter, &y1, &height1);
+      btk_text_layout_get_line_yrange (background, &iter, &y2, &height2);
+      g_assert_cmpint (y1, ==, y2);
+      g_assert_cmpint (height1, ==, height2);
+    }
+
+  g_object_unref (foreground);
+  g_object_unref (background);
+  g_object_unref (buffer);
+  g_object_unref (widget);
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  btk_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/TextLayout/display-cache", test_display_cache);
+  g_test_add_func ("/TextLayout/background-wrap", test_background_wrap);
+
+  return g_test_run ();
+}
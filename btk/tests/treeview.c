@@ -150,6 +150,156 @@ test_select_collapsed_row (void)
   btk_tree_path_free (path);
 }
 
+static void
+test_large_list_model (void)
+{
+  BtkTreeIter iter;
+  BtkTreePath *path;
+  BtkTreePath *cursor_path;
+  BtkListStore *list_store;
+  BtkWidget *view;
+  bint i;
+
+  list_store = btk_list_store_new (1, B_TYPE_INT);
+  for (i = 0; i < 1000; i++)
+    btk_list_store_insert_with_values (list_store, &iter, i,
+                                       0, i,
+                                       -1);
+
+  /* The row tree for a flat store is created in bulk; make sure every
+   * row is reachable afterwards.
+   */
+  view = btk_tree_view_new_with_model (BTK_TREE_MODEL (list_store));
+
+  for (i = 0; i < 1000; i += 333)
+    {
+      path = btk_tree_path_new_from_indices (i, -1);
+      btk_tree_view_set_cursor (BTK_TREE_VIEW (view), path, NULL, FALSE);
+
+      btk_tree_view_get_cursor (BTK_TREE_VIEW (view), &cursor_path, NULL);
+      g_assert (cursor_path != NULL);
+      g_assert (btk_tree_path_compare (cursor_path, path) == 0);
+
+      btk_tree_path_free (path);
+      btk_tree_path_free (cursor_path);
+    }
+
+  /* Rows added after the bulk build go through the regular path */
+  btk_list_store_insert_with_values (list_store, &iter, 500,
+                                     0, -1,
+                                     -1);
+  path = btk_tree_path_new_from_indices (1000, -1);
+  btk_tree_view_set_cursor (BTK_TREE_VIEW (view), path, NULL, FALSE);
+  btk_tree_view_get_cursor (BTK_TREE_VIEW (view), &cursor_path, NULL);
+  g_assert (cursor_path != NULL);
+  g_assert (btk_tree_path_compare (cursor_path, path) == 0);
+
+  btk_tree_path_free (path);
+  btk_tree_path_free (cursor_path);
+
+  /* Removing rows frees the bulk allocated nodes one by one */
+  for (i = 0; i < 600; i++)
+    {
+      btk_tree_model_iter_nth_child (BTK_TREE_MODEL (list_store), &iter, NULL,
+                                     (i * 7) % (1001 - i));
+      btk_list_store_remove (list_store, &iter);
+    }
+  g_assert_cmpint (btk_tree_model_iter_n_children (BTK_TREE_MODEL (list_store), NULL), ==, 401);
+  btk_list_store_clear (list_store);
+
+  btk_widget_destroy (view);
+  g_object_unref (list_store);
+}
+
+static void
+assert_cursor_row (BtkTreeView *tree_view,
+                   bint         row)
+{
+  BtkTreePath *cursor_path;
+
+  btk_tree_view_get_cursor (tree_view, &cursor_path, NULL);
+  g_assert (cursor_path != NULL);
+  g_assert_cmpint (btk_tree_path_get_indices (cursor_path)[0], ==, row);
+  btk_tree_path_free (cursor_path);
+}
+
+static void
+test_search_index (void)
+{
+  const bchar *fruits[] = {
+    "Apple", "banana", "apricot", "Blueberry", "avocado", "cherry"
+  };
+  BtkTreeIter iter;
+  BtkListStore *list_store;
+  BtkWidget *view;
+  BtkWidget *entry;
+  bint i;
+
+  list_store = btk_list_store_new (1, B_TYPE_STRING);
+  for (i = 0; i < G_N_ELEMENTS (fruits); i++)
+    btk_list_store_insert_with_values (list_store, &iter, i,
+                                       0, fruits[i],
+                                       -1);
+
+  view = btk_tree_view_new_with_model (BTK_TREE_MODEL (list_store));
+  btk_tree_view_set_enable_search_index (BTK_TREE_VIEW (view), TRUE);
+  g_assert (btk_tree_view_get_enable_search_index (BTK_TREE_VIEW (view)));
+
+  entry = btk_entry_new ();
+  g_object_ref_sink (entry);
+  btk_tree_view_set_search_entry (BTK_TREE_VIEW (view), BTK_ENTRY (entry));
+
+  /* Matching is case-insensitive and picks the first row in view order */
+  btk_entry_set_text (BTK_ENTRY (entry), "b");
+  assert_cursor_row (BTK_TREE_VIEW (view), 1);
+  btk_entry_set_text (BTK_ENTRY (entry), "BL");
+  assert_cursor_row (BTK_TREE_VIEW (view), 3);
+  btk_entry_set_text (BTK_ENTRY (entry), "av");
+  assert_cursor_row (BTK_TREE_VIEW (view), 4);
+
+  /* No match leaves the cursor alone */
+  btk_entry_set_text (BTK_ENTRY (entry), "avz");
+  assert_cursor_row (BTK_TREE_VIEW (view), 4);
+
+  /* Inserted rows are picked up */
+  btk_list_store_insert_with_values (list_store, &iter, 0,
+                                     0, "Blackberry",
+                                     -1);
+  btk_entry_set_text (BTK_ENTRY (entry), "bl");
+  assert_cursor_row (BTK_TREE_VIEW (view), 0);
+
+  /* Reordering renumbers the indexed rows */
+  btk_list_store_move_before (list_store, &iter, NULL);
+  btk_entry_set_text (BTK_ENTRY (entry), "bla");
+  assert_cursor_row (BTK_TREE_VIEW (view), 6);
+
+  /* Changed rows are picked up */
+  btk_tree_model_iter_nth_child (BTK_TREE_MODEL (list_store), &iter, NULL, 5);
+  btk_list_store_set (list_store, &iter, 0, "Cranberry", -1);
+  btk_entry_set_text (BTK_ENTRY (entry), "cr");
+  assert_cursor_row (BTK_TREE_VIEW (view), 5);
+
+  /* Deleted rows shift the ones after them */
+  btk_tree_model_iter_nth_child (BTK_TREE_MODEL (list_store), &iter, NULL, 0);
+  btk_list_store_remove (list_store, &iter);
+  btk_entry_set_text (BTK_ENTRY (entry), "cra");
+  assert_cursor_row (BTK_TREE_VIEW (view), 4);
+  btk_entry_set_text (BTK_ENTRY (entry), "apr");
+  assert_cursor_row (BTK_TREE_VIEW (view), 1);
+
+  /* Rows inserted during a search join its matches */
+  btk_list_store_insert_with_values (list_store, &iter, 0,
+                                     0, "Apricot jam",
+                                     -1);
+  btk_entry_set_text (BTK_ENTRY (entry), "apri");
+  assert_cursor_row (BTK_TREE_VIEW (view), 0);
+
+  btk_tree_view_set_search_entry (BTK_TREE_VIEW (view), NULL);
+  g_object_unref (entry);
+  btk_widget_destroy (view);
+  g_object_unref (list_store);
+}
+
 int
 main (int    argc,
       char **argv)
@@ -160,6 +310,10 @@ main (int    argc,
   g_test_add_func ("/TreeView/cursor/bug-539377", test_bug_539377);
   g_test_add_func ("/TreeView/cursor/select-collapsed_row",
                    test_select_collapsed_row);
+  g_test_add_func ("/TreeView/model/large-list",
+                   test_large_list_model);
+  g_test_add_func ("/TreeView/search/index",
+                   test_search_index);
 
   return g_test_run ();
 }
@@ -0,0 +1,448 @@
+/* Benchmarks for the tree and list models and BtkTreeView
+ *
+ * Run with
+ *
+ *   xvfb-run ./testmodelperf --rows=10000,100000,1000000
+ *
+ * and see README for the output format.
+ */
+
+#include <btk/btk.h>
+#include "perfbench.h"
+
+enum {
+  COLUMN_NUMBER,
+  COLUMN_TEXT,
+  N_COLUMNS
+};
+
+#define TREE_CHILDREN   100
+#define CHURN_CHANGES   10000
+#define VIEW_ITERATIONS 100
+
+static char *rows_option = "10000,100000,1000000";
+static bboolean no_views = FALSE;
+
+static const GOptionEntry entries[] = {
+  { "rows", 'r', 0, G_OPTION_ARG_STRING, &rows_option,
+    "Comma separated list of row counts to test", "N,..." },
+  { "no-views", 0, 0, G_OPTION_ARG_NONE, &no_views,
+    "Skip the BtkTreeView benchmarks", NULL },
+  { NULL }
+};
+
+static GRand *rng;
+
+static const char *words[] = {
+  "alpha", "bravo", "charlie", "delta", "echo", "foxtrot", "golf",
+  "hotel", "india", "juliet", "kilo", "lima", "mike", "november"
+};
+
+static char *
+random_text (void)
+{
+  return g_strdup_printf ("%s %s %d",
+			  words[g_rand_int_range (rng, 0, G_N_ELEMENTS (words))],
+			  words[g_rand_int_range (rng, 0, G_N_ELEMENTS (words))],
+			  g_rand_int_range (rng, 0, 1000000));
+}
+
+static void
+list_store_fill (BtkListStore *store,
+		 bint          n_rows)
+{
+  BtkTreeIter iter;
+  bint i;
+
+  for (i = 0; i < n_rows; i++)
+    {
+      char *text = random_text ();
+
+      btk_list_store_insert_with_values (store, &iter, -1,
+					 COLUMN_NUMBER, g_rand_int (rng),
+					 COLUMN_TEXT, text,
+					 -1);
+      g_free (text);
+    }
+}
+
+static BtkListStore *
+list_store_new_filled (bint n_rows)
+{
+  BtkListStore *store;
+
+  store = btk_list_store_new (N_COLUMNS, B_TYPE_INT, B_TYPE_STRING);
+  list_store_fill (store, n_rows);
+
+  return store;
+}
+
+static BtkTreeStore *
+tree_store_new_filled (bint n_rows)
+{
+  BtkTreeStore *store;
+  BtkTreeIter parent, iter;
+  bint i;
+
+  store = btk_tree_store_new (N_COLUMNS, B_TYPE_INT, B_TYPE_STRING);
+
+  for (i = 0; i < n_rows; i++)
+    {
+      char *text = random_text ();
+
+      if (i % (TREE_CHILDREN + 1) == 0)
+	btk_tree_store_insert_with_values (store, &parent, NULL, -1,
+					   COLUMN_NUMBER, g_rand_int (rng),
+					   COLUMN_TEXT, text,
+					   -1);
+      else
+	btk_tree_store_insert_with_values (store, &iter, &parent, -1,
+					   COLUMN_NUMBER, g_rand_int (rng),
+					   COLUMN_TEXT, text,
+					   -1);
+      g_free (text);
+    }
+
+  return store;
+}
+
+/* List store */
+
+static void
+bench_list_store (bint n_rows)
+{
+  BtkListStore *store;
+  BtkTreeIter iter;
+  bint i;
+
+  if (perf_bench_start ("list-store/append", n_rows))
+    {
+      store = btk_list_store_new (N_COLUMNS, B_TYPE_INT, B_TYPE_STRING);
+      list_store_fill (store, n_rows);
+      perf_bench_stop (n_rows);
+      g_object_unref (store);
+    }
+
+  if (perf_bench_start ("list-store/insert-rows", n_rows))
+    {
+      bint columns[N_COLUMNS] = { COLUMN_NUMBER, COLUMN_TEXT };
+      BValue *values;
+
+      store = btk_list_store_new (N_COLUMNS, B_TYPE_INT, B_TYPE_STRING);
+
+      values = g_new0 (BValue, N_COLUMNS * n_rows);
+      for (i = 0; i < n_rows; i++)
+	{
+	  b_value_init (&values[i], B_TYPE_INT);
+	  b_value_set_int (&values[i], g_rand_int (rng));
+	  b_value_init (&values[n_rows + i], B_TYPE_STRING);
+	  b_value_take_string (&values[n_rows + i], random_text ());
+	}
+
+      btk_list_store_insert_rows (store, -1, n_rows,
+				  columns, values, N_COLUMNS);
+      perf_bench_stop (n_rows);
+
+      for (i = 0; i < N_COLUMNS * n_rows; i++)
+	b_value_unset (&values[i]);
+      g_free (values);
+      g_object_unref (store);
+    }
+
+  if (perf_bench_enabled ("list-store/sort"))
+    {
+      store = list_store_new_filled (n_rows);
+
+      perf_bench_start ("list-store/sort", n_rows);
+      btk_tree_sortable_set_sort_column_id (BTK_TREE_SORTABLE (store),
+					    COLUMN_TEXT,
+					    BTK_SORT_ASCENDING);
+      perf_bench_stop (n_rows);
+      g_object_unref (store);
+    }
+
+  if (perf_bench_enabled ("list-store/remove"))
+    {
+      store = list_store_new_filled (n_rows);
+
+      perf_bench_start ("list-store/remove", n_rows);
+      while (btk_tree_model_get_iter_first (BTK_TREE_MODEL (store), &iter))
+	btk_list_store_remove (store, &iter);
+      perf_bench_stop (n_rows);
+      g_object_unref (store);
+    }
+}
+
+/* Tree store */
+
+static void
+tree_store_remove_all (BtkTreeStore *store)
+{
+  BtkTreeIter iter;
+
+  while (btk_tree_model_get_iter_first (BTK_TREE_MODEL (store), &iter))
+    btk_tree_store_remove (store, &iter);
+}
+
+static void
+bench_tree_store (bint n_rows)
+{
+  BtkTreeStore *store;
+
+  if (perf_bench_start ("tree-store/append", n_rows))
+    {
+      store = tree_store_new_filled (n_rows);
+      perf_bench_stop (n_rows);
+      g_object_unref (store);
+    }
+
+  if (perf_bench_enabled ("tree-store/sort"))
+    {
+      store = tree_store_new_filled (n_rows);
+
+      perf_bench_start ("tree-store/sort", n_rows);
+      btk_tree_sortable_set_sort_column_id (BTK_TREE_SORTABLE (store),
+					    COLUMN_TEXT,
+					    BTK_SORT_ASCENDING);
+      perf_bench_stop (n_rows);
+      g_object_unref (store);
+    }
+
+  if (perf_bench_enabled ("tree-store/remove"))
+    {
+      store = tree_store_new_filled (n_rows);
+
+      perf_bench_start ("tree-store/remove", n_rows);
+      tree_store_remove_all (store);
+      perf_bench_stop (n_rows);
+      g_object_unref (store);
+    }
+}
+
+/* Filter and sort models */
+
+static bint filter_parity;
+
+static bboolean
+filter_visible_func (BtkTreeModel *model,
+		     BtkTreeIter  *iter,
+		     bpointer      data)
+{
+  bint number;
+
+  btk_tree_model_get (model, iter, COLUMN_NUMBER, &number, -1);
+
+  return (number & 1) == filter_parity;
+}
+
+static void
+bench_filter (bint n_rows)
+{
+  BtkListStore *store;
+  BtkTreeModel *filter;
+  BtkTreeIter iter;
+
+  if (!perf_bench_enabled ("filter/refilter"))
+    return;
+
+  store = list_store_new_filled (n_rows);
+  filter = btk_tree_model_filter_new (BTK_TREE_MODEL (store), NULL);
+  btk_tree_model_filter_set_visible_func (BTK_TREE_MODEL_FILTER (filter),
+					  filter_visible_func, NULL, NULL);
+  filter_parity = 0;
+
+  /* Build the filter's root level so that the refilter has work to do */
+  btk_tree_model_get_iter_first (filter, &iter);
+
+  perf_bench_start ("filter/refilter", n_rows);
+  filter_parity = 1;
+  btk_tree_model_filter_refilter (BTK_TREE_MODEL_FILTER (filter));
+  btk_tree_model_get_iter_first (filter, &iter);
+  perf_bench_stop (n_rows);
+
+  g_object_unref (filter);
+  g_object_unref (store);
+}
+
+static void
+bench_sort_model (bint n_rows)
+{
+  BtkListStore *store;
+  BtkTreeModel *sort;
+  BtkTreeIter iter;
+  bint i, n_changes;
+
+  if (!perf_bench_enabled ("sort-model/churn"))
+    return;
+
+  store = list_store_new_filled (n_rows);
+  sort = btk_tree_model_sort_new_with_model (BTK_TREE_MODEL (store));
+  btk_tree_sortable_set_sort_column_id (BTK_TREE_SORTABLE (sort),
+					COLUMN_NUMBER,
+					BTK_SORT_ASCENDING);
+  btk_tree_model_get_iter_first (sort, &iter);
+
+  n_changes = MIN (n_rows, CHURN_CHANGES);
+
+  perf_bench_start ("sort-model/churn", n_rows);
+  for (i = 0; i < n_changes; i++)
+    {
+      btk_tree_model_iter_nth_child (BTK_TREE_MODEL (store), &iter, NULL,
+				     g_rand_int_range (rng, 0, n_rows));
+      btk_list_store_set (store, &iter,
+			  COLUMN_NUMBER, g_rand_int (rng),
+			  -1);
+    }
+  /* Resorting may be deferred to an idle */
+  if (!no_views)
+    perf_bench_flush_events ();
+  perf_bench_stop (n_changes);
+
+  g_object_unref (sort);
+  g_object_unref (store);
+}
+
+/* Tree view */
+
+static BtkWidget *
+tree_view_window_new (BtkWidget **tree_view)
+{
+  BtkWidget *window, *sw;
+  BtkCellRenderer *renderer;
+
+  window = btk_window_new (BTK_WINDOW_TOPLEVEL);
+  btk_window_set_default_size (BTK_WINDOW (window), 400, 600);
+
+  sw = btk_scrolled_window_new (NULL, NULL);
+  btk_container_add (BTK_CONTAINER (window), sw);
+
+  *tree_view = btk_tree_view_new ();
+  btk_tree_view_set_fixed_height_mode (BTK_TREE_VIEW (*tree_view), TRUE);
+  btk_container_add (BTK_CONTAINER (sw), *tree_view);
+
+  renderer = btk_cell_renderer_text_new ();
+  btk_tree_view_insert_column_with_attributes (BTK_TREE_VIEW (*tree_view), -1,
+					       "Number", renderer,
+					       "text", COLUMN_NUMBER,
+					       NULL);
+  btk_tree_view_insert_column_with_attributes (BTK_TREE_VIEW (*tree_view), -1,
+					       "Text", renderer,
+					       "text", COLUMN_TEXT,
+					       NULL);
+  btk_tree_view_column_set_sizing (btk_tree_view_get_column (BTK_TREE_VIEW (*tree_view), 0),
+				   BTK_TREE_VIEW_COLUMN_FIXED);
+  btk_tree_view_column_set_fixed_width (btk_tree_view_get_column (BTK_TREE_VIEW (*tree_view), 0),
+					100);
+  btk_tree_view_column_set_sizing (btk_tree_view_get_column (BTK_TREE_VIEW (*tree_view), 1),
+				   BTK_TREE_VIEW_COLUMN_FIXED);
+  btk_tree_view_column_set_fixed_width (btk_tree_view_get_column (BTK_TREE_VIEW (*tree_view), 1),
+					250);
+
+  btk_widget_show_all (window);
+  perf_bench_flush_events ();
+
+  return window;
+}
+
+static void
+bench_tree_view (bint n_rows)
+{
+  BtkWidget *window, *tree_view;
+  BtkListStore *store;
+  BtkAdjustment *vadj;
+  bdouble step;
+  bint i;
+
+  if (!perf_bench_enabled ("tree-view/validate") &&
+      !perf_bench_enabled ("tree-view/scroll") &&
+      !perf_bench_enabled ("tree-view/expose"))
+    return;
+
+  store = list_store_new_filled (n_rows);
+  window = tree_view_window_new (&tree_view);
+
+  if (perf_bench_start ("tree-view/validate", n_rows))
+    {
+      btk_tree_view_set_model (BTK_TREE_VIEW (tree_view),
+			       BTK_TREE_MODEL (store));
+      perf_bench_flush_events ();
+      perf_bench_stop (n_rows);
+    }
+  else
+    btk_tree_view_set_model (BTK_TREE_VIEW (tree_view),
+			     BTK_TREE_MODEL (store));
+
+  vadj = btk_tree_view_get_vadjustment (BTK_TREE_VIEW (tree_view));
+  step = (vadj->upper - vadj->page_size) / VIEW_ITERATIONS;
+
+  if (perf_bench_start ("tree-view/scroll", n_rows))
+    {
+      for (i = 1; i <= VIEW_ITERATIONS; i++)
+	{
+	  btk_adjustment_set_value (vadj, i * step);
+	  bdk_window_process_all_updates ();
+	  perf_bench_flush_events ();
+	}
+      perf_bench_stop (VIEW_ITERATIONS);
+    }
+
+  if (perf_bench_start ("tree-view/expose", n_rows))
+    {
+      for (i = 0; i < VIEW_ITERATIONS; i++)
+	{
+	  btk_widget_queue_draw (tree_view);
+	  bdk_window_process_all_updates ();
+	}
+      bdk_display_sync (btk_widget_get_display (window));
+      perf_bench_stop (VIEW_ITERATIONS);
+    }
+
+  btk_widget_destroy (window);
+  g_object_unref (store);
+}
+
+int
+main (int argc, char **argv)
+{
+  GOptionContext *context;
+  GError *error = NULL;
+  bint *rows, n_rows, i;
+
+  perf_bench_init (&argc, &argv);
+  g_type_init ();
+
+  context = g_option_context_new ("- benchmark the tree and list models");
+  g_option_context_add_main_entries (context, entries, NULL);
+  g_option_context_add_group (context, perf_bench_get_option_group ());
+  if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+      g_printerr ("%s\n", error->message);
+      return 1;
+    }
+  g_option_context_free (context);
+
+  if (!no_views && !btk_init_check (&argc, &argv))
+    {
+      g_printerr ("Cannot open a display, skipping the view benchmarks\n");
+      no_views = TRUE;
+    }
+
+  rng = g_rand_new_with_seed (42);
+  rows = perf_bench_parse_rows (rows_option, &n_rows);
+
+  for (i = 0; i < n_rows; i++)
+    {
+      bench_list_store (rows[i]);
+      bench_tree_store (rows[i]);
+      bench_filter (rows[i]);
+      bench_sort_model (rows[i]);
+      if (!no_views)
+	bench_tree_view (rows[i]);
+    }
+
+  g_free (rows);
+  g_rand_free (rng);
+  perf_bench_finish ();
+
+  return 0;
+}
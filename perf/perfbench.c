@@ -0,0 +1,325 @@
+/* Benchmark harness shared by the BTK+ data structure benchmarks
+ *
+ * Each benchmark is bracketed by perf_bench_start() and
+ * perf_bench_stop(), which print a line like
+ *
+ *   {"benchmark": "list-store/append", "rows": 100000, "ops": 100000,
+ *    "seconds": 0.081234, "ops_per_sec": 1231010.1,
+ *    "peak_rss_kb": 52344, "allocations": 300012}
+ *
+ * "peak_rss_kb" is the peak resident set size of the whole process so
+ * far; run a single benchmark with --only to measure it in isolation.
+ * "allocations" counts calls to malloc() while the benchmark ran, and
+ * is only reported with --count-allocations (glibc systems only).
+ * Benchmarks can report further numbers with perf_bench_add_value(),
+ * which are printed after the common fields.  Values can still be
+ * added after perf_bench_stop(), so that computing them is not timed;
+ * the line is printed when the next benchmark starts or the harness
+ * finishes.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <btk/btk.h>
+#ifdef G_OS_UNIX
+#include <sys/resource.h>
+#endif
+#include "perfbench.h"
+
+static GTimer *timer;
+static char *current_name;
+static bint current_rows;
+static bboolean running;
+static bboolean stopped;
+static GString *result;
+static GString *values;
+
+static char *only_pattern;
+static char *output_filename;
+static FILE *output;
+static bboolean count_allocations;
+static volatile bint n_allocations;
+
+static const GOptionEntry entries[] = {
+  { "only", 0, 0, G_OPTION_ARG_STRING, &only_pattern,
+    "Only run the benchmarks matching PATTERN", "PATTERN" },
+  { "output", 'o', 0, G_OPTION_ARG_FILENAME, &output_filename,
+    "Append the results to FILE instead of stdout", "FILE" },
+#ifdef __GLIBC__
+  { "count-allocations", 0, 0, G_OPTION_ARG_NONE, &count_allocations,
+    "Count calls to malloc()", NULL },
+#endif
+  { NULL }
+};
+
+#ifdef __GLIBC__
+
+/* The allocation count comes from replacing malloc() and friends for
+ * the whole process, which also catches allocations made by GLib,
+ * Bango and Xlib.  The real allocator is glibc's, under its internal
+ * names.
+ */
+extern void *__libc_malloc  (size_t n_bytes);
+extern void *__libc_calloc  (size_t n_blocks,
+			     size_t n_block_bytes);
+extern void *__libc_realloc (void  *mem,
+			     size_t n_bytes);
+
+static volatile bboolean counting;
+
+void *
+malloc (size_t n_bytes)
+{
+  if (counting)
+    g_atomic_int_inc (&n_allocations);
+  return __libc_malloc (n_bytes);
+}
+
+void *
+calloc (size_t n_blocks,
+	size_t n_block_bytes)
+{
+  if (counting)
+    g_atomic_int_inc (&n_allocations);
+  return __libc_calloc (n_blocks, n_block_bytes);
+}
+
+void *
+realloc (void  *mem,
+	 size_t n_bytes)
+{
+  if (counting && mem == NULL)
+    g_atomic_int_inc (&n_allocations);
+  return __libc_realloc (mem, n_bytes);
+}
+
+#endif
+
+/* Must be called before anything else touches GLib, so that GSlice
+ * picks up the environment set here.
+ */
+void
+perf_bench_init (int    *argc,
+		 char ***argv)
+{
+#ifdef __GLIBC__
+  int i;
+
+  for (i = 1; i < *argc; i++)
+    if (strcmp ((*argv)[i], "--count-allocations") == 0)
+      {
+	/* Have GSlice allocate every block with malloc() too */
+	g_setenv ("G_SLICE", "always-malloc", TRUE);
+	counting = TRUE;
+	break;
+      }
+#endif
+
+  timer = g_timer_new ();
+}
+
+GOptionGroup *
+perf_bench_get_option_group (void)
+{
+  GOptionGroup *group;
+
+  group = g_option_group_new ("bench", "Benchmark Options:",
+			      "Show benchmark options", NULL, NULL);
+  g_option_group_add_entries (group, entries);
+
+  return group;
+}
+
+static void
+print_result (void)
+{
+  if (!stopped)
+    return;
+
+  stopped = FALSE;
+
+  if (output == NULL)
+    {
+      if (output_filename)
+	output = fopen (output_filename, "a");
+      if (output == NULL)
+	output = stdout;
+    }
+
+  fprintf (output, "%s%s}\n", result->str, values->str);
+  fflush (output);
+}
+
+void
+perf_bench_finish (void)
+{
+  print_result ();
+
+  if (output && output != stdout)
+    fclose (output);
+  output = NULL;
+
+  g_timer_destroy (timer);
+  timer = NULL;
+
+  if (values)
+    g_string_free (values, TRUE);
+  values = NULL;
+
+  if (result)
+    g_string_free (result, TRUE);
+  result = NULL;
+}
+
+static long
+get_peak_rss (void)
+{
+#ifdef G_OS_UNIX
+  struct rusage usage;
+
+  if (getrusage (RUSAGE_SELF, &usage) == 0)
+    return usage.ru_maxrss;
+#endif
+
+  return -1;
+}
+
+/* Returns %FALSE if the benchmark is filtered out by --only, so that
+ * callers can skip the setup for it.
+ */
+bboolean
+perf_bench_enabled (const char *name)
+{
+  return only_pattern == NULL || g_pattern_match_simple (only_pattern, name);
+}
+
+/* Returns %FALSE if the benchmark is filtered out by --only */
+bboolean
+perf_bench_start (const char *name,
+		  bint        rows)
+{
+  g_return_val_if_fail (!running, FALSE);
+
+  if (!perf_bench_enabled (name))
+    return FALSE;
+
+  print_result ();
+
+  g_free (current_name);
+  current_name = g_strdup (name);
+  current_rows = rows;
+  running = TRUE;
+
+  if (values == NULL)
+    values = g_string_new (NULL);
+  g_string_truncate (values, 0);
+
+  g_atomic_int_set (&n_allocations, 0);
+  g_timer_start (timer);
+
+  return TRUE;
+}
+
+void
+perf_bench_stop (bint n_ops)
+{
+  bdouble elapsed;
+  bint allocations;
+  char seconds[G_ASCII_DTOSTR_BUF_SIZE];
+  char ops_per_sec[G_ASCII_DTOSTR_BUF_SIZE];
+
+  g_return_if_fail (running);
+
+  g_timer_stop (timer);
+  elapsed = g_timer_elapsed (timer, NULL);
+  allocations = g_atomic_int_get (&n_allocations);
+  running = FALSE;
+  stopped = TRUE;
+
+  if (result == NULL)
+    result = g_string_new (NULL);
+
+  /* Keep the decimal point independent of the locale */
+  g_ascii_formatd (seconds, sizeof (seconds), "%.6f", elapsed);
+  g_ascii_formatd (ops_per_sec, sizeof (ops_per_sec), "%.1f",
+		   elapsed > 0 ? n_ops / elapsed : 0.0);
+
+  g_string_printf (result,
+		   "{\"benchmark\": \"%s\", \"rows\": %d, \"ops\": %d, "
+		   "\"seconds\": %s, \"ops_per_sec\": %s, \"peak_rss_kb\": %ld, ",
+		   current_name, current_rows, n_ops,
+		   seconds, ops_per_sec, get_peak_rss ());
+
+  if (count_allocations)
+    g_string_append_printf (result, "\"allocations\": %d", allocations);
+  else
+    g_string_append (result, "\"allocations\": null");
+}
+
+/* Adds a field to the result of the running or just stopped
+ * benchmark.  Values computed after perf_bench_stop() are not timed.
+ */
+void
+perf_bench_add_value (const char *name,
+		      bdouble     value)
+{
+  char buf[G_ASCII_DTOSTR_BUF_SIZE];
+
+  g_return_if_fail (running || stopped);
+
+  g_ascii_formatd (buf, sizeof (buf), "%.6g", value);
+  g_string_append_printf (values, ", \"%s\": %s", name, buf);
+}
+
+/* Parses a comma separated list of row counts like "10000,1e6" */
+bint *
+perf_bench_parse_rows (const char *rows,
+		       bint       *n_rows)
+{
+  char **tokens;
+  bint *result;
+  bint i, n;
+
+  tokens = g_strsplit (rows, ",", -1);
+  result = g_new (bint, g_strv_length (tokens));
+
+  for (i = 0, n = 0; tokens[i]; i++)
+    {
+      bdouble value = g_ascii_strtod (tokens[i], NULL);
+
+      if (value >= 1 && value <= B_MAXINT)
+	result[n++] = value;
+      else
+	g_printerr ("Ignoring row count '%s'\n", tokens[i]);
+    }
+
+  g_strfreev (tokens);
+  *n_rows = n;
+
+  return result;
+}
+
+void
+perf_bench_flush_events (void)
+{
+  while (btk_events_pending ())
+    btk_main_iteration ();
+}
+
+/* Like perf_bench_flush_events(), but also blocks in the main loop
+ * until @done returns %TRUE, for work that finishes off the main
+ * thread and only then queues the rest of it.
+ */
+void
+perf_bench_flush_events_until (PerfBenchDoneFunc done,
+			       bpointer          data)
+{
+  perf_bench_flush_events ();
+
+  while (!done (data))
+    {
+      btk_main_iteration_do (TRUE);
+      perf_bench_flush_events ();
+    }
+}
@@ -0,0 +1,35 @@
+#ifndef PERFBENCH_H
+#define PERFBENCH_H
+
+#include <btk/btk.h>
+
+G_BEGIN_DECLS
+
+/* Shared harness for the data structure benchmarks (testmodelperf and
+ * friends).  Every finished benchmark prints one JSON object per line,
+ * so that runs can be collected and compared by scripts.
+ */
+
+typedef bboolean (*PerfBenchDoneFunc) (bpointer data);
+
+void          perf_bench_init             (int         *argc,
+					   char      ***argv);
+GOptionGroup *perf_bench_get_option_group (void);
+void          perf_bench_finish           (void);
+
+bboolean      perf_bench_enabled          (const char  *name);
+bboolean      perf_bench_start            (const char  *name,
+					   bint         rows);
+void          perf_bench_stop             (bint         n_ops);
+void          perf_bench_add_value        (const char  *name,
+					   bdouble      value);
+
+bint         *perf_bench_parse_rows       (const char  *rows,
+					   bint        *n_rows);
+void          perf_bench_flush_events     (void);
+void          perf_bench_flush_events_until (PerfBenchDoneFunc done,
+					     bpointer          data);
+
+G_END_DECLS
+
+#endif
@@ -0,0 +1,567 @@
+/* Benchmarks for BtkTextBuffer and BtkTextView on large buffers
+ *
+ * Run with
+ *
+ *   xvfb-run ./testtextperf --size=1e6,8e6
+ *
+ * and see README for the output format.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <btk/btk.h>
+#include "perfbench.h"
+
+#define BTK_TEXT_USE_INTERNAL_UNSUPPORTED_API
+#include "btk/btktextlayout.h"
+
+#define N_TAGS          8
+#define N_EDITS         10000
+#define N_KEYSTROKES    500
+#define VIEW_ITERATIONS 100
+#define SEARCH_WORD     "zulu"
+
+static char *size_option = "1e6,8e6";
+static bboolean no_views = FALSE;
+
+static const GOptionEntry entries[] = {
+  { "size", 's', 0, G_OPTION_ARG_STRING, &size_option,
+    "Comma separated list of buffer sizes in bytes to test", "N,..." },
+  { "no-views", 0, 0, G_OPTION_ARG_NONE, &no_views,
+    "Skip the BtkTextView benchmarks", NULL },
+  { NULL }
+};
+
+static GRand *rng;
+
+static const char *words[] = {
+  "alpha", "bravo", "charlie", "delta", "echo", "foxtrot", "golf",
+  "hotel", "india", "juliet", "kilo", "lima", "mike", "november",
+  "oscar", "papa", "quebec", "romeo", "sierra", "tango", "uniform",
+  "victor", "whiskey", "xray", "yankee"
+};
+
+/* Generates about @n_bytes of text in lines of 40 to 120 characters,
+ * with an occasional long paragraph and a rare SEARCH_WORD.
+ */
+static char *
+random_text (bint n_bytes)
+{
+  GString *text;
+  bsize line_start;
+  bint line_length;
+
+  text = g_string_sized_new (n_bytes + 256);
+  line_start = 0;
+  line_length = g_rand_int_range (rng, 40, 120);
+
+  while (text->len < (bsize) n_bytes)
+    {
+      if (g_rand_int_range (rng, 0, 2000) == 0)
+	g_string_append (text, SEARCH_WORD);
+      else
+	g_string_append (text, words[g_rand_int_range (rng, 0, G_N_ELEMENTS (words))]);
+
+      if (text->len - line_start >= (bsize) line_length)
+	{
+	  g_string_append_c (text, '\n');
+	  line_start = text->len;
+	  if (g_rand_int_range (rng, 0, 50) == 0)
+	    line_length = g_rand_int_range (rng, 1000, 5000);
+	  else
+	    line_length = g_rand_int_range (rng, 40, 120);
+	}
+      else
+	g_string_append_c (text, ' ');
+    }
+
+  return g_string_free (text, FALSE);
+}
+
+static void
+create_tags (BtkTextBuffer *buffer,
+	     BtkTextTag    *tags[N_TAGS])
+{
+  static const char *colors[] = { "red", "blue", "dark green", "purple" };
+  bint i;
+
+  for (i = 0; i < N_TAGS; i++)
+    {
+      char *name = g_strdup_printf ("tag%d", i);
+
+      if (i < (bint) G_N_ELEMENTS (colors))
+	tags[i] = btk_text_buffer_create_tag (buffer, name,
+					      "foreground", colors[i],
+					      NULL);
+      else if (i % 2)
+	tags[i] = btk_text_buffer_create_tag (buffer, name,
+					      "weight", BANGO_WEIGHT_BOLD,
+					      NULL);
+      else
+	tags[i] = btk_text_buffer_create_tag (buffer, name,
+					      "style", BANGO_STYLE_ITALIC,
+					      "scale", BANGO_SCALE_LARGE,
+					      NULL);
+      g_free (name);
+    }
+}
+
+/* Returns one range per word, like a syntax highlighter would */
+static BtkTextBufferTagRange *
+word_ranges (const char *text,
+	     BtkTextTag *tags[N_TAGS],
+	     bint       *n_ranges)
+{
+  GArray *ranges;
+  const char *p;
+  bint offset, start;
+
+  ranges = g_array_new (FALSE, FALSE, sizeof (BtkTextBufferTagRange));
+  start = -1;
+
+  /* The text is ASCII, so byte offsets are character offsets */
+  for (p = text, offset = 0; ; p++, offset++)
+    {
+      if (*p >= 'a' && *p <= 'z')
+	{
+	  if (start < 0)
+	    start = offset;
+	}
+      else if (start >= 0)
+	{
+	  BtkTextBufferTagRange range;
+
+	  range.tag = tags[g_rand_int_range (rng, 0, N_TAGS)];
+	  range.start_offset = start;
+	  range.end_offset = offset;
+	  g_array_append_val (ranges, range);
+	  start = -1;
+	}
+
+      if (*p == '\0')
+	break;
+    }
+
+  *n_ranges = ranges->len;
+
+  return (BtkTextBufferTagRange *) g_array_free (ranges, FALSE);
+}
+
+static BtkTextBuffer *
+buffer_new_tagged (const char *text,
+		   bint        n_bytes)
+{
+  BtkTextBuffer *buffer;
+  BtkTextTag *tags[N_TAGS];
+  BtkTextBufferTagRange *ranges;
+  bint n_ranges;
+
+  buffer = btk_text_buffer_new (NULL);
+  create_tags (buffer, tags);
+  btk_text_buffer_set_text (buffer, text, n_bytes);
+
+  ranges = word_ranges (text, tags, &n_ranges);
+  btk_text_buffer_apply_tag_ranges (buffer, ranges, n_ranges);
+  g_free (ranges);
+
+  return buffer;
+}
+
+/* Text buffer */
+
+static void
+bench_text_buffer (const char *text,
+		   bint        n_bytes)
+{
+  BtkTextBuffer *buffer;
+  BtkTextTag *tags[N_TAGS];
+  BtkTextBufferTagRange *ranges;
+  BtkTextIter start, end;
+  bint n_ranges, i;
+
+  if (perf_bench_start ("text-buffer/load", n_bytes))
+    {
+      buffer = btk_text_buffer_new (NULL);
+      btk_text_buffer_set_text (buffer, text, n_bytes);
+      perf_bench_stop (n_bytes);
+      g_object_unref (buffer);
+    }
+
+  if (perf_bench_enabled ("text-buffer/tag-ranges"))
+    {
+      buffer = btk_text_buffer_new (NULL);
+      create_tags (buffer, tags);
+      btk_text_buffer_set_text (buffer, text, n_bytes);
+      ranges = word_ranges (text, tags, &n_ranges);
+
+      perf_bench_start ("text-buffer/tag-ranges", n_bytes);
+      btk_text_buffer_apply_tag_ranges (buffer, ranges, n_ranges);
+      perf_bench_stop (n_ranges);
+
+      g_free (ranges);
+      g_object_unref (buffer);
+    }
+
+  if (perf_bench_enabled ("text-buffer/tag-each"))
+    {
+      buffer = btk_text_buffer_new (NULL);
+      create_tags (buffer, tags);
+      btk_text_buffer_set_text (buffer, text, n_bytes);
+      ranges = word_ranges (text, tags, &n_ranges);
+
+      perf_bench_start ("text-buffer/tag-each", n_bytes);
+      for (i = 0; i < n_ranges; i++)
+	{
+	  btk_text_buffer_get_iter_at_offset (buffer, &start,
+					      ranges[i].start_offset);
+	  btk_text_buffer_get_iter_at_offset (buffer, &end,
+					      ranges[i].end_offset);
+	  btk_text_buffer_apply_tag (buffer, ranges[i].tag, &start, &end);
+	}
+      perf_bench_stop (n_ranges);
+
+      g_free (ranges);
+      g_object_unref (buffer);
+    }
+
+  if (!perf_bench_enabled ("text-buffer/edit") &&
+      !perf_bench_enabled ("text-buffer/search-find-all") &&
+      !perf_bench_enabled ("text-buffer/search-iter") &&
+      !perf_bench_enabled ("text-buffer/search-case-insensitive"))
+    return;
+
+  buffer = buffer_new_tagged (text, n_bytes);
+
+  if (perf_bench_start ("text-buffer/edit", n_bytes))
+    {
+      bint n_chars = btk_text_buffer_get_char_count (buffer);
+
+      /* Alternate insertions and deletions at random places, so the
+       * buffer keeps its size
+       */
+      for (i = 0; i < N_EDITS; i++)
+	{
+	  btk_text_buffer_get_iter_at_offset (buffer, &start,
+					      g_rand_int_range (rng, 0, n_chars - 8));
+	  if (i % 2 == 0)
+	    btk_text_buffer_insert (buffer, &start, "edit ", -1);
+	  else
+	    {
+	      end = start;
+	      btk_text_iter_forward_chars (&end, 5);
+	      btk_text_buffer_delete (buffer, &start, &end);
+	    }
+	}
+      perf_bench_stop (N_EDITS);
+    }
+
+  if (perf_bench_start ("text-buffer/search-find-all", n_bytes))
+    {
+      GArray *matches;
+
+      btk_text_buffer_get_bounds (buffer, &start, &end);
+      matches = btk_text_buffer_find_all (buffer, SEARCH_WORD, 0, &start, &end);
+      perf_bench_stop (matches->len);
+      g_array_free (matches, TRUE);
+    }
+
+  if (perf_bench_start ("text-buffer/search-iter", n_bytes))
+    {
+      BtkTextIter match_end;
+      bint n_matches = 0;
+
+      btk_text_buffer_get_start_iter (buffer, &start);
+      while (btk_text_iter_forward_search (&start, SEARCH_WORD, 0,
+					   NULL, &match_end, NULL))
+	{
+	  start = match_end;
+	  n_matches++;
+	}
+      perf_bench_stop (n_matches);
+    }
+
+  if (perf_bench_start ("text-buffer/search-case-insensitive", n_bytes))
+    {
+      GArray *matches;
+
+      btk_text_buffer_get_bounds (buffer, &start, &end);
+      matches = btk_text_buffer_find_all (buffer, "ZULU",
+					  BTK_TEXT_SEARCH_CASE_INSENSITIVE,
+					  &start, &end);
+      perf_bench_stop (matches->len);
+      g_array_free (matches, TRUE);
+    }
+
+  g_object_unref (buffer);
+}
+
+/* Text view */
+
+/* BangoLayouts are how the text view lays out and draws every line, so
+ * counting them tells how many lines were laid out again.  Bango has no
+ * API for that; wrap the class constructor instead.  Lines are also
+ * wrapped on the layout's wrap thread, so the count is atomic.
+ */
+static volatile bint n_bango_layouts;
+static BObject *(* bango_layout_constructor) (GType                  type,
+					      buint                  n_properties,
+					      BObjectConstructParam *properties);
+
+static BObject *
+counting_constructor (GType                  type,
+		      buint                  n_properties,
+		      BObjectConstructParam *properties)
+{
+  g_atomic_int_inc (&n_bango_layouts);
+
+  return bango_layout_constructor (type, n_properties, properties);
+}
+
+static void
+count_bango_layouts (void)
+{
+  BObjectClass *klass;
+
+  klass = g_type_class_ref (BANGO_TYPE_LAYOUT);
+  bango_layout_constructor = klass->constructor;
+  klass->constructor = counting_constructor;
+}
+
+static int
+compare_doubles (gconstpointer a,
+		 gconstpointer b)
+{
+  const bdouble *da = a;
+  const bdouble *db = b;
+
+  return *da < *db ? -1 : *da > *db;
+}
+
+/* @values must be sorted */
+static bdouble
+percentile (const bdouble *values,
+	    bint           n_values,
+	    bdouble        p)
+{
+  return values[(bint) ((n_values - 1) * p + 0.5)];
+}
+
+static bboolean
+text_view_is_valid (bpointer data)
+{
+  BtkTextLayout *layout = BTK_TEXT_VIEW (data)->layout;
+
+  return layout == NULL || btk_text_layout_is_valid (layout);
+}
+
+/* Lines are wrapped on another thread in batches, and the view goes
+ * idle while a batch runs, so wait for the whole layout to be valid.
+ */
+static void
+text_view_flush (BtkWidget *text_view)
+{
+  perf_bench_flush_events_until (text_view_is_valid, text_view);
+}
+
+static BtkWidget *
+text_view_window_new (BtkWidget **text_view)
+{
+  BtkWidget *window, *sw;
+
+  window = btk_window_new (BTK_WINDOW_TOPLEVEL);
+  btk_window_set_default_size (BTK_WINDOW (window), 600, 800);
+
+  sw = btk_scrolled_window_new (NULL, NULL);
+  btk_container_add (BTK_CONTAINER (window), sw);
+
+  *text_view = btk_text_view_new ();
+  btk_text_view_set_wrap_mode (BTK_TEXT_VIEW (*text_view), BTK_WRAP_WORD);
+  btk_container_add (BTK_CONTAINER (sw), *text_view);
+
+  btk_widget_show_all (window);
+  text_view_flush (*text_view);
+
+  return window;
+}
+
+static void
+bench_typing (BtkWidget     *text_view,
+	      BtkTextBuffer *buffer,
+	      bint           n_bytes)
+{
+  BdkDisplay *display;
+  BtkAdjustment *vadj;
+  BtkTextIter iter;
+  GTimer *keystroke_timer;
+  bdouble *latencies;
+  bint i;
+
+  if (!perf_bench_enabled ("text-view/typing"))
+    return;
+
+  display = btk_widget_get_display (text_view);
+  vadj = btk_text_view_get_vadjustment (BTK_TEXT_VIEW (text_view));
+
+  /* Type into the middle of the buffer, near the top of the screen so
+   * that most of the view is below the cursor
+   */
+  btk_adjustment_set_value (vadj, (vadj->upper - vadj->page_size) / 2);
+  text_view_flush (text_view);
+  btk_text_view_get_iter_at_location (BTK_TEXT_VIEW (text_view), &iter,
+				      0, vadj->value + 50);
+  btk_text_buffer_place_cursor (buffer, &iter);
+  btk_widget_grab_focus (text_view);
+  bdk_window_process_all_updates ();
+  text_view_flush (text_view);
+
+  keystroke_timer = g_timer_new ();
+  latencies = g_new (bdouble, N_KEYSTROKES);
+  g_atomic_int_set (&n_bango_layouts, 0);
+
+  perf_bench_start ("text-view/typing", n_bytes);
+  for (i = 0; i < N_KEYSTROKES; i++)
+    {
+      g_timer_start (keystroke_timer);
+
+      /* Break the line now and then, so line heights change */
+      btk_text_buffer_insert_interactive_at_cursor (buffer,
+						    i % 40 == 39 ? "\n" : "x", 1,
+						    TRUE);
+      bdk_window_process_all_updates ();
+      text_view_flush (text_view);
+      bdk_display_sync (display);
+
+      latencies[i] = g_timer_elapsed (keystroke_timer, NULL);
+    }
+  perf_bench_stop (N_KEYSTROKES);
+
+  qsort (latencies, N_KEYSTROKES, sizeof (bdouble), compare_doubles);
+  perf_bench_add_value ("p50_ms", 1000 * percentile (latencies, N_KEYSTROKES, 0.5));
+  perf_bench_add_value ("p90_ms", 1000 * percentile (latencies, N_KEYSTROKES, 0.9));
+  perf_bench_add_value ("p99_ms", 1000 * percentile (latencies, N_KEYSTROKES, 0.99));
+  perf_bench_add_value ("max_ms", 1000 * latencies[N_KEYSTROKES - 1]);
+  perf_bench_add_value ("bango_layouts", g_atomic_int_get (&n_bango_layouts));
+
+  g_free (latencies);
+  g_timer_destroy (keystroke_timer);
+}
+
+static void
+bench_text_view (const char *text,
+		 bint        n_bytes)
+{
+  BtkWidget *window, *text_view;
+  BtkTextBuffer *buffer;
+  BtkAdjustment *vadj;
+  bdouble step;
+  bint i;
+
+  if (!perf_bench_enabled ("text-view/validate") &&
+      !perf_bench_enabled ("text-view/scroll") &&
+      !perf_bench_enabled ("text-view/scroll-small") &&
+      !perf_bench_enabled ("text-view/typing"))
+    return;
+
+  buffer = buffer_new_tagged (text, n_bytes);
+  window = text_view_window_new (&text_view);
+
+  /* The view validates the whole buffer from an idle */
+  g_atomic_int_set (&n_bango_layouts, 0);
+  if (perf_bench_start ("text-view/validate", n_bytes))
+    {
+      btk_text_view_set_buffer (BTK_TEXT_VIEW (text_view), buffer);
+      text_view_flush (text_view);
+      perf_bench_add_value ("bango_layouts", g_atomic_int_get (&n_bango_layouts));
+      perf_bench_stop (btk_text_buffer_get_line_count (buffer));
+    }
+  else
+    {
+      btk_text_view_set_buffer (BTK_TEXT_VIEW (text_view), buffer);
+      text_view_flush (text_view);
+    }
+
+  vadj = btk_text_view_get_vadjustment (BTK_TEXT_VIEW (text_view));
+  step = (vadj->upper - vadj->page_size) / VIEW_ITERATIONS;
+
+  g_atomic_int_set (&n_bango_layouts, 0);
+  if (perf_bench_start ("text-view/scroll", n_bytes))
+    {
+      for (i = 1; i <= VIEW_ITERATIONS; i++)
+	{
+	  btk_adjustment_set_value (vadj, i * step);
+	  bdk_window_process_all_updates ();
+	  text_view_flush (text_view);
+	}
+      perf_bench_add_value ("bango_layouts", g_atomic_int_get (&n_bango_layouts));
+      perf_bench_stop (VIEW_ITERATIONS);
+    }
+
+  g_atomic_int_set (&n_bango_layouts, 0);
+  if (perf_bench_start ("text-view/scroll-small", n_bytes))
+    {
+      /* Scroll by a few lines at a time, like wheel scrolling */
+      for (i = 1; i <= VIEW_ITERATIONS; i++)
+	{
+	  btk_adjustment_set_value (vadj, i * vadj->step_increment * 3);
+	  bdk_window_process_all_updates ();
+	  text_view_flush (text_view);
+	}
+      perf_bench_add_value ("bango_layouts", g_atomic_int_get (&n_bango_layouts));
+      perf_bench_stop (VIEW_ITERATIONS);
+    }
+
+  bench_typing (text_view, buffer, n_bytes);
+
+  btk_widget_destroy (window);
+  g_object_unref (buffer);
+}
+
+int
+main (int argc, char **argv)
+{
+  GOptionContext *context;
+  GError *error = NULL;
+  bint *sizes, n_sizes, i;
+
+  perf_bench_init (&argc, &argv);
+  g_type_init ();
+
+  context = g_option_context_new ("- benchmark the text buffer and view");
+  g_option_context_add_main_entries (context, entries, NULL);
+  g_option_context_add_group (context, perf_bench_get_option_group ());
+  if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+      g_printerr ("%s\n", error->message);
+      return 1;
+    }
+  g_option_context_free (context);
+
+  if (!no_views && !btk_init_check (&argc, &argv))
+    {
+      g_printerr ("Cannot open a display, skipping the view benchmarks\n");
+      no_views = TRUE;
+    }
+
+  count_bango_layouts ();
+
+  rng = g_rand_new_with_seed (42);
+  sizes = perf_bench_parse_rows (size_option, &n_sizes);
+
+  for (i = 0; i < n_sizes; i++)
+    {
+      char *text = random_text (sizes[i]);
+      bint n_bytes = strlen (text);
+
+      bench_text_buffer (text, n_bytes);
+      if (!no_views)
+	bench_text_view (text, n_bytes);
+
+      g_free (text);
+    }
+
+  g_free (sizes);
+  g_rand_free (rng);
+  perf_bench_finish ();
+
+  return 0;
+}
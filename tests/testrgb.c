@@ -52,6 +52,10 @@ quit_func (BtkWidget *widget, bpointer dummy)
 #define HEIGHT 400
 #define NUM_ITERS 50
 
+#define FRAME_WIDTH 1920
+#define FRAME_HEIGHT 1080
+#define FRAME_ITERS 20
+
 static void
 testrgb_rgb_test (BtkWidget *drawing_area)
 {
@@ -276,6 +280,116 @@ testrgb_rgb_test (BtkWidget *drawing_area)
 #endif
 }
 
+/* Returns megapixels/s for drawing full frames to @drawable */
+static bdouble
+testrgb_time_frames (BdkDrawable  *drawable,
+		     BdkGC        *gc,
+		     const buchar *buf,
+		     bboolean      rgb_32,
+		     BdkRgbDither  dith)
+{
+  GTimer *timer;
+  bdouble total_time;
+  bint i;
+
+  timer = g_timer_new ();
+  for (i = 0; i < FRAME_ITERS; i++)
+    {
+      if (rgb_32)
+	bdk_draw_rgb_32_image (drawable, gc, 0, 0, FRAME_WIDTH, FRAME_HEIGHT,
+			       dith, buf, FRAME_WIDTH * 4);
+      else
+	bdk_draw_rgb_image (drawable, gc, 0, 0, FRAME_WIDTH, FRAME_HEIGHT,
+			    dith, buf, FRAME_WIDTH * 3);
+    }
+  bdk_flush ();
+  total_time = g_timer_elapsed (timer, NULL);
+  g_timer_destroy (timer);
+
+  return FRAME_ITERS * (FRAME_WIDTH * FRAME_HEIGHT * 1e-6) / total_time;
+}
+
+static bboolean
+testrgb_same_format (BdkVisual *a,
+		     BdkVisual *b)
+{
+  return a->type == b->type && a->depth == b->depth &&
+    a->byte_order == b->byte_order &&
+    a->red_mask == b->red_mask && a->green_mask == b->green_mask &&
+    a->blue_mask == b->blue_mask;
+}
+
+/* Draws full HD frames to a pixmap for every kind of visual of the
+ * screen, which shows the speed of the BdkRGB converter for each.
+ */
+static void
+testrgb_visual_test (BtkWidget *drawing_area)
+{
+  static const char *type_names[] = {
+    "static gray", "grayscale", "static color",
+    "pseudo color", "true color", "direct color"
+  };
+  BdkScreen *screen;
+  GList *visuals, *seen, *l, *s;
+  buchar *buf;
+  bint i;
+
+  buf = g_malloc (FRAME_WIDTH * FRAME_HEIGHT * 4);
+  for (i = 0; i < FRAME_WIDTH * FRAME_HEIGHT * 4; i++)
+    buf[i] = rand () & 0xff;
+
+  g_print ("Frame test, %dx%d, megapixels/s by visual "
+	   "(set BDK_DISABLE_SIMD to compare with the plain C loops):\n",
+	   FRAME_WIDTH, FRAME_HEIGHT);
+
+  screen = btk_widget_get_screen (drawing_area);
+  visuals = bdk_screen_list_visuals (screen);
+  seen = NULL;
+  for (l = visuals; l; l = l->next)
+    {
+      BdkVisual *visual = l->data;
+      BdkColormap *cmap;
+      BdkPixmap *pixmap;
+      BdkGC *gc;
+      bdouble rgb, rgb_32;
+
+      for (s = seen; s; s = s->next)
+	if (testrgb_same_format (visual, s->data))
+	  break;
+      if (s)
+	continue;
+      seen = g_list_prepend (seen, visual);
+
+      cmap = bdk_colormap_new (visual, FALSE);
+      pixmap = bdk_pixmap_new (drawing_area->window,
+			       FRAME_WIDTH, FRAME_HEIGHT, visual->depth);
+      bdk_drawable_set_colormap (pixmap, cmap);
+      gc = bdk_gc_new (pixmap);
+
+      /* Sets up the BdkRGB state for the colormap */
+      testrgb_time_frames (pixmap, gc, buf, FALSE, BDK_RGB_DITHER_NONE);
+
+      rgb = testrgb_time_frames (pixmap, gc, buf, FALSE, BDK_RGB_DITHER_NONE);
+      rgb_32 = testrgb_time_frames (pixmap, gc, buf, TRUE, BDK_RGB_DITHER_NONE);
+      g_print ("  %s, depth %d, %s first: rgb %.1f, rgb_32 %.1f",
+	       type_names[visual->type], visual->depth,
+	       visual->byte_order == BDK_LSB_FIRST ? "lsb" : "msb",
+	       rgb, rgb_32);
+      if (bdk_rgb_colormap_ditherable (cmap))
+	g_print (", dithered %.1f",
+		 testrgb_time_frames (pixmap, gc, buf, FALSE, BDK_RGB_DITHER_MAX));
+      g_print ("\n");
+
+      g_object_unref (gc);
+      g_object_unref (pixmap);
+      g_object_unref (cmap);
+    }
+
+  g_list_free (seen);
+  g_list_free (visuals);
+  g_free (buf);
+}
+
 void
 new_testrgb_window (void)
 {
@@ -314,6 +428,7 @@ new_testrgb_window (void)
   btk_widget_show (window);
 
   testrgb_rgb_test (drawing_area);
+  testrgb_visual_test (drawing_area);
 }
 
 int